@@ -0,0 +1,332 @@
+/**
+   bench-compare.c
+
+   Compares the csv records of utilities-bench in a results file with the
+   records in a baseline file and flags the metrics that regressed beyond
+   a tolerance.
+
+   usage: bench-compare baseline.csv results.csv [tolerance] [min seconds]
+
+   A record is identified by its suite, name, and params fields, and by
+   the number of preceding records with the same fields in the same file,
+   so that a benchmark that is repeated with the same parameters within a
+   run is compared in order. The compared metrics are the median wall-clock
+   time, the median CPU time of the timing thread, and the median cycle and
+   instruction counts if the counters were read in both runs. A metric
+   regressed if its value in the results is greater than its baseline value
+   multiplied by 1 + tolerance. Times with a baseline value below min
+   seconds are not compared, because their relative noise is too large.
+   The default tolerance is 0.10 and the default min seconds is 0.001.
+
+   Records that are present in only one of the files are listed but are
+   not regressions. The exit status is 1 if a metric regressed, 2 if the
+   files could not be compared, and 0 otherwise.
+
+   The implementation is portable under C89/C90.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utilities-mem.h"
+
+#define TOLU(i) ((unsigned long int)(i)) /* printing size_t under C89/C90 */
+
+typedef enum{
+  METRIC_WALL,
+  METRIC_CPU,
+  METRIC_CYCLES,
+  METRIC_INSTRS,
+  METRIC_COUNT
+} metric_t;
+
+typedef struct{
+  char *key; /* "suite,name,params" */
+  size_t occ; /* # preceding records with the same key */
+  double val[METRIC_COUNT]; /* < 0.0 if not measured */
+} rec_t;
+
+typedef struct{
+  size_t num_recs;
+  size_t count;
+  rec_t *recs;
+} rec_arr_t;
+
+/* input handling */
+const char *C_USAGE =
+  "bench-compare baseline.csv results.csv [tolerance] [min seconds]\n";
+const double C_TOL_DEF = 0.10;
+const double C_MIN_SECONDS_DEF = 0.001;
+const size_t C_LINE_INIT_COUNT = 1024;
+const size_t C_RECS_INIT_COUNT = 256;
+
+/* csv columns */
+const char *C_METRIC_COLS[4] = {"wall_med", "cpu_med", "cycles_med",
+				"instrs_med"};
+const char *C_METRIC_NAMES[4] = {"wall", "cpu", "cycles", "instrs"};
+const int C_METRIC_IS_TIME[4] = {1, 1, 0, 0};
+const size_t C_NUM_KEY_COLS = 3; /* suite, name, params */
+
+void read_recs(rec_arr_t *ra, const char *path);
+char *read_line(FILE *f, char **buf, size_t *count);
+size_t split(char *line, char **fields, size_t num_fields);
+void set_occ(rec_arr_t *ra);
+int cmp_rec(const void *a, const void *b);
+void free_recs(rec_arr_t *ra);
+int compare(const rec_arr_t *base,
+	    const rec_arr_t *res,
+	    double tol,
+	    double min_seconds);
+
+/**
+   Reads the records of a csv file written by utilities-bench. The columns
+   are located by the names in the header line, which may be repeated if
+   several runs appended to the same file.
+*/
+void read_recs(rec_arr_t *ra, const char *path){
+  size_t i, k, num_fields, num_cols = 0;
+  size_t key_len, line_count = C_LINE_INIT_COUNT;
+  size_t key_ix[3] = {0, 0, 0};
+  size_t metric_ix[4] = {0, 0, 0, 0}; /* METRIC_COUNT */
+  char *line = NULL, *end = NULL;
+  char **fields = NULL;
+  rec_t *r = NULL;
+  FILE *f = fopen(path, "r");
+  if (f == NULL){
+    perror(path);
+    exit(2);
+  }
+  ra->num_recs = 0;
+  ra->count = C_RECS_INIT_COUNT;
+  ra->recs = malloc_perror(ra->count, sizeof(rec_t));
+  line = malloc_perror(line_count, 1);
+  fields = malloc_perror(line_count, sizeof(char *));
+  while (read_line(f, &line, &line_count) != NULL){
+    fields = realloc_perror(fields, line_count, sizeof(char *));
+    num_fields = split(line, fields, line_count);
+    if (num_fields == 0 || fields[0][0] == '\0') continue;
+    if (strcmp(fields[0], "suite") == 0){
+      /* header */
+      for (i = 0; i < C_NUM_KEY_COLS; i++){
+	key_ix[i] = num_fields;
+      }
+      for (i = 0; i < METRIC_COUNT; i++){
+	metric_ix[i] = num_fields;
+      }
+      for (i = 0; i < num_fields; i++){
+	if (strcmp(fields[i], "suite") == 0) key_ix[0] = i;
+	if (strcmp(fields[i], "name") == 0) key_ix[1] = i;
+	if (strcmp(fields[i], "params") == 0) key_ix[2] = i;
+	for (k = 0; k < METRIC_COUNT; k++){
+	  if (strcmp(fields[i], C_METRIC_COLS[k]) == 0) metric_ix[k] = i;
+	}
+      }
+      if (key_ix[0] == num_fields ||
+	  key_ix[1] == num_fields ||
+	  key_ix[2] == num_fields ||
+	  metric_ix[METRIC_WALL] == num_fields){
+	fprintf(stderr, "%s: not a utilities-bench csv header\n", path);
+	exit(2);
+      }
+      num_cols = num_fields;
+      continue;
+    }
+    if (num_cols == 0){
+      fprintf(stderr, "%s: record before a csv header\n", path);
+      exit(2);
+    }
+    if (num_fields != num_cols) continue; /* truncated record */
+    if (ra->num_recs == ra->count){
+      ra->count *= 2;
+      ra->recs = realloc_perror(ra->recs, ra->count, sizeof(rec_t));
+    }
+    r = &ra->recs[ra->num_recs];
+    key_len = 0;
+    for (i = 0; i < C_NUM_KEY_COLS; i++){
+      key_len += strlen(fields[key_ix[i]]) + 1;
+    }
+    r->key = malloc_perror(key_len, 1);
+    sprintf(r->key, "%s,%s,%s",
+	    fields[key_ix[0]], fields[key_ix[1]], fields[key_ix[2]]);
+    r->occ = 0;
+    for (i = 0; i < METRIC_COUNT; i++){
+      r->val[i] = -1.0;
+      if (metric_ix[i] == num_fields || fields[metric_ix[i]][0] == '\0'){
+	continue;
+      }
+      r->val[i] = strtod(fields[metric_ix[i]], &end);
+      if (*end != '\0') r->val[i] = -1.0;
+    }
+    ra->num_recs++;
+  }
+  fclose(f);
+  free(line);
+  free(fields);
+  set_occ(ra);
+  qsort(ra->recs, ra->num_recs, sizeof(rec_t), cmp_rec);
+  line = NULL;
+  fields = NULL;
+}
+
+/**
+   Reads a line without the newline character into a buffer that is
+   enlarged as needed. Returns a pointer to the line, or NULL at the end
+   of the file.
+*/
+char *read_line(FILE *f, char **buf, size_t *count){
+  size_t len = 0;
+  if (fgets(*buf, *count, f) == NULL) return NULL;
+  len = strlen(*buf);
+  while (len > 0 && (*buf)[len - 1] != '\n' && !feof(f)){
+    *count = mul_sz_perror(*count, 2);
+    *buf = realloc_perror(*buf, *count, 1);
+    if (fgets(*buf + len, *count - len, f) == NULL) break;
+    len += strlen(*buf + len);
+  }
+  while (len > 0 && ((*buf)[len - 1] == '\n' || (*buf)[len - 1] == '\r')){
+    (*buf)[--len] = '\0';
+  }
+  return *buf;
+}
+
+/**
+   Splits a line at commas in place and returns the number of fields.
+*/
+size_t split(char *line, char **fields, size_t num_fields){
+  size_t n = 0;
+  char *p = line;
+  fields[n++] = p;
+  for (; *p != '\0' && n < num_fields; p++){
+    if (*p == ','){
+      *p = '\0';
+      fields[n++] = p + 1;
+    }
+  }
+  return n;
+}
+
+/**
+   Sets the occurrence index of each record with respect to the preceding
+   records with the same key in the file order.
+*/
+void set_occ(rec_arr_t *ra){
+  size_t i, j;
+  for (i = 0; i < ra->num_recs; i++){
+    for (j = i; j > 0; j--){
+      if (strcmp(ra->recs[j - 1].key, ra->recs[i].key) == 0){
+	ra->recs[i].occ = ra->recs[j - 1].occ + 1;
+	break;
+      }
+    }
+  }
+}
+
+int cmp_rec(const void *a, const void *b){
+  const rec_t *ra = a;
+  const rec_t *rb = b;
+  int c = strcmp(ra->key, rb->key);
+  if (c != 0) return c;
+  if (ra->occ > rb->occ){
+    return 1;
+  }else if (ra->occ < rb->occ){
+    return -1;
+  }else{
+    return 0;
+  }
+}
+
+void free_recs(rec_arr_t *ra){
+  size_t i;
+  for (i = 0; i < ra->num_recs; i++){
+    free(ra->recs[i].key);
+    ra->recs[i].key = NULL;
+  }
+  free(ra->recs);
+  ra->recs = NULL;
+}
+
+/**
+   Compares the sorted records of the results with the sorted records of
+   the baseline and prints the regressions, improvements, and unmatched
+   records. Returns the number of regressed metrics.
+*/
+int compare(const rec_arr_t *base,
+	    const rec_arr_t *res,
+	    double tol,
+	    double min_seconds){
+  int c, num_reg = 0, num_impr = 0;
+  size_t i = 0, j = 0, k;
+  size_t num_matched = 0, num_base_only = 0, num_res_only = 0;
+  double b, r;
+  while (i < base->num_recs || j < res->num_recs){
+    if (i == base->num_recs){
+      c = 1;
+    }else if (j == res->num_recs){
+      c = -1;
+    }else{
+      c = cmp_rec(&base->recs[i], &res->recs[j]);
+    }
+    if (c < 0){
+      printf("missing    %s #%lu\n", base->recs[i].key,
+	     TOLU(base->recs[i].occ));
+      num_base_only++;
+      i++;
+      continue;
+    }
+    if (c > 0){
+      printf("new        %s #%lu\n", res->recs[j].key,
+	     TOLU(res->recs[j].occ));
+      num_res_only++;
+      j++;
+      continue;
+    }
+    for (k = 0; k < METRIC_COUNT; k++){
+      b = base->recs[i].val[k];
+      r = res->recs[j].val[k];
+      if (b < 0.0 || r < 0.0) continue;
+      if (C_METRIC_IS_TIME[k] && b < min_seconds) continue;
+      if (b == 0.0) continue;
+      if (r > b * (1.0 + tol)){
+	printf("REGRESSION %s #%lu %s %.9g -> %.9g (%+.1f%%)\n",
+	       res->recs[j].key, TOLU(res->recs[j].occ), C_METRIC_NAMES[k],
+	       b, r, 100.0 * (r - b) / b);
+	num_reg++;
+      }else if (r < b * (1.0 - tol)){
+	printf("improved   %s #%lu %s %.9g -> %.9g (%+.1f%%)\n",
+	       res->recs[j].key, TOLU(res->recs[j].occ), C_METRIC_NAMES[k],
+	       b, r, 100.0 * (r - b) / b);
+	num_impr++;
+      }
+    }
+    num_matched++;
+    i++;
+    j++;
+  }
+  printf("compared %lu records (tolerance %.1f%%, min %.6f seconds): "
+	 "%d regressed, %d improved, %lu missing, %lu new\n",
+	 TOLU(num_matched), 100.0 * tol, min_seconds, num_reg, num_impr,
+	 TOLU(num_base_only), TOLU(num_res_only));
+  return num_reg;
+}
+
+int main(int argc, char *argv[]){
+  int num_reg;
+  double tol = C_TOL_DEF, min_seconds = C_MIN_SECONDS_DEF;
+  rec_arr_t base, res;
+  if (argc < 3 || argc > 5){
+    fprintf(stderr, "USAGE:\n%s", C_USAGE);
+    exit(2);
+  }
+  if (argc > 3) tol = atof(argv[3]);
+  if (argc > 4) min_seconds = atof(argv[4]);
+  if (tol < 0.0 || min_seconds < 0.0){
+    fprintf(stderr, "USAGE:\n%s", C_USAGE);
+    exit(2);
+  }
+  read_recs(&base, argv[1]);
+  read_recs(&res, argv[2]);
+  num_reg = compare(&base, &res, tol, min_seconds);
+  free_recs(&base);
+  free_recs(&res);
+  return num_reg > 0;
+}
@@ -0,0 +1,796 @@
+/**
+   ht-bench.c
+
+   Microbenchmarks of the hash tables under configurable key
+   distributions, operation mixes, key sizes, and load factor upper
+   bounds. The runtimes are reported per operation with utilities-bench
+   together with the number of probes per operation.
+
+   The following command line arguments can be used to customize the
+   benchmarks:
+   ht-bench
+      [0, # bits in size_t - 2) : i s.t. # keys = 2**i
+      [0, # bits in size_t) : j s.t. # operations = 2**j
+      [0, # bits in size_t) : a given k = sizeof(size_t)
+      [0, # bits in size_t) : b s.t. k * 2**a <= key size <= k * 2**b
+      > 0 : c
+      > 0 : d
+      > 0 : e log base 2
+      > 0 : f s.t. c / 2**e <= alpha <= d / 2**e, in f steps
+      [0, 3] : keys: sequential, random, sparse bitset, all
+      [0, 100] : % of searches, the rest are inserts and removes
+      [0, 1000] : s * 100 for the Zipf exponent s of key popularity
+      [0, # bits in size_t) : t s.t. 1 <= # threads <= 2**t, in pow. of 2
+      [0, 1] : ht-divchn on/off
+      [0, 1] : ht-muloa on/off
+      [0, 1] : ht-divchn-pthread on/off
+
+   usage examples:
+   ./ht-bench
+   ./ht-bench 20 22
+   ./ht-bench 16 20 0 3 1 3 2 2 2 50 120
+   ./ht-bench 18 20 0 0 1 1 0 1 1 100 0 3 0 0 1
+
+   ht-bench can be run with any subset of command line arguments in the
+   above-defined order. If the (i + 1)th argument is specified then the
+   ith argument must be specified for i >= 0. Default values are used for
+   the unspecified arguments according to the C_ARGS_DEF array.
+
+   The key universe consists of 2 * 2**i distinct keys, and the first 2**i
+   keys are inserted before the operations are run. A key has a
+   sizeof(size_t)-sized block at the start of the key that is
+     - sequential: the index of the key,
+     - random: a bijective mix of the index of the key,
+     - sparse bitset: the bits of the index spread at a fixed stride
+       across the key, such as vertex sets of a sparse graph,
+   and the remainder of a key is zero, except for random keys, where it is
+   random. The operations are drawn from the universe with a Zipf
+   distribution over a random ranking of the keys, where s = 0 is
+   uniform. A write is an insert or a remove with equal probability, so
+   that the number of keys in a hash table remains near 2**i. The same
+   sequence of operations is used for each hash table.
+
+   The operations are repeated and the median time per operation is
+   reported. The operations are called through function pointers, as in
+   the graph algorithms with a hash table parameter. The probes are
+   counted in the warmup repetition, which is not recorded: a probe is a
+   key comparison in a chain of ht-divchn and ht-divchn-pthread, and a
+   slot in ht-muloa. The memory footprint of ht-divchn and ht-muloa is
+   reported in bytes per key after the preload and after the operations.
+
+   Because ht-divchn-pthread does not permit searches concurrent with
+   modifications, its benchmark consists of phases across thread counts: a
+   batched insert of the first 2**i keys, the searches of the operation
+   sequence, and a batched remove of the first 2**i keys, each divided
+   among the threads.
+
+   The runtimes can be written as csv or json records by setting
+   BENCH_FORMAT and BENCH_OUT. If TEST_SEED is defined, the keys and the
+   operations are the same in each run.
+
+   The implementation does not use stdint.h and is portable under C89/C90
+   and C99. The requirements are: i) CHAR_BIT * sizeof(size_t) is greater
+   or equal to 16 and is even, and ii) pthreads API is available.
+*/
+
+#define _XOPEN_SOURCE 600
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include "ht-divchn-pthread.h"
+#include "ht-divchn.h"
+#include "ht-muloa.h"
+#include "utilities-bench.h"
+#include "utilities-mem.h"
+#include "utilities-mod.h"
+#include "utilities-pthread.h"
+
+/**
+   Generate random numbers in a portable way for test purposes only; rand()
+   in the Linux C Library uses the same generator as random(), which may not
+   be the case on older rand() implementations, and on current
+   implementations on different systems.
+*/
+#ifdef TEST_SEED
+#define RGENS_SEED() do{srand(TEST_SEED);}while (0)
+#else
+#define RGENS_SEED() do{srand(time(NULL));}while (0)
+#endif
+#define RANDOM() (rand()) /* [0, RAND_MAX] */
+#define DRAND() ((double)rand() / RAND_MAX) /* [0.0, 1.0] */
+
+#define TOLU(i) ((unsigned long int)(i)) /* printing size_t under C89/C90 */
+
+/* input handling */
+const char *C_USAGE =
+  "ht-bench\n"
+  "[0, # bits in size_t - 2) : i s.t. # keys = 2**i\n"
+  "[0, # bits in size_t) : j s.t. # operations = 2**j\n"
+  "[0, # bits in size_t) : a\n"
+  "[0, # bits in size_t) : b s.t. k * 2**a <= key size <= k * 2**b\n"
+  "> 0 : c\n"
+  "> 0 : d\n"
+  "> 0 : e log base 2\n"
+  "> 0 : f s.t. c / 2**e <= alpha <= d / 2**e, in f steps\n"
+  "[0, 3] : keys\n"
+  "[0, 100] : % of searches\n"
+  "[0, 1000] : s * 100 for Zipf exponent s\n"
+  "[0, # bits in size_t) : t s.t. 1 <= # threads <= 2**t\n"
+  "[0, 1] x 3 : divchn, muloa, divchn-pthread on/off\n";
+const int C_ARGC_MAX = 16;
+const size_t C_ARGS_DEF[15] = {16, 20, 0, 2, 1, 3, 2, 2, 3, 90, 99, 2,
+			       1, 1, 1};
+const size_t C_FULL_BIT = CHAR_BIT * sizeof(size_t);
+const size_t C_PCT_MAX = 100;
+const size_t C_ZIPF_MAX = 1000;
+
+/* benchmarks */
+const char *C_SUITE = "ht-bench";
+const char *C_KEY_NAMES[3] = {"seq", "rand", "sparse"};
+const size_t C_NUM_KEY_TYPES = 3;
+const size_t C_KEY_SIZE_FACTOR = sizeof(size_t);
+const size_t C_OPS_WARMUPS = 1; /* >= 1, probes counted in first warmup */
+const size_t C_OPS_REPS = 3;
+const size_t C_LOG_NUM_LOCKS = 15;
+const size_t C_BATCH_COUNT = 1000;
+const double C_NS = 1e9;
+
+typedef enum{
+  OP_SEARCH,
+  OP_INSERT,
+  OP_REMOVE,
+  OP_COUNT
+} op_t;
+
+typedef void (*ht_init)(void *, size_t, size_t, size_t, size_t);
+typedef void (*ht_insert)(void *, const void *, const void *);
+typedef void *(*ht_search)(const void *, const void *);
+typedef void (*ht_remove)(void *, const void *, void *);
+typedef void (*ht_free)(void *);
+typedef size_t (*ht_probes)(const void *, const void *);
+typedef void (*ht_footprint)(const void *, mem_footprint_t *);
+
+typedef struct{
+  const char *name;
+  void *ht; /* points to a block of hash table struct size */
+  ht_init init; /* key_size, elt_size, alpha_n, log_alpha_d */
+  ht_insert insert;
+  ht_search search;
+  ht_remove remove;
+  ht_free free;
+  ht_probes probes;
+  ht_footprint footprint;
+} ht_ops_t;
+
+typedef struct{
+  size_t num_keys; /* keys in the universe */
+  size_t num_ins; /* first num_ins keys are inserted before operations */
+  size_t num_ops;
+  size_t key_size;
+  size_t key_type;
+  size_t pct_search;
+  size_t zipf;
+  size_t alpha_n;
+  size_t log_alpha_d;
+  unsigned char *keys;
+  size_t *ixs; /* key index of each operation, also inserted as element */
+  unsigned char *types; /* op_t of each operation */
+} work_t;
+
+typedef struct{
+  size_t count[OP_COUNT];
+  size_t probes[OP_COUNT];
+  size_t num_hits; /* searches that found a key */
+} probe_stats_t;
+
+void run_ops(const ht_ops_t *h, const work_t *w);
+void run_ops_probes(const ht_ops_t *h,
+		    const work_t *w,
+		    probe_stats_t *ps);
+void new_keys(work_t *w);
+void new_ops(work_t *w);
+size_t mix(size_t i, size_t mul_a, size_t mul_b);
+size_t random_sz(void);
+size_t random_range(size_t n);
+void *ptr(const void *block, size_t i, size_t size);
+void report(const bench_t *b,
+	    const char *label,
+	    const work_t *w,
+	    size_t num_threads);
+void print_per_op(const bench_t *b, size_t num_ops);
+void print_probes(const probe_stats_t *ps);
+void print_footprint(const ht_ops_t *h, const work_t *w);
+
+/**
+   Initialization helpers with the default key reduction and contiguous
+   size_t elements.
+*/
+
+void ht_divchn_init_helper(ht_divchn_t *ht,
+			   size_t key_size,
+			   size_t elt_size,
+			   size_t alpha_n,
+			   size_t log_alpha_d){
+  ht_divchn_init(ht, key_size, elt_size, 0, alpha_n, log_alpha_d, NULL);
+}
+
+void ht_muloa_init_helper(ht_muloa_t *ht,
+			  size_t key_size,
+			  size_t elt_size,
+			  size_t alpha_n,
+			  size_t log_alpha_d){
+  ht_muloa_init(ht, key_size, elt_size, 0, alpha_n, log_alpha_d,
+		NULL, NULL);
+}
+
+/**
+   Runs the benchmark of a single-threaded hash table on a workload:
+   the insertion of the first num_ins keys, the operations, and free.
+*/
+void run_ht_bench(const ht_ops_t *h, const work_t *w){
+  char preload_name[32], ops_name[32];
+  size_t i;
+  bench_t b;
+  probe_stats_t ps;
+  memset(&ps, 0, sizeof(probe_stats_t));
+  sprintf(preload_name, "%s preload", h->name);
+  sprintf(ops_name, "%s ops", h->name);
+  printf("\t%s\n", h->name);
+  h->init(h->ht, w->key_size, sizeof(size_t), w->alpha_n, w->log_alpha_d);
+  bench_init(&b, C_SUITE, preload_name, 0, 1);
+  bench_start(&b);
+  for (i = 0; i < w->num_ins; i++){
+    h->insert(h->ht, ptr(w->keys, i, w->key_size), &i);
+  }
+  bench_stop(&b);
+  report(&b, "\t\tpreload time:        ", w, 0);
+  print_per_op(&b, w->num_ins);
+  print_footprint(h, w);
+  bench_free(&b);
+  bench_init(&b, C_SUITE, ops_name, C_OPS_WARMUPS, C_OPS_REPS);
+  for (i = 0; i < b.num_warmups + b.num_reps; i++){
+    bench_start(&b);
+    if (i == 0){
+      run_ops_probes(h, w, &ps);
+    }else{
+      run_ops(h, w);
+    }
+    bench_stop(&b);
+  }
+  report(&b, "\t\tops time:            ", w, 0);
+  print_per_op(&b, w->num_ops);
+  print_probes(&ps);
+  print_footprint(h, w);
+  bench_free(&b);
+  (h->free)(h->ht);
+}
+
+/**
+   Runs the operations of a workload on a hash table.
+*/
+void run_ops(const ht_ops_t *h, const work_t *w){
+  size_t i, elt;
+  const void *key = NULL;
+  for (i = 0; i < w->num_ops; i++){
+    key = ptr(w->keys, w->ixs[i], w->key_size);
+    switch (w->types[i]){
+    case OP_SEARCH:
+      h->search(h->ht, key);
+      break;
+    case OP_INSERT:
+      h->insert(h->ht, key, &w->ixs[i]);
+      break;
+    default:
+      h->remove(h->ht, key, &elt);
+      break;
+    }
+  }
+}
+
+/**
+   Runs the operations of a workload on a hash table and counts the probes
+   of a search for the key before each operation.
+*/
+void run_ops_probes(const ht_ops_t *h,
+		    const work_t *w,
+		    probe_stats_t *ps){
+  size_t i, elt;
+  const void *key = NULL;
+  for (i = 0; i < w->num_ops; i++){
+    key = ptr(w->keys, w->ixs[i], w->key_size);
+    ps->count[w->types[i]]++;
+    ps->probes[w->types[i]] += h->probes(h->ht, key);
+    switch (w->types[i]){
+    case OP_SEARCH:
+      ps->num_hits += (h->search(h->ht, key) != NULL);
+      break;
+    case OP_INSERT:
+      h->insert(h->ht, key, &w->ixs[i]);
+      break;
+    default:
+      h->remove(h->ht, key, &elt);
+      break;
+    }
+  }
+}
+
+/**
+   Runs the benchmarks of ht-divchn-pthread on a workload across thread
+   counts.
+*/
+
+typedef struct{
+  size_t start;
+  size_t count;
+  const work_t *w;
+  size_t *elts; /* inserted and removed elements of the first keys */
+  ht_divchn_pthread_t *ht;
+  const size_t *search_ixs; /* key indices of the search operations */
+} thread_arg_t;
+
+void *insert_thread(void *arg){
+  size_t i, count;
+  const thread_arg_t *ta = arg;
+  for (i = 0; i < ta->count; i += C_BATCH_COUNT){
+    count = (ta->count - i < C_BATCH_COUNT) ? ta->count - i : C_BATCH_COUNT;
+    ht_divchn_pthread_insert(ta->ht,
+			     ptr(ta->w->keys, ta->start + i, ta->w->key_size),
+			     &ta->elts[ta->start + i],
+			     count);
+  }
+  return NULL;
+}
+
+void *search_thread(void *arg){
+  size_t i;
+  const thread_arg_t *ta = arg;
+  for (i = ta->start; i < ta->start + ta->count; i++){
+    ht_divchn_pthread_search(ta->ht, ptr(ta->w->keys,
+					 ta->search_ixs[i],
+					 ta->w->key_size));
+  }
+  return NULL;
+}
+
+void *remove_thread(void *arg){
+  size_t i, count;
+  const thread_arg_t *ta = arg;
+  for (i = 0; i < ta->count; i += C_BATCH_COUNT){
+    count = (ta->count - i < C_BATCH_COUNT) ? ta->count - i : C_BATCH_COUNT;
+    ht_divchn_pthread_remove(ta->ht,
+			     ptr(ta->w->keys, ta->start + i, ta->w->key_size),
+			     &ta->elts[ta->start + i],
+			     count);
+  }
+  return NULL;
+}
+
+void run_threads(void *(*fn)(void *),
+		 thread_arg_t *tas,
+		 size_t count,
+		 size_t num_threads){
+  size_t i, start = 0;
+  size_t seg_count = count / num_threads;
+  size_t rem_count = count % num_threads; /* distribute among threads */
+  pthread_t *tids = NULL;
+  tids = malloc_perror(num_threads, sizeof(pthread_t));
+  for (i = 0; i < num_threads; i++){
+    tas[i].start = start;
+    tas[i].count = seg_count + (i < rem_count);
+    start += tas[i].count;
+  }
+  for (i = 1; i < num_threads; i++){
+    thread_create_perror(&tids[i], fn, &tas[i]);
+  }
+  /* use the parent thread as well */
+  fn(&tas[0]);
+  for (i = 1; i < num_threads; i++){
+    thread_join_perror(tids[i], NULL);
+  }
+  free(tids);
+  tids = NULL;
+}
+
+void run_ht_pthread_bench(const work_t *w, size_t log_threads){
+  size_t i, j, num_threads, num_searches = 0;
+  size_t *search_ixs = NULL, *elts = NULL;
+  bench_t b;
+  probe_stats_t ps;
+  thread_arg_t *tas = NULL;
+  ht_divchn_pthread_t ht;
+  search_ixs = malloc_perror(w->num_ops, sizeof(size_t));
+  for (i = 0; i < w->num_ops; i++){
+    if (w->types[i] == OP_SEARCH) search_ixs[num_searches++] = w->ixs[i];
+  }
+  elts = malloc_perror(w->num_ins, sizeof(size_t));
+  tas = malloc_perror(pow_two_perror(log_threads), sizeof(thread_arg_t));
+  printf("\tdivchn-pthread, %lu searches\n", TOLU(num_searches));
+  for (j = 0; j <= log_threads; j++){
+    num_threads = pow_two_perror(j);
+    printf("\t\t# threads: %lu\n", TOLU(num_threads));
+    for (i = 0; i < num_threads; i++){
+      tas[i].w = w;
+      tas[i].elts = elts;
+      tas[i].ht = &ht;
+      tas[i].search_ixs = search_ixs;
+    }
+    for (i = 0; i < w->num_ins; i++){
+      elts[i] = i;
+    }
+    ht_divchn_pthread_init(&ht, w->key_size, sizeof(size_t), 0,
+			   w->alpha_n, w->log_alpha_d, C_LOG_NUM_LOCKS,
+			   num_threads, NULL, NULL);
+    bench_init(&b, C_SUITE, "divchn-pthread insert", 0, 1);
+    bench_start(&b);
+    run_threads(insert_thread, tas, w->num_ins, num_threads);
+    bench_stop(&b);
+    report(&b, "\t\tinsert time:         ", w, num_threads);
+    print_per_op(&b, w->num_ins);
+    bench_free(&b);
+    bench_init(&b, C_SUITE, "divchn-pthread search", C_OPS_WARMUPS,
+	       C_OPS_REPS);
+    for (i = 0; i < b.num_warmups + b.num_reps; i++){
+      bench_start(&b);
+      run_threads(search_thread, tas, num_searches, num_threads);
+      bench_stop(&b);
+    }
+    report(&b, "\t\tsearch time:         ", w, num_threads);
+    print_per_op(&b, num_searches);
+    memset(&ps, 0, sizeof(probe_stats_t));
+    for (i = 0; i < num_searches; i++){
+      ps.count[OP_SEARCH]++;
+      ps.probes[OP_SEARCH] +=
+	ht_divchn_pthread_probes(&ht, ptr(w->keys, search_ixs[i],
+					  w->key_size));
+      ps.num_hits +=
+	(ht_divchn_pthread_search(&ht, ptr(w->keys, search_ixs[i],
+					   w->key_size)) != NULL);
+    }
+    print_probes(&ps);
+    bench_free(&b);
+    bench_init(&b, C_SUITE, "divchn-pthread remove", 0, 1);
+    bench_start(&b);
+    run_threads(remove_thread, tas, w->num_ins, num_threads);
+    bench_stop(&b);
+    report(&b, "\t\tremove time:         ", w, num_threads);
+    print_per_op(&b, w->num_ins);
+    bench_free(&b);
+    ht_divchn_pthread_free(&ht);
+  }
+  free(search_ixs);
+  free(elts);
+  free(tas);
+  search_ixs = NULL;
+  elts = NULL;
+  tas = NULL;
+}
+
+/**
+   Runs the benchmarks across key types, key sizes, and load factor upper
+   bounds.
+*/
+void run_bench(size_t log_ins,
+	       size_t log_ops,
+	       size_t log_key_start,
+	       size_t log_key_end,
+	       size_t alpha_n_start,
+	       size_t alpha_n_end,
+	       size_t log_alpha_d,
+	       size_t num_alpha_steps,
+	       size_t key_type,
+	       size_t pct_search,
+	       size_t zipf,
+	       size_t log_threads,
+	       const int *ht_on){
+  size_t i, j, t, rem, step;
+  size_t t_start = (key_type == C_NUM_KEY_TYPES) ? 0 : key_type;
+  size_t t_end = (key_type == C_NUM_KEY_TYPES) ? key_type : key_type + 1;
+  work_t w;
+  ht_divchn_t ht_divchn;
+  ht_muloa_t ht_muloa;
+  ht_ops_t h[2];
+  h[0].name = "divchn";
+  h[0].ht = &ht_divchn;
+  h[0].init = (ht_init)ht_divchn_init_helper;
+  h[0].insert = (ht_insert)ht_divchn_insert;
+  h[0].search = (ht_search)ht_divchn_search;
+  h[0].remove = (ht_remove)ht_divchn_remove;
+  h[0].free = (ht_free)ht_divchn_free;
+  h[0].probes = (ht_probes)ht_divchn_probes;
+  h[0].footprint = (ht_footprint)ht_divchn_footprint;
+  h[1].name = "muloa";
+  h[1].ht = &ht_muloa;
+  h[1].init = (ht_init)ht_muloa_init_helper;
+  h[1].insert = (ht_insert)ht_muloa_insert;
+  h[1].search = (ht_search)ht_muloa_search;
+  h[1].remove = (ht_remove)ht_muloa_remove;
+  h[1].free = (ht_free)ht_muloa_free;
+  h[1].probes = (ht_probes)ht_muloa_probes;
+  h[1].footprint = (ht_footprint)ht_muloa_footprint;
+  w.num_ins = pow_two_perror(log_ins);
+  w.num_keys = mul_sz_perror(2, w.num_ins);
+  w.num_ops = pow_two_perror(log_ops);
+  w.pct_search = pct_search;
+  w.zipf = zipf;
+  w.log_alpha_d = log_alpha_d;
+  w.ixs = malloc_perror(w.num_ops, sizeof(size_t));
+  w.types = malloc_perror(w.num_ops, 1);
+  new_ops(&w);
+  for (t = t_start; t < t_end; t++){
+    w.key_type = t;
+    for (i = log_key_start; i <= log_key_end; i++){
+      w.key_size = mul_sz_perror(C_KEY_SIZE_FACTOR, pow_two_perror(i));
+      w.keys = malloc_perror(w.num_keys, w.key_size);
+      new_keys(&w);
+      step = (alpha_n_end - alpha_n_start) / num_alpha_steps;
+      rem = (alpha_n_end - alpha_n_start) % num_alpha_steps;
+      w.alpha_n = alpha_n_start;
+      for (j = 0; j <= num_alpha_steps; j++){
+	printf("Run ht benchmarks on %s keys\n"
+	       "\t# keys: %lu, # inserted keys: %lu, # operations: %lu\n"
+	       "\tkey size: %lu, alpha: %.4f\n"
+	       "\tsearches: %lu%%, Zipf exponent: %.2f\n",
+	       C_KEY_NAMES[t], TOLU(w.num_keys), TOLU(w.num_ins),
+	       TOLU(w.num_ops), TOLU(w.key_size),
+	       (double)w.alpha_n / pow_two_perror(w.log_alpha_d),
+	       TOLU(w.pct_search), (double)w.zipf / C_PCT_MAX);
+	if (ht_on[0]) run_ht_bench(&h[0], &w);
+	if (ht_on[1]) run_ht_bench(&h[1], &w);
+	if (ht_on[2]) run_ht_pthread_bench(&w, log_threads);
+	w.alpha_n += (j < num_alpha_steps) * step + (rem > 0 && rem--);
+      }
+      free(w.keys);
+      w.keys = NULL;
+    }
+  }
+  free(w.ixs);
+  free(w.types);
+  w.ixs = NULL;
+  w.types = NULL;
+}
+
+/**
+   Creates the keys of a workload according to its key type.
+*/
+void new_keys(work_t *w){
+  size_t i, j, b;
+  size_t num_bits = 1, stride;
+  size_t mul_a = random_sz() | 1, mul_b = random_sz() | 1;
+  size_t k;
+  unsigned char *key = NULL;
+  while (((size_t)1 << num_bits) < w->num_keys) num_bits++;
+  stride = w->key_size * CHAR_BIT / num_bits;
+  for (i = 0; i < w->num_keys; i++){
+    key = ptr(w->keys, i, w->key_size);
+    memset(key, 0, w->key_size);
+    if (w->key_type == 0){
+      memcpy(key, &i, sizeof(size_t));
+    }else if (w->key_type == 1){
+      for (j = sizeof(size_t); j < w->key_size; j++){
+	key[j] = RANDOM(); /* mod 2^CHAR_BIT */
+      }
+      k = mix(i, mul_a, mul_b);
+      memcpy(key, &k, sizeof(size_t));
+    }else{
+      for (j = 0; j < num_bits; j++){
+	if (!((i >> j) & 1)) continue;
+	b = j * stride;
+	key[b / CHAR_BIT] |= (unsigned char)(1u << (b % CHAR_BIT));
+      }
+    }
+  }
+}
+
+/**
+   Creates the operations of a workload. The key of an operation is drawn
+   with a Zipf distribution over a random permutation of the key indices.
+*/
+void new_ops(work_t *w){
+  size_t i, j, t, lo, hi, mid;
+  size_t *perm = NULL;
+  double s = (double)w->zipf / C_PCT_MAX;
+  double sum = 0.0, r;
+  double *cdf = NULL;
+  perm = malloc_perror(w->num_keys, sizeof(size_t));
+  cdf = malloc_perror(w->num_keys, sizeof(double));
+  for (i = 0; i < w->num_keys; i++){
+    perm[i] = i;
+  }
+  for (i = w->num_keys - 1; i > 0; i--){
+    j = random_range(i + 1);
+    t = perm[i];
+    perm[i] = perm[j];
+    perm[j] = t;
+  }
+  for (i = 0; i < w->num_keys; i++){
+    sum += 1.0 / pow((double)(i + 1), s);
+    cdf[i] = sum;
+  }
+  for (i = 0; i < w->num_ops; i++){
+    r = DRAND() * sum;
+    lo = 0;
+    hi = w->num_keys - 1;
+    while (lo < hi){
+      mid = lo + (hi - lo) / 2;
+      if (cdf[mid] < r){
+	lo = mid + 1;
+      }else{
+	hi = mid;
+      }
+    }
+    w->ixs[i] = perm[lo];
+    if (DRAND() * C_PCT_MAX < w->pct_search){
+      w->types[i] = OP_SEARCH;
+    }else{
+      w->types[i] = (RANDOM() & 1) ? OP_INSERT : OP_REMOVE;
+    }
+  }
+  free(perm);
+  free(cdf);
+  perm = NULL;
+  cdf = NULL;
+}
+
+/**
+   Maps an index to a pseudorandom value with a bijection given odd
+   multipliers.
+*/
+size_t mix(size_t i, size_t mul_a, size_t mul_b){
+  i *= mul_a;
+  i ^= i >> (C_FULL_BIT / 2);
+  i *= mul_b;
+  i ^= i >> (C_FULL_BIT / 2);
+  return i;
+}
+
+/**
+   Returns a random size_t value, and a random value in [0, n) for n > 0.
+*/
+
+size_t random_sz(void){
+  size_t i, ret = 0;
+  for (i = 0; i < sizeof(size_t); i++){
+    ret = (ret << CHAR_BIT) | (unsigned char)RANDOM();
+  }
+  return ret;
+}
+
+size_t random_range(size_t n){
+  size_t ret = (size_t)(DRAND() * n);
+  return (ret < n) ? ret : n - 1;
+}
+
+/**
+   Computes a pointer to the ith element in the block of elements.
+*/
+void *ptr(const void *block, size_t i, size_t size){
+  return (void *)((char *)block + i * size);
+}
+
+/**
+   Prints a report of a benchmark with the parameters of a workload, and
+   the time and the number of probes per operation.
+*/
+
+void report(const bench_t *b,
+	    const char *label,
+	    const work_t *w,
+	    size_t num_threads){
+  char params[192];
+  sprintf(params, "n=%lu ops=%lu key=%s key_size=%lu alpha=%lu/2^%lu "
+	  "search_pct=%lu zipf=%lu/100",
+	  TOLU(w->num_ins), TOLU(w->num_ops), C_KEY_NAMES[w->key_type],
+	  TOLU(w->key_size), TOLU(w->alpha_n), TOLU(w->log_alpha_d),
+	  TOLU(w->pct_search), TOLU(w->zipf));
+  if (num_threads > 0){
+    sprintf(params + strlen(params), " threads=%lu", TOLU(num_threads));
+  }
+  bench_report(b, label, params);
+}
+
+void print_per_op(const bench_t *b, size_t num_ops){
+  bench_summary_t w;
+  bench_summarize(b, &w, NULL, NULL);
+  if (num_ops > 0){
+    printf("\t\t\tns/op: %.1f\n", C_NS * w.med / num_ops);
+  }
+}
+
+void print_probes(const probe_stats_t *ps){
+  int i;
+  size_t count = 0, probes = 0;
+  const char *names[3] = {"search", "insert", "remove"};
+  for (i = 0; i < OP_COUNT; i++){
+    count += ps->count[i];
+    probes += ps->probes[i];
+  }
+  if (count == 0) return;
+  printf("\t\t\tprobes/op: %.3f (", (double)probes / count);
+  for (i = 0; i < OP_COUNT; i++){
+    if (ps->count[i] == 0) continue;
+    printf("%s%s %.3f", (i > 0) ? ", " : "", names[i],
+	   (double)ps->probes[i] / ps->count[i]);
+  }
+  printf(")\n");
+  if (ps->count[OP_SEARCH] > 0){
+    printf("\t\t\tsearch hit ratio: %.3f\n",
+	   (double)ps->num_hits / ps->count[OP_SEARCH]);
+  }
+}
+
+/**
+   Prints the memory footprint of a hash table in bytes per key. The
+   payload of a key includes its size_t element.
+*/
+void print_footprint(const ht_ops_t *h, const work_t *w){
+  size_t num_elts;
+  mem_footprint_t f;
+  h->footprint(h->ht, &f);
+  num_elts = f.payload / (w->key_size + sizeof(size_t));
+  if (num_elts == 0) return;
+  printf("\t\t\tbytes/key: payload %.1f, overhead %.1f, slack %.1f\n",
+	 (double)f.payload / num_elts,
+	 (double)f.overhead / num_elts,
+	 (double)f.slack / num_elts);
+}
+
+int main(int argc, char *argv[]){
+  int i;
+  int ht_on[3];
+  size_t *args = NULL;
+  RGENS_SEED();
+  if (argc > C_ARGC_MAX){
+    fprintf(stderr, "USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  args = malloc_perror(C_ARGC_MAX - 1, sizeof(size_t));
+  memcpy(args, C_ARGS_DEF, (C_ARGC_MAX - 1) * sizeof(size_t));
+  for (i = 1; i < argc; i++){
+    args[i - 1] = atoi(argv[i]);
+  }
+  if (args[0] > C_FULL_BIT - 3 ||
+      args[1] > C_FULL_BIT - 1 ||
+      args[2] > C_FULL_BIT - 1 ||
+      args[3] > C_FULL_BIT - 1 ||
+      args[4] < 1 ||
+      args[5] < 1 ||
+      args[6] < 1 ||
+      args[7] < 1 ||
+      args[2] > args[3] ||
+      args[4] > args[5] ||
+      args[6] > C_FULL_BIT - 1 ||
+      args[8] > C_NUM_KEY_TYPES ||
+      args[9] > C_PCT_MAX ||
+      args[10] > C_ZIPF_MAX ||
+      args[11] > C_FULL_BIT - 1 ||
+      args[12] > 1 ||
+      args[13] > 1 ||
+      args[14] > 1){
+    fprintf(stderr, "USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  ht_on[0] = args[12];
+  ht_on[1] = args[13];
+  ht_on[2] = args[14];
+  run_bench(args[0],
+	    args[1],
+	    args[2],
+	    args[3],
+	    args[4],
+	    args[5],
+	    args[6],
+	    args[7],
+	    args[8],
+	    args[9],
+	    args[10],
+	    args[11],
+	    ht_on);
+  free(args);
+  args = NULL;
+  return 0;
+}
@@ -6,6 +6,10 @@
    on a division method for hashing and a chaining method for resolving
    collisions.
 
+   The runtimes are measured with utilities-bench. A search is repeated
+   and the median of the repetitions is printed. The runtimes can be
+   written as csv or json records by setting BENCH_FORMAT and BENCH_OUT.
+
    The implementation of tests does not use stdint.h and is portable under
    C89/C90 and C99. The requirements are: i) CHAR_BIT * sizeof(size_t) is
    greater or equal to 16 and is even, and ii) pthreads API is available.
@@ -18,9 +22,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
-#include <sys/time.h>
 #include "ht-divchn-pthread.h"
 #include "dll.h"
+#include "utilities-bench.h"
 #include "utilities-mem.h"
 #include "utilities-mod.h"
 #include "utilities-pthread.h"
@@ -31,7 +35,11 @@
    be the case on older rand() implementations, and on current
    implementations on different systems.
 */
+#ifdef TEST_SEED
+#define RGENS_SEED() do{srand(TEST_SEED);}while (0)
+#else
 #define RGENS_SEED() do{srand(time(NULL));}while (0)
+#endif
 #define RANDOM() (rand()) /* [0, RAND_MAX] */
 #define DRAND() ((double)rand() / RAND_MAX) /* [0.0, 1.0] */
 
@@ -51,14 +59,19 @@ const char *C_USAGE =
   "[0, 1] : on/off remove delete uint test\n"
   "[0, 1] : on/off insert search uint_ptr test\n"
   "[0, 1] : on/off remove delete uint_ptr test\n"
-  "[0, 1] : on/off corner cases test\n";
-const int C_ARGC_MAX = 13;
-const size_t C_ARGS_DEF[12] = {14, 0, 2, 1024, 30720u, 11, 10, 1, 1, 1, 1, 1};
+  "[0, 1] : on/off corner cases test\n"
+  "> 0 : # threads\n";
+const int C_ARGC_MAX = 14;
+const size_t C_ARGS_DEF[13] = {14, 0, 2, 1024, 30720u, 11, 10, 1, 1, 1, 1, 1,
+			       4};
 const size_t C_SIZE_MAX = (size_t)-1;
 const size_t C_FULL_BIT = CHAR_BIT * sizeof(size_t);
 
 /* insert, search, free, remove, delete tests */
+const char *C_SUITE = "ht-divchn-pthread-test";
 const size_t C_KEY_SIZE_FACTOR = sizeof(size_t);
+const size_t C_SEARCH_WARMUPS = 1;
+const size_t C_SEARCH_REPS = 3;
 
 /* corner cases test */
 const size_t C_CORNER_LOG_KEY_START = 0;
@@ -95,8 +108,12 @@ void remove_delete(size_t num_ins,
 		   size_t (*val_elt)(const void *),
 		   void (*free_elt)(void *));
 void *ptr(const void *block, size_t i, size_t size);
+void report(const bench_t *b,
+	    const char *label,
+	    const ht_divchn_pthread_t *ht,
+	    size_t count,
+	    size_t num_threads);
 void print_test_result(int res);
-double timer();
 
 /**
    Test hash table operations on distinct keys and size_t elements 
@@ -440,7 +457,7 @@ void insert_keys_elts(ht_divchn_pthread_t *ht,
   size_t i;
   size_t seg_count, rem_count;
   size_t start = 0;
-  double t;
+  bench_t b;
   pthread_t *iids = NULL;
   insert_arg_t *ias = NULL;
   iids = malloc_perror(num_threads, sizeof(pthread_t));
@@ -460,7 +477,8 @@ void insert_keys_elts(ht_divchn_pthread_t *ht,
     ias[i].ht = ht;
     start += ias[i].count;
   }
-  t = timer();
+  bench_init(&b, C_SUITE, "insert", 0, 1);
+  bench_start(&b);
   for (i = 1; i < num_threads; i++){
     thread_create_perror(&iids[i], insert_thread, &ias[i]);
   }
@@ -469,14 +487,17 @@ void insert_keys_elts(ht_divchn_pthread_t *ht,
   for (i = 1; i < num_threads; i++){
     thread_join_perror(iids[i], NULL);
   }
-  t = timer() - t;
+  bench_stop(&b);
   if (init_count < ht->count){
-    printf("\t\tinsert w/ growth time               "
-	   "%.4f seconds\n", t);
+    b.name = "insert w/ growth";
+    report(&b, "\t\tinsert w/ growth time               ",
+	   ht, count, num_threads);
   }else{
-    printf("\t\tinsert w/o growth time              "
-	   "%.4f seconds\n", t);
+    b.name = "insert w/o growth";
+    report(&b, "\t\tinsert w/o growth time              ",
+	   ht, count, num_threads);
   }
+  bench_free(&b);
   *res *= (ht->num_elts == n + count);
   free(iids);
   free(ias);
@@ -531,8 +552,8 @@ size_t search_ht_helper(const ht_divchn_pthread_t *ht,
 			size_t count,
 			size_t num_threads,
 			size_t (*val_elt)(const void *),
-			double *t){
-  size_t i;
+			bench_t *b){
+  size_t i, j;
   size_t ret = 0;
   size_t seg_count, rem_count;
   size_t start = 0;
@@ -559,15 +580,17 @@ size_t search_ht_helper(const ht_divchn_pthread_t *ht,
     start += sas[i].count;
   }
   /* timing */
-  *t = timer();
-  for (i = 1; i < num_threads; i++){
-    thread_create_perror(&sids[i], search_thread, &sas[i]);
-  }
-  search_thread(&sas[0]);
-  for (i = 1; i < num_threads; i++){
-    thread_join_perror(sids[i], NULL);
+  for (j = 0; j < b->num_warmups + b->num_reps; j++){
+    bench_start(b);
+    for (i = 1; i < num_threads; i++){
+      thread_create_perror(&sids[i], search_thread, &sas[i]);
+    }
+    search_thread(&sas[0]);
+    for (i = 1; i < num_threads; i++){
+      thread_join_perror(sids[i], NULL);
+    }
+    bench_stop(b);
   }
-  *t = timer() - *t;
   /* correctness */
   for (i = 1; i < num_threads; i++){
     thread_create_perror(&sids[i], search_res_thread, &sas[i]);
@@ -595,18 +618,20 @@ void search_in_ht(const ht_divchn_pthread_t *ht,
 		  size_t (*val_elt)(const void *),
 		  int *res){
   size_t n = ht->num_elts;
-  double t;
+  bench_t b;
+  bench_init(&b, C_SUITE, "in ht search", C_SEARCH_WARMUPS, C_SEARCH_REPS);
   *res *=
-    (search_ht_helper(ht, keys, elts, count, num_threads, val_elt, &t) ==
+    (search_ht_helper(ht, keys, elts, count, num_threads, val_elt, &b) ==
      ht->num_elts);
   *res *= (n == ht->num_elts);
   if (num_threads == 1){
-    printf("\t\tin ht search time (nt = 1):         "
-	   "%.4f seconds\n", t);
+    report(&b, "\t\tin ht search time (nt = 1):         ",
+	   ht, count, num_threads);
   }else{
-    printf("\t\tin ht search time:                  "
-	   "%.4f seconds\n", t);
+    report(&b, "\t\tin ht search time:                  ",
+	   ht, count, num_threads);
   }
+  bench_free(&b);
 }
 
 void search_nin_ht(const ht_divchn_pthread_t *ht,
@@ -617,30 +642,35 @@ void search_nin_ht(const ht_divchn_pthread_t *ht,
 		   size_t (*val_elt)(const void *),
 		   int *res){
   size_t n = ht->num_elts;
-  double t;
+  bench_t b;
+  bench_init(&b, C_SUITE, "not in ht search", C_SEARCH_WARMUPS,
+	     C_SEARCH_REPS);
   *res *=
-    (search_ht_helper(ht, keys, elts, count, num_threads, val_elt, &t) == 0);
+    (search_ht_helper(ht, keys, elts, count, num_threads, val_elt, &b) == 0);
   *res *= (n == ht->num_elts);
   if (num_threads == 1){
-    printf("\t\tnot in ht search time (nt = 1):     " 
-	   "%.4f seconds\n", t);
+    report(&b, "\t\tnot in ht search time (nt = 1):     ",
+	   ht, count, num_threads);
   }else{
-    printf("\t\tnot in ht search time:              "
-	   "%.4f seconds\n", t);
+    report(&b, "\t\tnot in ht search time:              ",
+	   ht, count, num_threads);
   }
+  bench_free(&b);
 }
 
 /* Search */
 
 void free_ht(ht_divchn_pthread_t *ht, int verb){
-  double t;;
-  t = timer();
+  size_t count = ht->num_elts;
+  bench_t b;
+  bench_init(&b, C_SUITE, "free", 0, 1);
+  bench_start(&b);
   ht_divchn_pthread_free(ht);
-  t = timer() - t;
+  bench_stop(&b);
   if (verb){
-    printf("\t\tfree time:                          "
-	   "%.4f seconds\n", t);
+    report(&b, "\t\tfree time:                          ", ht, count, 1);
   }
+  bench_free(&b);
 }
 
 /* Insert, search, free */
@@ -769,7 +799,7 @@ void remove_key_elts(ht_divchn_pthread_t *ht,
   size_t i;
   size_t seg_count, rem_count;
   size_t start = 0;
-  double t;
+  bench_t b;
   pthread_t *rids = NULL;
   remove_arg_t *ras = NULL;
   rids = malloc_perror(num_threads, sizeof(pthread_t));
@@ -789,7 +819,8 @@ void remove_key_elts(ht_divchn_pthread_t *ht,
     ras[i].ht = ht;
     start += ras[i].count;
   }
-  t = timer();
+  bench_init(&b, C_SUITE, "remove", 0, 1);
+  bench_start(&b);
   for (i = 1; i < num_threads; i++){
     thread_create_perror(&rids[i], remove_thread, &ras[i]);
   }
@@ -798,7 +829,7 @@ void remove_key_elts(ht_divchn_pthread_t *ht,
   for (i = 1; i < num_threads; i++){
     thread_join_perror(rids[i], NULL);
   }
-  t = timer() - t;
+  bench_stop(&b);
   *res *= (ht->num_elts == 0);
   for (i = 0; i < count; i++){
     *res *=
@@ -807,8 +838,9 @@ void remove_key_elts(ht_divchn_pthread_t *ht,
   for (i = 0; i < ht->count; i++){
     *res *= (ht->key_elts[i] == NULL);
   }
-  printf("\t\tremove time:                        "
-	 "%.4f seconds\n", t);
+  report(&b, "\t\tremove time:                        ",
+	 ht, count, num_threads);
+  bench_free(&b);
   free(rids);
   free(ras);
   rids = NULL;
@@ -855,7 +887,7 @@ void delete_key_elts(ht_divchn_pthread_t *ht,
   size_t i;
   size_t seg_count, rem_count;
   size_t start = 0;
-  double t;
+  bench_t b;
   pthread_t *dids = NULL;
   delete_arg_t *das = NULL;
   dids = malloc_perror(num_threads, sizeof(pthread_t));
@@ -874,7 +906,8 @@ void delete_key_elts(ht_divchn_pthread_t *ht,
     das[i].ht = ht;
     start += das[i].count;
   }
-  t = timer();
+  bench_init(&b, C_SUITE, "delete", 0, 1);
+  bench_start(&b);
   for (i = 1; i < num_threads; i++){
     thread_create_perror(&dids[i], delete_thread, &das[i]);
   }
@@ -883,7 +916,7 @@ void delete_key_elts(ht_divchn_pthread_t *ht,
   for (i = 1; i < num_threads; i++){
     thread_join_perror(dids[i], NULL);
   }
-  t = timer() - t;
+  bench_stop(&b);
   *res *= (ht->num_elts == 0);
   for (i = 0; i < count; i++){
     *res *=
@@ -892,8 +925,9 @@ void delete_key_elts(ht_divchn_pthread_t *ht,
   for (i = 0; i < ht->count; i++){
     *res *= (ht->key_elts[i] == NULL);
   }
-  printf("\t\tdelete time:                        "
-	 "%.4f seconds\n", t);
+  report(&b, "\t\tdelete time:                        ",
+	 ht, count, num_threads);
+  bench_free(&b);
   free(dids);
   free(das);
   dids = NULL;
@@ -1029,12 +1063,19 @@ void print_test_result(int res){
 }
 
 /**
-   Times execution.
+   Prints the runtime of a timed section with the parameters of a hash
+   table, the number of keys, and the number of threads.
 */
-double timer(){
-  struct timeval tm;
-  gettimeofday(&tm, NULL);
-  return tm.tv_sec + tm.tv_usec / 1e6;
+void report(const bench_t *b,
+	    const char *label,
+	    const ht_divchn_pthread_t *ht,
+	    size_t count,
+	    size_t num_threads){
+  char params[160];
+  sprintf(params, "n=%lu key_size=%lu elt_size=%lu alpha=%lu/2^%lu nt=%lu",
+	  TOLU(count), TOLU(ht->key_size), TOLU(ht->elt_size),
+	  TOLU(ht->alpha_n), TOLU(ht->log_alpha_d), TOLU(num_threads));
+  bench_report(b, label, params);
 }
 
 int main(int argc, char *argv[]){
@@ -1063,7 +1104,8 @@ int main(int argc, char *argv[]){
       args[8] > 1 ||
       args[9] > 1 ||
       args[10] > 1 ||
-      args[11] > 1){
+      args[11] > 1 ||
+      args[12] < 1){
     fprintf(stderr, "USAGE:\n%s", C_USAGE);
     exit(EXIT_FAILURE);
   }
@@ -1074,9 +1116,9 @@ int main(int argc, char *argv[]){
 						args[4],
 						args[5],
 						args[6],
-						4,
+						args[12],
 						15,
-						4,
+						args[12],
 						1000);
   if (args[8]) run_remove_delete_uint_test(args[0],
 					   args[1],
@@ -1085,9 +1127,9 @@ int main(int argc, char *argv[]){
 					   args[4],
 					   args[5],
 					   args[6],
-					   4,
+					   args[12],
 					   15,
-					   4,
+					   args[12],
 					   1000);
   if (args[9]) run_insert_search_free_uint_ptr_test(args[0],
 						    args[1],
@@ -1096,9 +1138,9 @@ int main(int argc, char *argv[]){
 						    args[4],
 						    args[5],
 						    args[6],
-						    4,
+						    args[12],
 						    15,
-						    4,
+						    args[12],
 						    1000);
   if (args[10]) run_remove_delete_uint_ptr_test(args[0],
 						args[1],
@@ -1107,9 +1149,9 @@ int main(int argc, char *argv[]){
 						args[4],
 						args[5],
 						args[6],
-						4,
+						args[12],
 						15,
-						4,
+						args[12],
 						1000);
   if (args[11]) run_corner_cases_test(args[0]); 
   free(args);
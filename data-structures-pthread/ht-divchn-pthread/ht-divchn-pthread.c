@@ -5,8 +5,8 @@
    concurrently accessible and modifiable.
    
    The implementation is based on a division method for hashing into upto  
-   the number of slots determined by the largest prime number in the
-   C_PRIME_PARTS array, representable as size_t on a given system, and a
+   the number of slots determined by the largest growth prime, computed at
+   runtime and representable as size_t on a given system, and a
    chaining method for resolving collisions. 
 
    A hash key is an object within a contiguous block of memory (e.g. a basic 
@@ -53,6 +53,8 @@
 
 #define _XOPEN_SOURCE 600
 
+#define UTILITIES_MEM_TAG MEM_TAG_HT
+
 #include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -66,82 +68,28 @@
 #include "utilities-pthread.h"
 
 /**
-   An array of primes in the increasing order, approximately doubling in 
-   magnitude, that are not too close to the powers of 2 and 10 to avoid 
-   hashing regularities due to the structure of data.
+   The slots are allocated with huge_malloc_perror if
+   HT_DIVCHN_PTHREAD_HUGE is defined, and with malloc_perror otherwise.
 */
-static const size_t C_PRIME_PARTS[6 * 1 + 16 * (2 + 3 + 4)] =
-  {0x0607u,                               /* 1543 */
-   0x0c2fu,                               /* 3119 */
-   0x1843u,                               /* 6211 */
-   0x3037u,                               /* 12343 */
-   0x5dadu,                               /* 23981 */
-   0xbe21u,                               /* 48673 */
-   0x5b0bu, 0x0001u,                      /* 88843 */
-   0xd8d5u, 0x0002u,                      /* 186581 */
-   0xc219u, 0x0005u,                      /* 377369 */
-   0x0077u, 0x000cu,                      /* 786551 */
-   0xa243u, 0x0016u,                      /* 1483331 */
-   0x2029u, 0x0031u,                      /* 3219497 */
-   0xcc21u, 0x005fu,                      /* 6278177 */
-   0x5427u, 0x00bfu,                      /* 12538919 */
-   0x037fu, 0x0180u,                      /* 25166719 */
-   0x42bbu, 0x030fu,                      /* 51331771 */
-   0x1c75u, 0x06b7u,                      /* 112663669 */
-   0x96adu, 0x0c98u,                      /* 211326637 */
-   0x96b7u, 0x1898u,                      /* 412653239 */
-   0xc10fu, 0x2ecfu,                      /* 785367311 */
-   0x425bu, 0x600fu,                      /* 1611612763 */
-   0x0007u, 0xc000u,                      /* 3221225479 */
-   0x016fu, 0x8000u, 0x0001u,             /* 6442451311 */
-   0x9345u, 0xffc8u, 0x0002u,             /* 12881269573 */
-   0x5523u, 0xf272u, 0x0005u,             /* 25542415651 */
-   0x1575u, 0x0a63u, 0x000cu,             /* 51713873269 */
-   0x22fbu, 0xca07u, 0x001bu,             /* 119353582331 */
-   0xc513u, 0x4d6bu, 0x0031u,             /* 211752305939 */
-   0xa6cdu, 0x50f3u, 0x0061u,             /* 417969972941 */
-   0xa021u, 0x5460u, 0x00beu,             /* 817459404833 */
-   0xea29u, 0x7882u, 0x0179u,             /* 1621224516137 */
-   0xeaafu, 0x7c3du, 0x02f5u,             /* 3253374675631 */
-   0xab5fu, 0x5a69u, 0x05ffu,             /* 6594291673951 */
-   0x6b1fu, 0x29efu, 0x0c24u,             /* 13349461912351 */
-   0xc81bu, 0x35a7u, 0x17feu,             /* 26380589320219 */
-   0x57b7u, 0xccbeu, 0x2ffbu,             /* 52758518323127 */
-   0xc8fbu, 0x1da8u, 0x6bf3u,             /* 118691918825723 */
-   0x82c3u, 0x2c9fu, 0xc2ccu,             /* 214182177768131 */
-   0x3233u, 0x1c54u, 0x7d40u, 0x0001u,    /* 419189283369523 */
-   0x60adu, 0x46a1u, 0xf55eu, 0x0002u,    /* 832735214133421 */
-   0x6babu, 0x40c4u, 0xf12au, 0x0005u,    /* 1672538661088171 */
-   0xb24du, 0x6765u, 0x38b5u, 0x000bu,    /* 3158576518771277 */
-   0x789fu, 0xfd94u, 0xc6b2u, 0x0017u,    /* 6692396525189279 */
-   0x0d35u, 0x5443u, 0xff54u, 0x0030u,    /* 13791536538127669 */
-   0x2465u, 0x74f9u, 0x42d1u, 0x005eu,    /* 26532115188884581 */
-   0xd017u, 0x90c7u, 0x37b3u, 0x00c6u,    /* 55793289756397591 */
-   0x5055u, 0x5a82u, 0x64dfu, 0x0193u,    /* 113545326073368661 */
-   0x6f8fu, 0x423bu, 0x8949u, 0x0304u,    /* 217449629757435791 */
-   0xd627u, 0x08e0u, 0x0b2fu, 0x05feu,    /* 431794910914467367 */
-   0xbbc1u, 0x662cu, 0x4d90u, 0x0badu,    /* 841413987972987841 */
-   0xf7d3u, 0x45a1u, 0x8ccbu, 0x185du,    /* 1755714234418853843 */
-   0xc647u, 0x3c91u, 0x46b2u, 0x2e9bu,    /* 3358355678469146183 */
-   0x58a1u, 0xbd96u, 0x2836u, 0x5f8cu,    /* 6884922145916737697 */
-   0x8969u, 0x4c70u, 0x6dbeu, 0xdad8u};   /* 15769474759331449193 */
-
-static const size_t C_PRIME_PARTS_COUNT = 6 + 16 * (2 + 3 + 4);
-static const size_t C_PARTS_PER_PRIME[4] = {1, 2, 3, 4};
-static const size_t C_PARTS_ACC_COUNTS[4] = {6,
-					     6 + 16 * 2,
-					     6 + 16 * (2 + 3),
-					     6 + 16 * (2 + 3 + 4)};
-static const size_t C_BUILD_SHIFT = 16;
+#ifdef HT_DIVCHN_PTHREAD_HUGE
+#define SLOTS_MALLOC(num, size) huge_malloc_perror((num), (size))
+#define SLOTS_FREE(ptr) aligned_free(ptr)
+#else
+#define SLOTS_MALLOC(num, size) malloc_perror((num), (size))
+#define SLOTS_FREE(ptr) free(ptr)
+#endif
+
+static const size_t C_LOG_COUNT_START = 9; /* first target 3 * 2^9 */
+static const size_t C_TEN = 10;
 static const size_t C_FULL_BIT = CHAR_BIT * sizeof(size_t);
 static const size_t C_SIZE_MAX = (size_t)-1;
 
 static size_t hash(const ht_divchn_pthread_t *ht, const void *key);
 static size_t mul_alpha_sz_max(size_t n, size_t alpha_n, size_t log_alpha_d);
 static void ht_grow(ht_divchn_pthread_t *ht);
+static void key_elts_init(ht_divchn_pthread_t *ht);
 static int incr_count(ht_divchn_pthread_t *ht);
-static int is_overflow(size_t start, size_t count);
-static size_t build_prime(size_t start, size_t count);
+static size_t growth_prime(size_t ix);
 static void *ptr(const void *block, size_t i, size_t size);
 
 /**
@@ -172,6 +120,7 @@ static void *ptr(const void *block, size_t i, size_t size);
                       and may reduce the time threads are blocked, depending
                       on the scheduler and at the expense of space
    num_grow_threads : >= 1, number of threads used in growing the hash table
+                      and in initializing its slots
    rdc_elt          : - NULL, if a key is in the hash table when the key is
                       inserted, the key-associated element in the hash table
                       is updated to the inserted element
@@ -212,20 +161,17 @@ void ht_divchn_pthread_init(ht_divchn_pthread_t *ht,
   ht->pair_size = add_sz_perror(key_size, elt_size);
   ht->group_ix = 0;
   ht->count_ix = 0;
-  ht->count = build_prime(ht->count_ix, C_PARTS_PER_PRIME[ht->group_ix]);
+  ht->count = growth_prime(ht->count_ix);
   /* 0 <= max_num_elts */
   ht->max_num_elts = mul_alpha_sz_max(ht->count, alpha_n, log_alpha_d);
   while (min_num > ht->max_num_elts && incr_count(ht));
   ht->num_elts = 0;
   ht->alpha_n = alpha_n;
   ht->log_alpha_d = log_alpha_d;
-  ht->key_elts = malloc_perror(ht->count, sizeof(dll_node_t *));
-  for (i = 0; i < ht->count; i++){
-    dll_init(&ht->key_elts[i]);
-  }
   /* thread synchronization */
   ht->num_in_threads = 0;
   ht->num_grow_threads = num_grow_threads;
+  key_elts_init(ht);
   key_locks_count = pow_two_perror(log_num_locks);
   ht->key_locks_mask = C_SIZE_MAX & (key_locks_count - 1);
   ht->gate_open = TRUE;
@@ -296,8 +242,7 @@ void ht_divchn_pthread_insert(ht_divchn_pthread_t *ht,
   }
 
   /* grow ht if needed, and finish */
-  if (ht->count_ix != C_SIZE_MAX &&
-      ht->count_ix != C_PRIME_PARTS_COUNT){
+  if (ht->count_ix != C_SIZE_MAX){
     mutex_lock_perror(&ht->gate_lock);
     ht->num_elts += increased;
     if (ht->num_elts > ht->max_num_elts && ht->gate_open){
@@ -343,6 +288,28 @@ void *ht_divchn_pthread_search(const ht_divchn_pthread_t *ht,
   }
 }
 
+/**
+   Returns the number of keys that are compared in a search for a key,
+   i.e. the position of the key in the chain of its slot if the key is
+   present, and the length of the chain otherwise. The key parameter is
+   not NULL. As the search operation, the operation is called
+   before/after all threads started/completed insert, remove, and delete
+   operations on ht.
+*/
+size_t ht_divchn_pthread_probes(const ht_divchn_pthread_t *ht,
+				const void *key){
+  size_t num_probes = 0;
+  const dll_node_t *head = ht->key_elts[hash(ht, key)];
+  const dll_node_t *node = head;
+  if (node == NULL) return 0;
+  do{
+    num_probes++;
+    if (memcmp(dll_ptr(node, 0), key, ht->key_size) == 0) break;
+    node = node->next;
+  }while (node != head);
+  return num_probes;
+}
+
 /**
    Removes a batch of keys and associated elements from a hash table.
    The batch_keys and batch_elts parameters are not NULL. The
@@ -443,7 +410,7 @@ void ht_divchn_pthread_free(ht_divchn_pthread_t *ht){
   for (i = 0; i < ht->count; i++){
     dll_free(&ht->key_elts[i], ht->key_size, ht->free_elt);
   }
-  free(ht->key_elts);
+  SLOTS_FREE(ht->key_elts);
   free(ht->key_locks);
   ht->key_elts = NULL;
   ht->key_locks = NULL;
@@ -474,12 +441,11 @@ static size_t mul_alpha_sz_max(size_t n, size_t alpha_n, size_t log_alpha_d){
 }
 
 /**
-   Increase the size of a hash table to the next prime number in the
-   C_PRIME_PARTS array that lowers the load factor below alpha, or if not
-   possible to the largest prime number in the C_PRIME_PARTS array
-   representable on a system. The operation is called if i) alpha was
-   exceeded and the hash table count did not reach the largest
-   prime number in the C_PRIME_PARTS array representable on a system, AND
+   Increase the size of a hash table to the next growth prime that lowers
+   the load factor below alpha, or if not possible to the largest growth
+   prime representable on a system. The operation is called if i) alpha was
+   exceeded and the hash table count did not reach the largest growth
+   prime representable on a system, AND
    ii) it is guaranteed that only the calling thread has access to the hash
    table throughout the operation.
 */
@@ -522,10 +488,7 @@ static void ht_grow(ht_divchn_pthread_t *ht){
   if (prev_count == ht->count) return; /* load factor not lowered */
   rids = malloc_perror(ht->num_grow_threads, sizeof(pthread_t));
   ras = malloc_perror(ht->num_grow_threads, sizeof(reinsert_arg_t));
-  ht->key_elts = malloc_perror(ht->count, sizeof(dll_node_t *));
-  for (i = 0; i < ht->count; i++){
-    dll_init(&ht->key_elts[i]);
-  }
+  key_elts_init(ht);
   /* multithreaded reinsertion */
   seg_count = prev_count / ht->num_grow_threads;
   rem_count = prev_count - seg_count * ht->num_grow_threads;
@@ -545,7 +508,7 @@ static void ht_grow(ht_divchn_pthread_t *ht){
   for (i = 1; i < ht->num_grow_threads; i++){
     thread_join_perror(rids[i], NULL);
   }
-  free(prev_key_elts);
+  SLOTS_FREE(prev_key_elts);
   free(rids);
   free(ras);
   prev_key_elts = NULL;
@@ -553,60 +516,65 @@ static void ht_grow(ht_divchn_pthread_t *ht){
   ras = NULL;
 }
 
+/**
+   Allocates the slots of a hash table with SLOTS_MALLOC and initializes
+   the slots with num_grow_threads threads, so that the page faults of a
+   large slot array are handled in parallel and its pages are spread
+   across the NUMA nodes of the threads, if the system places pages on
+   first touch.
+*/
+static void key_elts_init(ht_divchn_pthread_t *ht){
+  dll_node_t *head = NULL;
+  dll_init(&head);
+  ht->key_elts = SLOTS_MALLOC(ht->count, sizeof(dll_node_t *));
+  first_touch_pthread(ht->key_elts,
+		      ht->count,
+		      sizeof(dll_node_t *),
+		      &head,
+		      ht->num_grow_threads);
+}
+
 /**
    Attempts to increase the count of a hash table. Returns 1 if the count
-   was increased. Otherwise returns 0. Updates count_ix, group_ix, count,
-   and max_num_elts accordingly. If the largest representable prime is
-   reached, count_ix may not yet be set to C_SIZE_MAX or C_PRIME_PARTS_COUNT,
-   which requires one additional call that does not increase the count.
-   Otherwise, each call increases the count.
+   was increased. Otherwise returns 0 and sets count_ix to C_SIZE_MAX,
+   because the next growth prime is not representable as size_t. Updates
+   count_ix, count, and max_num_elts accordingly.
 */
 static int incr_count(ht_divchn_pthread_t *ht){
-  ht->count_ix += C_PARTS_PER_PRIME[ht->group_ix];
-  if (ht->count_ix == C_PARTS_ACC_COUNTS[ht->group_ix]) ht->group_ix++;
-  if (ht->count_ix == C_PRIME_PARTS_COUNT){
-    return 0;
-  }else if (is_overflow(ht->count_ix, C_PARTS_PER_PRIME[ht->group_ix])){
+  size_t p = growth_prime(ht->count_ix + 1);
+  if (p == 0){
     ht->count_ix = C_SIZE_MAX;
     return 0;
-  }else{
-    ht->count = build_prime(ht->count_ix, C_PARTS_PER_PRIME[ht->group_ix]);
-    /* 0 <= max_num_elts <= C_SIZE_MAX */
-    ht->max_num_elts = mul_alpha_sz_max(ht->count,
-					ht->alpha_n,
-					ht->log_alpha_d);
   }
+  ht->count_ix++;
+  ht->count = p;
+  /* 0 <= max_num_elts <= C_SIZE_MAX */
+  ht->max_num_elts = mul_alpha_sz_max(ht->count,
+				      ht->alpha_n,
+				      ht->log_alpha_d);
   return 1;
 }
 
 /**
-   Tests if the next prime number results in an overflow of size_t
-   on a given system. Returns 0 if no overflow, otherwise returns 1.
+   Computes the prime count of a hash table at a growth step ix >= 0.
+   The prime is the smallest prime greater or equal to 3 * 2^{9 + ix},
+   approximately doubling in magnitude across steps and not too close to
+   the powers of 2, or, if the target is within 1/16 of its magnitude from
+   a power of 10, the smallest prime greater or equal to 7/8 of the power
+   of 10, to avoid hashing regularities due to the structure of data.
+   Returns 0 if the prime is not representable as size_t.
 */
-static int is_overflow(size_t start, size_t count){
-  size_t c = 0;
-  size_t n_shift;
-  n_shift = C_PRIME_PARTS[start + (count - 1)];
-  while (n_shift){
-    n_shift >>= 1;
-    c++;
-  }
-  return (c + (count - 1) * C_BUILD_SHIFT > C_FULL_BIT);
-}
-
-/**
-   Builds a prime number from parts in the C_PRIME_PARTS array.
-*/
-static size_t build_prime(size_t start, size_t count){
-  size_t p = 0;
-  size_t n_shift;
-  size_t i;
-  for (i = 0; i < count; i++){
-    n_shift = C_PRIME_PARTS[start + i];
-    n_shift <<= (i * C_BUILD_SHIFT);
-    p |= n_shift;
+static size_t growth_prime(size_t ix){
+  size_t t, ten = 1;
+  if (C_LOG_COUNT_START + ix + 2 > C_FULL_BIT) return 0;
+  t = (size_t)3 << (C_LOG_COUNT_START + ix);
+  while (ten <= t / C_TEN) ten *= C_TEN; /* ten <= t < C_TEN * ten */
+  if (t - ten < t / 16){
+    t = ten - ten / 8;
+  }else if (ten <= C_SIZE_MAX / C_TEN && C_TEN * ten - t < t / 16){
+    t = C_TEN * ten - C_TEN * ten / 8;
   }
-  return p;
+  return next_prime(t);
 }
 
 /**
@@ -6,8 +6,8 @@
    accessible and modifiable.
 
    The implementation is based on a division method for hashing into upto  
-   the number of slots determined by the largest prime number in the
-   C_PRIME_PARTS array, representable as size_t on a given system, and a
+   the number of slots determined by the largest growth prime, computed at
+   runtime and representable as size_t on a given system, and a
    chaining method for resolving collisions. 
 
    A hash key is an object within a contiguous block of memory (e.g. a basic 
@@ -40,6 +40,12 @@
      exceeded**, or iii) after the hash table reaches its maximum count of
      slots on a given system and alpha no longer bounds the load factor.
 
+   The slots are allocated with malloc_perror. If HT_DIVCHN_PTHREAD_HUGE
+   is defined when ht-divchn-pthread.c is compiled, e.g. by
+   "make clean-all && make CPPFLAGS=-DHT_DIVCHN_PTHREAD_HUGE", the slots
+   are allocated with huge_malloc_perror of utilities-mem, which backs a
+   large slot array with huge pages where available.
+
    The implementation does not use stdint.h and is portable under C89/C90
    and C99. The requirements are: i) CHAR_BIT * sizeof(size_t) is greater
    or equal to 16 and is even, and ii) pthreads API is available.
@@ -68,7 +74,7 @@ typedef struct{
   size_t key_size;
   size_t elt_size;
   size_t pair_size; /* key_size + elt_size for input iterations by user */
-  size_t group_ix;
+  size_t group_ix; /* deprecated, set to 0; growth primes are computed */
   size_t count_ix; /* max size_t value if last representable prime reached */
   size_t count;
   size_t max_num_elts; /*  >= 0, <= C_SIZE_MAX, represents alpha */
@@ -120,6 +126,7 @@ typedef struct{
                       and may reduce the time threads are blocked, depending
                       on the scheduler and at the expense of space
    num_grow_threads : >= 1, number of threads used in growing the hash table
+                      and in initializing its slots
    rdc_elt          : - NULL, if a key is in the hash table when the key is
                       inserted, the key-associated element in the hash table
                       is updated to the inserted element
@@ -174,6 +181,17 @@ void ht_divchn_pthread_insert(ht_divchn_pthread_t *ht,
 void *ht_divchn_pthread_search(const ht_divchn_pthread_t *ht,
 			       const void *key);
 
+/**
+   Returns the number of keys that are compared in a search for a key,
+   i.e. the position of the key in the chain of its slot if the key is
+   present, and the length of the chain otherwise. The key parameter is
+   not NULL. As the search operation, the operation is called
+   before/after all threads started/completed insert, remove, and delete
+   operations on ht.
+*/
+size_t ht_divchn_pthread_probes(const ht_divchn_pthread_t *ht,
+				const void *key);
+
 /**
    Removes a batch of keys and associated elements from a hash table.
    The batch_keys and batch_elts parameters are not NULL. The
@@ -20,6 +20,10 @@
    argument must be specified for i >= 0. Default values are used for the
    unspecified arguments according to the C_ARGS_DEF array.
 
+   The runtimes are measured with utilities-bench and can be written as
+   csv or json records by setting BENCH_FORMAT and BENCH_OUT, e.g.
+   BENCH_FORMAT=json BENCH_OUT=dll.json ./dll-test 24 1 0 0
+
    The implementation of tests does not use stdint.h and is portable under
    C89/C90 and C99 with the only requirement that CHAR_BIT * sizeof(size_t)
    is even.
@@ -29,8 +33,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
-#include <time.h>
 #include "dll.h"
+#include "utilities-bench.h"
 #include "utilities-mem.h"
 #include "utilities-mod.h"
 
@@ -46,6 +50,7 @@ const size_t C_ARGS_DEF[4] = {13, 1, 1, 1};
 const size_t C_INT_BIT = CHAR_BIT * sizeof(int);
 
 /* tests */
+const char *C_SUITE = "dll-test";
 const int C_START_VAL = 0;
 
 void prepend_append_free(dll_node_t **head_prep,
@@ -58,6 +63,10 @@ void prepend_append_free(dll_node_t **head_prep,
 			 void (*free_elt)(void *));
 void *ptr(const void *block, size_t i, size_t size);
 void print_dll(dll_node_t **head, int (*val)(const dll_node_t *));
+void report(const bench_t *b,
+	    const char *label,
+	    int num_ins,
+	    size_t elt_size);
 void print_test_result(int res);
 
 /**
@@ -341,7 +350,7 @@ void prepend_append_free(dll_node_t **head_prep,
   size_t key_size = sizeof(int);
   void *elts_prep = NULL, *elts_app = NULL;
   dll_node_t *node_prep = NULL, *node_app = NULL;
-  clock_t t_prep, t_app, t_free_prep, t_free_app;
+  bench_t b_prep, b_app, b_free_prep, b_free_app;
   keys = calloc_perror(num_ins, key_size);
   elts_prep = malloc_perror(num_ins, elt_size);
   elts_app = malloc_perror(num_ins, elt_size);
@@ -350,7 +359,8 @@ void prepend_append_free(dll_node_t **head_prep,
     new_elt(ptr(elts_prep, i, elt_size), start_val + i);
     new_elt(ptr(elts_app, i, elt_size), start_val + i);
   }  
-  t_prep = clock();
+  bench_init(&b_prep, C_SUITE, "prepend", 0, 1);
+  bench_start(&b_prep);
   for (i = 0; i < num_ins; i++){
     dll_prepend_new(head_prep,
 		    &keys[i],
@@ -358,8 +368,9 @@ void prepend_append_free(dll_node_t **head_prep,
 		    key_size,
 		    elt_size);
   }
-  t_prep = clock() - t_prep;
-  t_app = clock();
+  bench_stop(&b_prep);
+  bench_init(&b_app, C_SUITE, "append", 0, 1);
+  bench_start(&b_app);
   for (i = 0; i < num_ins; i++){
     dll_append_new(head_app,
 		   &keys[i],
@@ -367,7 +378,7 @@ void prepend_append_free(dll_node_t **head_prep,
 		   key_size,
 		   elt_size);
   }
-  t_app = clock() - t_app;
+  bench_stop(&b_app);
   node_prep = *head_prep;
   node_app = *head_app;
   for (i = 0; i < num_ins; i++){
@@ -380,22 +391,24 @@ void prepend_append_free(dll_node_t **head_prep,
     node_prep = node_prep->next;
     node_app = node_app->next;
   }
-  t_free_prep = clock();
+  bench_init(&b_free_prep, C_SUITE, "free after prepend", 0, 1);
+  bench_start(&b_free_prep);
   dll_free(head_prep, key_size, free_elt);
-  t_free_prep = clock() - t_free_prep;
-  t_free_app = clock();
+  bench_stop(&b_free_prep);
+  bench_init(&b_free_app, C_SUITE, "free after append", 0, 1);
+  bench_start(&b_free_app);
   dll_free(head_app, key_size, free_elt);
-  t_free_app = clock() - t_free_app;
+  bench_stop(&b_free_app);
   res *= (head_prep != NULL && *head_prep == NULL);
   res *= (head_app != NULL && *head_app == NULL);
-  printf("\t\tprepend time:            %.4f seconds\n",
-	 (float)t_prep / CLOCKS_PER_SEC);
-  printf("\t\tappend time:             %.4f seconds\n",
-	 (float)t_app / CLOCKS_PER_SEC);
-  printf("\t\tfree after prepend time: %.4f seconds\n",
-	 (float)t_free_prep / CLOCKS_PER_SEC);
-  printf("\t\tfree after append time:  %.4f seconds\n",
-	 (float)t_free_app / CLOCKS_PER_SEC);
+  report(&b_prep, "\t\tprepend time:            ", num_ins, elt_size);
+  bench_free(&b_prep);
+  report(&b_app, "\t\tappend time:             ", num_ins, elt_size);
+  bench_free(&b_app);
+  report(&b_free_prep, "\t\tfree after prepend time: ", num_ins, elt_size);
+  bench_free(&b_free_prep);
+  report(&b_free_app, "\t\tfree after append time:  ", num_ins, elt_size);
+  bench_free(&b_free_app);
   printf("\t\tcorrectness:             ");
   print_test_result(res);
   free(keys);
@@ -413,6 +426,19 @@ void *ptr(const void *block, size_t i, size_t size){
   return (void *)((char *)block + i * size);
 }
 
+/**
+   Prints a report of a benchmark with the number of inserts and the
+   element size as its parameters.
+*/
+void report(const bench_t *b,
+	    const char *label,
+	    int num_ins,
+	    size_t elt_size){
+  char params[64];
+  sprintf(params, "n=%d elt_size=%lu", num_ins, (unsigned long)elt_size);
+  bench_report(b, label, params);
+}
+
 /**
    Prints a test result.
 */
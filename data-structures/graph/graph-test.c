@@ -22,6 +22,10 @@
    argument must be specified for i >= 0. Default values are used for the
    unspecified arguments according to the C_ARGS_DEF array.
 
+   The runtimes are measured with utilities-bench and can be written as
+   csv or json records by setting BENCH_FORMAT and BENCH_OUT, e.g.
+   BENCH_FORMAT=json BENCH_OUT=graph.json ./graph-test 10 14
+
    The implementation of tests does not use stdint.h and is portable under
    C89/C90 and C99 with the requirements that CHAR_BIT * sizeof(size_t)
    is even, and sizeof(size_t) and the size of a weight are powers of two.
@@ -35,6 +39,7 @@
 #include <time.h>
 #include "graph.h"
 #include "stack.h"
+#include "utilities-bench.h"
 #include "utilities-mem.h"
 #include "utilities-mod.h"
 
@@ -44,7 +49,11 @@
    be the case on older rand() implementations, and on current
    implementations on different systems.
 */
+#ifdef TEST_SEED
+#define RGENS_SEED() do{srand(TEST_SEED);}while (0)
+#else
 #define RGENS_SEED() do{srand(time(NULL));}while (0)
+#endif
 #define RANDOM() (rand()) /* [0, RAND_MAX] */
 #define DRAND() ((double)rand() / RAND_MAX) /* [0.0, 1.0] */
 
@@ -80,6 +89,9 @@ const size_t C_VTS_UNDIR[8] = {1, 2, 3, 0, 3, 0, 0, 1};
 const size_t C_WTS_UINT_UNDIR[8] = {4, 3, 2, 4, 1, 3, 2, 1};
 const double C_WTS_DOUBLE_UNDIR[8] = {4.0, 3.0, 2.0, 4.0, 1.0, 3.0, 2.0, 1.0};
 
+/* timed tests */
+const char *C_SUITE = "graph-test";
+
 /* corner cases test */
 const size_t C_CORNER_NUM_VTS_MAX = 100;
 
@@ -92,6 +104,7 @@ size_t sum_vts(const adj_lst_t *a, size_t i);
 void print_uint(const void *a);
 void print_double(const void *a);
 void print_adj_lst(const adj_lst_t *a, void (*print_wt)(const void *));
+void report(const bench_t *b, const char *label, const adj_lst_t *a);
 void print_test_result(int res);
 
 /** 
@@ -171,6 +184,7 @@ void uint_graph_helper(const adj_lst_t *a,
   int res = 1;
   size_t ix = 0;
   size_t i;
+  mem_footprint_t f;
   for (i = 0; i < a->num_vts; i++){
     res *= (nums[i] == a->vt_wts[i]->num_elts);
     p_start = a->vt_wts[i]->elts;
@@ -181,6 +195,9 @@ void uint_graph_helper(const adj_lst_t *a,
       ix++;
     }
   }
+  adj_lst_footprint(a, &f);
+  res *= (f.payload == ix * (sizeof(size_t) + a->wt_size));
+  res *= (f.overhead >= sizeof(adj_lst_t) + a->num_vts * sizeof(stack_t));
   print_test_result(res);
 }
 
@@ -223,6 +240,7 @@ void double_graph_helper(const adj_lst_t *a,
   int res = 1;
   size_t ix = 0;
   size_t i;
+  mem_footprint_t f;
   for (i = 0; i < a->num_vts; i++){
     res *= (nums[i] == a->vt_wts[i]->num_elts);
     p_start = a->vt_wts[i]->elts;
@@ -234,6 +252,9 @@ void double_graph_helper(const adj_lst_t *a,
       ix++;
     }
   }
+  adj_lst_footprint(a, &f);
+  res *= (f.payload == ix * (sizeof(size_t) + a->wt_size));
+  res *= (f.overhead >= sizeof(adj_lst_t) + a->num_vts * sizeof(stack_t));
   print_test_result(res);
 }
 
@@ -317,20 +338,22 @@ void run_adj_lst_undir_build_test(int log_start, int log_end){
   int l;
   graph_t g;
   adj_lst_t a;
-  clock_t t;
+  bench_t b;
   printf("Test adj_lst_undir_build on complete unweighted graphs \n");
   printf("\tn vertices, n(n - 1)/2 edges represented by n(n - 1) "
 	 "directed edges \n");
   for (l = log_start; l <= log_end; l++){
     complete_graph_init(&g, pow_two_perror(l));
     adj_lst_init(&a, &g);
-    t = clock();
+    bench_init(&b, C_SUITE, "undir build", 0, 1);
+    bench_start(&b);
     adj_lst_undir_build(&a, &g);
-    t = clock() - t;
+    bench_stop(&b);
     printf("\t\tvertices: %lu, "
-	   "directed edges: %lu, "
-	   "build time: %.6f seconds\n",
-	   TOLU(a.num_vts), TOLU(a.num_es), (float)t / CLOCKS_PER_SEC);
+	   "directed edges: %lu\n",
+	   TOLU(a.num_vts), TOLU(a.num_es));
+    report(&b, "\t\t\tbuild time: ", &a);
+    bench_free(&b);
     fflush(stdout);
     adj_lst_free(&a);
     graph_free(&g);
@@ -403,7 +426,7 @@ void add_edge_helper(int log_start,
   bern_arg_t b;
   graph_t g_blt, g_bld;
   adj_lst_t a_blt, a_bld;
-  clock_t t;
+  bench_t bt;
   b.p = C_PROB_ONE;
   for (l = log_start; l <= log_end; l++){
     n = pow_two_perror(l);
@@ -413,19 +436,20 @@ void add_edge_helper(int log_start,
     adj_lst_init(&a_bld, &g_bld);
     build(&a_blt, &g_blt);
     build(&a_bld, &g_bld);
-    t = clock();
+    bench_init(&bt, C_SUITE, "add edge", 0, 1);
+    bench_start(&bt);
     for (i = 0; i < n - 1; i++){
       for (j = i + 1; j < n; j++){
 	add_edge(&a_bld, i, j, NULL, bern, &b);
       }
     }
-    t = clock() - t;
+    bench_stop(&bt);
     printf("\t\tvertices: %lu, "
-	   "directed edges: %lu, "
-	   "build time: %.6f seconds\n",
+	   "directed edges: %lu\n",
 	   TOLU(a_bld.num_vts),
-	   TOLU(a_bld.num_es),
-	   (float)t / CLOCKS_PER_SEC);
+	   TOLU(a_bld.num_es));
+    report(&bt, "\t\t\tbuild time: ", &a_bld);
+    bench_free(&bt);
     fflush(stdout);
     /* sum test; wraps around */
     for (i = 0; i < n; i++){
@@ -552,6 +576,12 @@ void print_adj_lst(const adj_lst_t *a, void (*print_wt)(const void *)){
   }
 }
 
+void report(const bench_t *b, const char *label, const adj_lst_t *a){
+  char params[64];
+  sprintf(params, "vts=%lu es=%lu", TOLU(a->num_vts), TOLU(a->num_es));
+  bench_report(b, label, params);
+}
+
 void print_test_result(int res){
   if (res){
     printf("SUCCESS\n");
@@ -27,12 +27,30 @@
    performance was recorded in tests of bfs and dfs on unweighted graphs.
 */
 
+#define UTILITIES_MEM_TAG MEM_TAG_GRAPH
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "graph.h"
 #include "stack.h"
 #include "utilities-mem.h"
+#include "utilities-perf.h"
+
+/**
+   The array of stack pointers of an adjacency list is allocated with
+   huge_malloc_perror if GRAPH_HUGE is defined, and with malloc_perror
+   otherwise.
+*/
+#ifdef GRAPH_HUGE
+#define VT_WTS_MALLOC(num, size) huge_malloc_perror((num), (size))
+#define VT_WTS_FREE(ptr) aligned_free(ptr)
+#define VT_WTS_OVERHEAD(ptr, size) mem_aligned_overhead(ptr)
+#else
+#define VT_WTS_MALLOC(num, size) malloc_perror((num), (size))
+#define VT_WTS_FREE(ptr) free(ptr)
+#define VT_WTS_OVERHEAD(ptr, size) mem_block_overhead(size)
+#endif
 
 static void *wt_ptr(const graph_t *g, size_t i);
 
@@ -94,7 +112,7 @@ void adj_lst_init(adj_lst_t *a, const graph_t *g){
   a->buf = malloc_perror(1, a->pair_size);
   a->vt_wts = NULL;
   if (a->num_vts > 0){
-    a->vt_wts = malloc_perror(a->num_vts, sizeof(stack_t *));
+    a->vt_wts = VT_WTS_MALLOC(a->num_vts, sizeof(stack_t *));
   }
   /* initialize stacks */
   for (i = 0; i < a->num_vts; i++){
@@ -108,6 +126,7 @@ void adj_lst_init(adj_lst_t *a, const graph_t *g){
 */
 void adj_lst_dir_build(adj_lst_t *a, const graph_t *g){
   size_t i;
+  PERF_REGION_START(PERF_REG_ADJ_BUILD);
   for (i = 0; i < g->num_es; i++){
     memcpy(a->buf, &g->v[i], sizeof(size_t));
     if (a->wt_size > 0){
@@ -116,6 +135,7 @@ void adj_lst_dir_build(adj_lst_t *a, const graph_t *g){
     stack_push(a->vt_wts[g->u[i]], a->buf);
     a->num_es++;
   }
+  PERF_REGION_STOP(PERF_REG_ADJ_BUILD);
 }
 
 /**
@@ -123,6 +143,7 @@ void adj_lst_dir_build(adj_lst_t *a, const graph_t *g){
 */
 void adj_lst_undir_build(adj_lst_t *a, const graph_t *g){
   size_t i;
+  PERF_REGION_START(PERF_REG_ADJ_BUILD);
   for (i = 0; i < g->num_es; i++){
     memcpy(a->buf, &g->v[i], sizeof(size_t));
     if (a->wt_size > 0){
@@ -133,6 +154,7 @@ void adj_lst_undir_build(adj_lst_t *a, const graph_t *g){
     stack_push(a->vt_wts[g->v[i]], a->buf);
     a->num_es += 2;
   }
+  PERF_REGION_STOP(PERF_REG_ADJ_BUILD);
 }
 
 /**
@@ -193,6 +215,7 @@ void adj_lst_rand_dir(adj_lst_t *a,
 		      void *arg){
   size_t i, j;
   graph_t g;
+  PERF_REGION_START(PERF_REG_ADJ_BUILD);
   graph_base_init(&g, n, 0);
   adj_lst_init(a, &g);
   if (n > 0){
@@ -203,6 +226,7 @@ void adj_lst_rand_dir(adj_lst_t *a,
       }
     }
   }
+  PERF_REGION_STOP(PERF_REG_ADJ_BUILD);
 }
 
 /**
@@ -217,6 +241,7 @@ void adj_lst_rand_undir(adj_lst_t *a,
 			void *arg){
   size_t i, j;
   graph_t g;
+  PERF_REGION_START(PERF_REG_ADJ_BUILD);
   graph_base_init(&g, n, 0);
   adj_lst_init(a, &g);
   if (n > 0){
@@ -226,6 +251,7 @@ void adj_lst_rand_undir(adj_lst_t *a,
       }
     }
   }
+  PERF_REGION_STOP(PERF_REG_ADJ_BUILD);
 }
 
 /**
@@ -240,11 +266,38 @@ void adj_lst_free(adj_lst_t *a){
     a->vt_wts[i] = NULL;
   }
   free(a->buf);
-  free(a->vt_wts); /* free(NULL) performs no operation */
+  VT_WTS_FREE(a->vt_wts); /* NULL is a no-op for both */
   a->buf = NULL;
   a->vt_wts = NULL;
 }
 
+/**
+   Computes the memory footprint of an adjacency list, including the block
+   of size sizeof(adj_lst_t) pointed to by the a parameter.
+*/
+void adj_lst_footprint(const adj_lst_t *a, mem_footprint_t *f){
+  size_t i;
+  size_t pad_size = a->pair_size - sizeof(size_t) - a->wt_size;
+  mem_footprint_t sf;
+  f->payload = 0;
+  f->overhead = (sizeof(adj_lst_t) +
+		 a->pair_size +
+		 mem_block_overhead(a->pair_size)); /* buf */
+  f->slack = 0;
+  if (a->num_vts > 0){
+    f->overhead += (a->num_vts * sizeof(stack_t *) +
+		    VT_WTS_OVERHEAD(a->vt_wts, a->num_vts * sizeof(stack_t *)));
+  }
+  for (i = 0; i < a->num_vts; i++){
+    stack_footprint(a->vt_wts[i], &sf);
+    f->payload += sf.payload - a->vt_wts[i]->num_elts * pad_size;
+    f->overhead += (sf.overhead +
+		    a->vt_wts[i]->num_elts * pad_size +
+		    mem_block_overhead(sizeof(stack_t)));
+    f->slack += sf.slack;
+  }
+}
+
 /** Helper functions */
 
 static void *wt_ptr(const graph_t *g, size_t i){
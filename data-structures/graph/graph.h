@@ -17,6 +17,12 @@
    sizeof(size_t) and the size of a generic weight are powers of two.
    The size of weight can also be 0.
 
+   The array of stack pointers of an adjacency list is allocated with
+   malloc_perror. If GRAPH_HUGE is defined when graph.c is compiled, e.g.
+   by "make clean-all && make CPPFLAGS=-DGRAPH_HUGE", the array is
+   allocated with huge_malloc_perror of utilities-mem, which backs the
+   array of a graph with many vertices with huge pages where available.
+
    Optimization:
 
    -  The implementation resulted in upto 1.3 - 1.4x speedups for dijkstra
@@ -82,6 +88,18 @@ void adj_lst_init(adj_lst_t *a, const graph_t *g);
 */
 void adj_lst_free(adj_lst_t *a);
 
+/**
+   Computes the memory footprint of an adjacency list, including the block
+   of size sizeof(adj_lst_t) pointed to by the a parameter. The payload
+   consists of the adjacent vertices and the weights. The padding of the
+   vertex weight pairs is overhead, and the unused capacity of the stacks
+   is slack.
+   a           : pointer to an initialized adjacency list
+   f           : pointer to a preallocated block of size
+                 sizeof(mem_footprint_t)
+*/
+void adj_lst_footprint(const adj_lst_t *a, mem_footprint_t *f);
+
 /**
    Builds the adjacency list of a directed graph.
 */
@@ -32,6 +32,10 @@
    argument must be specified for i >= 0. Default values are used for the
    unspecified arguments according to the C_ARGS_DEF array.
 
+   The runtimes are measured with utilities-bench and can be written as
+   csv or json records by setting BENCH_FORMAT and BENCH_OUT, e.g.
+   BENCH_FORMAT=json BENCH_OUT=heap.json ./heap-test 20 1 0 10 10 0 0
+
    The implementation of tests does not use stdint.h and is portable under
    C89/C90 and C99 with the only requirement that CHAR_BIT * sizeof(size_t)
    is greater or equal to 16 and is even.
@@ -41,12 +45,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
-#include <time.h>
 #include "heap.h"
 #include "ht-divchn.h"
 #include "ht-muloa.h"
+#include "utilities-bench.h"
 #include "utilities-mem.h"
 #include "utilities-mod.h"
+#include "utilities-perf.h"
 
 #define TOLU(i) ((unsigned long int)(i)) /* printing size_t under C89/C90 */
 
@@ -67,6 +72,7 @@ const size_t C_ARGS_DEF[9] = {14, 1, 0, 341, 10, 1, 1, 1, 1};
 const size_t C_FULL_BIT = CHAR_BIT * sizeof(size_t);
 
 /* tests */
+const char *C_SUITE = "heap-test";
 const int C_PTY_TYPES_COUNT = 3;
 const char *C_PTY_TYPES[3] = {"size_t", "double", "long double"};
 const size_t C_PTY_SIZES[3] = {sizeof(size_t),
@@ -107,6 +113,7 @@ void update_search(size_t num_ins,
 		   void (*new_elt)(void *, size_t),
 		   void (*free_elt)(void *));
 void *ptr(const void *block, size_t i, size_t size);
+void report(const bench_t *b, const char *label, size_t count);
 void print_test_result(int res);
 
 /**
@@ -600,27 +607,34 @@ void push_ptys_elts(heap_t *h,
   const char *p = NULL, *p_start = NULL, *p_end = NULL;
   size_t half_count;
   size_t n = h->num_elts;
-  clock_t t_first, t_second;
+  bench_t b_first, b_second;
+  mem_footprint_t f;
   half_count = count >> 1;  /* count > 0 */
   p_start = pty_elts;
   p_end = ptr(pty_elts, half_count, h->pair_size);
-  t_first = clock();
+  bench_init(&b_first, C_SUITE, "push 1/2 elements", 0, 1);
+  bench_start(&b_first);
   for (p = p_start; p != p_end; p += h->pair_size){
     heap_push(h, p, p + h->pty_size);
   }
-  t_first = clock() - t_first;
+  bench_stop(&b_first);
   p_start = ptr(pty_elts, half_count, h->pair_size);
   p_end = ptr(pty_elts, count, h->pair_size);
-  t_second = clock();
+  bench_init(&b_second, C_SUITE, "push residual elements", 0, 1);
+  bench_start(&b_second);
   for (p = p_start; p != p_end; p += h->pair_size){
     heap_push(h, p, p + h->pty_size);
   }
-  t_second = clock() - t_second;
-  printf("\t\tpush 1/2 elements:                           "
-	 "%.4f seconds\n", (float)t_first / CLOCKS_PER_SEC);
-  printf("\t\tpush residual elements:                      "
-	 "%.4f seconds\n", (float)t_second / CLOCKS_PER_SEC);
+  bench_stop(&b_second);
+  report(&b_first, "\t\tpush 1/2 elements:                           ", count);
+  bench_free(&b_first);
+  report(&b_second, "\t\tpush residual elements:                      ", count);
+  bench_free(&b_second);
   *res *= (h->num_elts == n + count);
+  heap_footprint(h, &f);
+  *res *= (f.payload == h->num_elts * h->pair_size);
+  *res *= (f.payload + f.slack == h->count * h->pair_size);
+  *res *= (f.overhead >= sizeof(heap_t) + 2 * h->pair_size);
 }
 
 void push_rev_ptys_elts(heap_t *h,
@@ -630,27 +644,29 @@ void push_rev_ptys_elts(heap_t *h,
   const char *p = NULL, *p_start = NULL, *p_end = NULL;
   size_t half_count;
   size_t n = h->num_elts;
-  clock_t t_first, t_second;
+  bench_t b_first, b_second;
   half_count = count >> 1;
   /* backwards pointer iteration; count > 0 */
   p_start = ptr(pty_elts, count - 1, h->pair_size);
   p_end = ptr(pty_elts, half_count, h->pair_size);
-  t_first = clock();
+  bench_init(&b_first, C_SUITE, "push 1/2 elements rev", 0, 1);
+  bench_start(&b_first);
   for (p = p_start; p != p_end; p -= h->pair_size){
     heap_push(h, p, p + h->pty_size);
   }
-  t_first = clock() - t_first;
+  bench_stop(&b_first);
   p_start = ptr(pty_elts, half_count, h->pair_size);
   p_end = pty_elts;
-  t_second = clock();
+  bench_init(&b_second, C_SUITE, "push residual elements rev", 0, 1);
+  bench_start(&b_second);
   for (p = p_start; p >= p_end; p -= h->pair_size){
     heap_push(h, p, p + h->pty_size);
   }
-  t_second = clock() - t_second;
-  printf("\t\tpush 1/2 elements, rev. pty order:           "
-	 "%.4f seconds\n", (float)t_first / CLOCKS_PER_SEC);
-  printf("\t\tpush residual elements, rev. pty order:      "
-	 "%.4f seconds\n", (float)t_second / CLOCKS_PER_SEC);
+  bench_stop(&b_second);
+  report(&b_first, "\t\tpush 1/2 elements, rev. pty order:           ", count);
+  bench_free(&b_first);
+  report(&b_second, "\t\tpush residual elements, rev. pty order:      ", count);
+  bench_free(&b_second);
   *res *= (h->num_elts == n + count);
 }
 
@@ -664,23 +680,25 @@ void pop_ptys_elts(heap_t *h,
   size_t i, half_count;
   size_t n = h->num_elts;
   void *pop_pty_elts = NULL;
-  clock_t t_first, t_second;
+  bench_t b_first, b_second;
   half_count = count >> 1; /* count > 0 */
   pop_pty_elts = malloc_perror(count, h->pair_size);
   p_start = pop_pty_elts;
   p_end = ptr(pop_pty_elts, half_count, h->pair_size);
-  t_first = clock();
+  bench_init(&b_first, C_SUITE, "pop 1/2 elements", 0, 1);
+  bench_start(&b_first);
   for (p = p_start; p != p_end; p += h->pair_size){
     heap_pop(h, p, p + h->pty_size);
   }
-  t_first = clock() - t_first;
+  bench_stop(&b_first);
   p_start = ptr(pop_pty_elts, half_count, h->pair_size);
   p_end = ptr(pop_pty_elts, count, h->pair_size);
-  t_second = clock();
+  bench_init(&b_second, C_SUITE, "pop residual elements", 0, 1);
+  bench_start(&b_second);
   for (p = p_start; p != p_end; p += h->pair_size){
     heap_pop(h, p, p + h->pty_size);
   }
-  t_second = clock() - t_second;
+  bench_stop(&b_second);
   *res *= (h->num_elts == n - count);
   for (i = 0; i < count; i++){
     if (i == 0){
@@ -696,21 +714,23 @@ void pop_ptys_elts(heap_t *h,
 		 (char *)ptr(pty_elts, i, h->pair_size) + h->pty_size) == 0);
     }
   }
-  printf("\t\tpop 1/2 elements:                            "
-	 "%.4f seconds\n", (float)t_first / CLOCKS_PER_SEC);
-  printf("\t\tpop residual elements:                       "
-	 "%.4f seconds\n", (float)t_second / CLOCKS_PER_SEC);
+  report(&b_first, "\t\tpop 1/2 elements:                            ", count);
+  bench_free(&b_first);
+  report(&b_second, "\t\tpop residual elements:                       ", count);
+  bench_free(&b_second);
   free(pop_pty_elts);
   pop_pty_elts = NULL;
 }
 
 void free_heap(heap_t *h){
-  clock_t t;
-  t = clock();
+  size_t n = h->num_elts;
+  bench_t b;
+  bench_init(&b, C_SUITE, "free", 0, 1);
+  bench_start(&b);
   heap_free(h);
-  t = clock() - t;
-  printf("\t\tfree time:                                   "
-	 "%.4f seconds\n", (float)t / CLOCKS_PER_SEC);
+  bench_stop(&b);
+  report(&b, "\t\tfree time:                                   ", n);
+  bench_free(&b);
 }
 
 /** 
@@ -724,26 +744,28 @@ void update_ptys_elts(heap_t *h,
   const char *p = NULL, *p_start = NULL, *p_end = NULL;
   size_t half_count = count >> 1;
   size_t n = h->num_elts;
-  clock_t t_first, t_second;
+  bench_t b_first, b_second;
   p_start = pty_elts;
   p_end = ptr(pty_elts, half_count, h->pair_size);
-  t_first = clock();
+  bench_init(&b_first, C_SUITE, "update 1/2 elements", 0, 1);
+  bench_start(&b_first);
   for (p = p_start; p != p_end; p += h->pair_size){
     heap_update(h, p, p + h->pty_size);
   }
-  t_first = clock() - t_first;
+  bench_stop(&b_first);
   *res *= (h->num_elts == n);
   p_start = ptr(pty_elts, half_count, h->pair_size);
   p_end = ptr(pty_elts, count, h->pair_size);
-  t_second = clock();
+  bench_init(&b_second, C_SUITE, "update residual elements", 0, 1);
+  bench_start(&b_second);
   for (p = p_start; p != p_end; p += h->pair_size){
     heap_update(h, p, p + h->pty_size);
   }
-  t_second = clock() - t_second;
-  printf("\t\tupdate 1/2 elements:                         "
-	 "%.4f seconds\n", (float)t_first / CLOCKS_PER_SEC);
-  printf("\t\tupdate residual elements:                    "
-	 "%.4f seconds\n", (float)t_second / CLOCKS_PER_SEC);
+  bench_stop(&b_second);
+  report(&b_first, "\t\tupdate 1/2 elements:                         ", count);
+  bench_free(&b_first);
+  report(&b_second, "\t\tupdate residual elements:                    ", count);
+  bench_free(&b_second);
   *res *= (h->num_elts == n);
 }
 
@@ -755,14 +777,15 @@ void search_ptys_elts(const heap_t *h,
   const char *p = NULL, *p_start = NULL, *p_end = NULL;
   size_t n = h->num_elts;
   void *rp = NULL;
-  clock_t t_heap, t_not_heap;
+  bench_t b_heap, b_not_heap;
   p_start = pty_elts;
   p_end = ptr(pty_elts, count, h->pair_size);
-  t_heap = clock();
+  bench_init(&b_heap, C_SUITE, "in heap search", 0, 1);
+  bench_start(&b_heap);
   for (p = p_start; p != p_end; p += h->pair_size){
     rp = heap_search(h, p + h->pty_size);
   }
-  t_heap = clock() - t_heap;
+  bench_stop(&b_heap);
   for (p = p_start; p != p_end; p += h->pair_size){
     rp = heap_search(h, p + h->pty_size);
     *res *= (rp != NULL);
@@ -770,19 +793,21 @@ void search_ptys_elts(const heap_t *h,
   *res *= (h->num_elts == n);
   p_start = not_heap_elts;
   p_end = ptr(not_heap_elts, count, h->elt_size);
-  t_not_heap = clock();
+  bench_init(&b_not_heap, C_SUITE, "not in heap search", 0, 1);
+  bench_start(&b_not_heap);
   for (p = p_start; p != p_end; p += h->elt_size){
     rp = heap_search(h, p);
   }
-  t_not_heap = clock() - t_not_heap;
+  bench_stop(&b_not_heap);
   for (p = p_start; p != p_end; p += h->elt_size){
     rp = heap_search(h, p);
     *res *= (rp == NULL);
   }
-  printf("\t\tin heap search:                              "
-	 "%.4f seconds\n", (float)t_heap / CLOCKS_PER_SEC);
-  printf("\t\tnot in heap search:                          "
-	 "%.4f seconds\n", (float)t_not_heap / CLOCKS_PER_SEC);
+  report(&b_heap, "\t\tin heap search:                              ", count);
+  bench_free(&b_heap);
+  report(&b_not_heap, "\t\tnot in heap search:                          ",
+                      count);
+  bench_free(&b_not_heap);
 }
 
 /** 
@@ -884,6 +909,12 @@ void *ptr(const void *block, size_t i, size_t size){
 /**
    Prints a test result.
 */
+void report(const bench_t *b, const char *label, size_t count){
+  char params[64];
+  sprintf(params, "n=%lu", TOLU(count));
+  bench_report(b, label, params);
+}
+
 void print_test_result(int res){
   if (res){
     printf("SUCCESS\n");
@@ -933,6 +964,12 @@ int main(int argc, char *argv[]){
     run_update_search_muloa_uint_test(args[0], args[3], args[4]);
     run_update_search_muloa_uint_ptr_test(args[0], args[3], args[4]);
   }
+#ifdef UTILITIES_MEM_ACCOUNT
+  mem_report();
+#endif
+#ifdef UTILITIES_PERF_REGIONS
+  perf_region_report();
+#endif
   free(args);
   args = NULL;
   return 0;
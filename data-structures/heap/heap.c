@@ -29,11 +29,28 @@
    readability.
 */
 
+#define UTILITIES_MEM_TAG MEM_TAG_HEAP
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "heap.h"
 #include "utilities-mem.h"
+#include "utilities-perf.h"
+
+/**
+   The priority-element pairs are allocated with huge_malloc_perror if
+   HEAP_HUGE is defined, and with malloc_perror otherwise.
+*/
+#ifdef HEAP_HUGE
+#define PTY_ELTS_MALLOC(num, size) huge_malloc_perror((num), (size))
+#define PTY_ELTS_FREE(ptr) aligned_free(ptr)
+#define PTY_ELTS_OVERHEAD(ptr, size) mem_aligned_overhead(ptr)
+#else
+#define PTY_ELTS_MALLOC(num, size) malloc_perror((num), (size))
+#define PTY_ELTS_FREE(ptr) free(ptr)
+#define PTY_ELTS_OVERHEAD(ptr, size) mem_block_overhead(size)
+#endif
 
 static void swap(heap_t *h, size_t i, size_t j);
 static void half_swap(heap_t *h, size_t t, size_t s);
@@ -90,7 +107,7 @@ void heap_init(heap_t *h,
   h->pty_size = pty_size;
   h->elt_size = elt_size;
   h->pair_size = add_sz_perror(pty_size, elt_size);
-  h->pty_elts = malloc_perror(init_count, h->pair_size);
+  h->pty_elts = PTY_ELTS_MALLOC(init_count, h->pair_size);
   h->buf = malloc_perror(2, h->pair_size); /* 1st heapify, 2nd swap */
   h->hht = hht;
   h->cmp_pty = cmp_pty;
@@ -113,12 +130,14 @@ void heap_init(heap_t *h,
 */
 void heap_push(heap_t *h, const void *pty, const void *elt){
   size_t ix = h->num_elts;
+  PERF_REGION_START(PERF_REG_HEAP);
   if (h->count == ix) heap_grow(h);
   memcpy(pty_ptr(h, ix), pty, h->pty_size);
   memcpy(elt_ptr(h, ix), elt, h->elt_size);
   h->hht->insert(h->hht->ht, elt, &ix);
   h->num_elts++;
   heapify_up(h, ix);
+  PERF_REGION_STOP(PERF_REG_HEAP);
 }
 
 /** 
@@ -146,10 +165,13 @@ void *heap_search(const heap_t *h, const void *elt){
    specification in heap_push.
 */
 void heap_update(heap_t *h, const void *pty, const void *elt){
-  size_t ix = *(const size_t *)h->hht->search(h->hht->ht, elt);
+  size_t ix;
+  PERF_REGION_START(PERF_REG_HEAP);
+  ix = *(const size_t *)h->hht->search(h->hht->ht, elt);
   memcpy(pty_ptr(h, ix), pty, h->pty_size);
   heapify_up(h, ix);
   heapify_down(h, ix);
+  PERF_REGION_STOP(PERF_REG_HEAP);
 }
 
 /**
@@ -161,12 +183,14 @@ void heap_update(heap_t *h, const void *pty, const void *elt){
 void heap_pop(heap_t *h, void *pty, void *elt){
   size_t ix_buf, ix = 0;
   if (h->num_elts == 0) return;
+  PERF_REGION_START(PERF_REG_HEAP);
   memcpy(pty, pty_ptr(h, ix), h->pty_size);
   memcpy(elt, elt_ptr(h, ix), h->elt_size);
   swap(h, ix, h->num_elts - 1);
   h->hht->remove(h->hht->ht, elt, &ix_buf);
   h->num_elts--;
   if (h->num_elts > 0) heapify_down(h, ix);
+  PERF_REGION_STOP(PERF_REG_HEAP);
 }
 
 /**
@@ -180,13 +204,27 @@ void heap_free(heap_t *h){
       h->free_elt(elt_ptr(h, i));
     } 
   }
-  free(h->pty_elts);
+  PTY_ELTS_FREE(h->pty_elts);
   free(h->buf);
-  h->hht->free(h->hht->ht);
+  (h->hht->free)(h->hht->ht);
   h->pty_elts = NULL;
   h->buf = NULL;
 }
 
+/**
+   Computes the memory footprint of a heap, without its hash table,
+   including the block of size sizeof(heap_t) pointed to by the h
+   parameter.
+*/
+void heap_footprint(const heap_t *h, mem_footprint_t *f){
+  f->payload = h->num_elts * h->pair_size;
+  f->overhead = (sizeof(heap_t) +
+		 PTY_ELTS_OVERHEAD(h->pty_elts, h->count * h->pair_size) +
+		 2 * h->pair_size +
+		 mem_block_overhead(2 * h->pair_size)); /* buf */
+  f->slack = (h->count - h->num_elts) * h->pair_size;
+}
+
 /** Helper functions */
 
 /**
@@ -216,9 +254,14 @@ static void half_swap(heap_t *h, size_t t, size_t s){
 /**
    Doubles the size of a heap upto the maximal heap count. Amortized
    constant overhead per push operation, without considering realloc's
-   search of the memory heap.
+   search of the memory heap. If HEAP_HUGE is defined, the pairs are
+   copied to a new huge block, because an aligned block is not resized
+   with realloc.
 */
 static void heap_grow(heap_t *h){
+#ifdef HEAP_HUGE
+  void *prev_pty_elts = h->pty_elts;
+#endif
   if (h->count == h->count_max){
     fprintf_stderr_exit("tried to exceed the count maximum", __LINE__);
   }
@@ -227,7 +270,14 @@ static void heap_grow(heap_t *h){
   }else{
     h->count *= 2;
   }
+#ifdef HEAP_HUGE
+  h->pty_elts = huge_malloc_perror(h->count, h->pair_size);
+  memcpy(h->pty_elts, prev_pty_elts, h->num_elts * h->pair_size);
+  aligned_free(prev_pty_elts);
+  prev_pty_elts = NULL;
+#else
   h->pty_elts = realloc_perror(h->pty_elts, h->count, h->pair_size);
+#endif
 }
 
 /**
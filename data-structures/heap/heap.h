@@ -20,12 +20,20 @@
    represented by its unique pointer, this invariant only prevents
    associating a given element in memory with more than one priority
    value in a heap.
+
+   The priority-element pairs are allocated with malloc_perror and grown
+   with realloc_perror. If HEAP_HUGE is defined when heap.c is compiled,
+   e.g. by "make clean-all && make CPPFLAGS=-DHEAP_HUGE", the pairs are
+   allocated with huge_malloc_perror of utilities-mem and copied to a new
+   block when the heap grows, which backs a large heap with huge pages
+   where available.
 */
 
 #ifndef HEAP_H  
 #define HEAP_H
 
 #include <stddef.h>
+#include "utilities-mem.h"
 
 typedef void (*heap_ht_init)(void *,
 			     size_t,
@@ -147,6 +155,19 @@ void heap_pop(heap_t *h, void *pty, void *elt);
 */
 void heap_free(heap_t *h);
 
+/**
+   Computes the memory footprint of a heap, including the block of size
+   sizeof(heap_t) pointed to by the h parameter. The payload consists of
+   the priority element pairs, or of the priorities and the pointers to
+   noncontiguous elements, and the slack of the unused capacity of the
+   doubling pair array. The hash table of the heap is not included, and its
+   footprint is computed by the footprint function of the hash table.
+   h           : pointer to an initialized heap
+   f           : pointer to a preallocated block of size
+                 sizeof(mem_footprint_t)
+*/
+void heap_footprint(const heap_t *h, mem_footprint_t *f);
+
 /**
    Sets the heap count maximum that may be reached, if possible, as a heap
    grows by repetitive doubling from its initial count and by adding, if
@@ -31,6 +31,10 @@
    argument must be specified for i >= 0. Default values are used for the
    unspecified arguments according to the C_ARGS_DEF array.
 
+   The runtimes are measured with utilities-bench. A search is repeated
+   and the median of the repetitions is printed. The runtimes can be
+   written as csv or json records by setting BENCH_FORMAT and BENCH_OUT.
+
    The implementation of tests does not use stdint.h and is portable under
    C89/C90 and C99 with the only requirement that CHAR_BIT * sizeof(size_t)
    is greater or equal to 16 and is even.
@@ -42,6 +46,7 @@
 #include <limits.h>
 #include <time.h>
 #include "ht-divchn.h"
+#include "utilities-bench.h"
 #include "dll.h"
 #include "utilities-mem.h"
 #include "utilities-mod.h"
@@ -52,7 +57,11 @@
    be the case on older rand() implementations, and on current
    implementations on different systems.
 */
+#ifdef TEST_SEED
+#define RGENS_SEED() do{srand(TEST_SEED);}while (0)
+#else
 #define RGENS_SEED() do{srand(time(NULL));}while (0)
+#endif
 #define RANDOM() (rand()) /* [0, RAND_MAX] */
 #define DRAND() ((double)rand() / RAND_MAX) /* [0.0, 1.0] */
 
@@ -79,7 +88,10 @@ const size_t C_SIZE_MAX = (size_t)-1;
 const size_t C_FULL_BIT = CHAR_BIT * sizeof(size_t);
 
 /* insert, search, free, remove, delete tests */
+const char *C_SUITE = "ht-divchn-test";
 const size_t C_KEY_SIZE_FACTOR = sizeof(size_t);
+const size_t C_SEARCH_WARMUPS = 1;
+const size_t C_SEARCH_REPS = 3;
 
 /* corner cases test */
 const size_t C_CORNER_LOG_KEY_START = 0;
@@ -105,6 +117,10 @@ void remove_delete(size_t num_ins,
 		   size_t (*val_elt)(const void *),
 		   void (*free_elt)(void *));
 void *ptr(const void *block, size_t i, size_t size);
+void report(const bench_t *b,
+	    const char *label,
+	    const ht_divchn_t *ht,
+	    size_t count);
 void print_test_result(int res);
 
 /**
@@ -343,21 +359,23 @@ void insert_keys_elts(ht_divchn_t *ht,
   const char *p = NULL, *p_start = NULL, *p_end = NULL;
   size_t n = ht->num_elts;
   size_t init_count = ht->count;
-  clock_t t;
+  bench_t b;
   p_start = key_elts;
   p_end = ptr(key_elts, count, ht->pair_size);
-  t = clock();
+  bench_init(&b, C_SUITE, "insert", 0, 1);
+  bench_start(&b);
   for (p = p_start; p != p_end; p += ht->pair_size){
     ht_divchn_insert(ht, p, p + ht->key_size);
   }
-  t = clock() - t;
+  bench_stop(&b);
   if (init_count < ht->count){
-    printf("\t\tinsert w/ growth time           "
-	   "%.4f seconds\n", (float)t / CLOCKS_PER_SEC);
+    b.name = "insert w/ growth";
+    report(&b, "\t\tinsert w/ growth time           ", ht, count);
   }else{
-    printf("\t\tinsert w/o growth time          "
-	   "%.4f seconds\n", (float)t / CLOCKS_PER_SEC);
+    b.name = "insert w/o growth";
+    report(&b, "\t\tinsert w/o growth time          ", ht, count);
   }
+  bench_free(&b);
   *res *= (ht->num_elts == n + count);
 }
 
@@ -369,21 +387,33 @@ void search_in_ht(const ht_divchn_t *ht,
   const char *p = NULL, *p_start = NULL, *p_end = NULL;
   size_t n = ht->num_elts;
   const void *elt = NULL;
-  clock_t t;
+  size_t i;
+  bench_t b;
+  mem_footprint_t f;
   p_start = key_elts;
   p_end = ptr(key_elts, count, ht->pair_size);
-  t = clock();
-  for (p = p_start; p != p_end; p += ht->pair_size){
-    elt = ht_divchn_search(ht, p);
+  bench_init(&b, C_SUITE, "in ht search", C_SEARCH_WARMUPS, C_SEARCH_REPS);
+  for (i = 0; i < b.num_warmups + b.num_reps; i++){
+    bench_start(&b);
+    for (p = p_start; p != p_end; p += ht->pair_size){
+      elt = ht_divchn_search(ht, p);
+    }
+    bench_stop(&b);
   }
-  t = clock() - t;
   for (p = p_start; p != p_end; p += ht->pair_size){
     elt = ht_divchn_search(ht, p);
     *res *= (val_elt(p + ht->key_size) == val_elt(elt));
+    *res *= (ht_divchn_probes(ht, p) >= 1 &&
+	     ht_divchn_probes(ht, p) <= ht->num_elts);
   }
-  printf("\t\tin ht search time:              "
-	 "%.4f seconds\n", (float)t / CLOCKS_PER_SEC);
+  report(&b, "\t\tin ht search time:              ", ht, count);
+  bench_free(&b);
   *res *= (ht->num_elts == n);
+  ht_divchn_footprint(ht, &f);
+  *res *= (f.payload == ht->num_elts * ht->pair_size);
+  *res *= (f.slack <= ht->count * sizeof(dll_node_t *));
+  *res *= (f.overhead >= sizeof(ht_divchn_t) +
+	   ht->num_elts * sizeof(dll_node_t));
 }
 
 void search_nin_ht(const ht_divchn_t *ht,
@@ -393,30 +423,38 @@ void search_nin_ht(const ht_divchn_t *ht,
   const char *p = NULL, *p_start = NULL, *p_end = NULL;
   size_t n = ht->num_elts;
   const void *elt = NULL;
-  clock_t t;
+  size_t i;
+  bench_t b;
   p_start = nin_keys;
   p_end = ptr(nin_keys, count, ht->key_size);
-  t = clock();
-  for (p = p_start; p != p_end; p += ht->key_size){
-    elt = ht_divchn_search(ht, p);
+  bench_init(&b, C_SUITE, "not in ht search", C_SEARCH_WARMUPS,
+	     C_SEARCH_REPS);
+  for (i = 0; i < b.num_warmups + b.num_reps; i++){
+    bench_start(&b);
+    for (p = p_start; p != p_end; p += ht->key_size){
+      elt = ht_divchn_search(ht, p);
+    }
+    bench_stop(&b);
   }
-  t = clock() - t;
   for (p = p_start; p != p_end; p += ht->key_size){
     elt = ht_divchn_search(ht, p);
     *res *= (elt == NULL);
+    *res *= (ht_divchn_probes(ht, p) <= ht->num_elts);
   }
-  printf("\t\tnot in ht search time:          "
-	 "%.4f seconds\n", (float)t / CLOCKS_PER_SEC);
+  report(&b, "\t\tnot in ht search time:          ", ht, count);
+  bench_free(&b);
   *res *= (ht->num_elts == n);
 }
 
 void free_ht(ht_divchn_t *ht){
-  clock_t t;
-  t = clock();
+  size_t count = ht->num_elts;
+  bench_t b;
+  bench_init(&b, C_SUITE, "free", 0, 1);
+  bench_start(&b);
   ht_divchn_free(ht);
-  t = clock() - t;
-  printf("\t\tfree time:                      "
-	 "%.4f seconds\n", (float)t / CLOCKS_PER_SEC);
+  bench_stop(&b);
+  report(&b, "\t\tfree time:                      ", ht, count);
+  bench_free(&b);
 }
 
 void insert_search_free(size_t num_ins,
@@ -501,16 +539,17 @@ void remove_key_elts(ht_divchn_t *ht,
   size_t step_size = mul_sz_perror(2, ht->pair_size);
   size_t i;
   void *elt = NULL;
-  clock_t t_first_half, t_second_half;
+  bench_t b_first_half, b_second_half;
   elt = malloc_perror(1, ht->elt_size);
   p = key_elts;
-  t_first_half = clock();
+  bench_init(&b_first_half, C_SUITE, "remove 1/2 elements", 0, 1);
+  bench_start(&b_first_half);
   for (i = 0; i < count; i += 2){ /* count < SIZE_MAX */
     p += (i > 0) * step_size; /* avoid undef. behavior of pointer increment */
     ht_divchn_remove(ht, p, elt);
     /* noncontiguous element is still accessible from key_elts */
   }
-  t_first_half = clock() - t_first_half;
+  bench_stop(&b_first_half);
   *res *= (ht->num_elts == ((count & 1) ?
 			    (n - count / 2 - 1) :
 			    (n - count / 2)));
@@ -525,13 +564,14 @@ void remove_key_elts(ht_divchn_t *ht,
     }
   }
   p = ptr(key_elts, (count > 0), ht->pair_size);
-  t_second_half = clock();
+  bench_init(&b_second_half, C_SUITE, "remove residual elements", 0, 1);
+  bench_start(&b_second_half);
   for (i = 1; i < count; i += 2){ /* count < SIZE_MAX */
     p += (i > 1) * step_size; /* avoid undef. behavior of pointer increment */
     ht_divchn_remove(ht, p, elt);
     /* noncontiguous element is still accessible from key_elts */
   }
-  t_second_half = clock() - t_second_half;
+  bench_stop(&b_second_half);
   *res *= (ht->num_elts == 0);
   p_start = key_elts;
   p_end = ptr(key_elts, count, ht->pair_size);
@@ -541,10 +581,12 @@ void remove_key_elts(ht_divchn_t *ht,
   for (i = 0; i < ht->count; i++){
     *res *= (ht->key_elts[i] == NULL);
   }
-  printf("\t\tremove 1/2 elements time:       "
-	 "%.4f seconds\n", (float)t_first_half / CLOCKS_PER_SEC);
-  printf("\t\tremove residual elements time:  "
-	 "%.4f seconds\n", (float)t_second_half / CLOCKS_PER_SEC);
+  report(&b_first_half, "\t\tremove 1/2 elements time:       ",
+	 ht, count);
+  report(&b_second_half, "\t\tremove residual elements time:  ",
+	 ht, count);
+  bench_free(&b_first_half);
+  bench_free(&b_second_half);
   free(elt);
   elt = NULL;
 }
@@ -558,14 +600,15 @@ void delete_key_elts(ht_divchn_t *ht,
   size_t n = ht->num_elts;
   size_t step_size = mul_sz_perror(2, ht->pair_size);
   size_t i;
-  clock_t t_first_half, t_second_half;
+  bench_t b_first_half, b_second_half;
   p = key_elts;
-  t_first_half = clock();
+  bench_init(&b_first_half, C_SUITE, "delete 1/2 elements", 0, 1);
+  bench_start(&b_first_half);
   for (i = 0; i < count; i += 2){ /* count < SIZE_MAX */
     p += (i > 0) * step_size; /* avoid undef. behavior of pointer increment */
     ht_divchn_delete(ht, p);
   }
-  t_first_half = clock() - t_first_half;
+  bench_stop(&b_first_half);
   *res *= (ht->num_elts == ((count & 1) ?
 			    (n - count / 2 - 1) :
 			    (n - count / 2)));
@@ -580,12 +623,13 @@ void delete_key_elts(ht_divchn_t *ht,
     }
   }
   p = ptr(key_elts, (count > 0), ht->pair_size);
-  t_second_half = clock();
+  bench_init(&b_second_half, C_SUITE, "delete residual elements", 0, 1);
+  bench_start(&b_second_half);
   for (i = 1; i < count; i += 2){ /* count < SIZE_MAX */
     p += (i > 1) * step_size; /* avoid undef. behavior of pointer increment */
     ht_divchn_delete(ht, p);
   }
-  t_second_half = clock() - t_second_half;
+  bench_stop(&b_second_half);
   *res *= (ht->num_elts == 0);
   p_start = key_elts;
   p_end = ptr(key_elts, count, ht->pair_size);
@@ -595,10 +639,12 @@ void delete_key_elts(ht_divchn_t *ht,
   for (i = 0; i < ht->count; i++){
     *res *= (ht->key_elts[i] == NULL);
   }
-  printf("\t\tdelete 1/2 elements time:       "
-	 "%.4f seconds\n", (float)t_first_half / CLOCKS_PER_SEC);
-  printf("\t\tdelete residual elements time:  "
-	 "%.4f seconds\n", (float)t_second_half / CLOCKS_PER_SEC);
+  report(&b_first_half, "\t\tdelete 1/2 elements time:       ",
+	 ht, count);
+  report(&b_second_half, "\t\tdelete residual elements time:  ",
+	 ht, count);
+  bench_free(&b_first_half);
+  bench_free(&b_second_half);
 }
 
 void remove_delete(size_t num_ins,
@@ -700,6 +746,21 @@ void *ptr(const void *block, size_t i, size_t size){
   return (void *)((char *)block + i * size);
 }
 
+/**
+   Prints the runtime of a timed section with the parameters of a hash
+   table and the number of keys.
+*/
+void report(const bench_t *b,
+	    const char *label,
+	    const ht_divchn_t *ht,
+	    size_t count){
+  char params[128];
+  sprintf(params, "n=%lu key_size=%lu elt_size=%lu alpha=%lu/2^%lu",
+	  TOLU(count), TOLU(ht->key_size), TOLU(ht->elt_size),
+	  TOLU(ht->alpha_n), TOLU(ht->log_alpha_d));
+  bench_report(b, label, params);
+}
+
 /**
    Prints a test result.
 */
@@ -4,8 +4,8 @@
    Struct declarations and declarations of accessible functions of a hash 
    table with generic hash keys and generic elements. The 
    implementation is based on a division method for hashing into upto  
-   the number of slots determined by the largest prime number in the
-   C_PRIME_PARTS array, representable as size_t on a given system, and a
+   the number of slots determined by the largest growth prime, computed at
+   runtime and representable as size_t on a given system, and a
    chaining method for resolving collisions. Due to chaining, the number
    of keys and elements that can be inserted is not limited by the hash
    table implementation.
@@ -27,6 +27,12 @@
    due to insufficient resources. The behavior outside the specified
    parameter ranges is undefined.
 
+   The slots are allocated with malloc_perror. If HT_DIVCHN_HUGE is
+   defined when ht-divchn.c is compiled, e.g. by
+   "make clean-all && make CPPFLAGS=-DHT_DIVCHN_HUGE", the slots are
+   allocated with huge_malloc_perror of utilities-mem, which backs a large
+   slot array with huge pages where available.
+
    The implementation does not use stdint.h and is portable under C89/C90
    and C99 with the only requirement that CHAR_BIT * sizeof(size_t) is
    greater or equal to 16 and is even.
@@ -41,12 +47,13 @@
 
 #include <stddef.h>
 #include "dll.h"
+#include "utilities-mem.h"
 
 typedef struct{
   size_t key_size;
   size_t elt_size;
   size_t pair_size; /* key_size + elt_size for input iterations by user */
-  size_t group_ix;
+  size_t group_ix; /* deprecated, set to 0; growth primes are computed */
   size_t count_ix; /* max size_t value if last representable prime reached */
   size_t count;
   size_t max_num_elts; /*  >= 0, <= C_SIZE_MAX, represents alpha */
@@ -108,6 +115,14 @@ void ht_divchn_insert(ht_divchn_t *ht, const void *key, const void *elt);
 */
 void *ht_divchn_search(const ht_divchn_t *ht, const void *key);
 
+/**
+   Returns the number of keys that are compared in a search for a key,
+   i.e. the position of the key in the chain of its slot if the key is
+   present, and the length of the chain otherwise. The key parameter is
+   not NULL and points to a block of size key_size.
+*/
+size_t ht_divchn_probes(const ht_divchn_t *ht, const void *key);
+
 /**
    Removes a key and its associated element from a hash table by copying 
    the element or its pointer into a block of size elt_size pointed to
@@ -130,4 +145,17 @@ void ht_divchn_delete(ht_divchn_t *ht, const void *key);
 */
 void ht_divchn_free(ht_divchn_t *ht);
 
+/**
+   Computes the memory footprint of a hash table, including the block of
+   size sizeof(ht_divchn_t) pointed to by the ht parameter. The payload
+   consists of the keys and the elements, or the pointers to noncontiguous
+   elements. The slot array, except for the empty slots, which are slack,
+   and the nodes and their allocation headers are overhead. The
+   computation is linear in the number of slots.
+   ht          : pointer to an initialized hash table
+   f           : pointer to a preallocated block of size
+                 sizeof(mem_footprint_t)
+*/
+void ht_divchn_footprint(const ht_divchn_t *ht, mem_footprint_t *f);
+
 #endif
@@ -40,6 +40,8 @@
      of computing bounds, which is defined by the implementation.
 */
 
+#define UTILITIES_MEM_TAG MEM_TAG_HT
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -47,6 +49,21 @@
 #include "ht-muloa.h"
 #include "utilities-mem.h"
 #include "utilities-mod.h"
+#include "utilities-perf.h"
+
+/**
+   The slots are allocated with huge_malloc_perror if HT_MULOA_HUGE is
+   defined, and with malloc_perror otherwise.
+*/
+#ifdef HT_MULOA_HUGE
+#define SLOTS_MALLOC(num, size) huge_malloc_perror((num), (size))
+#define SLOTS_FREE(ptr) aligned_free(ptr)
+#define SLOTS_OVERHEAD(ptr, size) mem_aligned_overhead(ptr)
+#else
+#define SLOTS_MALLOC(num, size) malloc_perror((num), (size))
+#define SLOTS_FREE(ptr) free(ptr)
+#define SLOTS_OVERHEAD(ptr, size) mem_block_overhead(size)
+#endif
 
 static const size_t C_FIRST_PRIME_PARTS[1 + 8 * (2 + 3 + 4)] =
   {0xbe21u,                            /* 2^15 < 48673 < 2^16 */
@@ -218,7 +235,7 @@ void ht_muloa_init(ht_muloa_t *ht,
   ht->alpha_n = alpha_n;
   ht->log_alpha_d = log_alpha_d;
   ht->ph = ph_new();
-  ht->key_elts = malloc_perror(ht->count, sizeof(key_elt_t *));
+  ht->key_elts = SLOTS_MALLOC(ht->count, sizeof(key_elt_t *));
   for (i = 0; i < ht->count; i++){
     ht->key_elts[i] = NULL;
   }
@@ -282,6 +299,33 @@ void *ht_muloa_search(const ht_muloa_t *ht, const void *key){
   }
 }
 
+/**
+   Returns the number of slots that are probed in a search for a key,
+   including the empty slot that ends an unsuccessful search. The number
+   is at most max_num_probes. The key parameter is not NULL and points to
+   a block of size key_size.
+*/
+size_t ht_muloa_probes(const ht_muloa_t *ht, const void *key){
+  size_t num_probes = 1;
+  size_t std_key, fval, sval, ix, dist;
+  key_elt_t * const *ke = NULL;
+  std_key = convert_std_key(ht, key);
+  fval = ht->fprime * std_key; /* mod 2^FULL_BIT */
+  sval = ht->sprime * std_key; /* mod 2^FULL_BIT */
+  ix = fval >> (C_FULL_BIT - ht->log_count);
+  dist = adjust_dist(sval >> (C_FULL_BIT - ht->log_count));
+  ke = &ht->key_elts[ix];
+  while (*ke != NULL &&
+	 (is_ph(*ke) ||
+	  memcmp(key_elt_ptr(*ke, 0), key, ht->key_size) != 0) &&
+	 num_probes < ht->max_num_probes){
+    ix = sum_mod(dist, ix, ht->count);
+    ke = &ht->key_elts[ix];
+    num_probes++;
+  }
+  return num_probes;
+}
+
 /**
    Removes a key and its associated element from a hash table by copying 
    the element or its pointer into a block of size elt_size pointed to
@@ -330,11 +374,30 @@ void ht_muloa_free(ht_muloa_t *ht){
     }
   }
   ph_free(ht->ph);
-  free(ht->key_elts);
+  SLOTS_FREE(ht->key_elts);
   ht->ph = NULL;
   ht->key_elts = NULL;
 }
 
+/**
+   Computes the memory footprint of a hash table, including the block of
+   size sizeof(ht_muloa_t) pointed to by the ht parameter.
+*/
+void ht_muloa_footprint(const ht_muloa_t *ht, mem_footprint_t *f){
+  size_t num_used = ht->num_elts + ht->num_phs;
+  size_t ke_size = sizeof(key_elt_t) + ht->pair_size;
+  f->payload = ht->num_elts * ht->pair_size;
+  f->overhead = (sizeof(ht_muloa_t) +
+		 SLOTS_OVERHEAD(ht->key_elts,
+				ht->count * sizeof(key_elt_t *)) +
+		 num_used * sizeof(key_elt_t *) +
+		 ht->num_elts * (sizeof(key_elt_t) +
+				 mem_block_overhead(ke_size)) +
+		 sizeof(key_elt_t) +
+		 mem_block_overhead(sizeof(key_elt_t))); /* placeholder */
+  f->slack = (ht->count - num_used) * sizeof(key_elt_t *);
+}
+
 /** Helper functions */
 
 /**
@@ -510,10 +573,11 @@ static void ht_grow(ht_muloa_t *ht){
   size_t i, prev_count = ht->count;
   key_elt_t **prev_key_elts = ht->key_elts;
   key_elt_t * const *ke = NULL;
+  PERF_REGION_START(PERF_REG_HT_GROW);
   while (ht->num_elts + ht->num_phs > ht->max_sum && incr_count(ht));
   ht->max_num_probes = 1;
   ht->num_phs = 0;
-  ht->key_elts = malloc_perror(ht->count, sizeof(key_elt_t *));
+  ht->key_elts = SLOTS_MALLOC(ht->count, sizeof(key_elt_t *));
   for (i = 0; i < ht->count; i++){
     ht->key_elts[i] = NULL;
   }
@@ -523,8 +587,9 @@ static void ht_grow(ht_muloa_t *ht){
       reinsert(ht, *ke);
     }
   }
-  free(prev_key_elts);
+  SLOTS_FREE(prev_key_elts);
   prev_key_elts = NULL;
+  PERF_REGION_STOP(PERF_REG_HT_GROW);
 }
 		      
 /**
@@ -555,7 +620,7 @@ static void ht_clean(ht_muloa_t *ht){
   key_elt_t * const *ke = NULL;
   ht->max_num_probes = 1;
   ht->num_phs = 0;
-  ht->key_elts = malloc_perror(ht->count, sizeof(key_elt_t *));
+  ht->key_elts = SLOTS_MALLOC(ht->count, sizeof(key_elt_t *));
   for (i = 0; i < ht->count; i++){
     ht->key_elts[i] = NULL;
   }
@@ -565,7 +630,7 @@ static void ht_clean(ht_muloa_t *ht){
       reinsert(ht, *ke);
     }
   }
-  free(prev_key_elts);
+  SLOTS_FREE(prev_key_elts);
   prev_key_elts = NULL;
 }
 
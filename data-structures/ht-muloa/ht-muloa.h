@@ -32,6 +32,12 @@
    due to insufficient resources. The behavior outside the specified
    parameter ranges is undefined.
 
+   The slots are allocated with malloc_perror. If HT_MULOA_HUGE is
+   defined when ht-muloa.c is compiled, e.g. by
+   "make clean-all && make CPPFLAGS=-DHT_MULOA_HUGE", the slots are
+   allocated with huge_malloc_perror of utilities-mem, which backs a large
+   slot array with huge pages where available.
+
    The implementation does not use stdint.h, and is portable under C89/C90
    and C99 with the only requirements that CHAR_BIT * sizeof(size_t) is
    greater or equal to 16 and is even.
@@ -45,6 +51,7 @@
 #define HT_MULOA_H
 
 #include <stddef.h>
+#include "utilities-mem.h"
 
 typedef struct{
   size_t fval; /* first hash value with first bit only set in placeholder */
@@ -135,6 +142,14 @@ void ht_muloa_insert(ht_muloa_t *ht, const void *key, const void *elt);
 */
 void *ht_muloa_search(const ht_muloa_t *ht, const void *key);
 
+/**
+   Returns the number of slots that are probed in a search for a key,
+   including the empty slot that ends an unsuccessful search. The number
+   is at most max_num_probes. The key parameter is not NULL and points to
+   a block of size key_size.
+*/
+size_t ht_muloa_probes(const ht_muloa_t *ht, const void *key);
+
 /**
    Removes a key and its associated element from a hash table by copying 
    the element or its pointer into a block of size elt_size pointed to
@@ -157,4 +172,17 @@ void ht_muloa_delete(ht_muloa_t *ht, const void *key);
 */
 void ht_muloa_free(ht_muloa_t *ht);
 
+/**
+   Computes the memory footprint of a hash table, including the block of
+   size sizeof(ht_muloa_t) pointed to by the ht parameter. The payload
+   consists of the keys and the elements, or the pointers to noncontiguous
+   elements. The slots with keys or placeholders, the key element headers
+   and their allocation headers, and the placeholder are overhead, and the
+   empty slots are slack.
+   ht          : pointer to an initialized hash table
+   f           : pointer to a preallocated block of size
+                 sizeof(mem_footprint_t)
+*/
+void ht_muloa_footprint(const ht_muloa_t *ht, mem_footprint_t *f);
+
 #endif
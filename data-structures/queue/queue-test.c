@@ -22,6 +22,10 @@
    argument must be specified for i >= 0. Default values are used for the
    unspecified arguments according to the C_ARGS_DEF array.
 
+   The runtimes are measured with utilities-bench and can be written as
+   csv or json records by setting BENCH_FORMAT and BENCH_OUT, e.g.
+   BENCH_FORMAT=json BENCH_OUT=queue.json ./queue-test 24 32 0 0 1
+
    The implementation of tests does not use stdint.h and is portable under
    C89/C90 with the only requirement that CHAR_BIT * sizeof(size_t) is even.
 */
@@ -30,8 +34,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
-#include <time.h>
 #include "queue.h"
+#include "utilities-bench.h"
 #include "utilities-mem.h"
 #include "utilities-mod.h"
 
@@ -50,10 +54,12 @@ const size_t C_ARGS_DEF[5] = {14, 15, 1, 1, 1};
 const size_t C_FULL_BIT = CHAR_BIT * sizeof(size_t);
 
 /* tests */
+const char *C_SUITE = "queue-test";
 const unsigned char C_UCHAR_MAX = (unsigned char)-1;
 const size_t C_INIT_COUNT = 1;
 const size_t C_START_VAL = 0;
 
+void report(const bench_t *b, const char *label, size_t num_ins);
 void print_test_result(int res);
 
 /**
@@ -88,29 +94,33 @@ void uint_push_pop_helper(queue_t *q, size_t start_val, size_t num_ins){
   int res = 1;
   size_t i;
   size_t *pushed = NULL, *popped = NULL;
-  clock_t t_push, t_pop;
+  bench_t b_push, b_pop;
   pushed = malloc_perror(num_ins, sizeof(size_t));
   popped = malloc_perror(num_ins, sizeof(size_t));
   for (i = 0; i < num_ins; i++){
     pushed[i] = start_val + i;
   }
-  t_push = clock();
+  bench_init(&b_push, C_SUITE, "uint push", 0, 1);
+  bench_start(&b_push);
   for (i = 0; i < num_ins; i++){
     queue_push(q, &pushed[i]);
   }
-  t_push = clock() - t_push;
-  t_pop = clock();
+  bench_stop(&b_push);
+  bench_init(&b_pop, C_SUITE, "uint pop", 0, 1);
+  bench_start(&b_pop);
   for (i = 0; i < num_ins; i++){
     queue_pop(q, &popped[i]);
   }
-  t_pop = clock() - t_pop;
+  bench_stop(&b_pop);
   res *= (q->num_elts == 0);
   res *= (q->count >= num_ins);
   for (i = 0; i < num_ins; i++){
     res *= (popped[i] == start_val + i);
   }
-  printf("\t\tpush time:   %.4f seconds\n", (float)t_push / CLOCKS_PER_SEC);
-  printf("\t\tpop time:    %.4f seconds\n", (float)t_pop / CLOCKS_PER_SEC);
+  report(&b_push, "\t\tpush time:   ", num_ins);
+  bench_free(&b_push);
+  report(&b_pop, "\t\tpop time:    ", num_ins);
+  bench_free(&b_pop);
   printf("\t\tcorrectness: ");
   print_test_result(res);
   free(pushed);
@@ -157,7 +167,7 @@ void run_uint_free_test(int pow_ins){
   size_t i;
   size_t num_ins;
   queue_t q;
-  clock_t t;
+  bench_t b;
   num_ins = pow_two(pow_ins);
   queue_init(&q, C_INIT_COUNT, sizeof(size_t), NULL);
   printf("Run a queue_free test on size_t elements\n");
@@ -165,10 +175,12 @@ void run_uint_free_test(int pow_ins){
   for (i = 0; i < num_ins; i++){
     queue_push(&q, &i);
   }
-  t = clock();
+  bench_init(&b, C_SUITE, "uint free", 0, 1);
+  bench_start(&b);
   queue_free(&q);
-  t = clock() - t;
-  printf("\t\tfree time:   %.4f seconds\n", (float)t / CLOCKS_PER_SEC);
+  bench_stop(&b);
+  report(&b, "\t\tfree time:   ", num_ins);
+  bench_free(&b);
 }
 
 /**
@@ -219,7 +231,7 @@ void uint_ptr_push_pop_helper(queue_t *q, size_t start_val, size_t num_ins){
   int res = 1;
   size_t i;
   uint_ptr_t **pushed = NULL, **popped = NULL;
-  clock_t t_push, t_pop;
+  bench_t b_push, b_pop;
   pushed = calloc_perror(num_ins, sizeof(uint_ptr_t *));
   popped = calloc_perror(num_ins, sizeof(uint_ptr_t *));
   for (i = 0; i < num_ins; i++){
@@ -227,25 +239,29 @@ void uint_ptr_push_pop_helper(queue_t *q, size_t start_val, size_t num_ins){
     pushed[i]->val = malloc_perror(1, sizeof(size_t));
     *(pushed[i]->val) = start_val + i;
   }
-  t_push = clock();
+  bench_init(&b_push, C_SUITE, "uint_ptr push", 0, 1);
+  bench_start(&b_push);
   for (i = 0; i < num_ins; i++){
     queue_push(q, &pushed[i]);
   }
-  t_push = clock() - t_push;
+  bench_stop(&b_push);
   memset(pushed, 0, num_ins * sizeof(uint_ptr_t *));
-  t_pop = clock();
+  bench_init(&b_pop, C_SUITE, "uint_ptr pop", 0, 1);
+  bench_start(&b_pop);
   for (i = 0; i < num_ins; i++){
     queue_pop(q, &popped[i]);
   }
-  t_pop = clock() - t_pop;
+  bench_stop(&b_pop);
   res *= (q->num_elts == 0);
   res *= (q->count >= num_ins);
   for (i = 0; i < num_ins; i++){
     res *= (*(popped[i]->val) == start_val + i);
     free_uint_ptr(&popped[i]);
   }
-  printf("\t\tpush time:   %.4f seconds\n", (float)t_push / CLOCKS_PER_SEC);
-  printf("\t\tpop time:    %.4f seconds\n", (float)t_pop / CLOCKS_PER_SEC);
+  report(&b_push, "\t\tpush time:   ", num_ins);
+  bench_free(&b_push);
+  report(&b_pop, "\t\tpop time:    ", num_ins);
+  bench_free(&b_pop);
   printf("\t\tcorrectness: ");
   print_test_result(res);
   free(pushed);
@@ -298,7 +314,7 @@ void run_uint_ptr_free_test(int pow_ins){
   size_t num_ins;
   uint_ptr_t *pushed = NULL;
   queue_t q;
-  clock_t t;
+  bench_t b;
   num_ins = pow_two(pow_ins);
   queue_init(&q, C_INIT_COUNT, sizeof(uint_ptr_t *), free_uint_ptr);
   printf("Run a queue_free test on noncontiguous uint_ptr_t elements\n");
@@ -310,10 +326,12 @@ void run_uint_ptr_free_test(int pow_ins){
     queue_push(&q, &pushed);
     pushed = NULL;
   }
-  t = clock();
+  bench_init(&b, C_SUITE, "uint_ptr free", 0, 1);
+  bench_start(&b);
   queue_free(&q);
-  t = clock() - t;
-  printf("\t\tfree time:   %.4f seconds\n", (float)t / CLOCKS_PER_SEC);
+  bench_stop(&b);
+  report(&b, "\t\tfree time:   ", num_ins);
+  bench_free(&b);
 }
 
 /**
@@ -324,26 +342,40 @@ void run_uchar_queue_test(int pow_ins){
   size_t i;
   size_t num_ins;
   queue_t q;
-  clock_t t_push, t_pop;
+  bench_t b_push, b_pop;
   num_ins = pow_two(pow_ins);
   queue_init(&q, C_INIT_COUNT, sizeof(unsigned char), NULL);
   printf("Run a queue_{push, pop} test on %lu char elements\n",
 	 TOLU(num_ins));
-  t_push = clock();
+  bench_init(&b_push, C_SUITE, "uchar push", 0, 1);
+  bench_start(&b_push);
   for (i = 0; i < num_ins; i++){
     queue_push(&q, &C_UCHAR_MAX);
   }
-  t_push = clock() - t_push;
-  t_pop = clock();
+  bench_stop(&b_push);
+  bench_init(&b_pop, C_SUITE, "uchar pop", 0, 1);
+  bench_start(&b_pop);
   for (i = 0; i < num_ins; i++){
     queue_pop(&q, &c);
   }
-  t_pop = clock() - t_pop;
-  printf("\t\tpush time:   %.4f seconds\n", (float)t_push / CLOCKS_PER_SEC);
-  printf("\t\tpop time:    %.4f seconds\n", (float)t_pop / CLOCKS_PER_SEC);
+  bench_stop(&b_pop);
+  report(&b_push, "\t\tpush time:   ", num_ins);
+  bench_free(&b_push);
+  report(&b_pop, "\t\tpop time:    ", num_ins);
+  bench_free(&b_pop);
   queue_free(&q);
 }
 
+/**
+   Prints a report of a benchmark with the number of inserts as its
+   parameter.
+*/
+void report(const bench_t *b, const char *label, size_t num_ins){
+  char params[64];
+  sprintf(params, "n=%lu", TOLU(num_ins));
+  bench_report(b, label, params);
+}
+
 void print_test_result(int res){
   if (res){
     printf("SUCCESS\n");
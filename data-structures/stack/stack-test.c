@@ -22,6 +22,10 @@
    argument must be specified for i >= 0. Default values are used for the
    unspecified arguments according to the C_ARGS_DEF array.
 
+   The runtimes are measured with utilities-bench and can be written as
+   csv or json records by setting BENCH_FORMAT and BENCH_OUT, e.g.
+   BENCH_FORMAT=json BENCH_OUT=stack.json ./stack-test 24 32 0 0 1
+
    The implementation of tests does not use stdint.h and is portable under
    C89/C90 with the only requirement that CHAR_BIT * sizeof(size_t) is even.
 */
@@ -30,8 +34,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
-#include <time.h>
 #include "stack.h"
+#include "utilities-bench.h"
 #include "utilities-mem.h"
 #include "utilities-mod.h"
 
@@ -50,10 +54,12 @@ const size_t C_ARGS_DEF[5] = {14, 15, 1, 1, 1};
 const size_t C_FULL_BIT = CHAR_BIT * sizeof(size_t);
 
 /* tests */
+const char *C_SUITE = "stack-test";
 const unsigned char C_UCHAR_MAX = (unsigned char)-1;
 const size_t C_INIT_COUNT = 1;
 const size_t C_START_VAL = 0;
 
+void report(const bench_t *b, const char *label, size_t num_ins);
 void print_test_result(int res);
 
 /**
@@ -88,29 +94,40 @@ void uint_push_pop_helper(stack_t *s, size_t start_val, size_t num_ins){
   int res = 1;
   size_t i;
   size_t *pushed = NULL, *popped = NULL;
-  clock_t t_push, t_pop;
+  bench_t b_push, b_pop;
+  mem_footprint_t f;
   pushed = malloc_perror(num_ins, sizeof(size_t));
   popped = malloc_perror(num_ins, sizeof(size_t));
   for (i = 0; i < num_ins; i++){
     pushed[i] = start_val + i;
   }
-  t_push = clock();
+  bench_init(&b_push, C_SUITE, "uint push", 0, 1);
+  bench_start(&b_push);
   for (i = 0; i < num_ins; i++){
     stack_push(s, &pushed[i]);
   }
-  t_push = clock() - t_push;
-  t_pop = clock();
+  bench_stop(&b_push);
+  stack_footprint(s, &f);
+  res *= (f.payload == num_ins * sizeof(size_t));
+  res *= (f.payload + f.slack == s->count * sizeof(size_t));
+  res *= (f.overhead >= sizeof(stack_t));
+  bench_init(&b_pop, C_SUITE, "uint pop", 0, 1);
+  bench_start(&b_pop);
   for (i = 0; i < num_ins; i++){
     stack_pop(s, &popped[i]);
   }
-  t_pop = clock() - t_pop;
+  bench_stop(&b_pop);
   res *= (s->num_elts == 0);
   res *= (s->count >= num_ins);
   for (i = 0; i < num_ins; i++){
     res *= (popped[i] == num_ins - 1 - i + start_val);
   }
-  printf("\t\tpush time:   %.4f seconds\n", (float)t_push / CLOCKS_PER_SEC);
-  printf("\t\tpop time:    %.4f seconds\n", (float)t_pop / CLOCKS_PER_SEC);
+  stack_footprint(s, &f);
+  res *= (f.payload == 0 && f.slack == s->count * sizeof(size_t));
+  report(&b_push, "\t\tpush time:   ", num_ins);
+  bench_free(&b_push);
+  report(&b_pop, "\t\tpop time:    ", num_ins);
+  bench_free(&b_pop);
   printf("\t\tcorrectness: ");
   print_test_result(res);
   free(pushed);
@@ -157,7 +174,7 @@ void run_uint_free_test(int pow_ins){
   size_t i;
   size_t num_ins;
   stack_t s;
-  clock_t t;
+  bench_t b;
   num_ins = pow_two(pow_ins);
   stack_init(&s, C_INIT_COUNT, sizeof(size_t), NULL);
   printf("Run a stack_free test on size_t elements\n");
@@ -165,10 +182,12 @@ void run_uint_free_test(int pow_ins){
   for (i = 0; i < num_ins; i++){
     stack_push(&s, &i);
   }
-  t = clock();
+  bench_init(&b, C_SUITE, "uint free", 0, 1);
+  bench_start(&b);
   stack_free(&s);
-  t = clock() - t;
-  printf("\t\tfree time:   %.4f seconds\n", (float)t / CLOCKS_PER_SEC);
+  bench_stop(&b);
+  report(&b, "\t\tfree time:   ", num_ins);
+  bench_free(&b);
 }
 
 /**
@@ -219,7 +238,7 @@ void uint_ptr_push_pop_helper(stack_t *s, size_t start_val, size_t num_ins){
   int res = 1;
   size_t i;
   uint_ptr_t **pushed = NULL, **popped = NULL;
-  clock_t t_push, t_pop;
+  bench_t b_push, b_pop;
   pushed = calloc_perror(num_ins, sizeof(uint_ptr_t *));
   popped = calloc_perror(num_ins, sizeof(uint_ptr_t *));
   for (i = 0; i < num_ins; i++){
@@ -227,25 +246,29 @@ void uint_ptr_push_pop_helper(stack_t *s, size_t start_val, size_t num_ins){
     pushed[i]->val = malloc_perror(1, sizeof(size_t));
     *(pushed[i]->val) = start_val + i;
   }
-  t_push = clock();
+  bench_init(&b_push, C_SUITE, "uint_ptr push", 0, 1);
+  bench_start(&b_push);
   for (i = 0; i < num_ins; i++){
     stack_push(s, &pushed[i]);
   }
-  t_push = clock() - t_push;
+  bench_stop(&b_push);
   memset(pushed, 0, num_ins * sizeof(uint_ptr_t *));
-  t_pop = clock();
+  bench_init(&b_pop, C_SUITE, "uint_ptr pop", 0, 1);
+  bench_start(&b_pop);
   for (i = 0; i < num_ins; i++){
     stack_pop(s, &popped[i]);
   }
-  t_pop = clock() - t_pop;
+  bench_stop(&b_pop);
   res *= (s->num_elts == 0);
   res *= (s->count >= num_ins);
   for (i = 0; i < num_ins; i++){
     res *= (*(popped[i]->val) == num_ins - 1 - i + start_val);
     free_uint_ptr(&popped[i]);
   }
-  printf("\t\tpush time:   %.4f seconds\n", (float)t_push / CLOCKS_PER_SEC);
-  printf("\t\tpop time:    %.4f seconds\n", (float)t_pop / CLOCKS_PER_SEC);
+  report(&b_push, "\t\tpush time:   ", num_ins);
+  bench_free(&b_push);
+  report(&b_pop, "\t\tpop time:    ", num_ins);
+  bench_free(&b_pop);
   printf("\t\tcorrectness: ");
   print_test_result(res);
   free(pushed);
@@ -299,7 +322,7 @@ void run_uint_ptr_free_test(int pow_ins){
   size_t num_ins;
   uint_ptr_t *pushed = NULL;
   stack_t s;
-  clock_t t;
+  bench_t b;
   num_ins = pow_two(pow_ins);
   stack_init(&s, C_INIT_COUNT, sizeof(uint_ptr_t *), free_uint_ptr);
   printf("Run a stack_free test on noncontiguous uint_ptr_t elements\n");
@@ -311,10 +334,12 @@ void run_uint_ptr_free_test(int pow_ins){
     stack_push(&s, &pushed);
     pushed = NULL;
   }
-  t = clock();
+  bench_init(&b, C_SUITE, "uint_ptr free", 0, 1);
+  bench_start(&b);
   stack_free(&s);
-  t = clock() - t;
-  printf("\t\tfree time:   %.4f seconds\n", (float)t / CLOCKS_PER_SEC);
+  bench_stop(&b);
+  report(&b, "\t\tfree time:   ", num_ins);
+  bench_free(&b);
 }
 
 /**
@@ -325,26 +350,40 @@ void run_uchar_stack_test(int pow_ins){
   size_t i;
   size_t num_ins;
   stack_t s;
-  clock_t t_push, t_pop;
+  bench_t b_push, b_pop;
   num_ins = pow_two(pow_ins);
   stack_init(&s, C_INIT_COUNT, sizeof(unsigned char), NULL);
   printf("Run a stack_{push, pop} test on %lu char elements\n",
 	 TOLU(num_ins));
-  t_push = clock();
+  bench_init(&b_push, C_SUITE, "uchar push", 0, 1);
+  bench_start(&b_push);
   for (i = 0; i < num_ins; i++){
     stack_push(&s, &C_UCHAR_MAX);
   }
-  t_push = clock() - t_push;
-  t_pop = clock();
+  bench_stop(&b_push);
+  bench_init(&b_pop, C_SUITE, "uchar pop", 0, 1);
+  bench_start(&b_pop);
   for (i = 0; i < num_ins; i++){
     stack_pop(&s, &c);
   }
-  t_pop = clock() - t_pop;
-  printf("\t\tpush time:   %.4f seconds\n", (float)t_push / CLOCKS_PER_SEC);
-  printf("\t\tpop time:    %.4f seconds\n", (float)t_pop / CLOCKS_PER_SEC);
+  bench_stop(&b_pop);
+  report(&b_push, "\t\tpush time:   ", num_ins);
+  bench_free(&b_push);
+  report(&b_pop, "\t\tpop time:    ", num_ins);
+  bench_free(&b_pop);
   stack_free(&s);
 }
 
+/**
+   Prints a report of a benchmark with the number of inserts as its
+   parameter.
+*/
+void report(const bench_t *b, const char *label, size_t num_ins){
+  char params[64];
+  sprintf(params, "n=%lu", TOLU(num_ins));
+  bench_report(b, label, params);
+}
+
 void print_test_result(int res){
   if (res){
     printf("SUCCESS\n");
@@ -106,6 +106,16 @@ void stack_free(stack_t *s){
   s->elts = NULL;
 }
 
+/**
+   Computes the memory footprint of a stack, including the block of size
+   sizeof(stack_t) pointed to by the s parameter.
+*/
+void stack_footprint(const stack_t *s, mem_footprint_t *f){
+  f->payload = s->num_elts * s->elt_size;
+  f->overhead = sizeof(stack_t) + mem_block_overhead(s->count * s->elt_size);
+  f->slack = (s->count - s->num_elts) * s->elt_size;
+}
+
 /** Helper functions */
 
 /**
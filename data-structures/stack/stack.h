@@ -16,6 +16,7 @@
 #define STACK_H
 
 #include <stddef.h>
+#include "utilities-mem.h"
 
 typedef struct{
   size_t count;
@@ -77,6 +78,17 @@ void *stack_first(const stack_t *s);
 */
 void stack_free(stack_t *s);
 
+/**
+   Computes the memory footprint of a stack, including the block of size
+   sizeof(stack_t) pointed to by the s parameter. The payload consists of
+   the elements, or of the pointers to noncontiguous elements, and the
+   slack of the unused capacity of the doubling element array.
+   s           : pointer to an initialized stack
+   f           : pointer to a preallocated block of size
+                 sizeof(mem_footprint_t)
+*/
+void stack_footprint(const stack_t *s, mem_footprint_t *f);
+
 /**
    Sets the stack count maximum that may be reached, if possible, as a stack
    grows by repetitive doubling from its initial count and by adding, if
@@ -0,0 +1,438 @@
+/**
+   bc-pthread-test.c
+
+   Tests of the betweenness centrality computation by Brandes' algorithm
+   with parallel processing of sources.
+
+   The following command line arguments can be used to customize tests:
+   bc-pthread-test
+     [0, # bits in size_t / 2] : a
+     [0, # bits in size_t / 2] : b s.t. 2^a <= V <= 2^b for random graph
+                                 tests
+     [0, # bits in size_t / 2] : c s.t. V = 2^c for the performance test
+     [1, # threads] : n for 1 <= # threads <= n
+     [0, 1] : on/off for path and star graph test
+     [0, 1] : on/off for random graph test
+     [0, 1] : on/off for performance test
+
+   usage examples:
+   ./bc-pthread-test
+   ./bc-pthread-test 3 7
+   ./bc-pthread-test 3 7 13 8 0 0 1
+
+   bc-pthread-test can be run with any subset of command line arguments in
+   the above-defined order. If the (i + 1)th argument is specified then the
+   ith argument must be specified for i >= 0. Default values are used for
+   the unspecified arguments according to the C_ARGS_DEF array.
+
+   The implementation of tests does not use stdint.h and is portable under
+   C89/C90 with the requirement that pthreads API is available.
+*/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include "bc-pthread.h"
+#include "graph.h"
+#include "stack.h"
+#include "utilities-mem.h"
+
+/**
+   Generate random numbers in a portable way for test purposes only; rand()
+   in the Linux C Library uses the same generator as random(), which may not
+   be the case on older rand() implementations, and on current
+   implementations on different systems.
+*/
+#ifdef TEST_SEED
+#define RGENS_SEED() do{srand(TEST_SEED);}while (0)
+#else
+#define RGENS_SEED() do{srand(time(NULL));}while (0)
+#endif
+#define RANDOM() (rand()) /* [0, RAND_MAX] */
+#define DRAND() ((double)rand() / RAND_MAX) /* [0.0, 1.0] */
+
+#define TOLU(i) ((unsigned long int)(i)) /* printing size_t under C89/C90 */
+
+/* input handling */
+const char *C_USAGE =
+  "bc-pthread-test \n"
+  "[0, # bits in size_t / 2] : a \n"
+  "[0, # bits in size_t / 2] : b s.t. 2^a <= V <= 2^b for random graph \n"
+  "                            tests \n"
+  "[0, # bits in size_t / 2] : c s.t. V = 2^c for the performance test \n"
+  "[1, # threads] : n for 1 <= # threads <= n \n"
+  "[0, 1] : on/off for path and star graph test \n"
+  "[0, 1] : on/off for random graph test \n"
+  "[0, 1] : on/off for performance test \n";
+const int C_ARGC_MAX = 8;
+const size_t C_ARGS_DEF[7] = {0, 6, 11, 4, 1, 1, 1};
+const size_t C_FULL_BIT = CHAR_BIT * sizeof(size_t);
+
+/* tests */
+const size_t C_NR = (size_t)-1;
+const double C_PROB_ONE = 1.0;
+const double C_PROB_ZERO = 0.0;
+const double C_PROBS[5] = {1.0, 0.5, 0.2, 0.05, 0.0};
+const size_t C_PROBS_COUNT = 5;
+const size_t C_WT_L = 1;
+const size_t C_WT_H = 4; /* small range for many shortest paths */
+const size_t C_PATH_STAR_COUNT = 101;
+const double C_PERF_DEG = 16.0;
+const size_t C_SAMPLE_COUNT = 64;
+const double C_REL_ERR = 1e-9;
+
+typedef struct{
+  double p;
+} bern_arg_t;
+
+int bern(void *arg);
+void add_uint(void *sum, const void *wt_a, const void *wt_b);
+int cmp_uint(const void *a, const void *b);
+void adj_lst_rand_dir_uint(adj_lst_t *a, size_t n, bern_arg_t *b);
+void naive_bc(const adj_lst_t *a, int weighted, double *bc);
+int bc_equal(const double *a, const double *b, size_t n);
+void print_test_result(int res);
+
+int bern(void *arg){
+  bern_arg_t *b = arg;
+  if (b->p >= C_PROB_ONE) return 1;
+  if (b->p <= C_PROB_ZERO) return 0;
+  if (b->p > DRAND()) return 1;
+  return 0;
+}
+
+void add_uint(void *sum, const void *wt_a, const void *wt_b){
+  *(size_t *)sum = *(const size_t *)wt_a + *(const size_t *)wt_b;
+}
+
+int cmp_uint(const void *a, const void *b){
+  if (*(const size_t *)a > *(const size_t *)b){
+    return 1;
+  }else if (*(const size_t *)a < *(const size_t *)b){
+    return -1;
+  }else{
+    return 0;
+  }
+}
+
+/**
+   Builds a random directed graph with n vertices and size_t weights in
+   [C_WT_L, C_WT_H], where each directed edge is added with probability
+   b->p.
+*/
+void adj_lst_rand_dir_uint(adj_lst_t *a, size_t n, bern_arg_t *b){
+  size_t u, v, wt;
+  graph_t g;
+  graph_base_init(&g, n, sizeof(size_t));
+  adj_lst_init(a, &g);
+  for (u = 0; u < n; u++){
+    for (v = 0; v < n; v++){
+      if (u == v) continue;
+      wt = C_WT_L + RANDOM() % (C_WT_H - C_WT_L + 1);
+      adj_lst_add_dir_edge(a, u, v, &wt, bern, b);
+    }
+  }
+  graph_free(&g);
+}
+
+/**
+   Computes the betweenness of each vertex by the pair dependencies
+
+     sum over s != v != t of sigma(s, v) * sigma(v, t) / sigma(s, t)
+
+   for the pairs (s, t) with d(s, v) + d(v, t) = d(s, t), where the
+   distances are computed by the Floyd-Warshall algorithm and the numbers
+   of shortest paths in the order of distances from each source. The
+   weights are size_t weights if weighted is non-zero, and 1 otherwise.
+*/
+void naive_bc(const adj_lst_t *a, int weighted, double *bc){
+  const char *p = NULL, *p_start = NULL, *p_end = NULL;
+  size_t i, j, s, t, u, v, w;
+  size_t n = a->num_vts;
+  size_t *d = NULL, *wts = NULL, *order = NULL;
+  double *sigma = NULL;
+  d = malloc_perror(n * n, sizeof(size_t));
+  wts = malloc_perror(n * n, sizeof(size_t));
+  order = malloc_perror(n, sizeof(size_t));
+  sigma = calloc_perror(n * n, sizeof(double));
+  memset(wts, 0xff, n * n * sizeof(size_t));
+  for (u = 0; u < n; u++){
+    p_start = a->vt_wts[u]->elts;
+    p_end = p_start + a->vt_wts[u]->num_elts * a->pair_size;
+    for (p = p_start; p != p_end; p += a->pair_size){
+      v = *(const size_t *)p;
+      wts[u * n + v] = (weighted) ? *(const size_t *)(p + a->offset) : 1;
+    }
+  }
+  memcpy(d, wts, n * n * sizeof(size_t));
+  for (u = 0; u < n; u++) d[u * n + u] = 0;
+  for (w = 0; w < n; w++){
+    for (u = 0; u < n; u++){
+      for (v = 0; v < n; v++){
+	if (d[u * n + w] == C_NR || d[w * n + v] == C_NR) continue;
+	if (d[u * n + w] + d[w * n + v] < d[u * n + v]){
+	  d[u * n + v] = d[u * n + w] + d[w * n + v];
+	}
+      }
+    }
+  }
+  for (s = 0; s < n; s++){
+    for (i = 0; i < n; i++){
+      order[i] = i;
+      for (j = i; j > 0 && d[s * n + order[j - 1]] > d[s * n + order[j]];
+	   j--){
+	t = order[j];
+	order[j] = order[j - 1];
+	order[j - 1] = t;
+      }
+    }
+    sigma[s * n + s] = 1.0;
+    for (i = 1; i < n; i++){
+      t = order[i];
+      if (d[s * n + t] == C_NR) break;
+      for (u = 0; u < n; u++){
+	if (wts[u * n + t] == C_NR || d[s * n + u] == C_NR) continue;
+	if (d[s * n + u] + wts[u * n + t] == d[s * n + t]){
+	  sigma[s * n + t] += sigma[s * n + u];
+	}
+      }
+    }
+  }
+  for (v = 0; v < n; v++){
+    bc[v] = 0.0;
+    for (s = 0; s < n; s++){
+      if (s == v || d[s * n + v] == C_NR) continue;
+      for (t = 0; t < n; t++){
+	if (t == v || t == s || d[v * n + t] == C_NR) continue;
+	if (d[s * n + v] + d[v * n + t] == d[s * n + t]){
+	  bc[v] += sigma[s * n + v] * sigma[v * n + t] / sigma[s * n + t];
+	}
+      }
+    }
+  }
+  free(d);
+  free(wts);
+  free(order);
+  free(sigma);
+  d = NULL;
+  wts = NULL;
+  order = NULL;
+  sigma = NULL;
+}
+
+/**
+   Returns 1 if the scores are equal within a relative error, and 0
+   otherwise.
+*/
+int bc_equal(const double *a, const double *b, size_t n){
+  size_t i;
+  double diff;
+  for (i = 0; i < n; i++){
+    diff = (a[i] > b[i]) ? a[i] - b[i] : b[i] - a[i];
+    if (diff > C_REL_ERR * (1.0 + ((b[i] > 0.0) ? b[i] : -b[i]))) return 0;
+  }
+  return 1;
+}
+
+/**
+   Tests bc_pthread on undirected path and star graphs, where the scores
+   are 2i(n - 1 - i) for the ith vertex of a path, and (n - 1)(n - 2) for
+   the center of a star and 0 for the other vertices.
+*/
+void run_path_star_test(size_t num_threads){
+  int res = 1;
+  size_t i, j, n = C_PATH_STAR_COUNT;
+  double *bc = NULL, *bc_wo = NULL;
+  bern_arg_t b;
+  graph_t g;
+  adj_lst_t a;
+  bc = malloc_perror(n, sizeof(double));
+  bc_wo = malloc_perror(n, sizeof(double));
+  b.p = C_PROB_ONE;
+  printf("Run bc_pthread test on path and star graphs\n");
+  for (j = 0; j < 2; j++){
+    graph_base_init(&g, n, 0);
+    adj_lst_init(&a, &g);
+    adj_lst_undir_build(&a, &g);
+    for (i = 0; i < n - 1; i++){
+      adj_lst_add_undir_edge(&a, (j == 0) ? i : 0, i + 1, NULL, bern, &b);
+    }
+    for (i = 0; i < n; i++){
+      if (j == 0){
+	bc_wo[i] = 2.0 * i * (n - 1 - i);
+      }else{
+	bc_wo[i] = (i == 0) ? (double)(n - 1) * (n - 2) : 0.0;
+      }
+    }
+    for (i = 1; i <= num_threads; i++){
+      bc_pthread(&a, NULL, 0, bc, i, NULL, NULL, NULL);
+      res *= bc_equal(bc, bc_wo, n);
+    }
+    adj_lst_free(&a);
+    graph_free(&g);
+  }
+  printf("\tV = %lu, 1 to %lu threads --> ",
+	 TOLU(n), TOLU(num_threads));
+  print_test_result(res);
+  free(bc);
+  free(bc_wo);
+  bc = NULL;
+  bc_wo = NULL;
+}
+
+/**
+   Tests bc_pthread on random directed graphs with and without weights
+   against naive_bc with 1 to num_threads threads, and with each vertex
+   repeated twice as a sample of sources.
+*/
+void run_random_graph_test(size_t log_start,
+			   size_t log_end,
+			   size_t num_threads){
+  int res = 1, res_smpl = 1;
+  int weighted;
+  size_t i, j, l, n;
+  size_t *srcs = NULL;
+  double *bc = NULL, *bc_wo = NULL;
+  bern_arg_t b;
+  adj_lst_t a;
+  bc = malloc_perror((size_t)1 << log_end, sizeof(double));
+  bc_wo = malloc_perror((size_t)1 << log_end, sizeof(double));
+  srcs = malloc_perror((size_t)1 << (log_end + 1), sizeof(size_t));
+  printf("Run bc_pthread test on random directed graphs against the pair "
+	 "dependencies\n");
+  for (l = log_start; l <= log_end; l++){
+    n = (size_t)1 << l;
+    for (i = 0; i < 2 * n; i++){
+      srcs[i] = i / 2;
+    }
+    for (i = 0; i < C_PROBS_COUNT; i++){
+      b.p = C_PROBS[i];
+      adj_lst_rand_dir_uint(&a, n, &b);
+      for (weighted = 0; weighted < 2; weighted++){
+	naive_bc(&a, weighted, bc_wo);
+	for (j = 1; j <= num_threads; j++){
+	  bc_pthread(&a, NULL, 0, bc, j,
+		     (weighted) ? add_uint : NULL, cmp_uint, NULL);
+	  res *= bc_equal(bc, bc_wo, n);
+	  bc_pthread(&a, srcs, 2 * n, bc, j,
+		     (weighted) ? add_uint : NULL, cmp_uint, NULL);
+	  res_smpl *= bc_equal(bc, bc_wo, n);
+	}
+      }
+      adj_lst_free(&a);
+    }
+  }
+  printf("\t2^%lu <= V <= 2^%lu, 1 to %lu threads\n",
+	 TOLU(log_start), TOLU(log_end), TOLU(num_threads));
+  printf("\t\tall sources --> ");
+  print_test_result(res);
+  printf("\t\teach source twice as a sample --> ");
+  print_test_result(res_smpl);
+  free(bc);
+  free(bc_wo);
+  free(srcs);
+  bc = NULL;
+  bc_wo = NULL;
+  srcs = NULL;
+}
+
+/**
+   Runs bc_pthread with all sources and with C_SAMPLE_COUNT random sources
+   on a random undirected graph, with 1 to num_threads threads, and prints
+   the counts and times.
+*/
+void run_perf_test(size_t log_n, size_t num_threads){
+  int res = 1;
+  size_t i, u, u_max = 0;
+  size_t n = (size_t)1 << log_n;
+  size_t *srcs = NULL;
+  double *bc = NULL, *bc_wo = NULL;
+  bern_arg_t b;
+  adj_lst_t a;
+  bc_stats_t st;
+  bc = malloc_perror(n, sizeof(double));
+  bc_wo = malloc_perror(n, sizeof(double));
+  srcs = malloc_perror(C_SAMPLE_COUNT, sizeof(size_t));
+  b.p = (n > 1) ? C_PERF_DEG / (n - 1) : C_PROB_ONE;
+  adj_lst_rand_undir(&a, n, bern, &b);
+  for (i = 0; i < C_SAMPLE_COUNT; i++){
+    srcs[i] = RANDOM() % n;
+  }
+  printf("Run bc_pthread performance test on a random undirected graph\n");
+  printf("\tvertices: %lu, edges: %lu\n",
+	 TOLU(a.num_vts), TOLU(a.num_es / 2));
+  bc_pthread(&a, NULL, 0, bc_wo, 1, NULL, NULL, NULL);
+  for (u = 0; u < n; u++){
+    if (bc_wo[u] > bc_wo[u_max]) u_max = u;
+  }
+  for (i = 1; i <= num_threads; i *= 2){
+    bc_pthread(&a, NULL, 0, bc, i, NULL, NULL, &st);
+    res *= bc_equal(bc, bc_wo, n);
+    printf("\t\t%2lu threads, all sources:   sources: %lu, edges: %lu\n"
+	   "\t\t                            init: %.4f, search: %.4f, "
+	   "free: %.4f seconds\n",
+	   TOLU(i), TOLU(st.num_srcs), TOLU(st.num_edges),
+	   st.init_secs, st.search_secs, st.free_secs);
+    bc_pthread(&a, srcs, C_SAMPLE_COUNT, bc, i, NULL, NULL, &st);
+    printf("\t\t%2lu threads, %lu sources:    search: %.4f seconds, "
+	   "max score: %.1f, estimate: %.1f\n",
+	   TOLU(i), TOLU(C_SAMPLE_COUNT), st.search_secs,
+	   bc_wo[u_max], bc[u_max]);
+  }
+  printf("\tequal scores across threads --> ");
+  print_test_result(res);
+  adj_lst_free(&a);
+  free(bc);
+  free(bc_wo);
+  free(srcs);
+  bc = NULL;
+  bc_wo = NULL;
+  srcs = NULL;
+}
+
+/**
+   Prints a test result.
+*/
+void print_test_result(int res){
+  if (res){
+    printf("SUCCESS\n");
+  }else{
+    printf("FAILURE\n");
+  }
+}
+
+int main(int argc, char *argv[]){
+  int i;
+  size_t *args = NULL;
+  RGENS_SEED();
+  if (argc > C_ARGC_MAX){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  args = malloc_perror(C_ARGC_MAX - 1, sizeof(size_t));
+  memcpy(args, C_ARGS_DEF, (C_ARGC_MAX - 1) * sizeof(size_t));
+  for (i = 1; i < argc; i++){
+    args[i - 1] = atoi(argv[i]);
+  }
+  if (args[0] > C_FULL_BIT / 2 ||
+      args[1] > C_FULL_BIT / 2 ||
+      args[2] > C_FULL_BIT / 2 ||
+      args[0] > args[1] ||
+      args[3] < 1 ||
+      args[4] > 1 ||
+      args[5] > 1 ||
+      args[6] > 1){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  if (args[4]) run_path_star_test(args[3]);
+  if (args[5]) run_random_graph_test(args[0], args[1], args[3]);
+  if (args[6]) run_perf_test(args[2], args[3]);
+  free(args);
+  args = NULL;
+  return 0;
+}
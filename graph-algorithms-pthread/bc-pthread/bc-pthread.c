@@ -0,0 +1,490 @@
+/**
+   bc-pthread.c
+
+   Functions for computing the betweenness centrality of the vertices of
+   graphs with vertices indexed from 0 by Brandes' algorithm, with parallel
+   processing of sources.
+
+   For a source s, bfs or dijkstra provides the distances from s. An edge
+   (u, v) is in the shortest-path DAG of s if u is reached and the distance
+   of v is the sum of the distance of u and the weight of (u, v), or the
+   distance of u plus one on unweighted graphs. A topological order of the
+   DAG is obtained on unweighted graphs by counting sort of the reached
+   vertices by distance, and on weighted graphs by counting the DAG
+   predecessors of each vertex and removing the vertices without
+   unprocessed predecessors. The number of shortest paths sigma[u] is added
+   to sigma[v] for each DAG edge (u, v) in the topological order. The last
+   pass processes the vertices in the reverse order and computes the
+   dependency
+
+     delta[u] = sum over DAG edges (u, v) of sigma[u] / sigma[v] *
+                (1 + delta[v]),
+
+   which is added to the score of u if u is not s. The numbers of shortest
+   paths are doubles, as in the original algorithm, because their counts
+   may exceed the range of size_t.
+
+   A thread takes a chunk of C_CHUNK_COUNT sources at a time from a shared
+   counter, which balances the threads if the numbers of reached vertices
+   differ across sources. The arrays of a thread are allocated once per
+   call and reused across its sources. On weighted graphs, the workspace
+   also provides dijkstra with the hash table of its heap, an index table
+   of V slots. The table is empty after each run of dijkstra, because
+   dijkstra empties its heap, and is reused without reinitialization, so
+   that a source does not allocate or clear O(V) memory in dijkstra.
+
+   The implementation does not use stdint.h and is portable under C89/C90
+   with the requirement that pthreads API is available.
+*/
+
+#define _POSIX_C_SOURCE 200112L
+
+#define UTILITIES_MEM_TAG MEM_TAG_GRAPH
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "bc-pthread.h"
+#include "bfs.h"
+#include "dijkstra.h"
+#include "graph.h"
+#include "heap.h"
+#include "stack.h"
+#include "utilities-mem.h"
+#include "utilities-pthread.h"
+#include "utilities-time.h"
+
+static const size_t C_CHUNK_COUNT = 4;
+static const size_t C_NREACHED = (size_t)-1; /* not reached as index */
+
+typedef struct{
+  size_t next; /* index of the first source of the next chunk */
+  size_t num_srcs;
+  const size_t *srcs; /* NULL if all vertices are sources */
+  pthread_mutex_t mutex;
+} sched_t;
+
+typedef struct{
+  size_t num_srcs;
+  size_t num_reached;
+  double *bc;
+  bc_ws_t ws;
+  const adj_lst_t *a;
+  sched_t *s;
+  void (*add_wt)(void *, const void *, const void *);
+  int (*cmp_wt)(const void *, const void *);
+} bc_arg_t;
+
+static void *bc_thread(void *arg);
+static size_t order_by_dist(bc_ws_t *ws);
+static size_t order_by_dag(const adj_lst_t *a,
+			   bc_ws_t *ws,
+			   size_t s,
+			   void (*add_wt)(void *, const void *, const void *),
+			   int (*cmp_wt)(const void *, const void *));
+static int is_dag_edge(const adj_lst_t *a,
+		       bc_ws_t *ws,
+		       size_t u,
+		       const char *p,
+		       void (*add_wt)(void *, const void *, const void *),
+		       int (*cmp_wt)(const void *, const void *));
+
+/* index table operations of the heap of dijkstra */
+static void ht_ws_init(bc_ws_t *ws,
+		       size_t key_size,
+		       size_t elt_size,
+		       void (*free_elt)(void *),
+		       void *context);
+static void ht_ws_insert(bc_ws_t *ws, const size_t *key, const size_t *elt);
+static void *ht_ws_search(const bc_ws_t *ws, const size_t *key);
+static void ht_ws_remove(bc_ws_t *ws, const size_t *key, size_t *elt);
+static void ht_ws_free(bc_ws_t *ws);
+
+/**
+   Initializes a workspace for running bc_source on an adjacency list.
+   ws          : pointer to a preallocated block of size sizeof(bc_ws_t)
+   a           : pointer to an adjacency list
+   weighted    : non-zero if distances are computed with weights
+*/
+void bc_ws_init(bc_ws_t *ws, const adj_lst_t *a, int weighted){
+  size_t n = a->num_vts;
+  ws->num_vts = n;
+  ws->wt_size = (weighted) ? a->wt_size : sizeof(size_t);
+  ws->num_reached = 0;
+  ws->num_edges = 0;
+  ws->prev = malloc_perror(n, sizeof(size_t));
+  ws->order = malloc_perror(n, sizeof(size_t));
+  ws->num_preds = malloc_perror(n, sizeof(size_t));
+  ws->sigma = malloc_perror(n, sizeof(double));
+  ws->delta = malloc_perror(n, sizeof(double));
+  ws->dist = malloc_perror(n, ws->wt_size);
+  ws->wt = malloc_perror(1, ws->wt_size);
+  ws->in_heap = NULL;
+  ws->heap_ixs = NULL;
+  if (weighted){
+    ws->in_heap = calloc_perror(n, sizeof(char));
+    ws->heap_ixs = malloc_perror(n, sizeof(size_t));
+  }
+}
+
+/**
+   Adds the dependencies of a source on each vertex to an array of scores.
+   a           : pointer to an adjacency list with at least one vertex
+   s           : source vertex
+   bc          : pointer to an array of scores with the count equal to the
+                 number of vertices in the adjacency list
+   ws          : pointer to a workspace initialized with the adjacency list
+                 and a non-zero weighted value if add_wt is not NULL
+   add_wt      : - NULL, if the graph is unweighted or the weights are not
+                 used; distances are computed by bfs
+                 - otherwise an addition function which copies the sum of
+                 the weight values pointed to by the second and third
+                 arguments to the preallocated weight block pointed to by
+                 the first argument; distances are computed by dijkstra and
+                 the weights are expected to be positive
+   cmp_wt      : comparison function as in dijkstra, used if add_wt is not
+                 NULL; two paths are of equal length if the sums of their
+                 weights compare equal, which is exact for integer weights
+*/
+void bc_source(const adj_lst_t *a,
+	       size_t s,
+	       double *bc,
+	       bc_ws_t *ws,
+	       void (*add_wt)(void *, const void *, const void *),
+	       int (*cmp_wt)(const void *, const void *)){
+  const char *p = NULL, *p_start = NULL, *p_end = NULL;
+  size_t i, u, v, tail;
+  heap_ht_t hht;
+  if (add_wt == NULL){
+    bfs(a, s, ws->dist, ws->prev, NULL);
+    tail = order_by_dist(ws);
+    for (i = 0; i < tail; i++){
+      ws->sigma[ws->order[i]] = 0.0;
+      ws->delta[ws->order[i]] = 0.0;
+    }
+    ws->sigma[s] = 1.0;
+    for (i = 0; i < tail; i++){
+      u = ws->order[i];
+      p_start = a->vt_wts[u]->elts;
+      p_end = p_start + a->vt_wts[u]->num_elts * a->pair_size;
+      ws->num_edges += a->vt_wts[u]->num_elts;
+      for (p = p_start; p != p_end; p += a->pair_size){
+	if (!is_dag_edge(a, ws, u, p, add_wt, cmp_wt)) continue;
+	ws->sigma[*(const size_t *)p] += ws->sigma[u];
+      }
+    }
+  }else{
+    hht.ht = ws;
+    hht.context = NULL;
+    hht.init = (heap_ht_init)ht_ws_init;
+    hht.insert = (heap_ht_insert)ht_ws_insert;
+    hht.search = (heap_ht_search)ht_ws_search;
+    hht.remove = (heap_ht_remove)ht_ws_remove;
+    hht.free = (heap_ht_free)ht_ws_free;
+    dijkstra(a, s, ws->dist, ws->prev, &hht, add_wt, cmp_wt, NULL);
+    tail = order_by_dag(a, ws, s, add_wt, cmp_wt);
+  }
+  for (i = tail; i > 0; i--){
+    u = ws->order[i - 1];
+    p_start = a->vt_wts[u]->elts;
+    p_end = p_start + a->vt_wts[u]->num_elts * a->pair_size;
+    ws->num_edges += a->vt_wts[u]->num_elts;
+    for (p = p_start; p != p_end; p += a->pair_size){
+      if (!is_dag_edge(a, ws, u, p, add_wt, cmp_wt)) continue;
+      v = *(const size_t *)p;
+      ws->delta[u] += ws->sigma[u] / ws->sigma[v] * (1.0 + ws->delta[v]);
+    }
+    if (u != s) bc[u] += ws->delta[u];
+  }
+  ws->num_reached = tail;
+}
+
+/**
+   Frees the arrays of a workspace and leaves a block of size
+   sizeof(bc_ws_t) pointed to by the ws parameter.
+*/
+void bc_ws_free(bc_ws_t *ws){
+  free(ws->prev);
+  free(ws->order);
+  free(ws->num_preds);
+  free(ws->sigma);
+  free(ws->delta);
+  free(ws->dist);
+  free(ws->wt);
+  free(ws->in_heap);
+  free(ws->heap_ixs);
+  ws->prev = NULL;
+  ws->order = NULL;
+  ws->num_preds = NULL;
+  ws->sigma = NULL;
+  ws->delta = NULL;
+  ws->dist = NULL;
+  ws->wt = NULL;
+  ws->in_heap = NULL;
+  ws->heap_ixs = NULL;
+}
+
+/**
+   Computes and copies to an array pointed to by bc the betweenness
+   centrality of each vertex with num_threads threads.
+   a           : pointer to an adjacency list with at least one vertex
+   srcs        : - NULL pointer, if all vertices are sources and the exact
+                 betweenness is computed
+                 - pointer to an array of num_srcs sources, e.g. sampled
+                 uniformly at random, where a source may be repeated; the
+                 sum of the dependencies is scaled by V / num_srcs
+   num_srcs    : > 0 number of sources in srcs; not used if srcs is NULL
+   bc          : pointer to a preallocated array with the count equal to
+                 the number of vertices in the adjacency list
+   num_threads : > 0 number of threads
+   add_wt      : NULL or an addition function of weights as in bc_source
+   cmp_wt      : comparison function of weights as in bc_source
+   stats       : - NULL pointer, if operations are not counted
+                 - a pointer to a block of size sizeof(bc_stats_t), where
+                 the counts and phase times of the run are copied
+*/
+void bc_pthread(const adj_lst_t *a,
+		const size_t *srcs,
+		size_t num_srcs,
+		double *bc,
+		size_t num_threads,
+		void (*add_wt)(void *, const void *, const void *),
+		int (*cmp_wt)(const void *, const void *),
+		bc_stats_t *stats){
+  size_t i, u;
+  size_t n = a->num_vts;
+  double scale;
+  double t = 0.0;
+  sched_t s;
+  bc_arg_t *bas = NULL;
+  pthread_t *ids = NULL;
+  if (stats != NULL){
+    memset(stats, 0, sizeof(bc_stats_t));
+    t = time_wall();
+  }
+  s.next = 0;
+  s.num_srcs = (srcs == NULL) ? n : num_srcs;
+  s.srcs = srcs;
+  mutex_init_perror(&s.mutex);
+  bas = malloc_perror(num_threads, sizeof(bc_arg_t));
+  ids = malloc_perror(num_threads, sizeof(pthread_t));
+  memset(bc, 0, n * sizeof(double));
+  for (i = 0; i < num_threads; i++){
+    bas[i].num_srcs = 0;
+    bas[i].num_reached = 0;
+    bas[i].bc = (i == 0) ? bc : calloc_perror(n, sizeof(double));
+    bc_ws_init(&bas[i].ws, a, add_wt != NULL);
+    bas[i].a = a;
+    bas[i].s = &s;
+    bas[i].add_wt = add_wt;
+    bas[i].cmp_wt = cmp_wt;
+  }
+  if (stats != NULL){
+    stats->init_secs = time_wall() - t;
+    t = time_wall();
+  }
+  for (i = 1; i < num_threads; i++){
+    thread_create_perror(&ids[i], bc_thread, &bas[i]);
+  }
+  bc_thread(&bas[0]);
+  for (i = 1; i < num_threads; i++){
+    thread_join_perror(ids[i], NULL);
+  }
+  if (stats != NULL){
+    stats->search_secs = time_wall() - t;
+    t = time_wall();
+  }
+  for (i = 0; i < num_threads; i++){
+    if (stats != NULL){
+      stats->num_srcs += bas[i].num_srcs;
+      stats->num_reached += bas[i].num_reached;
+      stats->num_edges += bas[i].ws.num_edges;
+    }
+    if (i > 0){
+      for (u = 0; u < n; u++){
+	bc[u] += bas[i].bc[u];
+      }
+      free(bas[i].bc);
+    }
+    bc_ws_free(&bas[i].ws);
+  }
+  if (srcs != NULL){
+    scale = (double)n / num_srcs;
+    for (u = 0; u < n; u++){
+      bc[u] *= scale;
+    }
+  }
+  pthread_mutex_destroy(&s.mutex);
+  free(bas);
+  free(ids);
+  bas = NULL;
+  ids = NULL;
+  if (stats != NULL) stats->free_secs = time_wall() - t;
+}
+
+/**
+   Processes chunks of sources until all sources are taken.
+*/
+static void *bc_thread(void *arg){
+  size_t i, i_end;
+  bc_arg_t *ba = arg;
+  sched_t *s = ba->s;
+  while (1){
+    mutex_lock_perror(&s->mutex);
+    i = s->next;
+    i_end = (s->num_srcs - i < C_CHUNK_COUNT) ?
+      s->num_srcs : i + C_CHUNK_COUNT;
+    s->next = i_end;
+    mutex_unlock_perror(&s->mutex);
+    if (i == i_end) break;
+    for (; i < i_end; i++){
+      bc_source(ba->a,
+		(s->srcs == NULL) ? i : s->srcs[i],
+		ba->bc,
+		&ba->ws,
+		ba->add_wt,
+		ba->cmp_wt);
+      ba->num_reached += ba->ws.num_reached;
+      ba->num_srcs++;
+    }
+  }
+  return NULL;
+}
+
+/**
+   Copies the vertices reached by bfs to the order array of a workspace in
+   the ascending order of distances by counting sort, and returns their
+   count. The distances are less than the number of vertices.
+*/
+static size_t order_by_dist(bc_ws_t *ws){
+  size_t u, d, c, sum = 0;
+  size_t n = ws->num_vts;
+  size_t *dist = ws->dist;
+  size_t *counts = ws->num_preds;
+  memset(counts, 0, n * sizeof(size_t));
+  for (u = 0; u < n; u++){
+    if (ws->prev[u] != C_NREACHED) counts[dist[u]]++;
+  }
+  for (d = 0; d < n; d++){
+    c = counts[d];
+    counts[d] = sum;
+    sum += c;
+  }
+  for (u = 0; u < n; u++){
+    if (ws->prev[u] == C_NREACHED) continue;
+    ws->order[counts[dist[u]]] = u;
+    counts[dist[u]]++;
+  }
+  return sum;
+}
+
+/**
+   Copies the vertices reached by dijkstra to the order array of a
+   workspace in a topological order of the shortest-path DAG, by counting
+   the DAG predecessors of each vertex and removing the vertices without
+   unprocessed predecessors, and returns their count. The numbers of
+   shortest paths are accumulated in the same order.
+*/
+static size_t order_by_dag(const adj_lst_t *a,
+			   bc_ws_t *ws,
+			   size_t s,
+			   void (*add_wt)(void *, const void *, const void *),
+			   int (*cmp_wt)(const void *, const void *)){
+  const char *p = NULL, *p_start = NULL, *p_end = NULL;
+  size_t u, v;
+  size_t head = 0, tail = 0;
+  size_t n = ws->num_vts;
+  memset(ws->num_preds, 0, n * sizeof(size_t));
+  for (u = 0; u < n; u++){
+    if (ws->prev[u] == C_NREACHED) continue;
+    ws->sigma[u] = 0.0;
+    ws->delta[u] = 0.0;
+    p_start = a->vt_wts[u]->elts;
+    p_end = p_start + a->vt_wts[u]->num_elts * a->pair_size;
+    ws->num_edges += a->vt_wts[u]->num_elts;
+    for (p = p_start; p != p_end; p += a->pair_size){
+      if (is_dag_edge(a, ws, u, p, add_wt, cmp_wt)){
+	ws->num_preds[*(const size_t *)p]++;
+      }
+    }
+  }
+  ws->sigma[s] = 1.0;
+  ws->order[tail] = s;
+  tail++;
+  while (head < tail){
+    u = ws->order[head];
+    head++;
+    p_start = a->vt_wts[u]->elts;
+    p_end = p_start + a->vt_wts[u]->num_elts * a->pair_size;
+    ws->num_edges += a->vt_wts[u]->num_elts;
+    for (p = p_start; p != p_end; p += a->pair_size){
+      if (!is_dag_edge(a, ws, u, p, add_wt, cmp_wt)) continue;
+      v = *(const size_t *)p;
+      ws->sigma[v] += ws->sigma[u];
+      ws->num_preds[v]--;
+      if (ws->num_preds[v] == 0){
+	ws->order[tail] = v;
+	tail++;
+      }
+    }
+  }
+  return tail;
+}
+
+/**
+   Returns non-zero if the edge from a reached vertex u to the vertex of
+   the pair pointed to by p is in the shortest-path DAG of the last run of
+   bfs or dijkstra in a workspace.
+*/
+static int is_dag_edge(const adj_lst_t *a,
+		       bc_ws_t *ws,
+		       size_t u,
+		       const char *p,
+		       void (*add_wt)(void *, const void *, const void *),
+		       int (*cmp_wt)(const void *, const void *)){
+  size_t v = *(const size_t *)p;
+  const size_t *dist = ws->dist;
+  if (add_wt == NULL) return dist[v] == dist[u] + 1;
+  add_wt(ws->wt, (char *)ws->dist + u * ws->wt_size, p + a->offset);
+  return cmp_wt(ws->wt, (char *)ws->dist + v * ws->wt_size) == 0;
+}
+
+/**
+   Index table operations of the heap of dijkstra. A key is a vertex and
+   an element is the heap index of the vertex, as per the specification of
+   the hash table parameter of the heap. The table is allocated by
+   bc_ws_init and freed by bc_ws_free, and init and free do not allocate
+   or free memory.
+*/
+
+static void ht_ws_init(bc_ws_t *ws,
+		       size_t key_size,
+		       size_t elt_size,
+		       void (*free_elt)(void *),
+		       void *context){
+  (void)ws;
+  (void)key_size;
+  (void)elt_size;
+  (void)free_elt;
+  (void)context;
+}
+
+static void ht_ws_insert(bc_ws_t *ws, const size_t *key, const size_t *elt){
+  ws->in_heap[*key] = 1;
+  ws->heap_ixs[*key] = *elt;
+}
+
+static void *ht_ws_search(const bc_ws_t *ws, const size_t *key){
+  if (ws->in_heap[*key]) return &ws->heap_ixs[*key];
+  return NULL;
+}
+
+static void ht_ws_remove(bc_ws_t *ws, const size_t *key, size_t *elt){
+  ws->in_heap[*key] = 0;
+  *elt = ws->heap_ixs[*key];
+}
+
+static void ht_ws_free(bc_ws_t *ws){
+  (void)ws;
+}
@@ -0,0 +1,133 @@
+/**
+   bc-pthread.h
+
+   Declarations of accessible functions for computing the betweenness
+   centrality of the vertices of graphs with vertices indexed from 0 by
+   Brandes' algorithm, with parallel processing of sources.
+
+   For each source s, the distances from s are computed by bfs on
+   unweighted graphs, or by dijkstra on graphs with generic positive
+   weights. The number of shortest paths from s is then accumulated in a
+   topological order of the shortest-path DAG, and the dependencies of s on
+   each vertex in the reverse order. The betweenness of a vertex is the sum
+   of the dependencies of the sources on the vertex.
+
+   If all vertices are sources, the exact betweenness is computed. If a
+   sample of k sources is provided, the sum of the dependencies of the
+   sample is scaled by V / k, which is an unbiased estimate of the
+   betweenness if the sources are drawn uniformly at random with
+   replacement.
+
+   The sources are distributed dynamically across threads. Each thread
+   reuses a bc_ws_t workspace of arrays of V elements across its sources,
+   including the index table of the heap of dijkstra, and accumulates the dependencies in its own array of scores, which are
+   summed after the threads are joined.
+
+   For an undirected graph, each shortest path is counted in both
+   directions, and the scores are twice the betweenness of the undirected
+   definition.
+
+   If a pointer to a bc_stats_t block is passed, the algorithm counts its
+   operations and measures the wall-clock time of its phases.
+*/
+
+#ifndef BC_PTHREAD_H
+#define BC_PTHREAD_H
+
+#include <stddef.h>
+#include "graph.h"
+
+typedef struct{
+  size_t num_srcs; /* # processed sources */
+  size_t num_reached; /* # vertices reached from the sources */
+  size_t num_edges; /* # scanned edges after the runs of bfs and dijkstra */
+  double init_secs; /* wall-clock time of allocating workspaces */
+  double search_secs; /* wall-clock time of the parallel sources */
+  double free_secs; /* wall-clock time of reducing and freeing */
+} bc_stats_t;
+
+typedef struct{
+  size_t num_vts;
+  size_t wt_size; /* size of a distance in dist */
+  size_t num_reached; /* # vertices in order after bc_source */
+  size_t num_edges; /* # scanned edges, summed across sources */
+  size_t *prev;
+  size_t *order; /* reached vertices in a topological order */
+  size_t *num_preds; /* # unprocessed predecessors in the DAG */
+  double *sigma; /* # shortest paths from the source */
+  double *delta; /* dependency of the source */
+  void *dist;
+  void *wt; /* block of wt_size bytes for a sum of weights */
+  char *in_heap; /* non-zero if a vertex is in the heap of dijkstra */
+  size_t *heap_ixs; /* heap indices of the vertices in the heap */
+} bc_ws_t;
+
+/**
+   Initializes a workspace for running bc_source on an adjacency list.
+   ws          : pointer to a preallocated block of size sizeof(bc_ws_t)
+   a           : pointer to an adjacency list
+   weighted    : non-zero if distances are computed with weights
+*/
+void bc_ws_init(bc_ws_t *ws, const adj_lst_t *a, int weighted);
+
+/**
+   Adds the dependencies of a source on each vertex to an array of scores.
+   a           : pointer to an adjacency list with at least one vertex
+   s           : source vertex
+   bc          : pointer to an array of scores with the count equal to the
+                 number of vertices in the adjacency list
+   ws          : pointer to a workspace initialized with the adjacency list
+                 and a non-zero weighted value if add_wt is not NULL
+   add_wt      : - NULL, if the graph is unweighted or the weights are not
+                 used; distances are computed by bfs
+                 - otherwise an addition function which copies the sum of
+                 the weight values pointed to by the second and third
+                 arguments to the preallocated weight block pointed to by
+                 the first argument; distances are computed by dijkstra and
+                 the weights are expected to be positive
+   cmp_wt      : comparison function as in dijkstra, used if add_wt is not
+                 NULL; two paths are of equal length if the sums of their
+                 weights compare equal, which is exact for integer weights
+*/
+void bc_source(const adj_lst_t *a,
+	       size_t s,
+	       double *bc,
+	       bc_ws_t *ws,
+	       void (*add_wt)(void *, const void *, const void *),
+	       int (*cmp_wt)(const void *, const void *));
+
+/**
+   Frees the arrays of a workspace and leaves a block of size
+   sizeof(bc_ws_t) pointed to by the ws parameter.
+*/
+void bc_ws_free(bc_ws_t *ws);
+
+/**
+   Computes and copies to an array pointed to by bc the betweenness
+   centrality of each vertex with num_threads threads.
+   a           : pointer to an adjacency list with at least one vertex
+   srcs        : - NULL pointer, if all vertices are sources and the exact
+                 betweenness is computed
+                 - pointer to an array of num_srcs sources, e.g. sampled
+                 uniformly at random, where a source may be repeated; the
+                 sum of the dependencies is scaled by V / num_srcs
+   num_srcs    : > 0 number of sources in srcs; not used if srcs is NULL
+   bc          : pointer to a preallocated array with the count equal to
+                 the number of vertices in the adjacency list
+   num_threads : > 0 number of threads
+   add_wt      : NULL or an addition function of weights as in bc_source
+   cmp_wt      : comparison function of weights as in bc_source
+   stats       : - NULL pointer, if operations are not counted
+                 - a pointer to a block of size sizeof(bc_stats_t), where
+                 the counts and phase times of the run are copied
+*/
+void bc_pthread(const adj_lst_t *a,
+		const size_t *srcs,
+		size_t num_srcs,
+		double *bc,
+		size_t num_threads,
+		void (*add_wt)(void *, const void *, const void *),
+		int (*cmp_wt)(const void *, const void *),
+		bc_stats_t *stats);
+
+#endif
@@ -0,0 +1,241 @@
+/**
+   kcore-pthread-test.c
+
+   Tests of the k-core decomposition by parallel level-synchronous
+   peeling.
+
+   The following command line arguments can be used to customize tests:
+   kcore-pthread-test
+     [0, # bits in size_t / 2] : a
+     [0, # bits in size_t / 2] : b s.t. 2^a <= V <= 2^b for random graph
+                                 tests
+     [0, # bits in size_t / 2] : c s.t. V = 2^c for the performance test
+     [1, # threads] : n for 1 <= # threads <= n
+     [0, 1] : on/off for random graph test
+     [0, 1] : on/off for performance test
+
+   usage examples:
+   ./kcore-pthread-test
+   ./kcore-pthread-test 5 10
+   ./kcore-pthread-test 5 10 14 8 0 1
+
+   kcore-pthread-test can be run with any subset of command line arguments
+   in the above-defined order. If the (i + 1)th argument is specified then
+   the ith argument must be specified for i >= 0. Default values are used
+   for the unspecified arguments according to the C_ARGS_DEF array.
+
+   The implementation of tests does not use stdint.h and is portable under
+   C89/C90 with the requirement that pthreads API is available.
+*/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include "kcore-pthread.h"
+#include "kcore.h"
+#include "graph.h"
+#include "stack.h"
+#include "utilities-mem.h"
+
+/**
+   Generate random numbers in a portable way for test purposes only; rand()
+   in the Linux C Library uses the same generator as random(), which may not
+   be the case on older rand() implementations, and on current
+   implementations on different systems.
+*/
+#ifdef TEST_SEED
+#define RGENS_SEED() do{srand(TEST_SEED);}while (0)
+#else
+#define RGENS_SEED() do{srand(time(NULL));}while (0)
+#endif
+#define RANDOM() (rand()) /* [0, RAND_MAX] */
+#define DRAND() ((double)rand() / RAND_MAX) /* [0.0, 1.0] */
+
+#define TOLU(i) ((unsigned long int)(i)) /* printing size_t under C89/C90 */
+
+/* input handling */
+const char *C_USAGE =
+  "kcore-pthread-test \n"
+  "[0, # bits in size_t / 2] : a \n"
+  "[0, # bits in size_t / 2] : b s.t. 2^a <= V <= 2^b for random graph \n"
+  "                            tests \n"
+  "[0, # bits in size_t / 2] : c s.t. V = 2^c for the performance test \n"
+  "[1, # threads] : n for 1 <= # threads <= n \n"
+  "[0, 1] : on/off for random graph test \n"
+  "[0, 1] : on/off for performance test \n";
+const int C_ARGC_MAX = 7;
+const size_t C_ARGS_DEF[6] = {0, 9, 13, 4, 1, 1};
+const size_t C_FULL_BIT = CHAR_BIT * sizeof(size_t);
+
+/* tests */
+const double C_PROB_ONE = 1.0;
+const double C_PROB_ZERO = 0.0;
+const double C_PROBS[5] = {1.0, 0.6, 0.2, 0.05, 0.0};
+const size_t C_PROBS_COUNT = 5;
+const double C_CORE_PROB = 0.5; /* within the core of V/16 vertices */
+const double C_PERF_DEG = 16.0; /* expected degree outside the core */
+
+typedef struct{
+  double p;
+} bern_arg_t;
+
+int bern(void *arg);
+void core_graph_init(adj_lst_t *a, graph_t *g, size_t n, double p);
+void print_test_result(int res);
+
+int bern(void *arg){
+  bern_arg_t *b = arg;
+  if (b->p >= C_PROB_ONE) return 1;
+  if (b->p <= C_PROB_ZERO) return 0;
+  if (b->p > DRAND()) return 1;
+  return 0;
+}
+
+/**
+   Builds a random graph with n vertices, where the edges between the
+   first n/16 vertices are added with probability C_CORE_PROB, and the
+   other edges with probability p.
+*/
+void core_graph_init(adj_lst_t *a, graph_t *g, size_t n, double p){
+  size_t u, v;
+  bern_arg_t b;
+  graph_base_init(g, n, 0);
+  adj_lst_init(a, g);
+  adj_lst_undir_build(a, g);
+  for (u = 0; u < n; u++){
+    for (v = u + 1; v < n; v++){
+      b.p = (v < n / 16) ? C_CORE_PROB : p;
+      adj_lst_add_undir_edge(a, u, v, NULL, bern, &b);
+    }
+  }
+}
+
+/**
+   Tests kcore_pthread on random graphs and random graphs with a dense
+   core against kcore with 1 to num_threads threads.
+*/
+void run_random_graph_test(size_t log_start,
+			   size_t log_end,
+			   size_t num_threads){
+  int res = 1;
+  size_t i, j, l, n, max_core;
+  size_t *core = NULL, *core_wo = NULL;
+  bern_arg_t b;
+  graph_t g;
+  adj_lst_t a;
+  core = malloc_perror((size_t)1 << log_end, sizeof(size_t));
+  core_wo = malloc_perror((size_t)1 << log_end, sizeof(size_t));
+  printf("Run kcore_pthread test on random graphs against kcore\n");
+  for (l = log_start; l <= log_end; l++){
+    n = (size_t)1 << l;
+    for (i = 0; i < 2 * C_PROBS_COUNT; i++){
+      if (i < C_PROBS_COUNT){
+	b.p = C_PROBS[i];
+	adj_lst_rand_undir(&a, n, bern, &b);
+      }else{
+	core_graph_init(&a, &g, n, C_PROBS[i - C_PROBS_COUNT] / 8);
+	graph_free(&g);
+      }
+      max_core = kcore(&a, core_wo, NULL);
+      for (j = 1; j <= num_threads; j++){
+	res *= (kcore_pthread(&a, core, j, NULL) == max_core);
+	res *= (memcmp(core, core_wo, n * sizeof(size_t)) == 0);
+      }
+      adj_lst_free(&a);
+    }
+  }
+  printf("\t2^%lu <= V <= 2^%lu, 1 to %lu threads --> ",
+	 TOLU(log_start), TOLU(log_end), TOLU(num_threads));
+  print_test_result(res);
+  free(core);
+  free(core_wo);
+  core = NULL;
+  core_wo = NULL;
+}
+
+/**
+   Runs kcore and kcore_pthread with 1 to num_threads threads on a random
+   graph with a dense core, and prints the counts and times.
+*/
+void run_perf_test(size_t log_n, size_t num_threads){
+  int res = 1;
+  size_t i, max_core;
+  size_t n = (size_t)1 << log_n;
+  size_t *core = NULL, *core_wo = NULL;
+  graph_t g;
+  adj_lst_t a;
+  kcore_stats_t st;
+  kcore_pthread_stats_t pst;
+  core = malloc_perror(n, sizeof(size_t));
+  core_wo = malloc_perror(n, sizeof(size_t));
+  core_graph_init(&a, &g, n, (n > 1) ? C_PERF_DEG / (n - 1) : C_PROB_ONE);
+  max_core = kcore(&a, core_wo, &st);
+  printf("Run kcore_pthread performance test on a random graph with a "
+	 "dense core\n");
+  printf("\tvertices: %lu, edges: %lu, degeneracy: %lu\n",
+	 TOLU(a.num_vts), TOLU(a.num_es / 2), TOLU(max_core));
+  printf("\t\tkcore:                  init: %.4f, peel: %.4f seconds\n",
+	 st.init_secs, st.peel_secs);
+  for (i = 1; i <= num_threads; i *= 2){
+    res *= (kcore_pthread(&a, core, i, &pst) == max_core);
+    res *= (memcmp(core, core_wo, n * sizeof(size_t)) == 0);
+    printf("\t\tkcore_pthread, %2lu threads: levels: %lu, rounds: %lu, "
+	   "undos: %lu\n"
+	   "\t\t                        init: %.4f, peel: %.4f seconds\n",
+	   TOLU(i), TOLU(pst.num_levels), TOLU(pst.num_rounds),
+	   TOLU(pst.num_undos), pst.init_secs, pst.peel_secs);
+  }
+  printf("\tequal core numbers --> ");
+  print_test_result(res);
+  adj_lst_free(&a);
+  graph_free(&g);
+  free(core);
+  free(core_wo);
+  core = NULL;
+  core_wo = NULL;
+}
+
+/**
+   Prints a test result.
+*/
+void print_test_result(int res){
+  if (res){
+    printf("SUCCESS\n");
+  }else{
+    printf("FAILURE\n");
+  }
+}
+
+int main(int argc, char *argv[]){
+  int i;
+  size_t *args = NULL;
+  RGENS_SEED();
+  if (argc > C_ARGC_MAX){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  args = malloc_perror(C_ARGC_MAX - 1, sizeof(size_t));
+  memcpy(args, C_ARGS_DEF, (C_ARGC_MAX - 1) * sizeof(size_t));
+  for (i = 1; i < argc; i++){
+    args[i - 1] = atoi(argv[i]);
+  }
+  if (args[0] > C_FULL_BIT / 2 ||
+      args[1] > C_FULL_BIT / 2 ||
+      args[2] > C_FULL_BIT / 2 ||
+      args[0] > args[1] ||
+      args[3] < 1 ||
+      args[4] > 1 ||
+      args[5] > 1){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  if (args[4]) run_random_graph_test(args[0], args[1], args[3]);
+  if (args[5]) run_perf_test(args[2], args[3]);
+  free(args);
+  args = NULL;
+  return 0;
+}
@@ -0,0 +1,321 @@
+/**
+   kcore-pthread.c
+
+   Functions for computing the k-core decomposition of undirected graphs
+   with vertices indexed from 0 by parallel level-synchronous peeling.
+
+   Each thread owns a range of vertices of equal count for computing the
+   degrees, the minimum current degree of its unpeeled vertices, and the
+   first frontier of a level. The vertices of a frontier are taken in
+   chunks of C_CHUNK_COUNT from a shared counter. A thread appends
+   vertices to a frontier through a buffer of C_BUF_COUNT vertices, and
+   reserves space in the frontier with one atomic addition per buffer.
+   The threads are synchronized by a barrier, and the first thread updates
+   the shared state between barriers.
+
+   The current degree of a neighbor u of a peeled vertex is decremented
+   only if it is greater than k. If concurrent decrements bring it below
+   k + 1, the decrements that observed a value of at most k are reverted,
+   so that the current degree of u is k when u is peeled at level k.
+
+   The atomic operations are __sync builtins if the compiler provides them,
+   and are otherwise serialized by a mutex.
+
+   The implementation does not use stdint.h and is portable under C89/C90
+   with the requirement that pthreads API is available.
+*/
+
+#define _POSIX_C_SOURCE 200112L
+
+#define UTILITIES_MEM_TAG MEM_TAG_GRAPH
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "kcore-pthread.h"
+#include "graph.h"
+#include "stack.h"
+#include "utilities-mem.h"
+#include "utilities-pthread.h"
+#include "utilities-time.h"
+
+#if defined(__GNUC__)
+#define FETCH_ADD(p, v) __sync_fetch_and_add((p), (v))
+#define FETCH_SUB(p, v) __sync_fetch_and_sub((p), (v))
+#else
+static pthread_mutex_t fetch_mutex = PTHREAD_MUTEX_INITIALIZER;
+static size_t fetch_add(size_t *p, size_t v);
+#define FETCH_ADD(p, v) fetch_add((p), (v))
+#define FETCH_SUB(p, v) fetch_add((p), (size_t)0 - (v))
+#endif
+
+static const size_t C_CHUNK_COUNT = 64;
+static const size_t C_BUF_COUNT = 256;
+static const size_t C_NR = (size_t)-1;
+
+typedef struct{
+  int done;
+  size_t k; /* current level */
+  size_t lb; /* lower bound of the current degrees of unpeeled vertices */
+  size_t cur_count; /* # vertices in the current frontier */
+  size_t cur_next; /* first untaken index of the current frontier */
+  size_t next_count; /* # vertices in the next frontier */
+  size_t num_levels;
+  size_t num_rounds;
+  size_t num_threads;
+  size_t *core; /* current degrees */
+  size_t *cur;
+  size_t *next;
+  const adj_lst_t *a;
+  struct peel_arg *pas;
+  barrier_t barrier;
+} peel_t;
+
+typedef struct peel_arg{
+  size_t ix;
+  size_t start, end; /* range of vertices */
+  size_t min; /* min current degree of unpeeled vertices in the range */
+  size_t num_undos;
+  size_t buf_count;
+  size_t *buf;
+  peel_t *p;
+} peel_arg_t;
+
+static void *peel_thread(void *arg);
+static void peel_frontier(peel_arg_t *pa);
+static void select_level(peel_t *p);
+static void swap_frontiers(peel_t *p);
+static void push(peel_arg_t *pa, size_t v, size_t *elts, size_t *count);
+static void flush(peel_arg_t *pa, size_t *elts, size_t *count);
+
+/**
+   Computes and copies to an array pointed to by core the core number of
+   each vertex, and returns the maximum core number, i.e. the degeneracy
+   of the graph, or 0 if there are no vertices.
+   a           : pointer to an adjacency list of an undirected graph
+   core        : pointer to a preallocated array with the count equal to
+                 the number of vertices in the adjacency list
+   num_threads : > 0 number of threads
+   stats       : - NULL pointer, if operations are not counted
+                 - a pointer to a block of size
+                 sizeof(kcore_pthread_stats_t), where the counts and phase
+                 times of the run are copied
+*/
+size_t kcore_pthread(const adj_lst_t *a,
+		     size_t *core,
+		     size_t num_threads,
+		     kcore_pthread_stats_t *stats){
+  size_t i, max_core;
+  size_t n = a->num_vts;
+  double t = 0.0;
+  peel_t p;
+  pthread_t *ids = NULL;
+  if (stats != NULL){
+    memset(stats, 0, sizeof(kcore_pthread_stats_t));
+    t = time_wall();
+  }
+  p.done = 0;
+  p.k = 0;
+  p.lb = 0;
+  p.cur_count = 0;
+  p.cur_next = 0;
+  p.next_count = 0;
+  p.num_levels = 0;
+  p.num_rounds = 0;
+  p.num_threads = num_threads;
+  p.core = core;
+  p.cur = malloc_perror(n + 1, sizeof(size_t));
+  p.next = malloc_perror(n + 1, sizeof(size_t));
+  p.a = a;
+  p.pas = malloc_perror(num_threads, sizeof(peel_arg_t));
+  barrier_init_perror(&p.barrier, num_threads);
+  ids = malloc_perror(num_threads, sizeof(pthread_t));
+  for (i = 0; i < num_threads; i++){
+    p.pas[i].ix = i;
+    p.pas[i].start = n / num_threads * i + ((i < n % num_threads) ?
+					     i : n % num_threads);
+    p.pas[i].end = p.pas[i].start + n / num_threads +
+      (i < n % num_threads);
+    p.pas[i].min = C_NR;
+    p.pas[i].num_undos = 0;
+    p.pas[i].buf_count = 0;
+    p.pas[i].buf = malloc_perror(C_BUF_COUNT, sizeof(size_t));
+    p.pas[i].p = &p;
+  }
+  if (stats != NULL){
+    stats->init_secs = time_wall() - t;
+    t = time_wall();
+  }
+  for (i = 1; i < num_threads; i++){
+    thread_create_perror(&ids[i], peel_thread, &p.pas[i]);
+  }
+  peel_thread(&p.pas[0]);
+  for (i = 1; i < num_threads; i++){
+    thread_join_perror(ids[i], NULL);
+  }
+  if (stats != NULL){
+    stats->peel_secs = time_wall() - t;
+    stats->num_levels = p.num_levels;
+    stats->num_rounds = p.num_rounds;
+    t = time_wall();
+  }
+  max_core = (p.num_levels > 0) ? p.k : 0;
+  for (i = 0; i < num_threads; i++){
+    if (stats != NULL) stats->num_undos += p.pas[i].num_undos;
+    free(p.pas[i].buf);
+  }
+  free(p.cur);
+  free(p.next);
+  free(p.pas);
+  free(ids);
+  p.cur = NULL;
+  p.next = NULL;
+  p.pas = NULL;
+  ids = NULL;
+  if (stats != NULL) stats->free_secs = time_wall() - t;
+  return max_core;
+}
+
+/**
+   Runs the levels of peeling on a thread.
+*/
+static void *peel_thread(void *arg){
+  size_t v;
+  peel_arg_t *pa = arg;
+  peel_t *p = pa->p;
+  for (v = pa->start; v < pa->end; v++){
+    p->core[v] = p->a->vt_wts[v]->num_elts;
+  }
+  barrier_wait_perror(&p->barrier);
+  while (1){
+    pa->min = C_NR;
+    for (v = pa->start; v < pa->end; v++){
+      if (p->core[v] >= p->lb && p->core[v] < pa->min){
+	pa->min = p->core[v];
+      }
+    }
+    barrier_wait_perror(&p->barrier);
+    if (pa->ix == 0) select_level(p);
+    barrier_wait_perror(&p->barrier);
+    if (p->done) break;
+    for (v = pa->start; v < pa->end; v++){
+      if (p->core[v] == p->k) push(pa, v, p->cur, &p->cur_count);
+    }
+    flush(pa, p->cur, &p->cur_count);
+    barrier_wait_perror(&p->barrier);
+    while (p->cur_count > 0){
+      peel_frontier(pa);
+      flush(pa, p->next, &p->next_count);
+      barrier_wait_perror(&p->barrier);
+      if (pa->ix == 0) swap_frontiers(p);
+      barrier_wait_perror(&p->barrier);
+    }
+  }
+  return NULL;
+}
+
+/**
+   Peels the vertices of the current frontier in chunks, and appends the
+   neighbors whose current degrees drop to the level to the next frontier.
+*/
+static void peel_frontier(peel_arg_t *pa){
+  const char *q = NULL, *q_start = NULL, *q_end = NULL;
+  size_t i, i_end, u, v, d;
+  peel_t *p = pa->p;
+  const adj_lst_t *a = p->a;
+  size_t k = p->k;
+  while ((i = FETCH_ADD(&p->cur_next, C_CHUNK_COUNT)) < p->cur_count){
+    i_end = (p->cur_count - i < C_CHUNK_COUNT) ?
+      p->cur_count : i + C_CHUNK_COUNT;
+    for (; i < i_end; i++){
+      v = p->cur[i];
+      q_start = a->vt_wts[v]->elts;
+      q_end = q_start + a->vt_wts[v]->num_elts * a->pair_size;
+      for (q = q_start; q != q_end; q += a->pair_size){
+	u = *(const size_t *)q;
+	if (p->core[u] <= k) continue;
+	d = FETCH_SUB(&p->core[u], 1);
+	if (d == k + 1){
+	  push(pa, u, p->next, &p->next_count);
+	}else if (d <= k){
+	  FETCH_ADD(&p->core[u], 1);
+	  pa->num_undos++;
+	}
+      }
+    }
+  }
+}
+
+/**
+   Selects the next level as the minimum current degree of the unpeeled
+   vertices, or sets done if all vertices are peeled. Called by the first
+   thread between barriers.
+*/
+static void select_level(peel_t *p){
+  size_t i, min = C_NR;
+  for (i = 0; i < p->num_threads; i++){
+    if (p->pas[i].min < min) min = p->pas[i].min;
+  }
+  if (min == C_NR){
+    p->done = 1;
+  }else{
+    p->k = min;
+    p->num_levels++;
+  }
+  p->cur_count = 0;
+  p->cur_next = 0;
+}
+
+/**
+   Makes the next frontier current, and raises the lower bound of the
+   current degrees of the unpeeled vertices if the level is complete.
+   Called by the first thread between barriers.
+*/
+static void swap_frontiers(peel_t *p){
+  size_t *t = p->cur;
+  p->cur = p->next;
+  p->next = t;
+  p->cur_count = p->next_count;
+  p->cur_next = 0;
+  p->next_count = 0;
+  p->num_rounds++;
+  if (p->cur_count == 0) p->lb = p->k + 1;
+}
+
+/**
+   Appends a vertex to the buffer of a thread, and flushes the buffer to
+   a frontier if the buffer is full.
+*/
+static void push(peel_arg_t *pa, size_t v, size_t *elts, size_t *count){
+  pa->buf[pa->buf_count] = v;
+  pa->buf_count++;
+  if (pa->buf_count == C_BUF_COUNT) flush(pa, elts, count);
+}
+
+/**
+   Copies the buffer of a thread to a frontier at an atomically reserved
+   offset, and empties the buffer.
+*/
+static void flush(peel_arg_t *pa, size_t *elts, size_t *count){
+  size_t offset;
+  if (pa->buf_count == 0) return;
+  offset = FETCH_ADD(count, pa->buf_count);
+  memcpy(elts + offset, pa->buf, pa->buf_count * sizeof(size_t));
+  pa->buf_count = 0;
+}
+
+#if !defined(__GNUC__)
+/**
+   Adds v to the value pointed to by p and returns the previous value,
+   serialized by a mutex.
+*/
+static size_t fetch_add(size_t *p, size_t v){
+  size_t prev;
+  mutex_lock_perror(&fetch_mutex);
+  prev = *p;
+  *p += v;
+  mutex_unlock_perror(&fetch_mutex);
+  return prev;
+}
+#endif
@@ -0,0 +1,66 @@
+/**
+   kcore-pthread.h
+
+   Declarations of accessible functions for computing the k-core
+   decomposition of undirected graphs with vertices indexed from 0 by
+   parallel level-synchronous peeling.
+
+   The core numbers are computed level by level. At level k, which is the
+   minimum current degree of the unpeeled vertices, the vertices with
+   current degree k form the first frontier. In each round, the threads
+   peel the vertices of the frontier in chunks taken from a shared
+   counter, and decrement the current degrees of their neighbors with
+   atomic operations; a neighbor whose current degree drops from k + 1 to
+   k is added to the frontier of the next round. The level ends when a
+   frontier is empty. The core number of a vertex is the level at which it
+   is peeled.
+
+   The peeling uses the core array and two frontier arrays of V entries,
+   and a small buffer per thread. The number of rounds is at least the
+   number of levels, and each level scans the vertices twice, so that the
+   parallel peeling is suited for large graphs with a moderate degeneracy;
+   kcore in graph-algorithms/kcore computes the same core numbers in
+   O(V + E) time with a single thread.
+
+   The adjacency list is expected to represent an undirected graph without
+   loops and multiple edges, e.g. built with adj_lst_undir_build or
+   adj_lst_rand_undir. The weights, if any, are not used.
+
+   If a pointer to a kcore_pthread_stats_t block is passed, the algorithm
+   counts its operations and measures the wall-clock time of its phases.
+*/
+
+#ifndef KCORE_PTHREAD_H
+#define KCORE_PTHREAD_H
+
+#include <stddef.h>
+#include "graph.h"
+
+typedef struct{
+  size_t num_levels; /* # levels with at least one peeled vertex */
+  size_t num_rounds; /* # synchronous rounds across levels */
+  size_t num_undos; /* # decrements reverted below the current level */
+  double init_secs; /* wall-clock time of allocation */
+  double peel_secs; /* wall-clock time of the threads */
+  double free_secs; /* wall-clock time of freeing the frontiers */
+} kcore_pthread_stats_t;
+
+/**
+   Computes and copies to an array pointed to by core the core number of
+   each vertex, and returns the maximum core number, i.e. the degeneracy
+   of the graph, or 0 if there are no vertices.
+   a           : pointer to an adjacency list of an undirected graph
+   core        : pointer to a preallocated array with the count equal to
+                 the number of vertices in the adjacency list
+   num_threads : > 0 number of threads
+   stats       : - NULL pointer, if operations are not counted
+                 - a pointer to a block of size
+                 sizeof(kcore_pthread_stats_t), where the counts and phase
+                 times of the run are copied
+*/
+size_t kcore_pthread(const adj_lst_t *a,
+		     size_t *core,
+		     size_t num_threads,
+		     kcore_pthread_stats_t *stats);
+
+#endif
@@ -0,0 +1,369 @@
+/**
+   pagerank-pthread-test.c
+
+   Tests of PageRank and personalized PageRank by parallel pull-based
+   power iteration.
+
+   The following command line arguments can be used to customize tests:
+   pagerank-pthread-test
+     [0, # bits in size_t / 2] : a
+     [0, # bits in size_t / 2] : b s.t. 2^a <= V <= 2^b for random graph
+                                 tests
+     [0, # bits in size_t / 2] : c s.t. V = 2^c for the performance test
+     [1, # threads] : n for 1 <= # threads <= n
+     [0, 1] : on/off for random graph test
+     [0, 1] : on/off for convergence test
+     [0, 1] : on/off for performance test
+
+   usage examples:
+   ./pagerank-pthread-test
+   ./pagerank-pthread-test 5 10
+   ./pagerank-pthread-test 5 10 20 8 0 0 1
+
+   pagerank-pthread-test can be run with any subset of command line
+   arguments in the above-defined order. If the (i + 1)th argument is
+   specified then the ith argument must be specified for i >= 0. Default
+   values are used for the unspecified arguments according to the
+   C_ARGS_DEF array.
+
+   The implementation of tests does not use stdint.h and is portable under
+   C89/C90 with the requirement that pthreads API is available.
+*/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include "pagerank-pthread.h"
+#include "graph.h"
+#include "stack.h"
+#include "utilities-mem.h"
+
+/**
+   Generate random numbers in a portable way for test purposes only; rand()
+   in the Linux C Library uses the same generator as random(), which may not
+   be the case on older rand() implementations, and on current
+   implementations on different systems.
+*/
+#ifdef TEST_SEED
+#define RGENS_SEED() do{srand(TEST_SEED);}while (0)
+#else
+#define RGENS_SEED() do{srand(time(NULL));}while (0)
+#endif
+#define RANDOM() (rand()) /* [0, RAND_MAX] */
+#define DRAND() ((double)rand() / RAND_MAX) /* [0.0, 1.0] */
+
+#define TOLU(i) ((unsigned long int)(i)) /* printing size_t under C89/C90 */
+
+/* input handling */
+const char *C_USAGE =
+  "pagerank-pthread-test \n"
+  "[0, # bits in size_t / 2] : a \n"
+  "[0, # bits in size_t / 2] : b s.t. 2^a <= V <= 2^b for random graph \n"
+  "                            tests \n"
+  "[0, # bits in size_t / 2] : c s.t. V = 2^c for the performance test \n"
+  "[1, # threads] : n for 1 <= # threads <= n \n"
+  "[0, 1] : on/off for random graph test \n"
+  "[0, 1] : on/off for convergence test \n"
+  "[0, 1] : on/off for performance test \n";
+const int C_ARGC_MAX = 8;
+const size_t C_ARGS_DEF[7] = {0, 8, 17, 4, 1, 1, 1};
+const size_t C_FULL_BIT = CHAR_BIT * sizeof(size_t);
+
+/* tests */
+const double C_PROB_ONE = 1.0;
+const double C_PROB_ZERO = 0.0;
+const double C_PROBS[5] = {1.0, 0.2, 0.05, 0.01, 0.0};
+const size_t C_PROBS_COUNT = 5;
+const double C_DAMP = 0.85;
+const double C_TOL = 1e-10;
+const size_t C_ITERS = 30;
+const size_t C_MAX_ITERS = 1000;
+const size_t C_SEED_COUNT = 8;
+const size_t C_PERF_DEG = 16;
+const double C_ERR = 1e-12;
+
+typedef struct{
+  double p;
+} bern_arg_t;
+
+int bern(void *arg);
+void naive_pagerank(const adj_lst_t *a,
+		    const size_t *seed,
+		    double *ranks,
+		    size_t num_iters);
+int ranks_equal(const double *a, const double *b, size_t n);
+void print_test_result(int res);
+
+int bern(void *arg){
+  bern_arg_t *b = arg;
+  if (b->p >= C_PROB_ONE) return 1;
+  if (b->p <= C_PROB_ZERO) return 0;
+  if (b->p > DRAND()) return 1;
+  return 0;
+}
+
+/**
+   Computes the PageRank of each vertex, or the personalized PageRank for
+   a seed if seed is not NULL, by num_iters push-based iterations over the
+   adjacency list.
+*/
+void naive_pagerank(const adj_lst_t *a,
+		    const size_t *seed,
+		    double *ranks,
+		    size_t num_iters){
+  const char *p = NULL, *p_start = NULL, *p_end = NULL;
+  size_t i, u;
+  size_t n = a->num_vts;
+  double dang, share;
+  double *x = NULL, *t = NULL;
+  x = malloc_perror(n, sizeof(double));
+  t = malloc_perror(n, sizeof(double));
+  for (u = 0; u < n; u++){
+    t[u] = (seed == NULL) ? 1.0 / n : (double)(u == *seed);
+  }
+  memcpy(ranks, t, n * sizeof(double));
+  for (i = 0; i < num_iters; i++){
+    memset(x, 0, n * sizeof(double));
+    dang = 0.0;
+    for (u = 0; u < n; u++){
+      if (a->vt_wts[u]->num_elts == 0){
+	dang += ranks[u];
+	continue;
+      }
+      share = ranks[u] / a->vt_wts[u]->num_elts;
+      p_start = a->vt_wts[u]->elts;
+      p_end = p_start + a->vt_wts[u]->num_elts * a->pair_size;
+      for (p = p_start; p != p_end; p += a->pair_size){
+	x[*(const size_t *)p] += share;
+      }
+    }
+    for (u = 0; u < n; u++){
+      ranks[u] = (1.0 - C_DAMP) * t[u] + C_DAMP * (x[u] + dang * t[u]);
+    }
+  }
+  free(x);
+  free(t);
+  x = NULL;
+  t = NULL;
+}
+
+/**
+   Returns 1 if the ranks are equal within an absolute error, and 0
+   otherwise.
+*/
+int ranks_equal(const double *a, const double *b, size_t n){
+  size_t i;
+  for (i = 0; i < n; i++){
+    if (a[i] - b[i] > C_ERR || b[i] - a[i] > C_ERR) return 0;
+  }
+  return 1;
+}
+
+/**
+   Tests pagerank_pthread and ppr_pthread with C_ITERS iterations on
+   random directed graphs, including vertices without outgoing edges,
+   against naive_pagerank with 1 to num_threads threads.
+*/
+void run_random_graph_test(size_t log_start,
+			   size_t log_end,
+			   size_t num_threads){
+  int res = 1, res_ppr = 1, res_sum = 1;
+  size_t i, j, l, s, u, n;
+  size_t seeds[8];
+  double sum;
+  double *ranks = NULL, *ranks_wo = NULL, *col = NULL;
+  bern_arg_t b;
+  adj_lst_t a;
+  n = (size_t)1 << log_end;
+  ranks = malloc_perror(n * C_SEED_COUNT, sizeof(double));
+  ranks_wo = malloc_perror(n, sizeof(double));
+  col = malloc_perror(n, sizeof(double));
+  printf("Run pagerank_pthread and ppr_pthread test on random directed "
+	 "graphs\n");
+  for (l = log_start; l <= log_end; l++){
+    n = (size_t)1 << l;
+    for (i = 0; i < C_PROBS_COUNT; i++){
+      b.p = C_PROBS[i];
+      adj_lst_rand_dir(&a, n, bern, &b);
+      naive_pagerank(&a, NULL, ranks_wo, C_ITERS);
+      for (s = 0; s < C_SEED_COUNT; s++){
+	seeds[s] = RANDOM() % n;
+      }
+      for (j = 1; j <= num_threads; j++){
+	res *= (pagerank_pthread(&a, ranks, C_DAMP, 0.0, C_ITERS, j, NULL) ==
+		C_ITERS);
+	res *= ranks_equal(ranks, ranks_wo, n);
+	sum = 0.0;
+	for (u = 0; u < n; u++){
+	  sum += ranks[u];
+	}
+	res_sum *= (sum - 1.0 < C_ERR * n && 1.0 - sum < C_ERR * n);
+	res_ppr *= (ppr_pthread(&a, seeds, C_SEED_COUNT, ranks,
+				C_DAMP, 0.0, C_ITERS, j, NULL) == C_ITERS);
+	for (s = 0; s < C_SEED_COUNT; s++){
+	  naive_pagerank(&a, &seeds[s], ranks_wo, C_ITERS);
+	  for (u = 0; u < n; u++){
+	    col[u] = ranks[u * C_SEED_COUNT + s];
+	  }
+	  res_ppr *= ranks_equal(col, ranks_wo, n);
+	}
+	naive_pagerank(&a, NULL, ranks_wo, C_ITERS);
+      }
+      adj_lst_free(&a);
+    }
+  }
+  printf("\t2^%lu <= V <= 2^%lu, 1 to %lu threads\n",
+	 TOLU(log_start), TOLU(log_end), TOLU(num_threads));
+  printf("\t\tPageRank --> ");
+  print_test_result(res);
+  printf("\t\tsum of ranks --> ");
+  print_test_result(res_sum);
+  printf("\t\tpersonalized PageRank, %lu seeds --> ",
+	 TOLU(C_SEED_COUNT));
+  print_test_result(res_ppr);
+  free(ranks);
+  free(ranks_wo);
+  free(col);
+  ranks = NULL;
+  ranks_wo = NULL;
+  col = NULL;
+}
+
+/**
+   Tests that the ranks on complete graphs converge to 1 / V within the
+   tolerance, and that the iteration on random graphs ends before
+   C_MAX_ITERS iterations with a difference less than the tolerance.
+*/
+void run_conv_test(size_t log_start, size_t log_end, size_t num_threads){
+  int res = 1;
+  size_t i, l, u, n, num_iters;
+  double *ranks = NULL;
+  bern_arg_t b;
+  adj_lst_t a;
+  pagerank_stats_t st;
+  ranks = malloc_perror((size_t)1 << log_end, sizeof(double));
+  printf("Run pagerank_pthread convergence test\n");
+  for (l = log_start; l <= log_end; l++){
+    n = (size_t)1 << l;
+    for (i = 0; i < C_PROBS_COUNT; i++){
+      b.p = C_PROBS[i];
+      adj_lst_rand_dir(&a, n, bern, &b);
+      num_iters = pagerank_pthread(&a, ranks, C_DAMP, C_TOL, C_MAX_ITERS,
+				   num_threads, &st);
+      res *= (num_iters < C_MAX_ITERS && st.diff < C_TOL);
+      if (b.p >= C_PROB_ONE || b.p <= C_PROB_ZERO){
+	for (u = 0; u < n; u++){
+	  res *= (ranks[u] - 1.0 / n < C_TOL && 1.0 / n - ranks[u] < C_TOL);
+	}
+      }
+      adj_lst_free(&a);
+    }
+  }
+  printf("\t2^%lu <= V <= 2^%lu, %lu threads --> ",
+	 TOLU(log_start), TOLU(log_end), TOLU(num_threads));
+  print_test_result(res);
+  free(ranks);
+  ranks = NULL;
+}
+
+/**
+   Runs pagerank_pthread and ppr_pthread with C_SEED_COUNT seeds on a
+   random directed graph with C_PERF_DEG edges per vertex, where the
+   targets of the edges are skewed towards vertices of small index, with
+   1 to num_threads threads, and prints the counts, times, and
+   throughputs.
+*/
+void run_perf_test(size_t log_n, size_t num_threads){
+  size_t i, u, v;
+  size_t n = (size_t)1 << log_n;
+  size_t seeds[8];
+  double r;
+  double *ranks = NULL;
+  bern_arg_t b;
+  graph_t g;
+  adj_lst_t a;
+  pagerank_stats_t st;
+  ranks = malloc_perror(n * C_SEED_COUNT, sizeof(double));
+  b.p = C_PROB_ONE;
+  graph_base_init(&g, n, 0);
+  adj_lst_init(&a, &g);
+  for (u = 0; u < n; u++){
+    for (i = 0; i < C_PERF_DEG; i++){
+      r = DRAND();
+      v = (size_t)(r * r * (n - 1));
+      adj_lst_add_dir_edge(&a, u, v, NULL, bern, &b);
+    }
+  }
+  for (i = 0; i < C_SEED_COUNT; i++){
+    seeds[i] = RANDOM() % n;
+  }
+  printf("Run pagerank_pthread and ppr_pthread performance test\n");
+  printf("\tvertices: %lu, edges: %lu, tolerance: %.0e\n",
+	 TOLU(a.num_vts), TOLU(a.num_es), C_TOL);
+  for (i = 1; i <= num_threads; i *= 2){
+    pagerank_pthread(&a, ranks, C_DAMP, C_TOL, C_MAX_ITERS, i, &st);
+    printf("\t\tPageRank, %2lu threads:   iterations: %lu, "
+	   "build: %.4f, iterations: %.4f seconds, %.3e edges/s\n",
+	   TOLU(i), TOLU(st.num_iters), st.build_secs, st.iter_secs,
+	   st.edges_per_sec);
+    ppr_pthread(&a, seeds, C_SEED_COUNT, ranks,
+		C_DAMP, C_TOL, C_MAX_ITERS, i, &st);
+    printf("\t\tPPR %lu seeds, %2lu threads: iterations: %lu, "
+	   "build: %.4f, iterations: %.4f seconds, %.3e edges/s, "
+	   "%.3e seed-edges/s\n",
+	   TOLU(C_SEED_COUNT), TOLU(i), TOLU(st.num_iters), st.build_secs,
+	   st.iter_secs, st.edges_per_sec,
+	   st.edges_per_sec * C_SEED_COUNT);
+  }
+  adj_lst_free(&a);
+  graph_free(&g);
+  free(ranks);
+  ranks = NULL;
+}
+
+/**
+   Prints a test result.
+*/
+void print_test_result(int res){
+  if (res){
+    printf("SUCCESS\n");
+  }else{
+    printf("FAILURE\n");
+  }
+}
+
+int main(int argc, char *argv[]){
+  int i;
+  size_t *args = NULL;
+  RGENS_SEED();
+  if (argc > C_ARGC_MAX){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  args = malloc_perror(C_ARGC_MAX - 1, sizeof(size_t));
+  memcpy(args, C_ARGS_DEF, (C_ARGC_MAX - 1) * sizeof(size_t));
+  for (i = 1; i < argc; i++){
+    args[i - 1] = atoi(argv[i]);
+  }
+  if (args[0] > C_FULL_BIT / 2 ||
+      args[1] > C_FULL_BIT / 2 ||
+      args[2] > C_FULL_BIT / 2 ||
+      args[0] > args[1] ||
+      args[3] < 1 ||
+      args[4] > 1 ||
+      args[5] > 1 ||
+      args[6] > 1){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  if (args[4]) run_random_graph_test(args[0], args[1], args[3]);
+  if (args[5]) run_conv_test(args[0], args[1], args[3]);
+  if (args[6]) run_perf_test(args[2], args[3]);
+  free(args);
+  args = NULL;
+  return 0;
+}
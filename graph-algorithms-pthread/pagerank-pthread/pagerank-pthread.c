@@ -0,0 +1,423 @@
+/**
+   pagerank-pthread.c
+
+   Functions for computing PageRank and personalized PageRank of the
+   vertices of graphs with vertices indexed from 0, by parallel pull-based
+   power iteration.
+
+   The transpose of the adjacency list is built in two passes without
+   comparison sorting: the first pass counts the incoming edges of each
+   vertex, and the second pass appends each vertex u to the incoming sets
+   of its out-neighbors in the ascending order of u. The incoming sets are
+   in a single array with offsets.
+
+   The vertices are split into num_threads ranges of consecutive vertices
+   with approximately equal sums of the number of incoming edges plus one
+   per vertex. An iteration consists of two phases separated by a barrier:
+   - each thread computes x(u) / deg(u) of the vertices u in its range,
+   and the sums of the ranks of its vertices without outgoing edges,
+   - each thread sums the incoming contributions of the vertices in its
+   range, and computes their next ranks and the L1 norms of the
+   differences.
+   After a second barrier, each thread sums the per-thread norms and the
+   threads end the iteration with the same decision. Each thread keeps
+   its own pointers to the current and next rank vectors and swaps them
+   in each iteration, and the per-thread sums are read only between
+   barriers. The rank vectors are initialized by the threads that update
+   them.
+
+   In the batched personalized mode, the ranks of the k seeds of a vertex
+   are contiguous, and the incoming contributions of the k seeds are summed
+   in one scan of the incoming set of each vertex.
+
+   The implementation does not use stdint.h and is portable under C89/C90
+   with the requirement that pthreads API is available.
+*/
+
+#define _POSIX_C_SOURCE 200112L
+
+#define UTILITIES_MEM_TAG MEM_TAG_GRAPH
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "pagerank-pthread.h"
+#include "graph.h"
+#include "stack.h"
+#include "utilities-mem.h"
+#include "utilities-pthread.h"
+#include "utilities-time.h"
+
+typedef struct{
+  size_t num_vts;
+  size_t num_es;
+  size_t *offs; /* num_vts + 1 offsets of the incoming sets in vts */
+  size_t *vts; /* incoming sets in ascending order */
+  double *inv_degs; /* 1 / outdegree, or 0.0 if there are no out-edges */
+} transpose_t;
+
+typedef struct{
+  size_t num_cols; /* # rank vectors, i.e. # seeds or 1 */
+  size_t num_iters;
+  size_t max_iters;
+  size_t num_threads;
+  double damp;
+  double tol;
+  double diff;
+  double tele; /* uniform teleport probability */
+  const size_t *seeds; /* NULL in PageRank */
+  double *x; /* initial, and after the run the final, rank vectors */
+  double *x_next;
+  double *contrib; /* x(u) / deg(u) */
+  const transpose_t *t;
+  struct pr_arg *pas;
+  barrier_t barrier;
+} pr_t;
+
+typedef struct pr_arg{
+  size_t ix;
+  size_t start, end; /* range of vertices */
+  double *dang; /* per-thread sums of ranks without out-edges */
+  double *dang_sums; /* sums across threads */
+  double *diffs; /* per-thread L1 norms of differences */
+  double *accs; /* incoming contributions of a vertex */
+  pr_t *p;
+} pr_arg_t;
+
+static size_t run(const adj_lst_t *a,
+		  const size_t *seeds,
+		  size_t num_cols,
+		  double *ranks,
+		  double damp,
+		  double tol,
+		  size_t max_iters,
+		  size_t num_threads,
+		  pagerank_stats_t *stats);
+static void *pr_thread(void *arg);
+static void pull(pr_arg_t *pa, const double *x, double *x_next);
+static double tele(const pr_t *p, size_t v, size_t j);
+static void transpose_init(transpose_t *t, const adj_lst_t *a);
+static void transpose_free(transpose_t *t);
+static void split_ranges(pr_arg_t *pas,
+			 const transpose_t *t,
+			 size_t num_threads);
+
+/**
+   Computes and copies to an array pointed to by ranks the PageRank of
+   each vertex, and returns the number of iterations.
+   a           : pointer to an adjacency list with at least one vertex
+   ranks       : pointer to a preallocated array with the count equal to
+                 the number of vertices in the adjacency list
+   damp        : damping factor in [0.0, 1.0), e.g. 0.85
+   tol         : >= 0.0 tolerance of the L1 norm of the difference between
+                 two consecutive rank vectors
+   max_iters   : > 0 maximum number of iterations
+   num_threads : > 0 number of threads
+   stats       : - NULL pointer, if operations are not counted
+                 - a pointer to a block of size sizeof(pagerank_stats_t),
+                 where the counts and phase times of the run are copied
+*/
+size_t pagerank_pthread(const adj_lst_t *a,
+			double *ranks,
+			double damp,
+			double tol,
+			size_t max_iters,
+			size_t num_threads,
+			pagerank_stats_t *stats){
+  return run(a, NULL, 1, ranks, damp, tol, max_iters, num_threads, stats);
+}
+
+/**
+   Computes and copies to an array pointed to by ranks the personalized
+   PageRank of each vertex for each of num_seeds seeds in a batch, and
+   returns the number of iterations. See pagerank-pthread.h for the
+   parameters.
+*/
+size_t ppr_pthread(const adj_lst_t *a,
+		   const size_t *seeds,
+		   size_t num_seeds,
+		   double *ranks,
+		   double damp,
+		   double tol,
+		   size_t max_iters,
+		   size_t num_threads,
+		   pagerank_stats_t *stats){
+  return run(a, seeds, num_seeds, ranks,
+	     damp, tol, max_iters, num_threads, stats);
+}
+
+/**
+   Builds the transpose, runs the iterations on num_threads threads, and
+   copies the final rank vectors to ranks.
+*/
+static size_t run(const adj_lst_t *a,
+		  const size_t *seeds,
+		  size_t num_cols,
+		  double *ranks,
+		  double damp,
+		  double tol,
+		  size_t max_iters,
+		  size_t num_threads,
+		  pagerank_stats_t *stats){
+  size_t i;
+  size_t n = a->num_vts;
+  double t = 0.0;
+  transpose_t tr;
+  pr_t p;
+  pthread_t *ids = NULL;
+  if (stats != NULL){
+    memset(stats, 0, sizeof(pagerank_stats_t));
+    t = time_wall();
+  }
+  transpose_init(&tr, a);
+  if (stats != NULL){
+    stats->build_secs = time_wall() - t;
+    t = time_wall();
+  }
+  p.num_cols = num_cols;
+  p.num_iters = 0;
+  p.max_iters = max_iters;
+  p.num_threads = num_threads;
+  p.damp = damp;
+  p.tol = tol;
+  p.diff = 0.0;
+  p.tele = 1.0 / n;
+  p.seeds = seeds;
+  p.x = ranks;
+  p.x_next = malloc_perror(n, num_cols * sizeof(double));
+  p.contrib = malloc_perror(n, num_cols * sizeof(double));
+  p.t = &tr;
+  p.pas = malloc_perror(num_threads, sizeof(pr_arg_t));
+  barrier_init_perror(&p.barrier, num_threads);
+  ids = malloc_perror(num_threads, sizeof(pthread_t));
+  split_ranges(p.pas, &tr, num_threads);
+  for (i = 0; i < num_threads; i++){
+    p.pas[i].ix = i;
+    p.pas[i].dang = malloc_perror(4 * num_cols, sizeof(double));
+    p.pas[i].dang_sums = p.pas[i].dang + num_cols;
+    p.pas[i].diffs = p.pas[i].dang + 2 * num_cols;
+    p.pas[i].accs = p.pas[i].dang + 3 * num_cols;
+    p.pas[i].p = &p;
+  }
+  for (i = 1; i < num_threads; i++){
+    thread_create_perror(&ids[i], pr_thread, &p.pas[i]);
+  }
+  pr_thread(&p.pas[0]);
+  for (i = 1; i < num_threads; i++){
+    thread_join_perror(ids[i], NULL);
+  }
+  if (p.x != ranks) memcpy(ranks, p.x, n * num_cols * sizeof(double));
+  if (stats != NULL){
+    stats->iter_secs = time_wall() - t;
+    stats->num_iters = p.num_iters;
+    stats->num_edges = p.num_iters * tr.num_es;
+    stats->diff = p.diff;
+    if (stats->iter_secs > 0.0){
+      stats->edges_per_sec = stats->num_edges / stats->iter_secs;
+    }
+    t = time_wall();
+  }
+  for (i = 0; i < num_threads; i++){
+    free(p.pas[i].dang);
+  }
+  free((p.x == ranks) ? p.x_next : p.x);
+  free(p.contrib);
+  free(p.pas);
+  free(ids);
+  transpose_free(&tr);
+  p.x = NULL;
+  p.x_next = NULL;
+  p.contrib = NULL;
+  p.pas = NULL;
+  ids = NULL;
+  if (stats != NULL) stats->free_secs = time_wall() - t;
+  return p.num_iters;
+}
+
+/**
+   Runs the iterations on a thread.
+*/
+static void *pr_thread(void *arg){
+  size_t i, j, u, num_iters = 0;
+  double diff, diff_max;
+  double *x = NULL, *x_next = NULL, *x_tmp = NULL;
+  pr_arg_t *pa = arg;
+  pr_t *p = pa->p;
+  size_t k = p->num_cols;
+  x = p->x;
+  x_next = p->x_next;
+  for (u = pa->start; u < pa->end; u++){
+    for (j = 0; j < k; j++){
+      x[u * k + j] = tele(p, u, j);
+    }
+  }
+  while (1){
+    memset(pa->dang, 0, k * sizeof(double));
+    for (u = pa->start; u < pa->end; u++){
+      if (p->t->inv_degs[u] == 0.0){
+	for (j = 0; j < k; j++){
+	  pa->dang[j] += x[u * k + j];
+	}
+      }else{
+	for (j = 0; j < k; j++){
+	  p->contrib[u * k + j] = x[u * k + j] * p->t->inv_degs[u];
+	}
+      }
+    }
+    barrier_wait_perror(&p->barrier);
+    pull(pa, x, x_next);
+    barrier_wait_perror(&p->barrier);
+    x_tmp = x;
+    x = x_next;
+    x_next = x_tmp;
+    num_iters++;
+    diff_max = 0.0;
+    for (j = 0; j < k; j++){
+      diff = 0.0;
+      for (i = 0; i < p->num_threads; i++){
+	diff += p->pas[i].diffs[j];
+      }
+      if (diff > diff_max) diff_max = diff;
+    }
+    if (diff_max < p->tol || num_iters == p->max_iters) break;
+  }
+  if (pa->ix == 0){
+    p->num_iters = num_iters;
+    p->diff = diff_max;
+    p->x = x;
+    p->x_next = x_next;
+  }
+  return NULL;
+}
+
+/**
+   Computes the next ranks of the vertices in the range of a thread from
+   the incoming contributions, and the L1 norms of the differences.
+*/
+static void pull(pr_arg_t *pa, const double *x, double *x_next){
+  size_t i, j, v;
+  const size_t *q = NULL, *q_end = NULL;
+  double s, tv, r, d;
+  pr_t *p = pa->p;
+  const transpose_t *t = p->t;
+  const double *contrib = p->contrib;
+  size_t k = p->num_cols;
+  double damp = p->damp;
+  for (j = 0; j < k; j++){
+    pa->dang_sums[j] = 0.0;
+    pa->diffs[j] = 0.0;
+    for (i = 0; i < p->num_threads; i++){
+      pa->dang_sums[j] += p->pas[i].dang[j];
+    }
+  }
+  for (v = pa->start; v < pa->end; v++){
+    q = t->vts + t->offs[v];
+    q_end = t->vts + t->offs[v + 1];
+    if (k == 1){
+      s = 0.0;
+      for (; q != q_end; q++){
+	s += contrib[*q];
+      }
+      pa->accs[0] = s;
+    }else{
+      memset(pa->accs, 0, k * sizeof(double));
+      for (; q != q_end; q++){
+	for (j = 0; j < k; j++){
+	  pa->accs[j] += contrib[*q * k + j];
+	}
+      }
+    }
+    for (j = 0; j < k; j++){
+      tv = tele(p, v, j);
+      r = (1.0 - damp) * tv + damp * (pa->accs[j] + pa->dang_sums[j] * tv);
+      d = r - x[v * k + j];
+      pa->diffs[j] += (d < 0.0) ? -d : d;
+      x_next[v * k + j] = r;
+    }
+  }
+}
+
+/**
+   Returns the teleport probability of a vertex for the jth rank vector.
+*/
+static double tele(const pr_t *p, size_t v, size_t j){
+  if (p->seeds == NULL) return p->tele;
+  return (p->seeds[j] == v) ? 1.0 : 0.0;
+}
+
+/**
+   Builds the transpose of an adjacency list and the inverse outdegrees.
+*/
+static void transpose_init(transpose_t *t, const adj_lst_t *a){
+  const char *p = NULL, *p_start = NULL, *p_end = NULL;
+  size_t u, v;
+  size_t n = a->num_vts;
+  size_t *next = NULL;
+  t->num_vts = n;
+  t->num_es = 0;
+  t->offs = calloc_perror(n + 1, sizeof(size_t));
+  t->inv_degs = malloc_perror(n, sizeof(double));
+  for (u = 0; u < n; u++){
+    p_start = a->vt_wts[u]->elts;
+    p_end = p_start + a->vt_wts[u]->num_elts * a->pair_size;
+    for (p = p_start; p != p_end; p += a->pair_size){
+      t->offs[*(const size_t *)p + 1]++;
+    }
+    t->num_es += a->vt_wts[u]->num_elts;
+    t->inv_degs[u] = (a->vt_wts[u]->num_elts == 0) ?
+      0.0 : 1.0 / a->vt_wts[u]->num_elts;
+  }
+  for (v = 0; v < n; v++){
+    t->offs[v + 1] += t->offs[v];
+  }
+  t->vts = malloc_perror(t->num_es + 1, sizeof(size_t));
+  next = malloc_perror(n, sizeof(size_t));
+  memcpy(next, t->offs, n * sizeof(size_t));
+  for (u = 0; u < n; u++){
+    p_start = a->vt_wts[u]->elts;
+    p_end = p_start + a->vt_wts[u]->num_elts * a->pair_size;
+    for (p = p_start; p != p_end; p += a->pair_size){
+      v = *(const size_t *)p;
+      t->vts[next[v]] = u;
+      next[v]++;
+    }
+  }
+  free(next);
+  next = NULL;
+}
+
+/**
+   Frees the arrays of a transpose.
+*/
+static void transpose_free(transpose_t *t){
+  free(t->offs);
+  free(t->vts);
+  free(t->inv_degs);
+  t->offs = NULL;
+  t->vts = NULL;
+  t->inv_degs = NULL;
+}
+
+/**
+   Splits the vertices into ranges of consecutive vertices, where the ith
+   range starts at the first vertex v with offs[v] + v >= i * (E + V) /
+   num_threads, i.e. the sum of the number of incoming edges plus one per
+   vertex is approximately equal across ranges. A range may be empty.
+*/
+static void split_ranges(pr_arg_t *pas,
+			 const transpose_t *t,
+			 size_t num_threads){
+  size_t i, v = 0;
+  size_t total = t->num_es + t->num_vts;
+  pas[0].start = 0;
+  for (i = 1; i < num_threads; i++){
+    while (v < t->num_vts &&
+	   (double)(t->offs[v] + v) < (double)total * i / num_threads){
+      v++;
+    }
+    pas[i].start = v;
+    pas[i - 1].end = v;
+  }
+  pas[num_threads - 1].end = t->num_vts;
+}
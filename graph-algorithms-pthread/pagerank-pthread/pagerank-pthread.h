@@ -0,0 +1,101 @@
+/**
+   pagerank-pthread.h
+
+   Declarations of accessible functions for computing PageRank and
+   personalized PageRank of the vertices of graphs with vertices indexed
+   from 0, by parallel pull-based power iteration.
+
+   The rank of a vertex v in an iteration is
+
+     x'(v) = (1 - d) t(v) + d (sum over edges (u, v) of x(u) / deg(u)
+                               + sum over u with deg(u) = 0 of x(u) t(v)),
+
+   where d is the damping factor, deg(u) is the outdegree of u, and t is
+   the teleport distribution, i.e. 1 / V for each vertex in PageRank, and
+   1 for a seed vertex and 0 for other vertices in personalized PageRank.
+   The mass of the vertices without outgoing edges is distributed
+   according to t, and the ranks sum to 1.
+
+   The incoming edges of each vertex are read from a transpose of the
+   adjacency list, so that each thread writes only the ranks of its own
+   range of vertices and no atomic operations are needed. The ranges are
+   split by the number of incoming edges and vertices, so that the threads
+   do equal work on graphs with skewed degrees. In the batched
+   personalized mode, the ranks of all seeds are updated in one scan of the
+   edges per iteration.
+
+   The iteration ends when the L1 norm of the difference between two
+   consecutive rank vectors is less than tol for each seed, or after
+   max_iters iterations.
+
+   Multiple edges are counted in the outdegrees and in the sums. The
+   weights, if any, are not used.
+
+   If a pointer to a pagerank_stats_t block is passed, the algorithm
+   counts its operations and measures the wall-clock time of its phases,
+   including the throughput of the iterations in edges per second.
+*/
+
+#ifndef PAGERANK_PTHREAD_H
+#define PAGERANK_PTHREAD_H
+
+#include <stddef.h>
+#include "graph.h"
+
+typedef struct{
+  size_t num_iters; /* # iterations */
+  size_t num_edges; /* # scanned incoming edges across iterations */
+  double diff; /* max L1 norm of the difference in the last iteration */
+  double build_secs; /* wall-clock time of building the transpose */
+  double iter_secs; /* wall-clock time of the iterations */
+  double free_secs; /* wall-clock time of freeing */
+  double edges_per_sec; /* num_edges / iter_secs */
+} pagerank_stats_t;
+
+/**
+   Computes and copies to an array pointed to by ranks the PageRank of
+   each vertex, and returns the number of iterations.
+   a           : pointer to an adjacency list with at least one vertex
+   ranks       : pointer to a preallocated array with the count equal to
+                 the number of vertices in the adjacency list
+   damp        : damping factor in [0.0, 1.0), e.g. 0.85
+   tol         : >= 0.0 tolerance of the L1 norm of the difference between
+                 two consecutive rank vectors
+   max_iters   : > 0 maximum number of iterations
+   num_threads : > 0 number of threads
+   stats       : - NULL pointer, if operations are not counted
+                 - a pointer to a block of size sizeof(pagerank_stats_t),
+                 where the counts and phase times of the run are copied
+*/
+size_t pagerank_pthread(const adj_lst_t *a,
+			double *ranks,
+			double damp,
+			double tol,
+			size_t max_iters,
+			size_t num_threads,
+			pagerank_stats_t *stats);
+
+/**
+   Computes and copies to an array pointed to by ranks the personalized
+   PageRank of each vertex for each of num_seeds seeds in a batch, and
+   returns the number of iterations. The iteration ends when each of the
+   rank vectors converged.
+   a           : pointer to an adjacency list with at least one vertex
+   seeds       : pointer to an array of num_seeds seed vertices
+   num_seeds   : > 0 number of seeds
+   ranks       : pointer to a preallocated array with the count equal to
+                 the number of vertices times num_seeds; the rank of a
+                 vertex v for the jth seed is ranks[v * num_seeds + j]
+   The other parameters are as in pagerank_pthread.
+*/
+size_t ppr_pthread(const adj_lst_t *a,
+		   const size_t *seeds,
+		   size_t num_seeds,
+		   double *ranks,
+		   double damp,
+		   double tol,
+		   size_t max_iters,
+		   size_t num_threads,
+		   pagerank_stats_t *stats);
+
+#endif
@@ -0,0 +1,420 @@
+/**
+   triangle-pthread-test.c
+
+   Tests of counting and listing triangles with parallel intersections of
+   sorted adjacency sets.
+
+   The following command line arguments can be used to customize tests:
+   triangle-pthread-test
+     [0, # bits in size_t / 2] : a
+     [0, # bits in size_t / 2] : b s.t. 2^a <= V <= 2^b for complete graph
+                                 and brute-force tests
+     [0, # bits in size_t / 2] : c s.t. V = 2^c for the performance test
+     [1, # threads] : n for 1 <= # threads <= n
+     [0, 1] : on/off for complete graph test
+     [0, 1] : on/off for brute-force test on random graphs
+     [0, 1] : on/off for performance test on a random graph
+
+   usage examples:
+   ./triangle-pthread-test
+   ./triangle-pthread-test 5 9
+   ./triangle-pthread-test 5 9 14 4
+   ./triangle-pthread-test 5 9 15 8 0 0 1
+
+   triangle-pthread-test can be run with any subset of command line
+   arguments in the above-defined order. If the (i + 1)th argument is
+   specified then the ith argument must be specified for i >= 0. Default
+   values are used for the unspecified arguments according to the
+   C_ARGS_DEF array.
+
+   Each test is run at each level of utilities-cpu that is available.
+
+   The implementation of tests does not use stdint.h and is portable under
+   C89/C90 with the requirement that pthreads API is available.
+*/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include "triangle-pthread.h"
+#include "graph.h"
+#include "stack.h"
+#include "utilities-cpu.h"
+#include "utilities-mem.h"
+
+/**
+   Generate random numbers in a portable way for test purposes only; rand()
+   in the Linux C Library uses the same generator as random(), which may not
+   be the case on older rand() implementations, and on current
+   implementations on different systems.
+*/
+#ifdef TEST_SEED
+#define RGENS_SEED() do{srand(TEST_SEED);}while (0)
+#else
+#define RGENS_SEED() do{srand(time(NULL));}while (0)
+#endif
+#define RANDOM() (rand()) /* [0, RAND_MAX] */
+#define DRAND() ((double)rand() / RAND_MAX) /* [0.0, 1.0] */
+
+#define TOLU(i) ((unsigned long int)(i)) /* printing size_t under C89/C90 */
+
+/* input handling */
+const char *C_USAGE =
+  "triangle-pthread-test \n"
+  "[0, # bits in size_t / 2] : a \n"
+  "[0, # bits in size_t / 2] : b s.t. 2^a <= V <= 2^b for complete graph \n"
+  "                            and brute-force tests \n"
+  "[0, # bits in size_t / 2] : c s.t. V = 2^c for the performance test \n"
+  "[1, # threads] : n for 1 <= # threads <= n \n"
+  "[0, 1] : on/off for complete graph test \n"
+  "[0, 1] : on/off for brute-force test on random graphs \n"
+  "[0, 1] : on/off for performance test on a random graph \n";
+const int C_ARGC_MAX = 8;
+const size_t C_ARGS_DEF[7] = {3, 8, 13, 4, 1, 1, 1};
+const size_t C_FULL_BIT = CHAR_BIT * sizeof(size_t);
+
+/* tests */
+const double C_PROB_ONE = 1.0;
+const double C_PROB_ZERO = 0.0;
+const double C_PROBS[3] = {0.05, 0.2, 0.6};
+const size_t C_PROBS_COUNT = 3;
+const double C_PERF_CORE_PROB = 0.25; /* within the core */
+const double C_PERF_PROB = 0.002; /* core to periphery; / 8 in periphery */
+
+typedef struct{
+  double p;
+} bern_arg_t;
+
+typedef struct{
+  size_t num_vts;
+  size_t num_threads;
+  const unsigned char *adj; /* adjacency matrix */
+  size_t *counts; /* per-thread counts of visited triangles */
+  int *res; /* per-thread results */
+} visit_arg_t;
+
+int bern(void *arg);
+void undir_graph_init(adj_lst_t *a, graph_t *g, size_t n);
+unsigned char *adj_mat(const adj_lst_t *a);
+size_t brute_force(const adj_lst_t *a,
+		   const unsigned char *adj,
+		   size_t *vt_counts);
+void visit(size_t u, size_t v, size_t w, size_t thread_ix, void *arg);
+int cmp_runs(const adj_lst_t *a,
+	     const unsigned char *adj,
+	     size_t num_tris,
+	     const size_t *vt_counts,
+	     size_t num_threads);
+void print_test_result(int res);
+
+int bern(void *arg){
+  bern_arg_t *b = arg;
+  if (b->p >= C_PROB_ONE) return 1;
+  if (b->p <= C_PROB_ZERO) return 0;
+  if (b->p > DRAND()) return 1;
+  return 0;
+}
+
+/**
+   Initializes an undirected unweighted graph with n vertices and no
+   edges, and builds its adjacency list.
+*/
+void undir_graph_init(adj_lst_t *a, graph_t *g, size_t n){
+  graph_base_init(g, n, 0);
+  adj_lst_init(a, g);
+  adj_lst_undir_build(a, g);
+}
+
+/**
+   Returns a pointer to the adjacency matrix of a graph.
+*/
+unsigned char *adj_mat(const adj_lst_t *a){
+  const char *p = NULL, *p_start = NULL, *p_end = NULL;
+  size_t u, n = a->num_vts;
+  unsigned char *adj = NULL;
+  adj = calloc_perror(n * n + 1, 1);
+  for (u = 0; u < n; u++){
+    p_start = a->vt_wts[u]->elts;
+    p_end = p_start + a->vt_wts[u]->num_elts * a->pair_size;
+    for (p = p_start; p != p_end; p += a->pair_size){
+      adj[u * n + *(const size_t *)p] = 1;
+    }
+  }
+  return adj;
+}
+
+/**
+   Counts the triangles of a graph and the per-vertex counts by testing
+   all triples of vertices.
+*/
+size_t brute_force(const adj_lst_t *a,
+		   const unsigned char *adj,
+		   size_t *vt_counts){
+  size_t u, v, w, n = a->num_vts;
+  size_t num_tris = 0;
+  memset(vt_counts, 0, n * sizeof(size_t));
+  for (u = 0; u < n; u++){
+    for (v = u + 1; v < n; v++){
+      if (!adj[u * n + v]) continue;
+      for (w = v + 1; w < n; w++){
+	if (adj[u * n + w] && adj[v * n + w]){
+	  num_tris++;
+	  vt_counts[u]++;
+	  vt_counts[v]++;
+	  vt_counts[w]++;
+	}
+      }
+    }
+  }
+  return num_tris;
+}
+
+/**
+   Counts a visited triangle in the slot of the calling thread and tests
+   that the vertices form a triangle.
+*/
+void visit(size_t u, size_t v, size_t w, size_t thread_ix, void *arg){
+  visit_arg_t *va = arg;
+  size_t n = va->num_vts;
+  if (thread_ix >= va->num_threads){
+    va->res[0] = 0;
+    return;
+  }
+  va->counts[thread_ix]++;
+  va->res[thread_ix] *= (va->adj[u * n + v] &&
+			 va->adj[u * n + w] &&
+			 va->adj[v * n + w] &&
+			 u != v && u != w && v != w);
+}
+
+/**
+   Runs counting with and without per-vertex counts, and listing, with
+   1 to num_threads threads at each available level, and compares the
+   results with the expected count and per-vertex counts.
+*/
+int cmp_runs(const adj_lst_t *a,
+	     const unsigned char *adj,
+	     size_t num_tris,
+	     const size_t *vt_counts,
+	     size_t num_threads){
+  int res = 1;
+  int level;
+  size_t i, j, sum;
+  size_t *counts = NULL;
+  visit_arg_t va;
+  counts = malloc_perror(a->num_vts + 1, sizeof(size_t));
+  va.num_vts = a->num_vts;
+  va.adj = adj;
+  va.counts = malloc_perror(num_threads, sizeof(size_t));
+  va.res = malloc_perror(num_threads, sizeof(int));
+  for (level = 0; level < CPU_LEVEL_COUNT; level++){
+    if (cpu_force((cpu_level_t)level) == NULL) continue;
+    for (i = 1; i <= num_threads; i++){
+      res *= (triangle_pthread(a, NULL, i, NULL) == num_tris);
+      res *= (triangle_pthread(a, counts, i, NULL) == num_tris);
+      res *= (memcmp(counts, vt_counts, a->num_vts * sizeof(size_t)) == 0);
+      va.num_threads = i;
+      for (j = 0; j < i; j++){
+	va.counts[j] = 0;
+	va.res[j] = 1;
+      }
+      res *= (triangle_list_pthread(a, i, visit, &va, NULL) == num_tris);
+      for (sum = 0, j = 0; j < i; j++){
+	sum += va.counts[j];
+	res *= va.res[j];
+      }
+      res *= (sum == num_tris);
+    }
+  }
+  cpu_force(cpu_detect());
+  free(counts);
+  free(va.counts);
+  free(va.res);
+  counts = NULL;
+  va.counts = NULL;
+  va.res = NULL;
+  return res;
+}
+
+/**
+   Tests counting and listing on complete graphs, where the number of
+   triangles is n(n - 1)(n - 2)/6 and each vertex is in (n - 1)(n - 2)/2
+   triangles.
+*/
+void run_complete_graph_test(size_t log_start,
+			     size_t log_end,
+			     size_t num_threads){
+  int res = 1;
+  size_t i, l, n;
+  size_t *vt_counts = NULL;
+  unsigned char *adj = NULL;
+  bern_arg_t b;
+  graph_t g;
+  adj_lst_t a;
+  b.p = C_PROB_ONE;
+  printf("Run triangle_pthread and triangle_list_pthread test on "
+	 "complete graphs\n");
+  for (l = log_start; l <= log_end; l++){
+    n = (size_t)1 << l;
+    adj_lst_rand_undir(&a, n, bern, &b);
+    adj = adj_mat(&a);
+    vt_counts = malloc_perror(n, sizeof(size_t));
+    for (i = 0; i < n; i++){
+      vt_counts[i] = (n - 1) * (n - 2) / 2;
+    }
+    res *= cmp_runs(&a, adj, n * (n - 1) * (n - 2) / 6, vt_counts,
+		    num_threads);
+    adj_lst_free(&a);
+    free(adj);
+    free(vt_counts);
+    adj = NULL;
+    vt_counts = NULL;
+  }
+  undir_graph_init(&a, &g, 1);
+  res *= (triangle_pthread(&a, NULL, num_threads, NULL) == 0);
+  adj_lst_free(&a);
+  graph_free(&g);
+  printf("\t2^%lu <= V <= 2^%lu, 1 to %lu threads --> ",
+	 TOLU(log_start), TOLU(log_end), TOLU(num_threads));
+  print_test_result(res);
+}
+
+/**
+   Tests counting and listing on random graphs against a brute-force
+   count.
+*/
+void run_brute_force_test(size_t log_start,
+			  size_t log_end,
+			  size_t num_threads){
+  int res = 1;
+  size_t i, l, n, num_tris;
+  size_t *vt_counts = NULL;
+  unsigned char *adj = NULL;
+  bern_arg_t b;
+  adj_lst_t a;
+  printf("Run triangle_pthread and triangle_list_pthread test on random "
+	 "graphs against a brute-force count\n");
+  for (l = log_start; l <= log_end; l++){
+    n = (size_t)1 << l;
+    vt_counts = malloc_perror(n, sizeof(size_t));
+    for (i = 0; i < C_PROBS_COUNT; i++){
+      b.p = C_PROBS[i];
+      adj_lst_rand_undir(&a, n, bern, &b);
+      adj = adj_mat(&a);
+      num_tris = brute_force(&a, adj, vt_counts);
+      res *= cmp_runs(&a, adj, num_tris, vt_counts, num_threads);
+      adj_lst_free(&a);
+      free(adj);
+      adj = NULL;
+    }
+    free(vt_counts);
+    vt_counts = NULL;
+  }
+  printf("\t2^%lu <= V <= 2^%lu, 1 to %lu threads --> ",
+	 TOLU(log_start), TOLU(log_end), TOLU(num_threads));
+  print_test_result(res);
+}
+
+/**
+   Counts the triangles of a random graph with a dense core of V/8
+   vertices and a sparse periphery, which results in skewed degrees, at
+   each available level with 1 to num_threads threads, and prints the
+   counts and times.
+*/
+void run_perf_test(size_t log_n, size_t num_threads){
+  int res = 1;
+  int level;
+  size_t i, u, v, n, num_tris = 0, num_core;
+  bern_arg_t b;
+  graph_t g;
+  adj_lst_t a;
+  triangle_stats_t st;
+  n = (size_t)1 << log_n;
+  num_core = n / 8;
+  undir_graph_init(&a, &g, n);
+  for (u = 0; u < n; u++){
+    for (v = u + 1; v < n; v++){
+      if (v < num_core){
+	b.p = C_PERF_CORE_PROB;
+      }else if (u < num_core){
+	b.p = C_PERF_PROB;
+      }else{
+	b.p = C_PERF_PROB / 8;
+      }
+      adj_lst_add_undir_edge(&a, u, v, NULL, bern, &b);
+    }
+  }
+  printf("Run triangle_pthread performance test on a random graph with "
+	 "a dense core\n");
+  printf("\tvertices: %lu, edges: %lu\n",
+	 TOLU(a.num_vts), TOLU(a.num_es / 2));
+  for (level = 0; level < CPU_LEVEL_COUNT; level++){
+    if (cpu_force((cpu_level_t)level) == NULL) continue;
+    printf("\t%s\n", cpu_level_name((cpu_level_t)level));
+    for (i = 1; i <= num_threads; i *= 2){
+      if (level == 0 && i == 1){
+	num_tris = triangle_pthread(&a, NULL, i, &st);
+      }else{
+	res *= (triangle_pthread(&a, NULL, i, &st) == num_tris);
+      }
+      printf("\t\tthreads: %lu, triangles: %lu, max oriented set: %lu, "
+	     "gallops: %lu/%lu\n"
+	     "\t\t\torient: %.4f, count: %.4f, free: %.4f seconds\n",
+	     TOLU(i), TOLU(num_tris), TOLU(st.max_out),
+	     TOLU(st.num_gallops), TOLU(st.num_isects),
+	     st.orient_secs, st.count_secs, st.free_secs);
+    }
+  }
+  cpu_force(cpu_detect());
+  adj_lst_free(&a);
+  graph_free(&g);
+  printf("\tequal counts --> ");
+  print_test_result(res);
+}
+
+/**
+   Prints a test result.
+*/
+void print_test_result(int res){
+  if (res){
+    printf("SUCCESS\n");
+  }else{
+    printf("FAILURE\n");
+  }
+}
+
+int main(int argc, char *argv[]){
+  int i;
+  size_t *args = NULL;
+  RGENS_SEED();
+  if (argc > C_ARGC_MAX){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  args = malloc_perror(C_ARGC_MAX - 1, sizeof(size_t));
+  memcpy(args, C_ARGS_DEF, (C_ARGC_MAX - 1) * sizeof(size_t));
+  for (i = 1; i < argc; i++){
+    args[i - 1] = atoi(argv[i]);
+  }
+  if (args[0] > C_FULL_BIT / 2 ||
+      args[1] > C_FULL_BIT / 2 ||
+      args[2] > C_FULL_BIT / 2 ||
+      args[0] > args[1] ||
+      args[3] < 1 ||
+      args[4] > 1 ||
+      args[5] > 1 ||
+      args[6] > 1){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  if (args[4]) run_complete_graph_test(args[0], args[1], args[3]);
+  if (args[5]) run_brute_force_test(args[0], args[1], args[3]);
+  if (args[6]) run_perf_test(args[2], args[3]);
+  free(args);
+  args = NULL;
+  return 0;
+}
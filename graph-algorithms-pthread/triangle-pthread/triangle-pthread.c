@@ -0,0 +1,398 @@
+/**
+   triangle-pthread.c
+
+   Functions for counting and listing the triangles of undirected graphs
+   with vertices indexed from 0, with parallel intersections of sorted
+   adjacency sets.
+
+   Each edge is oriented from the vertex of lower degree to the vertex of
+   higher degree, with ties broken by the lower index. The oriented
+   adjacency sets are built in two passes over the adjacency list without
+   comparison sorting: the first pass counts the oriented edges of each
+   vertex, and the second pass appends each vertex v to the sets of its
+   oriented in-neighbors in the ascending order of v. The sets are in a
+   single array with offsets.
+
+   A thread takes a chunk of C_CHUNK_COUNT consecutive vertices at a time
+   from a shared counter, and for each vertex u and each vertex v in the
+   oriented set of u, intersects the oriented sets of u and v. If one set
+   is at least C_GALLOP_RATIO times larger than the other set, the
+   intersection is computed by galloping search, i.e. by exponential and
+   binary search of each vertex of the smaller set in the remaining part
+   of the larger set. Otherwise, the block intersection kernel of
+   utilities-cpu is used. If per-vertex counts are computed, each thread
+   adds to its own array of per-vertex counts and the arrays are summed
+   after the threads are joined.
+
+   The implementation does not use stdint.h and is portable under C89/C90
+   with the requirement that pthreads API is available.
+*/
+
+#define _POSIX_C_SOURCE 200112L
+
+#define UTILITIES_MEM_TAG MEM_TAG_GRAPH
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "triangle-pthread.h"
+#include "graph.h"
+#include "stack.h"
+#include "utilities-cpu.h"
+#include "utilities-mem.h"
+#include "utilities-pthread.h"
+#include "utilities-time.h"
+
+static const size_t C_CHUNK_COUNT = 32;
+static const size_t C_GALLOP_RATIO = 32;
+
+typedef struct{
+  size_t num_vts;
+  size_t *offs; /* num_vts + 1 offsets of the oriented sets in vts */
+  size_t *vts; /* oriented sets in ascending order */
+} orient_t;
+
+typedef struct{
+  size_t next; /* first vertex of the next chunk */
+  pthread_mutex_t mutex;
+} sched_t;
+
+typedef struct{
+  size_t thread_ix;
+  size_t num_tris;
+  size_t num_isects;
+  size_t num_gallops;
+  size_t *buf; /* intersection buffer, NULL if triangles are only counted */
+  size_t *vt_counts; /* per-vertex counts, NULL if not computed */
+  const orient_t *o;
+  const cpu_kernels_t *k;
+  sched_t *s;
+  void (*visit)(size_t, size_t, size_t, size_t, void *);
+  void *arg;
+} tri_arg_t;
+
+static size_t run(const adj_lst_t *a,
+		  size_t *vt_counts,
+		  size_t num_threads,
+		  void (*visit)(size_t, size_t, size_t, size_t, void *),
+		  void *arg,
+		  triangle_stats_t *stats);
+static void *tri_thread(void *arg);
+static size_t isect(tri_arg_t *ta,
+		    const size_t *a,
+		    size_t a_count,
+		    const size_t *b,
+		    size_t b_count);
+static size_t isect_gallop(size_t *out,
+			   const size_t *a,
+			   size_t a_count,
+			   const size_t *b,
+			   size_t b_count);
+static size_t orient_init(orient_t *o, const adj_lst_t *a);
+static void orient_free(orient_t *o);
+static int is_out(const adj_lst_t *a, size_t u, size_t v);
+
+/**
+   Counts the triangles of an undirected graph and returns the count.
+   a           : pointer to an adjacency list of an undirected graph
+   vt_counts   : - NULL pointer, if per-vertex counts are not computed
+                 - pointer to a preallocated array with the count equal to
+                 the number of vertices in the adjacency list, where the
+                 number of triangles that contain each vertex is copied;
+                 the sum of the per-vertex counts is three times the
+                 returned count
+   num_threads : > 0 number of threads
+   stats       : - NULL pointer, if operations are not counted
+                 - a pointer to a block of size sizeof(triangle_stats_t),
+                 where the counts and phase times of the run are copied
+*/
+size_t triangle_pthread(const adj_lst_t *a,
+			size_t *vt_counts,
+			size_t num_threads,
+			triangle_stats_t *stats){
+  return run(a, vt_counts, num_threads, NULL, NULL, stats);
+}
+
+/**
+   Lists the triangles of an undirected graph by calling visit once for
+   each triangle, and returns the count of triangles. visit is called
+   concurrently by num_threads threads, each with its thread index in
+   [0, num_threads) and the arg parameter, and the order of calls is
+   unspecified. The vertices u, v, and w of a triangle are passed in the
+   order of the orientation.
+   a           : pointer to an adjacency list of an undirected graph
+   num_threads : > 0 number of threads
+   visit       : function called with the vertices of a triangle, the
+                 index of the calling thread, and arg
+   arg         : argument of visit
+   stats       : - NULL pointer, if operations are not counted
+                 - a pointer to a block of size sizeof(triangle_stats_t),
+                 where the counts and phase times of the run are copied
+*/
+size_t triangle_list_pthread(const adj_lst_t *a,
+			     size_t num_threads,
+			     void (*visit)(size_t u,
+					   size_t v,
+					   size_t w,
+					   size_t thread_ix,
+					   void *arg),
+			     void *arg,
+			     triangle_stats_t *stats){
+  return run(a, NULL, num_threads, visit, arg, stats);
+}
+
+/**
+   Orients the graph, runs the threads with the first thread entry on the
+   thread stack of the caller, and sums the counts of the threads.
+*/
+static size_t run(const adj_lst_t *a,
+		  size_t *vt_counts,
+		  size_t num_threads,
+		  void (*visit)(size_t, size_t, size_t, size_t, void *),
+		  void *arg,
+		  triangle_stats_t *stats){
+  size_t i, u, max_out;
+  size_t num_tris = 0;
+  size_t vt_size = sizeof(size_t);
+  double t = 0.0;
+  orient_t o;
+  sched_t s;
+  tri_arg_t *tas = NULL;
+  pthread_t *ids = NULL;
+  const cpu_kernels_t *k = cpu_init();
+  if (stats != NULL){
+    memset(stats, 0, sizeof(triangle_stats_t));
+    t = time_wall();
+  }
+  max_out = orient_init(&o, a);
+  if (stats != NULL){
+    stats->max_out = max_out;
+    stats->orient_secs = time_wall() - t;
+    t = time_wall();
+  }
+  s.next = 0;
+  mutex_init_perror(&s.mutex);
+  tas = malloc_perror(num_threads, sizeof(tri_arg_t));
+  ids = malloc_perror(num_threads, sizeof(pthread_t));
+  for (i = 0; i < num_threads; i++){
+    tas[i].thread_ix = i;
+    tas[i].num_tris = 0;
+    tas[i].num_isects = 0;
+    tas[i].num_gallops = 0;
+    tas[i].buf = NULL;
+    tas[i].vt_counts = NULL;
+    if (vt_counts != NULL || visit != NULL){
+      tas[i].buf = malloc_perror(max_out + 1, vt_size);
+    }
+    if (vt_counts != NULL && i == 0){
+      memset(vt_counts, 0, a->num_vts * vt_size);
+      tas[i].vt_counts = vt_counts;
+    }else if (vt_counts != NULL){
+      tas[i].vt_counts = calloc_perror(a->num_vts + 1, vt_size);
+    }
+    tas[i].o = &o;
+    tas[i].k = k;
+    tas[i].s = &s;
+    tas[i].visit = visit;
+    tas[i].arg = arg;
+  }
+  for (i = 1; i < num_threads; i++){
+    thread_create_perror(&ids[i], tri_thread, &tas[i]);
+  }
+  tri_thread(&tas[0]);
+  for (i = 1; i < num_threads; i++){
+    thread_join_perror(ids[i], NULL);
+  }
+  if (stats != NULL){
+    stats->count_secs = time_wall() - t;
+    t = time_wall();
+  }
+  for (i = 0; i < num_threads; i++){
+    num_tris += tas[i].num_tris;
+    if (stats != NULL){
+      stats->num_isects += tas[i].num_isects;
+      stats->num_gallops += tas[i].num_gallops;
+    }
+    if (vt_counts != NULL && i > 0){
+      for (u = 0; u < a->num_vts; u++){
+	vt_counts[u] += tas[i].vt_counts[u];
+      }
+      free(tas[i].vt_counts);
+    }
+    free(tas[i].buf);
+  }
+  pthread_mutex_destroy(&s.mutex);
+  orient_free(&o);
+  free(tas);
+  free(ids);
+  tas = NULL;
+  ids = NULL;
+  if (stats != NULL) stats->free_secs = time_wall() - t;
+  return num_tris;
+}
+
+/**
+   Processes chunks of vertices until all vertices are taken.
+*/
+static void *tri_thread(void *arg){
+  size_t i, j, c;
+  size_t u, u_end, v, w;
+  size_t u_count, v_count;
+  const size_t *u_vts = NULL, *v_vts = NULL;
+  tri_arg_t *ta = arg;
+  const orient_t *o = ta->o;
+  while (1){
+    mutex_lock_perror(&ta->s->mutex);
+    u = ta->s->next;
+    u_end = (o->num_vts - u < C_CHUNK_COUNT) ? o->num_vts : u + C_CHUNK_COUNT;
+    ta->s->next = u_end;
+    mutex_unlock_perror(&ta->s->mutex);
+    if (u == u_end) break;
+    for (; u < u_end; u++){
+      u_vts = o->vts + o->offs[u];
+      u_count = o->offs[u + 1] - o->offs[u];
+      ta->num_isects += u_count;
+      for (i = 0; i < u_count; i++){
+	v = u_vts[i];
+	v_vts = o->vts + o->offs[v];
+	v_count = o->offs[v + 1] - o->offs[v];
+	c = isect(ta, u_vts, u_count, v_vts, v_count);
+	ta->num_tris += c;
+	if (ta->buf == NULL) continue;
+	if (ta->vt_counts != NULL){
+	  ta->vt_counts[u] += c;
+	  ta->vt_counts[v] += c;
+	}
+	for (j = 0; j < c; j++){
+	  w = ta->buf[j];
+	  if (ta->vt_counts != NULL) ta->vt_counts[w]++;
+	  if (ta->visit != NULL) ta->visit(u, v, w, ta->thread_ix, ta->arg);
+	}
+      }
+    }
+  }
+  return NULL;
+}
+
+/**
+   Computes the intersection of two oriented sets by galloping search or
+   the block intersection kernel, and copies it to the buffer of a thread
+   if the buffer is not NULL.
+*/
+static size_t isect(tri_arg_t *ta,
+		    const size_t *a,
+		    size_t a_count,
+		    const size_t *b,
+		    size_t b_count){
+  const size_t *p = NULL;
+  size_t count;
+  if (a_count > b_count){
+    p = a;
+    a = b;
+    b = p;
+    count = a_count;
+    a_count = b_count;
+    b_count = count;
+  }
+  if (a_count == 0) return 0;
+  if (a_count * C_GALLOP_RATIO <= b_count){
+    ta->num_gallops++;
+    return isect_gallop(ta->buf, a, a_count, b, b_count);
+  }
+  return ta->k->isect(ta->buf, a, a_count, b, b_count);
+}
+
+/**
+   Computes the intersection of a smaller set and a larger set by finding
+   each element of the smaller set in the larger set with exponential
+   search from the last position, followed by binary search.
+*/
+static size_t isect_gallop(size_t *out,
+			   const size_t *a,
+			   size_t a_count,
+			   const size_t *b,
+			   size_t b_count){
+  size_t i, lo, hi, mid, step;
+  size_t j = 0, c = 0;
+  for (i = 0; i < a_count && j < b_count; i++){
+    /* b[lo - 1] < a[i] and b[hi] >= a[i] if hi < b_count */
+    lo = j;
+    hi = j;
+    step = 1;
+    while (hi < b_count && b[hi] < a[i]){
+      lo = hi + 1;
+      hi = (b_count - hi > step) ? hi + step : b_count;
+      step <<= 1;
+    }
+    while (lo < hi){
+      mid = lo + (hi - lo) / 2;
+      if (b[mid] < a[i]){
+	lo = mid + 1;
+      }else{
+	hi = mid;
+      }
+    }
+    j = lo;
+    if (j < b_count && b[j] == a[i]){
+      if (out != NULL) out[c] = a[i];
+      c++;
+      j++;
+    }
+  }
+  return c;
+}
+
+/**
+   Builds the oriented sets of a graph and returns the maximum count of
+   an oriented set.
+*/
+static size_t orient_init(orient_t *o, const adj_lst_t *a){
+  const char *p = NULL, *p_start = NULL, *p_end = NULL;
+  size_t u, v, max_out = 0;
+  size_t n = a->num_vts;
+  size_t *next = NULL;
+  o->num_vts = n;
+  o->offs = calloc_perror(n + 1, sizeof(size_t));
+  for (u = 0; u < n; u++){
+    p_start = a->vt_wts[u]->elts;
+    p_end = p_start + a->vt_wts[u]->num_elts * a->pair_size;
+    for (p = p_start; p != p_end; p += a->pair_size){
+      if (is_out(a, u, *(const size_t *)p)) o->offs[u + 1]++;
+    }
+    if (o->offs[u + 1] > max_out) max_out = o->offs[u + 1];
+  }
+  for (u = 0; u < n; u++){
+    o->offs[u + 1] += o->offs[u];
+  }
+  o->vts = malloc_perror(o->offs[n] + 1, sizeof(size_t));
+  next = malloc_perror(n + 1, sizeof(size_t));
+  memcpy(next, o->offs, n * sizeof(size_t));
+  for (v = 0; v < n; v++){
+    p_start = a->vt_wts[v]->elts;
+    p_end = p_start + a->vt_wts[v]->num_elts * a->pair_size;
+    for (p = p_start; p != p_end; p += a->pair_size){
+      u = *(const size_t *)p;
+      if (is_out(a, u, v)) o->vts[next[u]++] = v;
+    }
+  }
+  free(next);
+  next = NULL;
+  return max_out;
+}
+
+static void orient_free(orient_t *o){
+  free(o->offs);
+  free(o->vts);
+  o->offs = NULL;
+  o->vts = NULL;
+}
+
+/**
+   Returns nonzero if an edge (u, v) is oriented from u to v.
+*/
+static int is_out(const adj_lst_t *a, size_t u, size_t v){
+  size_t u_deg = a->vt_wts[u]->num_elts;
+  size_t v_deg = a->vt_wts[v]->num_elts;
+  return u_deg < v_deg || (u_deg == v_deg && u < v);
+}
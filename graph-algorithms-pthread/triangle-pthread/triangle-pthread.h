@@ -0,0 +1,91 @@
+/**
+   triangle-pthread.h
+
+   Declarations of accessible functions for counting and listing the
+   triangles of undirected graphs with vertices indexed from 0, with
+   parallel intersections of sorted adjacency sets.
+
+   Each edge is oriented from the vertex of lower degree to the vertex of
+   higher degree, with ties broken by the lower index, and the oriented
+   adjacency sets are sorted by vertex. A triangle is then found exactly
+   once as a vertex w in the intersection of the oriented sets of u and v
+   for an oriented edge (u, v), and each oriented set has at most
+   sqrt(2m) vertices, where m is the number of edges. An intersection is
+   computed by galloping search if one set is larger than the other set by
+   a constant factor, and otherwise by the block intersection kernel of
+   utilities-cpu, i.e. by AVX2 or AVX-512 block comparisons if available
+   at runtime, or by a merge.
+
+   The vertices are distributed dynamically across threads in chunks of
+   consecutive vertices, so that the threads that process vertices with
+   large oriented sets do not delay the other threads.
+
+   The adjacency list is expected to represent an undirected graph without
+   loops and multiple edges, e.g. built with adj_lst_undir_build or
+   adj_lst_rand_undir. The weights, if any, are not used.
+
+   If a pointer to a triangle_stats_t block is passed, the algorithm counts
+   its operations and measures the wall-clock time of its phases.
+*/
+
+#ifndef TRIANGLE_PTHREAD_H
+#define TRIANGLE_PTHREAD_H
+
+#include <stddef.h>
+#include "graph.h"
+
+typedef struct{
+  size_t num_isects; /* # intersections, i.e. # oriented edges */
+  size_t num_gallops; /* # intersections by galloping search */
+  size_t max_out; /* max # vertices in an oriented set */
+  double orient_secs; /* wall-clock time of orienting and sorting */
+  double count_secs; /* wall-clock time of the parallel intersections */
+  double free_secs; /* wall-clock time of reducing and freeing */
+} triangle_stats_t;
+
+/**
+   Counts the triangles of an undirected graph and returns the count.
+   a           : pointer to an adjacency list of an undirected graph
+   vt_counts   : - NULL pointer, if per-vertex counts are not computed
+                 - pointer to a preallocated array with the count equal to
+                 the number of vertices in the adjacency list, where the
+                 number of triangles that contain each vertex is copied;
+                 the sum of the per-vertex counts is three times the
+                 returned count
+   num_threads : > 0 number of threads
+   stats       : - NULL pointer, if operations are not counted
+                 - a pointer to a block of size sizeof(triangle_stats_t),
+                 where the counts and phase times of the run are copied
+*/
+size_t triangle_pthread(const adj_lst_t *a,
+			size_t *vt_counts,
+			size_t num_threads,
+			triangle_stats_t *stats);
+
+/**
+   Lists the triangles of an undirected graph by calling visit once for
+   each triangle, and returns the count of triangles. visit is called
+   concurrently by num_threads threads, each with its thread index in
+   [0, num_threads) and the arg parameter, and the order of calls is
+   unspecified. The vertices u, v, and w of a triangle are passed in the
+   order of the orientation.
+   a           : pointer to an adjacency list of an undirected graph
+   num_threads : > 0 number of threads
+   visit       : function called with the vertices of a triangle, the
+                 index of the calling thread, and arg
+   arg         : argument of visit
+   stats       : - NULL pointer, if operations are not counted
+                 - a pointer to a block of size sizeof(triangle_stats_t),
+                 where the counts and phase times of the run are copied
+*/
+size_t triangle_list_pthread(const adj_lst_t *a,
+			     size_t num_threads,
+			     void (*visit)(size_t u,
+					   size_t v,
+					   size_t w,
+					   size_t thread_ix,
+					   void *arg),
+			     void *arg,
+			     triangle_stats_t *stats);
+
+#endif
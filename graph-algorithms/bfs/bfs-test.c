@@ -26,6 +26,11 @@
    argument must be specified for i >= 0. Default values are used for the
    unspecified arguments according to the C_ARGS_DEF array.
 
+   The runtimes of the random graph test are measured with utilities-bench
+   and can be written as csv or json records by setting BENCH_FORMAT and
+   BENCH_OUT, e.g.
+   BENCH_FORMAT=json BENCH_OUT=bfs.json ./bfs-test 10 14 10 14 10 14 0 0 0 1
+
    The implementation does not use stdint.h and is portable under C89/C90.
 */
 
@@ -37,6 +42,7 @@
 #include "bfs.h"
 #include "graph.h"
 #include "stack.h"
+#include "utilities-bench.h"
 #include "utilities-mem.h"
 
 /**
@@ -45,7 +51,11 @@
    be the case on older rand() implementations, and on current
    implementations on different systems.
 */
+#ifdef TEST_SEED
+#define RGENS_SEED() do{srand(TEST_SEED);}while (0)
+#else
 #define RGENS_SEED() do{srand(time(NULL));}while (0)
+#endif
 #define RANDOM() (rand()) /* [0, RAND_MAX] */
 #define DRAND() ((double)rand() / RAND_MAX) /* [0.0, 1.0] */
 
@@ -128,7 +138,9 @@ const size_t C_UNDIR_PREV_SECOND[5][5] =
    {1, 2, 3, 4, 4}};
 
 /* large graph tests */
+const char *C_SUITE = "bfs-test";
 const int C_ITER = 10;
+const size_t C_NUM_WARMUPS = 1;
 const int C_PROBS_COUNT = 5;
 const double C_PROBS[5] = {1.00, 0.75, 0.50, 0.25, 0.00};
 const double C_PROB_ONE = 1.0;
@@ -234,7 +246,7 @@ void small_graph_helper(const graph_t *g,
   dist = malloc_perror(a.num_vts, sizeof(size_t));
   prev = malloc_perror(a.num_vts, sizeof(size_t));
   for (i = 0; i < a.num_vts; i++){
-    bfs(&a, i, dist, prev);
+    bfs(&a, i, dist, prev, NULL);
     *res *= cmp_arr(dist, ret_dist[i], a.num_vts);
     *res *= cmp_arr(prev, ret_prev[i], a.num_vts);
   }
@@ -271,6 +283,7 @@ void run_max_edges_graph_test(int pow_start, int pow_end){
   size_t *dist = NULL, *prev = NULL;
   bern_arg_t b;
   adj_lst_t a;
+  bfs_stats_t st;
   dist = malloc_perror(pow_two(pow_end), sizeof(size_t));
   prev = malloc_perror(pow_two(pow_end), sizeof(size_t));
   b.p = C_PROB_ONE;
@@ -281,7 +294,8 @@ void run_max_edges_graph_test(int pow_start, int pow_end){
     n = pow_two(i); /* 0 < n */
     adj_lst_rand_dir(&a, n, bern, &b);
     start =  RANDOM() % n;
-    bfs(&a, start, dist, prev);
+    bfs(&a, start, dist, prev, &st);
+    res *= (st.num_pops == n && st.num_edges == n * (n - 1));
     for (j = 0; j < n; j++){
       if (j == start){
 	res *= (dist[j] == 0);
@@ -309,6 +323,7 @@ void run_no_edges_graph_test(int pow_start, int pow_end){
   size_t *dist = NULL, *prev = NULL;
   bern_arg_t b;
   adj_lst_t a;
+  bfs_stats_t st;
   dist = malloc_perror(pow_two(pow_end), sizeof(size_t));
   prev = malloc_perror(pow_two(pow_end), sizeof(size_t));
   b.p = C_PROB_ZERO;
@@ -319,7 +334,8 @@ void run_no_edges_graph_test(int pow_start, int pow_end){
     n = pow_two(i); /* 0 < n */
     adj_lst_rand_dir(&a, n, bern, &b);
     start =  RANDOM() % n;
-    bfs(&a, start, dist, prev);
+    bfs(&a, start, dist, prev, &st);
+    res *= (st.num_pops == 1 && st.num_edges == 0);
     for (j = 0; j < n; j++){
       if (j == start){
 	res *= (prev[j] == start);
@@ -340,14 +356,29 @@ void run_no_edges_graph_test(int pow_start, int pow_end){
 /**
    Runs a bfs test on random directed graphs.
 */
+
+typedef struct{
+  const adj_lst_t *a;
+  const size_t *start;
+  size_t *dist;
+  size_t *prev;
+} rep_arg_t;
+
+void bfs_rep(void *arg, size_t i){
+  rep_arg_t *ra = arg;
+  bfs(ra->a, ra->start[i % C_ITER], ra->dist, ra->prev, NULL);
+}
+
 void run_random_dir_graph_test(int pow_start, int pow_end){
   int i, j, k;
   size_t n;
   size_t *start = NULL;
   size_t *dist = NULL, *prev = NULL;
+  char params[64];
   bern_arg_t b;
   adj_lst_t a;
-  clock_t t;
+  rep_arg_t ra;
+  bench_t bench;
   start = malloc_perror(C_ITER, sizeof(size_t));
   dist = malloc_perror(pow_two(pow_end), sizeof(size_t));
   prev = malloc_perror(pow_two(pow_end), sizeof(size_t));
@@ -363,15 +394,18 @@ void run_random_dir_graph_test(int pow_start, int pow_end){
       for (k = 0; k < C_ITER; k++){
 	start[k] =  RANDOM() % n;
       }
-      t = clock();
-      for (k = 0; k < C_ITER; k++){
-	bfs(&a, start[k], dist, prev);
-      }
-      t = clock() - t;
-      printf("\t\tvertices: %lu, E[# of directed edges]: %.1f, "
-	     "average runtime: %.6f seconds\n",
-	     TOLU(n), b.p * n * (n - 1), (float)t / C_ITER / CLOCKS_PER_SEC);
-      fflush(stdout);
+      sprintf(params, "p=%.2f vts=%lu es=%lu",
+	      b.p, TOLU(a.num_vts), TOLU(a.num_es));
+      printf("\t\tvertices: %lu, E[# of directed edges]: %.1f\n",
+	     TOLU(n), b.p * n * (n - 1));
+      ra.a = &a;
+      ra.start = start;
+      ra.dist = dist;
+      ra.prev = prev;
+      bench_init(&bench, C_SUITE, "rand-dir bfs", C_NUM_WARMUPS, C_ITER);
+      bench_run(&bench, bfs_rep, &ra);
+      bench_report(&bench, "\t\t\tbfs runtime: ", params);
+      bench_free(&bench);
       adj_lst_free(&a);
     }
   }
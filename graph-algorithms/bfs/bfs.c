@@ -9,8 +9,13 @@
    prev[vts[i]] == NR, in order to decrease cache misses did not result
    in a speed up in tests even when the index computation was performed
    with a right bit shift on 64-bit words.
+
+   If a pointer to a bfs_stats_t block is passed, the algorithm counts its
+   operations and measures the wall-clock time of its phases.
 */
 
+#define UTILITIES_MEM_TAG MEM_TAG_GRAPH
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -19,6 +24,7 @@
 #include "queue.h"
 #include "stack.h"
 #include "utilities-mem.h"
+#include "utilities-time.h"
 
 static const size_t NR = (size_t)-1; /* not reached as index */
 static const size_t QUEUE_INIT_COUNT = 1;
@@ -35,22 +41,42 @@ static const size_t QUEUE_INIT_COUNT = 1;
                  number of vertices in the adjacency list
    prev        : pointer to a preallocated array with the count equal to the
                  number of vertices in the adjacency list
+   stats       : - NULL pointer, if operations are not counted
+                 - a pointer to a block of size sizeof(bfs_stats_t), where
+                 the counts and phase times of the run are copied
 */
-void bfs(const adj_lst_t *a, size_t start, size_t *dist, size_t *prev){
+void bfs(const adj_lst_t *a,
+	 size_t start,
+	 size_t *dist,
+	 size_t *prev,
+	 bfs_stats_t *stats){
   const char *p = NULL, *p_start = NULL, *p_end = NULL;
   size_t u, v;
   size_t vt_size = sizeof(size_t);
+  double t = 0.0;
   queue_t q;
+  if (stats != NULL){
+    memset(stats, 0, sizeof(bfs_stats_t));
+    t = time_wall();
+  }
   memset(dist, 0, a->num_vts * vt_size);
   memset(prev, 0xff, a->num_vts * vt_size); /* initialize to NR */
   queue_init(&q, QUEUE_INIT_COUNT, vt_size, NULL);
   prev[start] = start;
   queue_push(&q, &start);
+  if (stats != NULL){
+    stats->init_secs = time_wall() - t;
+    t = time_wall();
+  }
   while (q.num_elts > 0){
     queue_pop(&q, &u);
     p_start = a->vt_wts[u]->elts;
-    p_end = p_start + a->vt_wts[u]->num_elts * a->step_size;
-    for (p = p_start; p != p_end; p += a->step_size){
+    p_end = p_start + a->vt_wts[u]->num_elts * a->pair_size;
+    if (stats != NULL){
+      stats->num_pops++;
+      stats->num_edges += a->vt_wts[u]->num_elts;
+    }
+    for (p = p_start; p != p_end; p += a->pair_size){
       v = *(const size_t *)p;
       if (prev[v] == NR){
 	dist[v] = dist[u] + 1;
@@ -59,5 +85,10 @@ void bfs(const adj_lst_t *a, size_t start, size_t *dist, size_t *prev){
       }
     }
   }
+  if (stats != NULL){
+    stats->search_secs = time_wall() - t;
+    t = time_wall();
+  }
   queue_free(&q);
+  if (stats != NULL) stats->free_secs = time_wall() - t;
 }
@@ -3,6 +3,9 @@
 
    Declarations of accessible functions for running the BFS algorithm on
    graphs with vertices indexed from 0.
+
+   If a pointer to a bfs_stats_t block is passed, the algorithm counts its
+   operations and measures the wall-clock time of its phases.
 */
 
 #ifndef BFS_H  
@@ -11,6 +14,14 @@
 #include <stddef.h>
 #include "graph.h"
 
+typedef struct{
+  size_t num_pops; /* # queue pops, i.e. # reached vertices */
+  size_t num_edges; /* # scanned edges */
+  double init_secs; /* wall-clock time of initialization */
+  double search_secs; /* wall-clock time of the main loop */
+  double free_secs; /* wall-clock time of freeing the queue */
+} bfs_stats_t;
+
 /**
    Computes and copies to an array pointed to by dist the lowest # of edges
    from start to each reached vertex, and provides the previous vertex in the
@@ -23,7 +34,14 @@
                  number of vertices in the adjacency list
    prev        : pointer to a preallocated array with the count equal to the
                  number of vertices in the adjacency list
+   stats       : - NULL pointer, if operations are not counted
+                 - a pointer to a block of size sizeof(bfs_stats_t), where
+                 the counts and phase times of the run are copied
 */
-void bfs(const adj_lst_t *a, size_t start, size_t *dist, size_t *prev);
+void bfs(const adj_lst_t *a,
+	 size_t start,
+	 size_t *dist,
+	 size_t *prev,
+	 bfs_stats_t *stats);
 
 #endif
@@ -26,6 +26,11 @@
    argument must be specified for i >= 0. Default values are used for the
    unspecified arguments according to the C_ARGS_DEF array.
 
+   The runtimes of the random graph test are measured with utilities-bench
+   and can be written as csv or json records by setting BENCH_FORMAT and
+   BENCH_OUT, e.g.
+   BENCH_FORMAT=json BENCH_OUT=dfs.json ./dfs-test 10 14 10 14 10 14 0 0 0 1
+
    The implementation does not use stdint.h and is portable under C89/C90.
 */
 
@@ -37,6 +42,7 @@
 #include "dfs.h"
 #include "graph.h"
 #include "stack.h"
+#include "utilities-bench.h"
 #include "utilities-mem.h"
 
 /* input handling */
@@ -78,7 +84,9 @@ const size_t C_UNDIR_PRE_SECOND[6] = {0, 1, 2, 3, 4, 5};
 const size_t C_UNDIR_POST_SECOND[6] = {11, 10, 9, 8, 7, 6};
 
 /* random graph tests */
+const char *C_SUITE = "dfs-test";
 const int C_ITER = 10;
+const size_t C_NUM_WARMUPS = 1;
 const int C_PROBS_COUNT = 5;
 const double C_PROBS[5] = {1.00, 0.75, 0.50, 0.25, 0.00};
 const double C_PROB_ONE = 1.0;
@@ -90,7 +98,11 @@ const double C_PROB_ZERO = 0.0;
    be the case on older rand() implementations, and on current
    implementations on different systems.
 */
+#ifdef TEST_SEED
+#define RGENS_SEED() do{srand(TEST_SEED);}while (0)
+#else
 #define RGENS_SEED() do{srand(time(NULL));}while (0)
+#endif
 #define RANDOM() (rand()) /* [0, RAND_MAX] */
 #define DRAND() ((double)rand() / RAND_MAX) /* [0.0, 1.0] */
 
@@ -201,7 +213,7 @@ void small_graph_helper(const graph_t *g,
   pre = malloc_perror(a.num_vts, sizeof(size_t));
   post = malloc_perror(a.num_vts, sizeof(size_t));
   for (i = 0; i < a.num_vts; i++){
-    dfs(&a, start, pre, post);
+    dfs(&a, start, pre, post, NULL);
     *res *= cmp_arr(pre, ret_pre, a.num_vts);
     *res *= cmp_arr(post, ret_post, a.num_vts);
   }
@@ -239,6 +251,7 @@ void run_max_edges_graph_test(int pow_start, int pow_end){
   size_t *pre = NULL, *post = NULL;
   bern_arg_t b;
   adj_lst_t a;
+  dfs_stats_t st;
   pre = malloc_perror(pow_two(pow_end), sizeof(size_t));
   post = malloc_perror(pow_two(pow_end), sizeof(size_t));
   b.p = C_PROB_ONE;
@@ -249,7 +262,10 @@ void run_max_edges_graph_test(int pow_start, int pow_end){
     n = pow_two(i); /* n > 0 */
     adj_lst_rand_dir(&a, n, bern, &b);
     start =  RANDOM() % n;
-    dfs(&a, start, pre, post);
+    dfs(&a, start, pre, post, &st);
+    res *= (st.num_searches == 1 &&
+	    st.num_edges == n * (n - 1) + n - 1 &&
+	    st.num_pushes == 2 * n - 1);
     for (j = 0; j < n; j++){
       if (j == start){
 	res *= (pre[j] == 0);
@@ -282,6 +298,7 @@ void run_no_edges_graph_test(int pow_start, int pow_end){
   size_t *pre = NULL, *post = NULL;
   bern_arg_t b;
   adj_lst_t a;
+  dfs_stats_t st;
   pre = malloc_perror(pow_two(pow_end), sizeof(size_t));
   post = malloc_perror(pow_two(pow_end), sizeof(size_t));
   b.p = C_PROB_ZERO;
@@ -292,7 +309,10 @@ void run_no_edges_graph_test(int pow_start, int pow_end){
     n = pow_two(i);
     adj_lst_rand_dir(&a, n, bern, &b);
     start =  RANDOM() % n;
-    dfs(&a, start, pre, post);
+    dfs(&a, start, pre, post, &st);
+    res *= (st.num_searches == n &&
+	    st.num_edges == 0 &&
+	    st.num_pushes == n);
     for (j = 0; j < n; j++){
       res *= (post[j] - pre[j] == 1);
     }
@@ -308,14 +328,28 @@ void run_no_edges_graph_test(int pow_start, int pow_end){
 /**
    Runs a dfs test on random directed graphs.
 */
+typedef struct{
+  const adj_lst_t *a;
+  const size_t *start;
+  size_t *pre;
+  size_t *post;
+} rep_arg_t;
+
+void dfs_rep(void *arg, size_t i){
+  rep_arg_t *ra = arg;
+  dfs(ra->a, ra->start[i % C_ITER], ra->pre, ra->post, NULL);
+}
+
 void run_random_dir_graph_test(int pow_start, int pow_end){
   int i, j, k;
   size_t n;
   size_t *start = NULL;
   size_t *pre = NULL, *post = NULL;
+  char params[64];
   bern_arg_t b;
   adj_lst_t a;
-  clock_t t;
+  rep_arg_t ra;
+  bench_t bench;
   printf("Run a dfs test on random directed graphs from %d random "
 	 "start vertices in each graph \n", C_ITER);
   fflush(stdout);
@@ -331,15 +365,18 @@ void run_random_dir_graph_test(int pow_start, int pow_end){
       for (k = 0; k < C_ITER; k++){
 	start[k] =  RANDOM() % n;
       }
-      t = clock();
-      for (k = 0; k < C_ITER; k++){
-	dfs(&a, start[k], pre, post);
-      }
-      t = clock() - t;
-      printf("\t\tvertices: %lu, E[# of directed edges]: %.1f, "
-	     "average runtime: %.6f seconds\n",
-	     TOLU(n), b.p * n * (n - 1), (float)t / C_ITER / CLOCKS_PER_SEC);
-      fflush(stdout);
+      sprintf(params, "p=%.2f vts=%lu es=%lu",
+	      b.p, TOLU(a.num_vts), TOLU(a.num_es));
+      printf("\t\tvertices: %lu, E[# of directed edges]: %.1f\n",
+	     TOLU(n), b.p * n * (n - 1));
+      ra.a = &a;
+      ra.start = start;
+      ra.pre = pre;
+      ra.post = post;
+      bench_init(&bench, C_SUITE, "rand-dir dfs", C_NUM_WARMUPS, C_ITER);
+      bench_run(&bench, dfs_rep, &ra);
+      bench_report(&bench, "\t\t\tdfs runtime: ", params);
+      bench_free(&bench);
       adj_lst_free(&a);
     }
   }
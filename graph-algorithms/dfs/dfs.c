@@ -6,6 +6,11 @@
 
    The implementation emulates the recursion in DFS on a dynamically 
    allocated stack data structure to avoid an overflow of the memory stack.
+
+   If a pointer to a dfs_stats_t block is passed, the algorithm counts its
+   operations and measures the wall-clock time of its phases. An edge to
+   a vertex that was explored from u is examined again when the search
+   resumes at u, and is counted twice.
 */
 
 #include <stdio.h>
@@ -14,6 +19,7 @@
 #include "dfs.h"
 #include "graph.h"
 #include "stack.h"
+#include "utilities-time.h"
 
 typedef struct{
   size_t u;
@@ -26,7 +32,8 @@ static void search(const adj_lst_t *a,
 		   size_t u,
 		   size_t *c,
 		   size_t *pre,
-		   size_t *post);
+		   size_t *post,
+		   dfs_stats_t *stats);
 static void move_uvp(const adj_lst_t *a, uvp_t *uvp, const size_t *pre);
 
 static const size_t NR = (size_t)-1; /* not reached as index */
@@ -42,26 +49,47 @@ static const size_t STACK_INIT_COUNT = 1;
                  number of vertices in the adjacency list
    post        : pointer to a preallocated array with the count equal to the
                  number of vertices in the adjacency list
+   stats       : - NULL pointer, if operations are not counted
+                 - a pointer to a block of size sizeof(dfs_stats_t), where
+                 the counts and phase times of the run are copied
 */
-void dfs(const adj_lst_t *a, size_t start, size_t *pre, size_t *post){
+void dfs(const adj_lst_t *a,
+	 size_t start,
+	 size_t *pre,
+	 size_t *post,
+	 dfs_stats_t *stats){
   size_t c = 0; /* counter */
   size_t vt_size = sizeof(size_t);
   size_t i;
+  double t = 0.0;
   stack_t s;
+  if (stats != NULL){
+    memset(stats, 0, sizeof(dfs_stats_t));
+    t = time_wall();
+  }
   memset(pre, 0xff, a->num_vts * vt_size); /* initialize both arrays to NR */
   memset(post, 0xff, a->num_vts * vt_size);
   stack_init(&s, STACK_INIT_COUNT, sizeof(uvp_t), NULL);
+  if (stats != NULL){
+    stats->init_secs = time_wall() - t;
+    t = time_wall();
+  }
   for (i = start; i < a->num_vts; i++){
     if (pre[i] == NR){
-      search(a, &s, i, &c, pre, post);
+      search(a, &s, i, &c, pre, post, stats);
     }
   }
   for (i = 0; i < start; i++){
     if (pre[i] == NR){
-      search(a, &s, i, &c, pre, post);
+      search(a, &s, i, &c, pre, post, stats);
     }
   }
+  if (stats != NULL){
+    stats->search_secs = time_wall() - t;
+    t = time_wall();
+  }
   stack_free(&s);
+  if (stats != NULL) stats->free_secs = time_wall() - t;
 }
 
 /**
@@ -74,17 +102,31 @@ static void search(const adj_lst_t *a,
 		   size_t u,
 		   size_t *c,
 		   size_t *pre,
-		   size_t *post){
+		   size_t *post,
+		   dfs_stats_t *stats){
+  const char *vp = NULL;
   uvp_t uvp;
+  if (stats != NULL){
+    stats->num_searches++;
+    stats->num_pushes++;
+  }
   pre[u] = *c;
   (*c)++;
   uvp.u = u;
   uvp.vp = a->vt_wts[uvp.u]->elts;
-  uvp.vp_end = uvp.vp + a->vt_wts[uvp.u]->num_elts * a->step_size;
+  uvp.vp_end = uvp.vp + a->vt_wts[uvp.u]->num_elts * a->pair_size;
   stack_push(s, &uvp);
   while (s->num_elts > 0){
     stack_pop(s, &uvp);
+    vp = uvp.vp;
     move_uvp(a, &uvp, pre);
+    if (stats != NULL){
+      stats->num_edges += (uvp.vp - vp) / a->pair_size;
+      if (uvp.vp != uvp.vp_end){
+	stats->num_edges++;
+	stats->num_pushes += 2;
+      }
+    }
     if (uvp.vp == uvp.vp_end){
       post[uvp.u] = *c;
       (*c)++;
@@ -94,7 +136,7 @@ static void search(const adj_lst_t *a,
       (*c)++;
       uvp.u = *(const size_t *)uvp.vp;
       uvp.vp = a->vt_wts[uvp.u]->elts;
-      uvp.vp_end = uvp.vp + a->vt_wts[uvp.u]->num_elts * a->step_size;
+      uvp.vp_end = uvp.vp + a->vt_wts[uvp.u]->num_elts * a->pair_size;
       stack_push(s, &uvp); /* then push an unexplored vertex */
     }
   }
@@ -106,7 +148,7 @@ static void search(const adj_lst_t *a,
 */
 static void move_uvp(const adj_lst_t *a, uvp_t *uvp, const size_t *pre){
   const char *p = NULL;
-  for (p = uvp->vp; p != uvp->vp_end; p += a->step_size){
+  for (p = uvp->vp; p != uvp->vp_end; p += a->pair_size){
     if (pre[*(const size_t *)p] == NR){
       uvp->vp = p;
       return;
@@ -6,6 +6,9 @@
 
    The implementation emulates the recursion in DFS on a dynamically 
    allocated stack data structure to avoid an overflow of the memory stack.
+
+   If a pointer to a dfs_stats_t block is passed, the algorithm counts its
+   operations and measures the wall-clock time of its phases.
 */
 
 #ifndef DFS_H  
@@ -14,6 +17,15 @@
 #include <stddef.h>
 #include "graph.h"
 
+typedef struct{
+  size_t num_searches; /* # searches from unexplored vertices */
+  size_t num_edges; /* # examined edges, including the resumed edges */
+  size_t num_pushes; /* # stack pushes */
+  double init_secs; /* wall-clock time of initialization */
+  double search_secs; /* wall-clock time of the searches */
+  double free_secs; /* wall-clock time of freeing the stack */
+} dfs_stats_t;
+
 /**
    Computes and copies to the arrays pointed to by pre and post the previsit
    and postvisit values of a DFS search from a start vertex. Assumes start
@@ -24,7 +36,14 @@
                  number of vertices in the adjacency list
    post        : pointer to a preallocated array with the count equal to the
                  number of vertices in the adjacency list
+   stats       : - NULL pointer, if operations are not counted
+                 - a pointer to a block of size sizeof(dfs_stats_t), where
+                 the counts and phase times of the run are copied
 */
-void dfs(const adj_lst_t *a, size_t start, size_t *pre, size_t *post);
+void dfs(const adj_lst_t *a,
+	 size_t start,
+	 size_t *pre,
+	 size_t *post,
+	 dfs_stats_t *stats);
 
 #endif
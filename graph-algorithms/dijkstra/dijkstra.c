@@ -21,10 +21,17 @@
    the computation of hash values. If V is large and the graph is sparse,
    a non-default hash table may provide space advantages.
 
+   If a pointer to a dijkstra_stats_t block is passed, the algorithm counts
+   its operations, including the calls to the hash table of the heap, and
+   measures the wall-clock time of its phases. If NULL is passed, the
+   operations are not counted and the hash table is called directly.
+
    The implementation does not use stdint.h and is portable under C89/C90
    and C99.
 */
 
+#define UTILITIES_MEM_TAG MEM_TAG_GRAPH
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -33,6 +40,7 @@
 #include "heap.h"
 #include "stack.h"
 #include "utilities-mem.h"
+#include "utilities-time.h"
 
 typedef enum{FALSE, TRUE} boolean_t;
 
@@ -49,6 +57,11 @@ typedef struct{
   void (*free_elt)(void *);
 } ht_def_t;
 
+typedef struct{
+  const heap_ht_t *hht; /* counted hash table parameter */
+  dijkstra_stats_t *stats;
+} ht_ctr_t;
+
 static const size_t C_NREACHED = (size_t)-1; /* not reached as index */
 
 /* default hash table operations */
@@ -62,6 +75,17 @@ static void *ht_def_search(const ht_def_t *ht, const size_t *key);
 static void ht_def_remove(ht_def_t *ht, const size_t *key, void *elt);
 static void ht_def_free(ht_def_t *ht);
 
+/* hash table operations that count the calls to a hash table parameter */
+static void ht_ctr_init(ht_ctr_t *ht,
+			size_t key_size,
+			size_t elt_size,
+			void (*free_elt)(void *),
+			void *context);
+static void ht_ctr_insert(ht_ctr_t *ht, const void *key, const void *elt);
+static void *ht_ctr_search(const ht_ctr_t *ht, const void *key);
+static void ht_ctr_remove(ht_ctr_t *ht, const void *key, void *elt);
+static void ht_ctr_free(ht_ctr_t *ht);
+
 /* functions for computing pointers */
 static void *wt_ptr(const void *wts, size_t i, size_t wt_size);
 static void *elt_ptr(const void *elts, size_t i, size_t elt_size);
@@ -94,6 +118,9 @@ static void *elt_ptr(const void *elts, size_t i, size_t elt_size);
                  the first argument is greater than the weight value 
                  pointed to by the second, and zero integer value if the two
                  weight values are equal
+   stats       : - NULL pointer, if operations are not counted
+                 - a pointer to a block of size sizeof(dijkstra_stats_t),
+                 where the counts and phase times of the run are copied
 */
 void dijkstra(const adj_lst_t *a,
 	      size_t start,
@@ -101,17 +128,24 @@ void dijkstra(const adj_lst_t *a,
 	      size_t *prev,
 	      const heap_ht_t *hht,
 	      void (*add_wt)(void *, const void *, const void *),
-	      int (*cmp_wt)(const void *, const void *)){
+	      int (*cmp_wt)(const void *, const void *),
+	      dijkstra_stats_t *stats){
   const char *p = NULL, *p_start = NULL, *p_end = NULL;
   size_t wt_size = a->wt_size;
   size_t vt_size = sizeof(size_t);
   size_t init_count = 1;
   size_t u, v;
   void *u_wt = NULL, *v_wt = NULL, *sum_wt = NULL;
+  double t = 0.0;
   ht_def_t ht_def;
+  ht_ctr_t ht_ctr;
   context_t context;
-  heap_ht_t hht_def;
+  heap_ht_t hht_def, hht_ctr;
   heap_t h;
+  if (stats != NULL){
+    memset(stats, 0, sizeof(dijkstra_stats_t));
+    t = time_wall();
+  }
   u_wt = malloc_perror(1, wt_size);
   sum_wt = malloc_perror(1, wt_size);
   memset(dist, 0, a->num_vts * wt_size);
@@ -125,17 +159,37 @@ void dijkstra(const adj_lst_t *a,
     hht_def.search = (heap_ht_search)ht_def_search;
     hht_def.remove = (heap_ht_remove)ht_def_remove;
     hht_def.free = (heap_ht_free)ht_def_free;
-    heap_init(&h, init_count, wt_size, vt_size, &hht_def, cmp_wt, NULL);
-  }else{
-    heap_init(&h, init_count, wt_size, vt_size, hht, cmp_wt, NULL);
+    hht = &hht_def;
+  }
+  if (stats != NULL){
+    ht_ctr.hht = hht;
+    ht_ctr.stats = stats;
+    hht_ctr.ht = &ht_ctr;
+    hht_ctr.context = NULL;
+    hht_ctr.init = (heap_ht_init)ht_ctr_init;
+    hht_ctr.insert = (heap_ht_insert)ht_ctr_insert;
+    hht_ctr.search = (heap_ht_search)ht_ctr_search;
+    hht_ctr.remove = (heap_ht_remove)ht_ctr_remove;
+    hht_ctr.free = (heap_ht_free)ht_ctr_free;
+    hht = &hht_ctr;
   }
+  heap_init(&h, init_count, wt_size, vt_size, hht, cmp_wt, NULL);
   heap_push(&h, wt_ptr(dist, start, wt_size), &start);
   prev[start] = start;
+  if (stats != NULL){
+    stats->num_pushes++;
+    stats->init_secs = time_wall() - t;
+    t = time_wall();
+  }
   while (h.num_elts > 0){
     heap_pop(&h, u_wt, &u);
     p_start = a->vt_wts[u]->elts;
-    p_end = p_start + a->vt_wts[u]->num_elts * a->step_size;
-    for (p = p_start; p != p_end; p += a->step_size){
+    p_end = p_start + a->vt_wts[u]->num_elts * a->pair_size;
+    if (stats != NULL){
+      stats->num_pops++;
+      stats->num_edges += a->vt_wts[u]->num_elts;
+    }
+    for (p = p_start; p != p_end; p += a->pair_size){
       v = *(const size_t *)p;
       v_wt = wt_ptr(dist, v, wt_size);
       add_wt(sum_wt, u_wt, p + sizeof(size_t));
@@ -143,19 +197,27 @@ void dijkstra(const adj_lst_t *a,
 	memcpy(v_wt, sum_wt, wt_size);
 	heap_push(&h, v_wt, &v);
 	prev[v] = u;
+	if (stats != NULL) stats->num_pushes++;
       }else if (cmp_wt(v_wt, sum_wt) > 0){
 	/* must be in the heap */
 	memcpy(v_wt, sum_wt, wt_size);
 	heap_update(&h, v_wt, &v);
 	prev[v] = u;
+	if (stats != NULL) stats->num_updates++;
       }
     }
   }
+  if (stats != NULL){
+    stats->num_relax = stats->num_pushes - 1 + stats->num_updates;
+    stats->search_secs = time_wall() - t;
+    t = time_wall();
+  }
   heap_free(&h);
   free(u_wt);
   free(sum_wt);
   u_wt = NULL;
   sum_wt = NULL;
+  if (stats != NULL) stats->free_secs = time_wall() - t;
 }
 
 /**
@@ -216,6 +278,40 @@ static void ht_def_free(ht_def_t *ht){
   ht->elts = NULL;
 }
 
+/**
+   Hash table operations that count the calls to a hash table parameter
+   and forward the calls. The hash table parameter is initialized with its
+   own context.
+*/
+
+static void ht_ctr_init(ht_ctr_t *ht,
+			size_t key_size,
+			size_t elt_size,
+			void (*free_elt)(void *),
+			void *context){
+  (void)context;
+  ht->hht->init(ht->hht->ht, key_size, elt_size, free_elt, ht->hht->context);
+}
+
+static void ht_ctr_insert(ht_ctr_t *ht, const void *key, const void *elt){
+  ht->stats->num_ht_inserts++;
+  ht->hht->insert(ht->hht->ht, key, elt);
+}
+
+static void *ht_ctr_search(const ht_ctr_t *ht, const void *key){
+  ht->stats->num_ht_searches++;
+  return ht->hht->search(ht->hht->ht, key);
+}
+
+static void ht_ctr_remove(ht_ctr_t *ht, const void *key, void *elt){
+  ht->stats->num_ht_removes++;
+  ht->hht->remove(ht->hht->ht, key, elt);
+}
+
+static void ht_ctr_free(ht_ctr_t *ht){
+  (ht->hht->free)(ht->hht->ht);
+}
+
 /** Functions for computing pointers */
 
 /**
@@ -0,0 +1,397 @@
+/**
+   ecc-test.c
+
+   Tests of the computation of the diameter, radius, and eccentricities of
+   connected undirected graphs by bounding traversals.
+
+   The following command line arguments can be used to customize tests:
+   ecc-test
+     [0, # bits in size_t / 2] : a
+     [0, # bits in size_t / 2] : b s.t. 2^a <= V <= 2^b for random graph
+                                 tests
+     [0, # bits in size_t / 2] : c s.t. V = 2^c for the performance test
+     [0, 1] : on/off for disconnected graph test
+     [0, 1] : on/off for random graph test
+     [0, 1] : on/off for performance test
+
+   usage examples:
+   ./ecc-test
+   ./ecc-test 5 8
+   ./ecc-test 5 8 15 0 0 1
+
+   ecc-test can be run with any subset of command line arguments in the
+   above-defined order. If the (i + 1)th argument is specified then the ith
+   argument must be specified for i >= 0. Default values are used for the
+   unspecified arguments according to the C_ARGS_DEF array.
+
+   The implementation of tests does not use stdint.h and is portable under
+   C89/C90 and C99.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include "ecc.h"
+#include "bfs.h"
+#include "dijkstra.h"
+#include "graph.h"
+#include "stack.h"
+#include "utilities-bench.h"
+#include "utilities-mem.h"
+
+/**
+   Generate random numbers in a portable way for test purposes only; rand()
+   in the Linux C Library uses the same generator as random(), which may not
+   be the case on older rand() implementations, and on current
+   implementations on different systems.
+*/
+#ifdef TEST_SEED
+#define RGENS_SEED() do{srand(TEST_SEED);}while (0)
+#else
+#define RGENS_SEED() do{srand(time(NULL));}while (0)
+#endif
+#define RANDOM() (rand()) /* [0, RAND_MAX] */
+#define DRAND() ((double)rand() / RAND_MAX) /* [0.0, 1.0] */
+
+#define TOLU(i) ((unsigned long int)(i)) /* printing size_t under C89/C90 */
+
+/* input handling */
+const char *C_USAGE =
+  "ecc-test \n"
+  "[0, # bits in size_t / 2] : a \n"
+  "[0, # bits in size_t / 2] : b s.t. 2^a <= V <= 2^b for random graph \n"
+  "                            tests \n"
+  "[0, # bits in size_t / 2] : c s.t. V = 2^c for the performance test \n"
+  "[0, 1] : on/off for disconnected graph test \n"
+  "[0, 1] : on/off for random graph test \n"
+  "[0, 1] : on/off for performance test \n";
+const int C_ARGC_MAX = 7;
+const size_t C_ARGS_DEF[6] = {0, 7, 13, 1, 1, 1};
+const size_t C_FULL_BIT = CHAR_BIT * sizeof(size_t);
+
+/* tests */
+const double C_PROB_ONE = 1.0;
+const double C_PROB_ZERO = 0.0;
+const double C_PROBS[4] = {1.0, 0.1, 0.01, 0.0};
+const size_t C_PROBS_COUNT = 4;
+const size_t C_WT_L = 1;
+const size_t C_WT_H = 8;
+const size_t C_PA_EDGES = 2; /* # edges of each new vertex */
+
+typedef struct{
+  double p;
+} bern_arg_t;
+
+int bern(void *arg);
+void add_uint(void *sum, const void *wt_a, const void *wt_b);
+void sub_uint(void *diff, const void *wt_a, const void *wt_b);
+int cmp_uint(const void *a, const void *b);
+void conn_graph_init(adj_lst_t *a, graph_t *g, size_t n, int weighted,
+		     double p);
+void pa_graph_init(adj_lst_t *a, graph_t *g, size_t n, int weighted);
+void naive_ecc(const adj_lst_t *a, int weighted, size_t *ecc);
+void print_test_result(int res);
+
+int bern(void *arg){
+  bern_arg_t *b = arg;
+  if (b->p >= C_PROB_ONE) return 1;
+  if (b->p <= C_PROB_ZERO) return 0;
+  if (b->p > DRAND()) return 1;
+  return 0;
+}
+
+void add_uint(void *sum, const void *wt_a, const void *wt_b){
+  *(size_t *)sum = *(const size_t *)wt_a + *(const size_t *)wt_b;
+}
+
+void sub_uint(void *diff, const void *wt_a, const void *wt_b){
+  *(size_t *)diff = *(const size_t *)wt_a - *(const size_t *)wt_b;
+}
+
+int cmp_uint(const void *a, const void *b){
+  if (*(const size_t *)a > *(const size_t *)b){
+    return 1;
+  }else if (*(const size_t *)a < *(const size_t *)b){
+    return -1;
+  }else{
+    return 0;
+  }
+}
+
+/**
+   Builds a connected undirected graph with n vertices, where each vertex
+   u > 0 is connected to a random vertex less than u, and each other pair
+   of vertices is connected with probability p. If weighted is non-zero,
+   the graph has size_t weights in [C_WT_L, C_WT_H].
+*/
+void conn_graph_init(adj_lst_t *a, graph_t *g, size_t n, int weighted,
+		     double p){
+  size_t u, v, wt = 1;
+  bern_arg_t b_one, b;
+  b_one.p = C_PROB_ONE;
+  b.p = p;
+  graph_base_init(g, n, (weighted) ? sizeof(size_t) : 0);
+  adj_lst_init(a, g);
+  adj_lst_undir_build(a, g);
+  for (u = 1; u < n; u++){
+    if (weighted) wt = C_WT_L + RANDOM() % (C_WT_H - C_WT_L + 1);
+    adj_lst_add_undir_edge(a, RANDOM() % u, u,
+			   (weighted) ? &wt : NULL, bern, &b_one);
+  }
+  if (p <= C_PROB_ZERO) return;
+  for (u = 0; u < n; u++){
+    for (v = u + 1; v < n; v++){
+      if (weighted) wt = C_WT_L + RANDOM() % (C_WT_H - C_WT_L + 1);
+      adj_lst_add_undir_edge(a, u, v, (weighted) ? &wt : NULL, bern, &b);
+    }
+  }
+}
+
+/**
+   Builds a connected undirected graph with n vertices by preferential
+   attachment, where each vertex u > 0 is connected to at most C_PA_EDGES
+   vertices less than u, each chosen with a probability proportional to
+   its degree, i.e. as an endpoint of a random edge. The graph has a few
+   vertices of large degree and many vertices of small degree. If weighted
+   is non-zero, the graph has size_t weights in [C_WT_L, C_WT_H].
+*/
+void pa_graph_init(adj_lst_t *a, graph_t *g, size_t n, int weighted){
+  size_t i, u, v, wt = 1;
+  size_t num_ends = 0;
+  size_t *ends = NULL;
+  bern_arg_t b_one;
+  b_one.p = C_PROB_ONE;
+  ends = malloc_perror(2 * C_PA_EDGES * n + 1, sizeof(size_t));
+  graph_base_init(g, n, (weighted) ? sizeof(size_t) : 0);
+  adj_lst_init(a, g);
+  adj_lst_undir_build(a, g);
+  for (u = 1; u < n; u++){
+    for (i = 0; i < C_PA_EDGES; i++){
+      v = (num_ends == 0) ? 0 : ends[RANDOM() % num_ends];
+      if (i > 0 && ends[num_ends - 1] == v) break;
+      if (weighted) wt = C_WT_L + RANDOM() % (C_WT_H - C_WT_L + 1);
+      adj_lst_add_undir_edge(a, u, v, (weighted) ? &wt : NULL, bern, &b_one);
+      ends[num_ends] = u;
+      ends[num_ends + 1] = v;
+      num_ends += 2;
+    }
+  }
+  free(ends);
+  ends = NULL;
+}
+
+/**
+   Computes the eccentricities of a connected graph by a traversal from
+   each vertex.
+*/
+void naive_ecc(const adj_lst_t *a, int weighted, size_t *ecc){
+  size_t i, u;
+  size_t *dist = NULL, *prev = NULL;
+  dist = malloc_perror(a->num_vts, sizeof(size_t));
+  prev = malloc_perror(a->num_vts, sizeof(size_t));
+  for (u = 0; u < a->num_vts; u++){
+    if (weighted){
+      dijkstra(a, u, dist, prev, NULL, add_uint, cmp_uint, NULL);
+    }else{
+      bfs(a, u, dist, prev, NULL);
+    }
+    ecc[u] = 0;
+    for (i = 0; i < a->num_vts; i++){
+      if (dist[i] > ecc[u]) ecc[u] = dist[i];
+    }
+  }
+  free(dist);
+  free(prev);
+  dist = NULL;
+  prev = NULL;
+}
+
+/**
+   Tests that the functions return 0 on graphs without edges.
+*/
+void run_disconn_test(){
+  int res = 1;
+  size_t n, diam, rad;
+  size_t *ecc = NULL;
+  graph_t g;
+  adj_lst_t a;
+  printf("Run ecc test on graphs without edges\n");
+  for (n = 1; n < 4; n++){
+    ecc = malloc_perror(n, sizeof(size_t));
+    graph_base_init(&g, n, sizeof(size_t));
+    adj_lst_init(&a, &g);
+    adj_lst_undir_build(&a, &g);
+    res *= (ecc_diameter(&a, &diam, NULL, NULL, NULL, NULL, NULL) ==
+	    (n == 1));
+    res *= (ecc_radius(&a, &rad, NULL, add_uint, sub_uint, cmp_uint, NULL) ==
+	    (n == 1));
+    res *= (ecc_all(&a, ecc, NULL, NULL, NULL, NULL, NULL) == (n == 1));
+    if (n == 1) res *= (diam == 0 && rad == 0 && ecc[0] == 0);
+    adj_lst_free(&a);
+    graph_free(&g);
+    free(ecc);
+    ecc = NULL;
+  }
+  printf("\t1 <= V <= 3 --> ");
+  print_test_result(res);
+}
+
+/**
+   Tests ecc_diameter, ecc_radius, and ecc_all on connected random graphs
+   with and without weights against the eccentricities computed by a
+   traversal from each vertex.
+*/
+void run_random_graph_test(size_t log_start, size_t log_end){
+  int res = 1, weighted;
+  size_t i, l, u, n, diam, rad, diam_wo, rad_wo;
+  size_t num_travs = 0, num_naive = 0;
+  size_t *ecc = NULL, *ecc_wo = NULL;
+  graph_t g;
+  adj_lst_t a;
+  ecc_stats_t st;
+  ecc = malloc_perror((size_t)1 << log_end, sizeof(size_t));
+  ecc_wo = malloc_perror((size_t)1 << log_end, sizeof(size_t));
+  printf("Run ecc test on connected random graphs against a traversal "
+	 "from each vertex\n");
+  for (weighted = 0; weighted < 2; weighted++){
+    for (l = log_start; l <= log_end; l++){
+      n = (size_t)1 << l;
+      for (i = 0; i < C_PROBS_COUNT; i++){
+	conn_graph_init(&a, &g, n, weighted, C_PROBS[i]);
+	naive_ecc(&a, weighted, ecc_wo);
+	diam_wo = 0;
+	rad_wo = (size_t)-1;
+	for (u = 0; u < n; u++){
+	  if (ecc_wo[u] > diam_wo) diam_wo = ecc_wo[u];
+	  if (ecc_wo[u] < rad_wo) rad_wo = ecc_wo[u];
+	}
+	res *= ecc_diameter(&a, &diam, NULL,
+			    (weighted) ? add_uint : NULL, sub_uint, cmp_uint,
+			    &st);
+	num_travs += st.num_travs;
+	res *= ecc_radius(&a, &rad, NULL,
+			  (weighted) ? add_uint : NULL, sub_uint, cmp_uint,
+			  &st);
+	num_travs += st.num_travs;
+	res *= ecc_all(&a, ecc, NULL,
+		       (weighted) ? add_uint : NULL, sub_uint, cmp_uint, &st);
+	num_travs += st.num_travs;
+	num_naive += 3 * n;
+	res *= (diam == diam_wo && rad == rad_wo);
+	res *= (memcmp(ecc, ecc_wo, n * sizeof(size_t)) == 0);
+	adj_lst_free(&a);
+	graph_free(&g);
+      }
+    }
+  }
+  printf("\t2^%lu <= V <= 2^%lu, unweighted and size_t weights --> ",
+	 TOLU(log_start), TOLU(log_end));
+  print_test_result(res);
+  printf("\t# traversals: %lu, # traversals from each vertex: %lu\n",
+	 TOLU(num_travs), TOLU(num_naive));
+  free(ecc);
+  free(ecc_wo);
+  ecc = NULL;
+  ecc_wo = NULL;
+}
+
+/**
+   Runs ecc_diameter, ecc_radius, and ecc_all on a graph built by
+   preferential attachment with and without weights, and prints the counts
+   and times.
+*/
+void run_perf_test(size_t log_n){
+  int weighted;
+  size_t n = (size_t)1 << log_n;
+  size_t diam, rad;
+  size_t *ecc = NULL, *prev = NULL;
+  double t;
+  graph_t g;
+  adj_lst_t a;
+  ecc_stats_t st;
+  ecc = malloc_perror(n, sizeof(size_t));
+  prev = malloc_perror(n, sizeof(size_t));
+  printf("Run ecc performance test on graphs built by preferential "
+	 "attachment\n");
+  for (weighted = 0; weighted < 2; weighted++){
+    pa_graph_init(&a, &g, n, weighted);
+    printf("\tvertices: %lu, edges: %lu, %s\n",
+	   TOLU(a.num_vts), TOLU(a.num_es / 2),
+	   (weighted) ? "size_t weights" : "unweighted");
+    t = bench_wall_time();
+    if (weighted){
+      dijkstra(&a, 0, ecc, prev, NULL, add_uint, cmp_uint, NULL);
+    }else{
+      bfs(&a, 0, ecc, prev, NULL);
+    }
+    t = bench_wall_time() - t;
+    ecc_diameter(&a, &diam, NULL,
+		 (weighted) ? add_uint : NULL, sub_uint, cmp_uint, &st);
+    printf("\t\tdiameter: %lu, traversals: %lu, candidates after first: "
+	   "%lu, %.4f seconds\n",
+	   TOLU(diam), TOLU(st.num_travs), TOLU(st.num_cands),
+	   st.search_secs);
+    ecc_radius(&a, &rad, NULL,
+	       (weighted) ? add_uint : NULL, sub_uint, cmp_uint, &st);
+    printf("\t\tradius:   %lu, traversals: %lu, candidates after first: "
+	   "%lu, %.4f seconds\n",
+	   TOLU(rad), TOLU(st.num_travs), TOLU(st.num_cands),
+	   st.search_secs);
+    ecc_all(&a, ecc, NULL,
+	    (weighted) ? add_uint : NULL, sub_uint, cmp_uint, &st);
+    printf("\t\tall:      traversals: %lu, %.4f seconds\n",
+	   TOLU(st.num_travs), st.search_secs);
+    printf("\t\ttraversal from each vertex, estimate: %.4f seconds\n",
+	   t * n);
+    adj_lst_free(&a);
+    graph_free(&g);
+  }
+  free(ecc);
+  free(prev);
+  ecc = NULL;
+  prev = NULL;
+}
+
+/**
+   Prints a test result.
+*/
+void print_test_result(int res){
+  if (res){
+    printf("SUCCESS\n");
+  }else{
+    printf("FAILURE\n");
+  }
+}
+
+int main(int argc, char *argv[]){
+  int i;
+  size_t *args = NULL;
+  RGENS_SEED();
+  if (argc > C_ARGC_MAX){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  args = malloc_perror(C_ARGC_MAX - 1, sizeof(size_t));
+  memcpy(args, C_ARGS_DEF, (C_ARGC_MAX - 1) * sizeof(size_t));
+  for (i = 1; i < argc; i++){
+    args[i - 1] = atoi(argv[i]);
+  }
+  if (args[0] > C_FULL_BIT / 2 ||
+      args[1] > C_FULL_BIT / 2 ||
+      args[2] > C_FULL_BIT / 2 ||
+      args[0] > args[1] ||
+      args[3] > 1 ||
+      args[4] > 1 ||
+      args[5] > 1){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  if (args[3]) run_disconn_test();
+  if (args[4]) run_random_graph_test(args[0], args[1]);
+  if (args[5]) run_perf_test(args[2]);
+  free(args);
+  args = NULL;
+  return 0;
+}
@@ -0,0 +1,373 @@
+/**
+   ecc.c
+
+   Functions for computing the exact diameter, radius, and eccentricities
+   of connected undirected graphs with vertices indexed from 0, by bounding
+   traversals.
+
+   After each traversal, the lower and upper bounds of the eccentricities
+   are updated, and a vertex w is no longer a candidate if
+   - lower(w) = upper(w), i.e. its eccentricity is known,
+   - upper(w) <= max lower bound, if the diameter is computed, because the
+   eccentricity of w cannot exceed a known eccentricity,
+   - lower(w) >= min upper bound, if the radius is computed, because the
+   eccentricity of w cannot be less than a known eccentricity.
+   The computation ends when there are no candidates. Then the diameter is
+   the max lower bound, the radius is the min upper bound, and the
+   eccentricities are the lower bounds. At most V traversals are run,
+   because the source of each traversal is no longer a candidate.
+
+   The bounds, the distances, and the previous vertices of a traversal are
+   in arrays of V elements that are allocated once per call. On unweighted
+   graphs, the bounds are size_t values updated by internal functions.
+
+   If a pointer to an ecc_stats_t block is passed, the algorithm counts its
+   operations and measures the wall-clock time of its phases.
+
+   The implementation does not use stdint.h and is portable under C89/C90
+   and C99.
+*/
+
+#define UTILITIES_MEM_TAG MEM_TAG_GRAPH
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ecc.h"
+#include "bfs.h"
+#include "dijkstra.h"
+#include "graph.h"
+#include "heap.h"
+#include "stack.h"
+#include "utilities-mem.h"
+#include "utilities-time.h"
+
+typedef enum{FALSE, TRUE} boolean_t;
+
+typedef enum{
+  ECC_DIAMETER,
+  ECC_RADIUS,
+  ECC_ALL
+} ecc_mode_t;
+
+typedef struct{
+  size_t num_vts;
+  size_t wt_size; /* size of a distance and a bound */
+  size_t num_cands;
+  boolean_t *cand;
+  size_t *prev;
+  void *dist;
+  void *lo; /* lower bounds of eccentricities */
+  void *hi; /* upper bounds of eccentricities */
+  void *buf; /* blocks for the eccentricity of a source and sums */
+  void (*add_wt)(void *, const void *, const void *);
+  void (*sub_wt)(void *, const void *, const void *);
+  int (*cmp_wt)(const void *, const void *);
+} bounds_t;
+
+static const size_t C_NREACHED = (size_t)-1; /* not reached as index */
+static const size_t C_BUF_COUNT = 3;
+
+static int run(const adj_lst_t *a,
+	       ecc_mode_t mode,
+	       void *res,
+	       const heap_ht_t *hht,
+	       void (*add_wt)(void *, const void *, const void *),
+	       void (*sub_wt)(void *, const void *, const void *),
+	       int (*cmp_wt)(const void *, const void *),
+	       ecc_stats_t *stats);
+static void bounds_init(bounds_t *b,
+			const adj_lst_t *a,
+			void (*add_wt)(void *, const void *, const void *),
+			void (*sub_wt)(void *, const void *, const void *),
+			int (*cmp_wt)(const void *, const void *));
+static void bounds_update(bounds_t *b, int first);
+static void bounds_prune(bounds_t *b, ecc_mode_t mode);
+static size_t bounds_select(const bounds_t *b,
+			    const adj_lst_t *a,
+			    int use_hi);
+static const void *bounds_ext(const bounds_t *b, const void *wts, int max);
+static void bounds_free(bounds_t *b);
+static void *elt_ptr(const void *elts, size_t i, size_t elt_size);
+
+/* bound operations on unweighted graphs */
+static void add_size(void *sum, const void *a, const void *b);
+static void sub_size(void *diff, const void *a, const void *b);
+static int cmp_size(const void *a, const void *b);
+
+/**
+   Computes the diameter, i.e. the largest eccentricity, of a connected
+   undirected graph and copies it to a block pointed to by diam. Returns 1
+   if the graph is connected and 0 otherwise. See ecc.h for the
+   parameters.
+*/
+int ecc_diameter(const adj_lst_t *a,
+		 void *diam,
+		 const heap_ht_t *hht,
+		 void (*add_wt)(void *, const void *, const void *),
+		 void (*sub_wt)(void *, const void *, const void *),
+		 int (*cmp_wt)(const void *, const void *),
+		 ecc_stats_t *stats){
+  return run(a, ECC_DIAMETER, diam, hht, add_wt, sub_wt, cmp_wt, stats);
+}
+
+/**
+   Computes the radius, i.e. the smallest eccentricity, of a connected
+   undirected graph and copies it to a block pointed to by rad. Returns 1
+   if the graph is connected and 0 otherwise. See ecc.h for the
+   parameters.
+*/
+int ecc_radius(const adj_lst_t *a,
+	       void *rad,
+	       const heap_ht_t *hht,
+	       void (*add_wt)(void *, const void *, const void *),
+	       void (*sub_wt)(void *, const void *, const void *),
+	       int (*cmp_wt)(const void *, const void *),
+	       ecc_stats_t *stats){
+  return run(a, ECC_RADIUS, rad, hht, add_wt, sub_wt, cmp_wt, stats);
+}
+
+/**
+   Computes the eccentricity of each vertex of a connected undirected
+   graph and copies the eccentricities to an array pointed to by ecc.
+   Returns 1 if the graph is connected and 0 otherwise. See ecc.h for the
+   parameters.
+*/
+int ecc_all(const adj_lst_t *a,
+	    void *ecc,
+	    const heap_ht_t *hht,
+	    void (*add_wt)(void *, const void *, const void *),
+	    void (*sub_wt)(void *, const void *, const void *),
+	    int (*cmp_wt)(const void *, const void *),
+	    ecc_stats_t *stats){
+  return run(a, ECC_ALL, ecc, hht, add_wt, sub_wt, cmp_wt, stats);
+}
+
+/**
+   Runs traversals from selected candidates until there are no candidates,
+   and copies the result according to the mode.
+*/
+static int run(const adj_lst_t *a,
+	       ecc_mode_t mode,
+	       void *res,
+	       const heap_ht_t *hht,
+	       void (*add_wt)(void *, const void *, const void *),
+	       void (*sub_wt)(void *, const void *, const void *),
+	       int (*cmp_wt)(const void *, const void *),
+	       ecc_stats_t *stats){
+  int conn = 1;
+  size_t i, v;
+  double t = 0.0;
+  bounds_t b;
+  if (stats != NULL){
+    memset(stats, 0, sizeof(ecc_stats_t));
+    t = time_wall();
+  }
+  bounds_init(&b, a, add_wt, sub_wt, cmp_wt);
+  if (stats != NULL){
+    stats->init_secs = time_wall() - t;
+    t = time_wall();
+  }
+  for (v = 0, i = 1; i < a->num_vts; i++){
+    if (a->vt_wts[i]->num_elts > a->vt_wts[v]->num_elts) v = i;
+  }
+  for (i = 0; b.num_cands > 0; i++){
+    if (add_wt == NULL){
+      bfs(a, v, b.dist, b.prev, NULL);
+    }else{
+      dijkstra(a, v, b.dist, b.prev, hht, add_wt, cmp_wt, NULL);
+    }
+    if (stats != NULL) stats->num_travs++;
+    if (i == 0){
+      for (v = 0; v < b.num_vts && conn; v++){
+	conn = (b.prev[v] != C_NREACHED);
+      }
+      if (!conn) break;
+    }
+    bounds_update(&b, i == 0);
+    bounds_prune(&b, mode);
+    if (stats != NULL && i == 0) stats->num_cands = b.num_cands;
+    v = bounds_select(&b, a, i % 2);
+  }
+  if (conn && mode == ECC_DIAMETER){
+    memcpy(res, bounds_ext(&b, b.lo, 1), b.wt_size);
+  }else if (conn && mode == ECC_RADIUS){
+    memcpy(res, bounds_ext(&b, b.hi, 0), b.wt_size);
+  }else if (conn){
+    memcpy(res, b.lo, b.num_vts * b.wt_size);
+  }
+  if (stats != NULL){
+    stats->search_secs = time_wall() - t;
+    t = time_wall();
+  }
+  bounds_free(&b);
+  if (stats != NULL) stats->free_secs = time_wall() - t;
+  return conn;
+}
+
+/**
+   Initializes the bounds and the arrays of traversals. All vertices are
+   candidates.
+*/
+static void bounds_init(bounds_t *b,
+			const adj_lst_t *a,
+			void (*add_wt)(void *, const void *, const void *),
+			void (*sub_wt)(void *, const void *, const void *),
+			int (*cmp_wt)(const void *, const void *)){
+  size_t i;
+  b->num_vts = a->num_vts;
+  b->wt_size = (add_wt == NULL) ? sizeof(size_t) : a->wt_size;
+  b->num_cands = a->num_vts;
+  b->cand = malloc_perror(a->num_vts, sizeof(boolean_t));
+  b->prev = malloc_perror(a->num_vts, sizeof(size_t));
+  b->dist = malloc_perror(a->num_vts, b->wt_size);
+  b->lo = malloc_perror(a->num_vts, b->wt_size);
+  b->hi = malloc_perror(a->num_vts, b->wt_size);
+  b->buf = malloc_perror(C_BUF_COUNT, b->wt_size);
+  b->add_wt = (add_wt == NULL) ? add_size : add_wt;
+  b->sub_wt = (add_wt == NULL) ? sub_size : sub_wt;
+  b->cmp_wt = (add_wt == NULL) ? cmp_size : cmp_wt;
+  for (i = 0; i < a->num_vts; i++){
+    b->cand[i] = TRUE;
+  }
+}
+
+/**
+   Updates the bounds with the distances of the last traversal. If first
+   is non-zero, the bounds are set.
+*/
+static void bounds_update(bounds_t *b, int first){
+  size_t i;
+  size_t wt_size = b->wt_size;
+  void *e = elt_ptr(b->buf, 0, wt_size);
+  void *diff = elt_ptr(b->buf, 1, wt_size);
+  void *sum = elt_ptr(b->buf, 2, wt_size);
+  const void *d = NULL, *lo = NULL;
+  memcpy(e, bounds_ext(b, b->dist, 1), wt_size);
+  for (i = 0; i < b->num_vts; i++){
+    d = elt_ptr(b->dist, i, wt_size);
+    b->sub_wt(diff, e, d);
+    lo = (b->cmp_wt(d, diff) > 0) ? d : diff;
+    b->add_wt(sum, e, d);
+    if (first || b->cmp_wt(lo, elt_ptr(b->lo, i, wt_size)) > 0){
+      memcpy(elt_ptr(b->lo, i, wt_size), lo, wt_size);
+    }
+    if (first || b->cmp_wt(sum, elt_ptr(b->hi, i, wt_size)) < 0){
+      memcpy(elt_ptr(b->hi, i, wt_size), sum, wt_size);
+    }
+  }
+}
+
+/**
+   Removes the candidates whose bounds cannot change the result according
+   to the mode.
+*/
+static void bounds_prune(bounds_t *b, ecc_mode_t mode){
+  size_t i;
+  size_t wt_size = b->wt_size;
+  const void *lo = NULL, *hi = NULL;
+  const void *max_lo = bounds_ext(b, b->lo, 1);
+  const void *min_hi = bounds_ext(b, b->hi, 0);
+  for (i = 0; i < b->num_vts; i++){
+    if (!b->cand[i]) continue;
+    lo = elt_ptr(b->lo, i, wt_size);
+    hi = elt_ptr(b->hi, i, wt_size);
+    if (b->cmp_wt(lo, hi) == 0 ||
+	(mode == ECC_DIAMETER && b->cmp_wt(hi, max_lo) <= 0) ||
+	(mode == ECC_RADIUS && b->cmp_wt(lo, min_hi) >= 0)){
+      b->cand[i] = FALSE;
+      b->num_cands--;
+    }
+  }
+}
+
+/**
+   Returns the candidate with the largest upper bound if use_hi is
+   non-zero, and otherwise the candidate with the smallest lower bound,
+   with ties broken by the larger degree. Returns 0 if there are no
+   candidates.
+*/
+static size_t bounds_select(const bounds_t *b,
+			    const adj_lst_t *a,
+			    int use_hi){
+  int c;
+  size_t i, v = C_NREACHED;
+  size_t wt_size = b->wt_size;
+  for (i = 0; i < b->num_vts; i++){
+    if (!b->cand[i]) continue;
+    if (v == C_NREACHED){
+      v = i;
+      continue;
+    }
+    if (use_hi){
+      c = b->cmp_wt(elt_ptr(b->hi, i, wt_size), elt_ptr(b->hi, v, wt_size));
+    }else{
+      c = b->cmp_wt(elt_ptr(b->lo, v, wt_size), elt_ptr(b->lo, i, wt_size));
+    }
+    if (c > 0 ||
+	(c == 0 && a->vt_wts[i]->num_elts > a->vt_wts[v]->num_elts)){
+      v = i;
+    }
+  }
+  return (v == C_NREACHED) ? 0 : v;
+}
+
+/**
+   Returns a pointer to the max weight in an array of num_vts weights if
+   max is non-zero, and otherwise a pointer to the min weight.
+*/
+static const void *bounds_ext(const bounds_t *b, const void *wts, int max){
+  size_t i;
+  const void *ext = wts;
+  const void *w = NULL;
+  for (i = 1; i < b->num_vts; i++){
+    w = elt_ptr(wts, i, b->wt_size);
+    if ((max && b->cmp_wt(w, ext) > 0) || (!max && b->cmp_wt(w, ext) < 0)){
+      ext = w;
+    }
+  }
+  return ext;
+}
+
+/**
+   Frees the arrays of the bounds and traversals.
+*/
+static void bounds_free(bounds_t *b){
+  free(b->cand);
+  free(b->prev);
+  free(b->dist);
+  free(b->lo);
+  free(b->hi);
+  free(b->buf);
+  b->cand = NULL;
+  b->prev = NULL;
+  b->dist = NULL;
+  b->lo = NULL;
+  b->hi = NULL;
+  b->buf = NULL;
+}
+
+static void add_size(void *sum, const void *a, const void *b){
+  *(size_t *)sum = *(const size_t *)a + *(const size_t *)b;
+}
+
+static void sub_size(void *diff, const void *a, const void *b){
+  *(size_t *)diff = *(const size_t *)a - *(const size_t *)b;
+}
+
+static int cmp_size(const void *a, const void *b){
+  if (*(const size_t *)a > *(const size_t *)b){
+    return 1;
+  }else if (*(const size_t *)a < *(const size_t *)b){
+    return -1;
+  }else{
+    return 0;
+  }
+}
+
+/**
+   Computes a pointer to an element in an element array.
+*/
+static void *elt_ptr(const void *elts, size_t i, size_t elt_size){
+  return (void *)((char *)elts + i * elt_size);
+}
@@ -0,0 +1,125 @@
+/**
+   ecc.h
+
+   Declarations of accessible functions for computing the exact diameter,
+   radius, and eccentricities of connected undirected graphs with vertices
+   indexed from 0, by bounding traversals.
+
+   The eccentricity of a vertex is its largest distance to a vertex. The
+   algorithm of Takes and Kosters (Computing the Eccentricity Distribution
+   of Large Graphs, 2013) maintains a lower bound and an upper bound of the
+   eccentricity of each vertex. A traversal from a vertex v with
+   eccentricity e sets for each vertex w at distance d from v
+
+     lower(w) = max(lower(w), d, e - d),
+     upper(w) = min(upper(w), e + d),
+
+   and the vertices whose bounds cannot change the result are no longer
+   candidates. The traversals start from candidates with the largest upper
+   bound and the smallest lower bound in turn, with ties broken by the
+   larger degree. The first traversal starts from a vertex of the largest
+   degree. On real-world graphs the result is typically obtained after tens
+   of traversals instead of V traversals.
+
+   The traversals are runs of bfs on unweighted graphs, or runs of dijkstra
+   with generic non-negative weights. For weights, an addition, a
+   subtraction, and a comparison function are provided. The bounds are
+   computed by additions and subtractions of distances, and the results
+   are exact for integer weights.
+
+   The adjacency list is expected to represent an undirected graph, e.g.
+   built with adj_lst_undir_build or adj_lst_rand_undir. If the graph is
+   not connected, the eccentricities are not defined, and the functions
+   return 0 after the first traversal.
+
+   If a pointer to an ecc_stats_t block is passed, the algorithm counts its
+   operations and measures the wall-clock time of its phases.
+*/
+
+#ifndef ECC_H
+#define ECC_H
+
+#include <stddef.h>
+#include "graph.h"
+#include "heap.h"
+
+typedef struct{
+  size_t num_travs; /* # runs of bfs or dijkstra */
+  size_t num_cands; /* # candidates after the first traversal */
+  double init_secs; /* wall-clock time of initialization */
+  double search_secs; /* wall-clock time of the traversals and bounds */
+  double free_secs; /* wall-clock time of freeing the bounds */
+} ecc_stats_t;
+
+/**
+   Computes the diameter, i.e. the largest eccentricity, of a connected
+   undirected graph and copies it to a block pointed to by diam. Returns 1
+   if the graph is connected and 0 otherwise, in which case the block
+   pointed to by diam is not modified.
+   a           : pointer to an adjacency list of an undirected graph with
+                 at least one vertex
+   diam        : - pointer to a block of size sizeof(size_t), if add_wt is
+                 NULL; the diameter is the # of edges
+                 - otherwise pointer to a block of the size of a weight
+   hht         : NULL or a hash table parameter for the in-heap operations
+                 of dijkstra; not used if add_wt is NULL
+   add_wt      : - NULL, if the graph is unweighted or the weights are not
+                 used; distances are computed by bfs
+                 - otherwise an addition function which copies the sum of
+                 the weight values pointed to by the second and third
+                 arguments to the preallocated weight block pointed to by
+                 the first argument; distances are computed by dijkstra
+   sub_wt      : subtraction function which copies the difference of the
+                 weight values pointed to by the second and third
+                 arguments, where the second is greater or equal to the
+                 third, to the preallocated weight block pointed to by the
+                 first argument; not used if add_wt is NULL
+   cmp_wt      : comparison function as in dijkstra; not used if add_wt is
+                 NULL
+   stats       : - NULL pointer, if operations are not counted
+                 - a pointer to a block of size sizeof(ecc_stats_t), where
+                 the counts and phase times of the run are copied
+*/
+int ecc_diameter(const adj_lst_t *a,
+		 void *diam,
+		 const heap_ht_t *hht,
+		 void (*add_wt)(void *, const void *, const void *),
+		 void (*sub_wt)(void *, const void *, const void *),
+		 int (*cmp_wt)(const void *, const void *),
+		 ecc_stats_t *stats);
+
+/**
+   Computes the radius, i.e. the smallest eccentricity, of a connected
+   undirected graph and copies it to a block pointed to by rad. Returns 1
+   if the graph is connected and 0 otherwise, in which case the block
+   pointed to by rad is not modified. The parameters are as in
+   ecc_diameter.
+*/
+int ecc_radius(const adj_lst_t *a,
+	       void *rad,
+	       const heap_ht_t *hht,
+	       void (*add_wt)(void *, const void *, const void *),
+	       void (*sub_wt)(void *, const void *, const void *),
+	       int (*cmp_wt)(const void *, const void *),
+	       ecc_stats_t *stats);
+
+/**
+   Computes the eccentricity of each vertex of a connected undirected
+   graph and copies the eccentricities to an array pointed to by ecc.
+   Returns 1 if the graph is connected and 0 otherwise, in which case the
+   array pointed to by ecc is not modified.
+   ecc         : - pointer to an array of size_t with the count equal to
+                 the number of vertices, if add_wt is NULL
+                 - otherwise pointer to an array of weights with the count
+                 equal to the number of vertices
+   The other parameters are as in ecc_diameter.
+*/
+int ecc_all(const adj_lst_t *a,
+	    void *ecc,
+	    const heap_ht_t *hht,
+	    void (*add_wt)(void *, const void *, const void *),
+	    void (*sub_wt)(void *, const void *, const void *),
+	    int (*cmp_wt)(const void *, const void *),
+	    ecc_stats_t *stats);
+
+#endif
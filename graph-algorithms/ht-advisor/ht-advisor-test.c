@@ -0,0 +1,332 @@
+/**
+   ht-advisor-test.c
+
+   Tests of the hash table advisor of Dijkstra's algorithm, Prim's
+   algorithm, and TSP on random graphs with random size_t weights.
+
+   The following command line arguments can be used to customize tests:
+   ht-advisor-test:
+   -  [0, # bits in size_t / 2] : n for 2^n vertices in the smallest graph
+   -  [0, # bits in size_t / 2] : n for 2^n vertices in the largest graph
+   -  [0, 1] : dijkstra and prim advisor test on/off
+   -  [0, 1] : tsp advisor test on/off
+
+   usage examples:
+   ./ht-advisor-test
+   ./ht-advisor-test 10 14
+   ./ht-advisor-test 14 14 1 0
+
+   ht-advisor-test can be run with any subset of command line arguments in
+   the above-defined order. If the (i + 1)th argument is specified then the
+   ith argument must be specified for i >= 0. Default values are used for
+   the unspecified arguments according to the C_ARGS_DEF array.
+
+   A test passes if the recommended configuration is viable and is optimal
+   under its objective among the viable configurations, if the peak bytes
+   of each viable hash table are positive, and if the algorithm computes
+   the same results with the recommended configuration as with a default
+   hash table.
+
+   The implementation of tests does not use stdint.h and is portable under
+   C89/C90 and C99 with the only requirement that CHAR_BIT * sizeof(size_t)
+   is greater or equal to 16 and is even.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include "ht-advisor.h"
+#include "dijkstra.h"
+#include "prim.h"
+#include "tsp.h"
+#include "graph.h"
+#include "stack.h"
+#include "utilities-mem.h"
+#include "utilities-mod.h"
+
+/**
+   Generate random numbers in a portable way for test purposes only; rand()
+   in the Linux C Library uses the same generator as random(), which may not
+   be the case on older rand() implementations, and on current
+   implementations on different systems.
+*/
+#ifdef TEST_SEED
+#define RGENS_SEED() do{srand(TEST_SEED);}while (0)
+#else
+#define RGENS_SEED() do{srand(time(NULL));}while (0)
+#endif
+#define DRAND() ((double)rand() / RAND_MAX) /* [0.0, 1.0] */
+
+#define TOLU(i) ((unsigned long int)(i)) /* printing size_t under C89/C90 */
+
+/* input handling */
+const char *C_USAGE =
+  "ht-advisor-test \n"
+  "[0, # bits in size_t / 2] : n for 2^n vertices in smallest graph\n"
+  "[0, # bits in size_t / 2] : n for 2^n vertices in largest graph\n"
+  "[0, 1] : dijkstra and prim advisor test on/off\n"
+  "[0, 1] : tsp advisor test on/off\n";
+const int C_ARGC_MAX = 5;
+const size_t C_ARGS_DEF[4] = {6, 10, 1, 1};
+const size_t C_FULL_BIT = CHAR_BIT * sizeof(size_t);
+
+/* tests */
+const size_t C_NUM_STARTS = 4;
+const size_t C_NUM_REPS = 3;
+const int C_PROBS_COUNT = 2;
+const double C_PROBS[2] = {1.000000, 0.015625};
+const size_t C_WEIGHT_HIGH = ((size_t)-1 >>
+			      ((CHAR_BIT * sizeof(size_t) + 1) / 2));
+const size_t C_TSP_NUM_VTS = 10;
+const size_t C_TSP_MAX_DEF_BYTES = 1073741824; /* 1GB */
+const char *C_KIND_NAMES[3] = {"default", "divchn", "muloa"};
+const char *C_OBJ_NAMES[2] = {"time", "memory"};
+
+void add_uint(void *s, const void *a, const void *b);
+int cmp_uint(const void *a, const void *b);
+int bern(void *arg);
+void adj_lst_rand_undir_wts(adj_lst_t *a, size_t n, double p);
+int cfg_optimal(const ht_adv_cfg_t *cfgs,
+		size_t num_cfgs,
+		size_t ix,
+		ht_adv_obj_t obj);
+void print_cfg(const ht_adv_cfg_t *cfg);
+void print_test_result(int res);
+
+/**
+   Runs a test of ht_adv_dijkstra and ht_adv_prim on random undirected
+   graphs with random size_t weights, under each objective.
+*/
+void run_heap_ht_test(size_t log_start, size_t log_end){
+  int res = 1;
+  int i, obj;
+  size_t j, k, n, ix;
+  size_t num_cfgs;
+  size_t *dist = NULL, *prev = NULL, *dist_def = NULL, *prev_def = NULL;
+  ht_adv_cfg_t cfgs[HT_ADV_CFGS_DEF_COUNT];
+  ht_adv_ht_t h;
+  adj_lst_t a;
+  printf("Run a ht_adv_{dijkstra, prim} test on random undirected graphs "
+	 "with random size_t weights\n");
+  for (i = 0; i < C_PROBS_COUNT; i++){
+    printf("\tP[an edge is in a graph] = %.4f\n", C_PROBS[i]);
+    for (j = log_start; j <= log_end; j++){
+      n = pow_two_perror(j);
+      adj_lst_rand_undir_wts(&a, n, C_PROBS[i]);
+      dist = malloc_perror(n, sizeof(size_t));
+      prev = malloc_perror(n, sizeof(size_t));
+      dist_def = malloc_perror(n, sizeof(size_t));
+      prev_def = malloc_perror(n, sizeof(size_t));
+      printf("\t\tvertices: %lu, directed edges: %lu\n",
+	     TOLU(a.num_vts), TOLU(a.num_es));
+      for (obj = HT_ADV_TIME; obj <= HT_ADV_MEM; obj++){
+	num_cfgs = ht_adv_cfgs_def(cfgs);
+	ix = ht_adv_dijkstra(&a, C_NUM_STARTS, C_NUM_REPS, add_uint,
+			     cmp_uint, obj, cfgs, num_cfgs);
+	res *= cfg_optimal(cfgs, num_cfgs, ix, obj);
+	printf("\t\t\tdijkstra, %-6s : ", C_OBJ_NAMES[obj]);
+	print_cfg(&cfgs[ix]);
+	for (k = 0; k < n; k += n / C_NUM_STARTS + 1){
+	  dijkstra(&a, k, dist_def, prev_def, NULL, add_uint, cmp_uint, NULL);
+	  dijkstra(&a, k, dist, prev, ht_adv_heap_ht(&h, &cfgs[ix]),
+		   add_uint, cmp_uint, NULL);
+	  res *= (memcmp(dist, dist_def, n * sizeof(size_t)) == 0);
+	  res *= (memcmp(prev, prev_def, n * sizeof(size_t)) == 0);
+	}
+	num_cfgs = ht_adv_cfgs_def(cfgs);
+	ix = ht_adv_prim(&a, C_NUM_STARTS, C_NUM_REPS, cmp_uint, obj,
+			 cfgs, num_cfgs);
+	res *= cfg_optimal(cfgs, num_cfgs, ix, obj);
+	printf("\t\t\tprim,     %-6s : ", C_OBJ_NAMES[obj]);
+	print_cfg(&cfgs[ix]);
+	prim(&a, 0, dist_def, prev_def, NULL, cmp_uint, NULL);
+	prim(&a, 0, dist, prev, ht_adv_heap_ht(&h, &cfgs[ix]),
+	     cmp_uint, NULL);
+	res *= (memcmp(dist, dist_def, n * sizeof(size_t)) == 0);
+      }
+      adj_lst_free(&a);
+      free(dist);
+      free(prev);
+      free(dist_def);
+      free(prev_def);
+      dist = NULL;
+      prev = NULL;
+      dist_def = NULL;
+      prev_def = NULL;
+    }
+  }
+  printf("\tcorrectness:      ");
+  print_test_result(res);
+}
+
+/**
+   Runs a test of ht_adv_tsp on a random complete graph with random size_t
+   weights, on the same graph with a memory budget of 0 bytes, and on a
+   graph with CHAR_BIT * sizeof(size_t) vertices, where a default hash
+   table is not viable.
+*/
+void run_tsp_ht_test(){
+  int res = 1;
+  int obj;
+  size_t ix, num_cfgs;
+  size_t dist, dist_def;
+  ht_adv_cfg_t cfgs[HT_ADV_CFGS_DEF_COUNT];
+  ht_adv_ht_t h;
+  adj_lst_t a;
+  printf("Run a ht_adv_tsp test on random complete graphs with random "
+	 "size_t weights\n");
+  adj_lst_rand_undir_wts(&a, C_TSP_NUM_VTS, 1.0);
+  printf("\tvertices: %lu, directed edges: %lu\n",
+	 TOLU(a.num_vts), TOLU(a.num_es));
+  for (obj = HT_ADV_TIME; obj <= HT_ADV_MEM; obj++){
+    num_cfgs = ht_adv_cfgs_def(cfgs);
+    ix = ht_adv_tsp(&a, C_TSP_NUM_VTS, C_NUM_REPS, C_TSP_MAX_DEF_BYTES,
+		    add_uint, cmp_uint, obj, cfgs, num_cfgs);
+    res *= cfg_optimal(cfgs, num_cfgs, ix, obj);
+    res *= cfgs[0].viable;
+    printf("\t\ttsp, %-6s : ", C_OBJ_NAMES[obj]);
+    print_cfg(&cfgs[ix]);
+    res *= (tsp(&a, 0, &dist_def, NULL, add_uint, cmp_uint, NULL) ==
+	    tsp(&a, 0, &dist, ht_adv_tsp_ht(&h, &cfgs[ix]),
+		add_uint, cmp_uint, NULL));
+    res *= (dist == dist_def);
+  }
+  num_cfgs = ht_adv_cfgs_def(cfgs);
+  ix = ht_adv_tsp(&a, C_TSP_NUM_VTS, C_NUM_REPS, 0, add_uint, cmp_uint,
+		  HT_ADV_MEM, cfgs, num_cfgs);
+  res *= cfg_optimal(cfgs, num_cfgs, ix, HT_ADV_MEM);
+  res *= (!cfgs[0].viable && cfgs[ix].kind != HT_ADV_DEF);
+  adj_lst_free(&a);
+  adj_lst_rand_undir_wts(&a, C_FULL_BIT, 1.0);
+  printf("\tvertices: %lu, directed edges: %lu, sampled vertices: %lu\n",
+	 TOLU(a.num_vts), TOLU(a.num_es), TOLU(C_TSP_NUM_VTS));
+  num_cfgs = ht_adv_cfgs_def(cfgs);
+  ix = ht_adv_tsp(&a, C_TSP_NUM_VTS, C_NUM_REPS, C_TSP_MAX_DEF_BYTES,
+		  add_uint, cmp_uint, HT_ADV_TIME, cfgs, num_cfgs);
+  res *= cfg_optimal(cfgs, num_cfgs, ix, HT_ADV_TIME);
+  res *= (!cfgs[0].viable && cfgs[ix].kind != HT_ADV_DEF);
+  printf("\t\ttsp, %-6s : ", C_OBJ_NAMES[HT_ADV_TIME]);
+  print_cfg(&cfgs[ix]);
+  adj_lst_free(&a);
+  printf("\tcorrectness:      ");
+  print_test_result(res);
+}
+
+/**
+   Returns 1 if the configuration at index ix is viable and optimal under
+   an objective among the viable configurations, and if each viable
+   hash table has positive peak bytes. Returns 0 otherwise.
+*/
+int cfg_optimal(const ht_adv_cfg_t *cfgs,
+		size_t num_cfgs,
+		size_t ix,
+		ht_adv_obj_t obj){
+  int res = 1;
+  size_t i;
+  if (ix >= num_cfgs || !cfgs[ix].viable) return 0;
+  for (i = 0; i < num_cfgs; i++){
+    if (!cfgs[i].viable) continue;
+    res *= (cfgs[i].peak_bytes > 0);
+    if (obj == HT_ADV_MEM){
+      res *= (cfgs[ix].peak_bytes <= cfgs[i].peak_bytes);
+    }else{
+      res *= (cfgs[ix].secs <= cfgs[i].secs);
+    }
+  }
+  return res;
+}
+
+/**
+   Construct adjacency lists of random undirected graphs with random size_t
+   weights.
+*/
+
+void add_uint(void *s, const void *a, const void *b){
+  *(size_t *)s = *(size_t *)a + *(size_t *)b;
+}
+
+int cmp_uint(const void *a, const void *b){
+  if (*(size_t *)a > *(size_t *)b){
+    return 1;
+  }else if (*(size_t *)a < *(size_t *)b){
+    return -1;
+  }else{
+    return 0;
+  }
+}
+
+int bern(void *arg){
+  double *p = arg;
+  if (*p >= 1.0) return 1;
+  if (*p <= 0.0) return 0;
+  if (*p > DRAND()) return 1;
+  return 0;
+}
+
+void adj_lst_rand_undir_wts(adj_lst_t *a, size_t n, double p){
+  size_t i, j;
+  size_t wt;
+  graph_t g;
+  graph_base_init(&g, n, sizeof(size_t));
+  adj_lst_init(a, &g);
+  for (i = 0; i + 1 < n; i++){
+    for (j = i + 1; j < n; j++){
+      wt = DRAND() * C_WEIGHT_HIGH;
+      adj_lst_add_undir_edge(a, i, j, &wt, bern, &p);
+    }
+  }
+  graph_free(&g);
+}
+
+/**
+   Prints a configuration and a test result.
+*/
+
+void print_cfg(const ht_adv_cfg_t *cfg){
+  printf("%-7s", C_KIND_NAMES[cfg->kind]);
+  if (cfg->kind == HT_ADV_DEF){
+    printf("             ");
+  }else{
+    printf(" alpha %.3f ",
+	   (double)cfg->alpha_n / pow_two_perror(cfg->log_alpha_d));
+  }
+  printf("%.6f seconds, %lu bytes\n", cfg->secs, TOLU(cfg->peak_bytes));
+}
+
+void print_test_result(int res){
+  if (res){
+    printf("SUCCESS\n");
+  }else{
+    printf("FAILURE\n");
+  }
+}
+
+int main(int argc, char *argv[]){
+  int i;
+  size_t *args = NULL;
+  RGENS_SEED();
+  if (argc > C_ARGC_MAX){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  args = malloc_perror(C_ARGC_MAX - 1, sizeof(size_t));
+  memcpy(args, C_ARGS_DEF, (C_ARGC_MAX - 1) * sizeof(size_t));
+  for (i = 1; i < argc; i++){
+    args[i - 1] = atoi(argv[i]);
+  }
+  if (args[0] > C_FULL_BIT / 2 ||
+      args[1] > C_FULL_BIT / 2 ||
+      args[1] < args[0] ||
+      args[2] > 1 ||
+      args[3] > 1){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  if (args[2]) run_heap_ht_test(args[0], args[1]);
+  if (args[3]) run_tsp_ht_test();
+  free(args);
+  args = NULL;
+  return 0;
+}
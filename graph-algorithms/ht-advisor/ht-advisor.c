@@ -0,0 +1,557 @@
+/**
+   ht-advisor.c
+
+   Functions for choosing the hash table parameter of Dijkstra's
+   algorithm, Prim's algorithm, and TSP on a given graph by running a
+   sampled workload.
+
+   The first run of the sampled workload of a division or
+   multiplication-based hash table passes a hash table parameter that
+   counts the keys of the hash table and forwards the calls. When the hash
+   table is freed, its bytes are computed with its footprint function and
+   the bytes of the keys that were removed after the peak are added. The
+   hash tables do not decrease their number of slots, and the bytes of a
+   key are the bytes of its node in ht-divchn and of its key element block
+   in ht-muloa. The following runs are timed with utilities-bench.
+
+   The bytes of a default hash table are the bytes of its key presence and
+   element arrays, as allocated in dijkstra.c, prim.c, and tsp.c.
+
+   The sampled subgraph of TSP is built from the vertices in the order of
+   a breadth-first search from vertex 0, so that the sample is connected
+   if the graph is, and the tours of the sample resemble the tours of the
+   graph more than the tours of the subgraph induced by the first vertices.
+
+   The implementation does not use stdint.h and is portable under C89/C90
+   and C99.
+*/
+
+#define UTILITIES_MEM_TAG MEM_TAG_GRAPH
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "ht-advisor.h"
+#include "dijkstra.h"
+#include "prim.h"
+#include "tsp.h"
+#include "graph.h"
+#include "heap.h"
+#include "ht-divchn.h"
+#include "ht-muloa.h"
+#include "dll.h"
+#include "utilities-bench.h"
+#include "utilities-mem.h"
+#include "utilities-mod.h"
+
+typedef enum{FALSE, TRUE} boolean_t; /* as in the default hash tables */
+
+typedef enum{
+  ALG_DIJKSTRA,
+  ALG_PRIM,
+  ALG_TSP
+} alg_t;
+
+typedef struct{
+  alg_t alg;
+  const adj_lst_t *a;
+  size_t num_starts;
+  void *dist;
+  size_t *prev;
+  void (*add_wt)(void *, const void *, const void *);
+  int (*cmp_wt)(const void *, const void *);
+} work_t;
+
+typedef struct{
+  ht_adv_ht_t *h; /* hash table of a configuration */
+  size_t num_keys;
+  size_t peak_keys; /* peak # keys in a run of an algorithm */
+  size_t peak_bytes; /* peak bytes across the runs of the workload */
+} ht_peak_t;
+
+static const char *C_SUITE = "ht-advisor";
+static const char *C_ALG_NAMES[3] = {"dijkstra sample",
+				     "prim sample",
+				     "tsp sample"};
+static const size_t C_FULL_BIT = CHAR_BIT * sizeof(size_t);
+static const ht_adv_cfg_t C_CFGS_DEF[HT_ADV_CFGS_DEF_COUNT] =
+  {{HT_ADV_DEF, 0, 0, 0, 0.0, 0},
+   {HT_ADV_DIVCHN, 1, 1, 0, 0.0, 0},
+   {HT_ADV_DIVCHN, 1, 0, 0, 0.0, 0},
+   {HT_ADV_DIVCHN, 2, 0, 0, 0.0, 0},
+   {HT_ADV_MULOA, 6554, 15, 0, 0.0, 0},
+   {HT_ADV_MULOA, 13107, 15, 0, 0.0, 0},
+   {HT_ADV_MULOA, 22938, 15, 0, 0.0, 0}};
+
+static size_t advise(const work_t *w,
+		     size_t num_reps,
+		     int def_viable,
+		     ht_adv_obj_t obj,
+		     ht_adv_cfg_t *cfgs,
+		     size_t num_cfgs);
+static void run_work(const work_t *w,
+		     const heap_ht_t *hht,
+		     const tsp_ht_t *tht);
+static size_t def_bytes(const work_t *w);
+static int def_tsp_fits(const adj_lst_t *a, size_t max_def_bytes);
+static int better(const ht_adv_cfg_t *c,
+		  const ht_adv_cfg_t *d,
+		  ht_adv_obj_t obj);
+static void ball_build(adj_lst_t *b,
+		       const adj_lst_t *a,
+		       size_t start,
+		       size_t n);
+static int bern_all(void *arg);
+
+/* initialization helpers of the hash tables of configurations */
+static void ht_divchn_init_helper(ht_divchn_t *ht,
+				  size_t key_size,
+				  size_t elt_size,
+				  void (*free_elt)(void *),
+				  void *context);
+static void ht_muloa_init_helper(ht_muloa_t *ht,
+				 size_t key_size,
+				 size_t elt_size,
+				 void (*free_elt)(void *),
+				 void *context);
+
+/* hash table operations that count the keys of a hash table parameter */
+static void ht_peak_init(ht_peak_t *ht,
+			 size_t key_size,
+			 size_t elt_size,
+			 void (*free_elt)(void *),
+			 void *context);
+static void ht_peak_insert(ht_peak_t *ht, const void *key, const void *elt);
+static void *ht_peak_search(const ht_peak_t *ht, const void *key);
+static void ht_peak_remove(ht_peak_t *ht, const void *key, void *elt);
+static void ht_peak_free(ht_peak_t *ht);
+static size_t ht_bytes(const ht_adv_ht_t *h);
+static size_t key_bytes(const ht_adv_ht_t *h);
+
+/**
+   Copies the default configurations and returns their number.
+*/
+size_t ht_adv_cfgs_def(ht_adv_cfg_t *cfgs){
+  memcpy(cfgs, C_CFGS_DEF, sizeof(C_CFGS_DEF));
+  return HT_ADV_CFGS_DEF_COUNT;
+}
+
+/**
+   Return the hash table parameter of a configuration, or NULL for a
+   default hash table.
+*/
+
+const heap_ht_t *ht_adv_heap_ht(ht_adv_ht_t *h, const ht_adv_cfg_t *cfg){
+  h->cfg = *cfg;
+  h->hht.context = &h->cfg;
+  if (cfg->kind == HT_ADV_DIVCHN){
+    h->hht.ht = &h->divchn;
+    h->hht.init = (heap_ht_init)ht_divchn_init_helper;
+    h->hht.insert = (heap_ht_insert)ht_divchn_insert;
+    h->hht.search = (heap_ht_search)ht_divchn_search;
+    h->hht.remove = (heap_ht_remove)ht_divchn_remove;
+    h->hht.free = (heap_ht_free)ht_divchn_free;
+  }else if (cfg->kind == HT_ADV_MULOA){
+    h->hht.ht = &h->muloa;
+    h->hht.init = (heap_ht_init)ht_muloa_init_helper;
+    h->hht.insert = (heap_ht_insert)ht_muloa_insert;
+    h->hht.search = (heap_ht_search)ht_muloa_search;
+    h->hht.remove = (heap_ht_remove)ht_muloa_remove;
+    h->hht.free = (heap_ht_free)ht_muloa_free;
+  }else{
+    return NULL;
+  }
+  return &h->hht;
+}
+
+const tsp_ht_t *ht_adv_tsp_ht(ht_adv_ht_t *h, const ht_adv_cfg_t *cfg){
+  if (ht_adv_heap_ht(h, cfg) == NULL) return NULL;
+  h->tht.ht = h->hht.ht;
+  h->tht.context = h->hht.context;
+  h->tht.init = (tsp_ht_init)h->hht.init;
+  h->tht.insert = (tsp_ht_insert)h->hht.insert;
+  h->tht.search = (tsp_ht_search)h->hht.search;
+  h->tht.remove = (tsp_ht_remove)h->hht.remove;
+  h->tht.free = (tsp_ht_free)h->hht.free;
+  return &h->tht;
+}
+
+/**
+   Run the sampled workload of dijkstra, prim, or tsp with each
+   configuration and return the index of the recommended configuration.
+*/
+
+size_t ht_adv_dijkstra(const adj_lst_t *a,
+		       size_t num_starts,
+		       size_t num_reps,
+		       void (*add_wt)(void *, const void *, const void *),
+		       int (*cmp_wt)(const void *, const void *),
+		       ht_adv_obj_t obj,
+		       ht_adv_cfg_t *cfgs,
+		       size_t num_cfgs){
+  size_t ix;
+  work_t w;
+  w.alg = ALG_DIJKSTRA;
+  w.a = a;
+  w.num_starts = (num_starts < a->num_vts) ? num_starts : a->num_vts;
+  w.dist = malloc_perror(a->num_vts, a->wt_size);
+  w.prev = malloc_perror(a->num_vts, sizeof(size_t));
+  w.add_wt = add_wt;
+  w.cmp_wt = cmp_wt;
+  ix = advise(&w, num_reps, 1, obj, cfgs, num_cfgs);
+  free(w.dist);
+  free(w.prev);
+  w.dist = NULL;
+  w.prev = NULL;
+  return ix;
+}
+
+size_t ht_adv_prim(const adj_lst_t *a,
+		   size_t num_starts,
+		   size_t num_reps,
+		   int (*cmp_wt)(const void *, const void *),
+		   ht_adv_obj_t obj,
+		   ht_adv_cfg_t *cfgs,
+		   size_t num_cfgs){
+  size_t ix;
+  work_t w;
+  w.alg = ALG_PRIM;
+  w.a = a;
+  w.num_starts = (num_starts < a->num_vts) ? num_starts : a->num_vts;
+  w.dist = malloc_perror(a->num_vts, a->wt_size);
+  w.prev = malloc_perror(a->num_vts, sizeof(size_t));
+  w.add_wt = NULL;
+  w.cmp_wt = cmp_wt;
+  ix = advise(&w, num_reps, 1, obj, cfgs, num_cfgs);
+  free(w.dist);
+  free(w.prev);
+  w.dist = NULL;
+  w.prev = NULL;
+  return ix;
+}
+
+size_t ht_adv_tsp(const adj_lst_t *a,
+		  size_t num_vts,
+		  size_t num_reps,
+		  size_t max_def_bytes,
+		  void (*add_wt)(void *, const void *, const void *),
+		  int (*cmp_wt)(const void *, const void *),
+		  ht_adv_obj_t obj,
+		  ht_adv_cfg_t *cfgs,
+		  size_t num_cfgs){
+  size_t ix;
+  adj_lst_t b;
+  work_t w;
+  ball_build(&b, a, 0, (num_vts < a->num_vts) ? num_vts : a->num_vts);
+  w.alg = ALG_TSP;
+  w.a = &b;
+  w.num_starts = 1;
+  w.dist = malloc_perror(1, a->wt_size);
+  w.prev = NULL;
+  w.add_wt = add_wt;
+  w.cmp_wt = cmp_wt;
+  ix = advise(&w,
+	      num_reps,
+	      def_tsp_fits(a, max_def_bytes),
+	      obj,
+	      cfgs,
+	      num_cfgs);
+  adj_lst_free(&b);
+  free(w.dist);
+  w.dist = NULL;
+  return ix;
+}
+
+/**
+   Runs a sampled workload with each configuration and returns the index
+   of the recommended configuration.
+*/
+static size_t advise(const work_t *w,
+		     size_t num_reps,
+		     int def_viable,
+		     ht_adv_obj_t obj,
+		     ht_adv_cfg_t *cfgs,
+		     size_t num_cfgs){
+  size_t i, j, ix = num_cfgs;
+  ht_adv_ht_t h;
+  ht_peak_t peak;
+  heap_ht_t hht_peak;
+  tsp_ht_t tht_peak;
+  bench_t b;
+  bench_summary_t s;
+  hht_peak.ht = &peak;
+  hht_peak.context = NULL;
+  hht_peak.init = (heap_ht_init)ht_peak_init;
+  hht_peak.insert = (heap_ht_insert)ht_peak_insert;
+  hht_peak.search = (heap_ht_search)ht_peak_search;
+  hht_peak.remove = (heap_ht_remove)ht_peak_remove;
+  hht_peak.free = (heap_ht_free)ht_peak_free;
+  tht_peak.ht = &peak;
+  tht_peak.context = NULL;
+  tht_peak.init = (tsp_ht_init)ht_peak_init;
+  tht_peak.insert = (tsp_ht_insert)ht_peak_insert;
+  tht_peak.search = (tsp_ht_search)ht_peak_search;
+  tht_peak.remove = (tsp_ht_remove)ht_peak_remove;
+  tht_peak.free = (tsp_ht_free)ht_peak_free;
+  for (i = 0; i < num_cfgs; i++){
+    cfgs[i].viable = (cfgs[i].kind != HT_ADV_DEF || def_viable);
+    cfgs[i].secs = 0.0;
+    cfgs[i].peak_bytes = 0;
+    if (!cfgs[i].viable) continue;
+    ht_adv_heap_ht(&h, &cfgs[i]);
+    ht_adv_tsp_ht(&h, &cfgs[i]);
+    bench_init(&b, C_SUITE, C_ALG_NAMES[w->alg], 1, num_reps);
+    for (j = 0; j < b.num_warmups + b.num_reps; j++){
+      bench_start(&b);
+      if (cfgs[i].kind == HT_ADV_DEF){
+	run_work(w, NULL, NULL);
+      }else if (j == 0){
+	peak.h = &h;
+	peak.peak_bytes = 0;
+	run_work(w, &hht_peak, &tht_peak);
+      }else{
+	run_work(w, &h.hht, &h.tht);
+      }
+      bench_stop(&b);
+    }
+    bench_summarize(&b, &s, NULL, NULL);
+    bench_free(&b);
+    cfgs[i].secs = s.med;
+    cfgs[i].peak_bytes = ((cfgs[i].kind == HT_ADV_DEF) ?
+			  def_bytes(w) :
+			  peak.peak_bytes);
+    if (ix == num_cfgs || better(&cfgs[i], &cfgs[ix], obj)) ix = i;
+  }
+  return ix;
+}
+
+/**
+   Runs a sampled workload with a hash table parameter. In dijkstra and
+   prim, the start vertices are evenly spaced across the vertices.
+*/
+static void run_work(const work_t *w,
+		     const heap_ht_t *hht,
+		     const tsp_ht_t *tht){
+  size_t i, start;
+  size_t step = w->a->num_vts / w->num_starts;
+  for (i = 0; i < w->num_starts; i++){
+    start = i * step;
+    if (w->alg == ALG_DIJKSTRA){
+      dijkstra(w->a, start, w->dist, w->prev, hht,
+	       w->add_wt, w->cmp_wt, NULL);
+    }else if (w->alg == ALG_PRIM){
+      prim(w->a, start, w->dist, w->prev, hht, w->cmp_wt, NULL);
+    }else{
+      tsp(w->a, start, w->dist, tht, w->add_wt, w->cmp_wt, NULL);
+    }
+  }
+}
+
+/**
+   Returns the bytes of the arrays of a default hash table.
+*/
+static size_t def_bytes(const work_t *w){
+  size_t count = w->a->num_vts;
+  size_t elt_size = sizeof(size_t); /* index of a heap */
+  if (w->alg == ALG_TSP){
+    count = mul_sz_perror(count, pow_two_perror(w->a->num_vts));
+    elt_size = w->a->wt_size;
+    return (mul_sz_perror(count, sizeof(boolean_t)) +
+	    mul_sz_perror(count, elt_size));
+  }
+  return (count * sizeof(boolean_t) +
+	  mem_block_overhead(count * sizeof(boolean_t)) +
+	  count * elt_size +
+	  mem_block_overhead(count * elt_size));
+}
+
+/**
+   Returns 1 if the arrays of the default hash table of TSP on a graph,
+   i.e. n * 2^n key presence flags and weights for n vertices, fit in
+   max_def_bytes bytes, and 0 otherwise. The comparison is performed by
+   division to avoid overflow.
+*/
+static int def_tsp_fits(const adj_lst_t *a, size_t max_def_bytes){
+  size_t n = a->num_vts;
+  size_t q = max_def_bytes / (sizeof(boolean_t) + a->wt_size) / n;
+  if (n >= C_FULL_BIT) return 0;
+  return (q >> n) > 0; /* 2^n <= q */
+}
+
+/**
+   Returns 1 if the configuration pointed to by c is better than the
+   configuration pointed to by d under an objective, and 0 otherwise.
+*/
+static int better(const ht_adv_cfg_t *c,
+		  const ht_adv_cfg_t *d,
+		  ht_adv_obj_t obj){
+  if (obj == HT_ADV_MEM && c->peak_bytes != d->peak_bytes){
+    return c->peak_bytes < d->peak_bytes;
+  }
+  return c->secs < d->secs;
+}
+
+/**
+   Builds the adjacency list of the subgraph induced by the first n
+   vertices reached by a breadth-first search from a start vertex of an
+   adjacency list, or by all reached vertices if fewer than n vertices are
+   reached. The ith reached vertex is the vertex i of the subgraph, and the
+   start vertex is the vertex 0.
+*/
+static void ball_build(adj_lst_t *b,
+		       const adj_lst_t *a,
+		       size_t start,
+		       size_t n){
+  const char *p = NULL, *p_start = NULL, *p_end = NULL;
+  size_t i, u, v, num_vts = 1;
+  size_t *vts = malloc_perror(n, sizeof(size_t)); /* reached vertices */
+  size_t *ixs = malloc_perror(a->num_vts, sizeof(size_t)); /* n if not */
+  graph_t g;
+  for (u = 0; u < a->num_vts; u++){
+    ixs[u] = n;
+  }
+  vts[0] = start;
+  ixs[start] = 0;
+  for (i = 0; i < num_vts && num_vts < n; i++){
+    p_start = a->vt_wts[vts[i]]->elts;
+    p_end = p_start + a->vt_wts[vts[i]]->num_elts * a->pair_size;
+    for (p = p_start; p != p_end && num_vts < n; p += a->pair_size){
+      v = *(const size_t *)p;
+      if (ixs[v] == n){
+	ixs[v] = num_vts;
+	vts[num_vts] = v;
+	num_vts++;
+      }
+    }
+  }
+  graph_base_init(&g, num_vts, a->wt_size);
+  adj_lst_init(b, &g);
+  for (i = 0; i < num_vts; i++){
+    p_start = a->vt_wts[vts[i]]->elts;
+    p_end = p_start + a->vt_wts[vts[i]]->num_elts * a->pair_size;
+    for (p = p_start; p != p_end; p += a->pair_size){
+      v = *(const size_t *)p;
+      if (ixs[v] < num_vts){
+	adj_lst_add_dir_edge(b, i, ixs[v], p + a->offset, bern_all, NULL);
+      }
+    }
+  }
+  graph_free(&g);
+  free(vts);
+  free(ixs);
+  vts = NULL;
+  ixs = NULL;
+}
+
+static int bern_all(void *arg){
+  (void)arg;
+  return 1;
+}
+
+/**
+   Initialization helpers with the load factor upper bound of a
+   configuration and the default key reduction.
+*/
+
+static void ht_divchn_init_helper(ht_divchn_t *ht,
+				  size_t key_size,
+				  size_t elt_size,
+				  void (*free_elt)(void *),
+				  void *context){
+  const ht_adv_cfg_t *c = context;
+  ht_divchn_init(ht,
+		 key_size,
+		 elt_size,
+		 0,
+		 c->alpha_n,
+		 c->log_alpha_d,
+		 free_elt);
+}
+
+static void ht_muloa_init_helper(ht_muloa_t *ht,
+				 size_t key_size,
+				 size_t elt_size,
+				 void (*free_elt)(void *),
+				 void *context){
+  const ht_adv_cfg_t *c = context;
+  ht_muloa_init(ht,
+		key_size,
+		elt_size,
+		0,
+		c->alpha_n,
+		c->log_alpha_d,
+		NULL,
+		free_elt);
+}
+
+/**
+   Hash table operations that count the keys of the hash table of a
+   configuration and forward the calls. The peak bytes of the hash table
+   are updated when it is freed.
+*/
+
+static void ht_peak_init(ht_peak_t *ht,
+			 size_t key_size,
+			 size_t elt_size,
+			 void (*free_elt)(void *),
+			 void *context){
+  heap_ht_t *hht = &ht->h->hht;
+  hht->init(hht->ht, key_size, elt_size, free_elt, hht->context);
+  ht->num_keys = 0;
+  ht->peak_keys = 0;
+  (void)context;
+}
+
+static void ht_peak_insert(ht_peak_t *ht, const void *key, const void *elt){
+  heap_ht_t *hht = &ht->h->hht;
+  if (hht->search(hht->ht, key) == NULL){
+    ht->num_keys++;
+    if (ht->num_keys > ht->peak_keys) ht->peak_keys = ht->num_keys;
+  }
+  hht->insert(hht->ht, key, elt);
+}
+
+static void *ht_peak_search(const ht_peak_t *ht, const void *key){
+  const heap_ht_t *hht = &ht->h->hht;
+  return hht->search(hht->ht, key);
+}
+
+static void ht_peak_remove(ht_peak_t *ht, const void *key, void *elt){
+  heap_ht_t *hht = &ht->h->hht;
+  if (hht->search(hht->ht, key) != NULL) ht->num_keys--;
+  hht->remove(hht->ht, key, elt);
+}
+
+static void ht_peak_free(ht_peak_t *ht){
+  heap_ht_t *hht = &ht->h->hht;
+  size_t bytes = (ht_bytes(ht->h) +
+		  (ht->peak_keys - ht->num_keys) * key_bytes(ht->h));
+  if (bytes > ht->peak_bytes) ht->peak_bytes = bytes;
+  (hht->free)(hht->ht);
+}
+
+/**
+   Returns the bytes of the hash table of a configuration, or the bytes of
+   a key in the hash table.
+*/
+
+static size_t ht_bytes(const ht_adv_ht_t *h){
+  mem_footprint_t f;
+  if (h->cfg.kind == HT_ADV_DIVCHN){
+    ht_divchn_footprint(&h->divchn, &f);
+  }else{
+    ht_muloa_footprint(&h->muloa, &f);
+  }
+  return f.payload + f.overhead + f.slack;
+}
+
+static size_t key_bytes(const ht_adv_ht_t *h){
+  size_t size;
+  if (h->cfg.kind == HT_ADV_DIVCHN){
+    size = sizeof(dll_node_t) + h->divchn.pair_size;
+  }else{
+    size = sizeof(key_elt_t) + h->muloa.pair_size;
+  }
+  return size + mem_block_overhead(size);
+}
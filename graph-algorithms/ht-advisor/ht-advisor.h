@@ -0,0 +1,151 @@
+/**
+   ht-advisor.h
+
+   Declarations of accessible functions for choosing the hash table
+   parameter of Dijkstra's algorithm, Prim's algorithm, and TSP on a given
+   graph by running a sampled workload.
+
+   A configuration is a default hash table of an algorithm, or a division
+   or multiplication-based hash table with a load factor upper bound. An
+   advisor function runs the sampled workload of an algorithm with each
+   configuration, records the median wall-clock time of the workload and
+   the bytes of the hash table at its peak number of keys, and returns the
+   index of the configuration that is recommended under an objective:
+   - HT_ADV_TIME : the lowest median time,
+   - HT_ADV_MEM : the lowest peak bytes, with ties resolved by time.
+
+   The sampled workload of Dijkstra's and Prim's algorithms consists of
+   the runs from a number of start vertices that are evenly spaced across
+   the vertices of the graph. Because the number of sets in TSP grows
+   exponentially with the number of vertices, the sampled workload of TSP
+   is a run on the subgraph induced by the first vertices reached by a
+   breadth-first search from vertex 0, and a default hash table is viable
+   only if its arrays of n * 2^n key presence flags and weights for the n
+   vertices of the graph fit in a memory budget passed by the caller.
+
+   The peak bytes of a division or multiplication-based hash table are
+   computed with its footprint function when the hash table is freed, and
+   the bytes of the keys that were removed after the peak are added. The
+   peak bytes of a default hash table are the bytes of its arrays.
+
+   A recommended configuration is passed to an algorithm as the hash table
+   parameter returned by ht_adv_heap_ht or ht_adv_tsp_ht, which is NULL for
+   a default hash table.
+
+   The implementation does not use stdint.h and is portable under C89/C90
+   and C99.
+*/
+
+#ifndef HT_ADVISOR_H
+#define HT_ADVISOR_H
+
+#include <stddef.h>
+#include "graph.h"
+#include "heap.h"
+#include "tsp.h"
+#include "ht-divchn.h"
+#include "ht-muloa.h"
+
+#define HT_ADV_CFGS_DEF_COUNT 7
+
+typedef enum{
+  HT_ADV_DEF, /* default hash table of an algorithm */
+  HT_ADV_DIVCHN,
+  HT_ADV_MULOA
+} ht_adv_kind_t;
+
+typedef enum{
+  HT_ADV_TIME,
+  HT_ADV_MEM
+} ht_adv_obj_t;
+
+typedef struct{
+  ht_adv_kind_t kind;
+  size_t alpha_n; /* alpha_n / 2**log_alpha_d is the load factor bound */
+  size_t log_alpha_d;
+  int viable; /* 0 if the configuration was not run */
+  double secs; /* median wall-clock time of the sampled workload */
+  size_t peak_bytes; /* bytes of the hash table at its peak # keys */
+} ht_adv_cfg_t;
+
+typedef struct{
+  ht_adv_cfg_t cfg; /* initialization context */
+  ht_divchn_t divchn;
+  ht_muloa_t muloa;
+  heap_ht_t hht;
+  tsp_ht_t tht;
+} ht_adv_ht_t;
+
+/**
+   Copies the HT_ADV_CFGS_DEF_COUNT default configurations, i.e. a default
+   hash table, ht-divchn with load factor upper bounds 0.5, 1.0, and 2.0,
+   and ht-muloa with load factor upper bounds 0.2, 0.4, and 0.7, to the
+   array pointed to by cfgs, and returns HT_ADV_CFGS_DEF_COUNT.
+   cfgs        : pointer to a preallocated array with a count of at least
+                 HT_ADV_CFGS_DEF_COUNT
+*/
+size_t ht_adv_cfgs_def(ht_adv_cfg_t *cfgs);
+
+/**
+   Returns the hash table parameter of a configuration for dijkstra and
+   prim, or for tsp. Returns NULL for a default hash table.
+   h           : pointer to a preallocated block of size
+                 sizeof(ht_adv_ht_t) that remains valid while the returned
+                 hash table parameter is used
+   cfg         : pointer to a configuration
+*/
+const heap_ht_t *ht_adv_heap_ht(ht_adv_ht_t *h, const ht_adv_cfg_t *cfg);
+const tsp_ht_t *ht_adv_tsp_ht(ht_adv_ht_t *h, const ht_adv_cfg_t *cfg);
+
+/**
+   Run the sampled workload of dijkstra, prim, or tsp with each
+   configuration, set the viable, secs, and peak_bytes fields of each
+   configuration, and return the index of the recommended configuration.
+   The workload of a configuration is run 1 + num_reps times; the first
+   run measures the peak bytes and is not timed.
+   a           : pointer to an adjacency list with at least one vertex
+   num_starts  : > 0 number of start vertices in the sampled workload
+                 of dijkstra and prim
+   num_vts     : > 0 number of vertices of the induced subgraph in the
+                 sampled workload of tsp; the number of vertices of a is
+                 used if num_vts is greater
+   num_reps    : > 0 number of timed runs of a sampled workload
+   max_def_bytes : memory budget in bytes of the default hash table of tsp
+                 on the graph; the default hash table is not viable if its
+                 arrays do not fit
+   add_wt      : addition function of weights as in dijkstra and tsp
+   cmp_wt      : comparison function of weights as in dijkstra, prim, and
+                 tsp
+   obj         : HT_ADV_TIME or HT_ADV_MEM
+   cfgs        : pointer to an array of configurations with at least one
+                 division or multiplication-based hash table
+   num_cfgs    : > 0 number of configurations
+*/
+size_t ht_adv_dijkstra(const adj_lst_t *a,
+		       size_t num_starts,
+		       size_t num_reps,
+		       void (*add_wt)(void *, const void *, const void *),
+		       int (*cmp_wt)(const void *, const void *),
+		       ht_adv_obj_t obj,
+		       ht_adv_cfg_t *cfgs,
+		       size_t num_cfgs);
+
+size_t ht_adv_prim(const adj_lst_t *a,
+		   size_t num_starts,
+		   size_t num_reps,
+		   int (*cmp_wt)(const void *, const void *),
+		   ht_adv_obj_t obj,
+		   ht_adv_cfg_t *cfgs,
+		   size_t num_cfgs);
+
+size_t ht_adv_tsp(const adj_lst_t *a,
+		  size_t num_vts,
+		  size_t num_reps,
+		  size_t max_def_bytes,
+		  void (*add_wt)(void *, const void *, const void *),
+		  int (*cmp_wt)(const void *, const void *),
+		  ht_adv_obj_t obj,
+		  ht_adv_cfg_t *cfgs,
+		  size_t num_cfgs);
+
+#endif
@@ -0,0 +1,256 @@
+/**
+   kcore-test.c
+
+   Tests of the k-core decomposition by bucket peeling.
+
+   The following command line arguments can be used to customize tests:
+   kcore-test
+     [0, # bits in size_t / 2] : a
+     [0, # bits in size_t / 2] : b s.t. 2^a <= V <= 2^b for complete graph,
+                                 no edges, and random graph tests
+     [0, # bits in size_t / 2] : c s.t. V = 2^c for the performance test
+     [0, 1] : on/off for complete graph and no edges tests
+     [0, 1] : on/off for random graph test
+     [0, 1] : on/off for performance test
+
+   usage examples:
+   ./kcore-test
+   ./kcore-test 5 10
+   ./kcore-test 5 10 14 0 0 1
+
+   kcore-test can be run with any subset of command line arguments in the
+   above-defined order. If the (i + 1)th argument is specified then the ith
+   argument must be specified for i >= 0. Default values are used for the
+   unspecified arguments according to the C_ARGS_DEF array.
+
+   The implementation does not use stdint.h and is portable under C89/C90.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include "kcore.h"
+#include "graph.h"
+#include "stack.h"
+#include "utilities-mem.h"
+
+/**
+   Generate random numbers in a portable way for test purposes only; rand()
+   in the Linux C Library uses the same generator as random(), which may not
+   be the case on older rand() implementations, and on current
+   implementations on different systems.
+*/
+#ifdef TEST_SEED
+#define RGENS_SEED() do{srand(TEST_SEED);}while (0)
+#else
+#define RGENS_SEED() do{srand(time(NULL));}while (0)
+#endif
+#define RANDOM() (rand()) /* [0, RAND_MAX] */
+#define DRAND() ((double)rand() / RAND_MAX) /* [0.0, 1.0] */
+
+#define TOLU(i) ((unsigned long int)(i)) /* printing size_t under C89/C90 */
+
+/* input handling */
+const char *C_USAGE =
+  "kcore-test \n"
+  "[0, # bits in size_t / 2] : a \n"
+  "[0, # bits in size_t / 2] : b s.t. 2^a <= V <= 2^b for complete graph, \n"
+  "                            no edges, and random graph tests \n"
+  "[0, # bits in size_t / 2] : c s.t. V = 2^c for the performance test \n"
+  "[0, 1] : on/off for complete graph and no edges tests \n"
+  "[0, 1] : on/off for random graph test \n"
+  "[0, 1] : on/off for performance test \n";
+const int C_ARGC_MAX = 7;
+const size_t C_ARGS_DEF[6] = {0, 9, 13, 1, 1, 1};
+const size_t C_FULL_BIT = CHAR_BIT * sizeof(size_t);
+
+/* tests */
+const size_t C_NR = (size_t)-1;
+const double C_PROB_ONE = 1.0;
+const double C_PROB_ZERO = 0.0;
+const double C_PROBS[4] = {0.005, 0.05, 0.2, 0.6};
+const size_t C_PROBS_COUNT = 4;
+const double C_PERF_DEG = 16.0; /* expected degree in the performance test */
+
+typedef struct{
+  double p;
+} bern_arg_t;
+
+int bern(void *arg);
+size_t naive_kcore(const adj_lst_t *a, size_t *core);
+void print_test_result(int res);
+
+int bern(void *arg){
+  bern_arg_t *b = arg;
+  if (b->p >= C_PROB_ONE) return 1;
+  if (b->p <= C_PROB_ZERO) return 0;
+  if (b->p > DRAND()) return 1;
+  return 0;
+}
+
+/**
+   Computes the core numbers by repeatedly removing a vertex of minimum
+   degree in O(V^2 + E) time, and returns the maximum core number.
+*/
+size_t naive_kcore(const adj_lst_t *a, size_t *core){
+  const char *p = NULL, *p_start = NULL, *p_end = NULL;
+  size_t i, u, v, k = 0, n = a->num_vts;
+  size_t *deg = NULL;
+  deg = malloc_perror(n + 1, sizeof(size_t));
+  for (v = 0; v < n; v++){
+    deg[v] = a->vt_wts[v]->num_elts;
+    core[v] = C_NR;
+  }
+  for (i = 0; i < n; i++){
+    for (u = n, v = 0; v < n; v++){
+      if (core[v] == C_NR && (u == n || deg[v] < deg[u])) u = v;
+    }
+    if (deg[u] > k) k = deg[u];
+    core[u] = k;
+    p_start = a->vt_wts[u]->elts;
+    p_end = p_start + a->vt_wts[u]->num_elts * a->pair_size;
+    for (p = p_start; p != p_end; p += a->pair_size){
+      v = *(const size_t *)p;
+      if (core[v] == C_NR) deg[v]--;
+    }
+  }
+  free(deg);
+  deg = NULL;
+  return k;
+}
+
+/**
+   Tests kcore on complete graphs, where each core number is V - 1, and on
+   graphs with no edges, where each core number is 0.
+*/
+void run_complete_no_edges_test(size_t log_start, size_t log_end){
+  int res = 1;
+  size_t i, l, n;
+  size_t *core = NULL;
+  bern_arg_t b;
+  adj_lst_t a;
+  core = malloc_perror((size_t)1 << log_end, sizeof(size_t));
+  printf("Run kcore test on complete graphs and graphs with no edges\n");
+  for (l = log_start; l <= log_end; l++){
+    n = (size_t)1 << l;
+    b.p = C_PROB_ONE;
+    adj_lst_rand_undir(&a, n, bern, &b);
+    res *= (kcore(&a, core, NULL) == n - 1);
+    for (i = 0; i < n; i++){
+      res *= (core[i] == n - 1);
+    }
+    adj_lst_free(&a);
+    b.p = C_PROB_ZERO;
+    adj_lst_rand_undir(&a, n, bern, &b);
+    res *= (kcore(&a, core, NULL) == 0);
+    for (i = 0; i < n; i++){
+      res *= (core[i] == 0);
+    }
+    adj_lst_free(&a);
+  }
+  printf("\t2^%lu <= V <= 2^%lu --> ", TOLU(log_start), TOLU(log_end));
+  print_test_result(res);
+  free(core);
+  core = NULL;
+}
+
+/**
+   Tests kcore on random graphs against the naive peeling.
+*/
+void run_random_graph_test(size_t log_start, size_t log_end){
+  int res = 1;
+  size_t i, l, n;
+  size_t *core = NULL, *core_wo = NULL;
+  bern_arg_t b;
+  adj_lst_t a;
+  core = malloc_perror((size_t)1 << log_end, sizeof(size_t));
+  core_wo = malloc_perror((size_t)1 << log_end, sizeof(size_t));
+  printf("Run kcore test on random graphs against naive peeling\n");
+  for (l = log_start; l <= log_end; l++){
+    n = (size_t)1 << l;
+    for (i = 0; i < C_PROBS_COUNT; i++){
+      b.p = C_PROBS[i];
+      adj_lst_rand_undir(&a, n, bern, &b);
+      res *= (kcore(&a, core, NULL) == naive_kcore(&a, core_wo));
+      res *= (memcmp(core, core_wo, n * sizeof(size_t)) == 0);
+      adj_lst_free(&a);
+    }
+  }
+  printf("\t2^%lu <= V <= 2^%lu --> ", TOLU(log_start), TOLU(log_end));
+  print_test_result(res);
+  free(core);
+  free(core_wo);
+  core = NULL;
+  core_wo = NULL;
+}
+
+/**
+   Runs kcore on a random graph with an expected degree of C_PERF_DEG and
+   prints the degeneracy, counts, and times.
+*/
+void run_perf_test(size_t log_n){
+  size_t n = (size_t)1 << log_n;
+  size_t max_core;
+  size_t *core = NULL;
+  bern_arg_t b;
+  adj_lst_t a;
+  kcore_stats_t st;
+  core = malloc_perror(n, sizeof(size_t));
+  b.p = (n > 1) ? C_PERF_DEG / (n - 1) : C_PROB_ONE;
+  adj_lst_rand_undir(&a, n, bern, &b);
+  max_core = kcore(&a, core, &st);
+  printf("Run kcore performance test on a random graph\n");
+  printf("\tvertices: %lu, edges: %lu, degeneracy: %lu\n"
+	 "\tscanned edges: %lu, moves: %lu\n"
+	 "\tinit: %.4f, peel: %.4f, free: %.4f seconds\n",
+	 TOLU(a.num_vts), TOLU(a.num_es / 2), TOLU(max_core),
+	 TOLU(st.num_edges), TOLU(st.num_moves),
+	 st.init_secs, st.peel_secs, st.free_secs);
+  adj_lst_free(&a);
+  free(core);
+  core = NULL;
+}
+
+/**
+   Prints a test result.
+*/
+void print_test_result(int res){
+  if (res){
+    printf("SUCCESS\n");
+  }else{
+    printf("FAILURE\n");
+  }
+}
+
+int main(int argc, char *argv[]){
+  int i;
+  size_t *args = NULL;
+  RGENS_SEED();
+  if (argc > C_ARGC_MAX){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  args = malloc_perror(C_ARGC_MAX - 1, sizeof(size_t));
+  memcpy(args, C_ARGS_DEF, (C_ARGC_MAX - 1) * sizeof(size_t));
+  for (i = 1; i < argc; i++){
+    args[i - 1] = atoi(argv[i]);
+  }
+  if (args[0] > C_FULL_BIT / 2 ||
+      args[1] > C_FULL_BIT / 2 ||
+      args[2] > C_FULL_BIT / 2 ||
+      args[0] > args[1] ||
+      args[3] > 1 ||
+      args[4] > 1 ||
+      args[5] > 1){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  if (args[3]) run_complete_no_edges_test(args[0], args[1]);
+  if (args[4]) run_random_graph_test(args[0], args[1]);
+  if (args[5]) run_perf_test(args[2]);
+  free(args);
+  args = NULL;
+  return 0;
+}
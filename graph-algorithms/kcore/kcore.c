@@ -0,0 +1,119 @@
+/**
+   kcore.c
+
+   Functions for computing the k-core decomposition of undirected graphs
+   with vertices indexed from 0.
+
+   The vertices are bucket sorted by degree into the vert array, where
+   bin[d] is the position of the first vertex with degree d and pos[v] is
+   the position of v. The vertices are peeled in the order of vert. When
+   a vertex v is peeled, the current degree of each neighbor u with a
+   higher current degree is decremented, and u is swapped with the first
+   vertex of its bucket, which moves u to the next lower bucket in O(1)
+   time. The current degree of a peeled vertex is its core number, and
+   the current degrees are kept in the core array.
+
+   If a pointer to a kcore_stats_t block is passed, the algorithm counts
+   its operations and measures the wall-clock time of its phases.
+*/
+
+#define UTILITIES_MEM_TAG MEM_TAG_GRAPH
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "kcore.h"
+#include "graph.h"
+#include "stack.h"
+#include "utilities-mem.h"
+#include "utilities-time.h"
+
+/**
+   Computes and copies to an array pointed to by core the core number of
+   each vertex, and returns the maximum core number, i.e. the degeneracy
+   of the graph, or 0 if there are no vertices.
+   a           : pointer to an adjacency list of an undirected graph
+   core        : pointer to a preallocated array with the count equal to
+                 the number of vertices in the adjacency list
+   stats       : - NULL pointer, if operations are not counted
+                 - a pointer to a block of size sizeof(kcore_stats_t), where
+                 the counts and phase times of the run are copied
+*/
+size_t kcore(const adj_lst_t *a, size_t *core, kcore_stats_t *stats){
+  const char *p = NULL, *p_start = NULL, *p_end = NULL;
+  size_t i, d, u, v, w, num;
+  size_t du, pu, pw;
+  size_t n = a->num_vts;
+  size_t max_deg = 0, max_core = 0;
+  size_t *bin = NULL, *pos = NULL, *vert = NULL;
+  double t = 0.0;
+  if (stats != NULL){
+    memset(stats, 0, sizeof(kcore_stats_t));
+    t = time_wall();
+  }
+  for (v = 0; v < n; v++){
+    core[v] = a->vt_wts[v]->num_elts;
+    if (core[v] > max_deg) max_deg = core[v];
+  }
+  bin = calloc_perror(max_deg + 1, sizeof(size_t));
+  pos = malloc_perror(n + 1, sizeof(size_t));
+  vert = malloc_perror(n + 1, sizeof(size_t));
+  for (v = 0; v < n; v++){
+    bin[core[v]]++;
+  }
+  for (d = 0, i = 0; d <= max_deg; d++){
+    num = bin[d];
+    bin[d] = i;
+    i += num;
+  }
+  for (v = 0; v < n; v++){
+    pos[v] = bin[core[v]];
+    vert[pos[v]] = v;
+    bin[core[v]]++;
+  }
+  for (d = max_deg; d > 0; d--){
+    bin[d] = bin[d - 1];
+  }
+  bin[0] = 0;
+  if (stats != NULL){
+    stats->init_secs = time_wall() - t;
+    t = time_wall();
+  }
+  for (i = 0; i < n; i++){
+    v = vert[i];
+    if (core[v] > max_core) max_core = core[v];
+    p_start = a->vt_wts[v]->elts;
+    p_end = p_start + a->vt_wts[v]->num_elts * a->pair_size;
+    if (stats != NULL) stats->num_edges += a->vt_wts[v]->num_elts;
+    for (p = p_start; p != p_end; p += a->pair_size){
+      u = *(const size_t *)p;
+      if (core[u] > core[v]){
+	du = core[u];
+	pu = pos[u];
+	pw = bin[du];
+	w = vert[pw];
+	if (u != w){
+	  pos[u] = pw;
+	  vert[pu] = w;
+	  pos[w] = pu;
+	  vert[pw] = u;
+	}
+	bin[du]++;
+	core[u]--;
+	if (stats != NULL) stats->num_moves++;
+      }
+    }
+  }
+  if (stats != NULL){
+    stats->peel_secs = time_wall() - t;
+    t = time_wall();
+  }
+  free(bin);
+  free(pos);
+  free(vert);
+  bin = NULL;
+  pos = NULL;
+  vert = NULL;
+  if (stats != NULL) stats->free_secs = time_wall() - t;
+  return max_core;
+}
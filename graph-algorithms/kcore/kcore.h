@@ -0,0 +1,49 @@
+/**
+   kcore.h
+
+   Declarations of accessible functions for computing the k-core
+   decomposition of undirected graphs with vertices indexed from 0.
+
+   The core number of a vertex is the largest k such that the vertex is in
+   a subgraph in which each vertex has at least k neighbors. The core
+   numbers are computed in O(V + E) time by the bucket peeling algorithm
+   of Batagelj and Zaversnik (An O(m) Algorithm for Cores Decomposition of
+   Networks, 2003), with the core array and three arrays of at most V + 1
+   entries.
+
+   The adjacency list is expected to represent an undirected graph without
+   loops and multiple edges, e.g. built with adj_lst_undir_build or
+   adj_lst_rand_undir. The weights, if any, are not used.
+
+   If a pointer to a kcore_stats_t block is passed, the algorithm counts its
+   operations and measures the wall-clock time of its phases.
+*/
+
+#ifndef KCORE_H
+#define KCORE_H
+
+#include <stddef.h>
+#include "graph.h"
+
+typedef struct{
+  size_t num_edges; /* # scanned edges */
+  size_t num_moves; /* # decrements of core numbers of unpeeled vertices */
+  double init_secs; /* wall-clock time of bucket sorting by degree */
+  double peel_secs; /* wall-clock time of the main loop */
+  double free_secs; /* wall-clock time of freeing the buckets */
+} kcore_stats_t;
+
+/**
+   Computes and copies to an array pointed to by core the core number of
+   each vertex, and returns the maximum core number, i.e. the degeneracy
+   of the graph, or 0 if there are no vertices.
+   a           : pointer to an adjacency list of an undirected graph
+   core        : pointer to a preallocated array with the count equal to
+                 the number of vertices in the adjacency list
+   stats       : - NULL pointer, if operations are not counted
+                 - a pointer to a block of size sizeof(kcore_stats_t), where
+                 the counts and phase times of the run are copied
+*/
+size_t kcore(const adj_lst_t *a, size_t *core, kcore_stats_t *stats);
+
+#endif
@@ -11,11 +11,13 @@
    -  [0, # bits in size_t / 2] : n for 2^n vertices in the largest graph
    -  [0, 1] : small graph test on/off
    -  [0, 1] : test on random graphs with random size_t weights on/off
+   -  [0, 1] : operation counter test on/off
 
    usage examples: 
    ./prim-test
    ./prim-test 10 14
    ./prim-test 14 14 0 1
+   ./prim-test 10 14 0 0 1
 
    prim-test can be run with any subset of command line arguments in the
    above-defined order. If the (i + 1)th argument is specified then the ith
@@ -23,6 +25,11 @@
    unspecified arguments, which are 0 for the first argument, 10 for the
    second argument, and 1 for the following arguments.
 
+   The runtimes of the random graph test are measured with utilities-bench
+   and can be written as csv or json records by setting BENCH_FORMAT and
+   BENCH_OUT, e.g.
+   BENCH_FORMAT=json BENCH_OUT=prim.json ./prim-test 10 14 0 1
+
    The implementation of tests does not use stdint.h and is portable under
    C89/C90 and C99 with the only requirement that CHAR_BIT * sizeof(size_t)
    is greater or equal to 16 and is even.
@@ -39,6 +46,7 @@
 #include "ht-muloa.h"
 #include "graph.h"
 #include "stack.h"
+#include "utilities-bench.h"
 #include "utilities-mem.h"
 #include "utilities-mod.h"
 
@@ -48,7 +56,11 @@
    be the case on older rand() implementations, and on current
    implementations on different systems.
 */
+#ifdef TEST_SEED
+#define RGENS_SEED() do{srand(TEST_SEED);}while (0)
+#else
 #define RGENS_SEED() do{srand(time(NULL));}while (0)
+#endif
 #define RANDOM() (rand()) /* [0, RAND_MAX] */
 #define DRAND() ((double)rand() / RAND_MAX) /* [0.0, 1.0] */
 
@@ -60,9 +72,10 @@ const char *C_USAGE =
   "[0, # bits in size_t / 2] : n for 2^n vertices in smallest graph \n"
   "[0, # bits in size_t / 2] : n for 2^n vertices in largest graph \n"
   "[0, 1] : small graph test on/off \n"
-  "[0, 1] : random graphs with random size_t weights test on/off \n";
-const int C_ARGC_MAX = 5;
-const size_t C_ARGS_DEF[4] = {0, 10, 1, 1};
+  "[0, 1] : random graphs with random size_t weights test on/off \n"
+  "[0, 1] : operation counter test on/off \n";
+const int C_ARGC_MAX = 6;
+const size_t C_ARGS_DEF[5] = {0, 10, 1, 1, 1};
 
 /* hash table load factor upper bounds */
 const size_t C_ALPHA_N_DIVCHN = 1;
@@ -78,8 +91,10 @@ const size_t C_V[4] = {1, 2, 3, 3};
 const size_t C_WTS_UINT[4] = {4, 3, 2, 1};
 const double C_WTS_DOUBLE[4] = {4.0, 3.0, 2.0, 1.0};
 
-/* random uint graph test */
+/* random uint graph and operation counter tests */
+const char *C_SUITE = "prim-test";
 const int C_ITER = 10;
+const size_t C_NUM_WARMUPS = 1;
 const int C_PROBS_COUNT = 7;
 const double C_PROBS[7] = {1.000000, 0.250000, 0.062500,
 			   0.015625, 0.003906, 0.000977,
@@ -180,7 +195,7 @@ void run_def_uint_prim(const adj_lst_t *a){
   dist = malloc_perror(a->num_vts, sizeof(size_t));
   prev = malloc_perror(a->num_vts, sizeof(size_t));
   for (i = 0; i < a->num_vts; i++){
-    prim(a, i, dist, prev, NULL, cmp_uint);
+    prim(a, i, dist, prev, NULL, cmp_uint, NULL);
     printf("distances and previous vertices with %lu as start \n", TOLU(i));
     print_uint_arr(dist, a->num_vts);
     print_uint_arr(prev, a->num_vts);
@@ -211,7 +226,7 @@ void run_divchn_uint_prim(const adj_lst_t *a){
   hht.remove = (heap_ht_remove)ht_divchn_remove;
   hht.free = (heap_ht_free)ht_divchn_free;
   for (i = 0; i < a->num_vts; i++){
-    prim(a, i, dist, prev, &hht, cmp_uint);
+    prim(a, i, dist, prev, &hht, cmp_uint, NULL);
     printf("distances and previous vertices with %lu as start \n", TOLU(i));
     print_uint_arr(dist, a->num_vts);
     print_uint_arr(prev, a->num_vts);
@@ -242,7 +257,7 @@ void run_muloa_uint_prim(const adj_lst_t *a){
   hht.remove = (heap_ht_remove)ht_muloa_remove;
   hht.free = (heap_ht_free)ht_muloa_free;
   for (i = 0; i < a->num_vts; i++){
-    prim(a, i, dist, prev, &hht, cmp_uint);
+    prim(a, i, dist, prev, &hht, cmp_uint, NULL);
     printf("distances and previous vertices with %lu as start \n", TOLU(i));
     print_uint_arr(dist, a->num_vts);
     print_uint_arr(prev, a->num_vts);
@@ -329,7 +344,7 @@ void run_def_double_prim(const adj_lst_t *a){
   dist = malloc_perror(a->num_vts, sizeof(double));
   prev = malloc_perror(a->num_vts, sizeof(size_t));
   for (i = 0; i < a->num_vts; i++){
-    prim(a, i, dist, prev, NULL, cmp_double);
+    prim(a, i, dist, prev, NULL, cmp_double, NULL);
     printf("distances and previous vertices with %lu as start \n", TOLU(i));
     print_double_arr(dist, a->num_vts);
     print_uint_arr(prev, a->num_vts);
@@ -360,7 +375,7 @@ void run_divchn_double_prim(const adj_lst_t *a){
   hht.remove = (heap_ht_remove)ht_divchn_remove;
   hht.free = (heap_ht_free)ht_divchn_free;
   for (i = 0; i < a->num_vts; i++){
-    prim(a, i, dist, prev, &hht, cmp_double);
+    prim(a, i, dist, prev, &hht, cmp_double, NULL);
     printf("distances and previous vertices with %lu as start \n", TOLU(i));
     print_double_arr(dist, a->num_vts);
     print_uint_arr(prev, a->num_vts);
@@ -391,7 +406,7 @@ void run_muloa_double_prim(const adj_lst_t *a){
   hht.remove = (heap_ht_remove)ht_muloa_remove;
   hht.free = (heap_ht_free)ht_muloa_free;
   for (i = 0; i < a->num_vts; i++){
-    prim(a, i, dist, prev, &hht, cmp_double);
+    prim(a, i, dist, prev, &hht, cmp_double, NULL);
     printf("distances and previous vertices with %lu as start \n", TOLU(i));
     print_double_arr(dist, a->num_vts);
     print_uint_arr(prev, a->num_vts);
@@ -505,6 +520,31 @@ void adj_lst_rand_undir_wts(adj_lst_t *a,
    across default, division-based and multiplication-based hash tables.
 */
 
+typedef struct{
+  const adj_lst_t *a;
+  const size_t *rand_start;
+  size_t *dist;
+  size_t *prev;
+  const heap_ht_t *hht;
+} rep_arg_t;
+
+void prim_rep(void *arg, size_t i){
+  rep_arg_t *ra = arg;
+  prim(ra->a, ra->rand_start[i % C_ITER], ra->dist, ra->prev, ra->hht,
+       cmp_uint, NULL);
+}
+
+void run_bench(const char *name,
+	       const char *label,
+	       const char *params,
+	       rep_arg_t *ra){
+  bench_t b;
+  bench_init(&b, C_SUITE, name, C_NUM_WARMUPS, C_ITER);
+  bench_run(&b, prim_rep, ra);
+  bench_report(&b, label, params);
+  bench_free(&b);
+}
+
 void sum_mst_edges(size_t *wt_mst,
 		   size_t *num_mst_vts,
 		   size_t num_vts,
@@ -537,7 +577,8 @@ void run_rand_uint_test(int pow_start, int pow_end){
   context_divchn_t context_divchn;
   context_muloa_t context_muloa;
   heap_ht_t hht_divchn, hht_muloa;
-  clock_t t_def, t_divchn, t_muloa;
+  rep_arg_t ra;
+  char params[128];
   rand_start = malloc_perror(C_ITER, sizeof(size_t));
   dist = malloc_perror(pow_two(pow_end), sizeof(size_t));
   prev = malloc_perror(pow_two(pow_end), sizeof(size_t));
@@ -578,36 +619,33 @@ void run_rand_uint_test(int pow_start, int pow_end){
       for (j = 0; j < C_ITER; j++){
 	rand_start[j] = RANDOM() % n;
       }
-      t_def = clock();
-      for (j = 0; j < C_ITER; j++){
-	prim(&a, rand_start[j], dist, prev, NULL, cmp_uint);
-      }
-      t_def = clock() - t_def;
+      sprintf(params, "p=%.6f vts=%lu es=%lu",
+	      C_PROBS[p], TOLU(a.num_vts), TOLU(a.num_es));
+      printf("\t\tvertices: %lu, # of directed edges: %lu\n",
+	     TOLU(a.num_vts), TOLU(a.num_es));
+      ra.a = &a;
+      ra.rand_start = rand_start;
+      ra.dist = dist;
+      ra.prev = prev;
+      ra.hht = NULL;
+      run_bench("rand-uint prim default ht",
+		"\t\t\tprim default ht runtime:             ",
+		params, &ra);
       sum_mst_edges(&wt_def, &num_vts_def, a.num_vts, dist, prev);
-      t_divchn = clock();
-      for (j = 0; j < C_ITER; j++){
-	prim(&a, rand_start[j], dist, prev, &hht_divchn, cmp_uint);
-      }
-      t_divchn = clock() - t_divchn;
+      ra.hht = &hht_divchn;
+      run_bench("rand-uint prim ht_divchn",
+		"\t\t\tprim ht_divchn runtime:              ",
+		params, &ra);
       sum_mst_edges(&wt_divchn, &num_vts_divchn, a.num_vts, dist, prev);
-      t_muloa = clock();
-      for (j = 0; j < C_ITER; j++){
-	prim(&a, rand_start[j], dist, prev, &hht_muloa, cmp_uint);
-      }
-      t_muloa = clock() - t_muloa;
+      ra.hht = &hht_muloa;
+      run_bench("rand-uint prim ht_muloa",
+		"\t\t\tprim ht_muloa runtime:               ",
+		params, &ra);
       sum_mst_edges(&wt_muloa, &num_vts_muloa, a.num_vts, dist, prev);
       res *= (wt_def == wt_divchn &&
 	      wt_divchn == wt_muloa);
       res *= (num_vts_def == num_vts_divchn &&
 	      num_vts_divchn == num_vts_muloa);
-      printf("\t\tvertices: %lu, # of directed edges: %lu\n",
-	     TOLU(a.num_vts), TOLU(a.num_es));
-      printf("\t\t\tprim default ht ave runtime:         %.8f seconds\n"
-	     "\t\t\tprim ht_divchn ave runtime:          %.8f seconds\n"
-	     "\t\t\tprim ht_muloa ave runtime:           %.8f seconds\n",
-	     (float)t_def / C_ITER / CLOCKS_PER_SEC,
-	     (float)t_divchn / C_ITER / CLOCKS_PER_SEC,
-	     (float)t_muloa / C_ITER / CLOCKS_PER_SEC);
       printf("\t\t\tcorrectness:                         ");
       print_test_result(res);
       printf("\t\t\tlast mst # edges:                    %lu\n",
@@ -630,6 +668,139 @@ void run_rand_uint_test(int pow_start, int pow_end){
   prev = NULL;
 }
 
+/**
+   Runs a test of the operation counters on random undirected graphs with
+   random size_t weights, across default, division-based and
+   multiplication-based hash tables. The counts are checked against the
+   distances and previous vertices computed without counting.
+*/
+
+int stats_valid(const adj_lst_t *a,
+		const size_t *prev,
+		const prim_stats_t *st){
+  int res = 1;
+  size_t i, num_reached = 0, num_edges = 0;
+  for (i = 0; i < a->num_vts; i++){
+    if (prev[i] != C_SIZE_MAX){
+      num_reached++;
+      num_edges += a->vt_wts[i]->num_elts;
+    }
+  }
+  res *= (st->num_pops == num_reached);
+  res *= (st->num_pushes == num_reached);
+  res *= (st->num_edges == num_edges);
+  res *= (st->num_relax == st->num_pushes - 1 + st->num_updates);
+  res *= (st->num_ht_removes == st->num_pops);
+  res *= (st->num_ht_searches >= 2 * st->num_updates);
+  res *= (st->num_ht_inserts >= st->num_pushes);
+  res *= (st->init_secs >= 0.0 &&
+	  st->search_secs >= 0.0 &&
+	  st->free_secs >= 0.0);
+  return res;
+}
+
+void print_stats(const char *name, const prim_stats_t *st){
+  size_t num_heap_ops = st->num_pushes + st->num_updates + st->num_pops;
+  printf("\t\t\t%s\n", name);
+  printf("\t\t\t\tpops: %lu, scanned edges: %lu, relaxations: %lu\n",
+	 TOLU(st->num_pops), TOLU(st->num_edges), TOLU(st->num_relax));
+  printf("\t\t\t\tpushes: %lu, updates: %lu\n",
+	 TOLU(st->num_pushes), TOLU(st->num_updates));
+  printf("\t\t\t\tht inserts: %lu, searches: %lu, removes: %lu, "
+	 "calls per heap op: %.2f\n",
+	 TOLU(st->num_ht_inserts), TOLU(st->num_ht_searches),
+	 TOLU(st->num_ht_removes),
+	 (double)(st->num_ht_inserts + st->num_ht_searches +
+		  st->num_ht_removes) / num_heap_ops);
+  printf("\t\t\t\tinit: %.6f, search: %.6f, free: %.6f seconds\n",
+	 st->init_secs, st->search_secs, st->free_secs);
+}
+
+void run_stats_test(int pow_start, int pow_end){
+  int p, i, j;
+  int res = 1;
+  size_t n, start;
+  size_t wt_l = 0, wt_h = C_WEIGHT_HIGH;
+  size_t *dist = NULL, *prev = NULL;
+  size_t *dist_st = NULL, *prev_st = NULL;
+  const char *names[3] = {"default ht", "ht_divchn", "ht_muloa"};
+  const heap_ht_t *hhts[3];
+  adj_lst_t a;
+  bern_arg_t b;
+  ht_divchn_t ht_divchn;
+  ht_muloa_t ht_muloa;
+  context_divchn_t context_divchn;
+  context_muloa_t context_muloa;
+  heap_ht_t hht_divchn, hht_muloa;
+  prim_stats_t st;
+  dist = malloc_perror(pow_two(pow_end), sizeof(size_t));
+  prev = malloc_perror(pow_two(pow_end), sizeof(size_t));
+  dist_st = malloc_perror(pow_two(pow_end), sizeof(size_t));
+  prev_st = malloc_perror(pow_two(pow_end), sizeof(size_t));
+  context_divchn.alpha_n = C_ALPHA_N_DIVCHN;
+  context_divchn.log_alpha_d = C_LOG_ALPHA_D_DIVCHN;
+  hht_divchn.ht = &ht_divchn;
+  hht_divchn.context = &context_divchn;
+  hht_divchn.init = (heap_ht_init)ht_divchn_init_helper;
+  hht_divchn.insert = (heap_ht_insert)ht_divchn_insert;
+  hht_divchn.search = (heap_ht_search)ht_divchn_search;
+  hht_divchn.remove = (heap_ht_remove)ht_divchn_remove;
+  hht_divchn.free = (heap_ht_free)ht_divchn_free;
+  context_muloa.alpha_n = C_ALPHA_N_MULOA;
+  context_muloa.log_alpha_d = C_LOG_ALPHA_D_MULOA;
+  hht_muloa.ht = &ht_muloa;
+  hht_muloa.context = &context_muloa;
+  hht_muloa.init = (heap_ht_init)ht_muloa_init_helper;
+  hht_muloa.insert = (heap_ht_insert)ht_muloa_insert;
+  hht_muloa.search = (heap_ht_search)ht_muloa_search;
+  hht_muloa.remove = (heap_ht_remove)ht_muloa_remove;
+  hht_muloa.free = (heap_ht_free)ht_muloa_free;
+  hhts[0] = NULL;
+  hhts[1] = &hht_divchn;
+  hhts[2] = &hht_muloa;
+  printf("Run a prim operation counter test on random undirected graphs "
+	 "with random size_t weights in [%lu, %lu]\n", TOLU(wt_l), TOLU(wt_h));
+  fflush(stdout);
+  for (p = 0; p < C_PROBS_COUNT; p++){
+    b.p = C_PROBS[p];
+    printf("\tP[an edge is in a graph] = %.4f\n", C_PROBS[p]);
+    for (i = pow_start; i <= pow_end; i++){
+      n = pow_two(i); /* 0 < n */
+      adj_lst_rand_undir_wts(&a,
+			     n,
+			     sizeof(size_t),
+			     wt_l,
+			     wt_h,
+			     bern,
+			     &b,
+			     add_undir_uint_edge);
+      start = RANDOM() % n;
+      printf("\t\tvertices: %lu, # of directed edges: %lu\n",
+	     TOLU(a.num_vts), TOLU(a.num_es));
+      for (j = 0; j < 3; j++){
+	prim(&a, start, dist, prev, hhts[j], cmp_uint, NULL);
+	prim(&a, start, dist_st, prev_st, hhts[j], cmp_uint, &st);
+	res *= (memcmp(dist, dist_st, n * sizeof(size_t)) == 0);
+	res *= (memcmp(prev, prev_st, n * sizeof(size_t)) == 0);
+	res *= stats_valid(&a, prev_st, &st);
+	print_stats(names[j], &st);
+      }
+      printf("\t\t\tcorrectness:                         ");
+      print_test_result(res);
+      res = 1;
+      adj_lst_free(&a);
+    }
+  }
+  free(dist);
+  free(prev);
+  free(dist_st);
+  free(prev_st);
+  dist = NULL;
+  prev = NULL;
+  dist_st = NULL;
+  prev_st = NULL;
+}
+
 /**
    Printing functions.
 */
@@ -649,8 +820,8 @@ void print_adj_lst(const adj_lst_t *a, void (*print_wt)(const void *)){
   for (i = 0; i < a->num_vts; i++){
     printf("\t%lu : ", TOLU(i));
     p_start = a->vt_wts[i]->elts;
-    p_end = p_start + a->vt_wts[i]->num_elts * a->step_size;
-    for (p = p_start; p != p_end; p += a->step_size){
+    p_end = p_start + a->vt_wts[i]->num_elts * a->pair_size;
+    for (p = p_start; p != p_end; p += a->pair_size){
       printf("%lu ", TOLU(*(const size_t *)p));
     }
     printf("\n");
@@ -660,8 +831,8 @@ void print_adj_lst(const adj_lst_t *a, void (*print_wt)(const void *)){
     for (i = 0; i < a->num_vts; i++){
       printf("\t%lu : ", TOLU(i));
       p_start = a->vt_wts[i]->elts;
-      p_end = p_start + a->vt_wts[i]->num_elts * a->step_size;
-      for (p = p_start; p != p_end; p += a->step_size){
+      p_end = p_start + a->vt_wts[i]->num_elts * a->pair_size;
+      for (p = p_start; p != p_end; p += a->pair_size){
 	print_wt(p + sizeof(size_t));
       }
       printf("\n");
@@ -714,7 +885,8 @@ int main(int argc, char *argv[]){
       args[1] > C_FULL_BIT / 2 ||
       args[1] < args[0] ||
       args[2] > 1 ||
-      args[3] > 1){
+      args[3] > 1 ||
+      args[4] > 1){
     printf("USAGE:\n%s", C_USAGE);
     exit(EXIT_FAILURE);
   }
@@ -723,6 +895,7 @@ int main(int argc, char *argv[]){
     run_double_graph_test();
   }
   if (args[3]) run_rand_uint_test(args[0], args[1]);
+  if (args[4]) run_stats_test(args[0], args[1]);
   free(args);
   args = NULL;
   return 0;
@@ -23,6 +23,11 @@
    the computation of hash values. If V is large and the graph is sparse,
    a non-default hash table may provide space advantages.
 
+   If a pointer to a prim_stats_t block is passed, the algorithm counts its
+   operations, including the calls to the hash table of the heap, and
+   measures the wall-clock time of its phases. If NULL is passed, the
+   operations are not counted and the hash table is called directly.
+
    The implementation does not use stdint.h and is portable under C89/C90
    and C99.
 */
@@ -34,6 +39,20 @@
 #include "graph.h"
 #include "heap.h"
 
+typedef struct{
+  size_t num_pops; /* # heap pops, i.e. # reached vertices */
+  size_t num_edges; /* # scanned edges */
+  size_t num_relax; /* # edges that decreased the key of a vertex */
+  size_t num_pushes; /* # heap pushes */
+  size_t num_updates; /* # heap updates */
+  size_t num_ht_inserts; /* # calls to the hash table of the heap */
+  size_t num_ht_searches;
+  size_t num_ht_removes;
+  double init_secs; /* wall-clock time of initialization */
+  double search_secs; /* wall-clock time of the main loop */
+  double free_secs; /* wall-clock time of freeing the heap */
+} prim_stats_t;
+
 /**
    Computes and copies the edge weights of an mst of the connected component
    of a start vertex to the array pointed to by dist, and the previous
@@ -59,11 +78,15 @@
                  the first argument is greater than the weight value 
                  pointed to by the second, and zero integer value if the two
                  weight values are equal
+   stats       : - NULL pointer, if operations are not counted
+                 - a pointer to a block of size sizeof(prim_stats_t), where
+                 the counts and phase times of the run are copied
 */
 void prim(const adj_lst_t *a,
 	  size_t start,
 	  void *dist,
 	  size_t *prev,
 	  const heap_ht_t *hht,
-	  int (*cmp_wt)(const void *, const void *));
+	  int (*cmp_wt)(const void *, const void *),
+	  prim_stats_t *stats);
 #endif
@@ -17,17 +17,25 @@
    -  [0, 1] : on/off for all hash tables test
    -  [0, 1] : on/off for default hash table test
    -  [0, 1] : on/off for sparse graph test
+   -  [0, 1] : on/off for operation counter test on complete graphs with
+               a <= |V| <= b
 
    usage examples:
    ./tsp-test
    ./tsp-test 12 18 18 22 10 60
    ./tsp-test 12 18 18 22 100 105 0 0 1 1
+   ./tsp-test 1 16 1 1 1 1 0 0 0 0 1
 
    tsp-test can be run with any subset of command line arguments in the
    above-defined order. If the (i + 1)th argument is specified then the ith
    argument must be specified for i >= 0. Default values are used for the
    unspecified arguments according to the C_ARGS_DEF array.
 
+   The runtimes of the random graph tests are measured with
+   utilities-bench and can be written as csv or json records by setting
+   BENCH_FORMAT and BENCH_OUT, e.g.
+   BENCH_FORMAT=csv BENCH_OUT=tsp.csv ./tsp-test 12 18 18 22 10 60
+
    The implementation of tests does not use stdint.h and is portable under
    C89/C90 with the only requirement that CHAR_BIT * sizeof(size_t) is
    greater or equal to 16 and is even.
@@ -43,6 +51,7 @@
 #include "ht-muloa.h"
 #include "graph.h"
 #include "stack.h"
+#include "utilities-bench.h"
 #include "utilities-mem.h"
 #include "utilities-mod.h"
 
@@ -52,7 +61,11 @@
    be the case on older rand() implementations, and on current
    implementations on different systems.
 */
+#ifdef TEST_SEED
+#define RGENS_SEED() do{srand(TEST_SEED);}while (0)
+#else
 #define RGENS_SEED() do{srand(time(NULL));}while (0)
+#endif
 #define RANDOM() (rand()) /* [0, RAND_MAX] */
 #define DRAND() ((double)rand() / RAND_MAX) /* [0.0, 1.0] */
 
@@ -70,9 +83,10 @@ const char *C_USAGE =
   "[0, 1] : on/off for small graph test \n"
   "[0, 1] : on/off for all hash tables test \n"
   "[0, 1] : on/off for default hash table test \n"
-  "[0, 1] : on/off for sparse graph test \n";
-const int C_ARGC_MAX = 11;
-const size_t C_ARGS_DEF[10] = {1, 20, 20, 21, 100, 104, 1, 1, 1, 1};
+  "[0, 1] : on/off for sparse graph test \n"
+  "[0, 1] : counter test on/off \n";
+const int C_ARGC_MAX = 12;
+const size_t C_ARGS_DEF[11] = {1, 20, 20, 21, 100, 104, 1, 1, 1, 1, 1};
 const size_t C_SPARSE_GRAPH_V_MAX = 8 * CHAR_BIT * sizeof(size_t);
 const size_t C_FULL_BIT = CHAR_BIT * sizeof(size_t);
 
@@ -92,7 +106,9 @@ const double C_WTS_DOUBLE[12] = {1.0, 1.0, 1.0, 1.0, 2.0, 2.0, 2.0,
 				 2.0, 2.0, 2.0, 2.0, 2.0};
 
 /* random graph tests */
+const char *C_SUITE = "tsp-test";
 const int C_ITER = 3;
+const size_t C_NUM_WARMUPS = 0; /* a run allocates and fills a table */
 const int C_PROBS_COUNT = 4;
 const int C_SPARSE_PROBS_COUNT = 2;
 const double C_PROBS[4] = {1.0000, 0.2500, 0.0625, 0.0000};
@@ -198,7 +214,7 @@ void run_def_uint_tsp(const adj_lst_t *a){
   size_t dist;
   size_t i;
   for (i = 0; i < a->num_vts; i++){
-    ret = tsp(a, i, &dist, NULL, add_uint, cmp_uint);
+    ret = tsp(a, i, &dist, NULL, add_uint, cmp_uint, NULL);
     printf("tsp ret: %d, tour length with %lu as start: ", ret, TOLU(i));
     print_uint_arr(&dist, 1);
   }
@@ -222,7 +238,7 @@ void run_divchn_uint_tsp(const adj_lst_t *a){
   tht.remove = (tsp_ht_remove)ht_divchn_remove;
   tht.free = (tsp_ht_free)ht_divchn_free;
   for (i = 0; i < a->num_vts; i++){
-    ret = tsp(a, i, &dist, &tht, add_uint, cmp_uint);
+    ret = tsp(a, i, &dist, &tht, add_uint, cmp_uint, NULL);
     printf("tsp ret: %d, tour length with %lu as start: ", ret, TOLU(i));
     print_uint_arr(&dist, 1);
   }
@@ -247,7 +263,7 @@ void run_muloa_uint_tsp(const adj_lst_t *a){
   tht.remove = (tsp_ht_remove)ht_muloa_remove;
   tht.free = (tsp_ht_free)ht_muloa_free;
   for (i = 0; i < a->num_vts; i++){
-    ret = tsp(a, i, &dist, &tht, add_uint, cmp_uint);
+    ret = tsp(a, i, &dist, &tht, add_uint, cmp_uint, NULL);
     printf("tsp ret: %d, tour length with %lu as start: ", ret, TOLU(i));
     print_uint_arr(&dist, 1);
   }
@@ -331,7 +347,7 @@ void run_def_double_tsp(const adj_lst_t *a){
   size_t i;
   double dist;
   for (i = 0; i < a->num_vts; i++){
-    ret = tsp(a, i, &dist, NULL, add_double, cmp_double);
+    ret = tsp(a, i, &dist, NULL, add_double, cmp_double, NULL);
     printf("tsp ret: %d, tour length with %lu as start: ", ret, TOLU(i));
     print_double_arr(&dist, 1);
   }
@@ -355,7 +371,7 @@ void run_divchn_double_tsp(const adj_lst_t *a){
   tht.remove = (tsp_ht_remove)ht_divchn_remove;
   tht.free = (tsp_ht_free)ht_divchn_free;
   for (i = 0; i < a->num_vts; i++){
-    ret = tsp(a, i, &dist, &tht, add_double, cmp_double);
+    ret = tsp(a, i, &dist, &tht, add_double, cmp_double, NULL);
     printf("tsp ret: %d, tour length with %lu as start: ", ret, TOLU(i));
     print_double_arr(&dist, 1);
   }
@@ -380,7 +396,7 @@ void run_muloa_double_tsp(const adj_lst_t *a){
   tht.remove = (tsp_ht_remove)ht_muloa_remove;
   tht.free = (tsp_ht_free)ht_muloa_free;
   for (i = 0; i < a->num_vts; i++){
-    ret = tsp(a, i, &dist, &tht, add_double, cmp_double);
+    ret = tsp(a, i, &dist, &tht, add_double, cmp_double, NULL);
     printf("tsp ret: %d, tour length with %lu as start: ", ret, TOLU(i));
     print_double_arr(&dist, 1);
   }
@@ -498,6 +514,51 @@ void adj_lst_rand_dir_wts(adj_lst_t *a,
   graph_free(&g);
 }
 
+/**
+   Timed repetitions of tsp from random start vertices.
+*/
+
+typedef struct{
+  const adj_lst_t *a;
+  const size_t *rand_start;
+  size_t *dist;
+  const tsp_ht_t *tht;
+  int ret;
+} rep_arg_t;
+
+void tsp_rep(void *arg, size_t i){
+  rep_arg_t *ra = arg;
+  ra->ret = tsp(ra->a,
+		ra->rand_start[i % C_ITER],
+		ra->dist,
+		ra->tht,
+		add_uint,
+		cmp_uint,
+		NULL);
+}
+
+int run_bench(const char *name,
+	      const char *label,
+	      const adj_lst_t *a,
+	      const size_t *rand_start,
+	      size_t *dist,
+	      const tsp_ht_t *tht){
+  char params[128];
+  bench_t b;
+  rep_arg_t ra;
+  ra.a = a;
+  ra.rand_start = rand_start;
+  ra.dist = dist;
+  ra.tht = tht;
+  ra.ret = -1;
+  sprintf(params, "vts=%lu es=%lu", TOLU(a->num_vts), TOLU(a->num_es));
+  bench_init(&b, C_SUITE, name, C_NUM_WARMUPS, C_ITER);
+  bench_run(&b, tsp_rep, &ra);
+  bench_report(&b, label, params);
+  bench_free(&b);
+  return ra.ret;
+}
+
 /**
    Tests tsp across all hash tables on random directed graphs with random
    size_t non-tour weights and a known tour.
@@ -517,7 +578,6 @@ void run_rand_uint_test(int num_vts_start, int num_vts_end){
   context_divchn_t context_divchn;
   context_muloa_t context_muloa;
   tsp_ht_t tht_divchn, tht_muloa;
-  clock_t t_def, t_divchn, t_muloa;
   rand_start = malloc_perror(C_ITER, sizeof(size_t));
   context_divchn.alpha_n = C_ALPHA_N_DIVCHN;
   context_divchn.log_alpha_d = C_LOG_ALPHA_D_DIVCHN;
@@ -558,36 +618,17 @@ void run_rand_uint_test(int num_vts_start, int num_vts_end){
       for (j = 0; j < C_ITER; j++){
 	rand_start[j] = RANDOM() % n;
       }
-      t_def = clock();
-      for (j = 0; j < C_ITER; j++){
-	ret_def = tsp(&a,
-		      rand_start[j],
-		      &dist_def,
-		      NULL,
-		      add_uint,
-		      cmp_uint);
-      }
-      t_def = clock() - t_def;
-      t_divchn = clock();
-      for (j = 0; j < C_ITER; j++){
-	ret_divchn = tsp(&a,
-		      rand_start[j],
-		      &dist_divchn,
-		      &tht_divchn,
-		      add_uint,
-		      cmp_uint);
-      }
-      t_divchn = clock() - t_divchn;
-      t_muloa = clock();
-      for (j = 0; j < C_ITER; j++){
-	ret_muloa = tsp(&a,
-		      rand_start[j],
-		      &dist_muloa,
-		      &tht_muloa,
-		      add_uint,
-		      cmp_uint);
-      }
-      t_muloa = clock() - t_muloa;
+      printf("\t\tvertices: %lu, # of directed edges: %lu\n",
+	     TOLU(a.num_vts), TOLU(a.num_es));
+      ret_def = run_bench("rand-uint tsp default ht",
+			  "\t\t\ttsp default ht runtime:         ",
+			  &a, rand_start, &dist_def, NULL);
+      ret_divchn = run_bench("rand-uint tsp ht_divchn",
+			     "\t\t\ttsp ht_divchn runtime:          ",
+			     &a, rand_start, &dist_divchn, &tht_divchn);
+      ret_muloa = run_bench("rand-uint tsp ht_muloa",
+			    "\t\t\ttsp ht_muloa runtime:           ",
+			    &a, rand_start, &dist_muloa, &tht_muloa);
       if (n == 1){
 	res *= (dist_def == 0 && ret_def == 0);
 	res *= (dist_divchn == 0 && ret_divchn == 0);
@@ -597,14 +638,6 @@ void run_rand_uint_test(int num_vts_start, int num_vts_end){
 	res *= (dist_divchn == n && ret_divchn == 0);
 	res *= (dist_muloa == n && ret_muloa == 0);
       }
-      printf("\t\tvertices: %lu, # of directed edges: %lu\n",
-	     TOLU(a.num_vts), TOLU(a.num_es));
-      printf("\t\t\ttsp default ht ave runtime:     %.8f seconds\n"
-	     "\t\t\ttsp ht_divchn ave runtime:      %.8f seconds\n"
-	     "\t\t\ttsp ht_muloa ave runtime:       %.8f seconds\n",
-	     (float)t_def / C_ITER / CLOCKS_PER_SEC,
-	     (float)t_divchn / C_ITER / CLOCKS_PER_SEC,
-	     (float)t_muloa / C_ITER / CLOCKS_PER_SEC);
       printf("\t\t\tcorrectness:                    ");
       print_test_result(res);
       res = 1;
@@ -629,7 +662,6 @@ void run_def_rand_uint_test(int num_vts_start, int num_vts_end){
   size_t *rand_start = NULL;
   adj_lst_t a;
   bern_arg_t b;
-  clock_t t_def;
   rand_start = malloc_perror(C_ITER, sizeof(size_t));
   printf("Run a tsp test with a default hash table on directed graphs \n"
 	 "with random size_t non-tour weights in [%lu, %lu]\n",
@@ -650,25 +682,16 @@ void run_def_rand_uint_test(int num_vts_start, int num_vts_end){
     for (j = 0; j < C_ITER; j++){
       rand_start[j] = RANDOM() % n;
     }
-    t_def = clock();
-    for (j = 0; j < C_ITER; j++){
-      ret_def = tsp(&a,
-		    rand_start[j],
-		    &dist_def,
-		    NULL,
-		    add_uint,
-		    cmp_uint);
-    }
-    t_def = clock() - t_def;
+    printf("\t\tvertices: %lu, # of directed edges: %lu\n",
+	   TOLU(a.num_vts), TOLU(a.num_es));
+    ret_def = run_bench("def-rand-uint tsp default ht",
+			"\t\t\ttsp default ht runtime:         ",
+			&a, rand_start, &dist_def, NULL);
     if (n == 1){
       res *= (dist_def == 0 && ret_def == 0);
     }else{
       res *= (dist_def == n && ret_def == 0);
     }
-    printf("\t\tvertices: %lu, # of directed edges: %lu\n",
-	   TOLU(a.num_vts), TOLU(a.num_es));
-    printf("\t\t\ttsp default ht ave runtime:     %.8f seconds\n",
-	   (float)t_def / C_ITER / CLOCKS_PER_SEC);
     printf("\t\t\tcorrectness:                    ");
     print_test_result(res);
     res = 1;
@@ -697,7 +720,6 @@ void run_sparse_rand_uint_test(int num_vts_start, int num_vts_end){
   context_divchn_t context_divchn;
   context_muloa_t context_muloa;
   tsp_ht_t tht_divchn, tht_muloa;
-  clock_t t_divchn, t_muloa;
   rand_start = malloc_perror(C_ITER, sizeof(size_t));
   context_divchn.alpha_n = C_ALPHA_N_DIVCHN;
   context_divchn.log_alpha_d = C_LOG_ALPHA_D_DIVCHN;
@@ -737,26 +759,14 @@ void run_sparse_rand_uint_test(int num_vts_start, int num_vts_end){
       for (j = 0; j < C_ITER; j++){
 	rand_start[j] = RANDOM() % n;
       }
-      t_divchn = clock();
-      for (j = 0; j < C_ITER; j++){
-	ret_divchn = tsp(&a,
-			 rand_start[j],
-			 &dist_divchn,
-			 &tht_divchn,
-			 add_uint,
-			 cmp_uint);
-      }
-      t_divchn = clock() - t_divchn;
-      t_muloa = clock();
-      for (j = 0; j < C_ITER; j++){
-	ret_muloa = tsp(&a,
-			rand_start[j],
-			&dist_muloa,
-			&tht_muloa,
-			add_uint,
-			cmp_uint);
-      }
-      t_muloa = clock() - t_muloa;
+      printf("\t\tvertices: %lu, # of directed edges: %lu\n",
+	     TOLU(a.num_vts), TOLU(a.num_es));
+      ret_divchn = run_bench("sparse-rand-uint tsp ht_divchn",
+			     "\t\t\ttsp ht_divchn runtime:          ",
+			     &a, rand_start, &dist_divchn, &tht_divchn);
+      ret_muloa = run_bench("sparse-rand-uint tsp ht_muloa",
+			    "\t\t\ttsp ht_muloa runtime:           ",
+			    &a, rand_start, &dist_muloa, &tht_muloa);
       if (n == 1){
 	res *= (dist_divchn == 0 && ret_divchn == 0);
 	res *= (dist_muloa == 0 && ret_muloa == 0);
@@ -764,12 +774,6 @@ void run_sparse_rand_uint_test(int num_vts_start, int num_vts_end){
 	res *= (dist_divchn == n && ret_divchn == 0);
 	res *= (dist_muloa == n && ret_muloa == 0);
       }
-      printf("\t\tvertices: %lu, # of directed edges: %lu\n",
-	     TOLU(a.num_vts), TOLU(a.num_es));
-      printf("\t\t\ttsp ht_divchn ave runtime:      %.8f seconds\n"
-	     "\t\t\ttsp ht_muloa ave runtime:       %.8f seconds\n",
-	     (float)t_divchn / C_ITER / CLOCKS_PER_SEC,
-	     (float)t_muloa / C_ITER / CLOCKS_PER_SEC);
       printf("\t\t\tcorrectness:                    ");
       print_test_result(res);
       res = 1;
@@ -780,6 +784,144 @@ void run_sparse_rand_uint_test(int num_vts_start, int num_vts_end){
   rand_start = NULL;
 }
 
+/**
+   Tests the operation counters of tsp across all hash tables on complete
+   directed graphs with random size_t weights. In a complete graph with n
+   vertices, the number of sets reached at level k is the number of
+   choices of k - 1 previous vertices other than start and of a last
+   vertex, i.e. C(n - 1, k - 1) * (n - k), and each popped set scans n - 1
+   edges.
+*/
+
+int stats_valid(size_t n, const tsp_stats_t *st){
+  int res = 1;
+  size_t k, c = 1; /* C(n - 1, k - 1) */
+  size_t num_sets = 0;
+  if (n == 1){
+    return (st->num_levels == 0 &&
+	    st->num_sets == 0 &&
+	    st->num_edges == 0 &&
+	    st->num_ht_inserts == 1 &&
+	    st->num_ht_removes == 0);
+  }
+  res *= (st->num_levels == n - 1);
+  for (k = 1; k < n; k++){
+    res *= (st->level_sets[k - 1] == c * (n - k));
+    res *= (st->level_secs[k - 1] >= 0.0);
+    num_sets += c * (n - k);
+    c = c * (n - k) / k;
+  }
+  res *= (st->num_sets == num_sets);
+  res *= (st->num_edges == (1 + num_sets) * (n - 1));
+  res *= (st->num_ht_removes == 1 + num_sets - st->level_sets[n - 2]);
+  res *= (st->num_ht_inserts >= 1 + num_sets);
+  res *= (st->num_ht_searches >= num_sets);
+  res *= (st->init_secs >= 0.0 &&
+	  st->levels_secs >= 0.0 &&
+	  st->final_secs >= 0.0 &&
+	  st->free_secs >= 0.0);
+  return res;
+}
+
+void print_stats(const char *name, size_t n, const tsp_stats_t *st){
+  size_t k, max_k = 0;
+  printf("\t\t\t%s\n", name);
+  printf("\t\t\t\tlevels: %lu, sets: %lu, scanned edges: %lu\n",
+	 TOLU(st->num_levels), TOLU(st->num_sets), TOLU(st->num_edges));
+  printf("\t\t\t\tht inserts: %lu, searches: %lu, removes: %lu\n",
+	 TOLU(st->num_ht_inserts), TOLU(st->num_ht_searches),
+	 TOLU(st->num_ht_removes));
+  for (k = 1; k < st->num_levels && k < n - 1; k++){
+    if (st->level_secs[k] > st->level_secs[max_k]) max_k = k;
+  }
+  if (st->num_levels > 0){
+    printf("\t\t\t\tlargest level time: level %lu, %lu sets, "
+	   "%.6f seconds\n", TOLU(max_k + 1), TOLU(st->level_sets[max_k]),
+	   st->level_secs[max_k]);
+  }
+  printf("\t\t\t\tinit: %.6f, levels: %.6f, final: %.6f, free: %.6f "
+	 "seconds\n",
+	 st->init_secs, st->levels_secs, st->final_secs, st->free_secs);
+}
+
+void run_stats_test(int num_vts_start, int num_vts_end){
+  int i, j;
+  int res = 1;
+  int ret = -1;
+  size_t n, start;
+  size_t wt_l = 0, wt_h = C_WEIGHT_HIGH;
+  size_t dist, dist_st;
+  const char *names[3] = {"default ht", "ht_divchn", "ht_muloa"};
+  const tsp_ht_t *thts[3];
+  adj_lst_t a;
+  bern_arg_t b;
+  ht_divchn_t ht_divchn;
+  ht_muloa_t ht_muloa;
+  context_divchn_t context_divchn;
+  context_muloa_t context_muloa;
+  tsp_ht_t tht_divchn, tht_muloa;
+  tsp_stats_t st;
+  st.level_sets = malloc_perror(num_vts_end, sizeof(size_t));
+  st.level_secs = malloc_perror(num_vts_end, sizeof(double));
+  context_divchn.alpha_n = C_ALPHA_N_DIVCHN;
+  context_divchn.log_alpha_d = C_LOG_ALPHA_D_DIVCHN;
+  tht_divchn.ht = &ht_divchn;
+  tht_divchn.context = &context_divchn;
+  tht_divchn.init = (tsp_ht_init)ht_divchn_init_helper;
+  tht_divchn.insert = (tsp_ht_insert)ht_divchn_insert;
+  tht_divchn.search = (tsp_ht_search)ht_divchn_search;
+  tht_divchn.remove = (tsp_ht_remove)ht_divchn_remove;
+  tht_divchn.free = (tsp_ht_free)ht_divchn_free;
+  context_muloa.alpha_n = C_ALPHA_N_MULOA;
+  context_muloa.log_alpha_d = C_LOG_ALPHA_D_MULOA;
+  context_muloa.rdc_key = NULL;
+  tht_muloa.ht = &ht_muloa;
+  tht_muloa.context = &context_muloa;
+  tht_muloa.init = (tsp_ht_init)ht_muloa_init_helper;
+  tht_muloa.insert = (tsp_ht_insert)ht_muloa_insert;
+  tht_muloa.search = (tsp_ht_search)ht_muloa_search;
+  tht_muloa.remove = (tsp_ht_remove)ht_muloa_remove;
+  tht_muloa.free = (tsp_ht_free)ht_muloa_free;
+  thts[0] = NULL;
+  thts[1] = &tht_divchn;
+  thts[2] = &tht_muloa;
+  printf("Run a tsp operation counter test across all hash tables on "
+	 "complete directed graphs \nwith random size_t weights in "
+	 "[%lu, %lu]\n", TOLU(wt_l), TOLU(wt_h));
+  fflush(stdout);
+  b.p = C_PROB_ONE;
+  for (i = num_vts_start; i <= num_vts_end; i++){
+    n = i;
+    adj_lst_rand_dir_wts(&a,
+			 n,
+			 sizeof(size_t),
+			 wt_l,
+			 wt_h,
+			 bern,
+			 &b,
+			 add_dir_uint_edge);
+    start = RANDOM() % n;
+    printf("\t\tvertices: %lu, # of directed edges: %lu\n",
+	   TOLU(a.num_vts), TOLU(a.num_es));
+    for (j = 0; j < 3; j++){
+      ret = tsp(&a, start, &dist, thts[j], add_uint, cmp_uint, NULL);
+      res *= (ret == tsp(&a, start, &dist_st, thts[j], add_uint, cmp_uint,
+			 &st));
+      res *= (dist == dist_st);
+      res *= stats_valid(n, &st);
+      print_stats(names[j], n, &st);
+    }
+    printf("\t\t\tcorrectness:                    ");
+    print_test_result(res);
+    res = 1;
+    adj_lst_free(&a);
+  }
+  free(st.level_sets);
+  free(st.level_secs);
+  st.level_sets = NULL;
+  st.level_secs = NULL;
+}
+
 /**
    Printing functions.
 */
@@ -799,8 +941,8 @@ void print_adj_lst(const adj_lst_t *a, void (*print_wt)(const void *)){
   for (i = 0; i < a->num_vts; i++){
     printf("\t%lu : ", TOLU(i));
     p_start = a->vt_wts[i]->elts;
-    p_end = p_start + a->vt_wts[i]->num_elts * a->step_size;
-    for (p = p_start; p != p_end; p += a->step_size){
+    p_end = p_start + a->vt_wts[i]->num_elts * a->pair_size;
+    for (p = p_start; p != p_end; p += a->pair_size){
       printf("%lu ", TOLU(*(const size_t *)p));
     }
     printf("\n");
@@ -810,8 +952,8 @@ void print_adj_lst(const adj_lst_t *a, void (*print_wt)(const void *)){
     for (i = 0; i < a->num_vts; i++){
       printf("\t%lu : ", TOLU(i));
       p_start = a->vt_wts[i]->elts;
-      p_end = p_start + a->vt_wts[i]->num_elts * a->step_size;
-      for (p = p_start; p != p_end; p += a->step_size){
+      p_end = p_start + a->vt_wts[i]->num_elts * a->pair_size;
+      for (p = p_start; p != p_end; p += a->pair_size){
 	print_wt(p + sizeof(size_t));
       }
       printf("\n");
@@ -880,7 +1022,8 @@ int main(int argc, char *argv[]){
       args[6] > 1 ||
       args[7] > 1 ||
       args[8] > 1 ||
-      args[9] > 1){
+      args[9] > 1 ||
+      args[10] > 1){
     fprintf(stderr, "USAGE:\n%s", C_USAGE);
     exit(EXIT_FAILURE);
   }
@@ -891,6 +1034,7 @@ int main(int argc, char *argv[]){
   if (args[7]) run_rand_uint_test(args[0], args[1]);
   if (args[8]) run_def_rand_uint_test(args[2], args[3]);
   if (args[9]) run_sparse_rand_uint_test(args[4], args[5]);
+  if (args[10]) run_stats_test(args[0], args[1]);
   free(args);
   args = NULL;
   return 0;
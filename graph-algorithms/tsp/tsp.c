@@ -25,8 +25,18 @@
    provide speed advantages by avoiding the computation of hash values. If V
    is larger and the graph is sparse, a non-default hash table may provide
    space advantages.
+
+   If a pointer to a tsp_stats_t block is passed, the algorithm counts the
+   reached sets at each level, i.e. the pairs of a last vertex and a set of
+   previous vertices reached by paths with the same number of edges, and
+   its other operations, including the calls to the hash table, and
+   measures the wall-clock time of its phases and levels. If NULL is
+   passed, the operations are not counted and the hash table is called
+   directly.
 */
 
+#define UTILITIES_MEM_TAG MEM_TAG_TSP
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -35,6 +45,23 @@
 #include "graph.h"
 #include "stack.h"
 #include "utilities-mem.h"
+#include "utilities-perf.h"
+#include "utilities-time.h"
+
+/**
+   The arrays of the default hash table are allocated with
+   huge_calloc_perror and huge_malloc_perror if TSP_HUGE is defined, and
+   with calloc_perror and malloc_perror otherwise.
+*/
+#ifdef TSP_HUGE
+#define DEF_CALLOC(num, size) huge_calloc_perror((num), (size))
+#define DEF_MALLOC(num, size) huge_malloc_perror((num), (size))
+#define DEF_FREE(ptr) aligned_free(ptr)
+#else
+#define DEF_CALLOC(num, size) calloc_perror((num), (size))
+#define DEF_MALLOC(num, size) malloc_perror((num), (size))
+#define DEF_FREE(ptr) free(ptr)
+#endif
 
 typedef enum{FALSE, TRUE} boolean_t;
 
@@ -56,6 +83,11 @@ typedef struct{
   size_t bit; /* set element with a single set bit */
 } ibit_t;
 
+typedef struct{
+  const tsp_ht_t *tht; /* counted hash table parameter */
+  tsp_stats_t *stats;
+} ht_ctr_t;
+
 static const size_t C_SET_ELT_SIZE = sizeof(size_t);
 static const size_t C_SET_ELT_BIT = CHAR_BIT * sizeof(size_t);
 
@@ -75,13 +107,26 @@ static void *ht_def_search(const ht_def_t *ht, const size_t *key);
 static void ht_def_remove(ht_def_t *ht, const size_t *key, void *elt);
 static void ht_def_free(ht_def_t *ht);
 
+/* hash table operations that count the calls to a hash table parameter */
+static void ht_ctr_init(ht_ctr_t *ht,
+			size_t key_size,
+			size_t elt_size,
+			void (*free_elt)(void *),
+			void *context);
+static void ht_ctr_insert(ht_ctr_t *ht, const void *key, const void *elt);
+static void *ht_ctr_search(const ht_ctr_t *ht, const void *key);
+static void ht_ctr_remove(ht_ctr_t *ht, const void *key, void *elt);
+static void ht_ctr_free(ht_ctr_t *ht);
+
 /* auxiliary functions */
 static void build_next(const adj_lst_t *a,
 		       stack_t *prev_s,
 		       stack_t *next_s,
 		       const tsp_ht_t *tht,
 		       void (*add_wt)(void *, const void *, const void *),
-		       int (*cmp_wt)(const void *, const void *));
+		       int (*cmp_wt)(const void *, const void *),
+		       tsp_stats_t *stats);
+static void stats_init(tsp_stats_t *stats);
 static size_t pow_two(size_t k);
 static void fprintf_stderr_exit(const char *s, int line);
 
@@ -118,13 +163,19 @@ static void *elt_ptr(const void *elts, size_t i, size_t elt_size);
                  the first argument is greater than the weight value 
                  pointed to by the second, and zero integer value if the two
                  weight values are equal
+   stats       : - NULL pointer, if operations are not counted
+                 - a pointer to a tsp_stats_t block, where the counts and
+                 phase times of the run are copied; if level_sets and
+                 level_secs are not NULL, they must point to preallocated
+                 arrays with a count equal to the number of vertices
 */
 int tsp(const adj_lst_t *a,
 	size_t start,
 	void *dist,
 	const tsp_ht_t *tht,
 	void (*add_wt)(void *, const void *, const void *),
-	int (*cmp_wt)(const void *, const void *)){
+	int (*cmp_wt)(const void *, const void *),
+	tsp_stats_t *stats){
   const char *p = NULL, *p_start = NULL, *p_end = NULL;
   size_t wt_size = a->wt_size;
   size_t set_count, set_size;
@@ -133,11 +184,17 @@ int tsp(const adj_lst_t *a,
   size_t *prev_set = NULL;
   void *sum_wt = NULL;
   boolean_t final_dist_updated = FALSE;
+  double t = 0.0, t_level = 0.0;
   stack_t prev_s, next_s;
   ht_def_t ht_def;
+  ht_ctr_t ht_ctr;
   context_t context;
-  tsp_ht_t tht_def;
+  tsp_ht_t tht_def, tht_ctr;
   const tsp_ht_t *thtp = tht;
+  if (stats != NULL){
+    stats_init(stats);
+    t = time_wall();
+  }
   set_count = a->num_vts / C_SET_ELT_BIT;
   if (a->num_vts % C_SET_ELT_BIT){
     set_count++;
@@ -161,32 +218,69 @@ int tsp(const adj_lst_t *a,
     tht_def.free = (tsp_ht_free)ht_def_free;
     thtp = &tht_def;
   }
+  if (stats != NULL){
+    ht_ctr.tht = thtp;
+    ht_ctr.stats = stats;
+    tht_ctr.ht = &ht_ctr;
+    tht_ctr.context = NULL;
+    tht_ctr.init = (tsp_ht_init)ht_ctr_init;
+    tht_ctr.insert = (tsp_ht_insert)ht_ctr_insert;
+    tht_ctr.search = (tsp_ht_search)ht_ctr_search;
+    tht_ctr.remove = (tsp_ht_remove)ht_ctr_remove;
+    tht_ctr.free = (tsp_ht_free)ht_ctr_free;
+    thtp = &tht_ctr;
+  }
   thtp->init(thtp->ht, set_size, wt_size, NULL, thtp->context);
   thtp->insert(thtp->ht, prev_set, dist);
+  if (stats != NULL){
+    stats->init_secs = time_wall() - t;
+    t = time_wall();
+  }
   for (i = 0; i < a->num_vts - 1; i++){
+    PERF_REGION_START(PERF_REG_TSP_LEVEL);
+    if (stats != NULL) t_level = time_wall();
     stack_init(&next_s, 1, set_size, NULL);
-    build_next(a, &prev_s, &next_s, thtp, add_wt, cmp_wt);
+    build_next(a, &prev_s, &next_s, thtp, add_wt, cmp_wt, stats);
     stack_free(&prev_s);
     prev_s = next_s;
+    if (stats != NULL){
+      if (stats->level_sets != NULL) stats->level_sets[i] = prev_s.num_elts;
+      if (stats->level_secs != NULL){
+	stats->level_secs[i] = time_wall() - t_level;
+      }
+      stats->num_levels++;
+      stats->num_sets += prev_s.num_elts;
+    }
+    PERF_REGION_STOP(PERF_REG_TSP_LEVEL);
     if (prev_s.num_elts == 0){
       /* no progress made */
+      if (stats != NULL){
+	stats->levels_secs = time_wall() - t;
+	t = time_wall();
+      }
       stack_free(&prev_s);
-      thtp->free(thtp->ht);
+      (thtp->free)(thtp->ht);
       free(prev_set);
       free(sum_wt);
       thtp = NULL;
       prev_set = NULL;
       sum_wt = NULL;
+      if (stats != NULL) stats->free_secs = time_wall() - t;
       return 1;
     }
   }
+  if (stats != NULL){
+    stats->levels_secs = time_wall() - t;
+    t = time_wall();
+  }
   /* compute the return to start */
   while (prev_s.num_elts > 0){
     stack_pop(&prev_s, prev_set);
     u = prev_set[0];
     p_start = a->vt_wts[u]->elts;
-    p_end = p_start + a->vt_wts[u]->num_elts * a->step_size;
-    for (p = p_start; p != p_end; p += a->step_size){
+    p_end = p_start + a->vt_wts[u]->num_elts * a->pair_size;
+    if (stats != NULL) stats->num_edges += a->vt_wts[u]->num_elts;
+    for (p = p_start; p != p_end; p += a->pair_size){
       v = *(const size_t *)p;
       if (v == start){
 	add_wt(sum_wt,
@@ -201,13 +295,18 @@ int tsp(const adj_lst_t *a,
       }
     }
   }
+  if (stats != NULL){
+    stats->final_secs = time_wall() - t;
+    t = time_wall();
+  }
   stack_free(&prev_s);
-  thtp->free(thtp->ht);
+  (thtp->free)(thtp->ht);
   free(prev_set);
   free(sum_wt);
   thtp = NULL;
   prev_set = NULL;
   sum_wt = NULL;
+  if (stats != NULL) stats->free_secs = time_wall() - t;
   if (!final_dist_updated && a->num_vts > 1) return 1;
   return 0;
 }
@@ -221,7 +320,8 @@ static void build_next(const adj_lst_t *a,
 		       stack_t *next_s,
 		       const tsp_ht_t *tht,
 		       void (*add_wt)(void *, const void *, const void *),
-		       int (*cmp_wt)(const void *, const void *)){
+		       int (*cmp_wt)(const void *, const void *),
+		       tsp_stats_t *stats){
   const char *p = NULL, *p_start = NULL, *p_end = NULL;
   size_t wt_size = a->wt_size;
   size_t set_size = prev_s->elt_size;
@@ -238,8 +338,9 @@ static void build_next(const adj_lst_t *a,
     tht->remove(tht->ht, prev_set, prev_wt);
     u = prev_set[0];
     p_start = a->vt_wts[u]->elts;
-    p_end = p_start + a->vt_wts[u]->num_elts * a->step_size;
-    for (p = p_start; p != p_end; p += a->step_size){
+    p_end = p_start + a->vt_wts[u]->num_elts * a->pair_size;
+    if (stats != NULL) stats->num_edges += a->vt_wts[u]->num_elts;
+    for (p = p_start; p != p_end; p += a->pair_size){
       v = *(const size_t *)p;
       set_init(&ibit, v);
       if (set_member(&ibit, &prev_set[1]) == NULL){
@@ -308,11 +409,12 @@ static void ht_def_init(ht_def_t *ht,
   ht->key_size = key_size;
   ht->elt_size = elt_size;
   ht->num_vts = c->num_vts;
-  ht->key_present = calloc_perror(mul_sz_perror(c->num_vts,
-						pow_two(c->num_vts)),
-				  sizeof(boolean_t));
-  ht->elts = malloc_perror(mul_sz_perror(c->num_vts, pow_two(c->num_vts)),
-			   elt_size);
+  ht->key_present = DEF_CALLOC(mul_sz_perror(c->num_vts,
+					     pow_two(c->num_vts)),
+			       sizeof(boolean_t));
+  ht->elts = DEF_MALLOC(mul_sz_perror(c->num_vts,
+				      pow_two(c->num_vts)),
+			elt_size);
   ht->free_elt = free_elt;
 }
 
@@ -350,12 +452,63 @@ static void ht_def_free(ht_def_t *ht){
       }
     }
   }
-  free(ht->key_present);
-  free(ht->elts);
+  DEF_FREE(ht->key_present);
+  DEF_FREE(ht->elts);
   ht->key_present = NULL;
   ht->elts = NULL;
 }
 
+/**
+   Hash table operations that count the calls to a hash table parameter
+   and forward the calls. The hash table parameter is initialized with its
+   own context.
+*/
+
+static void ht_ctr_init(ht_ctr_t *ht,
+			size_t key_size,
+			size_t elt_size,
+			void (*free_elt)(void *),
+			void *context){
+  (void)context;
+  ht->tht->init(ht->tht->ht, key_size, elt_size, free_elt, ht->tht->context);
+}
+
+static void ht_ctr_insert(ht_ctr_t *ht, const void *key, const void *elt){
+  ht->stats->num_ht_inserts++;
+  ht->tht->insert(ht->tht->ht, key, elt);
+}
+
+static void *ht_ctr_search(const ht_ctr_t *ht, const void *key){
+  ht->stats->num_ht_searches++;
+  return ht->tht->search(ht->tht->ht, key);
+}
+
+static void ht_ctr_remove(ht_ctr_t *ht, const void *key, void *elt){
+  ht->stats->num_ht_removes++;
+  ht->tht->remove(ht->tht->ht, key, elt);
+}
+
+static void ht_ctr_free(ht_ctr_t *ht){
+  (ht->tht->free)(ht->tht->ht);
+}
+
+/**
+   Sets the counts and times of a tsp_stats_t block to zero without
+   changing the level_sets and level_secs pointers.
+*/
+static void stats_init(tsp_stats_t *stats){
+  stats->num_levels = 0;
+  stats->num_sets = 0;
+  stats->num_edges = 0;
+  stats->num_ht_inserts = 0;
+  stats->num_ht_searches = 0;
+  stats->num_ht_removes = 0;
+  stats->init_secs = 0.0;
+  stats->levels_secs = 0.0;
+  stats->final_secs = 0.0;
+  stats->free_secs = 0.0;
+}
+
 /**
    Returns the kth power of 2, where 0 <= k < C_SET_ELT_BIT.
 */
@@ -26,6 +26,20 @@
    provide speed advantages by avoiding the computation of hash values. If V
    is larger and the graph is sparse, a non-default hash table may provide
    space advantages.
+
+   The arrays of a default hash table are allocated with calloc_perror and
+   malloc_perror. If TSP_HUGE is defined when tsp.c is compiled, e.g. by
+   "make clean-all && make CPPFLAGS=-DTSP_HUGE", the arrays are allocated
+   with huge_calloc_perror and huge_malloc_perror of utilities-mem, which
+   back large arrays with huge pages where available.
+
+   If a pointer to a tsp_stats_t block is passed, the algorithm counts the
+   reached sets at each level, i.e. the pairs of a last vertex and a set of
+   previous vertices reached by paths with the same number of edges, and
+   its other operations, including the calls to the hash table, and
+   measures the wall-clock time of its phases and levels. If NULL is
+   passed, the operations are not counted and the hash table is called
+   directly.
 */
 
 #ifndef TSP_H  
@@ -54,6 +68,21 @@ typedef struct{
   tsp_ht_free free;
 } tsp_ht_t;
 
+typedef struct{
+  size_t num_levels; /* # built levels */
+  size_t num_sets; /* # reached sets across the built levels */
+  size_t num_edges; /* # scanned edges */
+  size_t num_ht_inserts; /* # calls to the hash table */
+  size_t num_ht_searches;
+  size_t num_ht_removes;
+  size_t *level_sets; /* NULL or # reached sets at level i + 1 at i */
+  double *level_secs; /* NULL or wall-clock time of level i + 1 at i */
+  double init_secs; /* wall-clock time of initialization */
+  double levels_secs; /* wall-clock time of building the levels */
+  double final_secs; /* wall-clock time of the return to start */
+  double free_secs; /* wall-clock time of freeing the hash table */
+} tsp_stats_t;
+
 /**
    Copies to the block pointed to by dist the shortest tour length from 
    start to start across all vertices without revisiting, if a tour exists. 
@@ -84,11 +113,17 @@ typedef struct{
                  the first argument is greater than the weight value 
                  pointed to by the second, and zero integer value if the two
                  weight values are equal
+   stats       : - NULL pointer, if operations are not counted
+                 - a pointer to a tsp_stats_t block, where the counts and
+                 phase times of the run are copied; if level_sets and
+                 level_secs are not NULL, they must point to preallocated
+                 arrays with a count equal to the number of vertices
 */
 int tsp(const adj_lst_t *a,
 	size_t start,
 	void *dist,
 	const tsp_ht_t *tht,
 	void (*add_wt)(void *, const void *, const void *),
-	int (*cmp_wt)(const void *, const void *));
+	int (*cmp_wt)(const void *, const void *),
+	tsp_stats_t *stats);
 #endif
@@ -0,0 +1,322 @@
+/**
+   mergesort-ext-pthread-test.c
+
+   Correctness and performance tests of an external (out-of-core) generic
+   merge sort algorithm with parallel run generation under a memory budget.
+
+   The following command line arguments can be used to customize tests:
+   mergesort-ext-pthread-test
+      [0, # bits in size_t - 1) : a
+      [0, # bits in size_t - 1) : b s.t. 2^a <= count <= 2^b
+      [4, # bits in size_t) : c
+      [4, # bits in size_t) : d s.t. 2^c <= memory budget in bytes <= 2^d
+      [0, # bits in size_t) : e s.t. 2^e sort base case bound
+      [1, # bits in size_t) : f s.t. 2^f merge base case bound
+      [0, 1] : int corner test on/off
+      [0, 1] : int performance test on/off
+
+   usage examples:
+   ./mergesort-ext-pthread-test
+   ./mergesort-ext-pthread-test 20 20
+   ./mergesort-ext-pthread-test 24 24 16 26
+   ./mergesort-ext-pthread-test 24 24 16 26 15 15 0 1
+
+   mergesort-ext-pthread-test can be run with any subset of command line
+   arguments in the above-defined order. If the (i + 1)th argument is
+   specified then the ith argument must be specified for i >= 0. Default
+   values are used for the unspecified arguments according to the
+   C_ARGS_DEF array.
+
+   The runtimes are measured with utilities-bench and can be written as
+   csv or json records by setting BENCH_FORMAT and BENCH_OUT, e.g.
+   BENCH_FORMAT=json BENCH_OUT=mergesort-ext-pthread.json ./mergesort-ext-pthread-test 20 20
+
+   The implementation of tests does not use stdint.h and is portable under
+   C89/C90 with the requirements that CHAR_BIT * sizeof(size_t) is even and
+   pthreads API is available.
+*/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include "mergesort-ext-pthread.h"
+#include "utilities-bench.h"
+#include "utilities-mem.h"
+#include "utilities-mod.h"
+
+/**
+   Generate random numbers in a portable way for test purposes only; rand()
+   in the Linux C Library uses the same generator as random(), which may not
+   be the case on older rand() implementations, and on current
+   implementations on different systems.
+*/
+#ifdef TEST_SEED
+#define RGENS_SEED() do{srand(TEST_SEED);}while (0)
+#else
+#define RGENS_SEED() do{srand(time(NULL));}while (0)
+#endif
+#define RANDOM() (rand()) /* [0, RAND_MAX] */
+#define DRAND() ((double)rand() / RAND_MAX) /* [0.0, 1.0] */
+
+#define TOLU(i) ((unsigned long int)(i)) /* printing size_t under C89/C90 */
+
+/* input handling */
+const char *C_USAGE =
+  "mergesort-ext-pthread-test \n"
+  "[0, # bits in size_t - 1) : a \n"
+  "[0, # bits in size_t - 1) : b s.t. 2^a <= count <= 2^b \n"
+  "[4, # bits in size_t) : c \n"
+  "[4, # bits in size_t) : d s.t. 2^c <= memory budget in bytes <= 2^d \n"
+  "[0, # bits in size_t) : e s.t. 2^e sort base case bound \n"
+  "[1, # bits in size_t) : f s.t. 2^f merge base case bound \n"
+  "[0, 1] : int corner test on/off \n"
+  "[0, 1] : int performance test on/off \n";
+const int C_ARGC_MAX = 9;
+const size_t C_ARGS_DEF[8] = {20, 20, 18, 22, 15, 15, 1, 1};
+const size_t C_FULL_BIT = CHAR_BIT * sizeof(size_t);
+const double C_MB = 1048576.0;
+
+/* tests */
+const char *C_SUITE = "mergesort-ext-pthread-test";
+
+/* corner cases */
+const size_t C_CORNER_COUNT_MAX = 67;
+const size_t C_CORNER_MEM_COUNT_START = 4;
+const size_t C_CORNER_MEM_COUNT_END = 19;
+const size_t C_CORNER_SBASE = 2;
+const size_t C_CORNER_MBASE = 2;
+const double C_HALF_PROB = 0.5;
+
+/* performance tests */
+const size_t C_TRIALS = 3;
+
+int cmp_int(const void *a, const void *b);
+int sort_file(FILE *in,
+	      FILE *out,
+	      const int *arr,
+	      int *sorted,
+	      size_t count,
+	      size_t mem_size,
+	      size_t sbase,
+	      size_t mbase,
+	      bench_t *b);
+void print_test_result(int res);
+
+int cmp_int(const void *a, const void *b){
+  if (*(int *)a > *(int *)b){
+    return 1;
+  }else if  (*(int *)a < *(int *)b){
+    return -1;
+  }else{
+    return 0;
+  }
+}
+
+/**
+   Writes an array to an input stream, sorts the stream into an output
+   stream, reads the output stream into the sorted array, and returns 1 if
+   the sorted array is equal to the qsort-sorted copy of the input array.
+   Otherwise returns 0. If b is not NULL, the sort is timed as a
+   repetition of the benchmark pointed to by b.
+*/
+int sort_file(FILE *in,
+	      FILE *out,
+	      const int *arr,
+	      int *sorted,
+	      size_t count,
+	      size_t mem_size,
+	      size_t sbase,
+	      size_t mbase,
+	      bench_t *b){
+  int res = 1;
+  int *arr_q = NULL;
+  size_t elt_size = sizeof(int);
+  size_t i;
+  arr_q = malloc_perror(count + 1, elt_size);
+  memcpy(arr_q, arr, count * elt_size);
+  qsort(arr_q, count, elt_size, cmp_int);
+  rewind(in);
+  rewind(out);
+  res *= (fwrite(arr, elt_size, count, in) == count);
+  res *= (fflush(in) == 0 && ftruncate(fileno(in), count * elt_size) == 0);
+  res *= (ftruncate(fileno(out), 0) == 0);
+  rewind(in);
+  if (b != NULL) bench_start(b);
+  mergesort_ext_pthread(in, out, elt_size, mem_size, sbase, mbase, cmp_int);
+  fflush(out);
+  if (b != NULL) bench_stop(b);
+  rewind(out);
+  res *= (fread(sorted, elt_size, count + 1, out) == count);
+  for (i = 0; i < count; i++){
+    res *= (sorted[i] == arr_q[i]);
+  }
+  free(arr_q);
+  arr_q = NULL;
+  return res;
+}
+
+/**
+   Runs a mergesort_ext_pthread corner cases test on random integer arrays
+   across counts and memory budgets of a few elements, resulting in
+   multiple merge passes with the minimal fan-in.
+*/
+void run_int_corner_test(){
+  int res = 1;
+  int *arr = NULL, *sorted = NULL;
+  size_t count, mem_count;
+  size_t i;
+  size_t elt_size =  sizeof(int);
+  FILE *in = NULL, *out = NULL;
+  arr =  malloc_perror(C_CORNER_COUNT_MAX, elt_size);
+  sorted =  malloc_perror(C_CORNER_COUNT_MAX + 1, elt_size);
+  in = tmpfile();
+  out = tmpfile();
+  printf("Test mergesort_ext_pthread on corner cases on random "
+	 "integer arrays\n");
+  for (count = 0; count <= C_CORNER_COUNT_MAX; count++){
+    for (mem_count = C_CORNER_MEM_COUNT_START;
+	 mem_count <= C_CORNER_MEM_COUNT_END;
+	 mem_count++){
+      for (i = 0; i < count; i++){
+	arr[i] = (DRAND() < C_HALF_PROB ? -1 : 1) * RANDOM();
+      }
+      res *= sort_file(in,
+		       out,
+		       arr,
+		       sorted,
+		       count,
+		       mem_count * elt_size,
+		       C_CORNER_SBASE,
+		       C_CORNER_MBASE,
+		       NULL);
+    }
+  }
+  printf("\tcorrectness:       ");
+  print_test_result(res);
+  fclose(in);
+  fclose(out);
+  free(arr);
+  free(sorted);
+  arr = NULL;
+  sorted = NULL;
+}
+
+/**
+   Runs a test of mergesort_ext_pthread performance on random integer
+   arrays across memory budgets, and reports the sustained throughput
+   as the number of sorted MB per second.
+*/
+void run_int_perf_test(int pow_count_start,
+		       int pow_count_end,
+		       int pow_mem_start,
+		       int pow_mem_end,
+		       size_t sbase,
+		       size_t mbase){
+  int res = 1;
+  int *arr = NULL, *sorted = NULL;
+  int ci, mi;
+  size_t count, mem_size;
+  size_t i, j;
+  size_t elt_size = sizeof(int);
+  char params[64];
+  bench_t b;
+  bench_summary_t wall;
+  FILE *in = NULL, *out = NULL;
+  arr =  malloc_perror(pow_two(pow_count_end), elt_size);
+  sorted =  malloc_perror(pow_two(pow_count_end) + 1, elt_size);
+  in = tmpfile();
+  out = tmpfile();
+  printf("Test mergesort_ext_pthread performance on random integer "
+	 "arrays\n");
+  for (ci = pow_count_start; ci <= pow_count_end; ci++){
+    count = pow_two(ci); /* > 0 */
+    printf("\t# trials: %lu, array count: %lu, data size: %.2f MB\n",
+	   TOLU(C_TRIALS), TOLU(count), count * elt_size / C_MB);
+    for (mi = pow_mem_start; mi <= pow_mem_end; mi++){
+      mem_size = pow_two(mi);
+      printf("\t\tmemory budget: %lu bytes\n", TOLU(mem_size));
+      bench_init(&b, C_SUITE, "mergesort_ext_pthread", 0, C_TRIALS);
+      for (i = 0; i < C_TRIALS; i++){
+	for (j = 0; j < count; j++){
+	  arr[j] = (DRAND() < C_HALF_PROB ? -1 : 1) * RANDOM();
+	}
+	res *= sort_file(in,
+			 out,
+			 arr,
+			 sorted,
+			 count,
+			 mem_size,
+			 sbase,
+			 mbase,
+			 &b);
+      }
+      sprintf(params, "n=%lu mem=%lu", TOLU(count), TOLU(mem_size));
+      bench_report(&b, "\t\t\truntime:         ", params);
+      bench_summarize(&b, &wall, NULL, NULL);
+      printf("\t\t\tthroughput:      %.2f MB/s\n",
+	     count * elt_size / C_MB / wall.med);
+      bench_free(&b);
+      printf("\t\t\tcorrectness:     ");
+      print_test_result(res);
+    }
+  }
+  fclose(in);
+  fclose(out);
+  free(arr);
+  free(sorted);
+  arr = NULL;
+  sorted = NULL;
+}
+
+void print_test_result(int res){
+  if (res){
+    printf("SUCCESS\n");
+  }else{
+    printf("FAILURE\n");
+  }
+}
+
+int main(int argc, char *argv[]){
+  int i;
+  size_t *args = NULL;
+  RGENS_SEED();
+  if (argc > C_ARGC_MAX){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  args = malloc_perror(C_ARGC_MAX - 1, sizeof(size_t));
+  memcpy(args, C_ARGS_DEF, (C_ARGC_MAX - 1) * sizeof(size_t));
+  for (i = 1; i < argc; i++){
+    args[i - 1] = atoi(argv[i]);
+  }
+  if (args[0] > C_FULL_BIT - 2 ||
+      args[1] > C_FULL_BIT - 2 ||
+      args[2] > C_FULL_BIT - 1 ||
+      args[3] > C_FULL_BIT - 1 ||
+      args[4] > C_FULL_BIT - 1 ||
+      args[5] > C_FULL_BIT - 1 ||
+      args[2] < 4 ||
+      args[5] < 1 ||
+      args[0] > args[1] ||
+      args[2] > args[3] ||
+      args[6] > 1 ||
+      args[7] > 1){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  if (args[6]) run_int_corner_test();
+  if (args[7]) run_int_perf_test(args[0],
+				 args[1],
+				 args[2],
+				 args[3],
+				 pow_two(args[4]),
+				 pow_two(args[5]));
+  free(args);
+  args = NULL;
+  return 0;
+}
@@ -0,0 +1,382 @@
+/**
+   mergesort-ext-pthread.c
+
+   Functions for running an external (out-of-core) generic merge sort
+   algorithm under a memory budget.
+
+   The algorithm proceeds in two phases. In the run generation phase, the
+   input is read in blocks that fit into the memory budget, each block is
+   sorted with mergesort_pthread with parallel sorting and parallel
+   merging, and the resulting sorted run is written to a temporary file.
+   In the merge phase, at most a fan-in number of runs are merged at a time
+   with a loser tree over buffered run readers, and the passes are repeated
+   until a single run is written to the output file. All temporary data is
+   kept in two temporary files, which are removed when the sort returns.
+
+   The memory budget bounds the total size of the element buffers used in
+   each phase. In the run generation phase, half of the budget holds a run
+   and the other half holds the concatenation buffer of mergesort_pthread.
+   In the merge phase, the budget is divided among the run buffers and the
+   output buffer.
+
+   A loser tree was selected over a heap of run heads, because replacing the
+   winner requires a single leaf-to-root pass with one comparison per level,
+   and ties are resolved by run index, which preserves the order of equal
+   elements across runs.
+*/
+
+#define _POSIX_C_SOURCE 200112L
+#define _FILE_OFFSET_BITS 64
+
+#define UTILITIES_MEM_TAG MEM_TAG_SORT
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include "mergesort-ext-pthread.h"
+#include "mergesort-pthread.h"
+#include "utilities-mem.h"
+
+typedef struct{
+  size_t pos; /* index of the next element of the run in the source file */
+  size_t rem; /* number of elements of the run not yet read into buf */
+  size_t num; /* number of elements in buf */
+  size_t ix; /* index of the head element in buf */
+  void *buf;
+} reader_t;
+
+typedef struct{
+  size_t num_rds;
+  size_t buf_count; /* count of each run buffer */
+  size_t mem_count; /* count of all buffers, output buffer is last */
+  size_t elt_size;
+  size_t *tree; /* tree[0] is the winner, tree[1..num_rds - 1] are losers */
+  size_t *wins; /* 2 * num_rds block used for building the tree */
+  void *bufs;
+  reader_t *rds;
+  FILE *src;
+  int (*cmp)(const void *, const void *);
+} merge_t;
+
+static const size_t C_MIN_FAN_IN = 2;
+
+static size_t gen_runs(FILE *in,
+		       FILE *dst,
+		       size_t **run_counts,
+		       size_t elt_size,
+		       size_t run_count,
+		       size_t sbase_count,
+		       size_t mbase_count,
+		       int (*cmp)(const void *, const void *));
+static void merge_runs(merge_t *m,
+		       FILE *dst,
+		       size_t start,
+		       const size_t *counts);
+static void tree_build(merge_t *m);
+static void tree_replay(merge_t *m);
+static int beats(const merge_t *m, size_t i, size_t j);
+static int refill(merge_t *m, reader_t *rd);
+static size_t fread_perror(void *buf, size_t size, size_t count, FILE *f);
+static void fwrite_perror(const void *buf, size_t size, size_t count, FILE *f);
+static void fseeko_perror(FILE *f, size_t ix, size_t elt_size);
+static FILE *tmpfile_perror(void);
+static void *elt_ptr(const void *elts, size_t i, size_t elt_size);
+
+/**
+   Sorts the elements in a binary input stream in ascending order according
+   to cmp and writes the sorted elements to a binary output stream. The
+   input is read from its current position until the end of the stream.
+   The program exits with an error message if an I/O operation fails or if
+   the number of read bytes is not a multiple of elt_size.
+   in          : pointer to a stream opened for binary reading
+   out         : pointer to a stream opened for binary writing
+   elt_size    : size of each element in the input stream in bytes
+   mem_size    : >= 4 * elt_size memory budget in bytes for element buffers
+   sbase_count : > 0 base case upper bound for parallel sorting in
+                 mergesort_pthread during run generation
+   mbase_count : > 1 base case upper bound for parallel merging in
+                 mergesort_pthread during run generation
+   cmp         : comparison function which returns a negative integer value
+                 if the element pointed to by the first argument is less than
+                 the element pointed to by the second, a positive integer
+                 value if the element pointed to by the first argument is
+                 greater than the element pointed to by the second, and zero
+                 integer value if the two elements are equal
+*/
+void mergesort_ext_pthread(FILE *in,
+			   FILE *out,
+			   size_t elt_size,
+			   size_t mem_size,
+			   size_t sbase_count,
+			   size_t mbase_count,
+			   int (*cmp)(const void *, const void *)){
+  size_t mem_count = mem_size / elt_size; /* >= 4 */
+  size_t fan_in, num_runs, num_next, num_grp;
+  size_t start, i, j;
+  size_t *run_counts = NULL;
+  FILE *src = NULL, *dst = NULL, *tmp = NULL;
+  merge_t m;
+  src = tmpfile_perror();
+  num_runs = gen_runs(in,
+		      src,
+		      &run_counts,
+		      elt_size,
+		      mem_count / 2,
+		      sbase_count,
+		      mbase_count,
+		      cmp);
+  fan_in = mem_size / MERGESORT_EXT_PTHREAD_MIN_BUF_SIZE;
+  fan_in = (fan_in > C_MIN_FAN_IN + 1) ? fan_in - 1 : C_MIN_FAN_IN;
+  if (fan_in > mem_count - 1) fan_in = mem_count - 1; /* buf_count >= 1 */
+  m.mem_count = mem_count;
+  m.elt_size = elt_size;
+  m.tree = malloc_perror(fan_in, sizeof(size_t));
+  m.wins = malloc_perror(2 * fan_in, sizeof(size_t));
+  m.bufs = malloc_perror(mem_count, elt_size);
+  m.rds = malloc_perror(fan_in, sizeof(reader_t));
+  m.cmp = cmp;
+  if (num_runs > fan_in) dst = tmpfile_perror();
+  while (num_runs > 0){
+    if (num_runs <= fan_in){
+      if (dst != NULL) fclose(dst);
+      dst = out;
+    }else{
+      rewind(dst);
+    }
+    m.src = src;
+    start = 0;
+    num_next = 0;
+    for (i = 0; i < num_runs; i += num_grp){
+      num_grp = (num_runs - i < fan_in) ? num_runs - i : fan_in;
+      m.num_rds = num_grp;
+      m.buf_count = mem_count / (num_grp + 1);
+      merge_runs(&m, dst, start, &run_counts[i]);
+      /* the run counts of the next pass replace the merged run counts */
+      run_counts[num_next] = run_counts[i];
+      for (j = 1; j < num_grp; j++){
+	run_counts[num_next] += run_counts[i + j];
+      }
+      start += run_counts[num_next];
+      num_next++;
+    }
+    if (dst == out) break;
+    tmp = src;
+    src = dst;
+    dst = tmp;
+    num_runs = num_next;
+  }
+  fclose(src);
+  free(run_counts);
+  free(m.tree);
+  free(m.wins);
+  free(m.bufs);
+  free(m.rds);
+  run_counts = NULL;
+  m.tree = NULL;
+  m.wins = NULL;
+  m.bufs = NULL;
+  m.rds = NULL;
+}
+
+/**
+   Reads the input stream in blocks of run_count elements, sorts each block
+   with mergesort_pthread, and writes each sorted block as a run to dst.
+   Allocates and updates an array of run counts pointed to by the pointer
+   pointed to by run_counts. Returns the number of runs.
+*/
+static size_t gen_runs(FILE *in,
+		       FILE *dst,
+		       size_t **run_counts,
+		       size_t elt_size,
+		       size_t run_count,
+		       size_t sbase_count,
+		       size_t mbase_count,
+		       int (*cmp)(const void *, const void *)){
+  size_t num_runs = 0, count_max = 1;
+  size_t num;
+  void *run = malloc_perror(run_count, elt_size);
+  *run_counts = malloc_perror(count_max, sizeof(size_t));
+  while ((num = fread_perror(run, elt_size, run_count, in)) > 0){
+    mergesort_pthread(run, num, elt_size, sbase_count, mbase_count, cmp);
+    fwrite_perror(run, elt_size, num, dst);
+    if (num_runs == count_max){
+      count_max = mul_sz_perror(2, count_max);
+      *run_counts = realloc_perror(*run_counts, count_max, sizeof(size_t));
+    }
+    (*run_counts)[num_runs] = num;
+    num_runs++;
+    if (num < run_count) break;
+  }
+  free(run);
+  run = NULL;
+  return num_runs;
+}
+
+/**
+   Merges m->num_rds consecutive runs in the source file, starting at the
+   element index start, with a loser tree, and writes the merged run to
+   dst through the output buffer that follows the run buffers.
+*/
+static void merge_runs(merge_t *m,
+		       FILE *dst,
+		       size_t start,
+		       const size_t *counts){
+  size_t out_count = m->mem_count - m->num_rds * m->buf_count;
+  size_t num_out = 0;
+  size_t i;
+  void *out_buf = elt_ptr(m->bufs, m->num_rds * m->buf_count, m->elt_size);
+  reader_t *rd = NULL;
+  for (i = 0; i < m->num_rds; i++){
+    rd = &m->rds[i];
+    rd->pos = start;
+    rd->rem = counts[i];
+    rd->buf = elt_ptr(m->bufs, i * m->buf_count, m->elt_size);
+    refill(m, rd);
+    start += counts[i];
+  }
+  tree_build(m);
+  while (m->rds[m->tree[0]].ix < m->rds[m->tree[0]].num){
+    rd = &m->rds[m->tree[0]];
+    memcpy(elt_ptr(out_buf, num_out, m->elt_size),
+	   elt_ptr(rd->buf, rd->ix, m->elt_size),
+	   m->elt_size);
+    num_out++;
+    if (num_out == out_count){
+      fwrite_perror(out_buf, m->elt_size, num_out, dst);
+      num_out = 0;
+    }
+    rd->ix++;
+    if (rd->ix == rd->num) refill(m, rd);
+    tree_replay(m);
+  }
+  fwrite_perror(out_buf, m->elt_size, num_out, dst);
+}
+
+/**
+   Builds a loser tree bottom-up, where the leaf of the ith reader is the
+   node num_rds + i, the parent of the node j is the node j / 2, and the
+   winner of the tree is placed at the root index 0.
+*/
+static void tree_build(merge_t *m){
+  size_t n = m->num_rds;
+  size_t j;
+  for (j = 0; j < n; j++){
+    m->wins[n + j] = j;
+  }
+  for (j = n - 1; j > 0; j--){
+    if (beats(m, m->wins[2 * j], m->wins[2 * j + 1])){
+      m->wins[j] = m->wins[2 * j];
+      m->tree[j] = m->wins[2 * j + 1];
+    }else{
+      m->wins[j] = m->wins[2 * j + 1];
+      m->tree[j] = m->wins[2 * j];
+    }
+  }
+  m->tree[0] = (n == 1) ? 0 : m->wins[1];
+}
+
+/**
+   Replays the matches on the path from the leaf of the last winner to the
+   root, after the head element of the last winner was replaced.
+*/
+static void tree_replay(merge_t *m){
+  size_t w = m->tree[0];
+  size_t j, tmp;
+  for (j = (m->num_rds + w) / 2; j > 0; j /= 2){
+    if (beats(m, m->tree[j], w)){
+      tmp = m->tree[j];
+      m->tree[j] = w;
+      w = tmp;
+    }
+  }
+  m->tree[0] = w;
+}
+
+/**
+   Returns 1 if the head element of the ith reader precedes the head element
+   of the jth reader, where an exhausted reader is preceded by every reader
+   and equal elements are ordered by reader index. Otherwise returns 0.
+*/
+static int beats(const merge_t *m, size_t i, size_t j){
+  int c;
+  const reader_t *a = &m->rds[i], *b = &m->rds[j];
+  if (a->ix == a->num) return 0;
+  if (b->ix == b->num) return 1;
+  c = m->cmp(elt_ptr(a->buf, a->ix, m->elt_size),
+	     elt_ptr(b->buf, b->ix, m->elt_size));
+  return (c < 0 || (c == 0 && i < j));
+}
+
+/**
+   Refills the buffer of a reader from the source file. Returns 1 if at
+   least one element was read, otherwise returns 0 and leaves the reader
+   exhausted.
+*/
+static int refill(merge_t *m, reader_t *rd){
+  size_t num = (rd->rem < m->buf_count) ? rd->rem : m->buf_count;
+  rd->ix = 0;
+  rd->num = 0;
+  if (num == 0) return 0;
+  fseeko_perror(m->src, rd->pos, m->elt_size);
+  if (fread_perror(rd->buf, m->elt_size, num, m->src) != num){
+    fprintf(stderr, "mergesort_ext_pthread unexpected end of temporary "
+	    "file\n");
+    exit(EXIT_FAILURE);
+  }
+  rd->pos += num;
+  rd->rem -= num;
+  rd->num = num;
+  return 1;
+}
+
+/**
+   Read, write, seek, and temporary file creation with error checking.
+   fread_perror returns the number of read elements and exits with an error
+   if a partial element is read.
+*/
+
+static size_t fread_perror(void *buf, size_t size, size_t count, FILE *f){
+  size_t n = fread(buf, 1, count * size, f);
+  if (ferror(f)){
+    perror("mergesort_ext_pthread fread failed");
+    exit(EXIT_FAILURE);
+  }
+  if (n % size){
+    fprintf(stderr, "mergesort_ext_pthread input size is not a multiple "
+	    "of elt_size\n");
+    exit(EXIT_FAILURE);
+  }
+  return n / size;
+}
+
+static void fwrite_perror(const void *buf, size_t size, size_t count, FILE *f){
+  if (count > 0 && fwrite(buf, size, count, f) != count){
+    perror("mergesort_ext_pthread fwrite failed");
+    exit(EXIT_FAILURE);
+  }
+}
+
+static void fseeko_perror(FILE *f, size_t ix, size_t elt_size){
+  if (fseeko(f, (off_t)ix * (off_t)elt_size, SEEK_SET) != 0){
+    perror("mergesort_ext_pthread fseeko failed");
+    exit(EXIT_FAILURE);
+  }
+}
+
+static FILE *tmpfile_perror(void){
+  FILE *f = tmpfile();
+  if (f == NULL){
+    perror("mergesort_ext_pthread tmpfile failed");
+    exit(EXIT_FAILURE);
+  }
+  return f;
+}
+
+/**
+   Computes a pointer to an element in an element array.
+*/
+static void *elt_ptr(const void *elts, size_t i, size_t elt_size){
+  return (void *)((char *)elts + i * elt_size);
+}
@@ -0,0 +1,69 @@
+/**
+   mergesort-ext-pthread.h
+
+   Declarations of accessible functions and macro definitions for running
+   an external (out-of-core) generic merge sort algorithm under a memory
+   budget.
+
+   The algorithm proceeds in two phases. In the run generation phase, the
+   input is read in blocks that fit into the memory budget, each block is
+   sorted with mergesort_pthread with parallel sorting and parallel
+   merging, and the resulting sorted run is written to a temporary file.
+   In the merge phase, at most a fan-in number of runs are merged at a time
+   with a loser tree over buffered run readers, and the passes are repeated
+   until a single run is written to the output file. All temporary data is
+   kept in two temporary files, which are removed when the sort returns.
+
+   The memory budget bounds the total size of the element buffers used in
+   each phase. In the run generation phase, half of the budget holds a run
+   and the other half holds the concatenation buffer of mergesort_pthread.
+   In the merge phase, the budget is divided among the run buffers and the
+   output buffer.
+*/
+
+#ifndef MERGESORT_EXT_PTHREAD_H
+#define MERGESORT_EXT_PTHREAD_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+/**
+   Sorts the elements in a binary input stream in ascending order according
+   to cmp and writes the sorted elements to a binary output stream. The
+   input is read from its current position until the end of the stream.
+   The program exits with an error message if an I/O operation fails or if
+   the number of read bytes is not a multiple of elt_size.
+   in          : pointer to a stream opened for binary reading
+   out         : pointer to a stream opened for binary writing
+   elt_size    : size of each element in the input stream in bytes
+   mem_size    : >= 4 * elt_size memory budget in bytes for element buffers
+   sbase_count : > 0 base case upper bound for parallel sorting in
+                 mergesort_pthread during run generation
+   mbase_count : > 1 base case upper bound for parallel merging in
+                 mergesort_pthread during run generation
+   cmp         : comparison function which returns a negative integer value
+                 if the element pointed to by the first argument is less than
+                 the element pointed to by the second, a positive integer
+                 value if the element pointed to by the first argument is
+                 greater than the element pointed to by the second, and zero
+                 integer value if the two elements are equal
+*/
+void mergesort_ext_pthread(FILE *in,
+			   FILE *out,
+			   size_t elt_size,
+			   size_t mem_size,
+			   size_t sbase_count,
+			   size_t mbase_count,
+			   int (*cmp)(const void *, const void *));
+
+/**
+   A constant lower bound in bytes for the size of a run buffer in the merge
+   phase. Sets the fan-in of a merge pass to the largest number of runs,
+   such that each run buffer and the output buffer reach the bound within
+   the memory budget, thereby trading the number of merge passes for the
+   number of bytes read per I/O operation. The fan-in is at least 2.
+   The macro is used as size_t.
+*/
+#define MERGESORT_EXT_PTHREAD_MIN_BUF_SIZE (65536)
+
+#endif
@@ -0,0 +1,395 @@
+/**
+   mergesort-pthread-kernels-test.c
+
+   Correctness and performance tests of typed serial sort and merge
+   kernels, and of mergesort_pthread with typed kernels vs. generic
+   routines, on int, long, unsigned long and double arrays. The corner
+   case tests are run at each level of the kernels of utilities-cpu that
+   is available, and the performance tests at the level of cpu_init,
+   which can be lowered with the CPU_LEVEL environment variable.
+
+   The following command line arguments can be used to customize tests:
+   mergesort-pthread-kernels-test
+      [0, # bits in size_t - 1) : a
+      [0, # bits in size_t - 1) : b s.t. 2^a <= count <= 2^b
+      [0, # bits in size_t) : c s.t. 2^c sort base case bound
+      [1, # bits in size_t) : d s.t. 2^d merge base case bound
+      [0, 1] : corner tests on/off
+      [0, 1] : performance tests on/off
+
+   usage examples:
+   ./mergesort-pthread-kernels-test
+   ./mergesort-pthread-kernels-test
+   ./mergesort-pthread-kernels-test 20 24 15 15
+   ./mergesort-pthread-kernels-test 20 24 15 15 0 1
+   CPU_LEVEL=portable ./mergesort-pthread-kernels-test 20 24 15 15 0 1
+
+   mergesort-pthread-kernels-test can be run with any subset of command
+   line arguments in the above-defined order. If the (i + 1)th argument is
+   specified then the ith argument must be specified for i >= 0. Default
+   values are used for the unspecified arguments according to the
+   C_ARGS_DEF array.
+
+   The runtimes are measured with utilities-bench and can be written as
+   csv or json records by setting BENCH_FORMAT and BENCH_OUT, e.g.
+   BENCH_FORMAT=json BENCH_OUT=mergesort-pthread-kernels.json ./mergesort-pthread-kernels-test
+
+   The implementation of tests does not use stdint.h and is portable under
+   C89/C90 with the requirements that CHAR_BIT * sizeof(size_t) is even and
+   pthreads API is available.
+*/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include "mergesort-pthread.h"
+#include "mergesort-pthread-kernels.h"
+#include "utilities-cpu.h"
+#include "utilities-bench.h"
+#include "utilities-mem.h"
+#include "utilities-mod.h"
+
+/**
+   Generate random numbers in a portable way for test purposes only; rand()
+   in the Linux C Library uses the same generator as random(), which may not
+   be the case on older rand() implementations, and on current
+   implementations on different systems.
+*/
+#ifdef TEST_SEED
+#define RGENS_SEED() do{srand(TEST_SEED);}while (0)
+#else
+#define RGENS_SEED() do{srand(time(NULL));}while (0)
+#endif
+#define RANDOM() (rand()) /* [0, RAND_MAX] */
+#define DRAND() ((double)rand() / RAND_MAX) /* [0.0, 1.0] */
+
+#define TOLU(i) ((unsigned long int)(i)) /* printing size_t under C89/C90 */
+
+/* input handling */
+const char *C_USAGE =
+  "mergesort-pthread-kernels-test \n"
+  "[0, # bits in size_t - 1) : a \n"
+  "[0, # bits in size_t - 1) : b s.t. 2^a <= count <= 2^b \n"
+  "[0, # bits in size_t) : c s.t. 2^c sort base case bound \n"
+  "[1, # bits in size_t) : d s.t. 2^d merge base case bound \n"
+  "[0, 1] : corner tests on/off \n"
+  "[0, 1] : performance tests on/off \n";
+const int C_ARGC_MAX = 7;
+const size_t C_ARGS_DEF[6] = {18, 20, 15, 15, 1, 1};
+const size_t C_FULL_BIT = CHAR_BIT * sizeof(size_t);
+
+/* tests */
+const char *C_SUITE = "mergesort-pthread-kernels-test";
+
+/* corner cases */
+const size_t C_CORNER_TRIALS = 10;
+const size_t C_CORNER_COUNT_MAX = 70;
+const size_t C_CORNER_MERGE_COUNT_MAX = 20;
+const size_t C_CORNER_BASE_MAX = 5;
+const int C_CORNER_RANGE = 5; /* values with many duplicates */
+const double C_HALF_PROB = 0.5;
+
+/* performance tests */
+const size_t C_TRIALS = 5;
+
+/* types */
+typedef struct{
+  const char *name;
+  size_t elt_size;
+  int (*cmp)(const void *, const void *); /* enables typed kernels */
+  int (*cmp_gen)(const void *, const void *); /* same order, generic */
+  void (*new_elt)(void *, int);
+} type_t;
+
+int cmp_int(const void *a, const void *b);
+int cmp_long(const void *a, const void *b);
+int cmp_ulong(const void *a, const void *b);
+int cmp_double(const void *a, const void *b);
+void new_int(void *a, int dup);
+void new_long(void *a, int dup);
+void new_ulong(void *a, int dup);
+void new_double(void *a, int dup);
+void print_test_result(int res);
+
+/**
+   Comparison functions with the same order as the comparators of
+   mergesort-pthread-kernels.h, which do not enable typed kernels.
+*/
+
+int cmp_int(const void *a, const void *b){
+  return (*(const int *)a > *(const int *)b) -
+    (*(const int *)a < *(const int *)b);
+}
+
+int cmp_long(const void *a, const void *b){
+  return (*(const long *)a > *(const long *)b) -
+    (*(const long *)a < *(const long *)b);
+}
+
+int cmp_ulong(const void *a, const void *b){
+  return (*(const unsigned long *)a > *(const unsigned long *)b) -
+    (*(const unsigned long *)a < *(const unsigned long *)b);
+}
+
+int cmp_double(const void *a, const void *b){
+  return (*(const double *)a > *(const double *)b) -
+    (*(const double *)a < *(const double *)b);
+}
+
+/**
+   Random element generators. If dup is 1, the values are in a small range
+   with many duplicates.
+*/
+
+void new_int(void *a, int dup){
+  if (dup){
+    *(int *)a = RANDOM() % C_CORNER_RANGE - C_CORNER_RANGE / 2;
+  }else{
+    *(int *)a = (DRAND() < C_HALF_PROB ? -1 : 1) * RANDOM();
+  }
+}
+
+void new_long(void *a, int dup){
+  if (dup){
+    *(long *)a = RANDOM() % C_CORNER_RANGE - C_CORNER_RANGE / 2;
+  }else{
+    *(long *)a = (long)((unsigned long)RANDOM() * RANDOM() + RANDOM());
+  }
+}
+
+void new_ulong(void *a, int dup){
+  if (dup){
+    *(unsigned long *)a = RANDOM() % C_CORNER_RANGE;
+  }else{
+    *(unsigned long *)a = (unsigned long)RANDOM() * RANDOM() * RANDOM();
+  }
+}
+
+void new_double(void *a, int dup){
+  if (dup){
+    *(double *)a = 0.5 * (RANDOM() % C_CORNER_RANGE) - 1.0;
+  }else{
+    *(double *)a = (DRAND() < C_HALF_PROB ? -1 : 1) * DRAND() * RANDOM();
+    if (*(double *)a == 0.0) *(double *)a = 0.0; /* no -0.0 for memcmp */
+  }
+}
+
+const type_t C_TYPES[4] = {
+  {"int", sizeof(int), mergesort_pthread_cmp_int, cmp_int, new_int},
+  {"long", sizeof(long), mergesort_pthread_cmp_long, cmp_long, new_long},
+  {"unsigned long", sizeof(unsigned long),
+   mergesort_pthread_cmp_ulong, cmp_ulong, new_ulong},
+  {"double", sizeof(double),
+   mergesort_pthread_cmp_double, cmp_double, new_double}};
+const size_t C_NUM_TYPES = 4;
+
+/**
+   Runs corner cases tests of the typed kernels and of mergesort_pthread
+   with typed kernels vs. qsort at the level of the kernel table.
+*/
+void run_corner_test(const type_t *tp){
+  int res = 1;
+  size_t count, a_count, b_count, sb, mb, dup;
+  size_t i, j;
+  size_t elt_size = tp->elt_size;
+  void *arr_a = NULL, *arr_b = NULL, *arr_c = NULL;
+  const mergesort_pthread_kernel_t *kernel = NULL;
+  arr_a = malloc_perror(C_CORNER_COUNT_MAX + 1, elt_size);
+  arr_b = malloc_perror(C_CORNER_COUNT_MAX + 1, elt_size);
+  arr_c = malloc_perror(C_CORNER_COUNT_MAX + 1, elt_size);
+  kernel = mergesort_pthread_kernel(elt_size, tp->cmp);
+  printf("Test typed kernels at %s level on corner cases on random %s "
+	 "arrays\n", cpu_level_name(cpu_init()->level), tp->name);
+  res *= (kernel != NULL);
+  res *= (mergesort_pthread_kernel(elt_size, tp->cmp_gen) == NULL);
+  res *= (mergesort_pthread_kernel(elt_size + 1, tp->cmp) == NULL);
+  for (dup = 0; dup <= 1; dup++){
+    for (count = 0; count <= C_CORNER_COUNT_MAX; count++){
+      for (i = 0; i < C_CORNER_TRIALS; i++){
+	for (j = 0; j < count; j++){
+	  tp->new_elt((char *)arr_a + j * elt_size, dup);
+	}
+	memcpy(arr_b, arr_a, count * elt_size);
+	kernel->sort(arr_a, count);
+	qsort(arr_b, count, elt_size, tp->cmp_gen);
+	res *= (memcmp(arr_a, arr_b, count * elt_size) == 0);
+      }
+    }
+    for (a_count = 0; a_count <= C_CORNER_MERGE_COUNT_MAX; a_count++){
+      for (b_count = 0; b_count <= C_CORNER_MERGE_COUNT_MAX; b_count++){
+	count = a_count + b_count;
+	for (j = 0; j < count; j++){
+	  tp->new_elt((char *)arr_a + j * elt_size, dup);
+	}
+	qsort(arr_a, a_count, elt_size, tp->cmp_gen);
+	qsort((char *)arr_a + a_count * elt_size,
+	      b_count,
+	      elt_size,
+	      tp->cmp_gen);
+	kernel->merge(arr_c,
+		      arr_a,
+		      a_count,
+		      (char *)arr_a + a_count * elt_size,
+		      b_count);
+	qsort(arr_a, count, elt_size, tp->cmp_gen);
+	res *= (memcmp(arr_a, arr_c, count * elt_size) == 0);
+      }
+    }
+    for (count = 1; count <= C_CORNER_COUNT_MAX; count++){
+      for (sb = 1; sb <= C_CORNER_BASE_MAX; sb++){
+	for (mb = 2; mb <= C_CORNER_BASE_MAX; mb++){
+	  for (j = 0; j < count; j++){
+	    tp->new_elt((char *)arr_a + j * elt_size, dup);
+	  }
+	  memcpy(arr_b, arr_a, count * elt_size);
+	  mergesort_pthread(arr_a, count, elt_size, sb, mb, tp->cmp);
+	  qsort(arr_b, count, elt_size, tp->cmp_gen);
+	  res *= (memcmp(arr_a, arr_b, count * elt_size) == 0);
+	}
+      }
+    }
+  }
+  printf("\tcorrectness:       ");
+  print_test_result(res);
+  free(arr_a);
+  free(arr_b);
+  free(arr_c);
+  arr_a = NULL;
+  arr_b = NULL;
+  arr_c = NULL;
+}
+
+/**
+   Runs a test comparing mergesort_pthread with typed kernels vs.
+   mergesort_pthread with generic routines vs. qsort performance on random
+   arrays.
+*/
+void run_perf_test(const type_t *tp,
+		   int pow_count_start,
+		   int pow_count_end,
+		   size_t sbase,
+		   size_t mbase){
+  int res = 1;
+  int ci;
+  size_t count;
+  size_t i, j;
+  size_t elt_size = tp->elt_size;
+  char params[64];
+  bench_t b_k, b_g, b_q;
+  void *arr_a = NULL, *arr_b = NULL, *arr_c = NULL;
+  arr_a = malloc_perror(pow_two(pow_count_end), elt_size);
+  arr_b = malloc_perror(pow_two(pow_count_end), elt_size);
+  arr_c = malloc_perror(pow_two(pow_count_end), elt_size);
+  printf("Test mergesort_pthread performance with typed kernels at %s "
+	 "level on random %s arrays\n",
+	 cpu_level_name(cpu_init()->level), tp->name);
+  printf("\tsort base count: %lu, merge base count: %lu\n",
+	 TOLU(sbase), TOLU(mbase));
+  for (ci = pow_count_start; ci <= pow_count_end; ci++){
+    count = pow_two(ci); /* > 0 */
+    bench_init(&b_k, C_SUITE, "mergesort_pthread typed", 0, C_TRIALS);
+    bench_init(&b_g, C_SUITE, "mergesort_pthread generic", 0, C_TRIALS);
+    bench_init(&b_q, C_SUITE, "qsort", 0, C_TRIALS);
+    for (i = 0; i < C_TRIALS; i++){
+      for (j = 0; j < count; j++){
+	tp->new_elt((char *)arr_a + j * elt_size, 0);
+      }
+      memcpy(arr_b, arr_a, count * elt_size);
+      memcpy(arr_c, arr_a, count * elt_size);
+      bench_start(&b_k);
+      mergesort_pthread(arr_a, count, elt_size, sbase, mbase, tp->cmp);
+      bench_stop(&b_k);
+      bench_start(&b_g);
+      mergesort_pthread(arr_b, count, elt_size, sbase, mbase, tp->cmp_gen);
+      bench_stop(&b_g);
+      bench_start(&b_q);
+      qsort(arr_c, count, elt_size, tp->cmp_gen);
+      bench_stop(&b_q);
+      res *= (memcmp(arr_a, arr_c, count * elt_size) == 0);
+      res *= (memcmp(arr_b, arr_c, count * elt_size) == 0);
+    }
+    printf("\t# trials: %lu, array count: %lu\n",
+	   TOLU(C_TRIALS), TOLU(count));
+    sprintf(params,
+	    "n=%lu level=%s type=%s",
+	    TOLU(count),
+	    cpu_level_name(cpu_init()->level),
+	    tp->name);
+    bench_report(&b_k, "\t\tpthread mergesort typed:   ", params);
+    bench_report(&b_g, "\t\tpthread mergesort generic: ", params);
+    bench_report(&b_q, "\t\tqsort:                     ", params);
+    bench_free(&b_k);
+    bench_free(&b_g);
+    bench_free(&b_q);
+    printf("\t\tcorrectness:                   ");
+    print_test_result(res);
+  }
+  free(arr_a);
+  free(arr_b);
+  free(arr_c);
+  arr_a = NULL;
+  arr_b = NULL;
+  arr_c = NULL;
+}
+
+void print_test_result(int res){
+  if (res){
+    printf("SUCCESS\n");
+  }else{
+    printf("FAILURE\n");
+  }
+}
+
+int main(int argc, char *argv[]){
+  int i, level;
+  size_t ti;
+  cpu_level_t init_level;
+  size_t *args = NULL;
+  RGENS_SEED();
+  if (argc > C_ARGC_MAX){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  args = malloc_perror(C_ARGC_MAX - 1, sizeof(size_t));
+  memcpy(args, C_ARGS_DEF, (C_ARGC_MAX - 1) * sizeof(size_t));
+  for (i = 1; i < argc; i++){
+    args[i - 1] = atoi(argv[i]);
+  }
+  if (args[0] > C_FULL_BIT - 2 ||
+      args[1] > C_FULL_BIT - 2 ||
+      args[2] > C_FULL_BIT - 1 ||
+      args[3] > C_FULL_BIT - 1 ||
+      args[3] < 1 ||
+      args[0] > args[1] ||
+      args[4] > 1 ||
+      args[5] > 1){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  init_level = cpu_init()->level;
+  for (level = 0; level < CPU_LEVEL_COUNT && args[4]; level++){
+    if (cpu_force((cpu_level_t)level) == NULL){
+      printf("Skip typed kernels at %s level, not available\n",
+	     cpu_level_name((cpu_level_t)level));
+      continue;
+    }
+    for (ti = 0; ti < C_NUM_TYPES; ti++){
+      run_corner_test(&C_TYPES[ti]);
+    }
+  }
+  cpu_force(init_level);
+  for (ti = 0; ti < C_NUM_TYPES; ti++){
+    if (args[5]) run_perf_test(&C_TYPES[ti],
+			       args[0],
+			       args[1],
+			       pow_two(args[2]),
+			       pow_two(args[3]));
+  }
+  free(args);
+  args = NULL;
+  return 0;
+}
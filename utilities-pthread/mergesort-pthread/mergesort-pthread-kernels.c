@@ -0,0 +1,156 @@
+/**
+   mergesort-pthread-kernels.c
+
+   Functions for typed serial sort and merge kernels used by
+   mergesort_pthread in the base cases of parallel sorting and parallel
+   merging when the elements are of a primitive type.
+
+   A primitive type is recognized by elt_size and a comparator provided by
+   this module. The kernels are the typed sort and merge kernels of the
+   table of utilities-cpu, which is resolved by cpu_init to the portable,
+   AVX2, or AVX-512 level once across threads with pthread_once at the
+   first call of mergesort_pthread_kernel.
+   The implementation is portable under C89/C90 and does not use stdint.h.
+*/
+
+#include <stdlib.h>
+#include "mergesort-pthread-kernels.h"
+#include "utilities-cpu.h"
+#include "utilities-pthread.h"
+
+static const cpu_kernels_t *cpu = NULL;
+static pthread_once_t cpu_once = PTHREAD_ONCE_INIT;
+
+static void cpu_resolve(void);
+
+int mergesort_pthread_cmp_int(const void *a, const void *b){
+  if (*(const int *)a > *(const int *)b){
+    return 1;
+  }else if (*(const int *)a < *(const int *)b){
+    return -1;
+  }else{
+    return 0;
+  }
+}
+
+int mergesort_pthread_cmp_long(const void *a, const void *b){
+  if (*(const long *)a > *(const long *)b){
+    return 1;
+  }else if (*(const long *)a < *(const long *)b){
+    return -1;
+  }else{
+    return 0;
+  }
+}
+
+int mergesort_pthread_cmp_ulong(const void *a, const void *b){
+  if (*(const unsigned long *)a > *(const unsigned long *)b){
+    return 1;
+  }else if (*(const unsigned long *)a < *(const unsigned long *)b){
+    return -1;
+  }else{
+    return 0;
+  }
+}
+
+int mergesort_pthread_cmp_double(const void *a, const void *b){
+  if (*(const double *)a > *(const double *)b){
+    return 1;
+  }else if (*(const double *)a < *(const double *)b){
+    return -1;
+  }else{
+    return 0;
+  }
+}
+
+/**
+   Calls the typed kernels of the resolved table.
+*/
+
+static void sort_int(void *elts, size_t count){
+  cpu->sort_int(elts, count);
+}
+
+static void sort_long(void *elts, size_t count){
+  cpu->sort_long(elts, count);
+}
+
+static void sort_ulong(void *elts, size_t count){
+  cpu->sort_ulong(elts, count);
+}
+
+static void sort_double(void *elts, size_t count){
+  cpu->sort_double(elts, count);
+}
+
+static void merge_int(void *cat_elts,
+		      const void *a_elts,
+		      size_t a_count,
+		      const void *b_elts,
+		      size_t b_count){
+  cpu->merge_int(cat_elts, a_elts, a_count, b_elts, b_count);
+}
+
+static void merge_long(void *cat_elts,
+		       const void *a_elts,
+		       size_t a_count,
+		       const void *b_elts,
+		       size_t b_count){
+  cpu->merge_long(cat_elts, a_elts, a_count, b_elts, b_count);
+}
+
+static void merge_ulong(void *cat_elts,
+			const void *a_elts,
+			size_t a_count,
+			const void *b_elts,
+			size_t b_count){
+  cpu->merge_ulong(cat_elts, a_elts, a_count, b_elts, b_count);
+}
+
+static void merge_double(void *cat_elts,
+			 const void *a_elts,
+			 size_t a_count,
+			 const void *b_elts,
+			 size_t b_count){
+  cpu->merge_double(cat_elts, a_elts, a_count, b_elts, b_count);
+}
+
+static const mergesort_pthread_kernel_t C_KERNEL_INT = {sort_int,
+							 merge_int};
+static const mergesort_pthread_kernel_t C_KERNEL_LONG = {sort_long,
+							  merge_long};
+static const mergesort_pthread_kernel_t C_KERNEL_ULONG = {sort_ulong,
+							   merge_ulong};
+static const mergesort_pthread_kernel_t C_KERNEL_DOUBLE = {sort_double,
+							    merge_double};
+
+/**
+   Returns a pointer to the typed kernels for an element size and a
+   comparison function, or NULL if the comparison function is not one of
+   the comparators of this module or the element size does not match the
+   size of its type. The table of utilities-cpu is resolved once across
+   threads at the first call.
+   elt_size    : size of each element in bytes
+   cmp         : comparison function
+*/
+const mergesort_pthread_kernel_t *
+mergesort_pthread_kernel(size_t elt_size,
+			 int (*cmp)(const void *, const void *)){
+  once_perror(&cpu_once, cpu_resolve);
+  if (cmp == mergesort_pthread_cmp_int && elt_size == sizeof(int)){
+    return &C_KERNEL_INT;
+  }else if (cmp == mergesort_pthread_cmp_long && elt_size == sizeof(long)){
+    return &C_KERNEL_LONG;
+  }else if (cmp == mergesort_pthread_cmp_ulong &&
+	    elt_size == sizeof(unsigned long)){
+    return &C_KERNEL_ULONG;
+  }else if (cmp == mergesort_pthread_cmp_double &&
+	    elt_size == sizeof(double)){
+    return &C_KERNEL_DOUBLE;
+  }
+  return NULL;
+}
+
+static void cpu_resolve(void){
+  cpu = cpu_init();
+}
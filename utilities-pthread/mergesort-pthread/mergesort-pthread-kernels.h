@@ -0,0 +1,73 @@
+/**
+   mergesort-pthread-kernels.h
+
+   Declarations of accessible functions for typed serial sort and merge
+   kernels used by mergesort_pthread in the base cases of parallel sorting
+   and parallel merging when the elements are of a primitive type.
+
+   A primitive type is recognized by elt_size and a comparator provided by
+   this module, i.e. if mergesort_pthread is called with cmp equal to
+   mergesort_pthread_cmp_int and elt_size equal to sizeof(int), then the
+   int kernels are used. The kernels compare elements with the < operator
+   of the type and do not call through the comparator. The kernels are the
+   typed sort and merge kernels of utilities-cpu and are selected at
+   runtime according to the features of the processor: the portable merge
+   kernel is branchless and the portable sort kernel is a quicksort with
+   sorting networks and insertion sort for small ranges, and the AVX2 and
+   AVX-512 kernels sort small ranges with bitonic sorting networks in
+   registers and merge a vector at a time with a bitonic merging network.
+   The typed sort kernels are not stable. The result of a kernel is a
+   permutation of the elements that is sorted by the < operator of the
+   type. For int, long, and unsigned long the result is equal to the result
+   of the generic routine, because elements that are not less than each
+   other are identical. For double the order of such elements, e.g. -0.0
+   and 0.0, may differ from the result of the generic routine.
+
+   The kernels are implemented for int, long, unsigned long and double,
+   which correspond to 32-bit and 64-bit keys on common LP64 platforms.
+   The kernel table of utilities-cpu is resolved once across threads with
+   pthread_once at the first call of mergesort_pthread_kernel, so that
+   mergesort_pthread can be called concurrently from its first call.
+*/
+
+#ifndef MERGESORT_PTHREAD_KERNELS_H
+#define MERGESORT_PTHREAD_KERNELS_H
+
+#include <stddef.h>
+
+typedef struct{
+  void (*sort)(void *elts, size_t count);
+  void (*merge)(void *cat_elts,
+		const void *a_elts,
+		size_t a_count,
+		const void *b_elts,
+		size_t b_count);
+} mergesort_pthread_kernel_t;
+
+/**
+   Comparison functions of primitive types that enable the typed kernels
+   in mergesort_pthread. Each function returns a negative integer value if
+   the element pointed to by the first argument is less than the element
+   pointed to by the second, a positive integer value if the element pointed
+   to by the first argument is greater than the element pointed to by the
+   second, and zero integer value otherwise.
+*/
+int mergesort_pthread_cmp_int(const void *a, const void *b);
+int mergesort_pthread_cmp_long(const void *a, const void *b);
+int mergesort_pthread_cmp_ulong(const void *a, const void *b);
+int mergesort_pthread_cmp_double(const void *a, const void *b);
+
+/**
+   Returns a pointer to the typed kernels for an element size and a
+   comparison function, or NULL if the comparison function is not one of
+   the above-declared functions or the element size does not match the
+   size of its type. The kernel table of utilities-cpu is resolved once
+   across threads at the first call.
+   elt_size    : size of each element in bytes
+   cmp         : comparison function
+*/
+const mergesort_pthread_kernel_t *
+mergesort_pthread_kernel(size_t elt_size,
+			 int (*cmp)(const void *, const void *));
+
+#endif
@@ -2,7 +2,8 @@
    mergesort-pthread-test.c
 
    Optimization and correctness tests of a generic merge sort algorithm with
-   parallel sorting and parallel merging.
+   parallel sorting and parallel merging, and of a parallel k-way merge of
+   sorted runs.
 
    The following command line arguments can be used to customize tests:
    mergesort-pthread-test
@@ -16,12 +17,15 @@
       [0, 1] : int performance test on/off
       [0, 1] : double corner test on/off
       [0, 1] : double performance test on/off
+      [0, 1] : kmerge corner on/off
+      [0, 1] : kmerge perf on/off
 
    usage examples: 
    ./mergesort-pthread-test
    ./mergesort-pthread-test 17 17
    ./mergesort-pthread-test 20 20 15 20 15 20
-   ./mergesort-pthread-test 20 20 15 20 15 20 0 1 0 1
+   ./mergesort-pthread-test 17 17
+   ./mergesort-pthread-test 24 24 15 15 15 15 0 0 0 0 0 1
 
    mergesort-pthread-test can be run with any subset of command line
    arguments in the above-defined order. If the (i + 1)th argument is
@@ -29,6 +33,10 @@
    values are used for the unspecified arguments according to the
    C_ARGS_DEF array.
 
+   The runtimes are measured with utilities-bench and can be written as
+   csv or json records by setting BENCH_FORMAT and BENCH_OUT, e.g.
+   BENCH_FORMAT=json BENCH_OUT=mergesort-pthread.json ./mergesort-pthread-test 17 17
+
    The implementation of tests does not use stdint.h and is portable under
    C89/C90 with the requirements that CHAR_BIT * sizeof(size_t) is even and
    pthreads API is available.
@@ -42,8 +50,8 @@
 #include <string.h>
 #include <limits.h>
 #include <time.h>
-#include <sys/time.h>
 #include "mergesort-pthread.h"
+#include "utilities-bench.h"
 #include "utilities-mem.h"
 #include "utilities-mod.h"
 
@@ -53,7 +61,11 @@
    be the case on older rand() implementations, and on current
    implementations on different systems.
 */
+#ifdef TEST_SEED
+#define RGENS_SEED() do{srand(TEST_SEED);}while (0)
+#else
 #define RGENS_SEED() do{srand(time(NULL));}while (0)
+#endif
 #define RANDOM() (rand()) /* [0, RAND_MAX] */
 #define DRAND() ((double)rand() / RAND_MAX) /* [0.0, 1.0] */
 
@@ -71,11 +83,16 @@ const char *C_USAGE =
   "[0, 1] : int corner test on/off \n"
   "[0, 1] : int performance test on/off \n"
   "[0, 1] : double corner test on/off \n"
-  "[0, 1] : double performance test on/off \n";
-const int C_ARGC_MAX = 11;
-const size_t C_ARGS_DEF[10] = {15, 15, 10, 15, 10, 15, 1, 1, 1, 1};
+  "[0, 1] : double performance test on/off \n"
+  "[0, 1] : kmerge corner on/off \n"
+  "[0, 1] : kmerge perf on/off \n";
+const int C_ARGC_MAX = 13;
+const size_t C_ARGS_DEF[12] = {15, 15, 10, 15, 10, 15, 1, 1, 1, 1, 1, 1};
 const size_t C_FULL_BIT = CHAR_BIT * sizeof(size_t);
 
+/* tests */
+const char *C_SUITE = "mergesort-pthread-test";
+
 /* corner cases */
 const size_t C_CORNER_TRIALS = 10;
 const size_t C_CORNER_COUNT_MAX = 17;
@@ -85,10 +102,17 @@ const size_t C_CORNER_MBASE_START = 2;
 const size_t C_CORNER_MBASE_END = 20;
 const double C_HALF_PROB = 0.5;
 
+/* k-way merge corner cases */
+const size_t C_KMERGE_CORNER_RUNS_MAX = 9;
+const size_t C_KMERGE_CORNER_COUNT_MAX = 17;
+const size_t C_KMERGE_CORNER_THREADS_MAX = 11;
+const int C_KMERGE_CORNER_RANGE = 5; /* values with many duplicates */
+
 /* performance tests */
 const size_t C_TRIALS = 5;
+const size_t C_KMERGE_LOG_RUNS_END = 6;
+const size_t C_KMERGE_LOG_THREADS_END = 3;
 
-double timer();
 void print_uint_elts(const size_t *a, size_t count);
 void print_test_result(int res);
 
@@ -150,6 +174,46 @@ void run_int_corner_test(){
   arr_b = NULL;
 }
 
+/**
+   Runs a mergesort_pthread_rec corner cases test on random integer arrays
+   with the upper bounds 0, 1, ... for the number of recursive calls on the
+   stack of a thread across trials.
+*/
+void run_int_rec_corner_test(){
+  int res = 1;
+  int *arr_a = NULL, *arr_b = NULL;
+  size_t count, sb, mb;
+  size_t i, j;
+  size_t elt_size =  sizeof(int);
+  arr_a =  malloc_perror(C_CORNER_COUNT_MAX, elt_size);
+  arr_b =  malloc_perror(C_CORNER_COUNT_MAX, elt_size);
+  printf("Test mergesort_pthread_rec on corner cases on random "
+	 "integer arrays\n");
+  for (count = 1; count <= C_CORNER_COUNT_MAX; count++){
+    for (sb = C_CORNER_SBASE_START; sb <= C_CORNER_SBASE_END; sb++){
+      for (mb = C_CORNER_MBASE_START; mb <= C_CORNER_MBASE_END; mb++){
+	for(i = 0; i < C_CORNER_TRIALS; i++){
+	  for (j = 0; j < count; j++){
+	    arr_a[j] = (DRAND() < C_HALF_PROB ? -1 : 1) * RANDOM();
+	  }
+	  memcpy(arr_b, arr_a, count * elt_size);
+	  mergesort_pthread_rec(arr_a, count, elt_size, sb, mb, i, cmp_int);
+	  qsort(arr_b, count, elt_size, cmp_int);
+	  for (j = 0; j < count; j++){
+	    res *= (arr_a[j] == arr_b[j]);
+	  }
+	}
+      }
+    }
+  }
+  printf("\tcorrectness:       ");
+  print_test_result(res);
+  free(arr_a);
+  free(arr_b);
+  arr_a = NULL;
+  arr_b = NULL;
+}
+
 /**
    Runs a test comparing mergesort_pthread vs. qsort performance on random 
    integer arrays across sort and merge base count bounds.
@@ -166,7 +230,8 @@ void run_int_opt_test(int pow_count_start,
   size_t count, sbase, mbase;
   size_t i, j;
   size_t elt_size = sizeof(int);
-  double tot_m, tot_q, t_m, t_q;
+  char params[64];
+  bench_t b_m, b_q;
   arr_a =  malloc_perror(pow_two(pow_count_end), elt_size);
   arr_b =  malloc_perror(pow_two(pow_count_end), elt_size);
   printf("Test mergesort_pthread performance on random integer arrays\n");
@@ -180,29 +245,32 @@ void run_int_opt_test(int pow_count_start,
       for (mi = pow_mbase_start; mi <= pow_mbase_end; mi++){
 	mbase = pow_two(mi);
 	printf("\t\t\tmerge base count: %lu\n", TOLU(mbase));
-	tot_m = 0.0;
-	tot_q = 0.0;
+	bench_init(&b_m, C_SUITE, "int mergesort_pthread", 0, C_TRIALS);
+	bench_init(&b_q, C_SUITE, "int qsort", 0, C_TRIALS);
 	for(i = 0; i < C_TRIALS; i++){
 	  for (j = 0; j < count; j++){
 	    arr_a[j] = (DRAND() < C_HALF_PROB ? -1 : 1) * RANDOM();
 	  }
 	  memcpy(arr_b, arr_a, count * elt_size);
-	  t_m = timer();
+	  bench_start(&b_m);
 	  mergesort_pthread(arr_a, count, elt_size, sbase, mbase, cmp_int);
-	  t_m = timer() - t_m;
-	  t_q = timer();
+	  bench_stop(&b_m);
+	  bench_start(&b_q);
 	  qsort(arr_b, count, elt_size, cmp_int);
-	  t_q = timer() - t_q;
-	  tot_m += t_m;
-	  tot_q += t_q;
+	  bench_stop(&b_q);
 	  for (j = 0; j < count; j++){
 	    res *= (arr_a[j] == arr_b[j]);
 	  }
 	}
-	printf("\t\t\tave pthread mergesort: %.6f seconds\n",
-	       tot_m / C_TRIALS);
-	printf("\t\t\tave qsort:             %.6f seconds\n",
-	       tot_q / C_TRIALS);
+	sprintf(params,
+		"n=%lu sbase=%lu mbase=%lu",
+		TOLU(count),
+		TOLU(sbase),
+		TOLU(mbase));
+	bench_report(&b_m, "\t\t\tpthread mergesort:     ", params);
+	bench_report(&b_q, "\t\t\tqsort:                 ", params);
+	bench_free(&b_m);
+	bench_free(&b_q);
 	printf("\t\t\tcorrectness:           ");
 	print_test_result(res);
       }
@@ -268,7 +336,8 @@ void run_double_opt_test(int pow_count_start,
   size_t i, j;
   size_t elt_size = sizeof(double);
   double *arr_a = NULL, *arr_b = NULL;
-  double tot_m, tot_q, t_m, t_q;
+  char params[64];
+  bench_t b_m, b_q;
   arr_a =  malloc_perror(pow_two(pow_count_end), elt_size);
   arr_b =  malloc_perror(pow_two(pow_count_end), elt_size);
   printf("Test mergesort_pthread performance on random double arrays\n");
@@ -282,29 +351,32 @@ void run_double_opt_test(int pow_count_start,
       for (mi = pow_mbase_start; mi <= pow_mbase_end; mi++){
 	mbase = pow_two(mi);
 	printf("\t\t\tmerge base count: %lu\n", TOLU(mbase));
-	tot_m = 0.0;
-	tot_q = 0.0;
+	bench_init(&b_m, C_SUITE, "double mergesort_pthread", 0, C_TRIALS);
+	bench_init(&b_q, C_SUITE, "double qsort", 0, C_TRIALS);
 	for(i = 0; i < C_TRIALS; i++){
 	  for (j = 0; j < count; j++){
 	    arr_a[j] = (DRAND() < C_HALF_PROB ? -1 : 1) * DRAND();
 	  }
 	  memcpy(arr_b, arr_a, count * elt_size);
-	  t_m = timer();
+	  bench_start(&b_m);
 	  mergesort_pthread(arr_a, count, elt_size, sbase, mbase, cmp_double);
-	  t_m = timer() - t_m;
-	  t_q = timer();
+	  bench_stop(&b_m);
+	  bench_start(&b_q);
 	  qsort(arr_b, count, elt_size, cmp_double);
-	  t_q = timer() - t_q;
-	  tot_m += t_m;
-	  tot_q += t_q;
+	  bench_stop(&b_q);
 	  for (j = 0; j < count; j++){
 	    res *= (arr_a[j] == arr_b[j]);
 	  }
 	}
-	printf("\t\t\tave pthread mergesort: %.6f seconds\n",
-	       tot_m / C_TRIALS);
-	printf("\t\t\tave qsort:             %.6f seconds\n",
-	       tot_q / C_TRIALS);
+	sprintf(params,
+		"n=%lu sbase=%lu mbase=%lu",
+		TOLU(count),
+		TOLU(sbase),
+		TOLU(mbase));
+	bench_report(&b_m, "\t\t\tpthread mergesort:     ", params);
+	bench_report(&b_q, "\t\t\tqsort:                 ", params);
+	bench_free(&b_m);
+	bench_free(&b_q);
 	printf("\t\t\tcorrectness:           ");
 	print_test_result(res);
       }
@@ -317,12 +389,140 @@ void run_double_opt_test(int pow_count_start,
 }
 
 /**
-   Times execution.
+   Splits an array of count elements into num_runs runs of random counts,
+   sorts each run, and sets the pointers to the runs and their counts.
 */
-double timer(){
-  struct timeval tm;
-  gettimeofday(&tm, NULL);
-  return tm.tv_sec + tm.tv_usec / (double)1000000;
+void split_sort_runs(int *arr,
+		     size_t count,
+		     size_t num_runs,
+		     const void **runs,
+		     size_t *counts){
+  size_t i, rem = count;
+  for (i = 0; i < num_runs; i++){
+    counts[i] = (i == num_runs - 1) ? rem : (size_t)(DRAND() * rem);
+    runs[i] = arr + (count - rem);
+    qsort(arr + (count - rem), counts[i], sizeof(int), cmp_int);
+    rem -= counts[i];
+  }
+}
+
+/**
+   Runs a kmerge_pthread corner cases test on random integer runs with
+   duplicates, including runs with no elements, across numbers of runs
+   and threads.
+*/
+void run_int_kmerge_corner_test(){
+  int res = 1;
+  int *arr_a = NULL, *arr_b = NULL, *arr_m = NULL;
+  size_t count, k, nt;
+  size_t i, j;
+  size_t elt_size = sizeof(int);
+  size_t *counts = NULL;
+  const void **runs = NULL;
+  arr_a = malloc_perror(C_KMERGE_CORNER_COUNT_MAX, elt_size);
+  arr_b = malloc_perror(C_KMERGE_CORNER_COUNT_MAX, elt_size);
+  arr_m = malloc_perror(C_KMERGE_CORNER_COUNT_MAX, elt_size);
+  counts = malloc_perror(C_KMERGE_CORNER_RUNS_MAX, sizeof(size_t));
+  runs = malloc_perror(C_KMERGE_CORNER_RUNS_MAX, sizeof(void *));
+  printf("Test kmerge_pthread on corner cases on random integer runs\n");
+  for (count = 0; count <= C_KMERGE_CORNER_COUNT_MAX; count++){
+    for (k = 1; k <= C_KMERGE_CORNER_RUNS_MAX; k++){
+      for (nt = 1; nt <= C_KMERGE_CORNER_THREADS_MAX; nt++){
+	for (i = 0; i < C_CORNER_TRIALS; i++){
+	  for (j = 0; j < count; j++){
+	    arr_a[j] = RANDOM() % C_KMERGE_CORNER_RANGE;
+	  }
+	  memcpy(arr_b, arr_a, count * elt_size);
+	  qsort(arr_b, count, elt_size, cmp_int);
+	  split_sort_runs(arr_a, count, k, runs, counts);
+	  kmerge_pthread(arr_m, runs, counts, k, elt_size, nt, cmp_int);
+	  for (j = 0; j < count; j++){
+	    res *= (arr_m[j] == arr_b[j]);
+	  }
+	}
+      }
+    }
+  }
+  printf("\tcorrectness:       ");
+  print_test_result(res);
+  free(arr_a);
+  free(arr_b);
+  free(arr_m);
+  free(counts);
+  free(runs);
+  arr_a = NULL;
+  arr_b = NULL;
+  arr_m = NULL;
+  counts = NULL;
+  runs = NULL;
+}
+
+/**
+   Runs a test of kmerge_pthread performance on random integer runs across
+   numbers of runs and threads.
+*/
+void run_int_kmerge_perf_test(int pow_count_start, int pow_count_end){
+  int res = 1;
+  int *arr_a = NULL, *arr_b = NULL, *arr_m = NULL;
+  int ci;
+  size_t count, k, nt;
+  size_t i, j;
+  size_t elt_size = sizeof(int);
+  size_t *counts = NULL;
+  char label[64], params[64];
+  bench_t b;
+  const void **runs = NULL;
+  arr_a = malloc_perror(pow_two(pow_count_end), elt_size);
+  arr_b = malloc_perror(pow_two(pow_count_end), elt_size);
+  arr_m = malloc_perror(pow_two(pow_count_end), elt_size);
+  counts = malloc_perror(pow_two(C_KMERGE_LOG_RUNS_END), sizeof(size_t));
+  runs = malloc_perror(pow_two(C_KMERGE_LOG_RUNS_END), sizeof(void *));
+  printf("Test kmerge_pthread performance on random integer runs\n");
+  for (ci = pow_count_start; ci <= pow_count_end; ci++){
+    count = pow_two(ci); /* > 0 */
+    printf("\t# trials: %lu, array count: %lu\n",
+	   TOLU(C_TRIALS), TOLU(count));
+    for (k = 2; k <= pow_two(C_KMERGE_LOG_RUNS_END); k *= 4){
+      printf("\t\t# runs: %lu\n", TOLU(k));
+      for (nt = 1; nt <= pow_two(C_KMERGE_LOG_THREADS_END); nt *= 2){
+	bench_init(&b, C_SUITE, "kmerge_pthread", 0, C_TRIALS);
+	for (i = 0; i < C_TRIALS; i++){
+	  for (j = 0; j < count; j++){
+	    arr_a[j] = (DRAND() < C_HALF_PROB ? -1 : 1) * RANDOM();
+	  }
+	  memcpy(arr_b, arr_a, count * elt_size);
+	  qsort(arr_b, count, elt_size, cmp_int);
+	  split_sort_runs(arr_a, count, k, runs, counts);
+	  bench_start(&b);
+	  kmerge_pthread(arr_m, runs, counts, k, elt_size, nt, cmp_int);
+	  bench_stop(&b);
+	  for (j = 0; j < count; j++){
+	    res *= (arr_m[j] == arr_b[j]);
+	  }
+	}
+	sprintf(label, "\t\t\t# threads: %lu, kmerge_pthread: ", TOLU(nt));
+	sprintf(params,
+		"n=%lu runs=%lu threads=%lu",
+		TOLU(count),
+		TOLU(k),
+		TOLU(nt));
+	bench_report(&b, label, params);
+	bench_free(&b);
+      }
+      printf("\t\t\tcorrectness:           ");
+      print_test_result(res);
+    }
+  }
+  free(arr_a);
+  free(arr_b);
+  free(arr_m);
+  free(counts);
+  free(runs);
+  arr_a = NULL;
+  arr_b = NULL;
+  arr_m = NULL;
+  counts = NULL;
+  runs = NULL;
 }
 
 /**
@@ -372,11 +572,16 @@ int main(int argc, char *argv[]){
       args[6] > 1 ||
       args[7] > 1 ||
       args[8] > 1 ||
-      args[9] > 1){
+      args[9] > 1 ||
+      args[10] > 1 ||
+      args[11] > 1){
     printf("USAGE:\n%s", C_USAGE);
     exit(EXIT_FAILURE);
   }
-  if (args[6]) run_int_corner_test();
+  if (args[6]){
+    run_int_corner_test();
+    run_int_rec_corner_test();
+  }
   if (args[7]) run_int_opt_test(args[0],
 				args[1],
 				args[2],
@@ -390,6 +595,8 @@ int main(int argc, char *argv[]){
 				   args[3],
 				   args[4],
 				   args[5]);
+  if (args[10]) run_int_kmerge_corner_test();
+  if (args[11]) run_int_kmerge_perf_test(args[0], args[1]);
   free(args);
   args = NULL;
   return 0;
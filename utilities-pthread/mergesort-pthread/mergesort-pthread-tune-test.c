@@ -0,0 +1,422 @@
+/**
+   mergesort-pthread-tune-test.c
+
+   Calibration of the parameters of mergesort_pthread on the current
+   machine, and tests of saving and loading the calibrated parameters.
+
+   The calibration tests tune the parameters on random integer and double
+   sample arrays, compare the runtime of the tuned parameters with the
+   runtime of the default parameters, and save the tuned parameters under
+   the "int" and "double" keys and the element sizes to a configuration
+   file that is created from the C_CFG_TEMPLATE path by mkstemp. The path is printed, and the file
+   can be copied and loaded with mergesort_pthread_params_load in
+   production. The tests do not write to the current working directory,
+   except for the temporary file of the save/load test that is removed.
+
+   The following command line arguments can be used to customize tests:
+   mergesort-pthread-tune-test
+      [0, # bits in size_t - 1) : a s.t. 2^a sample count
+      [0, # bits in size_t) : b
+      [0, # bits in size_t) : c s.t. 2^b <= sort base case bound <= 2^c
+      [1, # bits in size_t) : d
+      [1, # bits in size_t) : e s.t. 2^d <= merge base case bound <= 2^e
+      [0, # bits in size_t) : f
+      [0, # bits in size_t) : g s.t. 2^f <= on-thread rec. bound <= 2^g
+      [0, 1] : int calibration on/off
+      [0, 1] : double calibration on/off
+      [0, 1] : save/load test on/off
+
+   usage examples:
+   ./mergesort-pthread-tune-test
+   ./mergesort-pthread-tune-test 20
+   ./mergesort-pthread-tune-test 22 12 18 12 18 0 5
+   ./mergesort-pthread-tune-test 22 12 18 12 18 0 5 1 0 0
+
+   mergesort-pthread-tune-test can be run with any subset of command line
+   arguments in the above-defined order. If the (i + 1)th argument is
+   specified then the ith argument must be specified for i >= 0. Default
+   values are used for the unspecified arguments according to the
+   C_ARGS_DEF array.
+
+   The runtimes are measured with utilities-bench and can be written as
+   csv or json records by setting BENCH_FORMAT and BENCH_OUT, e.g.
+   BENCH_FORMAT=json BENCH_OUT=mergesort-pthread-tune.json ./mergesort-pthread-tune-test 20
+
+   The implementation of tests does not use stdint.h and is portable under
+   C89/C90 with the requirements that CHAR_BIT * sizeof(size_t) is even and
+   pthreads API is available.
+*/
+
+#define _XOPEN_SOURCE 600
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include "mergesort-pthread.h"
+#include "mergesort-pthread-tune.h"
+#include "utilities-bench.h"
+#include "utilities-mem.h"
+#include "utilities-mod.h"
+
+/**
+   Generate random numbers in a portable way for test purposes only; rand()
+   in the Linux C Library uses the same generator as random(), which may not
+   be the case on older rand() implementations, and on current
+   implementations on different systems.
+*/
+#ifdef TEST_SEED
+#define RGENS_SEED() do{srand(TEST_SEED);}while (0)
+#else
+#define RGENS_SEED() do{srand(time(NULL));}while (0)
+#endif
+#define RANDOM() (rand()) /* [0, RAND_MAX] */
+#define DRAND() ((double)rand() / RAND_MAX) /* [0.0, 1.0] */
+
+#define TOLU(i) ((unsigned long int)(i)) /* printing size_t under C89/C90 */
+
+/* input handling */
+const char *C_USAGE =
+  "mergesort-pthread-tune-test \n"
+  "[0, # bits in size_t - 1) : a s.t. 2^a sample count \n"
+  "[0, # bits in size_t) : b \n"
+  "[0, # bits in size_t) : c s.t. 2^b <= sort base bound <= 2^c \n"
+  "[1, # bits in size_t) : d \n"
+  "[1, # bits in size_t) : e s.t. 2^d <= merge base bound <= 2^e \n"
+  "[0, # bits in size_t) : f \n"
+  "[0, # bits in size_t) : g s.t. 2^f <= on-thread rec. bound <= 2^g \n"
+  "[0, 1] : int calibration on/off \n"
+  "[0, 1] : double calibration on/off \n"
+  "[0, 1] : save/load test on/off \n";
+const int C_ARGC_MAX = 11;
+const size_t C_ARGS_DEF[10] = {16, 12, 16, 12, 16, 0, 4, 1, 1, 1};
+const size_t C_FULL_BIT = CHAR_BIT * sizeof(size_t);
+
+/* tests */
+const char *C_SUITE = "mergesort-pthread-tune-test";
+
+/* calibration */
+const char *C_CFG_TEMPLATE = "/tmp/mergesort-pthread-tune-XXXXXX";
+const size_t C_TRIALS = 3;
+const double C_HALF_PROB = 0.5;
+
+/* save/load test */
+const char *C_TEST_CFG_PATH = "mergesort-pthread-tune-test.cfg";
+const char *C_TEST_TMP_PATH = "mergesort-pthread-tune-test.cfg.tmp";
+const char *C_TEST_KEY = "test";
+const char *C_TEST_OTHER_KEY = "test_other";
+const size_t C_TEST_NUM_SIZES = 17;
+
+int cmp_int(const void *a, const void *b);
+int cmp_double(const void *a, const void *b);
+void run_tune(const void *elts,
+	      size_t count,
+	      size_t elt_size,
+	      const mergesort_pthread_grid_t *grid,
+	      int (*cmp)(const void *, const void *),
+	      const char *key,
+	      const char *cfg_path);
+void sort_bench(bench_t *b,
+		const void *elts,
+		size_t count,
+		size_t elt_size,
+		const mergesort_pthread_params_t *params,
+		int (*cmp)(const void *, const void *),
+		int *res);
+void print_params(const mergesort_pthread_params_t *params);
+void print_test_result(int res);
+
+int cmp_int(const void *a, const void *b){
+  if (*(int *)a > *(int *)b){
+    return 1;
+  }else if  (*(int *)a < *(int *)b){
+    return -1;
+  }else{
+    return 0;
+  }
+}
+
+int cmp_double(const void *a, const void *b){
+  if (*(double *)a > *(double *)b){
+    return 1;
+  }else if  (*(double *)a < *(double *)b){
+    return -1;
+  }else{
+    return 0;
+  }
+}
+
+/**
+   Runs the calibration on a random integer sample array.
+*/
+void run_int_tune_test(size_t count,
+		       const mergesort_pthread_grid_t *grid,
+		       const char *cfg_path){
+  int *arr = NULL;
+  size_t i;
+  arr = malloc_perror(count, sizeof(int));
+  for (i = 0; i < count; i++){
+    arr[i] = (DRAND() < C_HALF_PROB ? -1 : 1) * RANDOM();
+  }
+  printf("Calibrate mergesort_pthread on a random integer array\n");
+  run_tune(arr, count, sizeof(int), grid, cmp_int, "int", cfg_path);
+  free(arr);
+  arr = NULL;
+}
+
+/**
+   Runs the calibration on a random double sample array.
+*/
+void run_double_tune_test(size_t count,
+			  const mergesort_pthread_grid_t *grid,
+			  const char *cfg_path){
+  double *arr = NULL;
+  size_t i;
+  arr = malloc_perror(count, sizeof(double));
+  for (i = 0; i < count; i++){
+    arr[i] = (DRAND() < C_HALF_PROB ? -1 : 1) * DRAND() * RANDOM();
+  }
+  printf("Calibrate mergesort_pthread on a random double array\n");
+  run_tune(arr, count, sizeof(double), grid, cmp_double, "double", cfg_path);
+  free(arr);
+  arr = NULL;
+}
+
+/**
+   Tunes the parameters on a sample array, prints the runtimes of the
+   default and tuned parameters, and saves the tuned parameters under a
+   key to the configuration file at cfg_path.
+*/
+void run_tune(const void *elts,
+	      size_t count,
+	      size_t elt_size,
+	      const mergesort_pthread_grid_t *grid,
+	      int (*cmp)(const void *, const void *),
+	      const char *key,
+	      const char *cfg_path){
+  int res = 1;
+  char params[64];
+  bench_t b, b_def, b_tune;
+  mergesort_pthread_params_t def, tuned;
+  printf("\t# trials: %lu, array count: %lu, element size: %lu\n",
+	 TOLU(C_TRIALS), TOLU(count), TOLU(elt_size));
+  bench_init(&b, C_SUITE, "mergesort_pthread_tune", 0, 1);
+  bench_start(&b);
+  mergesort_pthread_tune(&tuned, elts, count, elt_size, grid, cmp);
+  bench_stop(&b);
+  def.sbase_count = MERGESORT_PTHREAD_SBASE_COUNT_DEF;
+  def.mbase_count = MERGESORT_PTHREAD_MBASE_COUNT_DEF;
+  def.max_onthread_rec = MERGESORT_PTHREAD_MAX_ONTHREAD_REC;
+  bench_init(&b_def, C_SUITE, "default parameters", 0, C_TRIALS);
+  bench_init(&b_tune, C_SUITE, "tuned parameters", 0, C_TRIALS);
+  sort_bench(&b_def, elts, count, elt_size, &def, cmp, &res);
+  sort_bench(&b_tune, elts, count, elt_size, &tuned, cmp, &res);
+  sprintf(params, "n=%lu es=%lu", TOLU(count), TOLU(elt_size));
+  bench_report(&b, "\t\tcalibration runtime:  ", params);
+  printf("\t\tdefault parameters: ");
+  print_params(&def);
+  bench_report(&b_def, "\t\truntime:              ", params);
+  printf("\t\ttuned parameters:   ");
+  print_params(&tuned);
+  bench_report(&b_tune, "\t\truntime:              ", params);
+  bench_free(&b);
+  bench_free(&b_def);
+  bench_free(&b_tune);
+  printf("\t\tcorrectness:          ");
+  print_test_result(res);
+  mergesort_pthread_params_save(cfg_path, key, elt_size, &tuned);
+  printf("\t\tsaved as %s to %s\n", key, cfg_path);
+}
+
+/**
+   Times mergesort_pthread_rec with given parameters on copies of an array
+   in the warmup repetitions and repetitions of a benchmark, and updates
+   the value pointed to by res with the comparison of the results with
+   qsort.
+*/
+void sort_bench(bench_t *b,
+		const void *elts,
+		size_t count,
+		size_t elt_size,
+		const mergesort_pthread_params_t *params,
+		int (*cmp)(const void *, const void *),
+		int *res){
+  size_t i;
+  void *arr_a = NULL, *arr_b = NULL;
+  arr_a = malloc_perror(count, elt_size);
+  arr_b = malloc_perror(count, elt_size);
+  memcpy(arr_b, elts, count * elt_size);
+  qsort(arr_b, count, elt_size, cmp);
+  for (i = 0; i < b->num_warmups + b->num_reps; i++){
+    memcpy(arr_a, elts, count * elt_size);
+    bench_start(b);
+    mergesort_pthread_rec(arr_a,
+			  count,
+			  elt_size,
+			  params->sbase_count,
+			  params->mbase_count,
+			  params->max_onthread_rec,
+			  cmp);
+    bench_stop(b);
+    *res *= (memcmp(arr_a, arr_b, count * elt_size) == 0);
+  }
+  free(arr_a);
+  free(arr_b);
+  arr_a = NULL;
+  arr_b = NULL;
+}
+
+/**
+   Tests saving and loading parameters across element sizes in a
+   temporary configuration file, including overwriting, independence of
+   keys, removal of the temporary file of a save, loading of missing
+   element sizes and keys, and loading from a missing file.
+*/
+void run_save_load_test(){
+  int res = 1;
+  size_t i;
+  mergesort_pthread_params_t p;
+  FILE *f = NULL;
+  printf("Test mergesort_pthread_params_save and "
+	 "mergesort_pthread_params_load\n");
+  remove(C_TEST_CFG_PATH);
+  res *= (mergesort_pthread_params_load(C_TEST_CFG_PATH, C_TEST_KEY, 1, &p) == 0);
+  res *= (p.sbase_count == MERGESORT_PTHREAD_SBASE_COUNT_DEF &&
+	  p.mbase_count == MERGESORT_PTHREAD_MBASE_COUNT_DEF &&
+	  p.max_onthread_rec == MERGESORT_PTHREAD_MAX_ONTHREAD_REC);
+  for (i = 1; i <= C_TEST_NUM_SIZES; i++){
+    p.sbase_count = i;
+    p.mbase_count = i + 1;
+    p.max_onthread_rec = i - 1;
+    mergesort_pthread_params_save(C_TEST_CFG_PATH, C_TEST_KEY, i, &p);
+  }
+  /* overwrite the odd element sizes */
+  for (i = 1; i <= C_TEST_NUM_SIZES; i += 2){
+    p.sbase_count = 2 * i;
+    p.mbase_count = 2 * i + 1;
+    p.max_onthread_rec = 2 * i - 1;
+    mergesort_pthread_params_save(C_TEST_CFG_PATH, C_TEST_KEY, i, &p);
+  }
+  /* the same element size under another key is independent */
+  p.sbase_count = 3 * C_TEST_NUM_SIZES;
+  p.mbase_count = 3 * C_TEST_NUM_SIZES + 1;
+  p.max_onthread_rec = 0;
+  mergesort_pthread_params_save(C_TEST_CFG_PATH, C_TEST_OTHER_KEY, 2, &p);
+  f = fopen(C_TEST_TMP_PATH, "r");
+  res *= (f == NULL);
+  if (f != NULL) fclose(f);
+  res *= (mergesort_pthread_params_load(C_TEST_CFG_PATH,
+					C_TEST_OTHER_KEY,
+					2,
+					&p) == 1);
+  res *= (p.sbase_count == 3 * C_TEST_NUM_SIZES &&
+	  p.mbase_count == 3 * C_TEST_NUM_SIZES + 1 &&
+	  p.max_onthread_rec == 0);
+  res *= (mergesort_pthread_params_load(C_TEST_CFG_PATH,
+					C_TEST_OTHER_KEY,
+					1,
+					&p) == 0);
+  for (i = 1; i <= C_TEST_NUM_SIZES; i++){
+    res *= (mergesort_pthread_params_load(C_TEST_CFG_PATH,
+					  C_TEST_KEY,
+					  i,
+					  &p) == 1);
+    if (i & 1){
+      res *= (p.sbase_count == 2 * i &&
+	      p.mbase_count == 2 * i + 1 &&
+	      p.max_onthread_rec == 2 * i - 1);
+    }else{
+      res *= (p.sbase_count == i &&
+	      p.mbase_count == i + 1 &&
+	      p.max_onthread_rec == i - 1);
+    }
+  }
+  res *= (mergesort_pthread_params_load(C_TEST_CFG_PATH,
+					C_TEST_KEY,
+					C_TEST_NUM_SIZES + 1,
+					&p) == 0);
+  res *= (p.sbase_count == MERGESORT_PTHREAD_SBASE_COUNT_DEF);
+  remove(C_TEST_CFG_PATH);
+  printf("\tcorrectness:       ");
+  print_test_result(res);
+}
+
+/**
+   Print helper functions.
+*/
+
+void print_params(const mergesort_pthread_params_t *params){
+  printf("sbase %lu, mbase %lu, on-thread rec. %lu\n",
+	 TOLU(params->sbase_count),
+	 TOLU(params->mbase_count),
+	 TOLU(params->max_onthread_rec));
+}
+
+void print_test_result(int res){
+  if (res){
+    printf("SUCCESS\n");
+  }else{
+    printf("FAILURE\n");
+  }
+}
+
+int main(int argc, char *argv[]){
+  int i, fd;
+  size_t *args = NULL;
+  char *cfg_path = NULL;
+  mergesort_pthread_grid_t grid;
+  RGENS_SEED();
+  if (argc > C_ARGC_MAX){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  args = malloc_perror(C_ARGC_MAX - 1, sizeof(size_t));
+  memcpy(args, C_ARGS_DEF, (C_ARGC_MAX - 1) * sizeof(size_t));
+  for (i = 1; i < argc; i++){
+    args[i - 1] = atoi(argv[i]);
+  }
+  if (args[0] > C_FULL_BIT - 2 ||
+      args[1] > C_FULL_BIT - 1 ||
+      args[2] > C_FULL_BIT - 1 ||
+      args[3] > C_FULL_BIT - 1 ||
+      args[4] > C_FULL_BIT - 1 ||
+      args[5] > C_FULL_BIT - 1 ||
+      args[6] > C_FULL_BIT - 1 ||
+      args[3] < 1 ||
+      args[1] > args[2] ||
+      args[3] > args[4] ||
+      args[5] > args[6] ||
+      args[7] > 1 ||
+      args[8] > 1 ||
+      args[9] > 1){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  grid.sbase_start = pow_two(args[1]);
+  grid.sbase_end = pow_two(args[2]);
+  grid.mbase_start = pow_two(args[3]);
+  grid.mbase_end = pow_two(args[4]);
+  grid.rec_start = (args[5] == 0) ? 0 : pow_two(args[5]);
+  grid.rec_end = pow_two(args[6]);
+  grid.num_trials = C_TRIALS;
+  if (args[7] || args[8]){
+    cfg_path = malloc_perror(strlen(C_CFG_TEMPLATE) + 1, 1);
+    strcpy(cfg_path, C_CFG_TEMPLATE);
+    fd = mkstemp(cfg_path);
+    if (fd == -1){
+      perror("mkstemp failed");
+      exit(EXIT_FAILURE);
+    }
+    close(fd);
+  }
+  if (args[7]) run_int_tune_test(pow_two(args[0]), &grid, cfg_path);
+  if (args[8]) run_double_tune_test(pow_two(args[0]), &grid, cfg_path);
+  if (args[9]) run_save_load_test();
+  free(args);
+  free(cfg_path);
+  args = NULL;
+  cfg_path = NULL;
+  return 0;
+}
@@ -0,0 +1,297 @@
+/**
+   mergesort-pthread-tune.c
+
+   Functions for calibrating the base case upper bounds and the on-thread
+   recursion bound of mergesort_pthread on the current machine, and for
+   saving and loading the calibrated parameters.
+
+   The calibration times mergesort_pthread_rec on copies of a sample array
+   across a grid of parameters, where the base case upper bounds and the
+   on-thread recursion bound are doubled from the start to the end values
+   of the grid, and selects the parameters with the smallest runtime. The
+   runtime of a grid point is the minimum runtime across trials, which
+   reduces the effect of noise from other processes on the selection.
+
+   The calibrated parameters are saved to a text configuration file, where
+   each line other than a comment line starting with '#' contains a key
+   supplied by the caller (e.g. the name of the element type and
+   comparison function), the element size, the sort base case bound, the
+   merge base case bound, and the on-thread recursion bound. Parameters for
+   different keys and element sizes can be saved to the same file, and a
+   save overwrites the line of the same key and element size. A save
+   writes a temporary file at the path with the ".tmp" suffix and renames
+   it over the configuration file, so that a reader does not observe a
+   partially written file.
+
+   The runtimes are measured with the wall-clock time of utilities-time.
+
+   The implementation does not use stdint.h and is portable under C89/C90.
+   Element sizes and parameters are written as unsigned long.
+*/
+
+#include <stdio.h>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mergesort-pthread.h"
+#include "mergesort-pthread-tune.h"
+#include "utilities-mem.h"
+#include "utilities-time.h"
+
+#define TOLU(i) ((unsigned long int)(i)) /* printing size_t under C89/C90 */
+
+#define C_KEY_SIZE (64)
+#define C_KEY_FMT "%63s" /* reads at most C_KEY_SIZE - 1 characters */
+
+typedef struct{
+  char key[C_KEY_SIZE];
+  size_t elt_size;
+  mergesort_pthread_params_t params;
+} entry_t;
+
+static const size_t C_LINE_SIZE = 256;
+static const size_t C_INIT_NUM_ENTRIES = 8;
+static const char *C_CFG_HEADER =
+  "# key elt_size sbase_count mbase_count max_onthread_rec\n";
+static const char *C_TMP_SUFFIX = ".tmp";
+
+static size_t next_val(size_t val);
+static void check_key(const char *key);
+static size_t read_entries(const char *path, entry_t **entries);
+
+/**
+   Calibrates the parameters of mergesort_pthread_rec on the current
+   machine by sorting copies of a sample array across a grid of parameters.
+   The sample array is not modified.
+   params      : pointer to a preallocated block of size
+                 sizeof(mergesort_pthread_params_t), where the parameters
+                 with the smallest runtime are set
+   elts        : pointer to a sample array representative of the workload
+   count       : > 0, < 2^{CHAR_BIT * sizeof(size_t) - 1} count of elements
+                 in the sample array
+   elt_size    : size of each element in the sample array in bytes
+   grid        : pointer to a grid of parameters
+   cmp         : comparison function which returns a negative integer value
+                 if the element pointed to by the first argument is less than
+                 the element pointed to by the second, a positive integer
+                 value if the element pointed to by the first argument is
+                 greater than the element pointed to by the second, and zero
+                 integer value if the two elements are equal
+*/
+void mergesort_pthread_tune(mergesort_pthread_params_t *params,
+			    const void *elts,
+			    size_t count,
+			    size_t elt_size,
+			    const mergesort_pthread_grid_t *grid,
+			    int (*cmp)(const void *, const void *)){
+  int init = 0;
+  size_t sb, mb, rec;
+  size_t i;
+  double t, t_min, t_best = 0.0;
+  void *work_elts = NULL;
+  work_elts = malloc_perror(count, elt_size);
+  params->sbase_count = grid->sbase_start;
+  params->mbase_count = grid->mbase_start;
+  params->max_onthread_rec = grid->rec_start;
+  for (sb = grid->sbase_start; sb <= grid->sbase_end; sb = next_val(sb)){
+    for (mb = grid->mbase_start; mb <= grid->mbase_end; mb = next_val(mb)){
+      for (rec = grid->rec_start; rec <= grid->rec_end; rec = next_val(rec)){
+	t_min = 0.0;
+	for (i = 0; i < grid->num_trials; i++){
+	  memcpy(work_elts, elts, count * elt_size);
+	  t = time_wall();
+	  mergesort_pthread_rec(work_elts, count, elt_size, sb, mb, rec, cmp);
+	  t = time_wall() - t;
+	  if (i == 0 || t < t_min) t_min = t;
+	}
+	if (!init || t_min < t_best){
+	  init = 1;
+	  t_best = t_min;
+	  params->sbase_count = sb;
+	  params->mbase_count = mb;
+	  params->max_onthread_rec = rec;
+	}
+	if (rec > grid->rec_end / 2) break; /* next value exceeds the end */
+      }
+      if (mb > grid->mbase_end / 2) break;
+    }
+    if (sb > grid->sbase_end / 2) break;
+  }
+  free(work_elts);
+  work_elts = NULL;
+}
+
+/**
+   Saves the parameters for a key and an element size to a configuration
+   file, preserving the lines of the other keys and element sizes. The
+   lines are written to a temporary file at the path with the ".tmp"
+   suffix, which is then renamed over the configuration file. The program
+   exits with an error message if the key is invalid or the file cannot be
+   written.
+   path        : pointer to the path of the configuration file; the file
+                 is created if it does not exist
+   key         : pointer to a non-empty string of less than 64 characters
+                 without whitespace that identifies the element type and
+                 comparison function of the parameters
+   elt_size    : element size of the parameters
+   params      : pointer to the parameters
+*/
+void mergesort_pthread_params_save(const char *path,
+				   const char *key,
+				   size_t elt_size,
+				   const mergesort_pthread_params_t *params){
+  int res = 1;
+  size_t num_entries;
+  size_t i;
+  char *tmp_path = NULL;
+  entry_t *entries = NULL;
+  FILE *f = NULL;
+  check_key(key);
+  num_entries = read_entries(path, &entries);
+  for (i = 0; i < num_entries; i++){
+    if (entries[i].elt_size == elt_size &&
+	strcmp(entries[i].key, key) == 0) break;
+  }
+  if (i == num_entries){
+    entries = realloc_perror(entries, add_sz_perror(num_entries, 1),
+			     sizeof(entry_t));
+    num_entries++;
+  }
+  strcpy(entries[i].key, key);
+  entries[i].elt_size = elt_size;
+  entries[i].params = *params;
+  tmp_path = malloc_perror(add_sz_perror(strlen(path),
+					 strlen(C_TMP_SUFFIX) + 1), 1);
+  strcpy(tmp_path, path);
+  strcat(tmp_path, C_TMP_SUFFIX);
+  f = fopen(tmp_path, "w");
+  if (f == NULL){
+    perror("mergesort_pthread_params_save fopen failed");
+    exit(EXIT_FAILURE);
+  }
+  res *= (fputs(C_CFG_HEADER, f) >= 0);
+  for (i = 0; i < num_entries; i++){
+    res *= (fprintf(f, "%s %lu %lu %lu %lu\n",
+		    entries[i].key,
+		    TOLU(entries[i].elt_size),
+		    TOLU(entries[i].params.sbase_count),
+		    TOLU(entries[i].params.mbase_count),
+		    TOLU(entries[i].params.max_onthread_rec)) > 0);
+  }
+  res *= (fclose(f) == 0);
+  if (!res){
+    perror("mergesort_pthread_params_save write failed");
+    remove(tmp_path);
+    exit(EXIT_FAILURE);
+  }
+  if (rename(tmp_path, path) != 0){
+    perror("mergesort_pthread_params_save rename failed");
+    remove(tmp_path);
+    exit(EXIT_FAILURE);
+  }
+  free(tmp_path);
+  free(entries);
+  tmp_path = NULL;
+  entries = NULL;
+}
+
+/**
+   Loads the parameters for a key and an element size from a configuration
+   file. Returns 1 if the parameters were loaded. Otherwise, sets the
+   default parameters and returns 0, which includes the case when the file
+   does not exist. The program exits with an error message if the key is
+   invalid.
+   path        : pointer to the path of the configuration file
+   key         : pointer to a key as in mergesort_pthread_params_save
+   elt_size    : element size of the parameters
+   params      : pointer to a preallocated block of size
+                 sizeof(mergesort_pthread_params_t)
+*/
+int mergesort_pthread_params_load(const char *path,
+				  const char *key,
+				  size_t elt_size,
+				  mergesort_pthread_params_t *params){
+  size_t num_entries;
+  size_t i;
+  entry_t *entries = NULL;
+  check_key(key);
+  params->sbase_count = MERGESORT_PTHREAD_SBASE_COUNT_DEF;
+  params->mbase_count = MERGESORT_PTHREAD_MBASE_COUNT_DEF;
+  params->max_onthread_rec = MERGESORT_PTHREAD_MAX_ONTHREAD_REC;
+  num_entries = read_entries(path, &entries);
+  for (i = 0; i < num_entries; i++){
+    if (entries[i].elt_size == elt_size &&
+	strcmp(entries[i].key, key) == 0){
+      *params = entries[i].params;
+      break;
+    }
+  }
+  free(entries);
+  entries = NULL;
+  return (i < num_entries);
+}
+
+/**
+   Returns the next value of a grid dimension by doubling, or 1 if the
+   value is 0. The loops of the calibration exit before an overflow.
+*/
+static size_t next_val(size_t val){
+  if (val == 0) return 1;
+  return 2 * val;
+}
+
+/**
+   Exits with an error message if a key is empty, contains whitespace, or
+   has C_KEY_SIZE or more characters.
+*/
+static void check_key(const char *key){
+  size_t i;
+  for (i = 0; key[i] != '\0' && i < C_KEY_SIZE; i++){
+    if (isspace((unsigned char)key[i])) break;
+  }
+  if (i == 0 || i == C_KEY_SIZE || key[i] != '\0'){
+    fprintf(stderr, "mergesort_pthread_params: invalid key\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+/**
+   Reads the valid lines of a configuration file into a block of entries
+   allocated by the function and returns the number of entries. The block
+   pointer is set to NULL and 0 is returned if the file does not exist.
+   Invalid lines are skipped, including the lines without a key that were
+   written before keys were introduced; an entry with an invalid parameter
+   is skipped.
+*/
+static size_t read_entries(const char *path, entry_t **entries){
+  size_t num_entries = 0, max_num_entries = C_INIT_NUM_ENTRIES;
+  unsigned long es, sb, mb, rec;
+  char key[C_KEY_SIZE];
+  char *line = NULL;
+  FILE *f = NULL;
+  *entries = NULL;
+  f = fopen(path, "r");
+  if (f == NULL) return 0;
+  line = malloc_perror(C_LINE_SIZE, 1);
+  *entries = malloc_perror(max_num_entries, sizeof(entry_t));
+  while (fgets(line, (int)C_LINE_SIZE, f) != NULL){
+    if (line[0] == '#') continue;
+    if (sscanf(line, C_KEY_FMT " %lu %lu %lu %lu",
+	       key, &es, &sb, &mb, &rec) != 5) continue;
+    if (es == 0 || sb == 0 || mb < 2) continue;
+    if (num_entries == max_num_entries){
+      max_num_entries = mul_sz_perror(max_num_entries, 2);
+      *entries = realloc_perror(*entries, max_num_entries, sizeof(entry_t));
+    }
+    strcpy((*entries)[num_entries].key, key);
+    (*entries)[num_entries].elt_size = es;
+    (*entries)[num_entries].params.sbase_count = sb;
+    (*entries)[num_entries].params.mbase_count = mb;
+    (*entries)[num_entries].params.max_onthread_rec = rec;
+    num_entries++;
+  }
+  fclose(f);
+  free(line);
+  line = NULL;
+  return num_entries;
+}
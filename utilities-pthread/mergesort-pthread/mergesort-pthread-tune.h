@@ -0,0 +1,122 @@
+/**
+   mergesort-pthread-tune.h
+
+   Declarations of accessible functions and macro definitions for
+   calibrating the base case upper bounds and the on-thread recursion bound
+   of mergesort_pthread on the current machine, and for saving and loading
+   the calibrated parameters.
+
+   The calibration times mergesort_pthread_rec on copies of a sample array
+   across a grid of parameters, where the base case upper bounds and the
+   on-thread recursion bound are doubled from the start to the end values
+   of the grid, and selects the parameters with the smallest runtime. The
+   runtime of a grid point is the minimum runtime across trials, which
+   reduces the effect of noise from other processes on the selection.
+
+   The calibrated parameters are saved to a text configuration file, where
+   each line other than a comment line starting with '#' contains a key
+   supplied by the caller (e.g. the name of the element type and
+   comparison function), the element size, the sort base case bound, the
+   merge base case bound, and the on-thread recursion bound. Parameters for
+   different keys and element sizes can be saved to the same file, and a
+   save overwrites the line of the same key and element size. A save
+   replaces the file by renaming a temporary file at the path with the
+   ".tmp" suffix. Lines without a key, written before keys were introduced,
+   are ignored.
+*/
+
+#ifndef MERGESORT_PTHREAD_TUNE_H
+#define MERGESORT_PTHREAD_TUNE_H
+
+#include <stddef.h>
+#include "mergesort-pthread.h"
+
+typedef struct{
+  size_t sbase_count; /* > 0 sort base case upper bound */
+  size_t mbase_count; /* > 1 merge base case upper bound */
+  size_t max_onthread_rec;
+} mergesort_pthread_params_t;
+
+typedef struct{
+  size_t sbase_start; /* > 0 */
+  size_t sbase_end; /* >= sbase_start */
+  size_t mbase_start; /* > 1 */
+  size_t mbase_end; /* >= mbase_start */
+  size_t rec_start; /* if 0, the next grid value is 1 */
+  size_t rec_end; /* >= rec_start */
+  size_t num_trials; /* > 0 */
+} mergesort_pthread_grid_t;
+
+/**
+   Calibrates the parameters of mergesort_pthread_rec on the current
+   machine by sorting copies of a sample array across a grid of parameters.
+   The sample array is not modified.
+   params      : pointer to a preallocated block of size
+                 sizeof(mergesort_pthread_params_t), where the parameters
+                 with the smallest runtime are set
+   elts        : pointer to a sample array representative of the workload
+   count       : > 0, < 2^{CHAR_BIT * sizeof(size_t) - 1} count of elements
+                 in the sample array
+   elt_size    : size of each element in the sample array in bytes
+   grid        : pointer to a grid of parameters
+   cmp         : comparison function which returns a negative integer value
+                 if the element pointed to by the first argument is less than
+                 the element pointed to by the second, a positive integer
+                 value if the element pointed to by the first argument is
+                 greater than the element pointed to by the second, and zero
+                 integer value if the two elements are equal
+*/
+void mergesort_pthread_tune(mergesort_pthread_params_t *params,
+			    const void *elts,
+			    size_t count,
+			    size_t elt_size,
+			    const mergesort_pthread_grid_t *grid,
+			    int (*cmp)(const void *, const void *));
+
+/**
+   Saves the parameters for a key and an element size to a configuration
+   file, preserving the lines of the other keys and element sizes. The
+   lines are written to a temporary file at the path with the ".tmp"
+   suffix, which is then renamed over the configuration file. The program
+   exits with an error message if the key is invalid or the file cannot be
+   written.
+   path        : pointer to the path of the configuration file; the file
+                 is created if it does not exist
+   key         : pointer to a non-empty string of less than 64 characters
+                 without whitespace that identifies the element type and
+                 comparison function of the parameters
+   elt_size    : element size of the parameters
+   params      : pointer to the parameters
+*/
+void mergesort_pthread_params_save(const char *path,
+				   const char *key,
+				   size_t elt_size,
+				   const mergesort_pthread_params_t *params);
+
+/**
+   Loads the parameters for a key and an element size from a configuration
+   file. Returns 1 if the parameters were loaded. Otherwise, sets the
+   default parameters and returns 0, which includes the case when the file
+   does not exist. The program exits with an error message if the key is
+   invalid.
+   path        : pointer to the path of the configuration file
+   key         : pointer to a key as in mergesort_pthread_params_save
+   elt_size    : element size of the parameters
+   params      : pointer to a preallocated block of size
+                 sizeof(mergesort_pthread_params_t)
+*/
+int mergesort_pthread_params_load(const char *path,
+				  const char *key,
+				  size_t elt_size,
+				  mergesort_pthread_params_t *params);
+
+/**
+   Default base case upper bounds set by mergesort_pthread_params_load if
+   the parameters for an element size are not available. The default
+   on-thread recursion bound is MERGESORT_PTHREAD_MAX_ONTHREAD_REC. The
+   macros are used as size_t.
+*/
+#define MERGESORT_PTHREAD_SBASE_COUNT_DEF (32768)
+#define MERGESORT_PTHREAD_MBASE_COUNT_DEF (32768)
+
+#endif
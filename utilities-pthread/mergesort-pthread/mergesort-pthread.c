@@ -23,16 +23,27 @@
    parameters resulted in a speedup of approximately 2.6X in comparison
    to serial qsort (stdlib.h) on arrays of 10M random integer or double
    elements.
+
+   If cmp is one of the comparators of mergesort-pthread-kernels.h and
+   elt_size is the size of its type, then the serial base cases of sorting
+   and merging are performed by typed kernels that do not call through cmp.
+
+   A parallel k-way merge of sorted runs is also provided. The output is
+   split into equal ranges by multi-sequence selection, and each range is
+   merged with a loser tree on its own thread.
 */
 
 #define _POSIX_C_SOURCE 200112L
 
+#define UTILITIES_MEM_TAG MEM_TAG_SORT
+
 #include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <pthread.h>
 #include "mergesort-pthread.h"
+#include "mergesort-pthread-kernels.h"
 #include "utilities-alg.h"
 #include "utilities-mem.h"
 #include "utilities-pthread.h"
@@ -43,6 +54,8 @@ typedef struct{
   size_t mbase_count; /* >1, count of merge base case bound */
   size_t elt_size;
   size_t num_onthread_rec;
+  size_t max_onthread_rec;
+  const mergesort_pthread_kernel_t *kernel; /* NULL if not primitive */
   void *cat_elts; /* pointer to concatenation buffer for merging */
   void *elts; /* pointer to an input array */
   int (*cmp)(const void *, const void *);
@@ -53,16 +66,40 @@ typedef struct{
   size_t mbase_count; /* >1, count of merge base case bound */
   size_t elt_size;
   size_t num_onthread_rec;
+  size_t max_onthread_rec;
+  const mergesort_pthread_kernel_t *kernel; /* NULL if not primitive */
   void *cat_seg_elts; /* pointer to concatenation buffer segment */
   void *elts; /* pointer to an input array */
   int (*cmp)(const void *, const void *);
 } merge_arg_t;
 
+typedef struct{
+  size_t start; /* rank of the first output element of a thread */
+  size_t end; /* rank after the last output element of a thread */
+  size_t num_runs;
+  size_t elt_size;
+  size_t *lo; /* num_runs lower bounds of split positions in selection */
+  size_t *hi; /* num_runs upper bounds of split positions in selection */
+  size_t *ps; /* num_runs start positions in runs, advanced in merging */
+  size_t *pe; /* num_runs end positions in runs */
+  size_t *tree; /* num_runs loser tree, winner at 0 */
+  size_t *wins; /* 2 * num_runs block used for building the tree */
+  void *elts; /* pointer to the output array */
+  const void * const *runs;
+  const size_t *counts;
+  int (*cmp)(const void *, const void *);
+} kmerge_arg_t;
+
 const size_t C_SIZE_MAX = (size_t)-1; /* cannot be reached as array index */
 
 static void *mergesort_thread(void *arg);
 static void *merge_thread(void *arg);
 static void merge(merge_arg_t *ma);
+static void *kmerge_thread(void *arg);
+static void select_split(kmerge_arg_t *ka, size_t rank, size_t *pos);
+static void tree_build(kmerge_arg_t *ka);
+static void tree_replay(kmerge_arg_t *ka);
+static int beats(const kmerge_arg_t *ka, size_t i, size_t j);
 static void *elt_ptr(const void *elts, size_t i, size_t elt_size);
 
 /**
@@ -93,6 +130,37 @@ void mergesort_pthread(void *elts,
 		       size_t sbase_count,
 		       size_t mbase_count,
 		       int (*cmp)(const void *, const void *)){
+  mergesort_pthread_rec(elts,
+			count,
+			elt_size,
+			sbase_count,
+			mbase_count,
+			MERGESORT_PTHREAD_MAX_ONTHREAD_REC,
+			cmp);
+}
+
+/**
+   Sorts a given array as in mergesort_pthread with a runtime upper bound
+   for the number of recursive calls of thread entry functions placed on
+   the stack of a thread.
+   elts             : pointer to the array to sort
+   count            : > 0, < 2^{CHAR_BIT * sizeof(size_t) - 1} count of
+                      elements in the array
+   elt_size         : size of each element in the array in bytes
+   sbase_count      : > 0 base case upper bound for parallel sorting
+   mbase_count      : > 1 base case upper bound for parallel merging
+   max_onthread_rec : upper bound for the number of recursive calls placed
+                      on the stack of a thread; if 0, then each recursive
+                      call results in the creation of a new thread
+   cmp              : comparison function as in mergesort_pthread
+*/
+void mergesort_pthread_rec(void *elts,
+			   size_t count,
+			   size_t elt_size,
+			   size_t sbase_count,
+			   size_t mbase_count,
+			   size_t max_onthread_rec,
+			   int (*cmp)(const void *, const void *)){
   mergesort_arg_t msa;
   if (count < 1) return;
   msa.p = 0;
@@ -101,6 +169,8 @@ void mergesort_pthread(void *elts,
   msa.mbase_count = mbase_count;
   msa.elt_size = elt_size;
   msa.num_onthread_rec = 0;
+  msa.max_onthread_rec = max_onthread_rec;
+  msa.kernel = mergesort_pthread_kernel(elt_size, cmp);
   msa.elts = elts;
   msa.cat_elts = malloc_perror(count, elt_size);
   msa.cmp = cmp;
@@ -112,7 +182,7 @@ void mergesort_pthread(void *elts,
    Enters a mergesort thread that spawns mergesort threads recursively.
    The total number of threads is reduced and an additional speedup is
    provided by placing O(logn) recursive calls on a thread stack, with the
-   tightness of the bound set by MERGESORT_PTHREAD_MAX_ONTHREAD_REC.
+   tightness of the bound set by max_onthread_rec.
 */
 static void *mergesort_thread(void *arg){
   size_t q;
@@ -120,7 +190,10 @@ static void *mergesort_thread(void *arg){
   mergesort_arg_t child_msas[2];
   pthread_t child_ids[2];
   merge_arg_t ma;
-  if (msa->r - msa->p + 1 <= msa->sbase_count){
+  if (msa->r - msa->p + 1 <= msa->sbase_count && msa->kernel != NULL){
+    msa->kernel->sort(elt_ptr(msa->elts, msa->p, msa->elt_size),
+		      msa->r - msa->p + 1);
+  }else if (msa->r - msa->p + 1 <= msa->sbase_count){
     qsort(elt_ptr(msa->elts, msa->p, msa->elt_size),
 	  msa->r - msa->p + 1,
 	  msa->elt_size,
@@ -135,6 +208,8 @@ static void *mergesort_thread(void *arg){
     child_msas[0].mbase_count = msa->mbase_count;
     child_msas[0].elt_size = msa->elt_size;
     child_msas[0].num_onthread_rec = 0;
+    child_msas[0].max_onthread_rec = msa->max_onthread_rec;
+    child_msas[0].kernel = msa->kernel;
     child_msas[0].cat_elts = msa->cat_elts;
     child_msas[0].elts = msa->elts;
     child_msas[0].cmp = msa->cmp;
@@ -143,11 +218,13 @@ static void *mergesort_thread(void *arg){
     child_msas[1].sbase_count = msa->sbase_count;
     child_msas[1].mbase_count = msa->mbase_count;
     child_msas[1].elt_size = msa->elt_size;
+    child_msas[1].max_onthread_rec = msa->max_onthread_rec;
+    child_msas[1].kernel = msa->kernel;
     child_msas[1].cat_elts = msa->cat_elts;
     child_msas[1].elts = msa->elts;
     child_msas[1].cmp = msa->cmp;
     thread_create_perror(&child_ids[0], mergesort_thread, &child_msas[0]);
-    if (msa->num_onthread_rec < MERGESORT_PTHREAD_MAX_ONTHREAD_REC){
+    if (msa->num_onthread_rec < msa->max_onthread_rec){
       /* keep putting mergesort_thread calls on the current thread stack */
       child_msas[1].num_onthread_rec = msa->num_onthread_rec + 1;
       mergesort_thread(&child_msas[1]);
@@ -167,6 +244,8 @@ static void *mergesort_thread(void *arg){
     ma.mbase_count = msa->mbase_count;
     ma.elt_size = msa->elt_size;
     ma.num_onthread_rec = msa->num_onthread_rec;
+    ma.max_onthread_rec = msa->max_onthread_rec;
+    ma.kernel = msa->kernel;
     ma.cat_seg_elts = elt_ptr(msa->cat_elts, msa->p, msa->elt_size);
     ma.elts = msa->elts;
     ma.cmp = msa->cmp;
@@ -261,19 +340,23 @@ static void *merge_thread(void *arg){
   child_mas[0].mbase_count = ma->mbase_count;
   child_mas[0].elt_size = ma->elt_size;
   child_mas[0].num_onthread_rec = ma->num_onthread_rec;
+  child_mas[0].max_onthread_rec = ma->max_onthread_rec;
+  child_mas[0].kernel = ma->kernel;
   child_mas[0].cat_seg_elts = ma->cat_seg_elts;
   child_mas[0].elts = ma->elts;
   child_mas[0].cmp = ma->cmp;
   child_mas[1].mbase_count = ma->mbase_count;
   child_mas[1].elt_size = ma->elt_size;
   child_mas[1].num_onthread_rec = ma->num_onthread_rec;
+  child_mas[1].max_onthread_rec = ma->max_onthread_rec;
+  child_mas[1].kernel = ma->kernel;
   child_mas[1].cat_seg_elts = ma->cat_seg_elts;
   child_mas[1].elts = ma->elts;
   child_mas[1].cmp = ma->cmp;
 
   /* recursion */
   thread_create_perror(&child_ids[0], merge_thread, &child_mas[0]);
-  if (ma->num_onthread_rec < MERGESORT_PTHREAD_MAX_ONTHREAD_REC){
+  if (ma->num_onthread_rec < ma->max_onthread_rec){
     /* keep putting merge_thread calls on the current thread stack */
     child_mas[1].num_onthread_rec = ma->num_onthread_rec + 1;
     merge_thread(&child_mas[1]);
@@ -303,6 +386,13 @@ static void merge(merge_arg_t *ma){
     memcpy(elt_ptr(ma->cat_seg_elts, ma->cs, elt_size),
 	   elt_ptr(ma->elts, ma->ap, elt_size),
 	   (ma->ar - ma->ap + 1) * elt_size);
+  }else if (ma->kernel != NULL){
+    /* a and b are each not empty, and of a primitive type */
+    ma->kernel->merge(elt_ptr(ma->cat_seg_elts, ma->cs, elt_size),
+		      elt_ptr(ma->elts, ma->ap, elt_size),
+		      ma->ar - ma->ap + 1,
+		      elt_ptr(ma->elts, ma->bp, elt_size),
+		      ma->br - ma->bp + 1);
   }else{
     /* a and b are each not empty */
     first_ix = ma->ap;
@@ -336,6 +426,231 @@ static void merge(merge_arg_t *ma){
   }
 }
 
+/**
+   Merges num_runs arrays, each sorted in ascending order according to cmp,
+   into an output array pointed to by elts. The output is split into
+   num_threads ranges of equal count. The start positions of a range in
+   the runs are computed by multi-sequence selection with binary search,
+   and each range is merged with a loser tree on its own thread. The first
+   thread entry is placed on the thread stack of the caller. Equal elements
+   are ordered by run index.
+   elts        : pointer to a preallocated output array with the count equal
+                 to the sum of the counts of the runs; does not overlap with
+                 the runs
+   runs        : pointer to an array of num_runs pointers to sorted runs
+   counts      : pointer to an array of num_runs counts of the runs; a
+                 count may be 0
+   num_runs    : > 0 number of runs
+   elt_size    : size of each element in the runs in bytes
+   num_threads : > 0 number of threads and output ranges
+   cmp         : comparison function which returns a negative integer value
+                 if the element pointed to by the first argument is less than
+                 the element pointed to by the second, a positive integer
+                 value if the element pointed to by the first argument is
+                 greater than the element pointed to by the second, and zero
+                 integer value if the two elements are equal
+*/
+void kmerge_pthread(void *elts,
+		    const void * const *runs,
+		    const size_t *counts,
+		    size_t num_runs,
+		    size_t elt_size,
+		    size_t num_threads,
+		    int (*cmp)(const void *, const void *)){
+  size_t count = 0, step, rem;
+  size_t i;
+  size_t *buf = NULL;
+  pthread_t *ids = NULL;
+  kmerge_arg_t *kas = NULL;
+  for (i = 0; i < num_runs; i++){
+    count = add_sz_perror(count, counts[i]);
+  }
+  if (count == 0) return;
+  if (num_threads > count) num_threads = count;
+  step = count / num_threads;
+  rem = count % num_threads;
+  ids = malloc_perror(num_threads, sizeof(pthread_t));
+  kas = malloc_perror(num_threads, sizeof(kmerge_arg_t));
+  buf = malloc_perror(mul_sz_perror(num_threads, 7), /* 7 * num_runs */
+		      mul_sz_perror(num_runs, sizeof(size_t)));
+  for (i = 0; i < num_threads; i++){
+    /* the first rem ranges contain one additional element */
+    kas[i].start = i * step + (i < rem ? i : rem);
+    kas[i].end = kas[i].start + step + (i < rem ? 1 : 0);
+    kas[i].num_runs = num_runs;
+    kas[i].elt_size = elt_size;
+    kas[i].lo = buf + 7 * num_runs * i;
+    kas[i].hi = kas[i].lo + num_runs;
+    kas[i].ps = kas[i].hi + num_runs;
+    kas[i].pe = kas[i].ps + num_runs;
+    kas[i].tree = kas[i].pe + num_runs;
+    kas[i].wins = kas[i].tree + num_runs;
+    kas[i].elts = elts;
+    kas[i].runs = runs;
+    kas[i].counts = counts;
+    kas[i].cmp = cmp;
+  }
+  for (i = 1; i < num_threads; i++){
+    thread_create_perror(&ids[i], kmerge_thread, &kas[i]);
+  }
+  kmerge_thread(&kas[0]);
+  for (i = 1; i < num_threads; i++){
+    thread_join_perror(ids[i], NULL);
+  }
+  free(ids);
+  free(kas);
+  free(buf);
+  ids = NULL;
+  kas = NULL;
+  buf = NULL;
+}
+
+/**
+   Computes the start and end positions of the output range of a thread in
+   each run, and merges the range with a loser tree.
+*/
+static void *kmerge_thread(void *arg){
+  size_t i, w;
+  char *out = NULL;
+  kmerge_arg_t *ka = arg;
+  select_split(ka, ka->start, ka->ps);
+  select_split(ka, ka->end, ka->pe);
+  out = elt_ptr(ka->elts, ka->start, ka->elt_size);
+  tree_build(ka);
+  for (i = ka->start; i < ka->end; i++){
+    w = ka->tree[0];
+    memcpy(out,
+	   elt_ptr(ka->runs[w], ka->ps[w], ka->elt_size),
+	   ka->elt_size);
+    out += ka->elt_size;
+    ka->ps[w]++;
+    tree_replay(ka);
+  }
+  return NULL;
+}
+
+/**
+   Computes the positions in the runs that split the runs into the rank
+   smallest elements and the remaining elements, where elements are
+   ordered by value according to cmp, then by run index, and then by
+   position in a run. In each step, the middle element of the largest
+   undecided range of positions is the pivot, its rank is computed by
+   binary search in the undecided range of each run, and the undecided
+   range of the pivot run is at least halved.
+*/
+static void select_split(kmerge_arg_t *ka, size_t rank, size_t *pos){
+  size_t elt_size = ka->elt_size;
+  size_t j, m, r, max;
+  size_t i;
+  const void *pivot = NULL;
+  for (i = 0; i < ka->num_runs; i++){
+    ka->lo[i] = 0;
+    ka->hi[i] = ka->counts[i];
+  }
+  while (1){
+    j = 0;
+    max = 0;
+    for (i = 0; i < ka->num_runs; i++){
+      if (ka->hi[i] - ka->lo[i] > max){
+	j = i;
+	max = ka->hi[i] - ka->lo[i];
+      }
+    }
+    if (max == 0) break;
+    m = ka->lo[j] + max / 2;
+    pivot = elt_ptr(ka->runs[j], m, elt_size);
+    r = 0;
+    for (i = 0; i < ka->num_runs; i++){
+      /* the undecided range of each run contains the rank of the pivot */
+      if (i < j){
+	pos[i] = ka->lo[i] + first_gt_bsearch(pivot,
+					      elt_ptr(ka->runs[i],
+						      ka->lo[i],
+						      elt_size),
+					      ka->hi[i] - ka->lo[i],
+					      elt_size,
+					      ka->cmp);
+      }else if (i > j){
+	pos[i] = ka->lo[i] + first_geq_bsearch(pivot,
+					       elt_ptr(ka->runs[i],
+						       ka->lo[i],
+						       elt_size),
+					       ka->hi[i] - ka->lo[i],
+					       elt_size,
+					       ka->cmp);
+      }else{
+	pos[i] = m;
+      }
+      r += pos[i];
+    }
+    if (r < rank){
+      /* the pivot and the elements that precede it are in the split */
+      for (i = 0; i < ka->num_runs; i++) ka->lo[i] = pos[i];
+      ka->lo[j] = m + 1;
+    }else{
+      for (i = 0; i < ka->num_runs; i++) ka->hi[i] = pos[i];
+    }
+  }
+  for (i = 0; i < ka->num_runs; i++){
+    pos[i] = ka->lo[i];
+  }
+}
+
+/**
+   Builds a loser tree bottom-up, where the leaf of the ith run is the
+   node num_runs + i, the parent of the node j is the node j / 2, and the
+   winner of the tree is placed at the root index 0.
+*/
+static void tree_build(kmerge_arg_t *ka){
+  size_t n = ka->num_runs;
+  size_t j;
+  for (j = 0; j < n; j++){
+    ka->wins[n + j] = j;
+  }
+  for (j = n - 1; j > 0; j--){
+    if (beats(ka, ka->wins[2 * j], ka->wins[2 * j + 1])){
+      ka->wins[j] = ka->wins[2 * j];
+      ka->tree[j] = ka->wins[2 * j + 1];
+    }else{
+      ka->wins[j] = ka->wins[2 * j + 1];
+      ka->tree[j] = ka->wins[2 * j];
+    }
+  }
+  ka->tree[0] = (n == 1) ? 0 : ka->wins[1];
+}
+
+/**
+   Replays the matches on the path from the leaf of the last winner to the
+   root, after the head element of the last winner was advanced.
+*/
+static void tree_replay(kmerge_arg_t *ka){
+  size_t w = ka->tree[0];
+  size_t j, tmp;
+  for (j = (ka->num_runs + w) / 2; j > 0; j /= 2){
+    if (beats(ka, ka->tree[j], w)){
+      tmp = ka->tree[j];
+      ka->tree[j] = w;
+      w = tmp;
+    }
+  }
+  ka->tree[0] = w;
+}
+
+/**
+   Returns 1 if the head element of the ith run precedes the head element
+   of the jth run within the output range of a thread, where an exhausted
+   run is preceded by every run and equal elements are ordered by run
+   index. Otherwise returns 0.
+*/
+static int beats(const kmerge_arg_t *ka, size_t i, size_t j){
+  int c;
+  if (ka->ps[i] == ka->pe[i]) return 0;
+  if (ka->ps[j] == ka->pe[j]) return 1;
+  c = ka->cmp(elt_ptr(ka->runs[i], ka->ps[i], ka->elt_size),
+	      elt_ptr(ka->runs[j], ka->ps[j], ka->elt_size));
+  return (c < 0 || (c == 0 && i < j));
+}
+
 /**
    Computes a pointer to an element in an element array.
 */
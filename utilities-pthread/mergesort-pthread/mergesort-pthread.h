@@ -23,7 +23,20 @@
    On a 4-core machine, the optimization of the base case upper bound
    parameters resulted in a speedup of approximately 2.6X in comparison
    to serial qsort (stdlib.h) on arrays of 10M random integer or double
-   elements.
+   elements. The base case upper bounds and the on-thread recursion bound
+   can be calibrated on a given machine with mergesort_pthread_tune
+   (mergesort-pthread-tune.h) and loaded from a configuration file.
+
+   If cmp is one of the comparators of mergesort-pthread-kernels.h and
+   elt_size is the size of its type, then the serial base cases of sorting
+   and merging are performed by typed kernels that do not call through cmp.
+   With the double comparator, elements that compare equal but differ,
+   e.g. -0.0 and 0.0, may then be in a different order than with a
+   comparator of the same order that is not recognized.
+
+   A parallel k-way merge of sorted runs is also provided. The output is
+   split into equal ranges by multi-sequence selection, and each range is
+   merged with a loser tree on its own thread.
 */
 
 #ifndef MERGESORT_PTHREAD_H  
@@ -60,12 +73,67 @@ void mergesort_pthread(void *elts,
 		       size_t mbase_count,
 		       int (*cmp)(const void *, const void *));
 
+/**
+   Sorts a given array as in mergesort_pthread with a runtime upper bound
+   for the number of recursive calls of thread entry functions placed on
+   the stack of a thread, e.g. set by mergesort_pthread_tune.
+   elts             : pointer to the array to sort
+   count            : > 0, < 2^{CHAR_BIT * sizeof(size_t) - 1} count of
+                      elements in the array
+   elt_size         : size of each element in the array in bytes
+   sbase_count      : > 0 base case upper bound for parallel sorting
+   mbase_count      : > 1 base case upper bound for parallel merging
+   max_onthread_rec : upper bound for the number of recursive calls placed
+                      on the stack of a thread; if 0, then each recursive
+                      call results in the creation of a new thread
+   cmp              : comparison function as in mergesort_pthread
+*/
+void mergesort_pthread_rec(void *elts,
+			   size_t count,
+			   size_t elt_size,
+			   size_t sbase_count,
+			   size_t mbase_count,
+			   size_t max_onthread_rec,
+			   int (*cmp)(const void *, const void *));
+
+/**
+   Merges num_runs arrays, each sorted in ascending order according to cmp,
+   into an output array pointed to by elts. The output is split into
+   num_threads ranges of equal count. The start positions of a range in
+   the runs are computed by multi-sequence selection with binary search,
+   and each range is merged with a loser tree on its own thread. The first
+   thread entry is placed on the thread stack of the caller. Equal elements
+   are ordered by run index.
+   elts        : pointer to a preallocated output array with the count equal
+                 to the sum of the counts of the runs; does not overlap with
+                 the runs
+   runs        : pointer to an array of num_runs pointers to sorted runs
+   counts      : pointer to an array of num_runs counts of the runs; a
+                 count may be 0
+   num_runs    : > 0 number of runs
+   elt_size    : size of each element in the runs in bytes
+   num_threads : > 0 number of threads and output ranges
+   cmp         : comparison function which returns a negative integer value
+                 if the element pointed to by the first argument is less than
+                 the element pointed to by the second, a positive integer
+                 value if the element pointed to by the first argument is
+                 greater than the element pointed to by the second, and zero
+                 integer value if the two elements are equal
+*/
+void kmerge_pthread(void *elts,
+		    const void * const *runs,
+		    const size_t *counts,
+		    size_t num_runs,
+		    size_t elt_size,
+		    size_t num_threads,
+		    int (*cmp)(const void *, const void *));
+
 /**
    A constant upper bound for the number of recursive calls of thread entry
    functions placed on the stack of a thread. Reduces the total number of
    threads and provides an additional speedup if greater than 0. If equal to
-   0, then each recursive call results in the creation of a new thread. The
-   macro is used as size_t.
+   0, then each recursive call results in the creation of a new thread. Used
+   by mergesort_pthread. The macro is used as size_t.
 */
 #define MERGESORT_PTHREAD_MAX_ONTHREAD_REC (20)
 
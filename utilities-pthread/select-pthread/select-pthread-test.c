@@ -0,0 +1,380 @@
+/**
+   select-pthread-test.c
+
+   Correctness and performance tests of generic selection (nth element)
+   and partial sort algorithms with parallel partitioning.
+
+   The following command line arguments can be used to customize tests:
+   select-pthread-test
+      [0, # bits in size_t - 1) : a
+      [0, # bits in size_t - 1) : b s.t. 2^a <= count <= 2^b
+      [0, # bits in size_t) : c s.t. 2^c selection and sort base case bound
+      [1, # bits in size_t) : d s.t. 2^d merge base case bound
+      [0, # bits in size_t) : e s.t. 1 <= # threads <= 2^e
+      [0, 1] : int corner test on/off
+      [0, 1] : int nth performance test on/off
+      [0, 1] : int partial sort performance test on/off
+
+   usage examples:
+   ./select-pthread-test
+   ./select-pthread-test 20 20
+   ./select-pthread-test 22 24 15 15 3
+   ./select-pthread-test 22 24 15 15 3 0 1 0
+
+   select-pthread-test can be run with any subset of command line
+   arguments in the above-defined order. If the (i + 1)th argument is
+   specified then the ith argument must be specified for i >= 0. Default
+   values are used for the unspecified arguments according to the
+   C_ARGS_DEF array.
+
+   The runtimes are measured with utilities-bench and can be written as
+   csv or json records by setting BENCH_FORMAT and BENCH_OUT, e.g.
+   BENCH_FORMAT=json BENCH_OUT=select-pthread.json ./select-pthread-test 20 20
+
+   The implementation of tests does not use stdint.h and is portable under
+   C89/C90 with the requirements that CHAR_BIT * sizeof(size_t) is even and
+   pthreads API is available.
+*/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include "select-pthread.h"
+#include "utilities-bench.h"
+#include "utilities-mem.h"
+#include "utilities-mod.h"
+
+/**
+   Generate random numbers in a portable way for test purposes only; rand()
+   in the Linux C Library uses the same generator as random(), which may not
+   be the case on older rand() implementations, and on current
+   implementations on different systems.
+*/
+#ifdef TEST_SEED
+#define RGENS_SEED() do{srand(TEST_SEED);}while (0)
+#else
+#define RGENS_SEED() do{srand(time(NULL));}while (0)
+#endif
+#define RANDOM() (rand()) /* [0, RAND_MAX] */
+#define DRAND() ((double)rand() / RAND_MAX) /* [0.0, 1.0] */
+
+#define TOLU(i) ((unsigned long int)(i)) /* printing size_t under C89/C90 */
+
+/* input handling */
+const char *C_USAGE =
+  "select-pthread-test \n"
+  "[0, # bits in size_t - 1) : a \n"
+  "[0, # bits in size_t - 1) : b s.t. 2^a <= count <= 2^b \n"
+  "[0, # bits in size_t) : c s.t. 2^c select and sort base case bound \n"
+  "[1, # bits in size_t) : d s.t. 2^d merge base case bound \n"
+  "[0, # bits in size_t) : e s.t. 1 <= # threads <= 2^e \n"
+  "[0, 1] : int corner test on/off \n"
+  "[0, 1] : int nth performance test on/off \n"
+  "[0, 1] : int partial sort performance test on/off \n";
+const int C_ARGC_MAX = 9;
+const size_t C_ARGS_DEF[8] = {20, 20, 12, 15, 2, 1, 1, 1};
+const size_t C_FULL_BIT = CHAR_BIT * sizeof(size_t);
+
+/* tests */
+const char *C_SUITE = "select-pthread-test";
+
+/* corner cases */
+const size_t C_CORNER_COUNT_MAX = 41;
+const size_t C_CORNER_THREADS_MAX = 4;
+const size_t C_CORNER_SBASE_MAX = 2;
+const int C_CORNER_RANGE = 7; /* values with many duplicates */
+const double C_HALF_PROB = 0.5;
+
+/* performance tests */
+const size_t C_TRIALS = 5;
+const size_t C_TOPK_DIVS[3] = {1000, 100, 10}; /* k = count / div */
+const size_t C_NUM_TOPK_DIVS = 3;
+
+int cmp_int(const void *a, const void *b);
+int is_nth(const int *arr, const int *sorted, size_t count, size_t k);
+void report(const bench_t *b,
+	    const char *label,
+	    size_t count,
+	    size_t k,
+	    size_t nt);
+void print_test_result(int res);
+
+int cmp_int(const void *a, const void *b){
+  if (*(int *)a > *(int *)b){
+    return 1;
+  }else if  (*(int *)a < *(int *)b){
+    return -1;
+  }else{
+    return 0;
+  }
+}
+
+/**
+   Returns 1 if the element at index k of an array is the element at index
+   k of its sorted copy, each element before index k is less or equal, and
+   each element after index k is greater or equal. Otherwise returns 0.
+*/
+int is_nth(const int *arr, const int *sorted, size_t count, size_t k){
+  int res = 1;
+  size_t i;
+  res *= (arr[k] == sorted[k]);
+  for (i = 0; i < k; i++){
+    res *= (arr[i] <= arr[k]);
+  }
+  for (i = k + 1; i < count; i++){
+    res *= (arr[i] >= arr[k]);
+  }
+  return res;
+}
+
+/**
+   Runs nth_pthread and partial_sort_pthread corner cases tests on random
+   integer arrays with and without duplicates across all ranks, numbers
+   of threads, and small base case bounds.
+*/
+void run_int_corner_test(){
+  int res = 1;
+  int *arr_a = NULL, *arr_b = NULL, *arr_s = NULL;
+  size_t count, k, nt, sb, dup;
+  size_t i;
+  size_t elt_size = sizeof(int);
+  arr_a = malloc_perror(C_CORNER_COUNT_MAX, elt_size);
+  arr_b = malloc_perror(C_CORNER_COUNT_MAX, elt_size);
+  arr_s = malloc_perror(C_CORNER_COUNT_MAX, elt_size);
+  printf("Test nth_pthread and partial_sort_pthread on corner cases on "
+	 "random integer arrays\n");
+  for (count = 1; count <= C_CORNER_COUNT_MAX; count++){
+    for (dup = 0; dup <= 1; dup++){
+      for (i = 0; i < count; i++){
+	arr_s[i] = (dup ?
+		    RANDOM() % C_CORNER_RANGE :
+		    (DRAND() < C_HALF_PROB ? -1 : 1) * RANDOM());
+      }
+      memcpy(arr_b, arr_s, count * elt_size);
+      qsort(arr_s, count, elt_size, cmp_int);
+      for (nt = 1; nt <= C_CORNER_THREADS_MAX; nt++){
+	for (sb = 1; sb <= C_CORNER_SBASE_MAX; sb++){
+	  for (k = 0; k < count; k++){
+	    memcpy(arr_a, arr_b, count * elt_size);
+	    nth_pthread(arr_a, count, elt_size, k, nt, sb, cmp_int);
+	    res *= is_nth(arr_a, arr_s, count, k);
+	    qsort(arr_a, count, elt_size, cmp_int);
+	    res *= (memcmp(arr_a, arr_s, count * elt_size) == 0);
+	  }
+	  for (k = 0; k <= count; k++){
+	    memcpy(arr_a, arr_b, count * elt_size);
+	    partial_sort_pthread(arr_a, count, elt_size, k, nt, sb, 2,
+				 cmp_int);
+	    res *= (memcmp(arr_a, arr_s, k * elt_size) == 0);
+	    qsort(arr_a, count, elt_size, cmp_int);
+	    res *= (memcmp(arr_a, arr_s, count * elt_size) == 0);
+	  }
+	}
+      }
+    }
+  }
+  printf("\tcorrectness:       ");
+  print_test_result(res);
+  free(arr_a);
+  free(arr_b);
+  free(arr_s);
+  arr_a = NULL;
+  arr_b = NULL;
+  arr_s = NULL;
+}
+
+/**
+   Runs a test comparing nth_pthread selection of the median vs. qsort
+   performance on random integer arrays across numbers of threads.
+*/
+void run_int_nth_perf_test(int pow_count_start,
+			   int pow_count_end,
+			   size_t sbase,
+			   int pow_threads_end){
+  int res = 1;
+  int *arr_a = NULL, *arr_b = NULL;
+  int ci;
+  size_t count, k, nt;
+  size_t i, j;
+  size_t elt_size = sizeof(int);
+  bench_t b_n, b_q;
+  arr_a = malloc_perror(pow_two(pow_count_end), elt_size);
+  arr_b = malloc_perror(pow_two(pow_count_end), elt_size);
+  printf("Test nth_pthread performance on random integer arrays\n");
+  for (ci = pow_count_start; ci <= pow_count_end; ci++){
+    count = pow_two(ci); /* > 0 */
+    k = count / 2;
+    printf("\t# trials: %lu, array count: %lu, k: %lu\n",
+	   TOLU(C_TRIALS), TOLU(count), TOLU(k));
+    for (nt = 1; nt <= pow_two(pow_threads_end); nt *= 2){
+      bench_init(&b_n, C_SUITE, "nth_pthread", 0, C_TRIALS);
+      if (nt == 1) bench_init(&b_q, C_SUITE, "qsort", 0, C_TRIALS);
+      for (i = 0; i < C_TRIALS; i++){
+	for (j = 0; j < count; j++){
+	  arr_a[j] = (DRAND() < C_HALF_PROB ? -1 : 1) * RANDOM();
+	}
+	memcpy(arr_b, arr_a, count * elt_size);
+	bench_start(&b_n);
+	nth_pthread(arr_a, count, elt_size, k, nt, sbase, cmp_int);
+	bench_stop(&b_n);
+	if (nt == 1){
+	  bench_start(&b_q);
+	  qsort(arr_b, count, elt_size, cmp_int);
+	  bench_stop(&b_q);
+	}else{
+	  qsort(arr_b, count, elt_size, cmp_int);
+	}
+	res *= is_nth(arr_a, arr_b, count, k);
+      }
+      if (nt == 1){
+	report(&b_q, "\t\tqsort:                     ", count, k, nt);
+	bench_free(&b_q);
+      }
+      report(&b_n, "\t\t# threads: %lu, nth_pthread: ", count, k, nt);
+      bench_free(&b_n);
+    }
+    printf("\t\tcorrectness:                   ");
+    print_test_result(res);
+  }
+  free(arr_a);
+  free(arr_b);
+  arr_a = NULL;
+  arr_b = NULL;
+}
+
+/**
+   Runs a test comparing partial_sort_pthread vs. qsort performance on
+   random integer arrays across k and numbers of threads.
+*/
+void run_int_partial_perf_test(int pow_count_start,
+			       int pow_count_end,
+			       size_t sbase,
+			       size_t mbase,
+			       int pow_threads_end){
+  int res = 1;
+  int *arr_a = NULL, *arr_b = NULL;
+  int ci;
+  size_t count, k, nt;
+  size_t i, j, di;
+  size_t elt_size = sizeof(int);
+  bench_t b_p, b_q;
+  arr_a = malloc_perror(pow_two(pow_count_end), elt_size);
+  arr_b = malloc_perror(pow_two(pow_count_end), elt_size);
+  printf("Test partial_sort_pthread performance on random integer "
+	 "arrays\n");
+  for (ci = pow_count_start; ci <= pow_count_end; ci++){
+    count = pow_two(ci); /* > 0 */
+    for (di = 0; di < C_NUM_TOPK_DIVS; di++){
+      k = count / C_TOPK_DIVS[di] + 1;
+      if (k > count) k = count;
+      printf("\t# trials: %lu, array count: %lu, k: %lu\n",
+	     TOLU(C_TRIALS), TOLU(count), TOLU(k));
+      for (nt = 1; nt <= pow_two(pow_threads_end); nt *= 2){
+	bench_init(&b_p, C_SUITE, "partial_sort_pthread", 0, C_TRIALS);
+	if (nt == 1) bench_init(&b_q, C_SUITE, "qsort", 0, C_TRIALS);
+	for (i = 0; i < C_TRIALS; i++){
+	  for (j = 0; j < count; j++){
+	    arr_a[j] = (DRAND() < C_HALF_PROB ? -1 : 1) * RANDOM();
+	  }
+	  memcpy(arr_b, arr_a, count * elt_size);
+	  bench_start(&b_p);
+	  partial_sort_pthread(arr_a, count, elt_size, k, nt, sbase, mbase,
+			       cmp_int);
+	  bench_stop(&b_p);
+	  if (nt == 1){
+	    bench_start(&b_q);
+	    qsort(arr_b, count, elt_size, cmp_int);
+	    bench_stop(&b_q);
+	  }else{
+	    qsort(arr_b, count, elt_size, cmp_int);
+	  }
+	  res *= (memcmp(arr_a, arr_b, k * elt_size) == 0);
+	}
+	if (nt == 1){
+	  report(&b_q, "\t\tqsort:                              ", count, k, nt);
+	  bench_free(&b_q);
+	}
+	report(&b_p, "\t\t# threads: %lu, partial_sort_pthread: ", count, k, nt);
+	bench_free(&b_p);
+      }
+      printf("\t\tcorrectness:                            ");
+      print_test_result(res);
+    }
+  }
+  free(arr_a);
+  free(arr_b);
+  arr_a = NULL;
+  arr_b = NULL;
+}
+
+/**
+   Reports a benchmark with the count, k, and the number of threads. The
+   label may contain a %lu conversion for the number of threads.
+*/
+void report(const bench_t *b,
+	    const char *label,
+	    size_t count,
+	    size_t k,
+	    size_t nt){
+  char label_buf[128], params[64];
+  sprintf(label_buf, label, TOLU(nt));
+  sprintf(params,
+	  "n=%lu k=%lu threads=%lu",
+	  TOLU(count),
+	  TOLU(k),
+	  TOLU(nt));
+  bench_report(b, label_buf, params);
+}
+
+void print_test_result(int res){
+  if (res){
+    printf("SUCCESS\n");
+  }else{
+    printf("FAILURE\n");
+  }
+}
+
+int main(int argc, char *argv[]){
+  int i;
+  size_t *args = NULL;
+  RGENS_SEED();
+  if (argc > C_ARGC_MAX){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  args = malloc_perror(C_ARGC_MAX - 1, sizeof(size_t));
+  memcpy(args, C_ARGS_DEF, (C_ARGC_MAX - 1) * sizeof(size_t));
+  for (i = 1; i < argc; i++){
+    args[i - 1] = atoi(argv[i]);
+  }
+  if (args[0] > C_FULL_BIT - 2 ||
+      args[1] > C_FULL_BIT - 2 ||
+      args[2] > C_FULL_BIT - 1 ||
+      args[3] > C_FULL_BIT - 1 ||
+      args[4] > C_FULL_BIT - 1 ||
+      args[3] < 1 ||
+      args[0] > args[1] ||
+      args[5] > 1 ||
+      args[6] > 1 ||
+      args[7] > 1){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  if (args[5]) run_int_corner_test();
+  if (args[6]) run_int_nth_perf_test(args[0],
+				     args[1],
+				     pow_two(args[2]),
+				     args[4]);
+  if (args[7]) run_int_partial_perf_test(args[0],
+					 args[1],
+					 pow_two(args[2]),
+					 pow_two(args[3]),
+					 args[4]);
+  free(args);
+  args = NULL;
+  return 0;
+}
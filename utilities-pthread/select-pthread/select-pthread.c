@@ -0,0 +1,607 @@
+/**
+   select-pthread.c
+
+   Functions for running generic selection (nth element) and partial sort
+   algorithms with parallel partitioning.
+
+   The selection algorithm follows the sampling approach of Floyd and
+   Rivest. In each round, two pivots bracketing the target rank are
+   selected from a sample of the current range, and the range is
+   partitioned in parallel into the elements less than the lower pivot,
+   the elements between the pivots, and the elements greater than the
+   upper pivot. With high probability the target rank falls into the
+   middle part, which is a small fraction of the range, resulting in
+   O(n) expected work. The parallel partition is stable and out-of-place:
+   each thread counts the elements of each part in its chunk, the counts
+   are prefix-summed into output offsets, and each thread scatters its
+   chunk into the other block of an array and a buffer. The rounds
+   alternate between the two blocks, and after a round that scatters into
+   the buffer, only the parts outside the next range are copied back to
+   the array.
+
+   The sample consists of elements drawn uniformly at random from a range
+   with the xoshiro256** generator of utilities-rand-uint64, seeded from
+   the count and k of a call, so that a call is reproducible. If a round
+   does not reduce the range, the range is selected serially.
+
+   A range of at most a base case count of elements is selected with
+   serial introselect: quickselect with random pivots and a 3-way
+   partition, which switches to median-of-medians pivots after
+   2 * floor(log2(n)) partitions that keep more than 3/4 of a range,
+   bounding the serial work by O(n) in the worst case.
+
+   The partial sort selects the (k - 1)th element and sorts the first k
+   elements with mergesort_pthread, providing the top-k elements in
+   sorted order according to cmp.
+
+   The implementation is portable under C89/C90 with the requirements that
+   pthreads API is available and that stdint.h provides uint64_t for the
+   generator of utilities-rand-uint64.
+*/
+
+#define _POSIX_C_SOURCE 200112L
+
+#define UTILITIES_MEM_TAG MEM_TAG_SORT
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "select-pthread.h"
+#include "mergesort-pthread.h"
+#include "utilities-mem.h"
+#include "utilities-pthread.h"
+#include "utilities-rand-uint64.h"
+
+typedef struct{
+  size_t start; /* first index of the chunk of a thread */
+  size_t end; /* index after the last index of the chunk of a thread */
+  size_t counts[3]; /* counts of the parts in the chunk */
+  size_t offsets[3]; /* offsets of the parts of the chunk in dst */
+  size_t keep_start; /* next range, which is not copied back */
+  size_t keep_end;
+  size_t elt_size;
+  unsigned char *parts; /* part index of each element */
+  const void *low_piv;
+  const void *high_piv;
+  const void *src; /* block that is partitioned */
+  void *dst; /* block that receives the parts */
+  void *elts; /* array that receives the parts outside the next range */
+  int (*cmp)(const void *, const void *);
+} part_arg_t;
+
+static const size_t C_SAMPLE_COUNT_MIN = 1024;
+static const size_t C_SAMPLE_DIV = 64; /* sample count is count / 64 */
+static const size_t C_DEV_MUL = 2; /* pivot ranks at 2 * sqrt(m) from r */
+static const size_t C_GROUP_COUNT = 5; /* group count in median-of-medians */
+
+static void partition(part_arg_t *pas,
+		      pthread_t *ids,
+		      size_t num_threads,
+		      size_t lo,
+		      size_t hi,
+		      const void *src,
+		      void *dst);
+static void run_threads(void *(*start)(void *),
+			part_arg_t *pas,
+			pthread_t *ids,
+			size_t num_threads);
+static void *count_thread(void *arg);
+static void *scatter_thread(void *arg);
+static void *copy_thread(void *arg);
+static void copy_range(part_arg_t *pa, size_t start, size_t end);
+static void select_serial(void *elts,
+			  size_t count,
+			  size_t elt_size,
+			  size_t k,
+			  void *piv,
+			  xoshiro256_t *g,
+			  int (*cmp)(const void *, const void *));
+static void select_rec(void *elts,
+		       size_t count,
+		       size_t elt_size,
+		       size_t k,
+		       void *piv,
+		       xoshiro256_t *g,
+		       size_t max_bad,
+		       int (*cmp)(const void *, const void *));
+static void mom_pivot(void *elts,
+		      size_t count,
+		      size_t elt_size,
+		      void *piv,
+		      xoshiro256_t *g,
+		      int (*cmp)(const void *, const void *));
+static void insertion_sort(void *elts,
+			   size_t count,
+			   size_t elt_size,
+			   void *tmp,
+			   int (*cmp)(const void *, const void *));
+static void swap(void *a, void *b, void *tmp, size_t elt_size);
+static size_t log2_floor(size_t n);
+static size_t sqrt_floor(size_t n);
+static void *elt_ptr(const void *elts, size_t i, size_t elt_size);
+
+/**
+   Rearranges the elements of an array, such that the element at index k
+   is the element at index k in the array sorted in ascending order
+   according to cmp, each element before index k is less or equal to the
+   element at index k, and each element after index k is greater or equal
+   to the element at index k. The first thread entry is placed on the
+   thread stack of the caller.
+   elts        : pointer to the array
+   count       : > 0 count of elements in the array
+   elt_size    : size of each element in the array in bytes
+   k           : < count index of the element to select
+   num_threads : > 0 number of threads for partitioning
+   sbase_count : > 0 base case upper bound for parallel selection; if the
+                 count of a range is less or equal to sbase_count, then
+                 the range is selected with serial introselect
+   cmp         : comparison function which returns a negative integer value
+                 if the element pointed to by the first argument is less than
+                 the element pointed to by the second, a positive integer
+                 value if the element pointed to by the first argument is
+                 greater than the element pointed to by the second, and zero
+                 integer value if the two elements are equal
+*/
+void nth_pthread(void *elts,
+		 size_t count,
+		 size_t elt_size,
+		 size_t k,
+		 size_t num_threads,
+		 size_t sbase_count,
+		 int (*cmp)(const void *, const void *)){
+  int found = 0;
+  size_t lo = 0, hi = count, next_lo, next_hi;
+  size_t n, m, r, d, rl, rh, c0, c1, nt;
+  size_t i;
+  unsigned char *parts = NULL;
+  void *buf = NULL, *sample = NULL, *pivs = NULL;
+  void *src = elts, *dst = NULL;
+  pthread_t *ids = NULL;
+  part_arg_t *pas = NULL;
+  xoshiro256_t g;
+  xoshiro256_seed(&g, ((uint64_t)count << 32) ^ (uint64_t)k);
+  /* low pivot, high pivot, serial pivot, swap buffer */
+  pivs = malloc_perror(4, elt_size);
+  if (count > sbase_count){
+    m = count / C_SAMPLE_DIV;
+    if (m < C_SAMPLE_COUNT_MIN) m = C_SAMPLE_COUNT_MIN;
+    if (m > count) m = count;
+    parts = malloc_perror(count, 1);
+    buf = malloc_perror(count, elt_size);
+    sample = malloc_perror(m, elt_size);
+    ids = malloc_perror(num_threads, sizeof(pthread_t));
+    pas = malloc_perror(num_threads, sizeof(part_arg_t));
+    for (i = 0; i < num_threads; i++){
+      pas[i].elt_size = elt_size;
+      pas[i].parts = parts;
+      pas[i].low_piv = pivs;
+      pas[i].high_piv = elt_ptr(pivs, 1, elt_size);
+      pas[i].elts = elts;
+      pas[i].cmp = cmp;
+    }
+    dst = buf;
+  }
+  while (hi - lo > sbase_count){
+    n = hi - lo;
+    /* pivots bracketing the rank of k in a random sample */
+    m = n / C_SAMPLE_DIV;
+    if (m < C_SAMPLE_COUNT_MIN) m = C_SAMPLE_COUNT_MIN;
+    if (m > n) m = n;
+    for (i = 0; i < m; i++){
+      memcpy(elt_ptr(sample, i, elt_size),
+	     elt_ptr(src, lo + xoshiro256_range(&g, n), elt_size),
+	     elt_size);
+    }
+    r = (size_t)((double)(k - lo) / n * m);
+    if (r > m - 1) r = m - 1;
+    d = C_DEV_MUL * sqrt_floor(m) + 1;
+    rl = (r > d) ? r - d : 0;
+    rh = (m - 1 - r > d) ? r + d : m - 1;
+    select_serial(sample,
+		  m,
+		  elt_size,
+		  rl,
+		  elt_ptr(pivs, 2, elt_size),
+		  &g,
+		  cmp);
+    select_serial(elt_ptr(sample, rl, elt_size),
+		  m - rl,
+		  elt_size,
+		  rh - rl,
+		  elt_ptr(pivs, 2, elt_size),
+		  &g,
+		  cmp);
+    memcpy(pivs, elt_ptr(sample, rl, elt_size), elt_size);
+    memcpy(elt_ptr(pivs, 1, elt_size),
+	   elt_ptr(sample, rh, elt_size),
+	   elt_size);
+    nt = (num_threads < n) ? num_threads : n;
+    partition(pas, ids, nt, lo, hi, src, dst);
+    c0 = 0;
+    c1 = 0;
+    for (i = 0; i < nt; i++){
+      c0 += pas[i].counts[0];
+      c1 += pas[i].counts[1];
+    }
+    if (k < lo + c0){
+      next_lo = lo;
+      next_hi = lo + c0;
+    }else if (k >= lo + c0 + c1){
+      next_lo = lo + c0 + c1;
+      next_hi = hi;
+    }else{
+      next_lo = lo + c0;
+      next_hi = next_lo + c1;
+      /* the middle part consists of elements equal to the pivots */
+      if (cmp(pivs, elt_ptr(pivs, 1, elt_size)) == 0) found = 1;
+    }
+    if (dst != elts){
+      /* the parts outside the next range are final */
+      for (i = 0; i < nt; i++){
+	pas[i].keep_start = next_lo;
+	pas[i].keep_end = next_hi;
+      }
+      run_threads(copy_thread, pas, ids, nt);
+    }
+    src = dst;
+    dst = (src == elts) ? buf : elts;
+    lo = next_lo;
+    hi = next_hi;
+    if (found || hi - lo == n) break; /* found or no reduction */
+  }
+  if (src != elts){
+    memcpy(elt_ptr(elts, lo, elt_size),
+	   elt_ptr(src, lo, elt_size),
+	   (hi - lo) * elt_size);
+  }
+  if (!found){
+    select_serial(elt_ptr(elts, lo, elt_size),
+		  hi - lo,
+		  elt_size,
+		  k - lo,
+		  elt_ptr(pivs, 2, elt_size),
+		  &g,
+		  cmp);
+  }
+  free(parts);
+  free(buf);
+  free(sample);
+  free(pivs);
+  free(ids);
+  free(pas);
+  parts = NULL;
+  buf = NULL;
+  sample = NULL;
+  pivs = NULL;
+  ids = NULL;
+  pas = NULL;
+}
+
+/**
+   Rearranges the elements of an array, such that the first k elements are
+   the k smallest elements of the array according to cmp in ascending
+   order. The order of the remaining elements is unspecified. The k
+   largest elements are obtained with a reversed comparison function.
+   elts        : pointer to the array
+   count       : count of elements in the array
+   elt_size    : size of each element in the array in bytes
+   k           : <= count number of elements to sort; if 0, the array is
+                 not modified
+   num_threads : > 0 number of threads for partitioning
+   sbase_count : > 0 base case upper bound for parallel selection, and for
+                 parallel sorting in mergesort_pthread
+   mbase_count : > 1 base case upper bound for parallel merging in
+                 mergesort_pthread
+   cmp         : comparison function which returns a negative integer value
+                 if the element pointed to by the first argument is less than
+                 the element pointed to by the second, a positive integer
+                 value if the element pointed to by the first argument is
+                 greater than the element pointed to by the second, and zero
+                 integer value if the two elements are equal
+*/
+void partial_sort_pthread(void *elts,
+			  size_t count,
+			  size_t elt_size,
+			  size_t k,
+			  size_t num_threads,
+			  size_t sbase_count,
+			  size_t mbase_count,
+			  int (*cmp)(const void *, const void *)){
+  if (k == 0) return;
+  if (k < count){
+    nth_pthread(elts, count, elt_size, k - 1, num_threads, sbase_count, cmp);
+  }
+  mergesort_pthread(elts, k, elt_size, sbase_count, mbase_count, cmp);
+}
+
+/**
+   Partitions the range [lo, hi) of the src block in parallel into the
+   range [lo, hi) of the dst block, in the order of the elements less than
+   the low pivot, the elements between the pivots, and the elements
+   greater than the high pivot. The part counts of each thread are set in
+   the thread arguments.
+*/
+static void partition(part_arg_t *pas,
+		      pthread_t *ids,
+		      size_t num_threads,
+		      size_t lo,
+		      size_t hi,
+		      const void *src,
+		      void *dst){
+  size_t n = hi - lo;
+  size_t step = n / num_threads, rem = n % num_threads;
+  size_t offsets[3];
+  size_t i, j;
+  for (i = 0; i < num_threads; i++){
+    /* the first rem chunks contain one additional element */
+    pas[i].start = lo + i * step + (i < rem ? i : rem);
+    pas[i].end = pas[i].start + step + (i < rem ? 1 : 0);
+    pas[i].src = src;
+    pas[i].dst = dst;
+  }
+  run_threads(count_thread, pas, ids, num_threads);
+  offsets[0] = lo;
+  offsets[1] = lo;
+  offsets[2] = lo;
+  for (i = 0; i < num_threads; i++){
+    offsets[1] += pas[i].counts[0];
+  }
+  offsets[2] = offsets[1];
+  for (i = 0; i < num_threads; i++){
+    offsets[2] += pas[i].counts[1];
+  }
+  for (i = 0; i < num_threads; i++){
+    for (j = 0; j < 3; j++){
+      pas[i].offsets[j] = offsets[j];
+      offsets[j] += pas[i].counts[j];
+    }
+  }
+  run_threads(scatter_thread, pas, ids, num_threads);
+}
+
+/**
+   Runs a thread entry function on num_threads threads, with the first
+   thread entry placed on the thread stack of the caller.
+*/
+static void run_threads(void *(*start)(void *),
+			part_arg_t *pas,
+			pthread_t *ids,
+			size_t num_threads){
+  size_t i;
+  for (i = 1; i < num_threads; i++){
+    thread_create_perror(&ids[i], start, &pas[i]);
+  }
+  start(&pas[0]);
+  for (i = 1; i < num_threads; i++){
+    thread_join_perror(ids[i], NULL);
+  }
+}
+
+/**
+   Computes the part index of each element in the chunk of a thread and
+   counts the elements of each part.
+*/
+static void *count_thread(void *arg){
+  size_t i;
+  part_arg_t *pa = arg;
+  const void *elt = NULL;
+  pa->counts[0] = 0;
+  pa->counts[1] = 0;
+  pa->counts[2] = 0;
+  for (i = pa->start; i < pa->end; i++){
+    elt = elt_ptr(pa->src, i, pa->elt_size);
+    if (pa->cmp(elt, pa->low_piv) < 0){
+      pa->parts[i] = 0;
+    }else if (pa->cmp(elt, pa->high_piv) > 0){
+      pa->parts[i] = 2;
+    }else{
+      pa->parts[i] = 1;
+    }
+    pa->counts[pa->parts[i]]++;
+  }
+  return NULL;
+}
+
+/**
+   Copies each element in the chunk of a thread to the dst block at the
+   offset of its part.
+*/
+static void *scatter_thread(void *arg){
+  size_t i;
+  part_arg_t *pa = arg;
+  for (i = pa->start; i < pa->end; i++){
+    memcpy(elt_ptr(pa->dst, pa->offsets[pa->parts[i]]++, pa->elt_size),
+	   elt_ptr(pa->src, i, pa->elt_size),
+	   pa->elt_size);
+  }
+  return NULL;
+}
+
+/**
+   Copies the chunk of a thread from the dst block to the array, except
+   the elements in the next range [keep_start, keep_end).
+*/
+static void *copy_thread(void *arg){
+  part_arg_t *pa = arg;
+  copy_range(pa,
+	     pa->start,
+	     (pa->end < pa->keep_start) ? pa->end : pa->keep_start);
+  copy_range(pa,
+	     (pa->start > pa->keep_end) ? pa->start : pa->keep_end,
+	     pa->end);
+  return NULL;
+}
+
+static void copy_range(part_arg_t *pa, size_t start, size_t end){
+  if (start >= end) return;
+  memcpy(elt_ptr(pa->elts, start, pa->elt_size),
+	 elt_ptr(pa->dst, start, pa->elt_size),
+	 (end - start) * pa->elt_size);
+}
+
+/**
+   Selects the element at index k of an array with introselect. The piv
+   block holds two elements for the pivot and swapping.
+*/
+static void select_serial(void *elts,
+			  size_t count,
+			  size_t elt_size,
+			  size_t k,
+			  void *piv,
+			  xoshiro256_t *g,
+			  int (*cmp)(const void *, const void *)){
+  select_rec(elts, count, elt_size, k, piv, g, 2 * log2_floor(count), cmp);
+}
+
+/**
+   Selects the element at index k of an array with quickselect with a
+   3-way partition. The pivot is a random element until max_bad partitions
+   kept more than 3/4 of a range, and a median of medians afterwards.
+*/
+static void select_rec(void *elts,
+		       size_t count,
+		       size_t elt_size,
+		       size_t k,
+		       void *piv,
+		       xoshiro256_t *g,
+		       size_t max_bad,
+		       int (*cmp)(const void *, const void *)){
+  int c;
+  size_t lt, gt, i, prev_count;
+  void *tmp = elt_ptr(piv, 1, elt_size);
+  while (count > 1){
+    if (max_bad > 0){
+      memcpy(piv,
+	     elt_ptr(elts, xoshiro256_range(g, count), elt_size),
+	     elt_size);
+    }else{
+      mom_pivot(elts, count, elt_size, piv, g, cmp);
+    }
+    /* [0, lt) < piv, [lt, i) == piv, [gt, count) > piv */
+    lt = 0;
+    i = 0;
+    gt = count;
+    while (i < gt){
+      c = cmp(elt_ptr(elts, i, elt_size), piv);
+      if (c < 0){
+	if (lt != i){
+	  swap(elt_ptr(elts, lt, elt_size),
+	       elt_ptr(elts, i, elt_size),
+	       tmp,
+	       elt_size);
+	}
+	lt++;
+	i++;
+      }else if (c > 0){
+	gt--;
+	swap(elt_ptr(elts, i, elt_size),
+	     elt_ptr(elts, gt, elt_size),
+	     tmp,
+	     elt_size);
+      }else{
+	i++;
+      }
+    }
+    prev_count = count;
+    if (k < lt){
+      count = lt;
+    }else if (k >= gt){
+      elts = elt_ptr(elts, gt, elt_size);
+      k -= gt;
+      count -= gt;
+    }else{
+      return;
+    }
+    if (max_bad > 0 && count > prev_count - prev_count / 4) max_bad--;
+  }
+}
+
+/**
+   Computes a median of medians of groups of C_GROUP_COUNT elements and
+   copies it to the first element of the piv block. The medians are
+   moved to the front of the array and their median is selected with
+   median-of-medians pivots.
+*/
+static void mom_pivot(void *elts,
+		      size_t count,
+		      size_t elt_size,
+		      void *piv,
+		      xoshiro256_t *g,
+		      int (*cmp)(const void *, const void *)){
+  size_t i, n, num_meds = 0;
+  void *tmp = elt_ptr(piv, 1, elt_size);
+  for (i = 0; i < count; i += C_GROUP_COUNT){
+    n = (count - i < C_GROUP_COUNT) ? count - i : C_GROUP_COUNT;
+    insertion_sort(elt_ptr(elts, i, elt_size), n, elt_size, tmp, cmp);
+    swap(elt_ptr(elts, num_meds, elt_size),
+	 elt_ptr(elts, i + (n - 1) / 2, elt_size),
+	 tmp,
+	 elt_size);
+    num_meds++;
+  }
+  select_rec(elts, num_meds, elt_size, num_meds / 2, piv, g, 0, cmp);
+  memcpy(piv, elt_ptr(elts, num_meds / 2, elt_size), elt_size);
+}
+
+/**
+   Sorts a small array with insertion sort.
+*/
+static void insertion_sort(void *elts,
+			   size_t count,
+			   size_t elt_size,
+			   void *tmp,
+			   int (*cmp)(const void *, const void *)){
+  size_t i, j;
+  for (i = 1; i < count; i++){
+    for (j = i; j > 0 && cmp(elt_ptr(elts, j - 1, elt_size),
+			     elt_ptr(elts, j, elt_size)) > 0; j--){
+      swap(elt_ptr(elts, j - 1, elt_size),
+	   elt_ptr(elts, j, elt_size),
+	   tmp,
+	   elt_size);
+    }
+  }
+}
+
+/**
+   Swaps two elements through a temporary element.
+*/
+static void swap(void *a, void *b, void *tmp, size_t elt_size){
+  memcpy(tmp, a, elt_size);
+  memcpy(a, b, elt_size);
+  memcpy(b, tmp, elt_size);
+}
+
+/**
+   Returns the floor of the base-2 logarithm of n > 0, and 0 for n = 0.
+*/
+static size_t log2_floor(size_t n){
+  size_t r = 0;
+  while (n > 1){
+    n >>= 1;
+    r++;
+  }
+  return r;
+}
+
+/**
+   Returns the floor of the square root of n.
+*/
+static size_t sqrt_floor(size_t n){
+  size_t x = n, y;
+  if (n < 2) return n;
+  y = x / 2 + 1;
+  while (y < x){
+    x = y;
+    y = (x + n / x) / 2;
+  }
+  return x;
+}
+
+/**
+   Computes a pointer to an element in an array of elements.
+*/
+static void *elt_ptr(const void *elts, size_t i, size_t elt_size){
+  return (void *)((char *)elts + i * elt_size);
+}
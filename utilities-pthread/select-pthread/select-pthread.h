@@ -0,0 +1,95 @@
+/**
+   select-pthread.h
+
+   Declarations of accessible functions for running generic selection
+   (nth element) and partial sort algorithms with parallel partitioning.
+
+   The selection algorithm follows the sampling approach of Floyd and
+   Rivest. In each round, two pivots bracketing the target rank are
+   selected from a sample of the current range, and the range is
+   partitioned in parallel into the elements less than the lower pivot,
+   the elements between the pivots, and the elements greater than the
+   upper pivot. With high probability the target rank falls into the
+   middle part, which is a small fraction of the range, resulting in
+   O(n) expected work. The parallel partition is stable and out-of-place:
+   each thread counts the elements of each part in its chunk, the counts
+   are prefix-summed into output offsets, and each thread scatters its
+   chunk into a buffer or back into the array in alternating rounds. The
+   samples are drawn at random with the generator of
+   utilities-rand-uint64. A range of at most a base case count of elements
+   is selected with serial introselect, i.e. quickselect with random
+   pivots and a 3-way partition that switches to median-of-medians pivots
+   after repeated unbalanced partitions, with O(n) worst-case work.
+
+   The partial sort selects the (k - 1)th element and sorts the first k
+   elements with mergesort_pthread, providing the top-k elements in
+   sorted order according to cmp.
+*/
+
+#ifndef SELECT_PTHREAD_H
+#define SELECT_PTHREAD_H
+
+#include <stddef.h>
+
+/**
+   Rearranges the elements of an array, such that the element at index k
+   is the element at index k in the array sorted in ascending order
+   according to cmp, each element before index k is less or equal to the
+   element at index k, and each element after index k is greater or equal
+   to the element at index k. The first thread entry is placed on the
+   thread stack of the caller.
+   elts        : pointer to the array
+   count       : > 0 count of elements in the array
+   elt_size    : size of each element in the array in bytes
+   k           : < count index of the element to select
+   num_threads : > 0 number of threads for partitioning
+   sbase_count : > 0 base case upper bound for parallel selection; if the
+                 count of a range is less or equal to sbase_count, then
+                 the range is selected with serial introselect
+   cmp         : comparison function which returns a negative integer value
+                 if the element pointed to by the first argument is less than
+                 the element pointed to by the second, a positive integer
+                 value if the element pointed to by the first argument is
+                 greater than the element pointed to by the second, and zero
+                 integer value if the two elements are equal
+*/
+void nth_pthread(void *elts,
+		 size_t count,
+		 size_t elt_size,
+		 size_t k,
+		 size_t num_threads,
+		 size_t sbase_count,
+		 int (*cmp)(const void *, const void *));
+
+/**
+   Rearranges the elements of an array, such that the first k elements are
+   the k smallest elements of the array according to cmp in ascending
+   order. The order of the remaining elements is unspecified. The k
+   largest elements are obtained with a reversed comparison function.
+   elts        : pointer to the array
+   count       : count of elements in the array
+   elt_size    : size of each element in the array in bytes
+   k           : <= count number of elements to sort; if 0, the array is
+                 not modified
+   num_threads : > 0 number of threads for partitioning
+   sbase_count : > 0 base case upper bound for parallel selection, and for
+                 parallel sorting in mergesort_pthread
+   mbase_count : > 1 base case upper bound for parallel merging in
+                 mergesort_pthread
+   cmp         : comparison function which returns a negative integer value
+                 if the element pointed to by the first argument is less than
+                 the element pointed to by the second, a positive integer
+                 value if the element pointed to by the first argument is
+                 greater than the element pointed to by the second, and zero
+                 integer value if the two elements are equal
+*/
+void partial_sort_pthread(void *elts,
+			  size_t count,
+			  size_t elt_size,
+			  size_t k,
+			  size_t num_threads,
+			  size_t sbase_count,
+			  size_t mbase_count,
+			  int (*cmp)(const void *, const void *));
+
+#endif
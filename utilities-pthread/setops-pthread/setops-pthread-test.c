@@ -0,0 +1,465 @@
+/**
+   setops-pthread-test.c
+
+   Correctness and performance tests of generic deduplication and set
+   operations on arrays with parallel sorting, splitting and compaction.
+
+   The following command line arguments can be used to customize tests:
+   setops-pthread-test
+      [0, # bits in size_t - 1) : a
+      [0, # bits in size_t - 1) : b s.t. 2^a <= count <= 2^b
+      [0, # bits in size_t) : c s.t. 2^c sort base case bound
+      [1, # bits in size_t) : d s.t. 2^d merge base case bound
+      [0, # bits in size_t) : e s.t. 1 <= # threads <= 2^e
+      [0, 1] : int corner test on/off
+      [0, 1] : int unique performance test on/off
+      [0, 1] : int set operation performance test on/off
+
+   usage examples:
+   ./setops-pthread-test
+   ./setops-pthread-test 20 20
+   ./setops-pthread-test 22 24 15 15 3
+   ./setops-pthread-test 22 24 15 15 3 0 1 0
+
+   setops-pthread-test can be run with any subset of command line
+   arguments in the above-defined order. If the (i + 1)th argument is
+   specified then the ith argument must be specified for i >= 0. Default
+   values are used for the unspecified arguments according to the
+   C_ARGS_DEF array.
+
+   The runtimes are measured with utilities-bench and can be written as
+   csv or json records by setting BENCH_FORMAT and BENCH_OUT, e.g.
+   BENCH_FORMAT=json BENCH_OUT=setops-pthread.json ./setops-pthread-test 20 20
+
+   The implementation of tests does not use stdint.h and is portable under
+   C89/C90 with the requirements that CHAR_BIT * sizeof(size_t) is even and
+   pthreads API is available.
+*/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include "setops-pthread.h"
+#include "utilities-bench.h"
+#include "utilities-mem.h"
+#include "utilities-mod.h"
+
+/**
+   Generate random numbers in a portable way for test purposes only; rand()
+   in the Linux C Library uses the same generator as random(), which may not
+   be the case on older rand() implementations, and on current
+   implementations on different systems.
+*/
+#ifdef TEST_SEED
+#define RGENS_SEED() do{srand(TEST_SEED);}while (0)
+#else
+#define RGENS_SEED() do{srand(time(NULL));}while (0)
+#endif
+#define RANDOM() (rand()) /* [0, RAND_MAX] */
+#define DRAND() ((double)rand() / RAND_MAX) /* [0.0, 1.0] */
+
+#define TOLU(i) ((unsigned long int)(i)) /* printing size_t under C89/C90 */
+
+/* input handling */
+const char *C_USAGE =
+  "setops-pthread-test \n"
+  "[0, # bits in size_t - 1) : a \n"
+  "[0, # bits in size_t - 1) : b s.t. 2^a <= count <= 2^b \n"
+  "[0, # bits in size_t) : c s.t. 2^c sort base case bound \n"
+  "[1, # bits in size_t) : d s.t. 2^d merge base case bound \n"
+  "[0, # bits in size_t) : e s.t. 1 <= # threads <= 2^e \n"
+  "[0, 1] : int corner test on/off \n"
+  "[0, 1] : int unique performance test on/off \n"
+  "[0, 1] : int set operation performance test on/off \n";
+const int C_ARGC_MAX = 9;
+const size_t C_ARGS_DEF[8] = {20, 20, 15, 15, 2, 1, 1, 1};
+const size_t C_FULL_BIT = CHAR_BIT * sizeof(size_t);
+
+/* tests */
+const char *C_SUITE = "setops-pthread-test";
+
+/* corner cases */
+const size_t C_CORNER_COUNT_MAX = 29;
+const size_t C_CORNER_THREADS_MAX = 5;
+const int C_CORNER_RANGES[2] = {7, 64}; /* many and few duplicates */
+const size_t C_NUM_CORNER_RANGES = 2;
+
+/* performance tests */
+const size_t C_TRIALS = 5;
+const int C_UNIQUE_RANGE_DIVS[2] = {1, 16}; /* range = count / div */
+const size_t C_NUM_UNIQUE_RANGE_DIVS = 2;
+
+int cmp_int(const void *a, const void *b);
+size_t unique_ref(int *arr, size_t count);
+size_t setop_ref(int op,
+		 int *out,
+		 const int *a,
+		 size_t a_count,
+		 const int *b,
+		 size_t b_count);
+size_t run_setop(int op,
+		 int *out,
+		 const int *a,
+		 size_t a_count,
+		 const int *b,
+		 size_t b_count,
+		 size_t num_threads);
+void fill_random(int *arr, size_t count, int range);
+void report(const bench_t *b,
+	    const char *label,
+	    size_t count,
+	    int range,
+	    size_t nt);
+void print_test_result(int res);
+
+enum{UNION_OP, INTERSECTION_OP, DIFFERENCE_OP};
+const char *C_OP_NAMES[3] = {"union_pthread",
+			     "intersection_pthread",
+			     "difference_pthread"};
+const size_t C_NUM_OPS = 3;
+
+int cmp_int(const void *a, const void *b){
+  if (*(int *)a > *(int *)b){
+    return 1;
+  }else if  (*(int *)a < *(int *)b){
+    return -1;
+  }else{
+    return 0;
+  }
+}
+
+/**
+   Serial reference deduplication of a sorted array. Returns the count of
+   the unique elements.
+*/
+size_t unique_ref(int *arr, size_t count){
+  size_t i, n = 0;
+  for (i = 0; i < count; i++){
+    if (n == 0 || arr[n - 1] != arr[i]) arr[n++] = arr[i];
+  }
+  return n;
+}
+
+/**
+   Serial reference set operations on sorted arrays without duplicates.
+   Returns the count of the output.
+*/
+size_t setop_ref(int op,
+		 int *out,
+		 const int *a,
+		 size_t a_count,
+		 const int *b,
+		 size_t b_count){
+  size_t i = 0, j = 0, n = 0;
+  while (i < a_count || j < b_count){
+    if (j == b_count || (i < a_count && a[i] < b[j])){
+      if (op != INTERSECTION_OP) out[n++] = a[i];
+      i++;
+    }else if (i == a_count || b[j] < a[i]){
+      if (op == UNION_OP) out[n++] = b[j];
+      j++;
+    }else{
+      if (op != DIFFERENCE_OP) out[n++] = a[i];
+      i++;
+      j++;
+    }
+  }
+  return n;
+}
+
+size_t run_setop(int op,
+		 int *out,
+		 const int *a,
+		 size_t a_count,
+		 const int *b,
+		 size_t b_count,
+		 size_t num_threads){
+  size_t elt_size = sizeof(int);
+  if (op == UNION_OP){
+    return union_pthread(out, a, a_count, b, b_count, elt_size,
+			 num_threads, cmp_int);
+  }else if (op == INTERSECTION_OP){
+    return intersection_pthread(out, a, a_count, b, b_count, elt_size,
+				num_threads, cmp_int);
+  }else{
+    return difference_pthread(out, a, a_count, b, b_count, elt_size,
+			      num_threads, cmp_int);
+  }
+}
+
+/**
+   Fills an array with random integers in [0, range).
+*/
+void fill_random(int *arr, size_t count, int range){
+  size_t i;
+  for (i = 0; i < count; i++){
+    arr[i] = RANDOM() % range;
+  }
+}
+
+/**
+   Runs unique_pthread and set operation corner cases tests on random
+   integer arrays with many and few duplicates across all pairs of counts
+   up to C_CORNER_COUNT_MAX and numbers of threads, including numbers of
+   threads greater than the counts.
+*/
+void run_int_corner_test(){
+  int res = 1;
+  int *arr_a = NULL, *arr_b = NULL, *arr_u = NULL, *arr_r = NULL;
+  int *out = NULL, *out_r = NULL;
+  size_t a_count, b_count, ua_count, ub_count, n, n_r, nt, ri, op;
+  size_t elt_size = sizeof(int);
+  arr_a = malloc_perror(C_CORNER_COUNT_MAX, elt_size);
+  arr_b = malloc_perror(C_CORNER_COUNT_MAX, elt_size);
+  arr_u = malloc_perror(C_CORNER_COUNT_MAX, elt_size);
+  arr_r = malloc_perror(C_CORNER_COUNT_MAX, elt_size);
+  out = malloc_perror(2 * C_CORNER_COUNT_MAX, elt_size);
+  out_r = malloc_perror(2 * C_CORNER_COUNT_MAX, elt_size);
+  printf("Test unique_pthread and set operations on corner cases on "
+	 "random integer arrays\n");
+  for (ri = 0; ri < C_NUM_CORNER_RANGES; ri++){
+    for (a_count = 0; a_count <= C_CORNER_COUNT_MAX; a_count++){
+      fill_random(arr_a, a_count, C_CORNER_RANGES[ri]);
+      memcpy(arr_r, arr_a, a_count * elt_size);
+      qsort(arr_r, a_count, elt_size, cmp_int);
+      n_r = unique_ref(arr_r, a_count);
+      for (nt = 1; nt <= C_CORNER_THREADS_MAX; nt++){
+	memcpy(arr_u, arr_a, a_count * elt_size);
+	n = unique_pthread(arr_u, a_count, elt_size, nt, 1, 2, cmp_int);
+	res *= (n == n_r && memcmp(arr_u, arr_r, n * elt_size) == 0);
+      }
+      ua_count = n_r;
+      memcpy(arr_a, arr_r, ua_count * elt_size);
+      for (b_count = 0; b_count <= C_CORNER_COUNT_MAX; b_count++){
+	fill_random(arr_b, b_count, C_CORNER_RANGES[ri]);
+	qsort(arr_b, b_count, elt_size, cmp_int);
+	ub_count = unique_ref(arr_b, b_count);
+	for (op = 0; op < C_NUM_OPS; op++){
+	  n_r = setop_ref(op, out_r, arr_a, ua_count, arr_b, ub_count);
+	  for (nt = 1; nt <= C_CORNER_THREADS_MAX; nt++){
+	    n = run_setop(op, out, arr_a, ua_count, arr_b, ub_count, nt);
+	    res *= (n == n_r && memcmp(out, out_r, n * elt_size) == 0);
+	  }
+	}
+      }
+    }
+  }
+  printf("\tcorrectness:       ");
+  print_test_result(res);
+  free(arr_a);
+  free(arr_b);
+  free(arr_u);
+  free(arr_r);
+  free(out);
+  free(out_r);
+  arr_a = NULL;
+  arr_b = NULL;
+  arr_u = NULL;
+  arr_r = NULL;
+  out = NULL;
+  out_r = NULL;
+}
+
+/**
+   Runs a test comparing unique_pthread vs. qsort followed by a serial
+   deduplication on random integer arrays with many and few duplicates
+   across numbers of threads.
+*/
+void run_int_unique_perf_test(int pow_count_start,
+			      int pow_count_end,
+			      size_t sbase,
+			      size_t mbase,
+			      int pow_threads_end){
+  int res = 1;
+  int *arr_a = NULL, *arr_b = NULL;
+  int ci, range;
+  size_t count, nt, n, n_r;
+  size_t i, di;
+  size_t elt_size = sizeof(int);
+  bench_t b_u, b_q;
+  arr_a = malloc_perror(pow_two(pow_count_end), elt_size);
+  arr_b = malloc_perror(pow_two(pow_count_end), elt_size);
+  printf("Test unique_pthread performance on random integer arrays\n");
+  for (ci = pow_count_start; ci <= pow_count_end; ci++){
+    count = pow_two(ci); /* > 0 */
+    for (di = 0; di < C_NUM_UNIQUE_RANGE_DIVS; di++){
+      range = count / C_UNIQUE_RANGE_DIVS[di];
+      if (range < 1) range = 1;
+      if (range > RAND_MAX) range = RAND_MAX;
+      printf("\t# trials: %lu, array count: %lu, value range: %d\n",
+	     TOLU(C_TRIALS), TOLU(count), range);
+      for (nt = 1; nt <= pow_two(pow_threads_end); nt *= 2){
+	bench_init(&b_u, C_SUITE, "unique_pthread", 0, C_TRIALS);
+	if (nt == 1){
+	  bench_init(&b_q, C_SUITE, "qsort and serial unique", 0, C_TRIALS);
+	}
+	for (i = 0; i < C_TRIALS; i++){
+	  fill_random(arr_a, count, range);
+	  memcpy(arr_b, arr_a, count * elt_size);
+	  bench_start(&b_u);
+	  n = unique_pthread(arr_a, count, elt_size, nt, sbase, mbase,
+			     cmp_int);
+	  bench_stop(&b_u);
+	  if (nt == 1) bench_start(&b_q);
+	  qsort(arr_b, count, elt_size, cmp_int);
+	  n_r = unique_ref(arr_b, count);
+	  if (nt == 1) bench_stop(&b_q);
+	  res *= (n == n_r && memcmp(arr_a, arr_b, n * elt_size) == 0);
+	}
+	if (nt == 1){
+	  report(&b_q, "\t\tqsort and serial unique:      ", count, range, nt);
+	  bench_free(&b_q);
+	}
+	report(&b_u, "\t\t# threads: %lu, unique_pthread: ", count, range, nt);
+	bench_free(&b_u);
+      }
+      printf("\t\tcorrectness:                      ");
+      print_test_result(res);
+    }
+  }
+  free(arr_a);
+  free(arr_b);
+  arr_a = NULL;
+  arr_b = NULL;
+}
+
+/**
+   Runs a test comparing the set operations vs. the serial reference on
+   pairs of random integer sets of equal count with a half of the elements
+   in common on average across numbers of threads.
+*/
+void run_int_setop_perf_test(int pow_count_start,
+			     int pow_count_end,
+			     size_t sbase,
+			     size_t mbase,
+			     int pow_threads_end){
+  int res = 1;
+  int *arr_a = NULL, *arr_b = NULL, *out = NULL, *out_r = NULL;
+  int ci, range;
+  size_t count, a_count, b_count, nt, n, n_r, op;
+  size_t i;
+  size_t elt_size = sizeof(int);
+  bench_t b_s, b_r;
+  arr_a = malloc_perror(pow_two(pow_count_end), elt_size);
+  arr_b = malloc_perror(pow_two(pow_count_end), elt_size);
+  out = malloc_perror(pow_two(pow_count_end + 1), elt_size);
+  out_r = malloc_perror(pow_two(pow_count_end + 1), elt_size);
+  printf("Test set operation performance on random integer sets\n");
+  for (ci = pow_count_start; ci <= pow_count_end; ci++){
+    count = pow_two(ci); /* > 0 */
+    range = (count > RAND_MAX / 2) ? RAND_MAX : 2 * count;
+    for (op = 0; op < C_NUM_OPS; op++){
+      printf("\t%s, # trials: %lu, array count: %lu\n",
+	     C_OP_NAMES[op], TOLU(C_TRIALS), TOLU(count));
+      for (nt = 1; nt <= pow_two(pow_threads_end); nt *= 2){
+	bench_init(&b_s, C_SUITE, C_OP_NAMES[op], 0, C_TRIALS);
+	if (nt == 1) bench_init(&b_r, C_SUITE, "serial reference", 0, C_TRIALS);
+	for (i = 0; i < C_TRIALS; i++){
+	  fill_random(arr_a, count, range);
+	  fill_random(arr_b, count, range);
+	  a_count = unique_pthread(arr_a, count, elt_size, nt, sbase, mbase,
+				   cmp_int);
+	  b_count = unique_pthread(arr_b, count, elt_size, nt, sbase, mbase,
+				   cmp_int);
+	  bench_start(&b_s);
+	  n = run_setop(op, out, arr_a, a_count, arr_b, b_count, nt);
+	  bench_stop(&b_s);
+	  if (nt == 1) bench_start(&b_r);
+	  n_r = setop_ref(op, out_r, arr_a, a_count, arr_b, b_count);
+	  if (nt == 1) bench_stop(&b_r);
+	  res *= (n == n_r && memcmp(out, out_r, n * elt_size) == 0);
+	}
+	if (nt == 1){
+	  report(&b_r, "\t\tserial reference:         ", count, range, nt);
+	  bench_free(&b_r);
+	}
+	report(&b_s, "\t\t# threads: %lu, operation: ", count, range, nt);
+	bench_free(&b_s);
+      }
+      printf("\t\tcorrectness:                  ");
+      print_test_result(res);
+    }
+  }
+  free(arr_a);
+  free(arr_b);
+  free(out);
+  free(out_r);
+  arr_a = NULL;
+  arr_b = NULL;
+  out = NULL;
+  out_r = NULL;
+}
+
+/**
+   Reports a benchmark with the count, the value range, and the number of
+   threads. The label may contain a %lu conversion for the number of
+   threads.
+*/
+void report(const bench_t *b,
+	    const char *label,
+	    size_t count,
+	    int range,
+	    size_t nt){
+  char label_buf[128], params[64];
+  sprintf(label_buf, label, TOLU(nt));
+  sprintf(params,
+	  "n=%lu range=%d threads=%lu",
+	  TOLU(count),
+	  range,
+	  TOLU(nt));
+  bench_report(b, label_buf, params);
+}
+
+void print_test_result(int res){
+  if (res){
+    printf("SUCCESS\n");
+  }else{
+    printf("FAILURE\n");
+  }
+}
+
+int main(int argc, char *argv[]){
+  int i;
+  size_t *args = NULL;
+  RGENS_SEED();
+  if (argc > C_ARGC_MAX){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  args = malloc_perror(C_ARGC_MAX - 1, sizeof(size_t));
+  memcpy(args, C_ARGS_DEF, (C_ARGC_MAX - 1) * sizeof(size_t));
+  for (i = 1; i < argc; i++){
+    args[i - 1] = atoi(argv[i]);
+  }
+  if (args[0] > C_FULL_BIT - 2 ||
+      args[1] > C_FULL_BIT - 2 ||
+      args[2] > C_FULL_BIT - 1 ||
+      args[3] > C_FULL_BIT - 1 ||
+      args[4] > C_FULL_BIT - 1 ||
+      args[3] < 1 ||
+      args[0] > args[1] ||
+      args[5] > 1 ||
+      args[6] > 1 ||
+      args[7] > 1){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  if (args[5]) run_int_corner_test();
+  if (args[6]) run_int_unique_perf_test(args[0],
+					args[1],
+					pow_two(args[2]),
+					pow_two(args[3]),
+					args[4]);
+  if (args[7]) run_int_setop_perf_test(args[0],
+				       args[1],
+				       pow_two(args[2]),
+				       pow_two(args[3]),
+				       args[4]);
+  free(args);
+  args = NULL;
+  return 0;
+}
@@ -0,0 +1,333 @@
+/**
+   setops-pthread.c
+
+   Functions for running generic deduplication and set operations on
+   arrays with parallel sorting, splitting and compaction.
+
+   A set is represented by an array sorted in ascending order according to
+   cmp without duplicates, e.g. the output of unique_pthread. A binary set
+   operation splits the larger array into num_threads ranges of equal
+   count, and splits the smaller array at the first elements that are
+   greater or equal to the first elements of the ranges by binary search,
+   so that equal elements are in the same pair of ranges. Each thread
+   counts the output of its pair of ranges in a first pass, the counts are
+   prefix-summed into output offsets, and each thread writes its compacted
+   output in a second pass. Deduplication sorts an array with
+   mergesort_pthread and compacts the runs of equal elements in the same
+   manner, with the array split into ranges of equal count.
+
+   The implementation does not use stdint.h and is portable under C89/C90
+   with the requirement that pthreads API is available.
+*/
+
+#define _POSIX_C_SOURCE 200112L
+
+#define UTILITIES_MEM_TAG MEM_TAG_SORT
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "setops-pthread.h"
+#include "mergesort-pthread.h"
+#include "utilities-alg.h"
+#include "utilities-mem.h"
+#include "utilities-pthread.h"
+
+typedef enum{UNIQUE, UNION, INTERSECTION, DIFFERENCE} op_t;
+
+typedef struct{
+  size_t a_start, a_end; /* range of the first array */
+  size_t b_start, b_end; /* range of the second array */
+  size_t count; /* count of the output of the ranges */
+  size_t offset; /* offset of the output of the ranges */
+  size_t elt_size;
+  int write; /* 0 in the counting pass, 1 in the writing pass */
+  op_t op;
+  const void *a;
+  const void *b;
+  void *out;
+  int (*cmp)(const void *, const void *);
+} setop_arg_t;
+
+static size_t run_setop(op_t op,
+			void *out,
+			const void *a,
+			size_t a_count,
+			const void *b,
+			size_t b_count,
+			size_t elt_size,
+			size_t num_threads,
+			int (*cmp)(const void *, const void *));
+static void run_passes(setop_arg_t *sas, size_t num_threads);
+static void *setop_thread(void *arg);
+static void emit(setop_arg_t *sa, const void *elts, size_t i, size_t n);
+static void *elt_ptr(const void *elts, size_t i, size_t elt_size);
+
+/**
+   Sorts an array in ascending order according to cmp and removes
+   duplicates. Returns the count of the unique elements, which are in the
+   beginning of the array in ascending order. The order of the remaining
+   elements is unspecified.
+   elts        : pointer to the array
+   count       : count of elements in the array
+   elt_size    : size of each element in the array in bytes
+   num_threads : > 0 number of threads for compaction
+   sbase_count : > 0 base case upper bound for parallel sorting in
+                 mergesort_pthread
+   mbase_count : > 1 base case upper bound for parallel merging in
+                 mergesort_pthread
+   cmp         : comparison function which returns a negative integer value
+                 if the element pointed to by the first argument is less than
+                 the element pointed to by the second, a positive integer
+                 value if the element pointed to by the first argument is
+                 greater than the element pointed to by the second, and zero
+                 integer value if the two elements are equal
+*/
+size_t unique_pthread(void *elts,
+		      size_t count,
+		      size_t elt_size,
+		      size_t num_threads,
+		      size_t sbase_count,
+		      size_t mbase_count,
+		      int (*cmp)(const void *, const void *)){
+  mergesort_pthread(elts, count, elt_size, sbase_count, mbase_count, cmp);
+  return unique_sorted_pthread(elts, count, elt_size, num_threads, cmp);
+}
+
+/**
+   Removes duplicates from an array sorted in ascending order according to
+   cmp, as in unique_pthread without sorting. Returns the count of the
+   unique elements.
+*/
+size_t unique_sorted_pthread(void *elts,
+			     size_t count,
+			     size_t elt_size,
+			     size_t num_threads,
+			     int (*cmp)(const void *, const void *)){
+  size_t ret;
+  void *buf = NULL;
+  if (count < 2) return count;
+  buf = malloc_perror(count, elt_size);
+  ret = run_setop(UNIQUE, buf, elts, count, NULL, 0, elt_size,
+		  num_threads, cmp);
+  memcpy(elts, buf, ret * elt_size);
+  free(buf);
+  buf = NULL;
+  return ret;
+}
+
+/**
+   Computes the union, intersection, or difference of two sets and returns
+   the count of the output set. Each input is an array sorted in ascending
+   order according to cmp without duplicates, and the output is an array
+   sorted in ascending order according to cmp without duplicates. An
+   element in the intersection is copied from the first set.
+   out         : pointer to a preallocated output array with the count at
+                 least a_count + b_count for the union, min(a_count,
+                 b_count) for the intersection, and a_count for the
+                 difference; does not overlap with the input arrays
+   a           : pointer to the first set
+   a_count     : count of elements in the first set
+   b           : pointer to the second set
+   b_count     : count of elements in the second set
+   elt_size    : size of each element in the sets in bytes
+   num_threads : > 0 number of threads
+   cmp         : comparison function which returns a negative integer value
+                 if the element pointed to by the first argument is less than
+                 the element pointed to by the second, a positive integer
+                 value if the element pointed to by the first argument is
+                 greater than the element pointed to by the second, and zero
+                 integer value if the two elements are equal
+*/
+size_t union_pthread(void *out,
+		     const void *a,
+		     size_t a_count,
+		     const void *b,
+		     size_t b_count,
+		     size_t elt_size,
+		     size_t num_threads,
+		     int (*cmp)(const void *, const void *)){
+  return run_setop(UNION, out, a, a_count, b, b_count, elt_size,
+		   num_threads, cmp);
+}
+
+size_t intersection_pthread(void *out,
+			    const void *a,
+			    size_t a_count,
+			    const void *b,
+			    size_t b_count,
+			    size_t elt_size,
+			    size_t num_threads,
+			    int (*cmp)(const void *, const void *)){
+  return run_setop(INTERSECTION, out, a, a_count, b, b_count, elt_size,
+		   num_threads, cmp);
+}
+
+/**
+   Computes the elements of the first set that are not in the second set.
+*/
+size_t difference_pthread(void *out,
+			  const void *a,
+			  size_t a_count,
+			  const void *b,
+			  size_t b_count,
+			  size_t elt_size,
+			  size_t num_threads,
+			  int (*cmp)(const void *, const void *)){
+  return run_setop(DIFFERENCE, out, a, a_count, b, b_count, elt_size,
+		   num_threads, cmp);
+}
+
+/**
+   Splits the arrays into num_threads pairs of ranges, and runs the
+   counting and writing passes of an operation. In a unique operation, the
+   second array is empty and only the first array is split.
+*/
+static size_t run_setop(op_t op,
+			void *out,
+			const void *a,
+			size_t a_count,
+			const void *b,
+			size_t b_count,
+			size_t elt_size,
+			size_t num_threads,
+			int (*cmp)(const void *, const void *)){
+  int a_larger = (a_count >= b_count);
+  size_t l_count = a_larger ? a_count : b_count;
+  size_t s_count = a_larger ? b_count : a_count;
+  size_t step, rem, ls, ss, ret;
+  size_t i;
+  const void *l = a_larger ? a : b, *s = a_larger ? b : a;
+  setop_arg_t *sas = NULL;
+  if (l_count == 0) return 0;
+  if (num_threads > l_count) num_threads = l_count;
+  step = l_count / num_threads;
+  rem = l_count % num_threads;
+  sas = malloc_perror(num_threads, sizeof(setop_arg_t));
+  for (i = 0; i < num_threads; i++){
+    /* the first rem ranges contain one additional element */
+    ls = i * step + (i < rem ? i : rem);
+    ss = (i == 0) ? 0 : first_geq_bsearch(elt_ptr(l, ls, elt_size),
+					  s,
+					  s_count,
+					  elt_size,
+					  cmp);
+    if (a_larger){
+      sas[i].a_start = ls;
+      sas[i].b_start = ss;
+    }else{
+      sas[i].a_start = ss;
+      sas[i].b_start = ls;
+    }
+    if (i > 0){
+      sas[i - 1].a_end = sas[i].a_start;
+      sas[i - 1].b_end = sas[i].b_start;
+    }
+    sas[i].elt_size = elt_size;
+    sas[i].op = op;
+    sas[i].a = a;
+    sas[i].b = b;
+    sas[i].out = out;
+    sas[i].cmp = cmp;
+  }
+  sas[num_threads - 1].a_end = a_count;
+  sas[num_threads - 1].b_end = b_count;
+  run_passes(sas, num_threads);
+  ret = sas[num_threads - 1].offset + sas[num_threads - 1].count;
+  free(sas);
+  sas = NULL;
+  return ret;
+}
+
+/**
+   Runs the counting pass, computes the output offsets, and runs the
+   writing pass. The first thread entry of each pass is placed on the
+   thread stack of the caller.
+*/
+static void run_passes(setop_arg_t *sas, size_t num_threads){
+  int write;
+  size_t offset = 0;
+  size_t i;
+  pthread_t *ids = NULL;
+  ids = malloc_perror(num_threads, sizeof(pthread_t));
+  for (write = 0; write <= 1; write++){
+    for (i = 0; i < num_threads; i++){
+      sas[i].write = write;
+      if (write){
+	sas[i].offset = offset;
+	offset += sas[i].count;
+      }
+    }
+    for (i = 1; i < num_threads; i++){
+      thread_create_perror(&ids[i], setop_thread, &sas[i]);
+    }
+    setop_thread(&sas[0]);
+    for (i = 1; i < num_threads; i++){
+      thread_join_perror(ids[i], NULL);
+    }
+  }
+  free(ids);
+  ids = NULL;
+}
+
+/**
+   Counts or writes the output of an operation on a pair of ranges.
+*/
+static void *setop_thread(void *arg){
+  int c;
+  size_t i, j;
+  size_t elt_size;
+  setop_arg_t *sa = arg;
+  elt_size = sa->elt_size;
+  sa->count = 0;
+  if (sa->op == UNIQUE){
+    for (i = sa->a_start; i < sa->a_end; i++){
+      if (i == 0 ||
+	  sa->cmp(elt_ptr(sa->a, i - 1, elt_size),
+		  elt_ptr(sa->a, i, elt_size)) != 0){
+	emit(sa, sa->a, i, 1);
+      }
+    }
+    return NULL;
+  }
+  i = sa->a_start;
+  j = sa->b_start;
+  while (i < sa->a_end && j < sa->b_end){
+    c = sa->cmp(elt_ptr(sa->a, i, elt_size), elt_ptr(sa->b, j, elt_size));
+    if (c < 0){
+      if (sa->op != INTERSECTION) emit(sa, sa->a, i, 1);
+      i++;
+    }else if (c > 0){
+      if (sa->op == UNION) emit(sa, sa->b, j, 1);
+      j++;
+    }else{
+      if (sa->op != DIFFERENCE) emit(sa, sa->a, i, 1);
+      i++;
+      j++;
+    }
+  }
+  if (sa->op != INTERSECTION) emit(sa, sa->a, i, sa->a_end - i);
+  if (sa->op == UNION) emit(sa, sa->b, j, sa->b_end - j);
+  return NULL;
+}
+
+/**
+   Adds n elements starting at index i of an array to the output count, and
+   copies the elements to the output in the writing pass.
+*/
+static void emit(setop_arg_t *sa, const void *elts, size_t i, size_t n){
+  if (sa->write && n > 0){
+    memcpy(elt_ptr(sa->out, sa->offset + sa->count, sa->elt_size),
+	   elt_ptr(elts, i, sa->elt_size),
+	   n * sa->elt_size);
+  }
+  sa->count += n;
+}
+
+/**
+   Computes a pointer to an element in an array of elements.
+*/
+static void *elt_ptr(const void *elts, size_t i, size_t elt_size){
+  return (void *)((char *)elts + i * elt_size);
+}
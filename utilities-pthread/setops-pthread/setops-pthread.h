@@ -0,0 +1,118 @@
+/**
+   setops-pthread.h
+
+   Declarations of accessible functions for running generic deduplication
+   and set operations on arrays with parallel sorting, splitting and
+   compaction.
+
+   A set is represented by an array sorted in ascending order according to
+   cmp without duplicates, e.g. the output of unique_pthread. A binary set
+   operation splits the larger array into num_threads ranges of equal
+   count, and splits the smaller array at the first elements that are
+   greater or equal to the first elements of the ranges by binary search,
+   so that equal elements are in the same pair of ranges. Each thread
+   counts the output of its pair of ranges in a first pass, the counts are
+   prefix-summed into output offsets, and each thread writes its compacted
+   output in a second pass. Deduplication sorts an array with
+   mergesort_pthread and compacts the runs of equal elements in the same
+   manner, with the array split into ranges of equal count.
+*/
+
+#ifndef SETOPS_PTHREAD_H
+#define SETOPS_PTHREAD_H
+
+#include <stddef.h>
+
+/**
+   Sorts an array in ascending order according to cmp and removes
+   duplicates. Returns the count of the unique elements, which are in the
+   beginning of the array in ascending order. The order of the remaining
+   elements is unspecified.
+   elts        : pointer to the array
+   count       : count of elements in the array
+   elt_size    : size of each element in the array in bytes
+   num_threads : > 0 number of threads for compaction
+   sbase_count : > 0 base case upper bound for parallel sorting in
+                 mergesort_pthread
+   mbase_count : > 1 base case upper bound for parallel merging in
+                 mergesort_pthread
+   cmp         : comparison function which returns a negative integer value
+                 if the element pointed to by the first argument is less than
+                 the element pointed to by the second, a positive integer
+                 value if the element pointed to by the first argument is
+                 greater than the element pointed to by the second, and zero
+                 integer value if the two elements are equal
+*/
+size_t unique_pthread(void *elts,
+		      size_t count,
+		      size_t elt_size,
+		      size_t num_threads,
+		      size_t sbase_count,
+		      size_t mbase_count,
+		      int (*cmp)(const void *, const void *));
+
+/**
+   Removes duplicates from an array sorted in ascending order according to
+   cmp, as in unique_pthread without sorting. Returns the count of the
+   unique elements.
+*/
+size_t unique_sorted_pthread(void *elts,
+			     size_t count,
+			     size_t elt_size,
+			     size_t num_threads,
+			     int (*cmp)(const void *, const void *));
+
+/**
+   Computes the union, intersection, or difference of two sets and returns
+   the count of the output set. Each input is an array sorted in ascending
+   order according to cmp without duplicates, and the output is an array
+   sorted in ascending order according to cmp without duplicates. An
+   element in the intersection is copied from the first set.
+   out         : pointer to a preallocated output array with the count at
+                 least a_count + b_count for the union, min(a_count,
+                 b_count) for the intersection, and a_count for the
+                 difference; does not overlap with the input arrays
+   a           : pointer to the first set
+   a_count     : count of elements in the first set
+   b           : pointer to the second set
+   b_count     : count of elements in the second set
+   elt_size    : size of each element in the sets in bytes
+   num_threads : > 0 number of threads
+   cmp         : comparison function which returns a negative integer value
+                 if the element pointed to by the first argument is less than
+                 the element pointed to by the second, a positive integer
+                 value if the element pointed to by the first argument is
+                 greater than the element pointed to by the second, and zero
+                 integer value if the two elements are equal
+*/
+size_t union_pthread(void *out,
+		     const void *a,
+		     size_t a_count,
+		     const void *b,
+		     size_t b_count,
+		     size_t elt_size,
+		     size_t num_threads,
+		     int (*cmp)(const void *, const void *));
+
+size_t intersection_pthread(void *out,
+			    const void *a,
+			    size_t a_count,
+			    const void *b,
+			    size_t b_count,
+			    size_t elt_size,
+			    size_t num_threads,
+			    int (*cmp)(const void *, const void *));
+
+/**
+   Computes the elements of the first set that are not in the second set.
+*/
+size_t difference_pthread(void *out,
+			  const void *a,
+			  size_t a_count,
+			  const void *b,
+			  size_t b_count,
+			  size_t elt_size,
+			  size_t num_threads,
+			  int (*cmp)(const void *, const void *));
+
+#endif
@@ -2,17 +2,32 @@
    utilities-pthread.c
 
    Utility functions for concurrency, including
-   1) pthread functions with wrapped error checking, and
+   1) pthread functions with wrapped error checking,
    2) an implementation of semaphore operations based on 1),
    adopted from The Little Book of Semaphores by Allen B. Downey
-   (Version 2.2.1) with modifications.
+   (Version 2.2.1) with modifications,
+   3) a reusable barrier based on 1), and
+   4) parallel first-touch initialization of memory blocks.
 */
 
 #include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <pthread.h>
 #include "utilities-pthread.h"
+#include "utilities-mem.h"
+
+static const size_t C_TOUCH_THREAD_MIN_SIZE = 1048576; /* 1MB */
+
+typedef struct{
+  char *start;
+  size_t count;
+  size_t elt_size;
+  const void *elt;
+} touch_arg_t;
+
+static void *touch_thread(void *arg);
 
 /**
    Create a thread with default attributes and error checking. Join a thread
@@ -37,6 +52,18 @@ void thread_join_perror(pthread_t thread, void **retval){
   }
 }
 
+/**
+   Call an initialization routine once across threads with error checking.
+*/
+
+void once_perror(pthread_once_t *once, void (*init_routine)(void)){
+  int err = pthread_once(once, init_routine);
+  if (err != 0){
+    perror("pthread_once failed");
+    exit(EXIT_FAILURE);
+  }
+}
+
 /**
    Initialize with default attributes, lock, and unlock a mutex with
    error checking.
@@ -137,3 +164,100 @@ void sema_signal_perror(sema_t *sema){
   }
   mutex_unlock_perror(&sema->mutex);
 }
+
+/**
+   Initialize and wait at a barrier with error checking provided by mutex
+   and condition variable operations.
+*/
+
+void barrier_init_perror(barrier_t *barrier, size_t count){
+  barrier->count = count;
+  barrier->num_waiting = 0;
+  barrier->gen = 0;
+  mutex_init_perror(&barrier->mutex);
+  cond_init_perror(&barrier->cond);
+}
+
+void barrier_wait_perror(barrier_t *barrier){
+  size_t gen;
+  mutex_lock_perror(&barrier->mutex);
+  gen = barrier->gen;
+  barrier->num_waiting++;
+  if (barrier->num_waiting == barrier->count){
+    barrier->num_waiting = 0;
+    barrier->gen++;
+    cond_broadcast_perror(&barrier->cond);
+  }else{
+    do{
+      cond_wait_perror(&barrier->cond, &barrier->mutex);
+    }while (gen == barrier->gen); /* accounting due to spurious wakeups */
+  }
+  mutex_unlock_perror(&barrier->mutex);
+}
+
+/**
+   Initializes an array with num_threads threads, each writing a range of
+   elements of equal count. The first range is written on the thread of the
+   caller. The number of threads is lowered so that each thread writes at
+   least C_TOUCH_THREAD_MIN_SIZE bytes, and a smaller array is written on
+   the thread of the caller without creating threads.
+*/
+void first_touch_pthread(void *elts,
+			 size_t count,
+			 size_t elt_size,
+			 const void *elt,
+			 size_t num_threads){
+  size_t i, step, rem, start;
+  size_t max_num_threads = mul_sz_perror(count, elt_size) /
+    C_TOUCH_THREAD_MIN_SIZE;
+  pthread_t *ids = NULL;
+  touch_arg_t *tas = NULL;
+  touch_arg_t ta;
+  if (count == 0) return;
+  if (num_threads > max_num_threads) num_threads = max_num_threads;
+  if (num_threads > count) num_threads = count;
+  if (num_threads <= 1){
+    ta.start = elts;
+    ta.count = count;
+    ta.elt_size = elt_size;
+    ta.elt = elt;
+    touch_thread(&ta);
+    return;
+  }
+  step = count / num_threads;
+  rem = count % num_threads;
+  ids = malloc_perror(num_threads, sizeof(pthread_t));
+  tas = malloc_perror(num_threads, sizeof(touch_arg_t));
+  for (i = 0; i < num_threads; i++){
+    /* the first rem ranges contain one additional element */
+    start = i * step + (i < rem ? i : rem);
+    tas[i].start = (char *)elts + start * elt_size;
+    tas[i].count = step + (i < rem);
+    tas[i].elt_size = elt_size;
+    tas[i].elt = elt;
+  }
+  for (i = 1; i < num_threads; i++){
+    thread_create_perror(&ids[i], touch_thread, &tas[i]);
+  }
+  touch_thread(&tas[0]);
+  for (i = 1; i < num_threads; i++){
+    thread_join_perror(ids[i], NULL);
+  }
+  free(ids);
+  free(tas);
+  ids = NULL;
+  tas = NULL;
+}
+
+static void *touch_thread(void *arg){
+  size_t i;
+  touch_arg_t *ta = arg;
+  if (ta->elt == NULL){
+    memset(ta->start, 0, ta->count * ta->elt_size);
+  }else{
+    for (i = 0; i < ta->count; i++){
+      memcpy(ta->start + i * ta->elt_size, ta->elt, ta->elt_size);
+    }
+  }
+  return NULL;
+}
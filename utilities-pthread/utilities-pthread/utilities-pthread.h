@@ -2,15 +2,18 @@
    utilities-pthread.h
 
    Declarations of accessible utility functions for concurrency, including
-   1) pthread functions with wrapped error checking, and
+   1) pthread functions with wrapped error checking,
    2) an implementation of semaphore operations based on 1),
    adopted from The Little Book of Semaphores by Allen B. Downey
-   (Version 2.2.1) with modifications.
+   (Version 2.2.1) with modifications,
+   3) a reusable barrier based on 1), and
+   4) parallel first-touch initialization of memory blocks.
 */
 
 #ifndef UTILITIES_PTHREAD_H
 #define UTILITIES_PTHREAD_H
 
+#include <stddef.h>
 #include <pthread.h>
 
 typedef struct{
@@ -20,6 +23,14 @@ typedef struct{
   pthread_cond_t cond; /* the result of referring to a copy is undefined */
 } sema_t; /* the result of referring to a copy of an instance is undefined */
 
+typedef struct{
+  size_t count; /* number of threads that wait at the barrier */
+  size_t num_waiting;
+  size_t gen; /* number of times the barrier was passed */
+  pthread_mutex_t mutex; /* the result of referring to a copy is undefined */
+  pthread_cond_t cond; /* the result of referring to a copy is undefined */
+} barrier_t; /* the result of referring to a copy of an instance is undefined */
+
 
 /**
    Create a thread with default attributes and error checking. Join a thread
@@ -31,6 +42,13 @@ void thread_create_perror(pthread_t *thread,
 
 void thread_join_perror(pthread_t thread, void **retval);
 
+/**
+   Call an initialization routine once across threads with error checking.
+   The once parameter points to a pthread_once_t initialized with
+   PTHREAD_ONCE_INIT.
+*/
+void once_perror(pthread_once_t *once, void (*init_routine)(void));
+
 /**
    Initialize with default attributes, lock, and unlock a mutex with
    error checking.
@@ -66,4 +84,35 @@ void sema_wait_perror(sema_t *sema);
 
 void sema_signal_perror(sema_t *sema);
 
+/**
+   Initialize a barrier for count > 0 threads, and wait at a barrier with
+   error checking provided by mutex and condition variable operations. A
+   thread returns from barrier_wait_perror after count threads called it,
+   and the barrier is then reset for the next use.
+*/
+
+void barrier_init_perror(barrier_t *barrier, size_t count);
+
+void barrier_wait_perror(barrier_t *barrier);
+
+/**
+   Initializes an array with num_threads threads, each writing a range of
+   elements of equal count. The pages of a large block, e.g. allocated
+   with huge_malloc_perror, are then placed on the NUMA nodes of the
+   threads that first write the pages, if the system places pages on first
+   touch, and the page faults are handled in parallel. An array of less
+   than 2MB is written on the thread of the caller.
+   elts        : pointer to the array
+   count       : count of elements in the array
+   elt_size    : size of each element in bytes
+   elt         : pointer to the value of each element, or NULL if the
+                 elements are set to zero
+   num_threads : > 0 number of threads
+*/
+void first_touch_pthread(void *elts,
+			 size_t count,
+			 size_t elt_size,
+			 const void *elt,
+			 size_t num_threads);
+
 #endif
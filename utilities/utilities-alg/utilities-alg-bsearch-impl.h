@@ -0,0 +1,120 @@
+/**
+   utilities-alg-bsearch-impl.h
+
+   Typed branchless, Eytzinger, and batched binary searches. The file is
+   included by utilities-alg.c once per primitive type, with BSEARCH_T
+   defined as the type and BFN(f) defined as the name f suffixed with the
+   type name. The file does not have an include guard.
+*/
+
+/**
+   Searches for the first element that is greater or equal to key. The
+   count of the remaining range is halved in each step independently of
+   key, and the base of the range is advanced with a conditional move.
+*/
+size_t BFN(first_geq_bsearch)(BSEARCH_T key,
+			      const BSEARCH_T *elts,
+			      size_t count){
+  size_t half;
+  const BSEARCH_T *base = elts;
+  if (count == 0) return 0;
+  while (count > 1){
+    half = count / 2;
+    BSEARCH_PREFETCH(base + half / 2);
+    BSEARCH_PREFETCH(base + half + half / 2);
+    base = (base[half] < key) ? base + half : base;
+    count -= half;
+  }
+  return (base - elts) + (*base < key);
+}
+
+/**
+   Searches for num_keys keys in groups of C_BSEARCH_BATCH keys. The keys
+   of a group share the sequence of range counts and are advanced one step
+   at a time, so that the loads of a group are independent and their cache
+   misses overlap.
+*/
+void BFN(first_geq_bsearch_batch)(const BSEARCH_T *keys,
+				  size_t num_keys,
+				  const BSEARCH_T *elts,
+				  size_t count,
+				  size_t *ixs){
+  size_t i, j, n, half, batch;
+  const BSEARCH_T *bases[C_BSEARCH_BATCH];
+  for (i = 0; i < num_keys; i += batch){
+    batch = (num_keys - i < C_BSEARCH_BATCH) ? num_keys - i : C_BSEARCH_BATCH;
+    if (count == 0){
+      for (j = 0; j < batch; j++) ixs[i + j] = 0;
+      continue;
+    }
+    for (j = 0; j < batch; j++) bases[j] = elts;
+    n = count;
+    while (n > 1){
+      half = n / 2;
+      for (j = 0; j < batch; j++){
+	bases[j] = (bases[j][half] < keys[i + j]) ? bases[j] + half : bases[j];
+      }
+      n -= half;
+      for (j = 0; j < batch; j++){
+	BSEARCH_PREFETCH(bases[j] + n / 2);
+      }
+    }
+    for (j = 0; j < batch; j++){
+      ixs[i + j] = (bases[j] - elts) + (*bases[j] < keys[i + j]);
+    }
+  }
+}
+
+/**
+   Searches an array in the layout of eytz_layout for the first element
+   that is greater or equal to key. The descent selects the child with a
+   conditional move, records the last node that is greater or equal to key,
+   and prefetches the descendants C_EYTZ_PREFETCH_LEVELS levels below.
+*/
+size_t BFN(eytz_first_geq)(BSEARCH_T key,
+			   const BSEARCH_T *eytz,
+			   size_t count){
+  int t;
+  size_t k = 1, ret = 0;
+  while (k <= count){
+    BSEARCH_PREFETCH(eytz + (k << C_EYTZ_PREFETCH_LEVELS));
+    t = (eytz[k] < key);
+    ret = t ? ret : k;
+    k = 2 * k + t;
+  }
+  return ret;
+}
+
+/**
+   Searches an array in the layout of eytz_layout for num_keys keys in
+   groups of C_BSEARCH_BATCH keys, advancing the keys of a group one level
+   at a time.
+*/
+void BFN(eytz_first_geq_batch)(const BSEARCH_T *keys,
+			       size_t num_keys,
+			       const BSEARCH_T *eytz,
+			       size_t count,
+			       size_t *ixs){
+  int t;
+  size_t i, j, level, batch;
+  size_t ks[C_BSEARCH_BATCH];
+  for (i = 0; i < num_keys; i += batch){
+    batch = (num_keys - i < C_BSEARCH_BATCH) ? num_keys - i : C_BSEARCH_BATCH;
+    for (j = 0; j < batch; j++){
+      ks[j] = 1;
+      ixs[i + j] = 0;
+    }
+    /* all nodes at a level are within count if the level is complete */
+    for (level = 1; level <= count; level = 2 * level + 1){
+      for (j = 0; j < batch; j++){
+	BSEARCH_PREFETCH(eytz + (ks[j] << C_EYTZ_PREFETCH_LEVELS));
+	t = (eytz[ks[j]] < keys[i + j]);
+	ixs[i + j] = t ? ixs[i + j] : ks[j];
+	ks[j] = 2 * ks[j] + t;
+      }
+    }
+    for (j = 0; j < batch; j++){
+      if (ks[j] <= count && !(eytz[ks[j]] < keys[i + j])) ixs[i + j] = ks[j];
+    }
+  }
+}
@@ -11,18 +11,29 @@
                               geq_leq_bsearch tests
       [0, 1] : geq_leq_bsearch int test on/off
       [0, 1] : geq_leq_bsearch double test on/off
+      [0, 1] : first_geq_gt_bsearch int test on/off
+      [0, 1] : typed and Eytzinger bsearch test on/off
 
    usage examples: 
    ./utilities-alg-test
    ./utilities-alg-test 0 0 10
    ./utilities-alg-test 0 25 25
    ./utilities-alg-test 10 20 25 0 1
+   ./utilities-alg-test 10 20 25 0 0 1
+   ./utilities-alg-test 20 30 30 0 0 0 1
+
+   The last example searches arrays with 2^30 int elements and requires
+   more than 8GB of memory.
 
    utilities-alg-test can be run with any subset of command line arguments in
    the above-defined order. If the (i + 1)th argument is specified then the
    ith argument must be specified for i >= 0. Default values are used for the
    unspecified arguments according to the C_ARGS_DEF array.
 
+   The runtimes are measured with utilities-bench and can be written as
+   csv or json records by setting BENCH_FORMAT and BENCH_OUT, e.g.
+   BENCH_FORMAT=json BENCH_OUT=utilities-alg.json ./utilities-alg-test 10 20 20
+
    The implementation of tests does not use stdint.h and is portable under
    C89/C90 with the only requirement that CHAR_BIT * sizeof(size_t) is even.
 */
@@ -33,6 +44,7 @@
 #include <limits.h>
 #include <time.h>
 #include "utilities-alg.h"
+#include "utilities-bench.h"
 #include "utilities-mem.h"
 #include "utilities-mod.h"
 
@@ -42,7 +54,11 @@
    be the case on older rand() implementations, and on current
    implementations on different systems.
 */
+#ifdef TEST_SEED
+#define RGENS_SEED() do{srand(TEST_SEED);}while (0)
+#else
 #define RGENS_SEED() do{srand(time(NULL));}while (0)
+#endif
 #define RANDOM() (rand()) /* [0, RAND_MAX] */
 #define DRAND() ((double)rand() / RAND_MAX) /* [0.0, 1.0] */
 
@@ -56,16 +72,24 @@ const char *C_USAGE =
   "[0, # bits in size_t) : b s.t. 2^a <= count <= 2^b in "
   "geq_leq_bsearch tests \n"
   "[0, 1] : geq_leq_bsearch int test on/off \n"
-  "[0, 1] : geq_leq_bsearch double test on/off \n";
-const int C_ARGC_MAX = 6;
-const size_t C_ARGS_DEF[5] = {10, 10, 15, 1, 1};
+  "[0, 1] : geq_leq_bsearch double test on/off \n"
+  "[0, 1] : first_geq_gt_bsearch int test on/off \n"
+  "[0, 1] : typed and Eytzinger bsearch test on/off \n";
+const int C_ARGC_MAX = 8;
+const size_t C_ARGS_DEF[7] = {10, 10, 15, 1, 1, 1, 1};
 const size_t C_FULL_BIT = CHAR_BIT * sizeof(size_t);
 
 /* tests */
+const char *C_SUITE = "utilities-alg-test";
 const size_t C_NRAND_COUNT_MAX = 100;
 const double C_HALF_PROB = 0.5;
+const int C_DUP_RANGE = 64; /* elements in [0, C_DUP_RANGE) with duplicates */
 
 void *elt_ptr(const void *elts, size_t i, size_t elt_size);
+void report(const bench_t *b,
+	    const char *label,
+	    size_t count,
+	    size_t trials);
 void print_test_result(int result);
 
 /**
@@ -106,16 +130,19 @@ void run_geq_leq_bsearch_int_test(int pow_trials,
   int res = 1;
   int i;
   int key;
-  int *elts = NULL, *nrand_elts = NULL;
+  int *elts = NULL, *nrand_elts = NULL, *keys = NULL;
   size_t j, count;
   size_t k, trials;
   size_t elt_size = sizeof(int);
   size_t geq_ix, leq_ix;
-  double tot_geq, tot_leq, tot;
-  clock_t t_geq, t_leq, t;
+  size_t *geq_ixs = NULL, *leq_ixs = NULL;
+  bench_t b_geq, b_leq, b;
   trials = pow_two(pow_trials);
   elts = malloc_perror(pow_two(pow_count_end), elt_size);
   nrand_elts = malloc_perror(C_NRAND_COUNT_MAX, elt_size);
+  keys = malloc_perror(trials, elt_size);
+  geq_ixs = malloc_perror(trials, sizeof(size_t));
+  leq_ixs = malloc_perror(trials, sizeof(size_t));
   printf("Test geq_bsearch and leq_bsearch on random int arrays\n");
   for (i = pow_count_start; i <= pow_count_end; i++){
     count = pow_two(i);
@@ -123,35 +150,43 @@ void run_geq_leq_bsearch_int_test(int pow_trials,
       elts[j] = (DRAND() < C_HALF_PROB ? -1 : 1) * RANDOM();
     }
     qsort(elts, count, elt_size, cmp_int);
-    tot_geq = 0.0;
-    tot_leq = 0.0;
-    tot = 0.0;
-    for(k = 0; k < trials; k++){
-      key = (DRAND() < C_HALF_PROB ? -1 : 1) * RANDOM();
-      t_geq = clock();
-      geq_ix = geq_bsearch(&key, elts, count, elt_size, cmp_int);
-      t_geq = clock() - t_geq;
-      tot_geq += (double)t_geq / CLOCKS_PER_SEC;
-      t_leq = clock();
-      leq_ix = leq_bsearch(&key, elts, count, elt_size, cmp_int);
-      t_leq = clock() - t_leq;
-      tot_leq += (double)t_leq / CLOCKS_PER_SEC;
-      t = clock();
-      bsearch(&key, elts, count, elt_size, cmp_int);
-      t = clock() - t;
-      tot += (double)t / CLOCKS_PER_SEC;
-      res *= is_geq_leq_correct(&key,
+    for (k = 0; k < trials; k++){
+      keys[k] = (DRAND() < C_HALF_PROB ? -1 : 1) * RANDOM();
+    }
+    printf("\tarray count: %lu, # trials: %lu\n", TOLU(count), TOLU(trials));
+    bench_init(&b_geq, C_SUITE, "int geq_bsearch", 0, 1);
+    bench_start(&b_geq);
+    for (k = 0; k < trials; k++){
+      geq_ixs[k] = geq_bsearch(&keys[k], elts, count, elt_size, cmp_int);
+    }
+    bench_stop(&b_geq);
+    bench_init(&b_leq, C_SUITE, "int leq_bsearch", 0, 1);
+    bench_start(&b_leq);
+    for (k = 0; k < trials; k++){
+      leq_ixs[k] = leq_bsearch(&keys[k], elts, count, elt_size, cmp_int);
+    }
+    bench_stop(&b_leq);
+    bench_init(&b, C_SUITE, "int bsearch", 0, 1);
+    bench_start(&b);
+    for (k = 0; k < trials; k++){
+      bsearch(&keys[k], elts, count, elt_size, cmp_int);
+    }
+    bench_stop(&b);
+    for (k = 0; k < trials; k++){
+      res *= is_geq_leq_correct(&keys[k],
 				elts,
 				count,
 				elt_size,
-				geq_ix,
-				leq_ix,
+				geq_ixs[k],
+				leq_ixs[k],
 				cmp_int);
     }
-    printf("\tarray count: %lu, # trials: %lu\n", TOLU(count), TOLU(trials));
-    printf("\t\t\tgeq_bsearch: %.6f seconds\n", tot_geq);
-    printf("\t\t\tleq_bsearch: %.6f seconds\n", tot_geq);
-    printf("\t\t\tbsearch:     %.6f seconds\n", tot);
+    report(&b_geq, "\t\t\tgeq_bsearch: ", count, trials);
+    report(&b_leq, "\t\t\tleq_bsearch: ", count, trials);
+    report(&b, "\t\t\tbsearch:     ", count, trials);
+    bench_free(&b_geq);
+    bench_free(&b_leq);
+    bench_free(&b);
     printf("\t\t\tcorrectness: ");
     print_test_result(res);
   }
@@ -190,8 +225,14 @@ void run_geq_leq_bsearch_int_test(int pow_trials,
   print_test_result(res);
   free(elts);
   free(nrand_elts);
+  free(keys);
+  free(geq_ixs);
+  free(leq_ixs);
   elts = NULL;
   nrand_elts = NULL;
+  keys = NULL;
+  geq_ixs = NULL;
+  leq_ixs = NULL;
 }
 
 void run_geq_leq_bsearch_double_test(int pow_trials,
@@ -204,12 +245,15 @@ void run_geq_leq_bsearch_double_test(int pow_trials,
   size_t elt_size = sizeof(double);
   size_t geq_ix, leq_ix;
   double key;
-  double *elts = NULL, *nrand_elts = NULL;
-  double tot_geq, tot_leq, tot;
-  clock_t t_geq, t_leq, t;
+  double *elts = NULL, *nrand_elts = NULL, *keys = NULL;
+  size_t *geq_ixs = NULL, *leq_ixs = NULL;
+  bench_t b_geq, b_leq, b;
   trials = pow_two(pow_trials);
   elts = malloc_perror(pow_two(pow_count_end), elt_size);
   nrand_elts = malloc_perror(C_NRAND_COUNT_MAX, elt_size);
+  keys = malloc_perror(trials, elt_size);
+  geq_ixs = malloc_perror(trials, sizeof(size_t));
+  leq_ixs = malloc_perror(trials, sizeof(size_t));
   printf("Test geq_bsearch and leq_bsearch on random double arrays\n");
   for (i = pow_count_start; i <= pow_count_end; i++){
     count = pow_two(i);
@@ -217,35 +261,43 @@ void run_geq_leq_bsearch_double_test(int pow_trials,
       elts[j] = (DRAND() < C_HALF_PROB ? -1 : 1) * DRAND();
     }
     qsort(elts, count, elt_size, cmp_double);
-    tot_geq = 0.0;
-    tot_leq = 0.0;
-    tot = 0.0;
-    for(k = 0; k < trials; k++){
-      key = (DRAND() < C_HALF_PROB ? -1 : 1) * DRAND();
-      t_geq = clock();
-      geq_ix = geq_bsearch(&key, elts, count, elt_size, cmp_double);
-      t_geq = clock() - t_geq;
-      tot_geq += (double)t_geq / CLOCKS_PER_SEC;
-      t_leq = clock();
-      leq_ix = leq_bsearch(&key, elts, count, elt_size, cmp_double);
-      t_leq = clock() - t_leq;
-      tot_leq += (double)t_leq / CLOCKS_PER_SEC;
-      t = clock();
-      bsearch(&key, elts, count, elt_size, cmp_double);
-      t = clock() - t;
-      tot += (double)t / CLOCKS_PER_SEC;
-      res *= is_geq_leq_correct(&key,
+    for (k = 0; k < trials; k++){
+      keys[k] = (DRAND() < C_HALF_PROB ? -1 : 1) * DRAND();
+    }
+    printf("\tarray count: %lu, # trials: %lu\n", TOLU(count), TOLU(trials));
+    bench_init(&b_geq, C_SUITE, "double geq_bsearch", 0, 1);
+    bench_start(&b_geq);
+    for (k = 0; k < trials; k++){
+      geq_ixs[k] = geq_bsearch(&keys[k], elts, count, elt_size, cmp_double);
+    }
+    bench_stop(&b_geq);
+    bench_init(&b_leq, C_SUITE, "double leq_bsearch", 0, 1);
+    bench_start(&b_leq);
+    for (k = 0; k < trials; k++){
+      leq_ixs[k] = leq_bsearch(&keys[k], elts, count, elt_size, cmp_double);
+    }
+    bench_stop(&b_leq);
+    bench_init(&b, C_SUITE, "double bsearch", 0, 1);
+    bench_start(&b);
+    for (k = 0; k < trials; k++){
+      bsearch(&keys[k], elts, count, elt_size, cmp_double);
+    }
+    bench_stop(&b);
+    for (k = 0; k < trials; k++){
+      res *= is_geq_leq_correct(&keys[k],
 				elts,
 				count,
 				elt_size,
-				geq_ix,
-				leq_ix,
+				geq_ixs[k],
+				leq_ixs[k],
 				cmp_double);
     }
-    printf("\tarray count: %lu, # trials: %lu\n", TOLU(count), TOLU(trials));
-    printf("\t\t\tgeq_bsearch: %.6f seconds\n", tot_geq);
-    printf("\t\t\tleq_bsearch: %.6f seconds\n", tot_geq);
-    printf("\t\t\tbsearch:     %.6f seconds\n", tot);
+    report(&b_geq, "\t\t\tgeq_bsearch: ", count, trials);
+    report(&b_leq, "\t\t\tleq_bsearch: ", count, trials);
+    report(&b, "\t\t\tbsearch:     ", count, trials);
+    bench_free(&b_geq);
+    bench_free(&b_leq);
+    bench_free(&b);
     printf("\t\t\tcorrectness: ");
     print_test_result(res);
   }
@@ -284,8 +336,14 @@ void run_geq_leq_bsearch_double_test(int pow_trials,
   print_test_result(res);
   free(elts);
   free(nrand_elts);
+  free(keys);
+  free(geq_ixs);
+  free(leq_ixs);
   elts = NULL;
   nrand_elts = NULL;
+  keys = NULL;
+  geq_ixs = NULL;
+  leq_ixs = NULL;
 }
 
 int is_geq_leq_correct(const void *key,
@@ -315,6 +373,227 @@ int is_geq_leq_correct(const void *key,
   return res;
 }									 
 
+/**
+   Test first_geq_bsearch and first_gt_bsearch on random int arrays with
+   duplicate elements, including arrays with no elements. The results are
+   compared to the results of a linear search.
+*/
+void run_first_geq_gt_bsearch_int_test(int pow_trials,
+				       int pow_count_start,
+				       int pow_count_end){
+  int res = 1;
+  int i;
+  int key;
+  int *elts = NULL, *keys = NULL;
+  size_t j, count;
+  size_t k, trials;
+  size_t elt_size = sizeof(int);
+  size_t geq_ix, gt_ix;
+  size_t *geq_ixs = NULL, *gt_ixs = NULL;
+  bench_t b_geq, b_gt;
+  trials = pow_two(pow_trials);
+  elts = malloc_perror(pow_two(pow_count_end) + C_NRAND_COUNT_MAX,
+		       elt_size);
+  keys = malloc_perror(trials, elt_size);
+  geq_ixs = malloc_perror(trials, sizeof(size_t));
+  gt_ixs = malloc_perror(trials, sizeof(size_t));
+  printf("Test first_geq_bsearch and first_gt_bsearch on random int arrays "
+	 "with duplicates\n");
+  for (i = pow_count_start; i <= pow_count_end; i++){
+    count = pow_two(i);
+    for (j = 0; j < count; j++){
+      elts[j] = RANDOM() % C_DUP_RANGE;
+    }
+    qsort(elts, count, elt_size, cmp_int);
+    for (k = 0; k < trials; k++){
+      keys[k] = RANDOM() % (C_DUP_RANGE + 2) - 1; /* [-1, C_DUP_RANGE] */
+    }
+    printf("\tarray count: %lu, # trials: %lu\n", TOLU(count), TOLU(trials));
+    bench_init(&b_geq, C_SUITE, "int first_geq_bsearch dup", 0, 1);
+    bench_start(&b_geq);
+    for (k = 0; k < trials; k++){
+      geq_ixs[k] = first_geq_bsearch(&keys[k], elts, count, elt_size, cmp_int);
+    }
+    bench_stop(&b_geq);
+    bench_init(&b_gt, C_SUITE, "int first_gt_bsearch dup", 0, 1);
+    bench_start(&b_gt);
+    for (k = 0; k < trials; k++){
+      gt_ixs[k] = first_gt_bsearch(&keys[k], elts, count, elt_size, cmp_int);
+    }
+    bench_stop(&b_gt);
+    for (k = 0; k < trials; k++){
+      key = keys[k];
+      geq_ix = geq_ixs[k];
+      gt_ix = gt_ixs[k];
+      res *= (geq_ix <= gt_ix && gt_ix <= count);
+      res *= (geq_ix == 0 || elts[geq_ix - 1] < key);
+      res *= (geq_ix == count || elts[geq_ix] >= key);
+      res *= (gt_ix == 0 || elts[gt_ix - 1] <= key);
+      res *= (gt_ix == count || elts[gt_ix] > key);
+    }
+    report(&b_geq, "\t\t\tfirst_geq_bsearch: ", count, trials);
+    report(&b_gt, "\t\t\tfirst_gt_bsearch:  ", count, trials);
+    bench_free(&b_geq);
+    bench_free(&b_gt);
+    printf("\t\t\tcorrectness:       ");
+    print_test_result(res);
+  }
+  printf("\tcorner cases\n");
+  res = 1;
+  key = 0;
+  res *= (first_geq_bsearch(&key, elts, 0, elt_size, cmp_int) == 0);
+  res *= (first_gt_bsearch(&key, elts, 0, elt_size, cmp_int) == 0);
+  for (count = 1; count <= C_NRAND_COUNT_MAX; count++){
+    for (j = 0; j < count; j++){
+      elts[j] = 0;
+    }
+    key = -1;
+    res *= (first_geq_bsearch(&key, elts, count, elt_size, cmp_int) == 0);
+    res *= (first_gt_bsearch(&key, elts, count, elt_size, cmp_int) == 0);
+    key = 0;
+    res *= (first_geq_bsearch(&key, elts, count, elt_size, cmp_int) == 0);
+    res *= (first_gt_bsearch(&key, elts, count, elt_size, cmp_int) == count);
+    key = 1;
+    res *= (first_geq_bsearch(&key, elts, count, elt_size, cmp_int) ==
+	    count);
+    res *= (first_gt_bsearch(&key, elts, count, elt_size, cmp_int) == count);
+  }
+  printf("\t\t\tcorrectness:       ");
+  print_test_result(res);
+  free(elts);
+  free(keys);
+  free(geq_ixs);
+  free(gt_ixs);
+  elts = NULL;
+  keys = NULL;
+  geq_ixs = NULL;
+  gt_ixs = NULL;
+}
+
+/**
+   Test the typed branchless, batched, and Eytzinger searches on random int
+   arrays against first_geq_bsearch, and on double arrays with duplicate
+   elements, including arrays with no elements, against a linear search.
+*/
+void run_typed_bsearch_test(int pow_trials,
+			    int pow_count_start,
+			    int pow_count_end){
+  int res = 1;
+  int i;
+  int *elts = NULL, *eytz = NULL, *keys = NULL;
+  size_t j, count;
+  size_t k, trials;
+  size_t elt_size = sizeof(int);
+  size_t *ixs = NULL, *typed_ixs = NULL;
+  double dkey;
+  double *delts = NULL, *deytz = NULL;
+  bench_t b;
+  trials = pow_two(pow_trials);
+  elts = malloc_perror(pow_two(pow_count_end), elt_size);
+  eytz = malloc_perror(pow_two(pow_count_end) + 1, elt_size);
+  keys = malloc_perror(trials, elt_size);
+  ixs = malloc_perror(trials, sizeof(size_t));
+  typed_ixs = malloc_perror(trials, sizeof(size_t));
+  printf("Test typed, batched, and Eytzinger searches on random int "
+	 "arrays\n");
+  for (i = pow_count_start; i <= pow_count_end; i++){
+    count = pow_two(i);
+    for (j = 0; j < count; j++){
+      elts[j] = (DRAND() < C_HALF_PROB ? -1 : 1) * RANDOM();
+    }
+    qsort(elts, count, elt_size, cmp_int);
+    eytz_layout(eytz, elts, count, elt_size);
+    for (k = 0; k < trials; k++){
+      keys[k] = (DRAND() < C_HALF_PROB ? -1 : 1) * RANDOM();
+    }
+    printf("\tarray count: %lu, # trials: %lu\n", TOLU(count), TOLU(trials));
+    bench_init(&b, C_SUITE, "first_geq_bsearch", 0, 1);
+    bench_start(&b);
+    for (k = 0; k < trials; k++){
+      ixs[k] = first_geq_bsearch(&keys[k], elts, count, elt_size, cmp_int);
+    }
+    bench_stop(&b);
+    report(&b, "\t\t\tfirst_geq_bsearch:           ", count, trials);
+    bench_free(&b);
+    bench_init(&b, C_SUITE, "first_geq_bsearch_int", 0, 1);
+    bench_start(&b);
+    for (k = 0; k < trials; k++){
+      typed_ixs[k] = first_geq_bsearch_int(keys[k], elts, count);
+    }
+    bench_stop(&b);
+    report(&b, "\t\t\tfirst_geq_bsearch_int:       ", count, trials);
+    bench_free(&b);
+    res *= (memcmp(ixs, typed_ixs, trials * sizeof(size_t)) == 0);
+    bench_init(&b, C_SUITE, "first_geq_bsearch_batch_int", 0, 1);
+    bench_start(&b);
+    first_geq_bsearch_batch_int(keys, trials, elts, count, typed_ixs);
+    bench_stop(&b);
+    report(&b, "\t\t\tfirst_geq_bsearch_batch_int: ", count, trials);
+    bench_free(&b);
+    res *= (memcmp(ixs, typed_ixs, trials * sizeof(size_t)) == 0);
+    bench_init(&b, C_SUITE, "eytz_first_geq_int", 0, 1);
+    bench_start(&b);
+    for (k = 0; k < trials; k++){
+      typed_ixs[k] = eytz_first_geq_int(keys[k], eytz, count);
+    }
+    bench_stop(&b);
+    report(&b, "\t\t\teytz_first_geq_int:          ", count, trials);
+    bench_free(&b);
+    for (k = 0; k < trials; k++){
+      res *= (ixs[k] == eytz_rank(typed_ixs[k], count));
+    }
+    bench_init(&b, C_SUITE, "eytz_first_geq_batch_int", 0, 1);
+    bench_start(&b);
+    eytz_first_geq_batch_int(keys, trials, eytz, count, typed_ixs);
+    bench_stop(&b);
+    report(&b, "\t\t\teytz_first_geq_batch_int:    ", count, trials);
+    bench_free(&b);
+    for (k = 0; k < trials; k++){
+      res *= (ixs[k] == eytz_rank(typed_ixs[k], count));
+    }
+    printf("\t\t\tcorrectness:                 ");
+    print_test_result(res);
+  }
+  printf("\tdouble arrays with duplicates and corner cases\n");
+  res = 1;
+  delts = malloc_perror(C_NRAND_COUNT_MAX, sizeof(double));
+  deytz = malloc_perror(C_NRAND_COUNT_MAX + 1, sizeof(double));
+  for (count = 0; count <= C_NRAND_COUNT_MAX; count++){
+    for (j = 0; j < count; j++){
+      delts[j] = RANDOM() % C_DUP_RANGE;
+    }
+    qsort(delts, count, sizeof(double), cmp_double);
+    eytz_layout(deytz, delts, count, sizeof(double));
+    for (k = 0; k <= (size_t)C_DUP_RANGE + 1; k++){
+      dkey = (double)k - 0.5 * (k & 1); /* integers and halves */
+      for (j = 0; j < count && delts[j] < dkey; j++);
+      res *= (first_geq_bsearch_double(dkey, delts, count) == j);
+      res *= (eytz_rank(eytz_first_geq_double(dkey, deytz, count), count) ==
+	      j);
+      first_geq_bsearch_batch_double(&dkey, 1, delts, count, ixs);
+      res *= (ixs[0] == j);
+      eytz_first_geq_batch_double(&dkey, 1, deytz, count, ixs);
+      res *= (eytz_rank(ixs[0], count) == j);
+    }
+  }
+  printf("\t\t\tcorrectness:                 ");
+  print_test_result(res);
+  free(elts);
+  free(eytz);
+  free(keys);
+  free(ixs);
+  free(typed_ixs);
+  free(delts);
+  free(deytz);
+  elts = NULL;
+  eytz = NULL;
+  keys = NULL;
+  ixs = NULL;
+  typed_ixs = NULL;
+  delts = NULL;
+  deytz = NULL;
+}
+
 /**
    Computes a pointer to the ith element in an array pointed to by elts.
 */
@@ -325,6 +604,15 @@ void *elt_ptr(const void *elts, size_t i, size_t elt_size){
 /**
    Prints test result.
 */
+void report(const bench_t *b,
+	    const char *label,
+	    size_t count,
+	    size_t trials){
+  char params[64];
+  sprintf(params, "n=%lu trials=%lu", TOLU(count), TOLU(trials));
+  bench_report(b, label, params);
+}
+
 void print_test_result(int result){
   if (result){
     printf("SUCCESS\n");
@@ -351,12 +639,16 @@ int main(int argc, char *argv[]){
       args[2] > C_FULL_BIT - 1 ||
       args[1] > args[2] ||
       args[3] > 1 ||
-      args[4] > 1){
+      args[4] > 1 ||
+      args[5] > 1 ||
+      args[6] > 1){
     printf("USAGE:\n%s", C_USAGE);
     exit(EXIT_FAILURE);
   }
   if (args[3]) run_geq_leq_bsearch_int_test(args[0], args[1], args[2]);
   if (args[4]) run_geq_leq_bsearch_double_test(args[0], args[1], args[2]);
+  if (args[5]) run_first_geq_gt_bsearch_int_test(args[0], args[1], args[2]);
+  if (args[6]) run_typed_bsearch_test(args[0], args[1], args[2]);
   free(args);
   args = NULL;
   return 0;
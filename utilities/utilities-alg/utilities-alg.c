@@ -2,12 +2,40 @@
    utilities-alg.c
 
    Implementations of general algorithms.
+
+   The typed binary searches of each primitive type are generated from
+   utilities-alg-bsearch-impl.h. Prefetching is used if the compiler
+   provides __builtin_prefetch, and the implementation is otherwise
+   portable under C89/C90.
 */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include "utilities-alg.h"
 #include "utilities-mem.h"
 
+#if defined(__GNUC__)
+#define BSEARCH_PREFETCH(p) __builtin_prefetch(p)
+#else
+#define BSEARCH_PREFETCH(p) ((void)0)
+#endif
+
+#define BFN_CAT(f, name) f##_##name
+#define BFN_EXP(f, name) BFN_CAT(f, name)
+#define BFN(f) BFN_EXP(f, BSEARCH_NAME)
+
+#define C_BSEARCH_BATCH (16) /* keys per group of the batched searches */
+
+static const size_t C_EYTZ_PREFETCH_LEVELS = 4; /* 16 nodes ahead */
+
+static size_t eytz_layout_rec(void *eytz,
+			      const void *elts,
+			      size_t count,
+			      size_t elt_size,
+			      size_t k,
+			      size_t i);
+static size_t eytz_subtree_count(size_t k, size_t count);
 static void *elt_ptr(const void *elts, size_t i, size_t elt_size);
 
 /**
@@ -80,6 +108,159 @@ size_t leq_bsearch(const void *key,
   }
 }
 
+/**
+   Performs a binary search for the first element that is greater or equal
+   to the element pointed to by key, on an array with count elements,
+   sorted in an ascending order according to cmp. The array is pointed to
+   by elts and may have no elements.
+
+   Given an array A, returns the smallest index i, such that
+   A[i] >= element pointed to by key according to cmp. Returns count, if
+   A[count - 1] < element pointed to by key or count is 0. Unlike
+   geq_bsearch, the returned index is unique in the presence of elements
+   equal to the element pointed to by key.
+*/
+size_t first_geq_bsearch(const void *key,
+			 const void *elts,
+			 size_t count,
+			 size_t elt_size,
+			 int (*cmp)(const void *, const void *)){
+  size_t low = 0, high = count, mid;
+  while (low < high){
+    /* A[0, low) < key element <= A[high, count) */
+    mid = low + (high - low) / 2;
+    if (cmp(elt_ptr(elts, mid, elt_size), key) < 0){
+      low = mid + 1;
+    }else{
+      high = mid;
+    }
+  }
+  return low;
+}
+
+/**
+   Performs a binary search for the first element that is greater than
+   the element pointed to by key, on an array with count elements, sorted
+   in an ascending order according to cmp. The array is pointed to by elts
+   and may have no elements.
+
+   Given an array A, returns the smallest index i, such that
+   A[i] > element pointed to by key according to cmp. Returns count, if
+   A[count - 1] <= element pointed to by key or count is 0.
+*/
+size_t first_gt_bsearch(const void *key,
+			const void *elts,
+			size_t count,
+			size_t elt_size,
+			int (*cmp)(const void *, const void *)){
+  size_t low = 0, high = count, mid;
+  while (low < high){
+    /* A[0, low) <= key element < A[high, count) */
+    mid = low + (high - low) / 2;
+    if (cmp(elt_ptr(elts, mid, elt_size), key) <= 0){
+      low = mid + 1;
+    }else{
+      high = mid;
+    }
+  }
+  return low;
+}
+
+/**
+   Copies an array with count elements sorted in an ascending order to an
+   array in the Eytzinger layout, i.e. the breadth-first order of a binary
+   search tree that is complete except for the last level, which is filled
+   from the left. The element at index 1 is the root, and the children of
+   the element at index k are at 2k and 2k + 1. The element at index 0 is
+   not set. The layout can be applied to arrays of keys and values alike.
+   eytz        : pointer to a preallocated array with count + 1 elements
+   elts        : pointer to the array in ascending order
+   count       : count of elements in the array
+   elt_size    : size of each element in bytes
+*/
+void eytz_layout(void *eytz,
+		 const void *elts,
+		 size_t count,
+		 size_t elt_size){
+  eytz_layout_rec(eytz, elts, count, elt_size, 1, 0);
+}
+
+/**
+   Returns the index in ascending order of the element at index k in the
+   Eytzinger layout of count elements, where 1 <= k <= count, or count if k
+   is 0, in O(log^2 count) time.
+*/
+size_t eytz_rank(size_t k, size_t count){
+  size_t ret;
+  size_t p;
+  if (k == 0) return count;
+  ret = (k > count / 2) ? 0 : eytz_subtree_count(2 * k, count);
+  /* each right turn from an ancestor p adds the left subtree of p and p */
+  for (; k > 1; k = p){
+    p = k / 2;
+    if (k & 1) ret += eytz_subtree_count(2 * p, count) + 1;
+  }
+  return ret;
+}
+
+#define BSEARCH_T int
+#define BSEARCH_NAME int
+#include "utilities-alg-bsearch-impl.h"
+#undef BSEARCH_T
+#undef BSEARCH_NAME
+
+#define BSEARCH_T long
+#define BSEARCH_NAME long
+#include "utilities-alg-bsearch-impl.h"
+#undef BSEARCH_T
+#undef BSEARCH_NAME
+
+#define BSEARCH_T unsigned long
+#define BSEARCH_NAME ulong
+#include "utilities-alg-bsearch-impl.h"
+#undef BSEARCH_T
+#undef BSEARCH_NAME
+
+#define BSEARCH_T double
+#define BSEARCH_NAME double
+#include "utilities-alg-bsearch-impl.h"
+#undef BSEARCH_T
+#undef BSEARCH_NAME
+
+/**
+   Copies the elements of the subtree rooted at index k in the in-order of
+   the tree, starting at the element at index i of the sorted array.
+   Returns the index of the next element of the sorted array.
+*/
+static size_t eytz_layout_rec(void *eytz,
+			      const void *elts,
+			      size_t count,
+			      size_t elt_size,
+			      size_t k,
+			      size_t i){
+  if (k > count) return i;
+  i = eytz_layout_rec(eytz, elts, count, elt_size, 2 * k, i);
+  memcpy(elt_ptr(eytz, k, elt_size), elt_ptr(elts, i, elt_size), elt_size);
+  return eytz_layout_rec(eytz, elts, count, elt_size, 2 * k + 1, i + 1);
+}
+
+/**
+   Returns the count of elements in the subtree rooted at index k in the
+   Eytzinger layout of count elements. The nodes of the subtree at each
+   level are in [low, high].
+*/
+static size_t eytz_subtree_count(size_t k, size_t count){
+  size_t ret = 0;
+  size_t low = k, high = k;
+  while (low <= count){
+    ret += ((high < count) ? high : count) - low + 1;
+    if (low > count / 2) break; /* 2 * low > count or would overflow */
+    low = 2 * low;
+    high = 2 * high + 1;
+  }
+  return ret;
+}
+
 /**
    Computes a pointer to the ith element in an array pointed to by elts.
 */
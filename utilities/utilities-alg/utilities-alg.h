@@ -45,4 +45,143 @@ size_t leq_bsearch(const void *key,
 		   size_t elt_size,
 		   int (*cmp)(const void *, const void *));
 
+/**
+   Performs a binary search for the first element that is greater or equal
+   to the element pointed to by key, on an array with count elements,
+   sorted in an ascending order according to cmp. The array is pointed to
+   by elts and may have no elements.
+
+   Given an array A, returns the smallest index i, such that
+   A[i] >= element pointed to by key according to cmp. Returns count, if
+   A[count - 1] < element pointed to by key or count is 0. Unlike
+   geq_bsearch, the returned index is unique in the presence of elements
+   equal to the element pointed to by key.
+*/
+size_t first_geq_bsearch(const void *key,
+			 const void *elts,
+			 size_t count,
+			 size_t elt_size,
+			 int (*cmp)(const void *, const void *));
+
+/**
+   Performs a binary search for the first element that is greater than
+   the element pointed to by key, on an array with count elements, sorted
+   in an ascending order according to cmp. The array is pointed to by elts
+   and may have no elements.
+
+   Given an array A, returns the smallest index i, such that
+   A[i] > element pointed to by key according to cmp. Returns count, if
+   A[count - 1] <= element pointed to by key or count is 0.
+*/
+size_t first_gt_bsearch(const void *key,
+			const void *elts,
+			size_t count,
+			size_t elt_size,
+			int (*cmp)(const void *, const void *));
+
+/**
+   Copies an array with count elements sorted in an ascending order to an
+   array in the Eytzinger layout, i.e. the breadth-first order of a binary
+   search tree that is complete except for the last level, which is filled
+   from the left. The element at index 1 is the root, and the children of
+   the element at index k are at 2k and 2k + 1. The element at index 0 is
+   not set. The layout can be applied to arrays of keys and values alike.
+   eytz        : pointer to a preallocated array with count + 1 elements
+   elts        : pointer to the array in ascending order
+   count       : count of elements in the array
+   elt_size    : size of each element in bytes
+*/
+void eytz_layout(void *eytz,
+		 const void *elts,
+		 size_t count,
+		 size_t elt_size);
+
+/**
+   Returns the index in ascending order of the element at index k in the
+   Eytzinger layout of count elements, where 1 <= k <= count, or count if k
+   is 0, in O(log^2 count) time.
+*/
+size_t eytz_rank(size_t k, size_t count);
+
+/**
+   Typed binary searches for the first element that is greater or equal to
+   key according to the < operator of a primitive type, with the return
+   values of first_geq_bsearch. The searches do not call a comparison
+   function and do not branch on comparison results on common compilers
+   and platforms, and prefetch the next elements to be compared if the
+   compiler provides __builtin_prefetch. Arrays of double must not contain
+   NaN values.
+
+   first_geq_bsearch_<type> searches an array with count elements sorted in
+   an ascending order, and returns an index in [0, count].
+
+   eytz_first_geq_<type> searches an array in the layout of eytz_layout
+   with count elements, and returns an index in [1, count] of the layout,
+   or 0 if all elements are less than key. The Eytzinger layout places the
+   elements compared in the first steps of all searches in few cache lines,
+   and the descendants of a node at a given depth in contiguous memory.
+
+   The _batch variants search for num_keys keys and write the indices to
+   a preallocated ixs array with num_keys elements. The searches of a group
+   of keys are interleaved step by step, so that the cache misses of the
+   group overlap.
+*/
+size_t first_geq_bsearch_int(int key, const int *elts, size_t count);
+size_t first_geq_bsearch_long(long key, const long *elts, size_t count);
+size_t first_geq_bsearch_ulong(unsigned long key,
+			       const unsigned long *elts,
+			       size_t count);
+size_t first_geq_bsearch_double(double key,
+				const double *elts,
+				size_t count);
+
+void first_geq_bsearch_batch_int(const int *keys,
+				 size_t num_keys,
+				 const int *elts,
+				 size_t count,
+				 size_t *ixs);
+void first_geq_bsearch_batch_long(const long *keys,
+				  size_t num_keys,
+				  const long *elts,
+				  size_t count,
+				  size_t *ixs);
+void first_geq_bsearch_batch_ulong(const unsigned long *keys,
+				   size_t num_keys,
+				   const unsigned long *elts,
+				   size_t count,
+				   size_t *ixs);
+void first_geq_bsearch_batch_double(const double *keys,
+				    size_t num_keys,
+				    const double *elts,
+				    size_t count,
+				    size_t *ixs);
+
+size_t eytz_first_geq_int(int key, const int *eytz, size_t count);
+size_t eytz_first_geq_long(long key, const long *eytz, size_t count);
+size_t eytz_first_geq_ulong(unsigned long key,
+			    const unsigned long *eytz,
+			    size_t count);
+size_t eytz_first_geq_double(double key, const double *eytz, size_t count);
+
+void eytz_first_geq_batch_int(const int *keys,
+			      size_t num_keys,
+			      const int *eytz,
+			      size_t count,
+			      size_t *ixs);
+void eytz_first_geq_batch_long(const long *keys,
+			       size_t num_keys,
+			       const long *eytz,
+			       size_t count,
+			       size_t *ixs);
+void eytz_first_geq_batch_ulong(const unsigned long *keys,
+				size_t num_keys,
+				const unsigned long *eytz,
+				size_t count,
+				size_t *ixs);
+void eytz_first_geq_batch_double(const double *keys,
+				 size_t num_keys,
+				 const double *eytz,
+				 size_t count,
+				 size_t *ixs);
+
 #endif
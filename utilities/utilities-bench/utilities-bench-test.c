@@ -0,0 +1,183 @@
+/**
+   utilities-bench-test.c
+
+   Tests of utility functions for benchmarking.
+
+   The following command line arguments can be used to customize tests:
+   utilities-bench-test
+      [0, # bits in size_t) : n for 2^n iterations of a timed loop
+      > 0 : # repetitions
+      [0, 1] : summary test on/off
+      [0, 1] : timing test on/off
+
+   usage examples:
+   ./utilities-bench-test
+   ./utilities-bench-test 22 20
+   BENCH_FORMAT=csv BENCH_OUT=bench.csv ./utilities-bench-test
+
+   utilities-bench-test can be run with any subset of command line
+   arguments in the above-defined order. If the (i + 1)th argument is
+   specified then the ith argument must be specified for i >= 0. Default
+   values are used for the unspecified arguments according to the
+   C_ARGS_DEF array.
+
+   The implementation of tests is portable under C89/C90.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "utilities-bench.h"
+#include "utilities-mem.h"
+
+#define TOLU(i) ((unsigned long int)(i)) /* printing size_t under C89/C90 */
+
+/* input handling */
+const char *C_USAGE =
+  "utilities-bench-test \n"
+  "[0, # bits in size_t) : n for 2^n iterations of a timed loop \n"
+  "> 0 : # repetitions \n"
+  "[0, 1] : summary test on/off \n"
+  "[0, 1] : timing test on/off \n";
+const int C_ARGC_MAX = 5;
+const size_t C_ARGS_DEF[4] = {20, 10, 1, 1};
+const size_t C_FULL_BIT = CHAR_BIT * sizeof(size_t);
+
+/* tests */
+const size_t C_NUM_WARMUPS = 2;
+const double C_SAMPLES[10] = {9.0, 1.0, 8.0, 2.0, 7.0,
+			      3.0, 6.0, 4.0, 5.0, 10.0};
+const double C_EPS = 1e-9;
+
+void print_test_result(int res);
+
+/**
+   Test bench_stop and bench_summarize on known samples. Calls of
+   bench_stop before the warmups are completed and after all repetitions
+   are recorded do not change the samples.
+*/
+void run_summary_test(){
+  int res = 1;
+  size_t i;
+  bench_t b;
+  bench_summary_t w, c;
+  bench_init(&b, "utilities-bench-test", "summary", C_NUM_WARMUPS, 10);
+  b.num_warmups = C_NUM_WARMUPS; /* independent of BENCH_WARMUPS */
+  b.num_reps = 10;
+  b.wall = realloc_perror(b.wall, 10, sizeof(double));
+  b.cpu = realloc_perror(b.cpu, 10, sizeof(double));
+  b.proc_cpu = realloc_perror(b.proc_cpu, 10, sizeof(double));
+  if (b.perf_on) b.perf = realloc_perror(b.perf, 10, sizeof(perf_sample_t));
+  printf("Run bench_summarize test on known samples\n");
+  res *= (bench_count(&b) == 0);
+  for (i = 0; i < C_NUM_WARMUPS + 10 + 2; i++){
+    bench_start(&b);
+    bench_stop(&b);
+  }
+  res *= (bench_count(&b) == 10);
+  memcpy(b.wall, C_SAMPLES, 10 * sizeof(double));
+  memcpy(b.cpu, C_SAMPLES, 10 * sizeof(double));
+  bench_summarize(&b, &w, &c, NULL);
+  res *= (w.min == 1.0 && w.max == 10.0);
+  res *= (w.med > 5.5 - C_EPS && w.med < 5.5 + C_EPS);
+  res *= (w.p10 > 1.9 - C_EPS && w.p10 < 1.9 + C_EPS);
+  res *= (w.p90 > 9.1 - C_EPS && w.p90 < 9.1 + C_EPS);
+  res *= (w.p99 > 9.91 - C_EPS && w.p99 < 9.91 + C_EPS);
+  res *= (w.mean > 5.5 - C_EPS && w.mean < 5.5 + C_EPS);
+  res *= (memcmp(&w, &c, sizeof(bench_summary_t)) == 0);
+  b.num_calls = C_NUM_WARMUPS + 1;
+  bench_summarize(&b, &w, NULL, NULL);
+  res *= (w.min == C_SAMPLES[0] && w.med == C_SAMPLES[0]);
+  b.num_calls = C_NUM_WARMUPS;
+  bench_summarize(&b, &w, NULL, NULL);
+  res *= (w.max == 0.0 && w.med == 0.0);
+  printf("\tcorrectness:                             ");
+  print_test_result(res);
+  bench_free(&b);
+}
+
+/**
+   Test bench_run on a loop with 2^pow_iter iterations, and compare the
+   wall-clock and CPU times of the single-threaded loop.
+*/
+
+typedef struct{
+  size_t count;
+  volatile size_t sum;
+} loop_arg_t;
+
+void loop(void *arg, size_t i){
+  loop_arg_t *la = arg;
+  size_t j;
+  for (j = 0; j < la->count; j++){
+    la->sum += j ^ i;
+  }
+}
+
+void run_timing_test(size_t pow_iter, size_t num_reps){
+  int res = 1;
+  char params[64];
+  double t;
+  bench_t b;
+  bench_summary_t w, c, pc;
+  loop_arg_t la;
+  la.count = (size_t)1 << pow_iter;
+  la.sum = 0;
+  sprintf(params, "iters=%lu", TOLU(la.count));
+  printf("Run bench_run test on a loop with %lu iterations\n",
+	 TOLU(la.count));
+  t = bench_wall_time();
+  res *= (bench_wall_time() >= t);
+  bench_init(&b, "utilities-bench-test", "loop", C_NUM_WARMUPS, num_reps);
+  bench_run(&b, loop, &la);
+  bench_summarize(&b, &w, &c, &pc);
+  res *= (bench_count(&b) == b.num_reps);
+  res *= (b.num_calls == b.num_warmups + b.num_reps);
+  res *= (w.min <= w.p10 && w.p10 <= w.med && w.med <= w.p90 &&
+	  w.p90 <= w.p99 && w.p99 <= w.max);
+  res *= (w.min >= 0.0 && c.min >= 0.0 && pc.min >= 0.0);
+  bench_report(&b, "\tloop runtime:                            ", params);
+  printf("\tloop cpu median:                         %.8f seconds\n",
+	 c.med);
+  printf("\tcorrectness:                             ");
+  print_test_result(res);
+  bench_free(&b);
+}
+
+/**
+   Prints a test result.
+*/
+void print_test_result(int res){
+  if (res){
+    printf("SUCCESS\n");
+  }else{
+    printf("FAILURE\n");
+  }
+}
+
+int main(int argc, char *argv[]){
+  int i;
+  size_t *args = NULL;
+  if (argc > C_ARGC_MAX){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  args = malloc_perror(C_ARGC_MAX - 1, sizeof(size_t));
+  memcpy(args, C_ARGS_DEF, (C_ARGC_MAX - 1) * sizeof(size_t));
+  for (i = 1; i < argc; i++){
+    args[i - 1] = atoi(argv[i]);
+  }
+  if (args[0] > C_FULL_BIT - 1 ||
+      args[1] < 1 ||
+      args[2] > 1 ||
+      args[3] > 1){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  if (args[2]) run_summary_test();
+  if (args[3]) run_timing_test(args[0], args[1]);
+  free(args);
+  args = NULL;
+  return 0;
+}
@@ -0,0 +1,439 @@
+/**
+   utilities-bench.c
+
+   Utility functions for benchmarking.
+
+   The samples of a benchmark are copied and sorted to compute a summary,
+   and a percentile is linearly interpolated between the closest ranks. On
+   Linux, unless UTILITIES_BENCH_PORTABLE is defined, the times are
+   obtained with clock_gettime. The implementation is otherwise portable
+   under C89/C90.
+
+   The output settings are read from the environment at the first report
+   and the csv or json output file is kept open until the process exits.
+   BENCH_PERF is read and the counters are opened at the first
+   initialization of a benchmark. The counters are read outside of the
+   timed interval of a repetition.
+*/
+
+#if defined(__linux__) && !defined(UTILITIES_BENCH_PORTABLE)
+#define _POSIX_C_SOURCE 199309L
+#define UTILITIES_BENCH_POSIX
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "utilities-bench.h"
+#include "utilities-mem.h"
+
+typedef enum{
+  FORMAT_TEXT,
+  FORMAT_CSV,
+  FORMAT_JSON
+} format_t;
+
+static const char *C_CSV_HEADER =
+  "suite,name,params,reps,"
+  "wall_min,wall_p10,wall_med,wall_p90,wall_p99,wall_max,wall_mean,"
+  "cpu_med,cpu_mean,proc_cpu_med,proc_cpu_mean,"
+  "cycles_med,instrs_med,l1d_misses_med,llc_misses_med,"
+  "branch_misses_med,dtlb_misses_med\n";
+
+static int out_init = 0;
+static format_t out_format = FORMAT_TEXT;
+static FILE *out_file = NULL;
+static int perf_init = 0;
+static int perf_on = 0;
+
+#ifdef UTILITIES_BENCH_POSIX
+static double clock_time(clockid_t id);
+#endif
+static void summarize(const double *samples,
+		      size_t count,
+		      bench_summary_t *s);
+static double percentile(const double *sorted, size_t count, double q);
+static int cmp_double(const void *a, const void *b);
+static void env_uint(const char *var, size_t *val);
+static void out_open(void);
+static void perf_enable(void);
+
+/**
+   Returns the monotonic wall-clock time, the CPU time of the calling
+   thread, and the CPU time of the process in seconds since an arbitrary
+   point.
+*/
+
+double bench_wall_time(void){
+#ifdef UTILITIES_BENCH_POSIX
+  return clock_time(CLOCK_MONOTONIC);
+#else
+  return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+double bench_cpu_time(void){
+#ifdef UTILITIES_BENCH_POSIX
+  return clock_time(CLOCK_THREAD_CPUTIME_ID);
+#else
+  return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+double bench_proc_cpu_time(void){
+#ifdef UTILITIES_BENCH_POSIX
+  return clock_time(CLOCK_PROCESS_CPUTIME_ID);
+#else
+  return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+/**
+   Initializes a benchmark. The suite and name strings are not copied and
+   must remain valid until the benchmark is freed.
+   b           : pointer to a preallocated block of size sizeof(bench_t)
+   suite       : name of the suite of the benchmark
+   name        : name of the benchmark within the suite
+   num_warmups : number of repetitions that are not recorded
+   num_reps    : > 0 number of recorded repetitions
+*/
+void bench_init(bench_t *b,
+		const char *suite,
+		const char *name,
+		size_t num_warmups,
+		size_t num_reps){
+  if (num_reps > 1){
+    /* a section with a single repetition may not be repeatable */
+    env_uint("BENCH_WARMUPS", &num_warmups);
+    env_uint("BENCH_REPS", &num_reps);
+  }
+  if (num_reps == 0) num_reps = 1;
+  b->suite = suite;
+  b->name = name;
+  b->num_warmups = num_warmups;
+  b->num_reps = num_reps;
+  b->num_calls = 0;
+  b->wall = malloc_perror(num_reps, sizeof(double));
+  b->cpu = malloc_perror(num_reps, sizeof(double));
+  b->proc_cpu = malloc_perror(num_reps, sizeof(double));
+  b->wall_start = 0.0;
+  b->cpu_start = 0.0;
+  b->proc_cpu_start = 0.0;
+  if (!perf_init) perf_enable();
+  b->perf_on = perf_on;
+  b->perf = NULL;
+  if (b->perf_on){
+    b->perf = malloc_perror(num_reps, sizeof(perf_sample_t));
+  }
+}
+
+/**
+   Starts and stops a repetition. A repetition is recorded if it follows
+   all warmup repetitions and the number of recorded repetitions is less
+   than num_reps.
+*/
+
+void bench_start(bench_t *b){
+  if (b->perf_on) perf_read(&b->perf_start);
+  b->proc_cpu_start = bench_proc_cpu_time();
+  b->cpu_start = bench_cpu_time();
+  b->wall_start = bench_wall_time();
+}
+
+void bench_stop(bench_t *b){
+  double wall = bench_wall_time();
+  double cpu = bench_cpu_time();
+  double proc_cpu = bench_proc_cpu_time();
+  size_t i;
+  perf_sample_t perf;
+  if (b->perf_on) perf_read(&perf);
+  if (b->num_calls >= b->num_warmups){
+    i = b->num_calls - b->num_warmups;
+    if (i < b->num_reps){
+      b->wall[i] = wall - b->wall_start;
+      b->cpu[i] = cpu - b->cpu_start;
+      b->proc_cpu[i] = proc_cpu - b->proc_cpu_start;
+      if (b->perf_on) perf_diff(&b->perf[i], &perf, &b->perf_start);
+    }
+  }
+  b->num_calls++;
+}
+
+/**
+   Returns the number of recorded repetitions.
+*/
+size_t bench_count(const bench_t *b){
+  if (b->num_calls <= b->num_warmups) return 0;
+  if (b->num_calls - b->num_warmups > b->num_reps) return b->num_reps;
+  return b->num_calls - b->num_warmups;
+}
+
+/**
+   Calls fn num_warmups + num_reps times, passing arg and the index of the
+   call starting from 0, and times each call.
+*/
+void bench_run(bench_t *b, void (*fn)(void *, size_t), void *arg){
+  size_t i;
+  for (i = 0; i < b->num_warmups + b->num_reps; i++){
+    bench_start(b);
+    fn(arg, i);
+    bench_stop(b);
+  }
+}
+
+/**
+   Computes the summaries of the recorded wall-clock, thread CPU, and
+   process CPU times. A NULL summary pointer is not computed.
+*/
+void bench_summarize(const bench_t *b,
+		     bench_summary_t *wall,
+		     bench_summary_t *cpu,
+		     bench_summary_t *proc_cpu){
+  size_t count = bench_count(b);
+  if (wall != NULL) summarize(b->wall, count, wall);
+  if (cpu != NULL) summarize(b->cpu, count, cpu);
+  if (proc_cpu != NULL) summarize(b->proc_cpu, count, proc_cpu);
+}
+
+/**
+   Computes the medians of the recorded counts of each counter. Returns 1
+   if counters were read, and 0 otherwise.
+*/
+int bench_summarize_perf(const bench_t *b, perf_sample_t *med){
+  int i;
+  size_t j, count = bench_count(b);
+  double *vals = NULL;
+  bench_summary_t s;
+  for (i = 0; i < PERF_COUNT; i++){
+    med->ctr[i] = PERF_NA;
+  }
+  if (!b->perf_on) return 0;
+  vals = malloc_perror(count + 1, sizeof(double));
+  for (i = 0; i < PERF_COUNT; i++){
+    for (j = 0; j < count; j++){
+      if (b->perf[j].ctr[i] < 0.0) break;
+      vals[j] = b->perf[j].ctr[i];
+    }
+    if (count == 0 || j < count) continue;
+    summarize(vals, count, &s);
+    med->ctr[i] = s.med;
+  }
+  free(vals);
+  vals = NULL;
+  return 1;
+}
+
+/**
+   Prints a report of the recorded repetitions as a line of text to stdout,
+   and as a csv or json record if selected by BENCH_FORMAT. The text line
+   of the counters is indented as label.
+*/
+void bench_report(const bench_t *b, const char *label, const char *params){
+  int i;
+  size_t count = bench_count(b);
+  bench_summary_t w, c, pc;
+  perf_sample_t m;
+  bench_summarize(b, &w, &c, &pc);
+  bench_summarize_perf(b, &m);
+  if (!out_init) out_open();
+  if (params == NULL) params = "";
+  printf("%s%.8f seconds (p10 %.8f, p90 %.8f, reps %lu)\n",
+	 label, w.med, w.p10, w.p90, (unsigned long)count);
+  if (b->perf_on){
+    printf("%.*s\t", (int)strspn(label, "\t "), label);
+    for (i = 0; i < PERF_COUNT; i++){
+      if (m.ctr[i] < 0.0){
+	printf("%s n/a, ", perf_name(i));
+      }else{
+	printf("%s %.0f, ", perf_name(i), m.ctr[i]);
+      }
+    }
+    if (m.ctr[PERF_CYCLES] > 0.0 && m.ctr[PERF_INSTRS] >= 0.0){
+      printf("ipc %.2f\n", m.ctr[PERF_INSTRS] / m.ctr[PERF_CYCLES]);
+    }else{
+      printf("ipc n/a\n");
+    }
+  }
+  fflush(stdout);
+  if (out_format == FORMAT_CSV){
+    fprintf(out_file,
+	    "%s,%s,%s,%lu,%.9f,%.9f,%.9f,%.9f,%.9f,%.9f,%.9f,"
+	    "%.9f,%.9f,%.9f,%.9f",
+	    b->suite, b->name, params, (unsigned long)count,
+	    w.min, w.p10, w.med, w.p90, w.p99, w.max, w.mean,
+	    c.med, c.mean, pc.med, pc.mean);
+    for (i = 0; i < PERF_COUNT; i++){
+      if (m.ctr[i] < 0.0){
+	fputs(",", out_file);
+      }else{
+	fprintf(out_file, ",%.0f", m.ctr[i]);
+      }
+    }
+    fputs("\n", out_file);
+  }else if (out_format == FORMAT_JSON){
+    fprintf(out_file,
+	    "{\"suite\": \"%s\", \"name\": \"%s\", \"params\": \"%s\", "
+	    "\"reps\": %lu, \"wall\": {\"min\": %.9f, \"p10\": %.9f, "
+	    "\"med\": %.9f, \"p90\": %.9f, \"p99\": %.9f, \"max\": %.9f, "
+	    "\"mean\": %.9f}, \"cpu\": {\"med\": %.9f, \"mean\": %.9f}, "
+	    "\"proc_cpu\": {\"med\": %.9f, \"mean\": %.9f}, \"perf\": ",
+	    b->suite, b->name, params, (unsigned long)count,
+	    w.min, w.p10, w.med, w.p90, w.p99, w.max, w.mean,
+	    c.med, c.mean, pc.med, pc.mean);
+    if (b->perf_on){
+      for (i = 0; i < PERF_COUNT; i++){
+	fprintf(out_file, "%s\"%s\": ", (i == 0) ? "{" : ", ", perf_name(i));
+	if (m.ctr[i] < 0.0){
+	  fputs("null", out_file);
+	}else{
+	  fprintf(out_file, "%.0f", m.ctr[i]);
+	}
+      }
+      fputs("}}\n", out_file);
+    }else{
+      fputs("null}\n", out_file);
+    }
+  }
+  if (out_format != FORMAT_TEXT) fflush(out_file);
+}
+
+/**
+   Frees the samples of a benchmark. The block pointed to by b is not
+   freed.
+*/
+void bench_free(bench_t *b){
+  free(b->wall);
+  free(b->cpu);
+  free(b->proc_cpu);
+  b->wall = NULL;
+  b->cpu = NULL;
+  b->proc_cpu = NULL;
+  free(b->perf);
+  b->perf = NULL;
+}
+
+/**
+   Returns the time of a clock in seconds.
+*/
+#ifdef UTILITIES_BENCH_POSIX
+static double clock_time(clockid_t id){
+  struct timespec ts;
+  if (clock_gettime(id, &ts) != 0){
+    perror("clock_gettime failed");
+    exit(EXIT_FAILURE);
+  }
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+#endif
+
+/**
+   Computes a summary of count samples on a sorted copy.
+*/
+static void summarize(const double *samples,
+		      size_t count,
+		      bench_summary_t *s){
+  size_t i;
+  double sum = 0.0;
+  double *sorted = NULL;
+  memset(s, 0, sizeof(bench_summary_t));
+  if (count == 0) return;
+  sorted = malloc_perror(count, sizeof(double));
+  memcpy(sorted, samples, count * sizeof(double));
+  qsort(sorted, count, sizeof(double), cmp_double);
+  for (i = 0; i < count; i++){
+    sum += sorted[i];
+  }
+  s->min = sorted[0];
+  s->p10 = percentile(sorted, count, 0.10);
+  s->med = percentile(sorted, count, 0.50);
+  s->p90 = percentile(sorted, count, 0.90);
+  s->p99 = percentile(sorted, count, 0.99);
+  s->max = sorted[count - 1];
+  s->mean = sum / count;
+  free(sorted);
+  sorted = NULL;
+}
+
+/**
+   Returns the qth quantile of count > 0 sorted samples, interpolated
+   between the samples at ranks floor(q(count - 1)) and
+   ceil(q(count - 1)).
+*/
+static double percentile(const double *sorted, size_t count, double q){
+  double pos = q * (count - 1);
+  size_t i = (size_t)pos;
+  if (i + 1 >= count) return sorted[count - 1];
+  return sorted[i] + (pos - i) * (sorted[i + 1] - sorted[i]);
+}
+
+static int cmp_double(const void *a, const void *b){
+  if (*(const double *)a > *(const double *)b){
+    return 1;
+  }else if (*(const double *)a < *(const double *)b){
+    return -1;
+  }else{
+    return 0;
+  }
+}
+
+/**
+   Sets the value pointed to by val to the value of an environment
+   variable, if the variable is set to a non-negative integer.
+*/
+static void env_uint(const char *var, size_t *val){
+  const char *s = getenv(var);
+  char *end = NULL;
+  unsigned long v;
+  if (s == NULL || *s == '\0' || *s == '-') return;
+  v = strtoul(s, &end, 10);
+  if (*end == '\0') *val = v;
+}
+
+/**
+   Reads BENCH_FORMAT and BENCH_OUT, and opens the output of the records.
+   A csv header is written to an empty file or once to stdout.
+*/
+static void out_open(void){
+  const char *format = getenv("BENCH_FORMAT");
+  const char *path = getenv("BENCH_OUT");
+  out_init = 1;
+  if (format == NULL) return;
+  if (strcmp(format, "csv") == 0){
+    out_format = FORMAT_CSV;
+  }else if (strcmp(format, "json") == 0){
+    out_format = FORMAT_JSON;
+  }else{
+    return;
+  }
+  if (path == NULL || *path == '\0'){
+    out_file = stdout;
+  }else{
+    out_file = fopen(path, "a");
+    if (out_file == NULL){
+      perror("fopen failed");
+      exit(EXIT_FAILURE);
+    }
+    fseek(out_file, 0, SEEK_END);
+  }
+  if (out_format == FORMAT_CSV &&
+      (out_file == stdout || ftell(out_file) == 0)){
+    fputs(C_CSV_HEADER, out_file);
+  }
+}
+
+/**
+   Reads BENCH_PERF and opens the counters if requested. Prints a note to
+   stderr if no counter is available.
+*/
+static void perf_enable(void){
+  const char *s = getenv("BENCH_PERF");
+  perf_init = 1;
+  if (s == NULL || *s == '\0' || strcmp(s, "0") == 0) return;
+  if (perf_open() > 0){
+    perf_on = 1;
+  }else{
+    fprintf(stderr, "utilities-bench: hardware performance counters "
+	    "unavailable, BENCH_PERF ignored\n");
+  }
+}
@@ -0,0 +1,151 @@
+/**
+   utilities-bench.h
+
+   Declarations of accessible utility functions for benchmarking.
+
+   A benchmark records the wall-clock time, the CPU time of the calling
+   thread, and the CPU time of the process of each repetition of a timed
+   section after a number of warmup repetitions, and reports the minimum,
+   percentiles, median, maximum, and mean of the samples.
+
+   On Linux, unless UTILITIES_BENCH_PORTABLE is defined, the wall-clock
+   time is obtained with clock_gettime and CLOCK_MONOTONIC, and the CPU
+   times with CLOCK_THREAD_CPUTIME_ID and CLOCK_PROCESS_CPUTIME_ID. On
+   other systems, or if UTILITIES_BENCH_PORTABLE is defined, the
+   implementation is portable under C89/C90 and all times are obtained
+   with clock, which sums the CPU time across threads.
+
+   A report is printed as a line of text to stdout. If the BENCH_FORMAT
+   environment variable is "csv" or "json", a record is also written to
+   the file named by the BENCH_OUT environment variable, or to stdout if
+   BENCH_OUT is not set. A csv file begins with a header line and a json
+   file contains one object per line. If the BENCH_WARMUPS or BENCH_REPS
+   environment variable is set, its value replaces the number of warmup
+   repetitions or repetitions of each benchmark with more than one
+   repetition.
+
+   If the BENCH_PERF environment variable is set to a value other than
+   "0", the hardware performance counters of utilities-perf are also read
+   at the start and stop of each repetition, and the medians of the
+   available counters are reported. If no counter is available, a note is
+   printed to stderr once and the benchmarks run without counters. The
+   counters count the events of the thread that first initialized a
+   benchmark with BENCH_PERF set, which is expected to also start and stop
+   the repetitions.
+*/
+
+#ifndef UTILITIES_BENCH_H
+#define UTILITIES_BENCH_H
+
+#include <stdlib.h>
+#include "utilities-perf.h"
+
+typedef struct{
+  double min;
+  double p10;
+  double med;
+  double p90;
+  double p99;
+  double max;
+  double mean;
+} bench_summary_t;
+
+typedef struct{
+  const char *suite; /* e.g. name of a test program */
+  const char *name; /* e.g. name of a timed section */
+  size_t num_warmups;
+  size_t num_reps;
+  size_t num_calls; /* calls of bench_stop including warmups */
+  double *wall; /* samples of each repetition in seconds */
+  double *cpu;
+  double *proc_cpu;
+  double wall_start;
+  double cpu_start;
+  double proc_cpu_start;
+  int perf_on; /* 1 if counters are read, 0 otherwise */
+  perf_sample_t perf_start;
+  perf_sample_t *perf; /* counts of each repetition if perf_on */
+} bench_t;
+
+/**
+   Returns the monotonic wall-clock time, the CPU time of the calling
+   thread, and the CPU time of the process in seconds since an arbitrary
+   point.
+*/
+
+double bench_wall_time(void);
+
+double bench_cpu_time(void);
+
+double bench_proc_cpu_time(void);
+
+/**
+   Initializes a benchmark. The suite and name strings are not copied and
+   must remain valid until the benchmark is freed.
+   b           : pointer to a preallocated block of size sizeof(bench_t)
+   suite       : name of the suite of the benchmark
+   name        : name of the benchmark within the suite
+   num_warmups : number of repetitions that are not recorded
+   num_reps    : > 0 number of recorded repetitions
+*/
+void bench_init(bench_t *b,
+		const char *suite,
+		const char *name,
+		size_t num_warmups,
+		size_t num_reps);
+
+/**
+   Starts and stops a repetition. A repetition is recorded if it follows
+   all warmup repetitions and the number of recorded repetitions is less
+   than num_reps.
+*/
+
+void bench_start(bench_t *b);
+
+void bench_stop(bench_t *b);
+
+/**
+   Returns the number of recorded repetitions.
+*/
+size_t bench_count(const bench_t *b);
+
+/**
+   Calls fn num_warmups + num_reps times, passing arg and the index of the
+   call starting from 0, and times each call.
+*/
+void bench_run(bench_t *b, void (*fn)(void *, size_t), void *arg);
+
+/**
+   Computes the summaries of the recorded wall-clock, thread CPU, and
+   process CPU times. A NULL summary pointer is not computed. The
+   summaries are zero if no repetitions are recorded.
+*/
+void bench_summarize(const bench_t *b,
+		     bench_summary_t *wall,
+		     bench_summary_t *cpu,
+		     bench_summary_t *proc_cpu);
+
+/**
+   Computes the medians of the recorded counts of each counter. Returns 1
+   if counters were read, and 0 otherwise, in which case, and for each
+   unavailable counter, the value is PERF_NA.
+*/
+int bench_summarize_perf(const bench_t *b, perf_sample_t *med);
+
+/**
+   Prints a report of the recorded repetitions. The line of text consists
+   of label followed by the median wall-clock time and the 10th and 90th
+   percentiles, followed by a line with the medians of the counts if
+   counters were read. params is a string describing the parameters of the
+   benchmark for a csv or json record, e.g. "vts=1024 es=65536", without
+   commas, double quotes, and backslashes, or NULL.
+*/
+void bench_report(const bench_t *b, const char *label, const char *params);
+
+/**
+   Frees the samples of a benchmark. The block pointed to by b is not
+   freed.
+*/
+void bench_free(bench_t *b);
+
+#endif
@@ -0,0 +1,429 @@
+/**
+   utilities-cpu-avx2.c
+
+   AVX2 kernels of utilities-cpu. The file is compiled with -mavx2 and
+   contains the kernels only if the compiler targets AVX2 on an x86-64
+   system, where size_t is a 64-bit lane. The kernels process four
+   blocks per iteration and the remaining blocks with scalar code.
+
+   Because AVX2 does not provide an unsigned 64-bit comparison, the
+   minimum is computed with signed comparisons of values with a flipped
+   most significant bit. The low 64 bits of a 64-bit product are computed
+   from three 32-bit products, and the number of set bits with a nibble
+   lookup table and sums of absolute differences. The intersection of two
+   sets compares a block of four elements of each set with the four
+   rotations of the other block, and advances the block with the lower
+   last element, or both blocks if the last elements are equal.
+
+   The typed sort and merge kernels are generated from utilities-cpu-sort-
+   impl.h with vectors of eight int or four 64-bit lanes. A permutation
+   or a selection of 64-bit lanes is performed on pairs of 32-bit lanes,
+   and the minimum and maximum of 64-bit lanes are computed with a signed
+   comparison, after flipping the most significant bit for unsigned keys.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include "utilities-cpu.h"
+
+#if defined(__AVX2__) && defined(__x86_64__) && !defined(__ILP32__)
+
+#include <immintrin.h>
+
+static const size_t C_LANES = 4;
+static const size_t C_FULL_BIT = 64;
+static const size_t C_MSB = (size_t)1 << 63;
+
+static size_t min_ix(const size_t *a, size_t n);
+static size_t bitset_count(const size_t *a, size_t n);
+static void bitset_or(size_t *dst, const size_t *src, size_t n);
+static void bitset_and(size_t *dst, const size_t *src, size_t n);
+static void hash_mul(size_t *h,
+		     const size_t *keys,
+		     size_t n,
+		     size_t mul,
+		     size_t log_count);
+static size_t isect(size_t *out,
+		    const size_t *a,
+		    size_t a_count,
+		    const size_t *b,
+		    size_t b_count);
+static size_t isect_merge(size_t *out,
+			  const size_t *a,
+			  size_t a_count,
+			  const size_t *b,
+			  size_t b_count);
+static __m256i mullo(__m256i a, __m256i b);
+
+#define KFN_CAT(f, name) f##_##name
+#define KFN_EXP(f, name) KFN_CAT(f, name)
+#define KFN(f) KFN_EXP(f, KERNEL_NAME)
+
+/**
+   Vector primitives of the typed sort and merge kernels.
+*/
+
+static __m256i iota32(void){
+  return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+}
+
+static __m256i perm32(__m256i x, int m){
+  return _mm256_permutevar8x32_epi32(x,
+				     _mm256_xor_si256(iota32(),
+						      _mm256_set1_epi32(m)));
+}
+
+static __m256i mask32(int bit){
+  __m256i v = _mm256_set1_epi32(bit);
+  return _mm256_cmpeq_epi32(_mm256_and_si256(iota32(), v), v);
+}
+
+static __m256i sel32(__m256i a, __m256i b, int bit){
+  return _mm256_blendv_epi8(a, b, mask32(bit));
+}
+
+static __m256d min_pd(__m256d a, __m256d b){
+  return _mm256_blendv_pd(a, b, _mm256_cmp_pd(b, a, _CMP_LT_OQ));
+}
+
+static __m256d max_pd(__m256d a, __m256d b){
+  return _mm256_blendv_pd(a, b, _mm256_cmp_pd(a, b, _CMP_LT_OQ));
+}
+
+static __m256d perm_pd(__m256d x, int m){
+  return _mm256_castsi256_pd(perm32(_mm256_castpd_si256(x), 2 * m));
+}
+
+static __m256d sel_pd(__m256d a, __m256d b, int bit){
+  return _mm256_blendv_pd(a, b, _mm256_castsi256_pd(mask32(2 * bit)));
+}
+
+#define KERNEL_T int
+#define KERNEL_NAME int
+#define KERNEL_MAX INT_MAX
+#define VEC_T __m256i
+#define VLANES 8
+#define VLOAD(p) _mm256_loadu_si256((const __m256i *)(p))
+#define VSTORE(p, v) _mm256_storeu_si256((__m256i *)(p), (v))
+#define VMIN(a, b) _mm256_min_epi32((a), (b))
+#define VMAX(a, b) _mm256_max_epi32((a), (b))
+#define VPERM(x, m) perm32((x), (m))
+#define VSEL(a, b, bit) sel32((a), (b), (bit))
+#include "utilities-cpu-sort-impl.h"
+#undef KERNEL_T
+#undef KERNEL_NAME
+#undef KERNEL_MAX
+#undef VEC_T
+#undef VLANES
+#undef VLOAD
+#undef VSTORE
+#undef VMIN
+#undef VMAX
+#undef VPERM
+#undef VSEL
+
+#if ULONG_MAX > 0xffffffffUL
+
+static __m256i min_epi64(__m256i a, __m256i b){
+  return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b));
+}
+
+static __m256i max_epi64(__m256i a, __m256i b){
+  return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(b, a));
+}
+
+static __m256i min_epu64(__m256i a, __m256i b){
+  __m256i msb = _mm256_set1_epi64x(C_MSB);
+  return _mm256_blendv_epi8(a,
+			    b,
+			    _mm256_cmpgt_epi64(_mm256_xor_si256(a, msb),
+					       _mm256_xor_si256(b, msb)));
+}
+
+static __m256i max_epu64(__m256i a, __m256i b){
+  __m256i msb = _mm256_set1_epi64x(C_MSB);
+  return _mm256_blendv_epi8(a,
+			    b,
+			    _mm256_cmpgt_epi64(_mm256_xor_si256(b, msb),
+					       _mm256_xor_si256(a, msb)));
+}
+
+#define KERNEL_T long
+#define KERNEL_NAME long
+#define KERNEL_MAX LONG_MAX
+#define VEC_T __m256i
+#define VLANES 4
+#define VLOAD(p) _mm256_loadu_si256((const __m256i *)(p))
+#define VSTORE(p, v) _mm256_storeu_si256((__m256i *)(p), (v))
+#define VMIN(a, b) min_epi64((a), (b))
+#define VMAX(a, b) max_epi64((a), (b))
+#define VPERM(x, m) perm32((x), 2 * (m))
+#define VSEL(a, b, bit) sel32((a), (b), 2 * (bit))
+#include "utilities-cpu-sort-impl.h"
+#undef KERNEL_T
+#undef KERNEL_NAME
+#undef KERNEL_MAX
+#undef VMIN
+#undef VMAX
+
+#define KERNEL_T unsigned long
+#define KERNEL_NAME ulong
+#define KERNEL_MAX ULONG_MAX
+#define VMIN(a, b) min_epu64((a), (b))
+#define VMAX(a, b) max_epu64((a), (b))
+#include "utilities-cpu-sort-impl.h"
+#undef KERNEL_T
+#undef KERNEL_NAME
+#undef KERNEL_MAX
+#undef VEC_T
+#undef VLANES
+#undef VLOAD
+#undef VSTORE
+#undef VMIN
+#undef VMAX
+#undef VPERM
+#undef VSEL
+
+#endif
+
+#define KERNEL_T double
+#define KERNEL_NAME double
+#define KERNEL_MAX HUGE_VAL
+#define VEC_T __m256d
+#define VLANES 4
+#define VLOAD(p) _mm256_loadu_pd(p)
+#define VSTORE(p, v) _mm256_storeu_pd((p), (v))
+#define VMIN(a, b) min_pd((a), (b))
+#define VMAX(a, b) max_pd((a), (b))
+#define VPERM(x, m) perm_pd((x), (m))
+#define VSEL(a, b, bit) sel_pd((a), (b), (bit))
+#include "utilities-cpu-sort-impl.h"
+#undef KERNEL_T
+#undef KERNEL_NAME
+#undef KERNEL_MAX
+#undef VEC_T
+#undef VLANES
+#undef VLOAD
+#undef VSTORE
+#undef VMIN
+#undef VMAX
+#undef VPERM
+#undef VSEL
+
+/**
+   Sets the AVX2 kernels in a table and returns 1.
+*/
+int cpu_avx2_kernels(cpu_kernels_t *k){
+  k->min_ix = min_ix;
+  k->bitset_count = bitset_count;
+  k->bitset_or = bitset_or;
+  k->bitset_and = bitset_and;
+  k->hash_mul = hash_mul;
+  k->isect = isect;
+  k->sort_int = sort_int;
+  k->sort_double = sort_double;
+  k->merge_int = merge_int;
+  k->merge_double = merge_double;
+#if ULONG_MAX > 0xffffffffUL
+  k->sort_long = sort_long;
+  k->sort_ulong = sort_ulong;
+  k->merge_long = merge_long;
+  k->merge_ulong = merge_ulong;
+#endif
+  return 1;
+}
+
+/**
+   Computes the minimum in a first pass, and finds its first index in a
+   second pass that stops at the block of four with the index.
+*/
+static size_t min_ix(const size_t *a, size_t n){
+  size_t i, min;
+  size_t buf[4];
+  int mask;
+  __m256i m, v, msb;
+  if (n < C_LANES){
+    for (i = 1, min = 0; i < n; i++){
+      if (a[i] < a[min]) min = i;
+    }
+    return min;
+  }
+  msb = _mm256_set1_epi64x(C_MSB);
+  m = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)a), msb);
+  for (i = C_LANES; i + C_LANES <= n; i += C_LANES){
+    v = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(a + i)), msb);
+    m = _mm256_blendv_epi8(m, v, _mm256_cmpgt_epi64(m, v));
+  }
+  _mm256_storeu_si256((__m256i *)buf, _mm256_xor_si256(m, msb));
+  min = buf[0];
+  for (i = 1; i < C_LANES; i++){
+    if (buf[i] < min) min = buf[i];
+  }
+  for (i = n - n % C_LANES; i < n; i++){
+    if (a[i] < min) min = a[i];
+  }
+  v = _mm256_set1_epi64x(min);
+  for (i = 0; i + C_LANES <= n; i += C_LANES){
+    m = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *)(a + i)), v);
+    mask = _mm256_movemask_pd(_mm256_castsi256_pd(m));
+    if (mask) return i + __builtin_ctz(mask);
+  }
+  for (; a[i] != min; i++);
+  return i;
+}
+
+static size_t bitset_count(const size_t *a, size_t n){
+  size_t i, c = 0;
+  size_t buf[4];
+  __m256i v, lo, hi, acc, lookup, low_mask, zero;
+  lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+			    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  low_mask = _mm256_set1_epi8(0x0f);
+  zero = _mm256_setzero_si256();
+  acc = zero;
+  for (i = 0; i + C_LANES <= n; i += C_LANES){
+    v = _mm256_loadu_si256((const __m256i *)(a + i));
+    lo = _mm256_and_si256(v, low_mask);
+    hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+    v = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo),
+			_mm256_shuffle_epi8(lookup, hi));
+    acc = _mm256_add_epi64(acc, _mm256_sad_epu8(v, zero));
+  }
+  _mm256_storeu_si256((__m256i *)buf, acc);
+  c = buf[0] + buf[1] + buf[2] + buf[3];
+  for (; i < n; i++){
+    c += __builtin_popcountll(a[i]);
+  }
+  return c;
+}
+
+static void bitset_or(size_t *dst, const size_t *src, size_t n){
+  size_t i;
+  __m256i v;
+  for (i = 0; i + C_LANES <= n; i += C_LANES){
+    v = _mm256_or_si256(_mm256_loadu_si256((const __m256i *)(dst + i)),
+			_mm256_loadu_si256((const __m256i *)(src + i)));
+    _mm256_storeu_si256((__m256i *)(dst + i), v);
+  }
+  for (; i < n; i++){
+    dst[i] |= src[i];
+  }
+}
+
+static void bitset_and(size_t *dst, const size_t *src, size_t n){
+  size_t i;
+  __m256i v;
+  for (i = 0; i + C_LANES <= n; i += C_LANES){
+    v = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(dst + i)),
+			 _mm256_loadu_si256((const __m256i *)(src + i)));
+    _mm256_storeu_si256((__m256i *)(dst + i), v);
+  }
+  for (; i < n; i++){
+    dst[i] &= src[i];
+  }
+}
+
+static void hash_mul(size_t *h,
+		     const size_t *keys,
+		     size_t n,
+		     size_t mul,
+		     size_t log_count){
+  size_t i;
+  size_t shift = C_FULL_BIT - log_count;
+  __m256i v, m;
+  __m128i s;
+  m = _mm256_set1_epi64x(mul);
+  s = _mm_cvtsi64_si128(shift);
+  for (i = 0; i + C_LANES <= n; i += C_LANES){
+    v = mullo(_mm256_loadu_si256((const __m256i *)(keys + i)), m);
+    _mm256_storeu_si256((__m256i *)(h + i), _mm256_srl_epi64(v, s));
+  }
+  for (; i < n; i++){
+    h[i] = (keys[i] * mul) >> shift;
+  }
+}
+
+static size_t isect(size_t *out,
+		    const size_t *a,
+		    size_t a_count,
+		    const size_t *b,
+		    size_t b_count){
+  size_t i = 0, j = 0, c = 0;
+  size_t a_last, b_last;
+  int mask;
+  __m256i va, vb, m;
+  while (i + C_LANES <= a_count && j + C_LANES <= b_count){
+    va = _mm256_loadu_si256((const __m256i *)(a + i));
+    vb = _mm256_loadu_si256((const __m256i *)(b + j));
+    m = _mm256_or_si256(
+	  _mm256_or_si256(
+	    _mm256_cmpeq_epi64(va, vb),
+	    _mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, 0x39))),
+	  _mm256_or_si256(
+	    _mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, 0x4e)),
+	    _mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, 0x93))));
+    mask = _mm256_movemask_pd(_mm256_castsi256_pd(m));
+    if (out == NULL){
+      c += __builtin_popcount(mask);
+    }else{
+      for (; mask; mask &= mask - 1){
+	out[c++] = a[i + __builtin_ctz(mask)];
+      }
+    }
+    a_last = a[i + C_LANES - 1];
+    b_last = b[j + C_LANES - 1];
+    if (a_last <= b_last) i += C_LANES;
+    if (b_last <= a_last) j += C_LANES;
+  }
+  return c + isect_merge((out == NULL) ? NULL : out + c,
+			 a + i,
+			 a_count - i,
+			 b + j,
+			 b_count - j);
+}
+
+static size_t isect_merge(size_t *out,
+			  const size_t *a,
+			  size_t a_count,
+			  const size_t *b,
+			  size_t b_count){
+  size_t i = 0, j = 0, c = 0;
+  while (i < a_count && j < b_count){
+    if (a[i] < b[j]){
+      i++;
+    }else if (b[j] < a[i]){
+      j++;
+    }else{
+      if (out != NULL) out[c] = a[i];
+      c++;
+      i++;
+      j++;
+    }
+  }
+  return c;
+}
+
+/**
+   Computes the low 64 bits of the products of the 64-bit lanes.
+*/
+static __m256i mullo(__m256i a, __m256i b){
+  __m256i lo, cross;
+  lo = _mm256_mul_epu32(a, b);
+  cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+			   _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+  return _mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32));
+}
+
+#else
+
+/**
+   The build does not contain the AVX2 kernels.
+*/
+int cpu_avx2_kernels(cpu_kernels_t *k){
+  (void)k;
+  return 0;
+}
+
+#endif
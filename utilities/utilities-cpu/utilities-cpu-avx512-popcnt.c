@@ -0,0 +1,66 @@
+/**
+   utilities-cpu-avx512-popcnt.c
+
+   AVX-512 popcount kernels of utilities-cpu. The file is compiled with
+   -mavx512f -mavx512vpopcntdq and contains the kernels only if the
+   compiler targets these extensions on an x86-64 system, where size_t is
+   a 64-bit lane. The kernels are set on top of the AVX-512 kernels if
+   the processor supports VPOPCNTDQ, which is not the case on e.g.
+   Skylake-X and Cascade Lake, where the AVX-512 level uses the AVX2
+   popcount kernels.
+*/
+
+#include <stdlib.h>
+#include "utilities-cpu.h"
+
+#if defined(__AVX512F__) && defined(__AVX512VPOPCNTDQ__) &&	\
+  defined(__x86_64__) && !defined(__ILP32__)
+
+#include <immintrin.h>
+
+static const size_t C_LANES = 8;
+
+static size_t bitset_count(const size_t *a, size_t n);
+static __mmask8 tail_mask(size_t n);
+
+/**
+   Sets the AVX-512 popcount kernels in a table and returns 1.
+*/
+int cpu_avx512_popcnt_kernels(cpu_kernels_t *k){
+  k->bitset_count = bitset_count;
+  return 1;
+}
+
+static size_t bitset_count(const size_t *a, size_t n){
+  size_t i;
+  __m512i acc = _mm512_setzero_si512();
+  for (i = 0; i + C_LANES <= n; i += C_LANES){
+    acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(_mm512_loadu_si512(a + i)));
+  }
+  if (i < n){
+    acc = _mm512_add_epi64(acc,
+			   _mm512_popcnt_epi64(
+			     _mm512_maskz_loadu_epi64(tail_mask(n - i),
+						      a + i)));
+  }
+  return _mm512_reduce_add_epi64(acc);
+}
+
+/**
+   Returns the mask of the first n lanes, where 0 < n < 8.
+*/
+static __mmask8 tail_mask(size_t n){
+  return (__mmask8)((1u << n) - 1);
+}
+
+#else
+
+/**
+   The build does not contain the AVX-512 popcount kernels.
+*/
+int cpu_avx512_popcnt_kernels(cpu_kernels_t *k){
+  (void)k;
+  return 0;
+}
+
+#endif
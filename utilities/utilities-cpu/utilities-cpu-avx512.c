@@ -0,0 +1,380 @@
+/**
+   utilities-cpu-avx512.c
+
+   AVX-512 kernels of utilities-cpu. The file is compiled with -mavx512f
+   -mavx512dq and contains the kernels only if the compiler targets these
+   extensions on an x86-64 system, where size_t is a 64-bit lane. The
+   kernels process eight blocks per iteration and the remaining blocks
+   with masked loads and stores. The popcount kernels require VPOPCNTDQ
+   and are in utilities-cpu-avx512-popcnt.c. The intersection of two
+   sets compares a block of eight elements of each set with the eight
+   rotations of the other block, compresses the matching elements to the
+   output, and processes the remaining elements with a merge.
+
+   The typed sort and merge kernels are generated from utilities-cpu-sort-
+   impl.h with vectors of sixteen int or eight 64-bit lanes, where the
+   selections of the networks are mask blends.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include "utilities-cpu.h"
+
+#if defined(__AVX512F__) && defined(__AVX512DQ__) &&	\
+  defined(__x86_64__) && !defined(__ILP32__)
+
+#include <immintrin.h>
+
+static const size_t C_LANES = 8;
+static const size_t C_FULL_BIT = 64;
+
+static size_t min_ix(const size_t *a, size_t n);
+static void bitset_or(size_t *dst, const size_t *src, size_t n);
+static void bitset_and(size_t *dst, const size_t *src, size_t n);
+static void hash_mul(size_t *h,
+		     const size_t *keys,
+		     size_t n,
+		     size_t mul,
+		     size_t log_count);
+static size_t isect(size_t *out,
+		    const size_t *a,
+		    size_t a_count,
+		    const size_t *b,
+		    size_t b_count);
+static size_t isect_merge(size_t *out,
+			  const size_t *a,
+			  size_t a_count,
+			  const size_t *b,
+			  size_t b_count);
+static __mmask8 tail_mask(size_t n);
+
+#define KFN_CAT(f, name) f##_##name
+#define KFN_EXP(f, name) KFN_CAT(f, name)
+#define KFN(f) KFN_EXP(f, KERNEL_NAME)
+
+/**
+   Vector primitives of the typed sort and merge kernels.
+*/
+
+static __m512i iota32(void){
+  return _mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8,
+			  7, 6, 5, 4, 3, 2, 1, 0);
+}
+
+static __m512i iota64(void){
+  return _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0);
+}
+
+static __m512i perm32(__m512i x, int m){
+  return _mm512_permutexvar_epi32(_mm512_xor_si512(iota32(),
+						   _mm512_set1_epi32(m)),
+				  x);
+}
+
+static __m512i sel32(__m512i a, __m512i b, int bit){
+  return _mm512_mask_blend_epi32(_mm512_test_epi32_mask(iota32(),
+							_mm512_set1_epi32(bit)),
+				 a,
+				 b);
+}
+
+static __m512d min_pd(__m512d a, __m512d b){
+  return _mm512_mask_blend_pd(_mm512_cmp_pd_mask(b, a, _CMP_LT_OQ), a, b);
+}
+
+static __m512d max_pd(__m512d a, __m512d b){
+  return _mm512_mask_blend_pd(_mm512_cmp_pd_mask(a, b, _CMP_LT_OQ), a, b);
+}
+
+static __m512d perm_pd(__m512d x, int m){
+  return _mm512_permutexvar_pd(_mm512_xor_si512(iota64(),
+						_mm512_set1_epi64(m)),
+			       x);
+}
+
+static __m512d sel_pd(__m512d a, __m512d b, int bit){
+  return _mm512_mask_blend_pd(_mm512_test_epi64_mask(iota64(),
+						     _mm512_set1_epi64(bit)),
+			      a,
+			      b);
+}
+
+#define KERNEL_T int
+#define KERNEL_NAME int
+#define KERNEL_MAX INT_MAX
+#define VEC_T __m512i
+#define VLANES 16
+#define VLOAD(p) _mm512_loadu_si512(p)
+#define VSTORE(p, v) _mm512_storeu_si512((p), (v))
+#define VMIN(a, b) _mm512_min_epi32((a), (b))
+#define VMAX(a, b) _mm512_max_epi32((a), (b))
+#define VPERM(x, m) perm32((x), (m))
+#define VSEL(a, b, bit) sel32((a), (b), (bit))
+#include "utilities-cpu-sort-impl.h"
+#undef KERNEL_T
+#undef KERNEL_NAME
+#undef KERNEL_MAX
+#undef VLANES
+#undef VMIN
+#undef VMAX
+#undef VPERM
+#undef VSEL
+
+#if ULONG_MAX > 0xffffffffUL
+
+static __m512i perm64(__m512i x, int m){
+  return _mm512_permutexvar_epi64(_mm512_xor_si512(iota64(),
+						   _mm512_set1_epi64(m)),
+				  x);
+}
+
+static __m512i sel64(__m512i a, __m512i b, int bit){
+  return _mm512_mask_blend_epi64(_mm512_test_epi64_mask(iota64(),
+							_mm512_set1_epi64(bit)),
+				 a,
+				 b);
+}
+
+#define KERNEL_T long
+#define KERNEL_NAME long
+#define KERNEL_MAX LONG_MAX
+#define VLANES 8
+#define VMIN(a, b) _mm512_min_epi64((a), (b))
+#define VMAX(a, b) _mm512_max_epi64((a), (b))
+#define VPERM(x, m) perm64((x), (m))
+#define VSEL(a, b, bit) sel64((a), (b), (bit))
+#include "utilities-cpu-sort-impl.h"
+#undef KERNEL_T
+#undef KERNEL_NAME
+#undef KERNEL_MAX
+#undef VMIN
+#undef VMAX
+
+#define KERNEL_T unsigned long
+#define KERNEL_NAME ulong
+#define KERNEL_MAX ULONG_MAX
+#define VMIN(a, b) _mm512_min_epu64((a), (b))
+#define VMAX(a, b) _mm512_max_epu64((a), (b))
+#include "utilities-cpu-sort-impl.h"
+#undef KERNEL_T
+#undef KERNEL_NAME
+#undef KERNEL_MAX
+#undef VLANES
+#undef VMIN
+#undef VMAX
+#undef VPERM
+#undef VSEL
+
+#endif
+
+#undef VEC_T
+#undef VLOAD
+#undef VSTORE
+
+#define KERNEL_T double
+#define KERNEL_NAME double
+#define KERNEL_MAX HUGE_VAL
+#define VEC_T __m512d
+#define VLANES 8
+#define VLOAD(p) _mm512_loadu_pd(p)
+#define VSTORE(p, v) _mm512_storeu_pd((p), (v))
+#define VMIN(a, b) min_pd((a), (b))
+#define VMAX(a, b) max_pd((a), (b))
+#define VPERM(x, m) perm_pd((x), (m))
+#define VSEL(a, b, bit) sel_pd((a), (b), (bit))
+#include "utilities-cpu-sort-impl.h"
+#undef KERNEL_T
+#undef KERNEL_NAME
+#undef KERNEL_MAX
+#undef VEC_T
+#undef VLANES
+#undef VLOAD
+#undef VSTORE
+#undef VMIN
+#undef VMAX
+#undef VPERM
+#undef VSEL
+
+/**
+   Sets the AVX-512 kernels in a table and returns 1.
+*/
+int cpu_avx512_kernels(cpu_kernels_t *k){
+  k->min_ix = min_ix;
+  k->bitset_or = bitset_or;
+  k->bitset_and = bitset_and;
+  k->hash_mul = hash_mul;
+  k->isect = isect;
+  k->sort_int = sort_int;
+  k->sort_double = sort_double;
+  k->merge_int = merge_int;
+  k->merge_double = merge_double;
+#if ULONG_MAX > 0xffffffffUL
+  k->sort_long = sort_long;
+  k->sort_ulong = sort_ulong;
+  k->merge_long = merge_long;
+  k->merge_ulong = merge_ulong;
+#endif
+  return 1;
+}
+
+/**
+   Computes the minimum in a first pass, and finds its first index in a
+   second pass that stops at the block of eight with the index.
+*/
+static size_t min_ix(const size_t *a, size_t n){
+  size_t i, min;
+  __mmask8 mask;
+  __m512i m, v;
+  if (n == 0) return 0;
+  m = _mm512_set1_epi64(a[0]);
+  for (i = 0; i + C_LANES <= n; i += C_LANES){
+    m = _mm512_min_epu64(m, _mm512_loadu_si512(a + i));
+  }
+  if (i < n){
+    m = _mm512_mask_min_epu64(m,
+			      tail_mask(n - i),
+			      m,
+			      _mm512_maskz_loadu_epi64(tail_mask(n - i),
+						       a + i));
+  }
+  min = _mm512_reduce_min_epu64(m);
+  v = _mm512_set1_epi64(min);
+  for (i = 0; i + C_LANES <= n; i += C_LANES){
+    mask = _mm512_cmpeq_epu64_mask(_mm512_loadu_si512(a + i), v);
+    if (mask) return i + __builtin_ctz(mask);
+  }
+  for (; a[i] != min; i++);
+  return i;
+}
+
+static void bitset_or(size_t *dst, const size_t *src, size_t n){
+  size_t i;
+  __mmask8 mask;
+  __m512i v;
+  for (i = 0; i + C_LANES <= n; i += C_LANES){
+    v = _mm512_or_si512(_mm512_loadu_si512(dst + i),
+			_mm512_loadu_si512(src + i));
+    _mm512_storeu_si512(dst + i, v);
+  }
+  if (i < n){
+    mask = tail_mask(n - i);
+    v = _mm512_or_si512(_mm512_maskz_loadu_epi64(mask, dst + i),
+			_mm512_maskz_loadu_epi64(mask, src + i));
+    _mm512_mask_storeu_epi64(dst + i, mask, v);
+  }
+}
+
+static void bitset_and(size_t *dst, const size_t *src, size_t n){
+  size_t i;
+  __mmask8 mask;
+  __m512i v;
+  for (i = 0; i + C_LANES <= n; i += C_LANES){
+    v = _mm512_and_si512(_mm512_loadu_si512(dst + i),
+			 _mm512_loadu_si512(src + i));
+    _mm512_storeu_si512(dst + i, v);
+  }
+  if (i < n){
+    mask = tail_mask(n - i);
+    v = _mm512_and_si512(_mm512_maskz_loadu_epi64(mask, dst + i),
+			 _mm512_maskz_loadu_epi64(mask, src + i));
+    _mm512_mask_storeu_epi64(dst + i, mask, v);
+  }
+}
+
+static void hash_mul(size_t *h,
+		     const size_t *keys,
+		     size_t n,
+		     size_t mul,
+		     size_t log_count){
+  size_t i;
+  __mmask8 mask;
+  __m512i v, m;
+  __m128i s;
+  m = _mm512_set1_epi64(mul);
+  s = _mm_cvtsi64_si128(C_FULL_BIT - log_count);
+  for (i = 0; i + C_LANES <= n; i += C_LANES){
+    v = _mm512_mullo_epi64(_mm512_loadu_si512(keys + i), m);
+    _mm512_storeu_si512(h + i, _mm512_srl_epi64(v, s));
+  }
+  if (i < n){
+    mask = tail_mask(n - i);
+    v = _mm512_mullo_epi64(_mm512_maskz_loadu_epi64(mask, keys + i), m);
+    _mm512_mask_storeu_epi64(h + i, mask, _mm512_srl_epi64(v, s));
+  }
+}
+
+static size_t isect(size_t *out,
+		    const size_t *a,
+		    size_t a_count,
+		    const size_t *b,
+		    size_t b_count){
+  size_t i = 0, j = 0, c = 0;
+  size_t a_last, b_last;
+  __mmask8 mask;
+  __m512i va, vb;
+  while (i + C_LANES <= a_count && j + C_LANES <= b_count){
+    va = _mm512_loadu_si512(a + i);
+    vb = _mm512_loadu_si512(b + j);
+    mask = _mm512_cmpeq_epu64_mask(va, vb);
+    mask |= _mm512_cmpeq_epu64_mask(va, _mm512_alignr_epi64(vb, vb, 1));
+    mask |= _mm512_cmpeq_epu64_mask(va, _mm512_alignr_epi64(vb, vb, 2));
+    mask |= _mm512_cmpeq_epu64_mask(va, _mm512_alignr_epi64(vb, vb, 3));
+    mask |= _mm512_cmpeq_epu64_mask(va, _mm512_alignr_epi64(vb, vb, 4));
+    mask |= _mm512_cmpeq_epu64_mask(va, _mm512_alignr_epi64(vb, vb, 5));
+    mask |= _mm512_cmpeq_epu64_mask(va, _mm512_alignr_epi64(vb, vb, 6));
+    mask |= _mm512_cmpeq_epu64_mask(va, _mm512_alignr_epi64(vb, vb, 7));
+    if (out != NULL) _mm512_mask_compressstoreu_epi64(out + c, mask, va);
+    c += __builtin_popcount(mask);
+    a_last = a[i + C_LANES - 1];
+    b_last = b[j + C_LANES - 1];
+    if (a_last <= b_last) i += C_LANES;
+    if (b_last <= a_last) j += C_LANES;
+  }
+  return c + isect_merge((out == NULL) ? NULL : out + c,
+			 a + i,
+			 a_count - i,
+			 b + j,
+			 b_count - j);
+}
+
+static size_t isect_merge(size_t *out,
+			  const size_t *a,
+			  size_t a_count,
+			  const size_t *b,
+			  size_t b_count){
+  size_t i = 0, j = 0, c = 0;
+  while (i < a_count && j < b_count){
+    if (a[i] < b[j]){
+      i++;
+    }else if (b[j] < a[i]){
+      j++;
+    }else{
+      if (out != NULL) out[c] = a[i];
+      c++;
+      i++;
+      j++;
+    }
+  }
+  return c;
+}
+
+/**
+   Returns the mask of the first n lanes, where 0 < n < 8.
+*/
+static __mmask8 tail_mask(size_t n){
+  return (__mmask8)((1u << n) - 1);
+}
+
+#else
+
+/**
+   The build does not contain the AVX-512 kernels.
+*/
+int cpu_avx512_kernels(cpu_kernels_t *k){
+  (void)k;
+  return 0;
+}
+
+#endif
@@ -0,0 +1,340 @@
+/**
+   utilities-cpu-sort-impl.h
+
+   Typed sort and merge kernels of utilities-cpu. The file is included by
+   the file of a level once per primitive type, with KERNEL_T defined as
+   the type, and KFN(f) as the name f suffixed with the type name. The file
+   does not have an include guard.
+
+   If VEC_T is defined, the kernels are vectorized with KERNEL_MAX defined
+   as the maximum value of the type and the following macros of the
+   including file, where a lane with index i is the ith element of a
+   vector:
+      VEC_T            : vector type of VLANES elements, VLANES >= 2
+      VLOAD(p)         : loads a vector from p, not necessarily aligned
+      VSTORE(p, v)     : stores a vector to p, not necessarily aligned
+      VMIN(a, b)       : lanewise b < a ? b : a
+      VMAX(a, b)       : lanewise a < b ? b : a
+      VPERM(x, m)      : lane i is lane i ^ m of x
+      VSEL(a, b, bit)  : lane i is lane i of b if i & bit, of a otherwise
+   VMIN and VMAX exchange two lanes only if one is less than the other,
+   so that the kernels permute the elements also if the keys are not
+   ordered by <, e.g. NaN keys. A vector is sorted with a bitonic sorting
+   network, two sorted vectors are merged with a bitonic merging network,
+   sort_small sorts up to two vectors of elements padded with KERNEL_MAX,
+   and merge outputs a vector at a time by merging the vector of the
+   largest elements seen so far with a vector of the array with the lower
+   next element. sort_leaf sorts up to 32 vectors of elements by sorting
+   blocks with sort_small and merging the blocks with merge through a
+   buffer on the stack.
+
+   Otherwise, the kernels are portable C: sort_leaf sorts up to 16
+   elements with sorting networks of branchless compare-exchange
+   operations if the count is at most 4 and with insertion sort otherwise,
+   and merge is branchless.
+
+   At each level, sort is a quicksort with a median-of-three pivot that
+   sorts small ranges with sort_leaf and falls back to qsort if the
+   recursion depth exceeds 2 * log_{2}(count).
+*/
+
+#ifdef VEC_T
+#define SORT_SMALL_COUNT (2 * VLANES)
+#define SORT_LEAF_COUNT (32 * VLANES)
+#else
+#define SORT_SMALL_COUNT 16
+#define SORT_LEAF_COUNT 16
+#endif
+
+static int KFN(cmp)(const void *a, const void *b){
+  return (*(const KERNEL_T *)a > *(const KERNEL_T *)b) -
+    (*(const KERNEL_T *)a < *(const KERNEL_T *)b);
+}
+
+/**
+   Compare-exchange of two elements without a conditional jump on common
+   compilers and platforms.
+*/
+static void KFN(cswap)(KERNEL_T *a, KERNEL_T *b){
+  KERNEL_T x = *a, y = *b;
+  int t = (y < x);
+  *a = t ? y : x;
+  *b = t ? x : y;
+}
+
+/**
+   Merges two sorted arrays onto a concatenation array without a
+   conditional jump in the comparison loop.
+*/
+static void KFN(merge_scalar)(KERNEL_T *c,
+			      const KERNEL_T *a,
+			      size_t a_count,
+			      const KERNEL_T *b,
+			      size_t b_count){
+  int t;
+  const KERNEL_T *a_end = a + a_count;
+  const KERNEL_T *b_end = b + b_count;
+  while (a < a_end && b < b_end){
+    t = (*a < *b);
+    *c++ = t ? *a : *b;
+    a += t;
+    b += !t;
+  }
+  memcpy(c, a, (a_end - a) * sizeof(KERNEL_T));
+  c += a_end - a;
+  memcpy(c, b, (b_end - b) * sizeof(KERNEL_T));
+}
+
+#ifdef VEC_T
+
+/**
+   Performs a step of a network: lanes i and i ^ m are compare-exchanged,
+   and the lane with the bit set receives the greater element.
+*/
+static VEC_T KFN(vstep)(VEC_T x, int m, int bit){
+  VEC_T t = VPERM(x, m);
+  return VSEL(VMIN(x, t), VMAX(x, t), bit);
+}
+
+/**
+   Sorts the lanes of a vector with a bitonic sorting network.
+*/
+static VEC_T KFN(vsort)(VEC_T x){
+  int k, j;
+  for (k = 2; k <= VLANES; k *= 2){
+    x = KFN(vstep)(x, k - 1, k / 2);
+    for (j = k / 4; j > 0; j /= 2){
+      x = KFN(vstep)(x, j, j);
+    }
+  }
+  return x;
+}
+
+/**
+   Merges two sorted vectors with a bitonic merging network. The lower
+   half is in lo and the upper half is in hi, each sorted.
+*/
+static void KFN(vmerge)(VEC_T *lo, VEC_T *hi){
+  int j;
+  VEC_T b = VPERM(*hi, VLANES - 1);
+  VEC_T l = VMIN(*lo, b), h = VMAX(b, *lo);
+  for (j = VLANES / 2; j > 0; j /= 2){
+    l = KFN(vstep)(l, j, j);
+    h = KFN(vstep)(h, j, j);
+  }
+  *lo = l;
+  *hi = h;
+}
+
+/**
+   Sorts a range of at most SORT_SMALL_COUNT elements. The padding
+   elements are not less than any element and remain in the upper
+   positions.
+*/
+static void KFN(sort_small)(KERNEL_T *a, size_t count){
+  size_t i;
+  KERNEL_T buf[SORT_SMALL_COUNT];
+  VEC_T x, y;
+  memcpy(buf, a, count * sizeof(KERNEL_T));
+  for (i = count; i < SORT_SMALL_COUNT; i++){
+    buf[i] = KERNEL_MAX;
+  }
+  x = KFN(vsort)(VLOAD(buf));
+  y = KFN(vsort)(VLOAD(buf + VLANES));
+  KFN(vmerge)(&x, &y);
+  VSTORE(buf, x);
+  VSTORE(buf + VLANES, y);
+  memcpy(a, buf, count * sizeof(KERNEL_T));
+}
+
+/**
+   Merges two sorted arrays onto a concatenation array a vector at a time
+   while the array with the lower next element contains a vector of
+   elements, and merges the remaining elements and the vector of the
+   largest elements seen so far with a scalar merge.
+*/
+static void KFN(merge)(KERNEL_T *c,
+		       const KERNEL_T *a,
+		       size_t a_count,
+		       const KERNEL_T *b,
+		       size_t b_count){
+  int t;
+  size_t i = VLANES, j = VLANES, k = 0;
+  KERNEL_T buf[VLANES];
+  VEC_T lo, hi;
+  if (a_count < VLANES || b_count < VLANES){
+    KFN(merge_scalar)(c, a, a_count, b, b_count);
+    return;
+  }
+  lo = VLOAD(a);
+  hi = VLOAD(b);
+  for (;;){
+    KFN(vmerge)(&lo, &hi);
+    VSTORE(c, lo);
+    c += VLANES;
+    if (j == b_count || (i < a_count && a[i] < b[j])){
+      if (a_count - i < VLANES) break;
+      lo = VLOAD(a + i);
+      i += VLANES;
+    }else{
+      if (b_count - j < VLANES) break;
+      lo = VLOAD(b + j);
+      j += VLANES;
+    }
+  }
+  VSTORE(buf, hi);
+  while (k < VLANES && i < a_count && j < b_count){
+    if (a[i] < b[j]){
+      t = (a[i] < buf[k]);
+      *c++ = t ? a[i] : buf[k];
+      i += t;
+    }else{
+      t = (b[j] < buf[k]);
+      *c++ = t ? b[j] : buf[k];
+      j += t;
+    }
+    k += !t;
+  }
+  if (k < VLANES && i < a_count){
+    KFN(merge_scalar)(c, buf + k, VLANES - k, a + i, a_count - i);
+  }else if (k < VLANES){
+    KFN(merge_scalar)(c, buf + k, VLANES - k, b + j, b_count - j);
+  }else{
+    KFN(merge_scalar)(c, a + i, a_count - i, b + j, b_count - j);
+  }
+}
+
+/**
+   Sorts a range of at most SORT_LEAF_COUNT elements by sorting blocks of
+   SORT_SMALL_COUNT elements with sort_small and merging the sorted blocks
+   in passes between the range and a buffer.
+*/
+static void KFN(sort_leaf)(KERNEL_T *a, size_t count){
+  size_t i, w, n;
+  KERNEL_T buf[SORT_LEAF_COUNT];
+  KERNEL_T *src = a, *dst = buf, *t = NULL;
+  for (i = 0; i < count; i += SORT_SMALL_COUNT){
+    n = (count - i < SORT_SMALL_COUNT) ? count - i : SORT_SMALL_COUNT;
+    if (n > 1) KFN(sort_small)(a + i, n);
+  }
+  for (w = SORT_SMALL_COUNT; w < count; w *= 2){
+    for (i = 0; i < count; i += 2 * w){
+      if (count - i <= w){
+	memcpy(dst + i, src + i, (count - i) * sizeof(KERNEL_T));
+      }else{
+	n = (count - i - w < w) ? count - i - w : w;
+	KFN(merge)(dst + i, src + i, w, src + i + w, n);
+      }
+    }
+    t = src;
+    src = dst;
+    dst = t;
+  }
+  if (src != a) memcpy(a, src, count * sizeof(KERNEL_T));
+}
+
+#else
+
+/**
+   Sorts a range of at most SORT_SMALL_COUNT elements with sorting
+   networks if the count is at most 4, and with insertion sort otherwise.
+*/
+static void KFN(sort_small)(KERNEL_T *a, size_t count){
+  size_t i, j;
+  KERNEL_T x;
+  switch (count){
+  case 2:
+    KFN(cswap)(&a[0], &a[1]);
+    return;
+  case 3:
+    KFN(cswap)(&a[1], &a[2]);
+    KFN(cswap)(&a[0], &a[2]);
+    KFN(cswap)(&a[0], &a[1]);
+    return;
+  case 4:
+    KFN(cswap)(&a[0], &a[1]);
+    KFN(cswap)(&a[2], &a[3]);
+    KFN(cswap)(&a[0], &a[2]);
+    KFN(cswap)(&a[1], &a[3]);
+    KFN(cswap)(&a[1], &a[2]);
+    return;
+  default:
+    break;
+  }
+  for (i = 1; i < count; i++){
+    x = a[i];
+    j = i;
+    while (j > 0 && x < a[j - 1]){
+      a[j] = a[j - 1];
+      j--;
+    }
+    a[j] = x;
+  }
+}
+
+static void KFN(merge)(KERNEL_T *c,
+		       const KERNEL_T *a,
+		       size_t a_count,
+		       const KERNEL_T *b,
+		       size_t b_count){
+  KFN(merge_scalar)(c, a, a_count, b, b_count);
+}
+
+static void KFN(sort_leaf)(KERNEL_T *a, size_t count){
+  KFN(sort_small)(a, count);
+}
+
+#endif
+
+/**
+   Sorts an array with quicksort with a median-of-three pivot and a Hoare
+   partition. The smaller part is sorted recursively and the larger part
+   iteratively. Falls back to qsort if the depth bound is reached.
+*/
+static void KFN(sort_rec)(KERNEL_T *a, size_t count, size_t depth){
+  size_t i, j;
+  KERNEL_T piv, x;
+  while (count > SORT_LEAF_COUNT){
+    if (depth == 0){
+      qsort(a, count, sizeof(KERNEL_T), KFN(cmp));
+      return;
+    }
+    depth--;
+    KFN(cswap)(&a[0], &a[count / 2]);
+    KFN(cswap)(&a[count / 2], &a[count - 1]);
+    KFN(cswap)(&a[0], &a[count / 2]);
+    piv = a[count / 2];
+    i = (size_t)-1; /* wraps to 0 at the first increment */
+    j = count;
+    for (;;){
+      do i++; while (a[i] < piv);
+      do j--; while (piv < a[j]);
+      if (i >= j) break;
+      x = a[i];
+      a[i] = a[j];
+      a[j] = x;
+    }
+    /* [0, j] and [j + 1, count) are each not empty */
+    if (j + 1 < count - j - 1){
+      KFN(sort_rec)(a, j + 1, depth);
+      a += j + 1;
+      count -= j + 1;
+    }else{
+      KFN(sort_rec)(a + j + 1, count - j - 1, depth);
+      count = j + 1;
+    }
+  }
+  if (count > 1) KFN(sort_leaf)(a, count);
+}
+
+static void KFN(sort)(KERNEL_T *a, size_t count){
+  size_t depth = 0, n = count;
+  while (n > 1){
+    depth += 2;
+    n /= 2;
+  }
+  KFN(sort_rec)(a, count, depth);
+}
+
+#undef SORT_SMALL_COUNT
+#undef SORT_LEAF_COUNT
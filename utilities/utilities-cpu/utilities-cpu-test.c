@@ -0,0 +1,578 @@
+/**
+   utilities-cpu-test.c
+
+   Tests of utility functions for the runtime dispatch of vectorized
+   kernels. Each level is forced and the results of its kernels are
+   compared with the results of the portable kernels, including the
+   typed sort and merge kernels on int, long, unsigned long, and double
+   arrays. A level that is not available on the processor or in the build
+   is skipped.
+
+   The following command line arguments can be used to customize tests:
+   utilities-cpu-test
+      [0, # bits in size_t - 1) : n for 2^n max # blocks in correctness tests
+      [0, # bits in size_t - 1) : n for 2^n # blocks in performance tests
+      [0, # bits in size_t) : n for 2^n # repetitions in performance tests
+      [0, 1] : correctness tests on/off
+      [0, 1] : performance tests on/off
+
+   usage examples:
+   ./utilities-cpu-test
+   ./utilities-cpu-test 12
+   ./utilities-cpu-test 10 20 4
+   ./utilities-cpu-test 10 14 10 0 1
+   CPU_LEVEL=avx2 ./utilities-cpu-test
+
+   utilities-cpu-test can be run with any subset of command line arguments in
+   the above-defined order. If the (i + 1)th argument is specified then the
+   ith argument must be specified for i >= 0. Default values are used for the
+   unspecified arguments according to the C_ARGS_DEF array.
+
+   The runtimes are measured with utilities-bench and can be written as
+   csv or json records by setting BENCH_FORMAT and BENCH_OUT, e.g.
+   BENCH_FORMAT=json BENCH_OUT=utilities-cpu.json ./utilities-cpu-test 10 14 10 0 1
+
+   The implementation of tests does not use stdint.h and is portable under
+   C89/C90.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include "utilities-cpu.h"
+#include "utilities-bench.h"
+#include "utilities-mem.h"
+
+/**
+   Generate random numbers in a portable way for test purposes only; rand()
+   in the Linux C Library uses the same generator as random(), which may not
+   be the case on older rand() implementations, and on current
+   implementations on different systems.
+*/
+#ifdef TEST_SEED
+#define RGENS_SEED() do{srand(TEST_SEED);}while (0)
+#else
+#define RGENS_SEED() do{srand(time(NULL));}while (0)
+#endif
+#define RANDOM() (rand()) /* [0, RAND_MAX] */
+#define DRAND() ((double)rand() / RAND_MAX) /* [0.0, 1.0] */
+
+#define TOLU(i) ((unsigned long int)(i)) /* printing size_t under C89/C90 */
+
+/* input handling */
+const char *C_USAGE =
+  "utilities-cpu-test \n"
+  "[0, # bits in size_t - 1) : n for 2^n max # blocks in correctness tests \n"
+  "[0, # bits in size_t - 1) : n for 2^n # blocks in performance tests \n"
+  "[0, # bits in size_t) : n for 2^n # repetitions in performance tests \n"
+  "[0, 1] : correctness tests on/off \n"
+  "[0, 1] : performance tests on/off \n";
+const int C_ARGC_MAX = 6;
+const size_t C_ARGS_DEF[5] = {10, 14, 10, 1, 1};
+
+/* tests */
+const char *C_SUITE = "utilities-cpu-test";
+const size_t C_NUM_WARMUPS = 1;
+const size_t C_FULL_BIT = CHAR_BIT * sizeof(size_t);
+const size_t C_SMALL_COUNT = 40;
+const size_t C_MUL = (size_t)-1 / 0xff * 0x9b; /* odd */
+
+/* typed sort and merge kernels */
+typedef struct{
+  const char *name;
+  size_t elt_size;
+  void (*new_key)(void *, size_t);
+  void (*sort)(const cpu_kernels_t *, void *, size_t);
+  void (*merge)(const cpu_kernels_t *,
+		void *,
+		const void *,
+		size_t,
+		const void *,
+		size_t);
+} type_t;
+
+size_t random_block(size_t range);
+void random_set(size_t *a, size_t n, size_t start, size_t gap);
+int cmp_kernels(const cpu_kernels_t *k,
+		const cpu_kernels_t *p,
+		size_t n,
+		size_t range);
+int cmp_sort_kernels(const cpu_kernels_t *k,
+		     const cpu_kernels_t *p,
+		     const type_t *tp,
+		     size_t n,
+		     size_t range);
+void report(const bench_t *b, const char *label, int level, size_t n);
+void print_test_result(int res);
+
+/**
+   Sets a key from a random block r, with the maximum key of the type if
+   r % 16 is 0, and otherwise with a negative or non-negative key
+   according to the last bit of r. -0.0 is not a key, so that the results
+   of kernels can be compared with memcmp.
+*/
+
+void new_int(void *a, size_t r){
+  if (r % 16 == 0){
+    *(int *)a = INT_MAX;
+  }else{
+    *(int *)a = (int)(r / 2 % INT_MAX);
+    if (r & 1) *(int *)a = -1 - *(int *)a;
+  }
+}
+
+void new_long(void *a, size_t r){
+  if (r % 16 == 0){
+    *(long *)a = LONG_MAX;
+  }else{
+    *(long *)a = (long)(r / 2 % LONG_MAX);
+    if (r & 1) *(long *)a = -1 - *(long *)a;
+  }
+}
+
+void new_ulong(void *a, size_t r){
+  *(unsigned long *)a = (r % 16 == 0) ? ULONG_MAX : (unsigned long)r;
+}
+
+void new_double(void *a, size_t r){
+  *(double *)a = (double)(r / 2) / (r % 16 + 1);
+  if (r & 1) *(double *)a = -1.0 - *(double *)a;
+}
+
+/**
+   Calls the typed kernels of a table.
+*/
+
+void sort_int(const cpu_kernels_t *k, void *a, size_t n){
+  k->sort_int(a, n);
+}
+
+void sort_long(const cpu_kernels_t *k, void *a, size_t n){
+  k->sort_long(a, n);
+}
+
+void sort_ulong(const cpu_kernels_t *k, void *a, size_t n){
+  k->sort_ulong(a, n);
+}
+
+void sort_double(const cpu_kernels_t *k, void *a, size_t n){
+  k->sort_double(a, n);
+}
+
+void merge_int(const cpu_kernels_t *k,
+	       void *c,
+	       const void *a,
+	       size_t a_count,
+	       const void *b,
+	       size_t b_count){
+  k->merge_int(c, a, a_count, b, b_count);
+}
+
+void merge_long(const cpu_kernels_t *k,
+		void *c,
+		const void *a,
+		size_t a_count,
+		const void *b,
+		size_t b_count){
+  k->merge_long(c, a, a_count, b, b_count);
+}
+
+void merge_ulong(const cpu_kernels_t *k,
+		 void *c,
+		 const void *a,
+		 size_t a_count,
+		 const void *b,
+		 size_t b_count){
+  k->merge_ulong(c, a, a_count, b, b_count);
+}
+
+void merge_double(const cpu_kernels_t *k,
+		  void *c,
+		  const void *a,
+		  size_t a_count,
+		  const void *b,
+		  size_t b_count){
+  k->merge_double(c, a, a_count, b, b_count);
+}
+
+const type_t C_TYPES[4] = {
+  {"int", sizeof(int), new_int, sort_int, merge_int},
+  {"long", sizeof(long), new_long, sort_long, merge_long},
+  {"unsigned long", sizeof(unsigned long), new_ulong, sort_ulong, merge_ulong},
+  {"double", sizeof(double), new_double, sort_double, merge_double}};
+const size_t C_NUM_TYPES = 4;
+
+/**
+   Returns a random block in [0, range) if range > 0, or a random block
+   in [0, 2^k) where k is the number of bits in size_t.
+*/
+size_t random_block(size_t range){
+  size_t i, r = 0;
+  for (i = 0; i < sizeof(size_t); i++){
+    r = (r << CHAR_BIT) | (RANDOM() & (unsigned char)-1);
+  }
+  return (range > 0) ? r % range : r;
+}
+
+/**
+   Sets a to a random set of n elements in ascending order without
+   duplicates, where the first element is start and consecutive elements
+   differ by at most gap.
+*/
+void random_set(size_t *a, size_t n, size_t start, size_t gap){
+  size_t i;
+  if (n == 0) return;
+  a[0] = start;
+  for (i = 1; i < n; i++){
+    a[i] = a[i - 1] + 1 + random_block(gap);
+  }
+}
+
+/**
+   Compares the kernels of a table with the portable kernels on arrays
+   of n blocks. The blocks are drawn from [0, range) if range > 0, which
+   results in repeated minima, or from the full range of size_t. The
+   intersection is compared on random sets of n and up to n elements.
+*/
+int cmp_kernels(const cpu_kernels_t *k,
+		const cpu_kernels_t *p,
+		size_t n,
+		size_t range){
+  int res = 1;
+  size_t i, m, log_count;
+  size_t *a = NULL, *b = NULL, *c = NULL, *d = NULL;
+  a = malloc_perror(n + 1, sizeof(size_t));
+  b = malloc_perror(n + 1, sizeof(size_t));
+  c = malloc_perror(n + 1, sizeof(size_t));
+  d = malloc_perror(n + 1, sizeof(size_t));
+  for (i = 0; i < n; i++){
+    a[i] = random_block(range);
+    b[i] = random_block(range);
+  }
+  res *= (k->min_ix(a, n) == p->min_ix(a, n));
+  res *= (k->bitset_count(a, n) == p->bitset_count(a, n));
+  memcpy(c, a, n * sizeof(size_t));
+  memcpy(d, a, n * sizeof(size_t));
+  c[n] = d[n] = 1;
+  k->bitset_or(c, b, n);
+  p->bitset_or(d, b, n);
+  res *= (memcmp(c, d, (n + 1) * sizeof(size_t)) == 0);
+  memcpy(c, a, n * sizeof(size_t));
+  memcpy(d, a, n * sizeof(size_t));
+  k->bitset_and(c, b, n);
+  p->bitset_and(d, b, n);
+  res *= (memcmp(c, d, (n + 1) * sizeof(size_t)) == 0);
+  for (log_count = 1; log_count <= C_FULL_BIT; log_count += 7){
+    k->hash_mul(c, a, n, C_MUL, log_count);
+    p->hash_mul(d, a, n, C_MUL, log_count);
+    res *= (memcmp(c, d, (n + 1) * sizeof(size_t)) == 0);
+  }
+  i = random_block(0) >> 1;
+  random_set(a, n, i, 4);
+  random_set(b, n, i, 4);
+  for (m = 0; m <= n; m += 1 + n / 8){
+    res *= (k->isect(NULL, a, n, b, m) == p->isect(NULL, a, n, b, m));
+    res *= (k->isect(c, b, m, a, n) == p->isect(d, b, m, a, n));
+    res *= (memcmp(c, d, (n + 1) * sizeof(size_t)) == 0);
+  }
+  free(a);
+  free(b);
+  free(c);
+  free(d);
+  a = NULL;
+  b = NULL;
+  c = NULL;
+  d = NULL;
+  return res;
+}
+
+/**
+   Compares the sort and merge kernels of a type in a table with the
+   portable kernels on a random array of n keys, and on merges of n and
+   up to n keys. The keys are drawn from random blocks in [0, range) if
+   range > 0, which results in repeated keys, or from the full range of
+   size_t.
+*/
+int cmp_sort_kernels(const cpu_kernels_t *k,
+		     const cpu_kernels_t *p,
+		     const type_t *tp,
+		     size_t n,
+		     size_t range){
+  int res = 1;
+  size_t i, m;
+  size_t elt_size = tp->elt_size;
+  char *a = NULL, *b = NULL, *c = NULL, *d = NULL;
+  a = malloc_perror(2 * n + 1, elt_size);
+  b = malloc_perror(2 * n + 1, elt_size);
+  c = malloc_perror(2 * n + 1, elt_size);
+  d = malloc_perror(2 * n + 1, elt_size);
+  for (i = 0; i < 2 * n; i++){
+    tp->new_key(a + i * elt_size, random_block(range));
+  }
+  memcpy(b, a, 2 * n * elt_size);
+  tp->sort(k, a, n);
+  tp->sort(p, b, n);
+  res *= (memcmp(a, b, n * elt_size) == 0);
+  res *= (memcmp(a + n * elt_size, b + n * elt_size, n * elt_size) == 0);
+  for (m = 0; m <= n; m += 1 + n / 8){
+    memcpy(b, a + n * elt_size, m * elt_size);
+    tp->sort(p, b, m);
+    memset(c, 0, (2 * n + 1) * elt_size);
+    memset(d, 0, (2 * n + 1) * elt_size);
+    tp->merge(k, c, a, n, b, m);
+    tp->merge(p, d, a, n, b, m);
+    res *= (memcmp(c, d, (2 * n + 1) * elt_size) == 0);
+    tp->merge(k, c, b, m, a, n);
+    res *= (memcmp(c, d, (2 * n + 1) * elt_size) == 0);
+  }
+  free(a);
+  free(b);
+  free(c);
+  free(d);
+  a = NULL;
+  b = NULL;
+  c = NULL;
+  d = NULL;
+  return res;
+}
+
+/**
+   Forces each level and compares its kernels with the portable kernels
+   on arrays of all lengths up to C_SMALL_COUNT, and of random lengths up
+   to 2^log_n.
+*/
+void run_kernel_test(size_t log_n){
+  int res = 1;
+  int level;
+  size_t i, n, ti;
+  size_t n_max = (size_t)1 << log_n;
+  cpu_kernels_t p;
+  const cpu_kernels_t *k = NULL;
+  p = *cpu_force(CPU_LEVEL_PORTABLE);
+  printf("Run kernel test, detected level: %s\n",
+	 cpu_level_name(cpu_detect()));
+  for (level = 0; level < CPU_LEVEL_COUNT; level++){
+    k = cpu_force((cpu_level_t)level);
+    if (k == NULL){
+      printf("\t%s: not available, skipped\n",
+	     cpu_level_name((cpu_level_t)level));
+      continue;
+    }
+    res = (k->level == (cpu_level_t)level);
+    for (n = 0; n <= C_SMALL_COUNT; n++){
+      res *= cmp_kernels(k, &p, n, 0);
+      res *= cmp_kernels(k, &p, n, 4);
+      for (ti = 0; ti < C_NUM_TYPES; ti++){
+	res *= cmp_sort_kernels(k, &p, &C_TYPES[ti], n, 0);
+	res *= cmp_sort_kernels(k, &p, &C_TYPES[ti], n, 4);
+      }
+    }
+    for (i = 0; i < C_SMALL_COUNT; i++){
+      n = DRAND() * n_max;
+      res *= cmp_kernels(k, &p, n, 0);
+      res *= cmp_kernels(k, &p, n, n + 1);
+      for (ti = 0; ti < C_NUM_TYPES; ti++){
+	res *= cmp_sort_kernels(k, &p, &C_TYPES[ti], n, 0);
+	res *= cmp_sort_kernels(k, &p, &C_TYPES[ti], n, n + 1);
+      }
+    }
+    printf("\t%s, up to %lu blocks --> ",
+	   cpu_level_name((cpu_level_t)level), TOLU(n_max));
+    print_test_result(res);
+  }
+}
+
+/**
+   Runs the kernels of each available level on arrays of 2^log_n blocks
+   2^log_reps times after a warmup call and prints the median times. The
+   sort kernels are run on copies of random int and double arrays of
+   2^log_n keys max(1, 2^(log_reps - 4)) times, and the merge kernels on
+   two sorted arrays of 2^log_n keys each 2^log_reps times.
+*/
+void run_kernel_perf_test(size_t log_n, size_t log_reps){
+  int level;
+  size_t i, s = 0;
+  size_t n = (size_t)1 << log_n;
+  size_t reps = (size_t)1 << log_reps;
+  size_t sort_reps = (log_reps < 4) ? 1 : reps >> 4;
+  size_t *a = NULL, *b = NULL;
+  int *ia = NULL, *ib = NULL;
+  double *da = NULL, *db = NULL;
+  bench_t bt;
+  const cpu_kernels_t *k = NULL;
+  a = malloc_perror(n, sizeof(size_t));
+  b = malloc_perror(n, sizeof(size_t));
+  ia = malloc_perror(4 * n, sizeof(int));
+  ib = malloc_perror(2 * n, sizeof(int));
+  da = malloc_perror(4 * n, sizeof(double));
+  db = malloc_perror(2 * n, sizeof(double));
+  for (i = 0; i < n; i++){
+    a[i] = random_block(0);
+    b[i] = random_block(0);
+  }
+  for (i = 0; i < 2 * n; i++){
+    new_int(&ia[i], random_block(0));
+    new_double(&da[i], random_block(0));
+  }
+  cpu_force(CPU_LEVEL_PORTABLE)->sort_int(ia + n, n);
+  cpu_force(CPU_LEVEL_PORTABLE)->sort_double(da + n, n);
+  printf("Run kernel performance test, %lu blocks, %lu repetitions\n",
+	 TOLU(n), TOLU(reps));
+  for (level = 0; level < CPU_LEVEL_COUNT; level++){
+    k = cpu_force((cpu_level_t)level);
+    if (k == NULL) continue;
+    printf("\t%s\n", cpu_level_name((cpu_level_t)level));
+    bench_init(&bt, C_SUITE, "min_ix", C_NUM_WARMUPS, reps);
+    for (i = 0; i < C_NUM_WARMUPS + reps; i++){
+      bench_start(&bt);
+      s += k->min_ix(a, n);
+      bench_stop(&bt);
+    }
+    report(&bt, "\t\tmin_ix:         ", level, n);
+    bench_free(&bt);
+    bench_init(&bt, C_SUITE, "bitset_count", C_NUM_WARMUPS, reps);
+    for (i = 0; i < C_NUM_WARMUPS + reps; i++){
+      bench_start(&bt);
+      s += k->bitset_count(a, n);
+      bench_stop(&bt);
+    }
+    report(&bt, "\t\tbitset_count:   ", level, n);
+    bench_free(&bt);
+    bench_init(&bt, C_SUITE, "bitset_or", C_NUM_WARMUPS, reps);
+    for (i = 0; i < C_NUM_WARMUPS + reps; i++){
+      bench_start(&bt);
+      k->bitset_or(b, a, n);
+      bench_stop(&bt);
+    }
+    report(&bt, "\t\tbitset_or:      ", level, n);
+    bench_free(&bt);
+    bench_init(&bt, C_SUITE, "hash_mul", C_NUM_WARMUPS, reps);
+    for (i = 0; i < C_NUM_WARMUPS + reps; i++){
+      bench_start(&bt);
+      k->hash_mul(b, a, n, C_MUL, 10);
+      bench_stop(&bt);
+    }
+    report(&bt, "\t\thash_mul:       ", level, n);
+    bench_free(&bt);
+    random_set(a, n, 0, 4);
+    random_set(b, n, 0, 4);
+    bench_init(&bt, C_SUITE, "isect", C_NUM_WARMUPS, reps);
+    for (i = 0; i < C_NUM_WARMUPS + reps; i++){
+      bench_start(&bt);
+      s += k->isect(NULL, a, n, b, n);
+      bench_stop(&bt);
+    }
+    report(&bt, "\t\tisect:          ", level, n);
+    bench_free(&bt);
+    bench_init(&bt, C_SUITE, "sort_int", C_NUM_WARMUPS, sort_reps);
+    for (i = 0; i < C_NUM_WARMUPS + sort_reps; i++){
+      memcpy(ib, ia, n * sizeof(int));
+      bench_start(&bt);
+      k->sort_int(ib, n);
+      bench_stop(&bt);
+    }
+    report(&bt, "\t\tsort_int:       ", level, n);
+    bench_free(&bt);
+    bench_init(&bt, C_SUITE, "merge_int", C_NUM_WARMUPS, reps);
+    for (i = 0; i < C_NUM_WARMUPS + reps; i++){
+      bench_start(&bt);
+      k->merge_int(ia + 2 * n, ib, n, ia + n, n);
+      bench_stop(&bt);
+    }
+    report(&bt, "\t\tmerge_int:      ", level, n);
+    bench_free(&bt);
+    bench_init(&bt, C_SUITE, "sort_double", C_NUM_WARMUPS, sort_reps);
+    for (i = 0; i < C_NUM_WARMUPS + sort_reps; i++){
+      memcpy(db, da, n * sizeof(double));
+      bench_start(&bt);
+      k->sort_double(db, n);
+      bench_stop(&bt);
+    }
+    report(&bt, "\t\tsort_double:    ", level, n);
+    bench_free(&bt);
+    bench_init(&bt, C_SUITE, "merge_double", C_NUM_WARMUPS, reps);
+    for (i = 0; i < C_NUM_WARMUPS + reps; i++){
+      bench_start(&bt);
+      k->merge_double(da + 2 * n, db, n, da + n, n);
+      bench_stop(&bt);
+    }
+    report(&bt, "\t\tmerge_double:   ", level, n);
+    bench_free(&bt);
+  }
+  printf("\t(checksum %lu)\n",
+	 TOLU(s + b[0] + (size_t)ia[3 * n] + (size_t)da[3 * n]));
+  free(a);
+  free(b);
+  free(ia);
+  free(ib);
+  free(da);
+  free(db);
+  a = NULL;
+  b = NULL;
+  ia = NULL;
+  ib = NULL;
+  da = NULL;
+  db = NULL;
+}
+
+/**
+   Prints the level of cpu_init, according to CPU_LEVEL if it is set.
+*/
+void run_init_test(void){
+  const cpu_kernels_t *k = cpu_init();
+  printf("Run cpu_init test --> %s\n", cpu_level_name(k->level));
+}
+
+/**
+   Reports a benchmark with the level and the number of blocks or keys.
+*/
+void report(const bench_t *b, const char *label, int level, size_t n){
+  char params[64];
+  sprintf(params,
+	  "level=%s n=%lu",
+	  cpu_level_name((cpu_level_t)level),
+	  TOLU(n));
+  bench_report(b, label, params);
+}
+
+/**
+   Prints a test result.
+*/
+void print_test_result(int res){
+  if (res){
+    printf("SUCCESS\n");
+  }else{
+    printf("FAILURE\n");
+  }
+}
+
+int main(int argc, char *argv[]){
+  int i;
+  size_t *args = NULL;
+  RGENS_SEED();
+  if (argc > C_ARGC_MAX){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  args = malloc_perror(C_ARGC_MAX - 1, sizeof(size_t));
+  memcpy(args, C_ARGS_DEF, (C_ARGC_MAX - 1) * sizeof(size_t));
+  for (i = 1; i < argc; i++){
+    args[i - 1] = atoi(argv[i]);
+  }
+  if (args[0] > C_FULL_BIT - 2 ||
+      args[1] > C_FULL_BIT - 2 ||
+      args[2] > C_FULL_BIT - 1 ||
+      args[3] > 1 ||
+      args[4] > 1){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  run_init_test();
+  if (args[3]) run_kernel_test(args[0]);
+  if (args[4]) run_kernel_perf_test(args[1], args[2]);
+  free(args);
+  args = NULL;
+  return 0;
+}
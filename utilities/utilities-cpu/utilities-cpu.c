@@ -0,0 +1,256 @@
+/**
+   utilities-cpu.c
+
+   Utility functions for the runtime dispatch of vectorized kernels
+   according to the features of the processor, and the portable kernels.
+
+   The typed sort and merge kernels of each level are generated from
+   utilities-cpu-sort-impl.h.
+
+   On x86 systems with GCC or Clang, the features are detected with
+   __builtin_cpu_supports, which executes CPUID and checks that the
+   operating system saves the vector registers. The implementation is
+   otherwise portable under C89/C90, and only the portable level is
+   available.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "utilities-cpu.h"
+
+#define KFN_CAT(f, name) f##_##name
+#define KFN_EXP(f, name) KFN_CAT(f, name)
+#define KFN(f) KFN_EXP(f, KERNEL_NAME)
+
+#if (defined(__GNUC__) || defined(__clang__)) &&	\
+  (defined(__x86_64__) || defined(__i386__))
+#define UTILITIES_CPU_X86
+#endif
+
+static const char *C_LEVEL_NAMES[CPU_LEVEL_COUNT] = {"portable",
+						     "avx2",
+						     "avx512"};
+static const size_t C_FULL_BIT = CHAR_BIT * sizeof(size_t);
+
+static int is_init = 0;
+static cpu_kernels_t kernels;
+
+static void set_level(cpu_level_t level);
+static cpu_level_t env_level(cpu_level_t level);
+static int avx512_popcnt(void);
+
+/* portable kernels */
+static size_t min_ix(const size_t *a, size_t n);
+static size_t bitset_count(const size_t *a, size_t n);
+static void bitset_or(size_t *dst, const size_t *src, size_t n);
+static void bitset_and(size_t *dst, const size_t *src, size_t n);
+static void hash_mul(size_t *h,
+		     const size_t *keys,
+		     size_t n,
+		     size_t mul,
+		     size_t log_count);
+static size_t isect(size_t *out,
+		    const size_t *a,
+		    size_t a_count,
+		    const size_t *b,
+		    size_t b_count);
+
+#define KERNEL_T int
+#define KERNEL_NAME int
+#include "utilities-cpu-sort-impl.h"
+#undef KERNEL_T
+#undef KERNEL_NAME
+
+#define KERNEL_T long
+#define KERNEL_NAME long
+#include "utilities-cpu-sort-impl.h"
+#undef KERNEL_T
+#undef KERNEL_NAME
+
+#define KERNEL_T unsigned long
+#define KERNEL_NAME ulong
+#include "utilities-cpu-sort-impl.h"
+#undef KERNEL_T
+#undef KERNEL_NAME
+
+#define KERNEL_T double
+#define KERNEL_NAME double
+#include "utilities-cpu-sort-impl.h"
+#undef KERNEL_T
+#undef KERNEL_NAME
+
+/**
+   Returns the available level, without reading CPU_LEVEL.
+*/
+cpu_level_t cpu_detect(void){
+  cpu_level_t level = CPU_LEVEL_PORTABLE;
+#ifdef UTILITIES_CPU_X86
+  cpu_kernels_t k;
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2") && cpu_avx2_kernels(&k)){
+    level = CPU_LEVEL_AVX2;
+  }
+  if (level == CPU_LEVEL_AVX2 &&
+      __builtin_cpu_supports("avx512f") &&
+      __builtin_cpu_supports("avx512dq") &&
+      cpu_avx512_kernels(&k)){
+    level = CPU_LEVEL_AVX512;
+  }
+#endif
+  return level;
+}
+
+/**
+   Resolves the kernel table at the first call and returns a pointer to the
+   table.
+*/
+const cpu_kernels_t *cpu_init(void){
+  if (!is_init) set_level(env_level(cpu_detect()));
+  return &kernels;
+}
+
+/**
+   Resolves the kernel table of a level if the level is available.
+*/
+const cpu_kernels_t *cpu_force(cpu_level_t level){
+  if (level >= CPU_LEVEL_COUNT || level > cpu_detect()) return NULL;
+  set_level(level);
+  return &kernels;
+}
+
+/**
+   Returns the name of a level.
+*/
+const char *cpu_level_name(cpu_level_t level){
+  return C_LEVEL_NAMES[level];
+}
+
+/**
+   Sets the kernels of an available level. The kernels of a level replace
+   the kernels of the lower levels. The AVX-512 popcount kernels are set
+   only if the processor supports VPOPCNTDQ.
+*/
+static void set_level(cpu_level_t level){
+  kernels.level = level;
+  kernels.min_ix = min_ix;
+  kernels.bitset_count = bitset_count;
+  kernels.bitset_or = bitset_or;
+  kernels.bitset_and = bitset_and;
+  kernels.hash_mul = hash_mul;
+  kernels.isect = isect;
+  kernels.sort_int = sort_int;
+  kernels.sort_long = sort_long;
+  kernels.sort_ulong = sort_ulong;
+  kernels.sort_double = sort_double;
+  kernels.merge_int = merge_int;
+  kernels.merge_long = merge_long;
+  kernels.merge_ulong = merge_ulong;
+  kernels.merge_double = merge_double;
+  if (level >= CPU_LEVEL_AVX2) cpu_avx2_kernels(&kernels);
+  if (level >= CPU_LEVEL_AVX512) cpu_avx512_kernels(&kernels);
+  if (level >= CPU_LEVEL_AVX512 && avx512_popcnt()){
+    cpu_avx512_popcnt_kernels(&kernels);
+  }
+  is_init = 1;
+}
+
+/**
+   Returns 1 if the processor supports the VPOPCNTDQ extension of
+   AVX-512, and otherwise returns 0.
+*/
+static int avx512_popcnt(void){
+#ifdef UTILITIES_CPU_X86
+  __builtin_cpu_init();
+  return (__builtin_cpu_supports("avx512vpopcntdq") != 0);
+#else
+  return 0;
+#endif
+}
+
+/**
+   Returns the lower of a level and the level given by CPU_LEVEL, if set.
+*/
+static cpu_level_t env_level(cpu_level_t level){
+  int i;
+  const char *s = getenv("CPU_LEVEL");
+  if (s == NULL) return level;
+  for (i = 0; i < CPU_LEVEL_COUNT; i++){
+    if (strcmp(s, C_LEVEL_NAMES[i]) == 0){
+      return ((cpu_level_t)i < level) ? (cpu_level_t)i : level;
+    }
+  }
+  fprintf(stderr, "CPU_LEVEL=%s is not a level, ignored\n", s);
+  return level;
+}
+
+/**
+   Portable kernels.
+*/
+
+static size_t min_ix(const size_t *a, size_t n){
+  size_t i, ix = 0;
+  if (n == 0) return 0;
+  for (i = 1; i < n; i++){
+    if (a[i] < a[ix]) ix = i;
+  }
+  return ix;
+}
+
+static size_t bitset_count(const size_t *a, size_t n){
+  size_t i, b, c = 0;
+  for (i = 0; i < n; i++){
+    for (b = a[i]; b; b &= b - 1){
+      c++;
+    }
+  }
+  return c;
+}
+
+static void bitset_or(size_t *dst, const size_t *src, size_t n){
+  size_t i;
+  for (i = 0; i < n; i++){
+    dst[i] |= src[i];
+  }
+}
+
+static void bitset_and(size_t *dst, const size_t *src, size_t n){
+  size_t i;
+  for (i = 0; i < n; i++){
+    dst[i] &= src[i];
+  }
+}
+
+static void hash_mul(size_t *h,
+		     const size_t *keys,
+		     size_t n,
+		     size_t mul,
+		     size_t log_count){
+  size_t i;
+  size_t shift = C_FULL_BIT - log_count;
+  for (i = 0; i < n; i++){
+    h[i] = (keys[i] * mul) >> shift;
+  }
+}
+
+static size_t isect(size_t *out,
+		    const size_t *a,
+		    size_t a_count,
+		    const size_t *b,
+		    size_t b_count){
+  size_t i = 0, j = 0, c = 0;
+  while (i < a_count && j < b_count){
+    if (a[i] < b[j]){
+      i++;
+    }else if (b[j] < a[i]){
+      j++;
+    }else{
+      if (out != NULL) out[c] = a[i];
+      c++;
+      i++;
+      j++;
+    }
+  }
+  return c;
+}
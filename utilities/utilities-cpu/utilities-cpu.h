@@ -0,0 +1,143 @@
+/**
+   utilities-cpu.h
+
+   Declarations of accessible utility functions for the runtime dispatch
+   of vectorized kernels according to the features of the processor.
+
+   A kernel table contains function pointers to the kernels of one level:
+   portable kernels, kernels for AVX2, and kernels for AVX-512 with the F
+   and DQ extensions. The AVX-512 popcount kernels additionally require
+   the VPOPCNTDQ extension, and the AVX-512 level uses the AVX2 popcount
+   kernels on processors without it, e.g. Skylake-X and Cascade Lake. The
+   portable kernels are compiled with the flags of a build and are
+   portable under C89/C90. The kernels of a level above CPU_LEVEL_PORTABLE
+   are in separate files that are compiled with the target-specific flags
+   of the level, e.g. -mavx2, and contain the kernels only if the compiler
+   targets the level on an x86-64 system; otherwise the level is not
+   available in the build. A build without target-specific flags
+   therefore contains only the portable kernels, and all levels can be in
+   the same binary.
+
+   The available level is the highest level that is contained in the
+   build and is supported by the processor and the operating system, as
+   detected with CPUID by the compiler runtime on x86 systems with GCC or
+   Clang. If the CPU_LEVEL environment variable is set to "portable",
+   "avx2", or "avx512", the level of cpu_init is at most the given level.
+   The table is resolved once at the first call of cpu_init, which is not
+   thread-safe and is expected to precede the creation of threads that use
+   the kernels.
+
+   The kernels operate on arrays of size_t, where bitsets are arrays of
+   size_t blocks and sets are arrays in ascending order without
+   duplicates, and compute the same results at each level. The typed sort
+   and merge kernels operate on arrays of int, long, unsigned long, and
+   double, which correspond to 32-bit and 64-bit keys on common LP64
+   platforms, order the keys by the < operator of the type, and compute
+   the same results at each level up to the order of keys that are not
+   less than each other, e.g. -0.0 and 0.0. The vectorized sort kernels
+   sort small ranges with sorting networks in registers, and the
+   vectorized merge kernels merge a vector of elements at a time with a
+   bitonic merging network. On platforms where long is not a 64-bit type,
+   the long and unsigned long kernels are portable at each level.
+*/
+
+#ifndef UTILITIES_CPU_H
+#define UTILITIES_CPU_H
+
+#include <stdlib.h>
+
+typedef enum{
+  CPU_LEVEL_PORTABLE,
+  CPU_LEVEL_AVX2,
+  CPU_LEVEL_AVX512,
+  CPU_LEVEL_COUNT
+} cpu_level_t;
+
+typedef struct{
+  cpu_level_t level;
+  /* index of the first minimum of a[0..n - 1], 0 if n is 0 */
+  size_t (*min_ix)(const size_t *a, size_t n);
+  /* number of set bits in the bitset a of n blocks */
+  size_t (*bitset_count)(const size_t *a, size_t n);
+  /* dst = dst | src and dst = dst & src for bitsets of n blocks */
+  void (*bitset_or)(size_t *dst, const size_t *src, size_t n);
+  void (*bitset_and)(size_t *dst, const size_t *src, size_t n);
+  /* h[i] = (keys[i] * mul mod 2^k) >> (k - log_count), where k is the
+     number of bits in size_t and 0 < log_count <= k */
+  void (*hash_mul)(size_t *h,
+		   const size_t *keys,
+		   size_t n,
+		   size_t mul,
+		   size_t log_count);
+  /* count of the intersection of the sets a and b, which are in ascending
+     order without duplicates; if out is not NULL, the intersection is
+     copied to out in ascending order */
+  size_t (*isect)(size_t *out,
+		  const size_t *a,
+		  size_t a_count,
+		  const size_t *b,
+		  size_t b_count);
+  /* sorts n keys in ascending order */
+  void (*sort_int)(int *a, size_t n);
+  void (*sort_long)(long *a, size_t n);
+  void (*sort_ulong)(unsigned long *a, size_t n);
+  void (*sort_double)(double *a, size_t n);
+  /* merges the sorted arrays a and b onto c in ascending order, where c
+     does not overlap a or b */
+  void (*merge_int)(int *c,
+		    const int *a,
+		    size_t a_count,
+		    const int *b,
+		    size_t b_count);
+  void (*merge_long)(long *c,
+		     const long *a,
+		     size_t a_count,
+		     const long *b,
+		     size_t b_count);
+  void (*merge_ulong)(unsigned long *c,
+		      const unsigned long *a,
+		      size_t a_count,
+		      const unsigned long *b,
+		      size_t b_count);
+  void (*merge_double)(double *c,
+		       const double *a,
+		       size_t a_count,
+		       const double *b,
+		       size_t b_count);
+} cpu_kernels_t;
+
+/**
+   Returns the available level, without reading CPU_LEVEL.
+*/
+cpu_level_t cpu_detect(void);
+
+/**
+   Resolves the kernel table at the first call and returns a pointer to the
+   table. The table is of the available level, or of the level given by
+   CPU_LEVEL if it is lower.
+*/
+const cpu_kernels_t *cpu_init(void);
+
+/**
+   Resolves the kernel table of a level and returns a pointer to the
+   table, or returns NULL if the level is above the available level, in
+   which case the table is not changed. The following calls of cpu_init
+   return the table of the forced level.
+*/
+const cpu_kernels_t *cpu_force(cpu_level_t level);
+
+/**
+   Returns the name of a level, e.g. "avx2".
+*/
+const char *cpu_level_name(cpu_level_t level);
+
+/**
+   Sets the kernels of a level in a table and returns 1 if the kernels are
+   contained in the build, and otherwise returns 0 and does not change the
+   table. Each function is defined in the kernel file of its level.
+*/
+int cpu_avx2_kernels(cpu_kernels_t *k);
+int cpu_avx512_kernels(cpu_kernels_t *k);
+int cpu_avx512_popcnt_kernels(cpu_kernels_t *k);
+
+#endif
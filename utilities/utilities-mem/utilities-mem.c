@@ -2,13 +2,116 @@
    utilities-mem.c
 
    Utility functions for memory management.
+
+   An aligned block is preceded by a header with the information required
+   to free the block. On Linux, unless UTILITIES_MEM_PORTABLE is defined, a
+   huge page block is first requested with mmap and MAP_HUGETLB if enough
+   huge pages are free according to /proc/meminfo, e.g. after a reservation
+   by /proc/sys/vm/nr_hugepages, and if rounding the block up to a multiple
+   of the default huge page size wastes at most 1/C_HUGETLB_WASTE_DIV of the
+   block. The length of the mapping is recorded in the header for munmap.
+   Otherwise, if transparent huge pages are enabled in madvise or always
+   mode, the block is allocated with an alignment of C_HUGE_PAGE_SIZE and
+   advised with MADV_HUGEPAGE. Otherwise the block is aligned to a cache
+   line. The implementation is otherwise portable under C89/C90.
+
+   If UTILITIES_MEM_ACCOUNT is defined, a block of malloc_perror_tag,
+   realloc_perror_tag, and calloc_perror_tag is preceded by an acct_hdr_t
+   header with the size and tag of the block, and the header of an aligned
+   block includes the size and tag of the block. The statistics of each tag
+   and the totals are updated at each allocation, reallocation, and free.
 */
 
+#if defined(__linux__) && !defined(UTILITIES_MEM_PORTABLE)
+#define _DEFAULT_SOURCE
+#define UTILITIES_MEM_MMAP
+#include <sys/mman.h>
+#endif
+
+#define UTILITIES_MEM_C /* no replacement of allocation functions */
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "utilities-mem.h"
 
+typedef struct{
+  void *base; /* pointer returned by malloc, calloc, or mmap */
+  size_t len; /* length of a mapping, 0 if not mapped */
+  size_t size; /* size of the block in bytes */
+  size_t align; /* alignment of the block in bytes */
+  mem_tag_t tag;
+} hdr_t;
+
+#ifdef UTILITIES_MEM_ACCOUNT
+
+typedef union{
+  struct{
+    size_t size;
+    mem_tag_t tag;
+  } s;
+  long double ld; /* alignment of the block after the header */
+  double d;
+  long l;
+  void *p;
+} acct_hdr_t;
+
+#if defined(__GNUC__)
+#define ACCT_ADD(p, v) __sync_add_and_fetch((p), (v))
+#define ACCT_SUB(p, v) __sync_sub_and_fetch((p), (v))
+#define ACCT_CAS(p, old, new) __sync_bool_compare_and_swap((p), (old), (new))
+#else
+#define ACCT_ADD(p, v) (*(p) += (v))
+#define ACCT_SUB(p, v) (*(p) -= (v))
+#define ACCT_CAS(p, old, new) (*(p) = (new), 1)
+#endif
+
+#define ACCT_ALLOC(tag, n) acct_alloc((tag), (n))
+#define ACCT_FREE(tag, n) acct_free((tag), (n))
+
+static mem_stats_t acct_stats[MEM_TAG_COUNT];
+static size_t acct_cur_bytes = 0;
+static size_t acct_peak_bytes = 0;
+
+static void acct_alloc(mem_tag_t tag, size_t n);
+static void acct_realloc(mem_tag_t tag, size_t prev_n, size_t n);
+static void acct_free(mem_tag_t tag, size_t n);
+static void acct_peak(size_t *peak, size_t cur);
+static size_t hist_ix(size_t n);
+
+#else
+
+#define ACCT_ALLOC(tag, n) ((void)0)
+#define ACCT_FREE(tag, n) ((void)0)
+
+#endif
+
 static const size_t C_SIZE_MAX = (size_t)-1;
+static const size_t C_CACHE_LINE_SIZE = 64;
+static const size_t C_HUGE_PAGE_SIZE = 2097152; /* 2MB */
+#ifdef UTILITIES_MEM_MMAP
+static const size_t C_HUGETLB_WASTE_DIV = 8;
+#endif
+
+static void *aligned_alloc_perror(size_t num,
+				  size_t size,
+				  size_t align,
+				  int zero,
+				  mem_tag_t tag);
+static void *huge_alloc_perror(size_t num,
+			       size_t size,
+			       int zero,
+			       mem_tag_t tag);
+static void *hdr_set(void *base,
+		     size_t len,
+		     size_t align,
+		     size_t size,
+		     mem_tag_t tag);
+static size_t alloc_overhead(size_t size);
+#ifdef UTILITIES_MEM_MMAP
+static size_t hugetlb_page_size(size_t *num_free);
+static int thp_madvise_eligible(void);
+#endif
 
 /**
    size_t addition and multiplication with wrapped overflow checking.
@@ -78,3 +181,465 @@ void *calloc_perror(size_t num, size_t size){
   }
   return ptr;
 }
+
+/**
+   Allocates a block of num * size bytes aligned to align bytes, with
+   wrapped error checking. The block is set to zero by aligned_calloc_perror.
+   A block allocated by the functions of this section is only freed with
+   aligned_free.
+*/
+
+void *aligned_malloc_perror(size_t num, size_t size, size_t align){
+  return aligned_alloc_perror(num, size, align, 0, MEM_TAG_OTHER);
+}
+
+void *aligned_calloc_perror(size_t num, size_t size, size_t align){
+  return aligned_alloc_perror(num, size, align, 1, MEM_TAG_OTHER);
+}
+
+/**
+   Allocates a block of num * size bytes for a large array that is
+   accessed at random, with wrapped error checking. If the block is at
+   least C_HUGE_PAGE_SIZE, it is backed by huge pages where available, and
+   is aligned to C_HUGE_PAGE_SIZE otherwise. A smaller block is aligned to
+   a cache line.
+*/
+
+void *huge_malloc_perror(size_t num, size_t size){
+  return huge_alloc_perror(num, size, 0, MEM_TAG_OTHER);
+}
+
+void *huge_calloc_perror(size_t num, size_t size){
+  return huge_alloc_perror(num, size, 1, MEM_TAG_OTHER);
+}
+
+/**
+   Frees a block allocated by aligned_malloc_perror, aligned_calloc_perror,
+   huge_malloc_perror, or huge_calloc_perror.
+*/
+void aligned_free(void *ptr){
+  hdr_t h;
+  if (ptr == NULL) return;
+  memcpy(&h, (char *)ptr - sizeof(hdr_t), sizeof(hdr_t));
+  ACCT_FREE(h.tag, h.size);
+#ifdef UTILITIES_MEM_MMAP
+  if (h.len > 0){
+    if (munmap(h.base, h.len) != 0){
+      perror("munmap failed");
+      exit(EXIT_FAILURE);
+    }
+    return;
+  }
+#endif
+  free(h.base);
+}
+
+/**
+   Allocation functions with an explicit accounting tag.
+*/
+
+void *malloc_perror_tag(size_t num, size_t size, mem_tag_t tag){
+#ifdef UTILITIES_MEM_ACCOUNT
+  size_t n = mul_sz_perror(num, size);
+  acct_hdr_t *h = malloc_perror(1, add_sz_perror(n, sizeof(acct_hdr_t)));
+  h->s.size = n;
+  h->s.tag = tag;
+  acct_alloc(tag, n);
+  return h + 1;
+#else
+  (void)tag;
+  return malloc_perror(num, size);
+#endif
+}
+
+void *realloc_perror_tag(void *ptr, size_t num, size_t size, mem_tag_t tag){
+#ifdef UTILITIES_MEM_ACCOUNT
+  size_t n, prev_n;
+  acct_hdr_t *h = NULL;
+  if (ptr == NULL) return malloc_perror_tag(num, size, tag);
+  n = mul_sz_perror(num, size);
+  h = (acct_hdr_t *)ptr - 1;
+  prev_n = h->s.size;
+  h = realloc_perror(h, 1, add_sz_perror(n, sizeof(acct_hdr_t)));
+  h->s.size = n;
+  /* the tag of the allocation is kept */
+  acct_realloc(h->s.tag, prev_n, n);
+  return h + 1;
+#else
+  (void)tag;
+  return realloc_perror(ptr, num, size);
+#endif
+}
+
+void *calloc_perror_tag(size_t num, size_t size, mem_tag_t tag){
+#ifdef UTILITIES_MEM_ACCOUNT
+  size_t n = mul_sz_perror(num, size);
+  acct_hdr_t *h = calloc_perror(1, add_sz_perror(n, sizeof(acct_hdr_t)));
+  h->s.size = n;
+  h->s.tag = tag;
+  acct_alloc(tag, n);
+  return h + 1;
+#else
+  (void)tag;
+  return calloc_perror(num, size);
+#endif
+}
+
+void *aligned_malloc_perror_tag(size_t num,
+				size_t size,
+				size_t align,
+				mem_tag_t tag){
+  return aligned_alloc_perror(num, size, align, 0, tag);
+}
+
+void *aligned_calloc_perror_tag(size_t num,
+				size_t size,
+				size_t align,
+				mem_tag_t tag){
+  return aligned_alloc_perror(num, size, align, 1, tag);
+}
+
+void *huge_malloc_perror_tag(size_t num, size_t size, mem_tag_t tag){
+  return huge_alloc_perror(num, size, 0, tag);
+}
+
+void *huge_calloc_perror_tag(size_t num, size_t size, mem_tag_t tag){
+  return huge_alloc_perror(num, size, 1, tag);
+}
+
+void free_tag(void *ptr){
+#ifdef UTILITIES_MEM_ACCOUNT
+  acct_hdr_t *h = NULL;
+  if (ptr == NULL) return;
+  h = (acct_hdr_t *)ptr - 1;
+  acct_free(h->s.tag, h->s.size);
+  free(h);
+#else
+  free(ptr);
+#endif
+}
+
+/**
+   Copies the statistics of a tag, or the totals across tags if tag is
+   MEM_TAG_COUNT, to a preallocated mem_stats_t block. The values are read
+   without synchronization.
+*/
+void mem_snapshot(mem_stats_t *stats, mem_tag_t tag){
+#ifdef UTILITIES_MEM_ACCOUNT
+  size_t i, j;
+  if (tag < MEM_TAG_COUNT){
+    *stats = acct_stats[tag];
+    return;
+  }
+  memset(stats, 0, sizeof(mem_stats_t));
+  for (i = 0; i < MEM_TAG_COUNT; i++){
+    stats->num_allocs += acct_stats[i].num_allocs;
+    stats->num_reallocs += acct_stats[i].num_reallocs;
+    stats->num_frees += acct_stats[i].num_frees;
+    for (j = 0; j < MEM_HIST_COUNT; j++){
+      stats->hist[j] += acct_stats[i].hist[j];
+    }
+  }
+  stats->cur_bytes = acct_cur_bytes;
+  stats->peak_bytes = acct_peak_bytes;
+#else
+  (void)tag;
+  memset(stats, 0, sizeof(mem_stats_t));
+#endif
+}
+
+/**
+   Sets the peaks to the current byte counts, and the allocation counts and
+   histograms to zero.
+*/
+void mem_reset(void){
+#ifdef UTILITIES_MEM_ACCOUNT
+  size_t i;
+  size_t cur;
+  for (i = 0; i < MEM_TAG_COUNT; i++){
+    cur = acct_stats[i].cur_bytes;
+    memset(&acct_stats[i], 0, sizeof(mem_stats_t));
+    acct_stats[i].cur_bytes = cur;
+    acct_stats[i].peak_bytes = cur;
+  }
+  acct_peak_bytes = acct_cur_bytes;
+#endif
+}
+
+/**
+   Prints the statistics of each tag with allocations and the totals.
+*/
+void mem_report(void){
+  const char *names[MEM_TAG_COUNT + 1] = {"other", "graph", "heap", "ht",
+					  "tsp", "sort", "total"};
+  size_t i, j;
+  mem_stats_t s;
+#ifndef UTILITIES_MEM_ACCOUNT
+  printf("memory accounting disabled, define UTILITIES_MEM_ACCOUNT\n");
+  return;
+#endif
+  printf("%-6s %14s %14s %12s %12s %12s\n",
+	 "tag", "cur bytes", "peak bytes", "allocs", "reallocs", "frees");
+  for (i = 0; i <= MEM_TAG_COUNT; i++){
+    mem_snapshot(&s, i);
+    if (i < MEM_TAG_COUNT && s.num_allocs == 0 && s.cur_bytes == 0){
+      continue;
+    }
+    printf("%-6s %14lu %14lu %12lu %12lu %12lu\n", names[i],
+	   (unsigned long)s.cur_bytes, (unsigned long)s.peak_bytes,
+	   (unsigned long)s.num_allocs, (unsigned long)s.num_reallocs,
+	   (unsigned long)s.num_frees);
+    printf("       sizes:");
+    for (j = 0; j < MEM_HIST_COUNT; j++){
+      if (s.hist[j] > 0){
+	printf(" [2^%lu]:%lu", (unsigned long)j, (unsigned long)s.hist[j]);
+      }
+    }
+    printf("\n");
+  }
+}
+
+/**
+   Returns an estimate of the bytes that are used by an allocator in
+   addition to a block of size bytes of malloc_perror, realloc_perror, or
+   calloc_perror.
+*/
+size_t mem_block_overhead(size_t size){
+#ifdef UTILITIES_MEM_ACCOUNT
+  return sizeof(acct_hdr_t) + alloc_overhead(size + sizeof(acct_hdr_t));
+#else
+  return alloc_overhead(size);
+#endif
+}
+
+/**
+   Returns the bytes that are used in addition to a block of
+   aligned_malloc_perror, aligned_calloc_perror, huge_malloc_perror, or
+   huge_calloc_perror.
+*/
+size_t mem_aligned_overhead(const void *ptr){
+  size_t n;
+  hdr_t h;
+  if (ptr == NULL) return 0;
+  memcpy(&h, (const char *)ptr - sizeof(hdr_t), sizeof(hdr_t));
+  if (h.len > 0) return h.len - h.size; /* mapping */
+  n = h.size + sizeof(hdr_t) + h.align - 1;
+  return n - h.size + alloc_overhead(n);
+}
+
+/**
+   Allocates a block with malloc or calloc with the space for a header and
+   alignment, and returns the aligned pointer after the header.
+*/
+static void *aligned_alloc_perror(size_t num,
+				  size_t size,
+				  size_t align,
+				  int zero,
+				  mem_tag_t tag){
+  size_t n, size_n;
+  void *base = NULL;
+  if (align == 0 || (align & (align - 1)) != 0){
+    perror("alignment is not a power of two");
+    exit(EXIT_FAILURE);
+  }
+  size_n = mul_sz_perror(num, size);
+  n = add_sz_perror(size_n, sizeof(hdr_t));
+  n = add_sz_perror(n, align - 1);
+  if (zero){
+    base = calloc_perror(1, n);
+  }else{
+    base = malloc_perror(1, n);
+  }
+  ACCT_ALLOC(tag, size_n);
+  return hdr_set(base, 0, align, size_n, tag);
+}
+
+/**
+   Allocates a huge page block with mmap and MAP_HUGETLB if enough huge
+   pages are free and the rounding waste is bounded, or otherwise with an
+   alignment of C_HUGE_PAGE_SIZE and MADV_HUGEPAGE advice if transparent
+   huge pages may back the block, or otherwise with an alignment of a cache
+   line. A mapping is zeroed when created. The advice is not required for
+   correctness and its result is ignored.
+*/
+static void *huge_alloc_perror(size_t num,
+			       size_t size,
+			       int zero,
+			       mem_tag_t tag){
+  size_t n = mul_sz_perror(num, size);
+#ifdef UTILITIES_MEM_MMAP
+  size_t len, page, num_free;
+  void *base = NULL;
+  void *ptr = NULL;
+#endif
+  if (n < C_HUGE_PAGE_SIZE){
+    return aligned_alloc_perror(n, 1, C_CACHE_LINE_SIZE, zero, tag);
+  }
+#ifdef UTILITIES_MEM_MMAP
+  page = hugetlb_page_size(&num_free);
+  len = add_sz_perror(n, C_CACHE_LINE_SIZE);
+  len = add_sz_perror(len, page - 1);
+  len -= len % page;
+  if (len / page <= num_free && len - n <= n / C_HUGETLB_WASTE_DIV){
+    base = mmap(NULL,
+		len,
+		PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+		-1,
+		0);
+    if (base != MAP_FAILED){
+      ACCT_ALLOC(tag, n);
+      return hdr_set(base, len, C_CACHE_LINE_SIZE, n, tag);
+    }
+  }
+  if (thp_madvise_eligible()){
+    ptr = aligned_alloc_perror(n, 1, C_HUGE_PAGE_SIZE, zero, tag);
+    madvise(ptr, n, MADV_HUGEPAGE);
+    return ptr;
+  }
+#endif
+  return aligned_alloc_perror(n, 1, C_CACHE_LINE_SIZE, zero, tag);
+}
+
+/**
+   Computes the first pointer aligned to align bytes with the space for a
+   header between base and the pointer, and copies the header.
+*/
+static void *hdr_set(void *base,
+		     size_t len,
+		     size_t align,
+		     size_t size,
+		     mem_tag_t tag){
+  char *ptr = (char *)base + sizeof(hdr_t);
+  hdr_t h;
+  /* the conversion of a pointer to size_t is implementation-defined */
+  ptr += (align - (size_t)ptr % align) % align;
+  h.base = base;
+  h.len = len;
+  h.size = size;
+  h.align = align;
+  h.tag = tag;
+  memcpy(ptr - sizeof(hdr_t), &h, sizeof(hdr_t));
+  return ptr;
+}
+
+#ifdef UTILITIES_MEM_MMAP
+
+/**
+   Returns the default huge page size of MAP_HUGETLB mappings according to
+   /proc/meminfo, or C_HUGE_PAGE_SIZE if it is not available, and sets the
+   value pointed to by num_free to the number of free huge pages that are
+   not reserved by other mappings, or 0 if it is not available. The values are read at each call without a shared
+   state, because the number of free huge pages changes at runtime.
+*/
+static size_t hugetlb_page_size(size_t *num_free){
+  char line[128];
+  unsigned long val;
+  size_t page = C_HUGE_PAGE_SIZE;
+  size_t num_rsvd = 0;
+  FILE *f = NULL;
+  *num_free = 0;
+  f = fopen("/proc/meminfo", "r");
+  if (f == NULL) return page;
+  while (fgets(line, sizeof(line), f) != NULL){
+    if (sscanf(line, "HugePages_Free: %lu", &val) == 1){
+      *num_free = val;
+    }else if (sscanf(line, "HugePages_Rsvd: %lu", &val) == 1){
+      num_rsvd = val;
+    }else if (sscanf(line, "Hugepagesize: %lu kB", &val) == 1){
+      if (val > 0 && val <= C_SIZE_MAX / 1024) page = val * 1024;
+    }
+  }
+  fclose(f);
+  *num_free = (*num_free > num_rsvd) ? *num_free - num_rsvd : 0;
+  return page;
+}
+
+/**
+   Returns 1 if transparent huge pages are enabled in madvise or always
+   mode according to /sys/kernel/mm/transparent_hugepage/enabled, and 0
+   otherwise, in which case an alignment of C_HUGE_PAGE_SIZE only adds
+   padding.
+*/
+static int thp_madvise_eligible(void){
+  char line[128];
+  int ret = 0;
+  FILE *f = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+  if (f == NULL) return 0;
+  if (fgets(line, sizeof(line), f) != NULL){
+    ret = (strstr(line, "[always]") != NULL ||
+	   strstr(line, "[madvise]") != NULL);
+  }
+  fclose(f);
+  return ret;
+}
+
+#endif
+
+/**
+   Returns an estimate of the bytes that are used by malloc, realloc, or
+   calloc in addition to a block of size bytes.
+*/
+static size_t alloc_overhead(size_t size){
+  size_t n = size + sizeof(size_t); /* header */
+  size_t unit = 2 * sizeof(size_t);
+  n += (unit - n % unit) % unit;
+  if (n < 2 * unit) n = 2 * unit;
+  return n - size;
+}
+
+#ifdef UTILITIES_MEM_ACCOUNT
+
+/**
+   Updates the statistics of a tag and the totals at an allocation, a
+   reallocation, and a free of a block of n bytes.
+*/
+
+static void acct_alloc(mem_tag_t tag, size_t n){
+  acct_peak(&acct_stats[tag].peak_bytes,
+	    ACCT_ADD(&acct_stats[tag].cur_bytes, n));
+  acct_peak(&acct_peak_bytes, ACCT_ADD(&acct_cur_bytes, n));
+  ACCT_ADD(&acct_stats[tag].num_allocs, 1);
+  ACCT_ADD(&acct_stats[tag].hist[hist_ix(n)], 1);
+}
+
+static void acct_realloc(mem_tag_t tag, size_t prev_n, size_t n){
+  ACCT_SUB(&acct_stats[tag].cur_bytes, prev_n);
+  ACCT_SUB(&acct_cur_bytes, prev_n);
+  acct_peak(&acct_stats[tag].peak_bytes,
+	    ACCT_ADD(&acct_stats[tag].cur_bytes, n));
+  acct_peak(&acct_peak_bytes, ACCT_ADD(&acct_cur_bytes, n));
+  ACCT_ADD(&acct_stats[tag].num_reallocs, 1);
+  ACCT_ADD(&acct_stats[tag].hist[hist_ix(n)], 1);
+}
+
+static void acct_free(mem_tag_t tag, size_t n){
+  ACCT_SUB(&acct_stats[tag].cur_bytes, n);
+  ACCT_SUB(&acct_cur_bytes, n);
+  ACCT_ADD(&acct_stats[tag].num_frees, 1);
+}
+
+/**
+   Raises a peak to a current value with a compare-and-swap loop.
+*/
+static void acct_peak(size_t *peak, size_t cur){
+  size_t p = *peak;
+  while (cur > p && !ACCT_CAS(peak, p, cur)){
+    p = *peak;
+  }
+}
+
+/**
+   Returns the size class of n, i.e. floor(log2(n)) for n > 0 bounded by
+   MEM_HIST_COUNT - 1, and 0 for n = 0.
+*/
+static size_t hist_ix(size_t n){
+  size_t ret = 0;
+  while (n > 1 && ret < MEM_HIST_COUNT - 1){
+    n >>= 1;
+    ret++;
+  }
+  return ret;
+}
+
+#endif
@@ -2,6 +2,31 @@
    utilities-mem.h
 
    Declarations of accessible utility functions for memory management.
+
+   Aligned and huge page allocations are provided in addition to malloc,
+   realloc, and calloc with error checking. On Linux, unless
+   UTILITIES_MEM_PORTABLE is defined, huge page allocations are backed by
+   free reserved huge pages with mmap and MAP_HUGETLB if the rounding to
+   the huge page size wastes little space, and otherwise by transparent
+   huge pages with madvise and MADV_HUGEPAGE if transparent huge pages are
+   enabled in madvise or always mode. On other systems, or if
+   UTILITIES_MEM_PORTABLE is defined, the implementation is portable under
+   C89/C90 and huge page allocations are aligned to a cache line.
+
+   Allocation accounting is enabled at compile time by defining
+   UTILITIES_MEM_ACCOUNT in all translation units, e.g. by
+   "make clean-all && make CPPFLAGS=-DUTILITIES_MEM_ACCOUNT". A translation
+   unit assigns its allocations to a subsystem by defining
+   UTILITIES_MEM_TAG as a mem_tag_t value before including this header.
+   With accounting enabled, the allocation functions of this header and
+   free are replaced by macros that pass the tag, and each block of
+   malloc_perror, realloc_perror, and calloc_perror is preceded by a
+   header with its size and tag, so that a block must be freed by free in
+   a translation unit that includes this header. A call through a member
+   named free is parenthesized, e.g. (p->free)(p->ht), to prevent the
+   replacement. The counters are updated with atomic operations if the
+   compiler provides __sync builtins. Without accounting, the allocation
+   functions have no overhead and the statistics remain zero.
 */
 
 #ifndef UTILITIES_MEM_H
@@ -9,6 +34,33 @@
 
 #include <stdlib.h>
 
+#define MEM_HIST_COUNT 24 /* size classes of allocations */
+
+typedef enum{
+  MEM_TAG_OTHER,
+  MEM_TAG_GRAPH,
+  MEM_TAG_HEAP,
+  MEM_TAG_HT,
+  MEM_TAG_TSP,
+  MEM_TAG_SORT,
+  MEM_TAG_COUNT /* count of tags; selects all tags in mem_snapshot */
+} mem_tag_t;
+
+typedef struct{
+  size_t cur_bytes; /* bytes in allocated blocks */
+  size_t peak_bytes; /* maximum of cur_bytes since start or reset */
+  size_t num_allocs; /* malloc, calloc, aligned, and huge allocations */
+  size_t num_reallocs;
+  size_t num_frees;
+  size_t hist[MEM_HIST_COUNT]; /* ith class: [2^i, 2^(i + 1)) bytes */
+} mem_stats_t;
+
+typedef struct{
+  size_t payload; /* bytes of stored keys, elements, and priorities */
+  size_t overhead; /* bytes of structs, pointers, padding, and headers */
+  size_t slack; /* bytes of allocated and unused capacity */
+} mem_footprint_t;
+
 /**
    Addition and multiplication of size_t with wrapped overflow checking.
 */
@@ -30,4 +82,122 @@ void *realloc_perror(void *ptr, size_t num, size_t size);
 
 void *calloc_perror(size_t num, size_t size);
 
+/**
+   Allocates a block of num * size bytes aligned to align bytes, with
+   wrapped error checking. The block is set to zero by aligned_calloc_perror.
+   A block allocated by the functions of this section is only freed with
+   aligned_free.
+   num         : number of elements
+   size        : > 0 size of an element in bytes
+   align       : alignment in bytes that is a power of two
+*/
+void *aligned_malloc_perror(size_t num, size_t size, size_t align);
+
+void *aligned_calloc_perror(size_t num, size_t size, size_t align);
+
+/**
+   Allocates a block of num * size bytes for a large array that is
+   accessed at random, with wrapped error checking. If the block is at
+   least C_HUGE_PAGE_SIZE (2MB), it is backed by huge pages where
+   available to reduce TLB misses, and is aligned to C_HUGE_PAGE_SIZE only
+   if transparent huge pages may back it. Otherwise the block is aligned
+   to a cache line (64 bytes). The block is set to zero by
+   huge_calloc_perror.
+*/
+void *huge_malloc_perror(size_t num, size_t size);
+
+void *huge_calloc_perror(size_t num, size_t size);
+
+/**
+   Frees a block allocated by aligned_malloc_perror, aligned_calloc_perror,
+   huge_malloc_perror, or huge_calloc_perror. Does nothing if ptr is NULL.
+*/
+void aligned_free(void *ptr);
+
+/**
+   Allocation functions with an explicit accounting tag. The functions
+   without a tag use MEM_TAG_OTHER, or UTILITIES_MEM_TAG if accounting is
+   enabled. free_tag frees a block of malloc_perror_tag, realloc_perror_tag,
+   or calloc_perror_tag.
+*/
+
+void *malloc_perror_tag(size_t num, size_t size, mem_tag_t tag);
+
+void *realloc_perror_tag(void *ptr, size_t num, size_t size, mem_tag_t tag);
+
+void *calloc_perror_tag(size_t num, size_t size, mem_tag_t tag);
+
+void *aligned_malloc_perror_tag(size_t num,
+				size_t size,
+				size_t align,
+				mem_tag_t tag);
+
+void *aligned_calloc_perror_tag(size_t num,
+				size_t size,
+				size_t align,
+				mem_tag_t tag);
+
+void *huge_malloc_perror_tag(size_t num, size_t size, mem_tag_t tag);
+
+void *huge_calloc_perror_tag(size_t num, size_t size, mem_tag_t tag);
+
+void free_tag(void *ptr);
+
+/**
+   Copies the statistics of a tag, or the totals across tags if tag is
+   MEM_TAG_COUNT, to a preallocated mem_stats_t block. The peak of the
+   totals is the peak of the sum across tags.
+*/
+void mem_snapshot(mem_stats_t *stats, mem_tag_t tag);
+
+/**
+   Sets the peaks to the current byte counts, and the allocation counts and
+   histograms to zero.
+*/
+void mem_reset(void);
+
+/**
+   Prints the statistics of each tag with allocations and the totals.
+*/
+void mem_report(void);
+
+/**
+   Returns an estimate of the bytes that are used by an allocator in
+   addition to a block of size bytes of malloc_perror, realloc_perror, or
+   calloc_perror. The estimate assumes a header of sizeof(size_t) bytes
+   and blocks that are rounded up to a multiple of 2 * sizeof(size_t)
+   bytes and are at least 4 * sizeof(size_t) bytes, as in the GNU C
+   Library, and includes the header of allocation accounting if enabled.
+*/
+size_t mem_block_overhead(size_t size);
+
+/**
+   Returns the bytes that are used in addition to a block of
+   aligned_malloc_perror, aligned_calloc_perror, huge_malloc_perror, or
+   huge_calloc_perror, including its header, alignment, and the rounding
+   of a mapping. Returns 0 if ptr is NULL.
+*/
+size_t mem_aligned_overhead(const void *ptr);
+
+#if defined(UTILITIES_MEM_ACCOUNT) && !defined(UTILITIES_MEM_C)
+#ifndef UTILITIES_MEM_TAG
+#define UTILITIES_MEM_TAG MEM_TAG_OTHER
+#endif
+#define malloc_perror(num, size)					\
+  malloc_perror_tag((num), (size), UTILITIES_MEM_TAG)
+#define realloc_perror(ptr, num, size)					\
+  realloc_perror_tag((ptr), (num), (size), UTILITIES_MEM_TAG)
+#define calloc_perror(num, size)					\
+  calloc_perror_tag((num), (size), UTILITIES_MEM_TAG)
+#define aligned_malloc_perror(num, size, align)				\
+  aligned_malloc_perror_tag((num), (size), (align), UTILITIES_MEM_TAG)
+#define aligned_calloc_perror(num, size, align)				\
+  aligned_calloc_perror_tag((num), (size), (align), UTILITIES_MEM_TAG)
+#define huge_malloc_perror(num, size)					\
+  huge_malloc_perror_tag((num), (size), UTILITIES_MEM_TAG)
+#define huge_calloc_perror(num, size)					\
+  huge_calloc_perror_tag((num), (size), UTILITIES_MEM_TAG)
+#define free(ptr) free_tag(ptr)
+#endif
+
 #endif
@@ -13,18 +13,24 @@
       [0, 1] : mem_mod test on/off
       [0, 1] : fast_mem_mod test on/off
       [0, 1] : mul_ext, represent_uint, and pow_two tests on/off
+      [0, 1] : Montgomery and primality tests on/off
 
    usage examples: 
    ./utilities-mod-test 20
    ./utilities-mod-test 20 11 0 15
    ./utilities-mod-test 20 11 25 25 0 1 1 0
    ./utilities-mod-test 20 11 30 30 0 0 1 0
+   ./utilities-mod-test 15 10 10 15 0 0 0 0 1
 
    utilities-mod-test can be run with any subset of command line arguments in
    the above-defined order. If the (i + 1)th argument is specified then the
    ith argument must be specified for i >= 0. Default values are used for the
    unspecified arguments according to the C_ARGS_DEF array.
 
+   The runtimes are measured with utilities-bench and can be written as
+   csv or json records by setting BENCH_FORMAT and BENCH_OUT, e.g.
+   BENCH_FORMAT=json BENCH_OUT=utilities-mod.json ./utilities-mod-test 15 10 10 15 0 1 1 0 1
+
    The implementation of tests does not use stdint.h and is portable under
    C89/C90 with the only requirement that CHAR_BIT * sizeof(size_t) is even.
    Some tests require a little-endian machine, as indicated.
@@ -35,6 +41,7 @@
 #include <string.h>
 #include <limits.h>
 #include <time.h>
+#include "utilities-bench.h"
 #include "utilities-mem.h"
 #include "utilities-mod.h"
 
@@ -44,7 +51,11 @@
    be the case on older rand() implementations, and on current
    implementations on different systems.
 */
+#ifdef TEST_SEED
+#define RGENS_SEED() do{srand(TEST_SEED);}while (0)
+#else
 #define RGENS_SEED() do{srand(time(NULL));}while (0)
+#endif
 #define RANDOM() (rand()) /* [0, RAND_MAX] */
 #define DRAND() ((double)rand() / RAND_MAX) /* [0.0, 1.0] */
 
@@ -60,11 +71,13 @@ const char *C_USAGE =
   "[0, 1] : pow_mod, mul_mod, mul_mod_pow_two, and sum_mod tests on/off \n"
   "[0, 1] : mem_mod test on/off \n"
   "[0, 1] : fast_mem_mod test on/off \n"
-  "[0, 1] : mul_ext, represent_uint, and pow_two tests on/off \n";
-const int C_ARGC_MAX = 9;
-const size_t C_ARGS_DEF[8] = {15, 10, 10, 15, 1, 1, 1, 1};
+  "[0, 1] : mul_ext, represent_uint, and pow_two tests on/off \n"
+  "[0, 1] : Montgomery and primality tests on/off \n";
+const int C_ARGC_MAX = 10;
+const size_t C_ARGS_DEF[9] = {15, 10, 10, 15, 1, 1, 1, 1, 1};
 
 /* tests */
+const char *C_SUITE = "utilities-mod-test";
 const unsigned char C_UCHAR_MAX = (unsigned char)-1;
 const size_t C_SIZE_MAX = (size_t)-1; /* >= 3 */
 const size_t C_BYTE_BIT = CHAR_BIT;
@@ -73,6 +86,13 @@ const size_t C_HALF_BIT = CHAR_BIT * sizeof(size_t) / 2; /* >= 1 */
 const size_t C_BASE_MAX = (((size_t)1 << (CHAR_BIT / 2))
 			   + 1); /* >= 2, <= C_SIZE_MAX */
 
+size_t mul_mod_ref(size_t a, size_t b, size_t n);
+size_t pow_mod_ref(size_t a, size_t k, size_t n);
+size_t random_odd_mod(size_t n_min);
+void report(const bench_t *b,
+	    const char *label,
+	    const char *param,
+	    size_t val);
 void print_test_result(int res);
 
 /**
@@ -288,7 +308,7 @@ void run_mem_mod_test(int pow_trials,
   size_t i, trials;
   size_t num, n, mod_n;
   size_t size;
-  clock_t t;
+  bench_t b;
   block = calloc_perror(1, add_sz_perror(pow_two(pow_size_end), 1));
   trials = pow_two(pow_trials);
   size = sizeof(size_t);
@@ -307,14 +327,16 @@ void run_mem_mod_test(int pow_trials,
   for (j = pow_size_start; j <= pow_size_end; j++){
     size = pow_two(j) + 1;
     block[size - 1] = 1;
-    t = clock();
+    bench_init(&b, C_SUITE, "mem_mod", 0, 1);
+    bench_start(&b);
     mod_n = mem_mod(block, size, n);
-    t = clock() - t;
+    bench_stop(&b);
     res = (mod_n == pow_mod(mul_mod(pow_two(C_BYTE_BIT - 1), 2, n),
 			    size - 1,
 			    n));
     printf("\tblock size:  %lu bytes \n", TOLU(size));
-    printf("\truntime:     %.8f seconds \n", (float)t / CLOCKS_PER_SEC);
+    report(&b, "\truntime:     ", "size", size);
+    bench_free(&b);
     printf("\tcorrectness: ");
     print_test_result(res);
     res = 1;
@@ -336,7 +358,7 @@ void run_fast_mem_mod_test(int pow_trials,
   size_t i, trials;
   size_t num, n, mod_n;
   size_t k, size;
-  clock_t t;
+  bench_t b;
   trials = pow_two(pow_trials);
   size = sizeof(size_t);
   printf("Run fast_mem_mod in a random test, size = %lu bytes  --> ",
@@ -356,14 +378,16 @@ void run_fast_mem_mod_test(int pow_trials,
   for (j = pow_size_start; j <= pow_size_end; j++){
     size = pow_two(j) + 1;
     block[size - 1] = 1;
-    t = clock();
+    bench_init(&b, C_SUITE, "fast_mem_mod", 0, 1);
+    bench_start(&b);
     mod_n = fast_mem_mod(block, size, n);
-    t = clock() - t;
+    bench_stop(&b);
     res = (mod_n == pow_mod(mul_mod(pow_two(C_BYTE_BIT - 1), 2, n),
 			    size - 1,
 			    n));
     printf("\tblock size:  %lu bytes \n", TOLU(size));
-    printf("\truntime:     %.8f seconds \n", (float)t / CLOCKS_PER_SEC);
+    report(&b, "\truntime:     ", "size", size);
+    bench_free(&b);
     printf("\tcorrectness: ");
     print_test_result(res);
     res = 1;
@@ -376,14 +400,16 @@ void run_fast_mem_mod_test(int pow_trials,
   for (j = pow_size_start; j <= pow_size_end; j++){
     size = pow_two(j) + 1;
     block[size - 1] = 1;
-    t = clock();
+    bench_init(&b, C_SUITE, "fast_mem_mod", 0, 1);
+    bench_start(&b);
     mod_n = fast_mem_mod(block, size, n);
-    t = clock() - t;
+    bench_stop(&b);
     res = (mod_n == pow_mod(mul_mod(pow_two(C_BYTE_BIT - 1), 2, n),
 			    size - 1,
 			    n));
     printf("\tblock size:  %lu bytes \n", TOLU(size));
-    printf("\truntime:     %.8f seconds \n", (float)t / CLOCKS_PER_SEC);
+    report(&b, "\truntime:     ", "size", size);
+    bench_free(&b);
     printf("\tcorrectness: ");
     print_test_result(res);
     res = 1;
@@ -511,6 +537,247 @@ void run_represent_uint_test(int pow_trials){
   print_test_result(res);
 }
 
+/**
+   Computes (a * b) mod n by doubling with sum_mod, as a portable reference
+   without a double-width type and Montgomery contexts.
+*/
+size_t mul_mod_ref(size_t a, size_t b, size_t n){
+  size_t ret = 0;
+  size_t i;
+  if (n == 1) return 0;
+  if (a >= n) a = a % n;
+  for (i = C_FULL_BIT; i > 0; i--){
+    ret = sum_mod(ret, ret, n);
+    if ((b >> (i - 1)) & 1) ret = sum_mod(ret, a, n);
+  }
+  return ret;
+}
+
+/**
+   Computes mod n of the kth power with mul_mod_ref.
+*/
+size_t pow_mod_ref(size_t a, size_t k, size_t n){
+  size_t ret = 1;
+  if (n == 1) return 0;
+  while (k){
+    if (k & 1) ret = mul_mod_ref(ret, a, n);
+    a = mul_mod_ref(a, a, n);
+    k >>= 1;
+  }
+  return ret;
+}
+
+/**
+   Returns a random odd modulus n s.t. n_min <= n <= 2^{# bits in size_t}
+   - 1, where n_min >= 1.
+*/
+size_t random_odd_mod(size_t n_min){
+  size_t n = n_min + DRAND() * (C_SIZE_MAX - n_min);
+  return n | 1; /* C_SIZE_MAX is odd */
+}
+
+/**
+   Tests mont_init, mont_to, mont_from, mont_mul, and mont_pow_mod against
+   portable references.
+*/
+void run_mont_test(int pow_trials){
+  int res = 1;
+  size_t i, trials;
+  size_t a, b, k, n;
+  size_t n_mins[2];
+  size_t ni;
+  mont_t m;
+  trials = pow_two(pow_trials);
+  n_mins[0] = 3;
+  n_mins[1] = pow_two(C_HALF_BIT);
+  printf("Run Montgomery random test\n");
+  for (ni = 0; ni < 2; ni++){
+    res = 1;
+    for (i = 0; i < trials; i++){
+      n = (ni == 0) ?
+	3 + 2 * (size_t)(DRAND() * (pow_two(C_HALF_BIT) / 2 - 2)) :
+	random_odd_mod(n_mins[ni]);
+      a = DRAND() * C_SIZE_MAX;
+      b = DRAND() * C_SIZE_MAX;
+      k = DRAND() * C_SIZE_MAX;
+      mont_init(&m, n);
+      res *= (mont_from(&m, mont_to(&m, a)) == a % n);
+      res *= (mont_from(&m, mont_mul(&m, mont_to(&m, a), mont_to(&m, b))) ==
+	      mul_mod_ref(a, b, n));
+      res *= (mont_mul(&m, mont_to(&m, a), b % n) == mul_mod_ref(a, b, n));
+      res *= (mont_pow_mod(&m, a, k) == pow_mod_ref(a, k, n));
+      res *= (pow_mod(a, k, n) == pow_mod_ref(a, k, n));
+      res *= (mul_mod(a, b, n) == mul_mod_ref(a, b, n));
+    }
+    if (ni == 0){
+      printf("\t1 < n < 2^%lu, n odd --> ", TOLU(C_HALF_BIT));
+    }else{
+      printf("\t2^%lu <= n <= 2^%lu - 1, n odd --> ",
+	     TOLU(C_HALF_BIT), TOLU(C_FULL_BIT));
+    }
+    print_test_result(res);
+  }
+  res = 1;
+  mont_init(&m, 3);
+  res *= (mont_pow_mod(&m, 2, 0) == 1);
+  res *= (mont_pow_mod(&m, 2, 1) == 2);
+  res *= (mont_pow_mod(&m, 2, 2) == 1);
+  res *= (mont_pow_mod(&m, 3, 5) == 0);
+  mont_init(&m, C_SIZE_MAX);
+  res *= (mont_from(&m, mont_to(&m, C_SIZE_MAX - 1)) == C_SIZE_MAX - 1);
+  res *= (mont_pow_mod(&m, C_SIZE_MAX - 1, 2) == 1);
+  res *= (mont_pow_mod(&m, C_SIZE_MAX - 1, C_SIZE_MAX) == C_SIZE_MAX - 1);
+  res *= (mont_pow_mod(&m, C_SIZE_MAX, C_SIZE_MAX) == 0);
+  printf("\tcorner cases --> ");
+  print_test_result(res);
+}
+
+/**
+   Compares pow_mod with the portable reference on random odd moduli that
+   do not fit into the low half of size_t and random full-width exponents.
+*/
+void run_pow_mod_perf_test(int pow_trials){
+  int res = 1;
+  size_t i, trials;
+  size_t *as = NULL, *ks = NULL, *ns = NULL, *rs = NULL;
+  bench_t b_ref, b_pow, b_mont;
+  mont_t m;
+  trials = pow_two(pow_trials);
+  as = malloc_perror(trials, sizeof(size_t));
+  ks = malloc_perror(trials, sizeof(size_t));
+  ns = malloc_perror(trials, sizeof(size_t));
+  rs = malloc_perror(trials, sizeof(size_t));
+  for (i = 0; i < trials; i++){
+    as[i] = DRAND() * C_SIZE_MAX;
+    ks[i] = DRAND() * C_SIZE_MAX;
+    ns[i] = random_odd_mod(pow_two(C_HALF_BIT));
+  }
+  printf("Run pow_mod benchmark, # trials: %lu, 2^%lu <= n <= 2^%lu - 1, "
+	 "n odd\n", TOLU(trials), TOLU(C_HALF_BIT), TOLU(C_FULL_BIT));
+  bench_init(&b_ref, C_SUITE, "pow_mod_ref", 0, 1);
+  bench_start(&b_ref);
+  for (i = 0; i < trials; i++){
+    rs[i] = pow_mod_ref(as[i], ks[i], ns[i]);
+  }
+  bench_stop(&b_ref);
+  bench_init(&b_pow, C_SUITE, "pow_mod", 0, 1);
+  bench_start(&b_pow);
+  for (i = 0; i < trials; i++){
+    res *= (pow_mod(as[i], ks[i], ns[i]) == rs[i]);
+  }
+  bench_stop(&b_pow);
+  bench_init(&b_mont, C_SUITE, "mont_pow_mod", 0, 1);
+  bench_start(&b_mont);
+  for (i = 0; i < trials; i++){
+    mont_init(&m, ns[i]);
+    res *= (mont_pow_mod(&m, as[i], ks[i]) == rs[i]);
+  }
+  bench_stop(&b_mont);
+  report(&b_ref, "\tportable reference:    ", "trials", trials);
+  report(&b_pow, "\tpow_mod:               ", "trials", trials);
+  report(&b_mont, "\tmont_pow_mod w/ init:  ", "trials", trials);
+  bench_free(&b_ref);
+  bench_free(&b_pow);
+  bench_free(&b_mont);
+  printf("\tcorrectness:           ");
+  print_test_result(res);
+  free(as);
+  free(ks);
+  free(ns);
+  free(rs);
+  as = NULL;
+  ks = NULL;
+  ns = NULL;
+  rs = NULL;
+}
+
+/**
+   Tests is_prime, next_prime, and next_primes against a sieve of
+   Eratosthenes, on known primes and strong pseudoprimes, and on
+   consecutive prime generation at large magnitudes.
+*/
+void run_prime_test(int pow_trials){
+  int res = 1;
+  unsigned char *composite = NULL;
+  size_t i, j, trials, bound;
+  size_t n, p, num;
+  size_t *ps = NULL;
+  bench_t b;
+  trials = pow_two(pow_trials);
+  bound = 2 * trials + 2;
+  composite = calloc_perror(bound, 1);
+  composite[0] = 1;
+  composite[1] = 1;
+  for (i = 2; i < bound; i++){
+    if (!composite[i]){
+      for (j = 2 * i; j < bound; j += i){
+	composite[j] = 1;
+      }
+    }
+  }
+  printf("Run is_prime and next_prime sieve test, n < %lu --> ",
+	 TOLU(bound));
+  for (i = 0; i < bound; i++){
+    res *= (is_prime(i) == !composite[i]);
+  }
+  for (i = 0; i + 1 < bound; i++){
+    p = next_prime(i);
+    if (p < bound){
+      res *= (!composite[p]);
+      for (j = i; j < p; j++){
+	res *= composite[j];
+      }
+    }
+  }
+  print_test_result(res);
+  res = 1;
+  printf("Run is_prime test on known primes and composites --> ");
+  res *= is_prime(pow_two(C_HALF_BIT) + 1) ==
+    (C_HALF_BIT == 16 || C_HALF_BIT == 8); /* 2^16 + 1 prime, 2^32 + 1 not */
+  res *= !is_prime(561) && !is_prime(41041) && !is_prime(825265);
+  if (C_FULL_BIT >= 64){
+    /* built by shifts to avoid constants that are too large for C89 */
+    n = ((size_t)1 << (C_FULL_BIT / 2)) - 5; /* 2^32 - 5 */
+    res *= is_prime(n);
+    n = pow_two(C_FULL_BIT - 3) - 1; /* 2^61 - 1 */
+    res *= is_prime(n);
+    n = C_SIZE_MAX - 58; /* 2^64 - 59, the largest 64-bit prime */
+    res *= is_prime(n);
+    res *= (next_prime(n + 1) == 0);
+    res *= (next_primes(&p, 1, n + 1) == 0);
+    n = (size_t)3215031751ul; /* strong pseudoprime to bases 2, 3, 5, 7 */
+    res *= !is_prime(n);
+    /* 3825123056546413051, strong pseudoprime to bases 2 to 37 */
+    n = ((size_t)890605863ul << (C_FULL_BIT / 2)) + 1335556603ul;
+    res *= !is_prime(n);
+    res *= (next_prime(n) == n + 6);
+  }
+  print_test_result(res);
+  res = 1;
+  ps = malloc_perror(trials, sizeof(size_t));
+  n = pow_two(C_FULL_BIT - 2) + DRAND() * pow_two(C_FULL_BIT - 3);
+  printf("Run next_primes test, %lu primes from n = %lu\n",
+	 TOLU(trials), TOLU(n));
+  bench_init(&b, C_SUITE, "next_primes", 0, 1);
+  bench_start(&b);
+  num = next_primes(ps, trials, n);
+  bench_stop(&b);
+  res *= (num == trials);
+  p = n;
+  for (i = 0; i < num; i++){
+    res *= (ps[i] == next_prime(p));
+    p = ps[i] + 1;
+  }
+  report(&b, "\truntime:     ", "primes", trials);
+  bench_free(&b);
+  printf("\tcorrectness: ");
+  print_test_result(res);
+  free(composite);
+  free(ps);
+  composite = NULL;
+  ps = NULL;
+}
+
 /**
    Tests pow_two.
 */
@@ -526,6 +793,15 @@ void run_pow_two_test(){
   print_test_result(res);
 }
 
+void report(const bench_t *b,
+	    const char *label,
+	    const char *param,
+	    size_t val){
+  char params[64];
+  sprintf(params, "%s=%lu", param, TOLU(val));
+  bench_report(b, label, params);
+}
+
 void print_test_result(int res){
   if (res){
     printf("SUCCESS\n");
@@ -555,7 +831,8 @@ int main(int argc, char *argv[]){
       args[4] > 1 ||
       args[5] > 1 ||
       args[6] > 1 ||
-      args[7] > 1){
+      args[7] > 1 ||
+      args[8] > 1){
     printf("USAGE:\n%s", C_USAGE);
     exit(EXIT_FAILURE);
   }
@@ -572,6 +849,11 @@ int main(int argc, char *argv[]){
     run_represent_uint_test(args[0]);
     run_pow_two_test();
   }
+  if (args[8]){
+    run_mont_test(args[0]);
+    run_pow_mod_perf_test(args[0]);
+    run_prime_test(args[0]);
+  }
   free(args);
   args = NULL;
   return 0;
@@ -4,6 +4,20 @@
    Utility functions in modular arithmetic. The utility functions are
    integer overflow-safe. The provided implementations assume that 
    CHAR_BIT * sizeof(size_t) is even.
+
+   Montgomery contexts provide modular multiplication and exponentiation
+   for odd moduli without division in the inner loops, and are used by
+   pow_mod, mem_mod, and fast_mem_mod if a modulus is odd and does not fit
+   into the low half of size_t. The arithmetic is portable under C89/C90;
+   if gcc or clang provides an unsigned integer type of twice the width of
+   size_t, the type is used for the products in mul_ext and mul_mod unless
+   UTILITIES_MOD_PORTABLE is defined.
+
+   Primality testing is deterministic for numbers less than 2^64 and is
+   based on trial division by small primes followed by the Miller-Rabin
+   test with a known set of 7 bases, run with a Montgomery context. Batches
+   of consecutive primes are generated by sieving windows of odd candidates
+   with small primes before the Miller-Rabin test.
 */
 
 #include <stdio.h>
@@ -11,11 +25,51 @@
 #include <limits.h>
 #include "utilities-mod.h"
 
+#if !defined(UTILITIES_MOD_PORTABLE) && defined(__GNUC__) &&         \
+  defined(__SIZEOF_SIZE_T__) && defined(__SIZEOF_INT128__) &&         \
+  __SIZEOF_SIZE_T__ == 8
+#define UTILITIES_MOD_DWIDE
+__extension__ typedef unsigned __int128 dwide_t;
+#elif !defined(UTILITIES_MOD_PORTABLE) && defined(__GNUC__) &&       \
+  defined(__SIZEOF_SIZE_T__) && defined(__SIZEOF_LONG_LONG__) &&      \
+  __SIZEOF_SIZE_T__ == 4 && __SIZEOF_LONG_LONG__ == 8
+#define UTILITIES_MOD_DWIDE
+__extension__ typedef unsigned long long dwide_t;
+#endif
+
 static const size_t C_BYTE_BIT = CHAR_BIT;
 static const size_t C_FULL_BIT = CHAR_BIT * sizeof(size_t);
 static const size_t C_HALF_BIT = CHAR_BIT * sizeof(size_t) / 2;
 static const size_t C_LOW_MASK = ((size_t)-1 >>
 				  (CHAR_BIT * sizeof(size_t) / 2));
+static const size_t C_SIZE_MAX = (size_t)-1;
+static const size_t C_MONT_MIN_STEPS = 2; /* steps to amortize mont_init */
+
+/**
+   Odd primes less than 2^8 for sieving, the first C_TRIAL_COUNT of which
+   are used in trial division, and the Miller-Rabin bases that are
+   sufficient for a deterministic test of all numbers less than 2^64.
+*/
+static const unsigned int C_SIEVE_PRIMES[53] =
+  {3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59,
+   61, 67, 71, 73, 79, 83, 89, 97, 101, 103, 107, 109, 113, 127, 131, 137,
+   139, 149, 151, 157, 163, 167, 173, 179, 181, 191, 193, 197, 199, 211,
+   223, 227, 229, 233, 239, 241, 251};
+static const size_t C_SIEVE_PRIMES_COUNT = 53;
+static const size_t C_TRIAL_COUNT = 15; /* odd primes up to 53 */
+static const size_t C_TRIAL_SQ_BOUND = 59 * 59; /* no divisor in trials */
+static const unsigned long C_MR_BASES[7] = {2ul, 325ul, 9375ul, 28178ul,
+					    450775ul, 9780504ul,
+					    1795265022ul};
+static const size_t C_MR_BASES_COUNT = 7;
+static const size_t C_SIEVE_WINDOW = 512; /* # of odd candidates */
+
+static int use_mont(size_t n);
+static int miller_rabin(size_t n);
+static int is_strong_probable_prime(const mont_t *m,
+				    size_t a,
+				    size_t u,
+				    size_t t);
 
 /**
    Computes overflow-safe mod n of the kth power in O(logk) time,
@@ -27,7 +81,12 @@ static const size_t C_LOW_MASK = ((size_t)-1 >>
 size_t pow_mod(size_t a, size_t k, size_t n){
   size_t k_shift = k;
   size_t ret;
+  mont_t m;
   if (n == 1) return 0;
+  if (use_mont(n)){
+    mont_init(&m, n);
+    return mont_pow_mod(&m, a, k);
+  }
   ret = 1;
   while (k_shift){
     if (k_shift & 1){
@@ -44,15 +103,20 @@ size_t pow_mod(size_t a, size_t k, size_t n){
    if a1 ≡ b1 (mod n) and a2 ≡ b2 (mod n) then a1 + a2 ≡ b1 + b2 (mod n).
 */
 size_t mul_mod(size_t a, size_t b, size_t n){
+#ifndef UTILITIES_MOD_DWIDE
   size_t al, bl, ah, bh, ah_bh;
   size_t ret;
   size_t i;
+#endif
   /* comparisons for speed up */
   if (n == 1) return 0;
   if (a == 0 || b == 0) return 0;
   if (a < pow_two(C_HALF_BIT) && b < pow_two(C_HALF_BIT)){
     return (a * b) % n;
   }
+#ifdef UTILITIES_MOD_DWIDE
+  return (size_t)((dwide_t)a * b % n);
+#else
   al = a & C_LOW_MASK;
   bl = b & C_LOW_MASK;
   ah = a >> C_HALF_BIT;
@@ -68,6 +132,7 @@ size_t mul_mod(size_t a, size_t b, size_t n){
   }
   ret = sum_mod(ret, al * bl, n);
   return ret;
+#endif
 }
 
 /**
@@ -120,19 +185,33 @@ size_t sum_mod(size_t a, size_t b, size_t n){
 */
 size_t mem_mod(const void *s, size_t size, size_t n){
   unsigned char *ptr = (unsigned char *)s;
+  int mont;
   size_t val, prod;
   size_t ptwo = 1, ptwo_inc;
   size_t ret = 0;
   size_t i;
+  mont_t m = {0, 0, 0, 0};
   if (n == 1) return 0;
   ptwo_inc = mul_mod(pow_two(C_BYTE_BIT - 1), 2, n);
+  mont = (use_mont(n) && size >= C_MONT_MIN_STEPS);
+  if (mont){
+    /* ptwo in the Montgomery form, products in the standard form */
+    mont_init(&m, n);
+    ptwo = m.r_mod;
+    ptwo_inc = mont_to(&m, ptwo_inc);
+  }
   for (i = 0; i < size; i++){
     val = *ptr;
     /* comparison for speed up across a large memory block */
     if (val >= n) val = val % n;
-    prod = mul_mod(ptwo, val, n);
+    if (mont){
+      prod = mont_mul(&m, ptwo, val);
+      ptwo = mont_mul(&m, ptwo, ptwo_inc);
+    }else{
+      prod = mul_mod(ptwo, val, n);
+      ptwo = mul_mod(ptwo, ptwo_inc, n);
+    }
     ret = sum_mod(ret, prod, n);
-    ptwo = mul_mod(ptwo, ptwo_inc, n);
     ptr++;
   }
   return ret;
@@ -148,40 +227,209 @@ size_t mem_mod(const void *s, size_t size, size_t n){
 */
 size_t fast_mem_mod(const void *s, size_t size, size_t n){
   size_t *ptr = (size_t *)s;
+  int mont;
   size_t step_size = sizeof(size_t);
   size_t res_size = 0;
   size_t val, prod;
   size_t ptwo = 1, ptwo_inc = 1;
   size_t ret = 0;
   size_t i;
+  mont_t m = {0, 0, 0, 0};
   if (n == 1) return 0;
   if (size != step_size){
     res_size = size % step_size;
   }
   if (size > step_size){
     ptwo_inc = mul_mod(pow_two(C_FULL_BIT - 1), 2, n);
-  } 
+  }
+  mont = (use_mont(n) && size / step_size >= C_MONT_MIN_STEPS);
+  if (mont){
+    /* ptwo in the Montgomery form, products in the standard form */
+    mont_init(&m, n);
+    ptwo = m.r_mod;
+    ptwo_inc = mont_to(&m, ptwo_inc);
+  }
   for (i = 0; i < size - res_size; i += step_size){
     val = *ptr;
     /* comparison for speed across a large memory block */
     if (val >= n) val = val % n;
-    prod = mul_mod(ptwo, val, n);
+    if (mont){
+      prod = mont_mul(&m, ptwo, val);
+      ptwo = mont_mul(&m, ptwo, ptwo_inc);
+    }else{
+      prod = mul_mod(ptwo, val, n);
+      ptwo = mul_mod(ptwo, ptwo_inc, n);
+    }
     ret = sum_mod(ret, prod, n);
-    ptwo = mul_mod(ptwo, ptwo_inc, n);
     ptr++;
   }
   ptr = (size_t *)((char *)s + size - res_size);
-  prod = mul_mod(ptwo, mem_mod(ptr, res_size, n), n);
+  if (mont){
+    prod = mont_mul(&m, ptwo, mem_mod(ptr, res_size, n));
+  }else{
+    prod = mul_mod(ptwo, mem_mod(ptr, res_size, n), n);
+  }
   ret = sum_mod(ret, prod, n);
   return ret;
 }
 
+/**
+   Initializes a Montgomery context for an odd modulus n > 1. Exits with an
+   error if n is even or 1. The inverse of n mod 2^{CHAR_BIT *
+   sizeof(size_t)} is computed by Newton's iteration x = x (2 - n x), which
+   doubles the number of correct low bits starting with 3 bits at x = n.
+*/
+void mont_init(mont_t *m, size_t n){
+  size_t x = n;
+  size_t i;
+  if (!(n & 1) || n == 1){
+    perror("mont_init even modulus or 1");
+    exit(EXIT_FAILURE);
+  }
+  for (i = 3; i < C_FULL_BIT; i *= 2){
+    x = mul_mod_pow_two(x, 2 - mul_mod_pow_two(n, x));
+  }
+  m->n = n;
+  m->n_neg_inv = C_SIZE_MAX - x + 1;
+  m->r_mod = (C_SIZE_MAX - n + 1) % n;
+  m->r_sq_mod = mul_mod(m->r_mod, m->r_mod, n);
+}
+
+/**
+   Converts a number to and from the Montgomery form of a context, i.e.
+   computes a * R mod n and a * R^{-1} mod n respectively, where R is
+   2^{CHAR_BIT * sizeof(size_t)}.
+*/
+size_t mont_to(const mont_t *m, size_t a){
+  if (a >= m->n) a = a % m->n;
+  return mont_mul(m, a, m->r_sq_mod);
+}
+
+size_t mont_from(const mont_t *m, size_t a){
+  return mont_mul(m, a, 1);
+}
+
+/**
+   Computes a * b * R^{-1} mod n, where a, b < n and R is
+   2^{CHAR_BIT * sizeof(size_t)}, by Montgomery reduction of the double-
+   width product T = a * b: q = T * (-n^{-1}) mod R makes T + q * n
+   divisible by R, and (T + q * n) / R < 2n. The low half of T + q * n is
+   0 with a carry if and only if the low half of T is not 0.
+*/
+size_t mont_mul(const mont_t *m, size_t a, size_t b){
+  size_t h, l, qh, ql;
+  size_t ret;
+  mul_ext(a, b, &h, &l);
+  mul_ext(mul_mod_pow_two(l, m->n_neg_inv), m->n, &qh, &ql);
+  ret = h + qh + (l != 0); /* qh + (l != 0) < n */
+  if (ret < h || ret >= m->n) ret -= m->n; /* wraps if ret < h */
+  return ret;
+}
+
+/**
+   Computes mod n of the kth power of a number in the standard form with a
+   Montgomery context, and returns the result in the standard form.
+*/
+size_t mont_pow_mod(const mont_t *m, size_t a, size_t k){
+  size_t k_shift = k;
+  size_t ret = m->r_mod;
+  a = mont_to(m, a);
+  while (k_shift){
+    if (k_shift & 1){
+      ret = mont_mul(m, ret, a); /* update for each set bit */
+    }
+    a = mont_mul(m, a, a); /* repetitive squaring between updates */
+    k_shift >>= 1;
+  }
+  return mont_from(m, ret);
+}
+
+/**
+   Returns 1 if n is prime and 0 otherwise. The test is deterministic for
+   n < 2^64 and is a strong probable prime test to 7 bases otherwise.
+*/
+int is_prime(size_t n){
+  size_t i;
+  if (n < 2) return 0;
+  if (!(n & 1)) return (n == 2);
+  for (i = 0; i < C_TRIAL_COUNT; i++){
+    if (n == C_SIEVE_PRIMES[i]) return 1;
+    if (n % C_SIEVE_PRIMES[i] == 0) return 0;
+  }
+  if (n < C_TRIAL_SQ_BOUND) return 1;
+  return miller_rabin(n);
+}
+
+/**
+   Returns the smallest prime that is greater or equal to n, or 0 if the
+   prime is not representable as size_t.
+*/
+size_t next_prime(size_t n){
+  size_t p;
+  if (next_primes(&p, 1, n) == 0) return 0;
+  return p;
+}
+
+/**
+   Copies the count smallest primes that are greater or equal to n in the
+   increasing order into the preallocated array pointed to by primes.
+   Returns the number of copied primes, which is less than count only if
+   the primes are not representable as size_t. Odd candidates are sieved
+   in windows of C_SIEVE_WINDOW with the primes in C_SIEVE_PRIMES, and the
+   candidates that are not sieved out are tested with Miller-Rabin.
+*/
+size_t next_primes(size_t *primes, size_t count, size_t n){
+  unsigned char sieved[512]; /* C_SIEVE_WINDOW */
+  size_t num = 0;
+  size_t low, win, p, c;
+  size_t i, j;
+  if (count == 0) return 0;
+  if (n <= 2){
+    primes[num++] = 2;
+    n = 3;
+  }
+  low = n | 1; /* n is even and less than C_SIZE_MAX if n | 1 != n */
+  while (num < count){
+    win = (C_SIZE_MAX - low) / 2 + 1; /* low + 2 * (win - 1) <= C_SIZE_MAX */
+    if (win > C_SIEVE_WINDOW) win = C_SIEVE_WINDOW;
+    for (i = 0; i < win; i++){
+      sieved[i] = 0;
+    }
+    for (j = 0; j < C_SIEVE_PRIMES_COUNT; j++){
+      /* first i s.t. p divides low + 2i, i.e. i = (p - low mod p) / 2 mod p */
+      p = C_SIEVE_PRIMES[j];
+      i = (p - low % p) % p;
+      if (i & 1) i += p;
+      i /= 2;
+      if (low + 2 * i == p) i += p; /* p itself is not sieved out */
+      for (; i < win; i += p){
+	sieved[i] = 1;
+      }
+    }
+    for (i = 0; i < win && num < count; i++){
+      c = low + 2 * i;
+      if (!sieved[i] && (c < C_TRIAL_SQ_BOUND ? is_prime(c) :
+			 miller_rabin(c))){
+	primes[num++] = c;
+      }
+    }
+    if (win < C_SIEVE_WINDOW || low + 2 * (win - 1) == C_SIZE_MAX) break;
+    low += 2 * win;
+  }
+  return num;
+}
+
 /**
    Multiplies two numbers in an overflow-safe manner and copies the high and
    low bits of the product into the preallocated blocks pointed to by h
    and l.
 */
 void mul_ext(size_t a, size_t b, size_t *h, size_t *l){
+#ifdef UTILITIES_MOD_DWIDE
+  dwide_t p = (dwide_t)a * b;
+  *h = (size_t)(p >> C_FULL_BIT);
+  *l = (size_t)p;
+#else
   size_t al, bl, ah, bh, al_bl, al_bh;
   size_t overlap;
   al = a & C_LOW_MASK;
@@ -198,6 +446,7 @@ void mul_ext(size_t a, size_t b, size_t *h, size_t *l){
 	(ah * bl >> C_HALF_BIT) +
 	(al_bh >> C_HALF_BIT));
   *l = (overlap << C_HALF_BIT) + (al_bl & C_LOW_MASK);
+#endif
 }
 
 /**
@@ -232,4 +481,54 @@ size_t pow_two_perror(size_t k){
     exit(EXIT_FAILURE);
   }
   return (size_t)1 << k;
-} 
+}
+
+/**
+   Returns 1 if a Montgomery context is used for a modulus, i.e. if the
+   modulus is odd and mul_mod may not take its fast path, and 0 otherwise.
+*/
+static int use_mont(size_t n){
+  return ((n & 1) && n > C_LOW_MASK);
+}
+
+/**
+   Runs the Miller-Rabin test on an odd n > 2 with the bases in
+   C_MR_BASES. Returns 1 if n is a strong probable prime to each base, which
+   is equivalent to n being prime if n < 2^64, and 0 otherwise.
+*/
+static int miller_rabin(size_t n){
+  size_t a, t, u;
+  size_t i;
+  mont_t m;
+  mont_init(&m, n);
+  represent_uint(n - 1, &t, &u);
+  for (i = 0; i < C_MR_BASES_COUNT; i++){
+    a = C_MR_BASES[i] % n;
+    if (a == 0) continue;
+    if (!is_strong_probable_prime(&m, a, u, t)) return 0;
+  }
+  return 1;
+}
+
+/**
+   Returns 1 if n is a strong probable prime to base a, where
+   n - 1 = u * 2^t, u is odd, t > 0, and 0 < a < n. Otherwise returns 0.
+   The squaring is performed in the Montgomery form, where 1 and n - 1 are
+   represented by r_mod and n - r_mod.
+*/
+static int is_strong_probable_prime(const mont_t *m,
+				    size_t a,
+				    size_t u,
+				    size_t t){
+  size_t one = m->r_mod, neg_one = m->n - m->r_mod;
+  size_t x;
+  size_t i;
+  x = mont_to(m, mont_pow_mod(m, a, u));
+  if (x == one || x == neg_one) return 1;
+  for (i = 1; i < t; i++){
+    x = mont_mul(m, x, x);
+    if (x == neg_one) return 1;
+    if (x == one) return 0; /* nontrivial square root of 1 */
+  }
+  return 0;
+}
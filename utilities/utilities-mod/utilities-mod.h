@@ -4,6 +4,16 @@
    Declarations of accessible utility functions in modular arithmetic.
    The utility functions are integer overflow-safe. The provided
    implementations assume that CHAR_BIT * sizeof(size_t) is even.
+
+   Montgomery contexts provide modular multiplication and exponentiation
+   for odd moduli without division in the inner loops. The arithmetic is
+   portable under C89/C90; if gcc or clang provides an unsigned integer
+   type of twice the width of size_t, the type is used for the products
+   in mul_ext and mul_mod unless UTILITIES_MOD_PORTABLE is defined.
+
+   Primality testing is deterministic for numbers less than 2^64 and is
+   based on trial division by small primes followed by the Miller-Rabin
+   test with a known set of 7 bases, run with a Montgomery context.
 */
 
 #ifndef UTILITIES_MOD_H  
@@ -11,6 +21,13 @@
 
 #include <stddef.h>
 
+typedef struct{
+  size_t n; /* odd modulus > 1 */
+  size_t n_neg_inv; /* -n^{-1} mod 2^{CHAR_BIT * sizeof(size_t)} */
+  size_t r_mod; /* 2^{CHAR_BIT * sizeof(size_t)} mod n, the form of 1 */
+  size_t r_sq_mod; /* 2^{2 * CHAR_BIT * sizeof(size_t)} mod n */
+} mont_t;
+
 /**
    Computes overflow-safe mod n of the kth power.
 */
@@ -46,6 +63,54 @@ size_t mem_mod(const void *s, size_t size, size_t n);
 */
 size_t fast_mem_mod(const void *s, size_t size, size_t n);
 
+/**
+   Initializes a Montgomery context for an odd modulus n > 1. Exits with an
+   error if n is even or 1.
+*/
+void mont_init(mont_t *m, size_t n);
+
+/**
+   Converts a number to and from the Montgomery form of a context, i.e.
+   computes a * R mod n and a * R^{-1} mod n respectively, where R is
+   2^{CHAR_BIT * sizeof(size_t)}.
+*/
+size_t mont_to(const mont_t *m, size_t a);
+size_t mont_from(const mont_t *m, size_t a);
+
+/**
+   Computes a * b * R^{-1} mod n, where a, b < n and R is
+   2^{CHAR_BIT * sizeof(size_t)}. If a and b are in the Montgomery form,
+   the result is the Montgomery form of the product. If only a is in the
+   Montgomery form, the result is (a * b) mod n in the standard form.
+*/
+size_t mont_mul(const mont_t *m, size_t a, size_t b);
+
+/**
+   Computes mod n of the kth power of a number in the standard form with a
+   Montgomery context, and returns the result in the standard form.
+*/
+size_t mont_pow_mod(const mont_t *m, size_t a, size_t k);
+
+/**
+   Returns 1 if n is prime and 0 otherwise. The test is deterministic for
+   n < 2^64 and is a strong probable prime test to 7 bases otherwise.
+*/
+int is_prime(size_t n);
+
+/**
+   Returns the smallest prime that is greater or equal to n, or 0 if the
+   prime is not representable as size_t.
+*/
+size_t next_prime(size_t n);
+
+/**
+   Copies the count smallest primes that are greater or equal to n in the
+   increasing order into the preallocated array pointed to by primes.
+   Returns the number of copied primes, which is less than count only if
+   the primes are not representable as size_t.
+*/
+size_t next_primes(size_t *primes, size_t count, size_t n);
+
 /**
    Multiplies two numbers in an overflow-safe manner and copies the high and
    low bits of the product into the preallocated blocks pointed to by h
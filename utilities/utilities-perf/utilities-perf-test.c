@@ -0,0 +1,211 @@
+/**
+   utilities-perf-test.c
+
+   Tests of utility functions for reading hardware performance counters.
+
+   The following command line arguments can be used to customize tests:
+   utilities-perf-test
+      [0, # bits in size_t) : n for 2^n iterations of a counted loop
+      [0, 1] : counter test on/off
+      [0, 1] : region test on/off
+
+   usage examples:
+   ./utilities-perf-test
+   ./utilities-perf-test 24
+
+   utilities-perf-test can be run with any subset of command line
+   arguments in the above-defined order. If the (i + 1)th argument is
+   specified then the ith argument must be specified for i >= 0. Default
+   values are used for the unspecified arguments according to the
+   C_ARGS_DEF array.
+
+   The tests pass if the counters are unavailable, e.g. in a virtual
+   machine without a virtualized PMU or if perf_event_paranoid does not
+   permit user space counting, in which case all values must be PERF_NA.
+
+   The implementation of tests is portable under C89/C90.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "utilities-perf.h"
+#include "utilities-mem.h"
+
+#define TOLU(i) ((unsigned long int)(i)) /* printing size_t under C89/C90 */
+
+/* input handling */
+const char *C_USAGE =
+  "utilities-perf-test \n"
+  "[0, # bits in size_t) : n for 2^n iterations of a counted loop \n"
+  "[0, 1] : counter test on/off \n"
+  "[0, 1] : region test on/off \n";
+const int C_ARGC_MAX = 4;
+const size_t C_ARGS_DEF[3] = {20, 1, 1};
+const size_t C_FULL_BIT = CHAR_BIT * sizeof(size_t);
+
+/* tests */
+const size_t C_NUM_REG_CALLS = 3;
+
+void loop(size_t count);
+int sample_valid(const perf_sample_t *s);
+void print_sample(const perf_sample_t *s);
+void print_test_result(int res);
+
+/**
+   Runs a test of perf_open, perf_read, and perf_diff on a loop with
+   2^pow_iter iterations. If the instruction counter is available, the
+   loop executes at least one instruction per iteration.
+*/
+void run_counter_test(size_t pow_iter){
+  int res = 1;
+  int i, num_avail, num_ctrs = 0;
+  size_t count = (size_t)1 << pow_iter;
+  perf_sample_t start, end, d;
+  printf("Run perf counter test on a loop with %lu iterations\n",
+	 TOLU(count));
+  perf_read(&start);
+  res *= !sample_valid(&start); /* not open */
+  num_avail = perf_open();
+  res *= (num_avail >= 0 && num_avail <= PERF_COUNT);
+  res *= (perf_open() == num_avail);
+  for (i = 0; i < PERF_COUNT; i++){
+    num_ctrs += perf_available(i);
+  }
+  res *= (num_ctrs == num_avail);
+  perf_read(&start);
+  loop(count);
+  perf_read(&end);
+  perf_diff(&d, &end, &start);
+  for (i = 0; i < PERF_COUNT; i++){
+    if (perf_available(i)){
+      res *= (d.ctr[i] >= 0.0);
+    }else{
+      res *= (start.ctr[i] == PERF_NA && d.ctr[i] == PERF_NA);
+    }
+  }
+  if (perf_available(PERF_INSTRS) && d.ctr[PERF_INSTRS] > 0.0){
+    res *= (d.ctr[PERF_INSTRS] >= (double)count);
+  }
+  printf("\tavailable counters: %d of %d\n", num_avail, PERF_COUNT);
+  printf("\tloop counts:\n");
+  print_sample(&d);
+  perf_close();
+  perf_read(&end);
+  res *= !sample_valid(&end);
+  printf("\tcorrectness:                             ");
+  print_test_result(res);
+}
+
+/**
+   Runs a test of nested regions around a loop with 2^pow_iter
+   iterations. Only the outermost start-stop pairs are counted.
+*/
+void run_region_test(size_t pow_iter){
+  int res = 1;
+  int i;
+  size_t j, num_calls;
+  size_t count = (size_t)1 << pow_iter;
+  perf_sample_t s, t;
+  printf("Run perf region test on a loop with %lu iterations\n",
+	 TOLU(count));
+  perf_region_reset();
+  perf_region_get(PERF_REG_HEAP, &s, &num_calls);
+  res *= (num_calls == 0 && !sample_valid(&s));
+  for (j = 0; j < C_NUM_REG_CALLS; j++){
+    perf_region_start(PERF_REG_HEAP);
+    perf_region_start(PERF_REG_HEAP);
+    loop(count);
+    perf_region_stop(PERF_REG_HEAP);
+    perf_region_stop(PERF_REG_HEAP);
+  }
+  perf_region_stop(PERF_REG_HEAP); /* unmatched stop is ignored */
+  perf_region_get(PERF_REG_HEAP, &s, &num_calls);
+  res *= (num_calls == C_NUM_REG_CALLS);
+  for (i = 0; i < PERF_COUNT; i++){
+    res *= (perf_available(i) ? s.ctr[i] >= 0.0 : s.ctr[i] == PERF_NA);
+  }
+  perf_region_get(PERF_REG_HT_GROW, &t, &num_calls);
+  res *= (num_calls == 0);
+  printf("\theap region counts:\n");
+  print_sample(&s);
+  perf_region_reset();
+  perf_region_get(PERF_REG_HEAP, &s, &num_calls);
+  res *= (num_calls == 0);
+  perf_close();
+  printf("\tcorrectness:                             ");
+  print_test_result(res);
+}
+
+/**
+   Runs a loop that is not optimized away.
+*/
+void loop(size_t count){
+  size_t i;
+  volatile size_t sum = 0;
+  for (i = 0; i < count; i++){
+    sum += i;
+  }
+}
+
+/**
+   Returns 1 if at least one value of a sample is not PERF_NA.
+*/
+int sample_valid(const perf_sample_t *s){
+  int i;
+  for (i = 0; i < PERF_COUNT; i++){
+    if (s->ctr[i] != PERF_NA) return 1;
+  }
+  return 0;
+}
+
+/**
+   Prints the values of a sample.
+*/
+void print_sample(const perf_sample_t *s){
+  int i;
+  for (i = 0; i < PERF_COUNT; i++){
+    if (s->ctr[i] == PERF_NA){
+      printf("\t\t%-14s n/a\n", perf_name(i));
+    }else{
+      printf("\t\t%-14s %.0f\n", perf_name(i), s->ctr[i]);
+    }
+  }
+}
+
+/**
+   Prints a test result.
+*/
+void print_test_result(int res){
+  if (res){
+    printf("SUCCESS\n");
+  }else{
+    printf("FAILURE\n");
+  }
+}
+
+int main(int argc, char *argv[]){
+  int i;
+  size_t *args = NULL;
+  if (argc > C_ARGC_MAX){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  args = malloc_perror(C_ARGC_MAX - 1, sizeof(size_t));
+  memcpy(args, C_ARGS_DEF, (C_ARGC_MAX - 1) * sizeof(size_t));
+  for (i = 1; i < argc; i++){
+    args[i - 1] = atoi(argv[i]);
+  }
+  if (args[0] > C_FULL_BIT - 1 ||
+      args[1] > 1 ||
+      args[2] > 1){
+    printf("USAGE:\n%s", C_USAGE);
+    exit(EXIT_FAILURE);
+  }
+  if (args[1]) run_counter_test(args[0]);
+  if (args[2]) run_region_test(args[0]);
+  free(args);
+  args = NULL;
+  return 0;
+}
@@ -0,0 +1,309 @@
+/**
+   utilities-perf.c
+
+   Utility functions for reading hardware performance counters.
+
+   On Linux, unless UTILITIES_PERF_PORTABLE is defined, the available
+   counters are opened as one group with the first available counter as
+   the group leader, and the group is read with one system call. A group
+   that was not counting since it was opened, e.g. because it could not be
+   scheduled on the processor, is read as unavailable. The implementation
+   is otherwise portable under C89/C90.
+*/
+
+#if defined(__linux__) && !defined(UTILITIES_PERF_PORTABLE)
+#define _DEFAULT_SOURCE
+#define UTILITIES_PERF_EVENT
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "utilities-perf.h"
+
+static const char *C_CTR_NAMES[PERF_COUNT] = {"cycles",
+					      "instrs",
+					      "l1d_misses",
+					      "llc_misses",
+					      "branch_misses",
+					      "dtlb_misses"};
+static const char *C_REG_NAMES[PERF_REG_COUNT] = {"adj_lst build",
+						  "heap ops",
+						  "ht grow",
+						  "tsp levels"};
+
+static int is_open = 0;
+static int num_avail = 0;
+static int avail[PERF_COUNT]; /* position in the group + 1, 0 if n/a */
+
+static perf_sample_t reg_start[PERF_REG_COUNT];
+static perf_sample_t reg_total[PERF_REG_COUNT];
+static size_t reg_depth[PERF_REG_COUNT];
+static size_t reg_calls[PERF_REG_COUNT];
+
+#ifdef UTILITIES_PERF_EVENT
+
+#define GROUP_BUF_COUNT (3 + PERF_COUNT) /* nr, enabled, running, values */
+
+static int fds[PERF_COUNT];
+static int leader_fd = -1;
+
+static void attr_init(struct perf_event_attr *attr, perf_ctr_t c);
+static int ctr_open(perf_ctr_t c, int group_fd);
+
+#endif
+
+static void sample_na(perf_sample_t *s);
+
+/**
+   Opens the counters for the calling thread, if they are not open, and
+   returns the number of available counters.
+*/
+int perf_open(void){
+#ifdef UTILITIES_PERF_EVENT
+  int i, fd;
+#endif
+  if (is_open) return num_avail;
+  is_open = 1;
+  num_avail = 0;
+#ifdef UTILITIES_PERF_EVENT
+  for (i = 0; i < PERF_COUNT; i++){
+    avail[i] = 0;
+    fds[i] = -1;
+    fd = ctr_open(i, leader_fd);
+    if (fd < 0) continue;
+    if (leader_fd < 0) leader_fd = fd;
+    fds[i] = fd;
+    avail[i] = ++num_avail;
+  }
+#endif
+  return num_avail;
+}
+
+/**
+   Returns 1 if a counter is available, and 0 otherwise.
+*/
+int perf_available(perf_ctr_t c){
+  return is_open && avail[c] > 0;
+}
+
+/**
+   Returns the name of a counter, e.g. "cycles".
+*/
+const char *perf_name(perf_ctr_t c){
+  return C_CTR_NAMES[c];
+}
+
+/**
+   Reads the counts since the counters were opened. If the counters are not
+   open, then all values are PERF_NA.
+*/
+void perf_read(perf_sample_t *s){
+#ifdef UTILITIES_PERF_EVENT
+  int i;
+  double scale;
+  __u64 buf[GROUP_BUF_COUNT];
+#endif
+  sample_na(s);
+  if (num_avail == 0) return;
+#ifdef UTILITIES_PERF_EVENT
+  if (read(leader_fd, buf, sizeof(buf)) < (long)(3 * sizeof(__u64)) ||
+      buf[0] != (__u64)num_avail ||
+      buf[2] == 0){
+    return;
+  }
+  scale = (buf[2] < buf[1]) ? (double)buf[1] / buf[2] : 1.0;
+  for (i = 0; i < PERF_COUNT; i++){
+    if (avail[i] > 0) s->ctr[i] = scale * buf[2 + avail[i]];
+  }
+#endif
+}
+
+/**
+   Computes end - start for each counter. A value is PERF_NA if it is
+   PERF_NA in end or start. d may be equal to end or start.
+*/
+void perf_diff(perf_sample_t *d,
+	       const perf_sample_t *end,
+	       const perf_sample_t *start){
+  int i;
+  for (i = 0; i < PERF_COUNT; i++){
+    if (end->ctr[i] < 0.0 || start->ctr[i] < 0.0){
+      d->ctr[i] = PERF_NA;
+    }else{
+      d->ctr[i] = end->ctr[i] - start->ctr[i];
+    }
+  }
+}
+
+/**
+   Closes the counters.
+*/
+void perf_close(void){
+#ifdef UTILITIES_PERF_EVENT
+  int i;
+  for (i = PERF_COUNT - 1; i >= 0; i--){
+    if (fds[i] >= 0) close(fds[i]);
+    fds[i] = -1;
+  }
+  leader_fd = -1;
+#endif
+  is_open = 0;
+  num_avail = 0;
+}
+
+/**
+   Starts and stops a region. The counters are opened at the first start
+   of a region if they are not open.
+*/
+
+void perf_region_start(perf_reg_t r){
+  if (reg_depth[r]++ > 0) return;
+  if (!is_open) perf_open();
+  perf_read(&reg_start[r]);
+}
+
+void perf_region_stop(perf_reg_t r){
+  int i;
+  perf_sample_t end;
+  if (reg_depth[r] == 0 || --reg_depth[r] > 0) return;
+  perf_read(&end);
+  perf_diff(&end, &end, &reg_start[r]);
+  for (i = 0; i < PERF_COUNT; i++){
+    if (reg_total[r].ctr[i] < 0.0) continue;
+    if (end.ctr[i] < 0.0){
+      reg_total[r].ctr[i] = PERF_NA;
+    }else{
+      reg_total[r].ctr[i] += end.ctr[i];
+    }
+  }
+  reg_calls[r]++;
+}
+
+/**
+   Gets the accumulated counts and the number of start-stop pairs of a
+   region, or resets all regions.
+*/
+
+void perf_region_get(perf_reg_t r, perf_sample_t *s, size_t *num_calls){
+  if (reg_calls[r] == 0){
+    sample_na(s);
+  }else{
+    *s = reg_total[r];
+  }
+  *num_calls = reg_calls[r];
+}
+
+void perf_region_reset(void){
+  int r, i;
+  for (r = 0; r < PERF_REG_COUNT; r++){
+    for (i = 0; i < PERF_COUNT; i++){
+      reg_total[r].ctr[i] = 0.0;
+    }
+    reg_depth[r] = 0;
+    reg_calls[r] = 0;
+  }
+}
+
+/**
+   Prints the accumulated counts of the regions with at least one
+   start-stop pair.
+*/
+void perf_region_report(void){
+  int r, i;
+  perf_sample_t s;
+  size_t num_calls;
+#ifndef UTILITIES_PERF_REGIONS
+  printf("perf regions disabled, define UTILITIES_PERF_REGIONS\n");
+  return;
+#endif
+  printf("%-14s %12s", "region", "calls");
+  for (i = 0; i < PERF_COUNT; i++){
+    printf(" %14s", C_CTR_NAMES[i]);
+  }
+  printf("\n");
+  for (r = 0; r < PERF_REG_COUNT; r++){
+    perf_region_get(r, &s, &num_calls);
+    if (num_calls == 0) continue;
+    printf("%-14s %12lu", C_REG_NAMES[r], (unsigned long)num_calls);
+    for (i = 0; i < PERF_COUNT; i++){
+      if (s.ctr[i] < 0.0){
+	printf(" %14s", "n/a");
+      }else{
+	printf(" %14.0f", s.ctr[i]);
+      }
+    }
+    printf("\n");
+  }
+}
+
+/**
+   Sets all values of a sample to PERF_NA.
+*/
+static void sample_na(perf_sample_t *s){
+  int i;
+  for (i = 0; i < PERF_COUNT; i++){
+    s->ctr[i] = PERF_NA;
+  }
+}
+
+#ifdef UTILITIES_PERF_EVENT
+
+/**
+   Initializes the attributes of a counter of user space events of the
+   calling thread.
+*/
+static void attr_init(struct perf_event_attr *attr, perf_ctr_t c){
+  memset(attr, 0, sizeof(struct perf_event_attr));
+  attr->size = sizeof(struct perf_event_attr);
+  attr->read_format = (PERF_FORMAT_GROUP |
+		       PERF_FORMAT_TOTAL_TIME_ENABLED |
+		       PERF_FORMAT_TOTAL_TIME_RUNNING);
+  attr->exclude_kernel = 1;
+  attr->exclude_hv = 1;
+  attr->type = PERF_TYPE_HARDWARE;
+  switch (c){
+  case PERF_CYCLES:
+    attr->config = PERF_COUNT_HW_CPU_CYCLES;
+    break;
+  case PERF_INSTRS:
+    attr->config = PERF_COUNT_HW_INSTRUCTIONS;
+    break;
+  case PERF_LLC_MISSES:
+    attr->config = PERF_COUNT_HW_CACHE_MISSES;
+    break;
+  case PERF_BRANCH_MISSES:
+    attr->config = PERF_COUNT_HW_BRANCH_MISSES;
+    break;
+  case PERF_L1D_MISSES:
+    attr->type = PERF_TYPE_HW_CACHE;
+    attr->config = (PERF_COUNT_HW_CACHE_L1D |
+		    PERF_COUNT_HW_CACHE_OP_READ << 8 |
+		    PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    break;
+  case PERF_DTLB_MISSES:
+    attr->type = PERF_TYPE_HW_CACHE;
+    attr->config = (PERF_COUNT_HW_CACHE_DTLB |
+		    PERF_COUNT_HW_CACHE_OP_READ << 8 |
+		    PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    break;
+  default:
+    break;
+  }
+}
+
+/**
+   Opens a counter in the group of group_fd, or as a group leader if
+   group_fd is -1, and returns the file descriptor, or -1 if the counter is
+   unavailable.
+*/
+static int ctr_open(perf_ctr_t c, int group_fd){
+  struct perf_event_attr attr;
+  attr_init(&attr, c);
+  return (int)syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0UL);
+}
+
+#endif
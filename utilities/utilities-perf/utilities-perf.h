@@ -0,0 +1,127 @@
+/**
+   utilities-perf.h
+
+   Declarations of accessible utility functions for reading hardware
+   performance counters.
+
+   On Linux, unless UTILITIES_PERF_PORTABLE is defined, the counters are
+   opened with perf_event_open as one group that counts user space events
+   of the thread that opened the counters. A counter that is not supported
+   by the processor, hypervisor, or kernel configuration, or not permitted
+   by perf_event_paranoid, is unavailable and its value is PERF_NA; other
+   counters are not affected. On other systems, or if
+   UTILITIES_PERF_PORTABLE is defined, all counters are unavailable and the
+   implementation is portable under C89/C90. If the group is multiplexed
+   with other events, the values are scaled by the fraction of time the
+   group was counting.
+
+   Regions are named phases of algorithms that accumulate the counts of
+   the calling thread between the calls of perf_region_start and
+   perf_region_stop, and the number of such calls. Nested calls for the
+   same region are counted once, at the outermost level. The region macros
+   PERF_REGION_START and PERF_REGION_STOP are placed in the graph, heap,
+   hash table, and tsp modules and expand to nothing unless
+   UTILITIES_PERF_REGIONS is defined, e.g. with
+   "make clean-all && make CPPFLAGS=-DUTILITIES_PERF_REGIONS". Region
+   counts include the overhead of reading the counters, which is a system
+   call per boundary. Regions are not thread-safe and are meant for
+   single-threaded code.
+*/
+
+#ifndef UTILITIES_PERF_H
+#define UTILITIES_PERF_H
+
+#include <stdlib.h>
+
+#define PERF_NA (-1.0) /* value of an unavailable counter */
+
+typedef enum{
+  PERF_CYCLES,
+  PERF_INSTRS,
+  PERF_L1D_MISSES,
+  PERF_LLC_MISSES,
+  PERF_BRANCH_MISSES,
+  PERF_DTLB_MISSES,
+  PERF_COUNT
+} perf_ctr_t;
+
+typedef enum{
+  PERF_REG_ADJ_BUILD,
+  PERF_REG_HEAP,
+  PERF_REG_HT_GROW,
+  PERF_REG_TSP_LEVEL,
+  PERF_REG_COUNT
+} perf_reg_t;
+
+typedef struct{
+  double ctr[PERF_COUNT]; /* counts, or PERF_NA if unavailable */
+} perf_sample_t;
+
+/**
+   Opens the counters for the calling thread, if they are not open, and
+   returns the number of available counters.
+*/
+int perf_open(void);
+
+/**
+   Returns 1 if a counter is available, and 0 otherwise.
+*/
+int perf_available(perf_ctr_t c);
+
+/**
+   Returns the name of a counter, e.g. "cycles".
+*/
+const char *perf_name(perf_ctr_t c);
+
+/**
+   Reads the counts since the counters were opened. If the counters are not
+   open, then all values are PERF_NA.
+*/
+void perf_read(perf_sample_t *s);
+
+/**
+   Computes end - start for each counter. A value is PERF_NA if it is
+   PERF_NA in end or start. d may be equal to end or start.
+*/
+void perf_diff(perf_sample_t *d,
+	       const perf_sample_t *end,
+	       const perf_sample_t *start);
+
+/**
+   Closes the counters.
+*/
+void perf_close(void);
+
+/**
+   Starts and stops a region. The counters are opened at the first start
+   of a region if they are not open.
+*/
+
+void perf_region_start(perf_reg_t r);
+
+void perf_region_stop(perf_reg_t r);
+
+/**
+   Gets the accumulated counts and the number of start-stop pairs of a
+   region, or resets all regions.
+*/
+
+void perf_region_get(perf_reg_t r, perf_sample_t *s, size_t *num_calls);
+
+void perf_region_reset(void);
+
+/**
+   Prints the accumulated counts of the regions with at least one
+   start-stop pair.
+*/
+void perf_region_report(void);
+
+#ifdef UTILITIES_PERF_REGIONS
+#define PERF_REGION_START(r) perf_region_start(r)
+#define PERF_REGION_STOP(r) perf_region_stop(r)
+#else
+#define PERF_REGION_START(r)
+#define PERF_REGION_STOP(r)
+#endif
+
+#endif
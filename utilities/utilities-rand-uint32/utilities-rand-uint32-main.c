@@ -2,6 +2,10 @@
    utilities-rand-uint32-main.c
 
    Tests of randomness utility functions.
+
+   The runtimes are measured with utilities-bench and can be written as
+   csv or json records by setting BENCH_FORMAT and BENCH_OUT, e.g.
+   BENCH_FORMAT=json BENCH_OUT=utilities-rand-uint32.json ./utilities-rand-uint32
 */
 
 #include <stdio.h>
@@ -10,17 +14,132 @@
 #include <string.h>
 #include <time.h>
 #include "utilities-rand-uint32.h"
+#include "utilities-bench.h"
 #include "utilities-mem.h"
 #include "utilities-mod.h"
 
+static const char *C_SUITE = "utilities-rand-uint32";
 static const uint32_t BYTE_BIT_COUNT = 8;
 static const uint32_t FULL_BIT_COUNT = 8 * sizeof(uint32_t);
 static const uint32_t HALF_BIT_COUNT = 4 * sizeof(uint32_t);
 static const uint32_t UPPER_MAX = 0xffffffff;
 
+void report(const bench_t *b,
+	    const char *label,
+	    uint32_t n,
+	    uint32_t upper);
 void print_bit_probs(const uint32_t *counts, uint32_t trials);
 void print_test_result(int res);
 
+/**
+   Tests pcg32 functions and random_seed_uint32.
+*/
+void run_pcg32_test(){
+  int res = 1;
+  uint64_t seed = 42, stream = 54;
+  uint32_t n = 1000003;
+  uint32_t count = 10000000;
+  uint32_t num_streams = 8;
+  uint32_t stream_count = 1000;
+  uint32_t ref_nums[6] = {0xa15c02b7U, 0x7b47f409U, 0xba1d3330U,
+			  0x83d2f293U, 0xbfa4784bU, 0xcbed606eU};
+  uint32_t range_nums[4] = {630312U, 481568U, 727010U, 514939U};
+  uint32_t uppers[5] = {1U, 3U, 1000003U, 0x80000001U, UPPER_MAX};
+  uint32_t *nums = NULL, *streams = NULL;
+  pcg32_t g, h, gs[2];
+  bench_t b, b_fill, b_range;
+  printf("Run pcg32 test\n");
+  pcg32_seed(&g, seed, stream);
+  for (uint32_t i = 0; i < 6; i++){
+    res *= (pcg32_next(&g) == ref_nums[i]);
+  }
+  pcg32_seed(&g, seed, stream);
+  for (uint32_t i = 0; i < 4; i++){
+    res *= (pcg32_range(&g, n) == range_nums[i]);
+  }
+  printf("\treference values:          ");
+  print_test_result(res);
+  //fills and advances match sequential calls and ranges are bounded
+  res = 1;
+  nums = malloc_perror(count, sizeof(uint32_t));
+  pcg32_seed(&g, seed, stream);
+  pcg32_seed(&h, seed, stream);
+  pcg32_fill(&g, nums, count);
+  for (uint32_t i = 0; i < count; i++){
+    res *= (nums[i] == pcg32_next(&h));
+  }
+  pcg32_seed(&h, seed, stream);
+  pcg32_advance(&h, count - 1);
+  res *= (pcg32_next(&h) == nums[count - 1]);
+  pcg32_advance(&h, 0);
+  res *= (h.state == g.state);
+  for (uint32_t j = 0; j < 5; j++){
+    pcg32_fill_range(&g, nums, count, uppers[j]);
+    for (uint32_t i = 0; i < count; i++){
+      res *= (nums[i] < uppers[j]);
+      res *= (nums[i] == pcg32_range(&h, uppers[j]));
+    }
+  }
+  printf("\tfill, advance and range:   ");
+  print_test_result(res);
+  //split streams are reproducible and distinct
+  res = 1;
+  streams = malloc_perror(num_streams * stream_count, sizeof(uint32_t));
+  pcg32_seed(&g, seed, stream);
+  for (uint32_t i = 0; i < num_streams; i++){
+    pcg32_split(&g, &gs[0]);
+    pcg32_fill(&gs[0], &streams[i * stream_count], stream_count);
+  }
+  pcg32_seed(&g, seed, stream);
+  for (uint32_t i = 0; i < num_streams; i++){
+    pcg32_split(&g, &gs[1]);
+    for (uint32_t j = 0; j < stream_count; j++){
+      res *= (streams[i * stream_count + j] == pcg32_next(&gs[1]));
+    }
+    if (i > 0){
+      res *= (memcmp(&streams[i * stream_count],
+		     &streams[(i - 1) * stream_count],
+		     stream_count * sizeof(uint32_t)) != 0);
+    }
+  }
+  random_seed_uint32(seed);
+  for (uint32_t i = 0; i < stream_count; i++){
+    streams[i] = random_range_uint32(n);
+  }
+  random_seed_uint32(seed);
+  for (uint32_t i = 0; i < stream_count; i++){
+    res *= (streams[i] == random_range_uint32(n));
+  }
+  printf("\tsplit and seed:            ");
+  print_test_result(res);
+  //throughput
+  bench_init(&b, C_SUITE, "generator", 0, 1);
+  bench_start(&b);
+  for (uint32_t i = 0; i < count; i++){
+    nums[i] = UTILITIES_RAND_UINT32_RANDOM();
+  }
+  bench_stop(&b);
+  bench_init(&b_fill, C_SUITE, "pcg32_fill", 0, 1);
+  bench_start(&b_fill);
+  pcg32_fill(&g, nums, count);
+  bench_stop(&b_fill);
+  bench_init(&b_range, C_SUITE, "pcg32_fill_range", 0, 1);
+  bench_start(&b_range);
+  pcg32_fill_range(&g, nums, count, n);
+  bench_stop(&b_range);
+  printf("\t# numbers = %u\n", count);
+  report(&b, "\t\tgenerator:                 ", count, 0);
+  report(&b_fill, "\t\tpcg32_fill:                ", count, 0);
+  report(&b_range, "\t\tpcg32_fill_range:          ", count, n);
+  bench_free(&b);
+  bench_free(&b_fill);
+  bench_free(&b_range);
+  free(nums);
+  free(streams);
+  nums = NULL;
+  streams = NULL;
+}
+
 /**
    Tests random_range_uint32.
 */
@@ -30,7 +149,7 @@ void run_random_range_uint32_test(){
   uint32_t upper_low, upper_mid, upper_high;
   uint32_t *counts_low = NULL, *counts_mid = NULL, *counts_high = NULL;
   uint32_t *masks = NULL;
-  clock_t t, t_low, t_mid, t_high;
+  bench_t b, b_low, b_mid, b_high;
   counts_low = calloc_perror(FULL_BIT_COUNT, sizeof(uint32_t));
   counts_mid = calloc_perror(FULL_BIT_COUNT, sizeof(uint32_t));
   counts_high = calloc_perror(FULL_BIT_COUNT, sizeof(uint32_t));
@@ -45,47 +164,51 @@ void run_random_range_uint32_test(){
       upper_mid = pow_two(i);
       upper_low = pow_two(i);
       printf("\n\tlow: [0, %u), mid: [0, %u), high: [0, %u)\n",
-      	     upper_low, upper_mid, upper_high);
+	     upper_low, upper_mid, upper_high);
     }else if (i == 1){
       upper_low = pow_two(i - 1) + 1;
       upper_mid = pow_two(i - 1) + 1;
       upper_high = pow_two(i);
       printf("\n\tlow: [0, %u), mid: [0, %u), high: [0, %u)\n",
-      	     upper_low, upper_mid, upper_high);
+	     upper_low, upper_mid, upper_high);
     }else if (i == FULL_BIT_COUNT){
       upper_low = pow_two(i - 1) + 1;
       upper_mid = pow_two(i - 1) + (UPPER_MAX - pow_two(i - 1)) / 2;
       upper_high = UPPER_MAX;
       printf("\n\tlow: [0, %u), mid: [0, %u), high: [0, %u)\n",
-      	     upper_low, upper_mid, upper_high);
+	     upper_low, upper_mid, upper_high);
     }else{
       upper_low = pow_two(i - 1) + 1;
       upper_mid = pow_two(i - 1) + (pow_two(i) - pow_two(i - 1)) / 2;
       upper_high =  pow_two(i);
       printf("\n\tlow: [0, %u), mid: [0, %u), high: [0, %u)\n",
-      	     upper_low, upper_mid, upper_high);
+	     upper_low, upper_mid, upper_high);
     }
     fflush(stdout);
-    t = clock();
+    bench_init(&b, C_SUITE, "generator", 0, 1);
+    bench_start(&b);
     for (uint32_t i = 0; i < trials; i++){
       UTILITIES_RAND_UINT32_RANDOM();
     }
-    t = clock() - t;
-    t_low = clock();
+    bench_stop(&b);
+    bench_init(&b_low, C_SUITE, "random_range_uint32 low", 0, 1);
+    bench_start(&b_low);
     for (uint32_t i = 0; i < trials; i++){
       random_range_uint32(upper_low);
     }
-    t_low = clock() - t_low;
-    t_mid = clock();
+    bench_stop(&b_low);
+    bench_init(&b_mid, C_SUITE, "random_range_uint32 mid", 0, 1);
+    bench_start(&b_mid);
     for (uint32_t i = 0; i < trials; i++){
       random_range_uint32(upper_mid);
     }
-    t_mid = clock() - t_mid;
-    t_high = clock();
+    bench_stop(&b_mid);
+    bench_init(&b_high, C_SUITE, "random_range_uint32 high", 0, 1);
+    bench_start(&b_high);
     for (uint32_t i = 0; i < trials; i++){
       random_range_uint32(upper_high);
     }
-    t_high = clock() - t_high;
+    bench_stop(&b_high);
     for (uint32_t i = 0; i < trials; i++){
       n_low = random_range_uint32(upper_low);
       n_mid = random_range_uint32(upper_mid);
@@ -96,14 +219,14 @@ void run_random_range_uint32_test(){
 	if (n_high & masks[i]) counts_high[i]++;
       }
     }
-    printf("\t\tgenerator:                 %.8f seconds\n"
-	   "\t\trandom_range_uint32 low:   %.8f seconds\n"
-	   "\t\trandom_range_uint32 mid:   %.8f seconds\n"
-	   "\t\trandom_range_uint32 high:  %.8f seconds\n",
-	   (float)t / CLOCKS_PER_SEC,
-	   (float)t_low / CLOCKS_PER_SEC,
-	   (float)t_mid / CLOCKS_PER_SEC,
-	   (float)t_high / CLOCKS_PER_SEC);
+    report(&b, "\t\tgenerator:                 ", trials, 0);
+    report(&b_low, "\t\trandom_range_uint32 low:   ", trials, upper_low);
+    report(&b_mid, "\t\trandom_range_uint32 mid:   ", trials, upper_mid);
+    report(&b_high, "\t\trandom_range_uint32 high:  ", trials, upper_high);
+    bench_free(&b);
+    bench_free(&b_low);
+    bench_free(&b_mid);
+    bench_free(&b_high);
     printf("\t\tP[bit is set in low]:");
     print_bit_probs(counts_low, trials);
     printf("\t\tP[bit is set in mid]:");
@@ -139,7 +262,7 @@ void run_random_uint32_test(){
   uint32_t n;
   uint32_t *counts = NULL;
   uint32_t *masks = NULL;
-  clock_t t, t_rand;
+  bench_t b, b_rand;
   counts = calloc_perror(FULL_BIT_COUNT, sizeof(uint32_t));
   masks = calloc_perror(FULL_BIT_COUNT, sizeof(uint32_t));
   for (uint32_t i = 0; i < FULL_BIT_COUNT; i++){
@@ -148,26 +271,28 @@ void run_random_uint32_test(){
   printf("Run random_uint32 test\n");
   for (uint32_t ti = 0; ti < trials_count; ti++){
     printf("\t# trials = %u\n", trials[ti]);
-    t = clock();
+    bench_init(&b, C_SUITE, "generator", 0, 1);
+    bench_start(&b);
     for (uint32_t i = 0; i < trials[ti]; i++){
       UTILITIES_RAND_UINT32_RANDOM();
     }
-    t = clock() - t;
-    t_rand = clock();
+    bench_stop(&b);
+    bench_init(&b_rand, C_SUITE, "random_uint32", 0, 1);
+    bench_start(&b_rand);
     for (uint32_t i = 0; i < trials[ti]; i++){
       random_uint32();
     }
-    t_rand = clock() - t_rand;
+    bench_stop(&b_rand);
     for (uint32_t i = 0; i < trials[ti]; i++){
       n = random_uint32();
       for (uint32_t i = 0; i < FULL_BIT_COUNT; i++){
 	if (n & masks[i]) counts[i]++;
       }
     }
-    printf("\t\tgenerator:                 %.8f seconds\n"
-	   "\t\trandom_uint32:             %.8f seconds\n",
-	   (float)t / CLOCKS_PER_SEC,
-	   (float)t_rand / CLOCKS_PER_SEC);
+    report(&b, "\t\tgenerator:                 ", trials[ti], 0);
+    report(&b_rand, "\t\trandom_uint32:             ", trials[ti], 0);
+    bench_free(&b);
+    bench_free(&b_rand);
     printf("\t\tP[bit is set]:");
     print_bit_probs(counts, trials[ti]);
     memset(counts, 0, FULL_BIT_COUNT * sizeof(uint32_t));
@@ -239,7 +364,7 @@ void run_prime_scan_test(){
   uint32_t c;
   uint32_t low, high;
   uint32_t *starts = NULL, *nums = NULL;
-  clock_t t;
+  bench_t b;
   printf("Run a miller_rabin_uint32 test on finding %u primes "
 	 "in a range \n", trials);
   fflush(stdout);
@@ -254,13 +379,14 @@ void run_prime_scan_test(){
       starts[i] = low + random_range_uint32(high - low);
     }
     memcpy(nums, starts, trials * sizeof(uint32_t)); 
-    t = clock();
+    bench_init(&b, C_SUITE, "miller_rabin_uint32 scan", 0, 1);
+    bench_start(&b);
     for (uint32_t j = 0; j < trials; j++){
       while (!miller_rabin_uint32(nums[j])){
 	nums[j] = (nums[j] == low) ? high - 1 : nums[j] - 1;
       }
     }
-    t = clock() - t;
+    bench_stop(&b);
     memcpy(nums, starts, trials * sizeof(uint32_t));
     for (uint32_t j = 0; j < trials; j++){
       while (!miller_rabin_uint32(nums[j])){
@@ -268,10 +394,9 @@ void run_prime_scan_test(){
 	c++;
       }
     }
-    printf("\t\tave # tests/trial:         %.1f\n "
-	   "\t\ttotal runtime:             %.8f seconds\n",
-	   (float)c / trials,
-	   (float)t / CLOCKS_PER_SEC);
+    printf("\t\tave # tests/trial:         %.1f\n", (float)c / trials);
+    report(&b, "\t\ttotal runtime:             ", trials, high);
+    bench_free(&b);
     printf("\n");
   }
   free(starts);
@@ -280,6 +405,23 @@ void run_prime_scan_test(){
   nums = NULL;
 }
 
+/**
+   Reports a benchmark with the number of generated numbers or trials, and
+   the upper bound of the range if upper is not 0.
+*/
+void report(const bench_t *b,
+	    const char *label,
+	    uint32_t n,
+	    uint32_t upper){
+  char params[64];
+  if (upper){
+    sprintf(params, "n=%u upper=%u", n, upper);
+  }else{
+    sprintf(params, "n=%u", n);
+  }
+  bench_report(b, label, params);
+}
+
 /**
    Printing functions.
 */
@@ -304,6 +446,7 @@ void print_test_result(int res){
 
 int main(){
   UTILITIES_RAND_UINT32_SEED();
+  run_pcg32_test();
   run_random_range_uint32_test();
   run_random_uint32_test();
   run_primality_test();
@@ -12,11 +12,22 @@
    Primality testing is performed in a randomized approach according to
    Miller and Rabin.
 
-   The implementation is based on a generator that returns a number
-   from 0 to RAND_MAX, where RAND_MAX is 2^31 - 1, as set by 
-   UTILITIES_RAND_UINT32_RANDOM() and seeded by UTILITIES_RAND_UINT32_SEED().
-   Other generators may be accomodated in the future. The implementation is
-   not suitable for cryptographic use. 
+   The generation of numbers is based on the PCG32 generator by O'Neill
+   (XSH RR output of a 64-bit linear congruential generator) with an
+   explicit pcg32_t state. A state belongs to one of 2^63 streams selected
+   by the odd increment of the generator, and can be advanced by any number
+   of steps in logarithmic time, which enables independent streams, e.g.
+   one per thread, by splitting a seeded state. A number in [0, n) is
+   generated without bias by the multiplication and rejection method by
+   Lemire, with at most one division per call and a rejection probability
+   less than n / 2^32.
+
+   random_range_uint32 and random_uint32 use a default state that is
+   seeded by random_seed_uint32, or at the first call with three numbers
+   from the generator set by UTILITIES_RAND_UINT32_RANDOM() and seeded by
+   UTILITIES_RAND_UINT32_SEED(). The default state is not thread-safe, and
+   threads are expected to use states obtained with pcg32_split. The
+   implementation is not suitable for cryptographic use.
 */
 
 #include <stdio.h>
@@ -26,93 +37,155 @@
 #include "utilities-mod.h"
 
 static const uint32_t FULL_BIT_COUNT = 8 * sizeof(uint32_t);
-static const uint32_t HIGH_MASK = 2147483648U; //2^31
-static const uint32_t RAND_MAX_UINT32_TEST = 2147483647U;
-static const uint32_t RAND_MAX_UINT32 = RAND_MAX; //associate with a type
 static const int COMPOSITE_TRIALS = 50;
+static const uint64_t PCG_MUL = 6364136223846793005U;
+
+//default state of random_range_uint32 and random_uint32
+static pcg32_t default_g;
+static int default_seeded = 0;
 
 //number generation
-static uint32_t random_mod_pow_two(uint32_t k);
-static uint32_t random_gen_range(uint32_t n);
+static pcg32_t *default_state();
 
 //primality testing
 static int composite(uint32_t n, int trials);
 static int witness(uint32_t a, uint32_t n);
 static void represent_uint32(uint32_t n, uint32_t *k, uint32_t *u);
 
-//auxiliary functions
-static void fprintf_stderr_exit(const char *s, int line);
-
 /* Number generation */
 
 /**
-   Returns a generator-uniform uint32_t in [0 , n), where n > 0.
-   In the while loop, the probability of not finding a number decreases
-   exponentially and is less or equal to 0.5^n under the assumption of
-   generator uniformity, where n is the number of generator calls if
-   n <= RAND_MAX + 1, and the number of random_uint32() calls otherwise.
+   Initializes a state from a seed and a stream number. States with
+   distinct stream numbers mod 2^63 provide distinct sequences.
 */
-uint32_t random_range_uint32(uint32_t n){
-  uint32_t ret;
-  if (RAND_MAX_UINT32 != RAND_MAX_UINT32_TEST){
-    fprintf_stderr_exit("RAND_MAX value error", __LINE__);
-  }
-  if (n <= RAND_MAX_UINT32 + 1){
-    ret = random_gen_range(n);
-  }else{
-    ret = random_uint32();
-    while (ret > n - 1){
-      ret = random_uint32();
+void pcg32_seed(pcg32_t *g, uint64_t seed, uint64_t stream){
+  g->state = 0;
+  g->inc = (stream << 1) | 1;
+  pcg32_next(g);
+  g->state += seed;
+  pcg32_next(g);
+}
+
+/**
+   Returns a generator-uniform uint32_t and advances a state. The output is
+   the xorshifted high bits of the previous state rotated by its top five
+   bits.
+*/
+uint32_t pcg32_next(pcg32_t *g){
+  uint64_t s = g->state;
+  uint32_t x = ((s >> 18) ^ s) >> 27;
+  uint32_t r = s >> 59;
+  g->state = s * PCG_MUL + g->inc;
+  return (x >> r) | (x << ((-r) & 31));
+}
+
+/**
+   Returns a generator-uniform uint32_t in [0 , n), where n > 0, and
+   advances a state. The high word of the product of a number and n is
+   uniform in [0, n) unless the low word is less than 2^32 mod n, which
+   is computed only if the low word is less than n.
+*/
+uint32_t pcg32_range(pcg32_t *g, uint32_t n){
+  uint32_t t;
+  uint64_t m = (uint64_t)pcg32_next(g) * n;
+  if ((uint32_t)m < n){
+    t = -n % n; //2^32 mod n
+    while ((uint32_t)m < t){
+      m = (uint64_t)pcg32_next(g) * n;
     }
   }
-  return ret;
+  return m >> 32;
 }
 
 /**
-   Returns a generator-uniform uint32_t. 
+   Advances a state by delta steps in O(log delta) time by composing the
+   affine map of a step with itself according to the bits of delta.
 */
-uint32_t random_uint32(){
-  if (RAND_MAX_UINT32 != RAND_MAX_UINT32_TEST){
-    fprintf_stderr_exit("RAND_MAX value error", __LINE__);
+void pcg32_advance(pcg32_t *g, uint64_t delta){
+  uint64_t mul = PCG_MUL, add = g->inc;
+  uint64_t acc_mul = 1, acc_add = 0;
+  while (delta){
+    if (delta & 1){
+      acc_mul *= mul;
+      acc_add = acc_add * mul + add;
+    }
+    add = (mul + 1) * add;
+    mul *= mul;
+    delta >>= 1;
   }
-  return random_mod_pow_two(FULL_BIT_COUNT);
+  g->state = acc_mul * g->state + acc_add;
 }
 
 /**
-   Returns a generator-uniform uint32_t mod 2^k. 
+   Initializes a child state with a seed and a stream number generated by
+   a state, which advances the state by four steps.
 */
-static uint32_t random_mod_pow_two(uint32_t k){
-  uint32_t n, ret;
-  ret = UTILITIES_RAND_UINT32_RANDOM();
-  if (k < FULL_BIT_COUNT){
-    ret >>= FULL_BIT_COUNT - k - 1;
-  }else{
-    n = UTILITIES_RAND_UINT32_RANDOM();
-    n <<= 1;
-    n &= HIGH_MASK;
-    ret |= n;
+void pcg32_split(pcg32_t *g, pcg32_t *child){
+  uint64_t seed, stream;
+  seed = pcg32_next(g);
+  seed = (seed << 32) | pcg32_next(g);
+  stream = pcg32_next(g);
+  stream = (stream << 32) | pcg32_next(g);
+  pcg32_seed(child, seed, stream);
+}
+
+/**
+   Fills an array with count generator-uniform uint32_t, or with count
+   generator-uniform uint32_t in [0, n), where n > 0. The state is kept in
+   local variables across the loop.
+*/
+void pcg32_fill(pcg32_t *g, uint32_t *nums, size_t count){
+  pcg32_t lg = *g;
+  for (size_t i = 0; i < count; i++){
+    nums[i] = pcg32_next(&lg);
   }
-  return ret;
+  *g = lg;
+}
+
+void pcg32_fill_range(pcg32_t *g, uint32_t *nums, size_t count, uint32_t n){
+  pcg32_t lg = *g;
+  for (size_t i = 0; i < count; i++){
+    nums[i] = pcg32_range(&lg, n);
+  }
+  *g = lg;
 }
 
 /**
-   Returns a generator-uniform uint32_t in [0 , n) where
-   0 < n <= RAND_MAX + 1. In the while loop, the probability of not finding
-   a number decreases exponentially and is less or equal to 0.5^n under the
-   assumption of generator uniformity, where n is the number of generator
-   calls.
+   Seeds the default state of random_range_uint32 and random_uint32.
 */
-static uint32_t random_gen_range(uint32_t n){
-  uint32_t rem, ret;
-  rem = RAND_MAX_UINT32 % n;
-  ret =  UTILITIES_RAND_UINT32_RANDOM();
-  if (rem < n - 1){
-    while (ret > RAND_MAX_UINT32 - rem - 1){
-      ret = UTILITIES_RAND_UINT32_RANDOM();
-    }
+void random_seed_uint32(uint64_t seed){
+  pcg32_seed(&default_g, seed, 0);
+  default_seeded = 1;
+}
+
+/**
+   Returns a generator-uniform uint32_t in [0 , n), where n > 0.
+*/
+uint32_t random_range_uint32(uint32_t n){
+  return pcg32_range(default_state(), n);
+}
+
+/**
+   Returns a generator-uniform uint32_t. 
+*/
+uint32_t random_uint32(){
+  return pcg32_next(default_state());
+}
+
+/**
+   Returns a pointer to the default state, seeding the state with the
+   generator set by UTILITIES_RAND_UINT32_RANDOM() at the first call
+   unless random_seed_uint32 was called.
+*/
+static pcg32_t *default_state(){
+  uint64_t seed;
+  if (!default_seeded){
+    seed = UTILITIES_RAND_UINT32_RANDOM();
+    seed = (seed << 31) ^ UTILITIES_RAND_UINT32_RANDOM();
+    seed = (seed << 31) ^ UTILITIES_RAND_UINT32_RANDOM();
+    random_seed_uint32(seed);
   }
-  if (ret > n - 1) ret = ret % n;
-  return ret;
+  return &default_g;
 }
 
 /* Primality testing */
@@ -183,11 +256,3 @@ static void represent_uint32(uint32_t n, uint32_t *k, uint32_t *u){
   *k = FULL_BIT_COUNT - c;
   *u = n >> *k;
 }
-
-/**
-   Prints an error message and exits.
-*/
-static void fprintf_stderr_exit(const char *s, int line){
-  fprintf(stderr, "%s in %s at line %d\n", s,  __FILE__, line);
-  exit(EXIT_FAILURE);
-}
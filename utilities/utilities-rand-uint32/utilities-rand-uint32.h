@@ -12,19 +12,79 @@
    Primality testing is performed in a randomized approach according to
    Miller and Rabin.
 
-   The implementation is based on a generator that returns a number
-   from 0 to RAND_MAX, where RAND_MAX is 2^31 - 1, as set by 
-   UTILITIES_RAND_UINT32_RANDOM() and seeded by UTILITIES_RAND_UINT32_SEED().
-   Other generators may be accomodated in the future. The implementation is
-   not suitable for cryptographic use. 
+   The generation of numbers is based on the PCG32 generator by O'Neill
+   (XSH RR output of a 64-bit linear congruential generator) with an
+   explicit pcg32_t state. A state belongs to one of 2^63 streams selected
+   by the odd increment of the generator, and can be advanced by any number
+   of steps in logarithmic time, which enables independent streams, e.g.
+   one per thread, by splitting a seeded state. A number in [0, n) is
+   generated without bias by the multiplication and rejection method by
+   Lemire, with at most one division per call and a rejection probability
+   less than n / 2^32.
+
+   random_range_uint32 and random_uint32 use a default state that is
+   seeded by random_seed_uint32, or at the first call with three numbers
+   from the generator set by UTILITIES_RAND_UINT32_RANDOM() and seeded by
+   UTILITIES_RAND_UINT32_SEED(). The default state is not thread-safe, and
+   threads are expected to use states obtained with pcg32_split. The
+   implementation is not suitable for cryptographic use.
 */
 
 #ifndef UTILITIES_RAND_UINT32_H  
 #define UTILITIES_RAND_UINT32_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include <time.h>
 
+typedef struct{
+  uint64_t state;
+  uint64_t inc; //odd increment that selects the stream
+} pcg32_t;
+
+/**
+   Initializes a state from a seed and a stream number. States with
+   distinct stream numbers mod 2^63 provide distinct sequences.
+*/
+void pcg32_seed(pcg32_t *g, uint64_t seed, uint64_t stream);
+
+/**
+   Returns a generator-uniform uint32_t and advances a state.
+*/
+uint32_t pcg32_next(pcg32_t *g);
+
+/**
+   Returns a generator-uniform uint32_t in [0 , n), where n > 0, and
+   advances a state.
+*/
+uint32_t pcg32_range(pcg32_t *g, uint32_t n);
+
+/**
+   Advances a state by delta steps, equivalent to delta calls to
+   pcg32_next, in O(log delta) time.
+*/
+void pcg32_advance(pcg32_t *g, uint64_t delta);
+
+/**
+   Initializes a child state with a seed and a stream number generated by
+   a state, which advances the state. Splitting a state num_threads times
+   provides num_threads streams that are distinct with high probability.
+*/
+void pcg32_split(pcg32_t *g, pcg32_t *child);
+
+/**
+   Fills an array with count generator-uniform uint32_t, or with count
+   generator-uniform uint32_t in [0, n), where n > 0, in the order of
+   pcg32_next and pcg32_range calls respectively.
+*/
+void pcg32_fill(pcg32_t *g, uint32_t *nums, size_t count);
+void pcg32_fill_range(pcg32_t *g, uint32_t *nums, size_t count, uint32_t n);
+
+/**
+   Seeds the default state of random_range_uint32 and random_uint32.
+*/
+void random_seed_uint32(uint64_t seed);
+
 /**
    Returns a generator-uniform uint32_t in [0 , n).
 */
@@ -43,9 +103,11 @@ int miller_rabin_uint32(uint32_t n);
 
 /**
    Macro for setting the random number generator that returns a number
-   from 0 to RAND_MAX, where RAND_MAX is 2^31 - 1. By default, the
-   generator is set to random() that returns a pseudo-random number
-   with a large period of approximately 16 * (2^31 - 1). 
+   from 0 to RAND_MAX, where RAND_MAX is 2^31 - 1, and that seeds the
+   default state at the first call to random_range_uint32 or random_uint32
+   unless random_seed_uint32 was called. By default, the generator is set
+   to random() that returns a pseudo-random number with a large period of
+   approximately 16 * (2^31 - 1).
    (https://man7.org/linux/man-pages/man3/random.3.html)
 */
 #define UTILITIES_RAND_UINT32_SEED() do{srandom(time(0));}while (0)
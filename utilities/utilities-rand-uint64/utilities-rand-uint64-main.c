@@ -2,6 +2,10 @@
    utilities-rand-uint64-main.c
 
    Tests of randomness utility functions.
+
+   The runtimes are measured with utilities-bench and can be written as
+   csv or json records by setting BENCH_FORMAT and BENCH_OUT, e.g.
+   BENCH_FORMAT=json BENCH_OUT=utilities-rand-uint64.json ./utilities-rand-uint64
 */
 
 #include <stdio.h>
@@ -10,17 +14,149 @@
 #include <string.h>
 #include <time.h>
 #include "utilities-rand-uint64.h"
+#include "utilities-bench.h"
 #include "utilities-mem.h"
 #include "utilities-mod.h"
 
+static const char *C_SUITE = "utilities-rand-uint64";
 static const uint64_t BYTE_BIT_COUNT = 8;
 static const uint64_t FULL_BIT_COUNT = 8 * sizeof(uint64_t);
 static const uint64_t HALF_BIT_COUNT = 4 * sizeof(uint64_t);
 static const uint64_t UPPER_MAX = 0xffffffffffffffff;
 
+void report(const bench_t *b,
+	    const char *label,
+	    uint64_t n,
+	    uint64_t upper);
 void print_bit_probs(const uint64_t *counts, uint64_t trials);
 void print_test_result(int res);
 
+/**
+   Tests xoshiro256 functions and random_seed_uint64.
+*/
+void run_xoshiro256_test(){
+  int res = 1;
+  uint64_t seed = 2021;
+  uint64_t n = 1000003;
+  uint64_t count = 10000000;
+  uint64_t num_streams = 8;
+  uint64_t stream_count = 1000;
+  uint64_t ref_nums[3] = {11520U, 0U, 1509978240U};
+  uint64_t seed_nums[4] = {0xf61612c2ff4d9bc1U,
+			   0x584f61ab0b9a78b4U,
+			   0x8153a8240f70a3e2U,
+			   0xf7825de81809f5f1U};
+  uint64_t jump_nums[2] = {0x0511ba52d34c3863U, 0x1f2235052cd07dcfU};
+  uint64_t range_nums[4] = {961277U, 344962U, 505184U, 966835U};
+  uint64_t wide_n = 0x9e3779b97f4a7c15U;
+  uint64_t wide_nums[4] = {0x9816f35520a5065aU,
+			   0x4feda83da18284fbU,
+			   0x98f818a7625d9041U,
+			   0x7fa6b83c052e3929U};
+  uint64_t uppers[5] = {1U, 3U, 1000003U, 0x8000000000000001U, UPPER_MAX};
+  uint64_t *nums = NULL, *streams = NULL;
+  xoshiro256_t g, h, gs[2];
+  bench_t b, b_fill, b_range;
+  printf("Run xoshiro256 test\n");
+  g.s[0] = 1; g.s[1] = 2; g.s[2] = 3; g.s[3] = 4;
+  for (uint64_t i = 0; i < 3; i++){
+    res *= (xoshiro256_next(&g) == ref_nums[i]);
+  }
+  xoshiro256_seed(&g, seed);
+  for (uint64_t i = 0; i < 4; i++){
+    res *= (xoshiro256_next(&g) == seed_nums[i]);
+  }
+  xoshiro256_seed(&g, seed);
+  xoshiro256_jump(&g);
+  for (uint64_t i = 0; i < 2; i++){
+    res *= (xoshiro256_next(&g) == jump_nums[i]);
+  }
+  xoshiro256_seed(&g, seed);
+  for (uint64_t i = 0; i < 4; i++){
+    res *= (xoshiro256_range(&g, n) == range_nums[i]);
+  }
+  //n > 2^32 requires the high word of a full 128-bit product
+  xoshiro256_seed(&g, seed);
+  for (uint64_t i = 0; i < 4; i++){
+    res *= (xoshiro256_range(&g, wide_n) == wide_nums[i]);
+  }
+  printf("\treference values:          ");
+  print_test_result(res);
+  //fills match sequential calls and ranges are bounded
+  res = 1;
+  nums = malloc_perror(count, sizeof(uint64_t));
+  xoshiro256_seed(&g, seed);
+  xoshiro256_seed(&h, seed);
+  xoshiro256_fill(&g, nums, count);
+  for (uint64_t i = 0; i < count; i++){
+    res *= (nums[i] == xoshiro256_next(&h));
+  }
+  for (uint64_t j = 0; j < 5; j++){
+    xoshiro256_fill_range(&g, nums, count, uppers[j]);
+    for (uint64_t i = 0; i < count; i++){
+      res *= (nums[i] < uppers[j]);
+      res *= (nums[i] == xoshiro256_range(&h, uppers[j]));
+    }
+  }
+  printf("\tfill and range:            ");
+  print_test_result(res);
+  //split streams are reproducible and distinct
+  res = 1;
+  streams = malloc_perror(num_streams * stream_count, sizeof(uint64_t));
+  xoshiro256_seed(&g, seed);
+  for (uint64_t i = 0; i < num_streams; i++){
+    xoshiro256_split(&g, &gs[0]);
+    xoshiro256_fill(&gs[0], &streams[i * stream_count], stream_count);
+  }
+  xoshiro256_seed(&g, seed);
+  for (uint64_t i = 0; i < num_streams; i++){
+    xoshiro256_split(&g, &gs[1]);
+    for (uint64_t j = 0; j < stream_count; j++){
+      res *= (streams[i * stream_count + j] == xoshiro256_next(&gs[1]));
+      if (i > 0){
+	res *= (streams[i * stream_count + j] !=
+		streams[(i - 1) * stream_count + j]);
+      }
+    }
+  }
+  random_seed_uint64(seed);
+  for (uint64_t i = 0; i < stream_count; i++){
+    streams[i] = random_range_uint64(n);
+  }
+  random_seed_uint64(seed);
+  for (uint64_t i = 0; i < stream_count; i++){
+    res *= (streams[i] == random_range_uint64(n));
+  }
+  printf("\tsplit and seed:            ");
+  print_test_result(res);
+  //throughput
+  bench_init(&b, C_SUITE, "generator", 0, 1);
+  bench_start(&b);
+  for (uint64_t i = 0; i < count; i++){
+    nums[i] = UTILITIES_RAND_UINT64_RANDOM();
+  }
+  bench_stop(&b);
+  bench_init(&b_fill, C_SUITE, "xoshiro256_fill", 0, 1);
+  bench_start(&b_fill);
+  xoshiro256_fill(&g, nums, count);
+  bench_stop(&b_fill);
+  bench_init(&b_range, C_SUITE, "xoshiro256_fill_range", 0, 1);
+  bench_start(&b_range);
+  xoshiro256_fill_range(&g, nums, count, n);
+  bench_stop(&b_range);
+  printf("\t# numbers = %lu\n", count);
+  report(&b, "\t\tgenerator:                 ", count, 0);
+  report(&b_fill, "\t\txoshiro256_fill:           ", count, 0);
+  report(&b_range, "\t\txoshiro256_fill_range:     ", count, n);
+  bench_free(&b);
+  bench_free(&b_fill);
+  bench_free(&b_range);
+  free(nums);
+  free(streams);
+  nums = NULL;
+  streams = NULL;
+}
+
 /**
    Tests random_range_uint64.
 */
@@ -30,7 +166,7 @@ void run_random_range_uint64_test(){
   uint64_t upper_low, upper_mid, upper_high;
   uint64_t *counts_low = NULL, *counts_mid = NULL, *counts_high = NULL;
   uint64_t *masks = NULL;
-  clock_t t, t_low, t_mid, t_high;
+  bench_t b, b_low, b_mid, b_high;
   counts_low = calloc_perror(FULL_BIT_COUNT, sizeof(uint64_t));
   counts_mid = calloc_perror(FULL_BIT_COUNT, sizeof(uint64_t));
   counts_high = calloc_perror(FULL_BIT_COUNT, sizeof(uint64_t));
@@ -45,47 +181,51 @@ void run_random_range_uint64_test(){
       upper_mid = pow_two(i);
       upper_low = pow_two(i);
       printf("\n\tlow: [0, %lu), mid: [0, %lu), high: [0, %lu)\n",
-      	     upper_low, upper_mid, upper_high);
+	     upper_low, upper_mid, upper_high);
     }else if (i == 1){
       upper_low = pow_two(i - 1) + 1;
       upper_mid = pow_two(i - 1) + 1;
       upper_high = pow_two(i);
       printf("\n\tlow: [0, %lu), mid: [0, %lu), high: [0, %lu)\n",
-      	     upper_low, upper_mid, upper_high);
+	     upper_low, upper_mid, upper_high);
     }else if (i == FULL_BIT_COUNT){
       upper_low = pow_two(i - 1) + 1;
       upper_mid = pow_two(i - 1) + (UPPER_MAX - pow_two(i - 1)) / 2;
       upper_high = UPPER_MAX;
       printf("\n\tlow: [0, %lu), mid: [0, %lu), high: [0, %lu)\n",
-      	     upper_low, upper_mid, upper_high);
+	     upper_low, upper_mid, upper_high);
     }else{
       upper_low = pow_two(i - 1) + 1;
       upper_mid = pow_two(i - 1) + (pow_two(i) - pow_two(i - 1)) / 2;
       upper_high =  pow_two(i);
       printf("\n\tlow: [0, %lu), mid: [0, %lu), high: [0, %lu)\n",
-      	     upper_low, upper_mid, upper_high);
+	     upper_low, upper_mid, upper_high);
     }
     fflush(stdout);
-    t = clock();
+    bench_init(&b, C_SUITE, "generator", 0, 1);
+    bench_start(&b);
     for (uint64_t i = 0; i < trials; i++){
       UTILITIES_RAND_UINT64_RANDOM();
     }
-    t = clock() - t;
-    t_low = clock();
+    bench_stop(&b);
+    bench_init(&b_low, C_SUITE, "random_range_uint64 low", 0, 1);
+    bench_start(&b_low);
     for (uint64_t i = 0; i < trials; i++){
       random_range_uint64(upper_low);
     }
-    t_low = clock() - t_low;
-    t_mid = clock();
+    bench_stop(&b_low);
+    bench_init(&b_mid, C_SUITE, "random_range_uint64 mid", 0, 1);
+    bench_start(&b_mid);
     for (uint64_t i = 0; i < trials; i++){
       random_range_uint64(upper_mid);
     }
-    t_mid = clock() - t_mid;
-    t_high = clock();
+    bench_stop(&b_mid);
+    bench_init(&b_high, C_SUITE, "random_range_uint64 high", 0, 1);
+    bench_start(&b_high);
     for (uint64_t i = 0; i < trials; i++){
       random_range_uint64(upper_high);
     }
-    t_high = clock() - t_high;
+    bench_stop(&b_high);
     for (uint64_t i = 0; i < trials; i++){
       n_low = random_range_uint64(upper_low);
       n_mid = random_range_uint64(upper_mid);
@@ -96,14 +236,14 @@ void run_random_range_uint64_test(){
 	if (n_high & masks[i]) counts_high[i]++;
       }
     }
-    printf("\t\tgenerator:                 %.8f seconds\n"
-	   "\t\trandom_range_uint64 low:   %.8f seconds\n"
-	   "\t\trandom_range_uint64 mid:   %.8f seconds\n"
-	   "\t\trandom_range_uint64 high:  %.8f seconds\n",
-	   (float)t / CLOCKS_PER_SEC,
-	   (float)t_low / CLOCKS_PER_SEC,
-	   (float)t_mid / CLOCKS_PER_SEC,
-	   (float)t_high / CLOCKS_PER_SEC);
+    report(&b, "\t\tgenerator:                 ", trials, 0);
+    report(&b_low, "\t\trandom_range_uint64 low:   ", trials, upper_low);
+    report(&b_mid, "\t\trandom_range_uint64 mid:   ", trials, upper_mid);
+    report(&b_high, "\t\trandom_range_uint64 high:  ", trials, upper_high);
+    bench_free(&b);
+    bench_free(&b_low);
+    bench_free(&b_mid);
+    bench_free(&b_high);
     printf("\t\tP[bit is set in low]:");
     print_bit_probs(counts_low, trials);
     printf("\t\tP[bit is set in mid]:");
@@ -139,7 +279,7 @@ void run_random_uint64_test(){
   uint64_t n;
   uint64_t *counts = NULL;
   uint64_t *masks = NULL;
-  clock_t t, t_rand;
+  bench_t b, b_rand;
   counts = calloc_perror(FULL_BIT_COUNT, sizeof(uint64_t));
   masks = calloc_perror(FULL_BIT_COUNT, sizeof(uint64_t));
   for (uint64_t i = 0; i < FULL_BIT_COUNT; i++){
@@ -148,26 +288,28 @@ void run_random_uint64_test(){
   printf("Run random_uint64 test\n");
   for (uint64_t ti = 0; ti < trials_count; ti++){
     printf("\t# trials = %lu\n", trials[ti]);
-    t = clock();
+    bench_init(&b, C_SUITE, "generator", 0, 1);
+    bench_start(&b);
     for (uint64_t i = 0; i < trials[ti]; i++){
       UTILITIES_RAND_UINT64_RANDOM();
     }
-    t = clock() - t;
-    t_rand = clock();
+    bench_stop(&b);
+    bench_init(&b_rand, C_SUITE, "random_uint64", 0, 1);
+    bench_start(&b_rand);
     for (uint64_t i = 0; i < trials[ti]; i++){
       random_uint64();
     }
-    t_rand = clock() - t_rand;
+    bench_stop(&b_rand);
     for (uint64_t i = 0; i < trials[ti]; i++){
       n = random_uint64();
       for (uint64_t i = 0; i < FULL_BIT_COUNT; i++){
 	if (n & masks[i]) counts[i]++;
       }
     }
-    printf("\t\tgenerator:                 %.8f seconds\n"
-	   "\t\trandom_uint64:             %.8f seconds\n",
-	   (float)t / CLOCKS_PER_SEC,
-	   (float)t_rand / CLOCKS_PER_SEC);
+    report(&b, "\t\tgenerator:                 ", trials[ti], 0);
+    report(&b_rand, "\t\trandom_uint64:             ", trials[ti], 0);
+    bench_free(&b);
+    bench_free(&b_rand);
     printf("\t\tP[bit is set]:");
     print_bit_probs(counts, trials[ti]);
     memset(counts, 0, FULL_BIT_COUNT * sizeof(uint64_t));
@@ -262,7 +404,7 @@ void run_prime_scan_test(){
   uint64_t c;
   uint64_t low, high;
   uint64_t *starts = NULL, *nums = NULL;
-  clock_t t;
+  bench_t b;
   printf("Run a miller_rabin_uint64 test on finding %lu primes "
 	 "in a range \n", trials);
   fflush(stdout);
@@ -277,13 +419,14 @@ void run_prime_scan_test(){
       starts[i] = low + random_range_uint64(high - low);
     }
     memcpy(nums, starts, trials * sizeof(uint64_t)); 
-    t = clock();
+    bench_init(&b, C_SUITE, "miller_rabin_uint64 scan", 0, 1);
+    bench_start(&b);
     for (uint64_t j = 0; j < trials; j++){
       while (!miller_rabin_uint64(nums[j])){
 	nums[j] = (nums[j] == low) ? high - 1 : nums[j] - 1;
       }
     }
-    t = clock() - t;
+    bench_stop(&b);
     memcpy(nums, starts, trials * sizeof(uint64_t));
     for (uint64_t j = 0; j < trials; j++){
       while (!miller_rabin_uint64(nums[j])){
@@ -291,10 +434,9 @@ void run_prime_scan_test(){
 	c++;
       }
     }
-    printf("\t\tave # tests/trial:         %.1f\n "
-	   "\t\ttotal runtime:             %.8f seconds\n",
-	   (float)c / trials,
-	   (float)t / CLOCKS_PER_SEC);
+    printf("\t\tave # tests/trial:         %.1f\n", (float)c / trials);
+    report(&b, "\t\ttotal runtime:             ", trials, high);
+    bench_free(&b);
     printf("\n");
   }
   free(starts);
@@ -303,6 +445,23 @@ void run_prime_scan_test(){
   nums = NULL;
 }
 
+/**
+   Reports a benchmark with the number of generated numbers or trials, and
+   the upper bound of the range if upper is not 0.
+*/
+void report(const bench_t *b,
+	    const char *label,
+	    uint64_t n,
+	    uint64_t upper){
+  char params[64];
+  if (upper){
+    sprintf(params, "n=%lu upper=%lu", n, upper);
+  }else{
+    sprintf(params, "n=%lu", n);
+  }
+  bench_report(b, label, params);
+}
+
 /**
    Printing functions.
 */
@@ -327,6 +486,7 @@ void print_test_result(int res){
 
 int main(){
   UTILITIES_RAND_UINT64_SEED();
+  run_xoshiro256_test();
   run_random_range_uint64_test();
   run_random_uint64_test();
   run_primality_test();
@@ -3,20 +3,27 @@
 
    Randomness utility functions.
 
-   The generation of (pseudo-)random numbers in a given range is achieved
-   in a randomized approach by exponentially decreasing the probability of
-   not finding a number bounded by 0.5^N under the assumption of generator
-   uniformity, where N is the number of generated number candidates. N is
-   less or equal to 2 in expectation.
+   The generation of (pseudo-)random numbers is based on the xoshiro256**
+   generator by Blackman and Vigna with a 256-bit state in an explicit
+   xoshiro256_t object. A jump advances a state by 2^128 steps, which
+   enables independent streams, e.g. one per thread, by splitting a seeded
+   state. A number in [0, n) is generated without bias by the
+   multiplication and rejection method by Lemire: the high 64 bits of the
+   128-bit product of a generated number and n are returned unless the low
+   64 bits fall below 2^64 mod n, in which case a new number is generated.
+   The method uses at most one division per call, and the probability of a
+   rejection is less than n / 2^64 under the assumption of generator
+   uniformity.
 
    Primality testing is performed in a randomized approach according to
    Miller and Rabin.
 
-   The implementation is based on a generator that returns a number
-   from 0 to RAND_MAX, where RAND_MAX is 2^31 - 1, as set by 
-   UTILITIES_RAND_UINT64_RANDOM() and seeded by UTILITIES_RAND_UINT64_SEED().
-   Other generators may be accomodated in the future. The implementation is
-   not suitable for cryptographic use. 
+   random_range_uint64 and random_uint64 use a default state that is
+   seeded by random_seed_uint64, or at the first call with three numbers
+   from the generator set by UTILITIES_RAND_UINT64_RANDOM() and seeded by
+   UTILITIES_RAND_UINT64_SEED(). The default state is not thread-safe, and
+   threads are expected to use states obtained with xoshiro256_split. The
+   implementation is not suitable for cryptographic use.
 */
 
 #include <stdio.h>
@@ -26,110 +33,195 @@
 #include "utilities-mod.h"
 
 static const uint64_t FULL_BIT_COUNT = 8 * sizeof(uint64_t);
-static const uint64_t HALF_BIT_COUNT = 4 * sizeof(uint64_t);
-static const uint64_t HIGH_MASK = 13835058055282163712U; //2^62 + 2^63;
-static const uint64_t MID_MASK = 4611686016279904256U; //2^62 - 2^31;
-static const uint64_t RAND_MAX_UINT64_TEST = 2147483647U;
-static const uint64_t RAND_MAX_UINT64 = RAND_MAX; //associate with a type
 static const int COMPOSITE_TRIALS = 50;
+static const uint64_t SPLITMIX_INCR = 0x9e3779b97f4a7c15U;
+static const uint64_t JUMP[4] = {0x180ec6d33cfd0abaU,
+				 0xd5a61266f0c9392cU,
+				 0xa9582618e03fc9aaU,
+				 0x39abdc4529b1661cU};
+
+//default state of random_range_uint64 and random_uint64
+static xoshiro256_t default_g;
+static int default_seeded = 0;
 
 //number generation
-static uint64_t random_mod_pow_two(uint64_t k);
-static uint32_t random_gen_range(uint32_t n); //faster with uint32_t
+static uint64_t splitmix64(uint64_t *x);
+static uint64_t rotl(uint64_t x, int k);
+static void mul_ext_uint64(uint64_t a, uint64_t b, uint64_t *h, uint64_t *l);
+static xoshiro256_t *default_state();
 
 //primality testing
 static int composite(uint64_t n, int trials);
 static int witness(uint64_t a, uint64_t n);
 static void represent_uint64(uint64_t n, uint64_t *k, uint64_t *u);
 
-//auxiliary functions
-static void fprintf_stderr_exit(const char *s, int line);
-
 /* Number generation */
 
 /**
-   Returns a generator-uniform uint64_t in [0 , n), where n > 0.
-   In the while loop, the probability of not finding a number decreases
-   exponentially and is less or equal to 0.5^n under the assumption of
-   generator uniformity, where n is the number of generator calls if
-   n <= RAND_MAX + 1, and the number of random_uint64() calls otherwise.
+   Initializes a state from a seed by expanding the seed with the splitmix64
+   generator. Distinct seeds provide distinct states that are not all zero.
 */
-uint64_t random_range_uint64(uint64_t n){
-  uint64_t n_max, k, ret;
-  if (RAND_MAX_UINT64 != RAND_MAX_UINT64_TEST){
-    fprintf_stderr_exit("RAND_MAX value error", __LINE__);
+void xoshiro256_seed(xoshiro256_t *g, uint64_t seed){
+  for (int i = 0; i < 4; i++){
+    g->s[i] = splitmix64(&seed);
   }
-  if (n <= RAND_MAX_UINT64 + 1){
-    ret = random_gen_range(n);
-  }else{
-    n_max = n - 1;
-    n_max >>= HALF_BIT_COUNT;
-    k = HALF_BIT_COUNT;
-    while (n_max){
-      n_max >>= 1;
-      k++;
+}
+
+/**
+   Returns a generator-uniform uint64_t and advances a state.
+*/
+uint64_t xoshiro256_next(xoshiro256_t *g){
+  uint64_t *s = g->s;
+  uint64_t ret = rotl(s[1] * 5, 7) * 9;
+  uint64_t t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rotl(s[3], 45);
+  return ret;
+}
+
+/**
+   Returns a generator-uniform uint64_t in [0 , n), where n > 0, and
+   advances a state. The high word of the product of a number and n is
+   uniform in [0, n) unless the low word is less than 2^64 mod n, which
+   is computed only if the low word is less than n.
+*/
+uint64_t xoshiro256_range(xoshiro256_t *g, uint64_t n){
+  uint64_t h, l, t;
+  mul_ext_uint64(xoshiro256_next(g), n, &h, &l);
+  if (l < n){
+    t = -n % n; //2^64 mod n
+    while (l < t){
+      mul_ext_uint64(xoshiro256_next(g), n, &h, &l);
     }
-    ret = random_mod_pow_two(k);
-    while (ret > n - 1){
-      ret = random_mod_pow_two(k);
+  }
+  return h;
+}
+
+/**
+   Advances a state by 2^128 steps, equivalent to 2^128 calls to
+   xoshiro256_next.
+*/
+void xoshiro256_jump(xoshiro256_t *g){
+  uint64_t s[4] = {0, 0, 0, 0};
+  for (int i = 0; i < 4; i++){
+    for (int j = 0; j < 64; j++){
+      if (JUMP[i] & ((uint64_t)1 << j)){
+	s[0] ^= g->s[0];
+	s[1] ^= g->s[1];
+	s[2] ^= g->s[2];
+	s[3] ^= g->s[3];
+      }
+      xoshiro256_next(g);
     }
   }
-  return ret;
+  for (int i = 0; i < 4; i++){
+    g->s[i] = s[i];
+  }
+}
+
+/**
+   Copies a state to a child state and jumps the state, so that the child
+   state provides the next 2^128 numbers of the state without overlap with
+   the numbers provided by the state afterwards.
+*/
+void xoshiro256_split(xoshiro256_t *g, xoshiro256_t *child){
+  *child = *g;
+  xoshiro256_jump(g);
+}
+
+/**
+   Fills an array with count generator-uniform uint64_t, or with count
+   generator-uniform uint64_t in [0, n), where n > 0. The state is kept in
+   local variables across the loop.
+*/
+void xoshiro256_fill(xoshiro256_t *g, uint64_t *nums, size_t count){
+  xoshiro256_t lg = *g;
+  for (size_t i = 0; i < count; i++){
+    nums[i] = xoshiro256_next(&lg);
+  }
+  *g = lg;
+}
+
+void xoshiro256_fill_range(xoshiro256_t *g,
+			   uint64_t *nums,
+			   size_t count,
+			   uint64_t n){
+  xoshiro256_t lg = *g;
+  for (size_t i = 0; i < count; i++){
+    nums[i] = xoshiro256_range(&lg, n);
+  }
+  *g = lg;
+}
+
+/**
+   Seeds the default state of random_range_uint64 and random_uint64.
+*/
+void random_seed_uint64(uint64_t seed){
+  xoshiro256_seed(&default_g, seed);
+  default_seeded = 1;
+}
+
+/**
+   Returns a generator-uniform uint64_t in [0 , n), where n > 0.
+*/
+uint64_t random_range_uint64(uint64_t n){
+  return xoshiro256_range(default_state(), n);
 }
 
 /**
    Returns a generator-uniform uint64_t. 
 */
 uint64_t random_uint64(){
-  if (RAND_MAX_UINT64 != RAND_MAX_UINT64_TEST){
-    fprintf_stderr_exit("RAND_MAX value error", __LINE__);
-  }
-  return random_mod_pow_two(FULL_BIT_COUNT);
+  return xoshiro256_next(default_state());
 }
 
 /**
-   Returns a generator-uniform uint64_t mod 2^k. 
+   Returns the next number of the splitmix64 generator and advances its
+   state.
 */
-static uint64_t random_mod_pow_two(uint64_t k){
-  uint64_t n, ret;
-  ret = UTILITIES_RAND_UINT64_RANDOM();
-  if (k < HALF_BIT_COUNT){
-    ret >>= HALF_BIT_COUNT - k - 1;
-  }else if (k < FULL_BIT_COUNT - 1){
-    n = UTILITIES_RAND_UINT64_RANDOM();
-    n <<= k - (HALF_BIT_COUNT - 1);
-    n &= MID_MASK;
-    ret |= n;
-  }else{
-    n = UTILITIES_RAND_UINT64_RANDOM();
-    n <<= HALF_BIT_COUNT - 1;
-    ret |= n;
-    n = UTILITIES_RAND_UINT64_RANDOM();
-    n <<= k - (HALF_BIT_COUNT - 1);
-    n &= HIGH_MASK;
-    ret |= n;
-  }
-  return ret;
+static uint64_t splitmix64(uint64_t *x){
+  uint64_t z = (*x += SPLITMIX_INCR);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9U;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebU;
+  return z ^ (z >> 31);
+}
+
+static uint64_t rotl(uint64_t x, int k){
+  return (x << k) | (x >> (64 - k));
 }
 
 /**
-   Returns a generator-uniform uint32_t in [0 , n) where
-   0 < n <= RAND_MAX + 1. In the while loop, the probability of not finding
-   a number decreases exponentially and is less or equal to 0.5^n under the
-   assumption of generator uniformity, where n is the number of generator
-   calls.
+   Computes the high and low words of the 128-bit product of a and b from
+   products of 32-bit halves, without relying on the width of size_t.
 */
-static uint32_t random_gen_range(uint32_t n){
-  uint32_t rem, ret;
-  rem = (uint32_t)RAND_MAX_UINT64 % n;
-  ret =  UTILITIES_RAND_UINT64_RANDOM();
-  if (rem < n - 1){
-    while (ret > (uint32_t)RAND_MAX_UINT64 - rem - 1){
-      ret = UTILITIES_RAND_UINT64_RANDOM();
-    }
+static void mul_ext_uint64(uint64_t a, uint64_t b, uint64_t *h, uint64_t *l){
+  const uint64_t lmask = 0xffffffffU;
+  uint64_t al = a & lmask, ah = a >> 32;
+  uint64_t bl = b & lmask, bh = b >> 32;
+  uint64_t ll = al * bl, lh = al * bh, hl = ah * bl, hh = ah * bh;
+  uint64_t mid = (ll >> 32) + (lh & lmask) + (hl & lmask);
+  *l = (mid << 32) | (ll & lmask);
+  *h = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+}
+
+/**
+   Returns a pointer to the default state, seeding the state with the
+   generator set by UTILITIES_RAND_UINT64_RANDOM() at the first call
+   unless random_seed_uint64 was called.
+*/
+static xoshiro256_t *default_state(){
+  uint64_t seed;
+  if (!default_seeded){
+    seed = UTILITIES_RAND_UINT64_RANDOM();
+    seed = (seed << 31) ^ UTILITIES_RAND_UINT64_RANDOM();
+    seed = (seed << 31) ^ UTILITIES_RAND_UINT64_RANDOM();
+    random_seed_uint64(seed);
   }
-  if (ret > n - 1) ret = ret % n;
-  return ret;
+  return &default_g;
 }
 
 /* Primality testing */
@@ -170,20 +262,25 @@ static int composite(uint64_t n, int trials){
    a prime. n must be odd and greater or equal to 3.
 */
 static int witness(uint64_t a, uint64_t n){
-  uint64_t t, u, x[2];
+  uint64_t t, u, x[2], one, neg_one;
+  mont_t m;
   represent_uint64(n - 1, &t, &u);
-  x[0] = pow_mod(a, u, n);
-  x[1] = pow_mod(x[0], 2, n); //t > 0
+  //squaring in the Montgomery form of n, 1 and n - 1 in the same form
+  mont_init(&m, n);
+  one = m.r_mod;
+  neg_one = n - m.r_mod;
+  x[0] = mont_to(&m, mont_pow_mod(&m, a, u));
+  x[1] = mont_mul(&m, x[0], x[0]); //t > 0
   for (uint64_t i = 0; i < t; i++){
-    if (x[1] == 1 && !(x[0] == 1 || x[0] == n - 1)){
+    if (x[1] == one && !(x[0] == one || x[0] == neg_one)){
       return 1; //nontrivial root => composite
     }
     if (i < t - 1){
       x[0] = x[1];
-      x[1] = pow_mod(x[0], 2, n);
+      x[1] = mont_mul(&m, x[0], x[0]);
     }
   }
-  if (x[1] != 1) return 1; //composite based on Fermat's little theorem
+  if (x[1] != one) return 1; //composite based on Fermat's little theorem
   return 0;
 }
 
@@ -200,11 +297,3 @@ static void represent_uint64(uint64_t n, uint64_t *k, uint64_t *u){
   *k = FULL_BIT_COUNT - c;
   *u = n >> *k;
 }
-
-/**
-   Prints an error message and exits.
-*/
-static void fprintf_stderr_exit(const char *s, int line){
-  fprintf(stderr, "%s in %s at line %d\n", s,  __FILE__, line);
-  exit(EXIT_FAILURE);
-}
@@ -3,28 +3,87 @@
 
    Declarations of accessible randomness utility functions.
 
-   The generation of (pseudo-)random numbers in a given range is achieved
-   in a randomized approach by exponentially decreasing the probability of
-   not finding a number bounded by 0.5^N under the assumption of generator
-   uniformity, where N is the number of generated number candidates. N is
-   less or equal to 2 in expectation.
+   The generation of (pseudo-)random numbers is based on the xoshiro256**
+   generator by Blackman and Vigna with a 256-bit state in an explicit
+   xoshiro256_t object. A jump advances a state by 2^128 steps, which
+   enables independent streams, e.g. one per thread, by splitting a seeded
+   state. A number in [0, n) is generated without bias by the
+   multiplication and rejection method by Lemire: the high 64 bits of the
+   128-bit product of a generated number and n are returned unless the low
+   64 bits fall below 2^64 mod n, in which case a new number is generated.
+   The method uses at most one division per call, and the probability of a
+   rejection is less than n / 2^64 under the assumption of generator
+   uniformity.
 
    Primality testing is performed in a randomized approach according to
    Miller and Rabin.
 
-   The implementation is based on a generator that returns a number
-   from 0 to RAND_MAX, where RAND_MAX is 2^31 - 1, as set by 
-   UTILITIES_RAND_UINT64_RANDOM() and seeded by UTILITIES_RAND_UINT64_SEED().
-   Other generators may be accomodated in the future. The implementation is
-   not suitable for cryptographic use. 
+   random_range_uint64 and random_uint64 use a default state that is
+   seeded by random_seed_uint64, or at the first call with three numbers
+   from the generator set by UTILITIES_RAND_UINT64_RANDOM() and seeded by
+   UTILITIES_RAND_UINT64_SEED(). The default state is not thread-safe, and
+   threads are expected to use states obtained with xoshiro256_split. The
+   implementation is not suitable for cryptographic use.
 */
 
 #ifndef UTILITIES_RAND_UINT64_H  
 #define UTILITIES_RAND_UINT64_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include <time.h>
 
+typedef struct{
+  uint64_t s[4];
+} xoshiro256_t;
+
+/**
+   Initializes a state from a seed by expanding the seed with the splitmix64
+   generator. Distinct seeds provide distinct states that are not all zero.
+*/
+void xoshiro256_seed(xoshiro256_t *g, uint64_t seed);
+
+/**
+   Returns a generator-uniform uint64_t and advances a state.
+*/
+uint64_t xoshiro256_next(xoshiro256_t *g);
+
+/**
+   Returns a generator-uniform uint64_t in [0 , n), where n > 0, and
+   advances a state.
+*/
+uint64_t xoshiro256_range(xoshiro256_t *g, uint64_t n);
+
+/**
+   Advances a state by 2^128 steps, equivalent to 2^128 calls to
+   xoshiro256_next.
+*/
+void xoshiro256_jump(xoshiro256_t *g);
+
+/**
+   Copies a state to a child state and jumps the state, so that the child
+   state provides the next 2^128 numbers of the state without overlap with
+   the numbers provided by the state afterwards. Splitting a state
+   num_threads times provides num_threads independent streams.
+*/
+void xoshiro256_split(xoshiro256_t *g, xoshiro256_t *child);
+
+/**
+   Fills an array with count generator-uniform uint64_t, or with count
+   generator-uniform uint64_t in [0, n), where n > 0, in the order of
+   xoshiro256_next and xoshiro256_range calls respectively.
+*/
+void xoshiro256_fill(xoshiro256_t *g, uint64_t *nums, size_t count);
+void xoshiro256_fill_range(xoshiro256_t *g,
+                           uint64_t *nums,
+                           size_t count,
+                           uint64_t n);
+
+/**
+   Seeds the default state of random_range_uint64 and random_uint64.
+*/
+void random_seed_uint64(uint64_t seed);
+
 /**
    Returns a generator-uniform uint64_t in [0 , n).
 */
@@ -43,9 +102,11 @@ int miller_rabin_uint64(uint64_t n);
 
 /**
    Macro for setting the random number generator that returns a number
-   from 0 to RAND_MAX, where RAND_MAX is 2^31 - 1. By default, the
-   generator is set to random() that returns a pseudo-random number
-   with a large period of approximately 16 * (2^31 - 1). 
+   from 0 to RAND_MAX, where RAND_MAX is 2^31 - 1, and that seeds the
+   default state at the first call to random_range_uint64 or random_uint64
+   unless random_seed_uint64 was called. By default, the generator is set
+   to random() that returns a pseudo-random number with a large period of
+   approximately 16 * (2^31 - 1).
    (https://man7.org/linux/man-pages/man3/random.3.html)
 */
 #define UTILITIES_RAND_UINT64_SEED() do{srandom(time(0));}while (0)
@@ -0,0 +1,32 @@
+/**
+   utilities-time.c
+
+   Utility functions for measuring time.
+*/
+
+#if defined(__linux__) && !defined(UTILITIES_TIME_PORTABLE)
+#define _POSIX_C_SOURCE 199309L
+#define UTILITIES_TIME_POSIX
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "utilities-time.h"
+
+/**
+   Returns the monotonic wall-clock time in seconds since an arbitrary
+   point.
+*/
+double time_wall(void){
+#ifdef UTILITIES_TIME_POSIX
+  struct timespec ts;
+  if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0){
+    perror("clock_gettime failed");
+    exit(EXIT_FAILURE);
+  }
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+#else
+  return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
@@ -0,0 +1,24 @@
+/**
+   utilities-time.h
+
+   Declarations of accessible utility functions for measuring time.
+
+   On Linux, unless UTILITIES_TIME_PORTABLE is defined, the wall-clock time
+   is obtained with clock_gettime and CLOCK_MONOTONIC. On other systems, or
+   if UTILITIES_TIME_PORTABLE is defined, the processor time of clock is
+   used and the implementation is portable under C89/C90.
+
+   The module has no dependencies, so that algorithms can measure the
+   times of their phases without linking a benchmarking harness.
+*/
+
+#ifndef UTILITIES_TIME_H
+#define UTILITIES_TIME_H
+
+/**
+   Returns the monotonic wall-clock time in seconds since an arbitrary
+   point.
+*/
+double time_wall(void);
+
+#endif